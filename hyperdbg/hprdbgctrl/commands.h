@@ -41,6 +41,9 @@ HyperDbgReadMemoryAndDisassemble(DEBUGGER_SHOW_MEMORY_STYLE Style,
                                  UINT32                     Pid,
                                  UINT                       Size);
 
+BOOLEAN
+HyperDbgReadMemoryScatterGather(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest);
+
 string
 SeparateTo64BitValue(UINT64 Value);
 
@@ -56,6 +59,9 @@ ShowMemoryCommandDC(unsigned char * OutputBuffer, UINT Size, UINT64 Address, DEB
 void
 ShowMemoryCommandDQ(unsigned char * OutputBuffer, UINT Size, UINT64 Address, DEBUGGER_READ_MEMORY_TYPE MemoryType, UINT64 Length);
 
+VOID
+CommandIShowTraceRecords(PDEBUGGEE_TRACE_RECORDS_PACKET RecordsPacket, UINT32 Length);
+
 DEBUGGER_CONDITIONAL_JUMP_STATUS
 HyperDbgIsConditionalJumpTaken(unsigned char * BufferToDisassemble,
                                UINT64          BuffLength,
@@ -141,7 +147,8 @@ typedef std::map<std::string, COMMAND_DETAIL> CommandType;
  *
  */
 #define DEBUGGER_COMMAND_ATTRIBUTE_EVENT \
-    0x1 | DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE | DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_CASE_SENSITIVE
+    DEBUGGER_COMMAND_ATTRIBUTE_REGISTER_EVENT | DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE | DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_CASE_SENSITIVE
+#define DEBUGGER_COMMAND_ATTRIBUTE_REGISTER_EVENT                     0x1
 #define DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_DEBUGGER_MODE     0x2
 #define DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_COMMAND_IN_REMOTE_CONNECTION 0x4
 #define DEBUGGER_COMMAND_ATTRIBUTE_LOCAL_CASE_SENSITIVE               0x8
@@ -348,6 +355,9 @@ VOID
 CommandReadMemoryAndDisassembler(vector<string> SplittedCommand,
                                  string         Command);
 
+VOID
+CommandReadMemoryLinkedList(vector<string> SplittedCommand, string Command);
+
 VOID
 CommandConnect(vector<string> SplittedCommand, string Command);
 
@@ -465,6 +475,9 @@ CommandEditMemory(vector<string> SplittedCommand, string Command);
 VOID
 CommandSearchMemory(vector<string> SplittedCommand, string Command);
 
+VOID
+CommandSearchMemoryMultiPattern(vector<string> SplittedCommand, string Command);
+
 VOID
 CommandMeasure(vector<string> SplittedCommand, string Command);
 
@@ -1,7 +1,7 @@
 /**
  * @file d-u.cpp
  * @author Sina Karvandi (sina@rayanfam.com)
- * @brief !u* u* , !d* d* commands
+ * @brief !u* u* , !d* d* , !dl dl commands
  * @details
  * @version 0.1
  * @date 2020-05-27
@@ -315,3 +315,278 @@ CommandReadMemoryAndDisassembler(vector<string> SplittedCommand, string Command)
             Length);
     }
 }
+
+/**
+ * @brief help of dl !dl commands
+ *
+ * @return VOID
+ */
+VOID
+CommandReadMemoryLinkedListHelp()
+{
+    ShowMessages("dl !dl : walk a linked list and show the memory of its nodes\n");
+    ShowMessages("the pointer at the 'offset' of each node is the address of the "
+                 "next node, the list is walked until the pointer is null or "
+                 "points to the first node again\n");
+    ShowMessages("\nIf you want to read physical memory then add '!' at the "
+                 "start of the command\n\n");
+
+    ShowMessages("syntax : \t[!]dl [address] l [node size (hex)] c [maximum count of nodes (hex)] "
+                 "o [offset of the next pointer (hex)] pid [process id (hex)]\n");
+    ShowMessages("\t\te.g : dl nt!PsActiveProcessHead \n");
+    ShowMessages("\t\te.g : dl fffff8077356f010 l 30 c 10 \n");
+    ShowMessages("\t\te.g : dl fffff8077356f010 l 20 o 8 \n");
+}
+
+/**
+ * @brief dl !dl commands handler
+ *
+ * @param SplittedCommand
+ * @param Command
+ * @return VOID
+ */
+VOID
+CommandReadMemoryLinkedList(vector<string> SplittedCommand, string Command)
+{
+    UINT32                                   Pid             = 0;
+    UINT32                                   NodeSize        = 0x10;
+    UINT32                                   CountOfNodes    = MaximumScatterGatherReadDescriptors;
+    UINT32                                   Offset          = 0;
+    UINT64                                   TargetAddress   = 0;
+    BOOLEAN                                  IsNextProcessId = FALSE;
+    BOOLEAN                                  IsFirstCommand  = TRUE;
+    BOOLEAN                                  IsNextLength    = FALSE;
+    BOOLEAN                                  IsNextCount     = FALSE;
+    BOOLEAN                                  IsNextOffset    = FALSE;
+    PDEBUGGER_SCATTER_GATHER_READ_MEMORY     ReadRequest     = NULL;
+    PDEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR Descriptors     = NULL;
+    UCHAR *                                  Buffer          = NULL;
+    DEBUGGER_READ_MEMORY_TYPE                MemoryType      = DEBUGGER_READ_VIRTUAL_ADDRESS;
+    UINT64                                   NextAddress;
+    vector<string>                           SplittedCommandCaseSensitive {Split(Command, ' ')};
+    UINT32                                   IndexInCommandCaseSensitive = 0;
+
+    string FirstCommand = SplittedCommand.front();
+
+    if (SplittedCommand.size() == 1)
+    {
+        ShowMessages("incorrect use of '%s' command\n\n", FirstCommand.c_str());
+        CommandReadMemoryLinkedListHelp();
+        return;
+    }
+
+    for (auto Section : SplittedCommand)
+    {
+        IndexInCommandCaseSensitive++;
+
+        if (IsFirstCommand)
+        {
+            IsFirstCommand = FALSE;
+            continue;
+        }
+        if (IsNextProcessId == TRUE)
+        {
+            if (!ConvertStringToUInt32(Section, &Pid))
+            {
+                ShowMessages("err, you should enter a valid proc id\n\n");
+                return;
+            }
+            IsNextProcessId = FALSE;
+            continue;
+        }
+
+        if (IsNextLength == TRUE)
+        {
+            if (!ConvertStringToUInt32(Section, &NodeSize))
+            {
+                ShowMessages("err, you should enter a valid length\n\n");
+                return;
+            }
+            IsNextLength = FALSE;
+            continue;
+        }
+
+        if (IsNextCount == TRUE)
+        {
+            if (!ConvertStringToUInt32(Section, &CountOfNodes))
+            {
+                ShowMessages("err, you should enter a valid count\n\n");
+                return;
+            }
+            IsNextCount = FALSE;
+            continue;
+        }
+
+        if (IsNextOffset == TRUE)
+        {
+            if (!ConvertStringToUInt32(Section, &Offset))
+            {
+                ShowMessages("err, you should enter a valid offset\n\n");
+                return;
+            }
+            IsNextOffset = FALSE;
+            continue;
+        }
+
+        if (!Section.compare("l"))
+        {
+            IsNextLength = TRUE;
+            continue;
+        }
+
+        if (!Section.compare("c"))
+        {
+            IsNextCount = TRUE;
+            continue;
+        }
+
+        if (!Section.compare("o"))
+        {
+            IsNextOffset = TRUE;
+            continue;
+        }
+
+        if (!Section.compare("pid"))
+        {
+            IsNextProcessId = TRUE;
+            continue;
+        }
+
+        //
+        // Probably it's address
+        //
+        if (TargetAddress == 0)
+        {
+            if (!SymbolConvertNameToAddress(SplittedCommandCaseSensitive.at(IndexInCommandCaseSensitive - 1),
+                                            &TargetAddress))
+            {
+                //
+                // Couldn't resolve or unkonwn parameter
+                //
+                ShowMessages("err, couldn't resolve error at '%s'\n",
+                             SplittedCommandCaseSensitive.at(IndexInCommandCaseSensitive - 1).c_str());
+                return;
+            }
+        }
+        else
+        {
+            //
+            // User inserts two address
+            //
+            ShowMessages("err, incorrect use of '%s' command\n\n",
+                         FirstCommand.c_str());
+            CommandReadMemoryLinkedListHelp();
+
+            return;
+        }
+    }
+
+    if (!TargetAddress)
+    {
+        ShowMessages("err, please enter a valid address\n\n");
+        return;
+    }
+
+    if (IsNextLength || IsNextCount || IsNextOffset || IsNextProcessId)
+    {
+        ShowMessages("incorrect use of '%s' command\n\n", FirstCommand.c_str());
+        CommandReadMemoryLinkedListHelp();
+        return;
+    }
+
+    //
+    // Nodes are shown as quad-words, so the size is rounded up
+    //
+    NodeSize = (UINT32)((NodeSize + sizeof(UINT64) - 1) & ~(sizeof(UINT64) - 1));
+
+    if (NodeSize == 0 || NodeSize > MaximumScatterGatherReadTotalSize ||
+        CountOfNodes == 0 || CountOfNodes > MaximumScatterGatherReadDescriptors ||
+        Offset > NodeSize - sizeof(UINT64))
+    {
+        ShowMessages("err, the size of each node should be less than %x, the count of "
+                     "nodes should be less than %x and the next pointer should be in "
+                     "the node\n\n",
+                     MaximumScatterGatherReadTotalSize + 1,
+                     MaximumScatterGatherReadDescriptors + 1);
+        return;
+    }
+
+    //
+    // Check to prevent using process id in dl command
+    //
+    if (g_IsSerialConnectedToRemoteDebuggee && Pid != 0)
+    {
+        ShowMessages("err, you cannot specify 'pid' in the debugger mode\n\n");
+        return;
+    }
+
+    if (Pid == 0)
+    {
+        //
+        // Default process we read from current process
+        //
+        Pid = GetCurrentProcessId();
+    }
+
+    if (!FirstCommand.compare("!dl"))
+    {
+        MemoryType = DEBUGGER_READ_PHYSICAL_ADDRESS;
+    }
+
+    ReadRequest = (PDEBUGGER_SCATTER_GATHER_READ_MEMORY)malloc(DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE);
+
+    if (ReadRequest == NULL)
+    {
+        ShowMessages("err, unable to allocate memory\n");
+        return;
+    }
+
+    RtlZeroMemory(ReadRequest, DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE);
+
+    ReadRequest->ProcessId            = Pid;
+    ReadRequest->MemoryType           = MemoryType;
+    ReadRequest->Mode                 = DEBUGGER_SCATTER_GATHER_READ_FOLLOW_POINTER;
+    ReadRequest->CountOfDescriptors   = CountOfNodes;
+    ReadRequest->FollowPointerAddress = TargetAddress;
+    ReadRequest->FollowPointerSize    = NodeSize;
+    ReadRequest->FollowPointerOffset  = Offset;
+
+    //
+    // All of the nodes are read at once
+    //
+    if (HyperDbgReadMemoryScatterGather(ReadRequest))
+    {
+        Descriptors = (PDEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR)((UINT64)ReadRequest + SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY);
+        Buffer      = (UCHAR *)&Descriptors[ReadRequest->CountOfDescriptors];
+
+        for (UINT32 i = 0; i < ReadRequest->CountOfReadDescriptors; i++)
+        {
+            ShowMessages("\n");
+
+            ShowMemoryCommandDQ(Buffer,
+                                Descriptors[i].Size,
+                                Descriptors[i].Address,
+                                MemoryType,
+                                Descriptors[i].KernelStatus == DEBUGEER_OPERATION_WAS_SUCCESSFULL ? Descriptors[i].Size : 0);
+
+            Buffer += Descriptors[i].Size;
+        }
+
+        //
+        // Check whether the last node points to another node or not
+        //
+        if (ReadRequest->CountOfReadDescriptors != 0 &&
+            Descriptors[ReadRequest->CountOfReadDescriptors - 1].KernelStatus == DEBUGEER_OPERATION_WAS_SUCCESSFULL)
+        {
+            NextAddress = *(UINT64 *)(Buffer - NodeSize + Offset);
+
+            if (NextAddress != NULL && NextAddress != TargetAddress)
+            {
+                ShowMessages("\nthe list has more nodes, next node is at %s\n",
+                             SeparateTo64BitValue(NextAddress).c_str());
+            }
+        }
+    }
+
+    free(ReadRequest);
+}
@@ -26,6 +26,8 @@ extern BOOLEAN    g_IsConnectedToRemoteDebugger;
 extern BOOLEAN    g_IsSerialConnectedToRemoteDebuggee;
 extern BOOLEAN    g_IsSerialConnectedToRemoteDebugger;
 
+extern DEBUGGER_EVENT_BATCH g_EventBatch;
+
 /**
  * @brief shows the error message
  *
@@ -176,6 +178,57 @@ ShowErrorMessage(UINT32 Error)
         ShowMessages("err, process id is invalid (%x)\n", Error);
         break;
 
+    case DEBUGGER_ERROR_SEARCH_MEMORY_INVALID_PATTERN:
+        ShowMessages("err, the search pattern is invalid, a pattern can have up to "
+                     "%d bytes (%x)\n",
+                     MaximumSearchPatternLength,
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_SEARCH_MEMORY_INSUFFICIENT_RESOURCES:
+        ShowMessages("err, unable to allocate the search buffers (%x)\n", Error);
+        break;
+
+    case DEBUGGER_ERROR_MULTI_PATTERN_SEARCH_INVALID_PATTERNS:
+        ShowMessages("err, the patterns are invalid, up to %d patterns with the total "
+                     "length of %d bytes can be searched (%x)\n",
+                     MaximumMultiPatternSearchPatternsCount,
+                     MaximumMultiPatternSearchPatternsTotalLength,
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_MAXIMUM_NUMBER_OF_BREAKPOINTS_REACHED:
+        ShowMessages("err, maximum number of breakpoints is reached, clear some "
+                     "of the breakpoints (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_SCATTER_GATHER_READ_INVALID_DESCRIPTORS:
+        ShowMessages("err, the ranges are invalid, up to %d ranges with the total "
+                     "size of %d bytes can be read (%x)\n",
+                     MaximumScatterGatherReadDescriptors,
+                     MaximumScatterGatherReadTotalSize,
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_EVENTS_BATCH_INVALID_LAYOUT:
+        ShowMessages("err, the batch of events is invalid, none of its events "
+                     "are registered (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_UNABLE_TO_APPLY_EVENT:
+        ShowMessages("err, unable to change the controls or the bitmaps of the "
+                     "core for the event, the event is removed (%x)\n",
+                     Error);
+        break;
+
+    case DEBUGGER_ERROR_UNABLE_TO_ADD_ACTION_TO_EVENT:
+        ShowMessages("err, unable to add the action to the event, the event "
+                     "is removed (%x)\n",
+                     Error);
+        break;
+
     default:
         ShowMessages("err, error not found (%x)\n", Error);
         return FALSE;
@@ -1486,6 +1539,41 @@ InterpretOutput(vector<string> * SplittedCommand,
     return TRUE;
 }
 
+/**
+ * @brief Continue the debuggee after registering an event if the
+ * auto-unpause mode is enabled
+ *
+ * @return VOID
+ */
+VOID
+CheckForAutoUnpause()
+{
+    if (!g_IsSerialConnectedToRemoteDebuggee &&
+        !g_IsSerialConnectedToRemoteDebugger &&
+        g_BreakPrintingOutput &&
+        g_AutoUnpause)
+    {
+        //
+        // Allow debugger to show its contents
+        //
+
+        //
+        // Set the g_BreakPrintingOutput to FALSE
+        //
+        g_BreakPrintingOutput = FALSE;
+
+        //
+        // If it's a remote debugger then we send the remote debuggee a 'g'
+        //
+        if (g_IsConnectedToRemoteDebuggee)
+        {
+            RemoteConnectionSendCommand("g", strlen("g") + 1);
+        }
+
+        ShowMessages("\n");
+    }
+}
+
 /**
  * @brief Register the event to the kernel
  *
@@ -1502,6 +1590,22 @@ SendEventToKernel(PDEBUGGER_GENERAL_EVENT_DETAIL Event,
     ULONG                                 ReturnedLength;
     DEBUGGER_EVENT_AND_ACTION_REG_BUFFER  ReturnedBuffer = {0};
     PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER TempRegResult;
+    DEBUGGER_EVENT_BATCH_ENTRY            BatchEntry = {0};
+
+    //
+    // Check whether the event should be collected to be registered
+    // later with other events of the batch
+    //
+    if (g_EventBatch.IsCollecting)
+    {
+        BatchEntry.Line        = g_EventBatch.CurrentLine;
+        BatchEntry.Event       = Event;
+        BatchEntry.EventLength = EventBufferLength;
+
+        g_EventBatch.Entries.push_back(BatchEntry);
+
+        return TRUE;
+    }
 
     if (g_IsSerialConnectedToRemoteDebuggee)
     {
@@ -1574,30 +1678,7 @@ SendEventToKernel(PDEBUGGER_GENERAL_EVENT_DETAIL Event,
         //
         // Check for auto-unpause mode
         //
-        if (!g_IsSerialConnectedToRemoteDebuggee &&
-            !g_IsSerialConnectedToRemoteDebugger &&
-            g_BreakPrintingOutput &&
-            g_AutoUnpause)
-        {
-            //
-            // Allow debugger to show its contents
-            //
-
-            //
-            // Set the g_BreakPrintingOutput to FALSE
-            //
-            g_BreakPrintingOutput = FALSE;
-
-            //
-            // If it's a remote debugger then we send the remote debuggee a 'g'
-            //
-            if (g_IsConnectedToRemoteDebuggee)
-            {
-                RemoteConnectionSendCommand("g", strlen("g") + 1);
-            }
-
-            ShowMessages("\n");
-        }
+        CheckForAutoUnpause();
     }
     else
     {
@@ -1615,6 +1696,10 @@ SendEventToKernel(PDEBUGGER_GENERAL_EVENT_DETAIL Event,
         {
             ShowErrorMessage(ReturnedBuffer.Error);
         }
+        else
+        {
+            ShowMessages("err, unable to register the event\n");
+        }
         return FALSE;
     }
 
@@ -1641,6 +1726,30 @@ RegisterActionToEvent(PDEBUGGER_GENERAL_ACTION ActionBreakToDebugger,
     ULONG                                 ReturnedLength;
     DEBUGGER_EVENT_AND_ACTION_REG_BUFFER  ReturnedBuffer = {0};
     PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER TempAddingResult;
+    PDEBUGGER_EVENT_BATCH_ENTRY           BatchEntry;
+
+    //
+    // Check whether the actions should be collected, they belong to the
+    // last collected event of the batch
+    //
+    if (g_EventBatch.IsCollecting)
+    {
+        if (g_EventBatch.Entries.empty())
+        {
+            return FALSE;
+        }
+
+        BatchEntry = &g_EventBatch.Entries.back();
+
+        BatchEntry->ActionBreakToDebugger       = ActionBreakToDebugger;
+        BatchEntry->ActionBreakToDebuggerLength = ActionBreakToDebuggerLength;
+        BatchEntry->ActionCustomCode            = ActionCustomCode;
+        BatchEntry->ActionCustomCodeLength      = ActionCustomCodeLength;
+        BatchEntry->ActionScript                = ActionScript;
+        BatchEntry->ActionScriptLength          = ActionScriptLength;
+
+        return TRUE;
+    }
 
     if (g_IsSerialConnectedToRemoteDebuggee)
     {
@@ -1844,6 +1953,419 @@ RegisterActionToEvent(PDEBUGGER_GENERAL_ACTION ActionBreakToDebugger,
     return TRUE;
 }
 
+/**
+ * @brief Free the buffers of the actions of a collected event
+ *
+ * @param Entry the collected event
+ * @return VOID
+ */
+VOID
+EventBatchFreeActions(PDEBUGGER_EVENT_BATCH_ENTRY Entry)
+{
+    if (Entry->ActionBreakToDebugger != NULL)
+    {
+        free(Entry->ActionBreakToDebugger);
+    }
+    if (Entry->ActionCustomCode != NULL)
+    {
+        free(Entry->ActionCustomCode);
+    }
+    if (Entry->ActionScript != NULL)
+    {
+        free(Entry->ActionScript);
+    }
+
+    Entry->ActionBreakToDebugger = NULL;
+    Entry->ActionCustomCode      = NULL;
+    Entry->ActionScript          = NULL;
+}
+
+/**
+ * @brief Start collecting the events instead of registering them
+ * @details From now on, SendEventToKernel and RegisterActionToEvent
+ * keep the event and the actions in the batch until the batch is
+ * submitted or discarded
+ *
+ * @return VOID
+ */
+VOID
+EventBatchStart()
+{
+    EventBatchDiscard();
+
+    g_EventBatch.IsCollecting = TRUE;
+    g_EventBatch.CurrentLine  = 0;
+}
+
+/**
+ * @brief Compute the size of a collected event and its actions in
+ * a batch request
+ *
+ * @param Entry the collected event
+ * @return UINT32 size of the entry
+ */
+UINT32
+EventBatchGetEntrySize(PDEBUGGER_EVENT_BATCH_ENTRY Entry)
+{
+    UINT32 Size;
+
+    Size = SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY + DEBUGGER_EVENTS_BATCH_ALIGN(Entry->EventLength);
+
+    if (Entry->ActionBreakToDebugger != NULL)
+    {
+        Size += DEBUGGER_EVENTS_BATCH_ALIGN(Entry->ActionBreakToDebuggerLength);
+    }
+    if (Entry->ActionCustomCode != NULL)
+    {
+        Size += DEBUGGER_EVENTS_BATCH_ALIGN(Entry->ActionCustomCodeLength);
+    }
+    if (Entry->ActionScript != NULL)
+    {
+        Size += DEBUGGER_EVENTS_BATCH_ALIGN(Entry->ActionScriptLength);
+    }
+
+    return Size;
+}
+
+/**
+ * @brief Copy a collected event and its actions to a batch request
+ *
+ * @param Entry the collected event
+ * @param BatchEntry the target entry in the batch (should be zeroed
+ * and have enough space)
+ * @return VOID
+ */
+VOID
+EventBatchFillEntry(PDEBUGGER_EVENT_BATCH_ENTRY Entry, PDEBUGGER_EVENTS_BATCH_ENTRY BatchEntry)
+{
+    PDEBUGGER_GENERAL_ACTION Actions[DEBUGGER_EVENTS_BATCH_MAXIMUM_ACTIONS] = {
+        Entry->ActionBreakToDebugger,
+        Entry->ActionCustomCode,
+        Entry->ActionScript};
+    UINT32 ActionLengths[DEBUGGER_EVENTS_BATCH_MAXIMUM_ACTIONS] = {
+        Entry->ActionBreakToDebuggerLength,
+        Entry->ActionCustomCodeLength,
+        Entry->ActionScriptLength};
+    UINT32 Offset;
+
+    BatchEntry->Size        = EventBatchGetEntrySize(Entry);
+    BatchEntry->EventLength = Entry->EventLength;
+
+    memcpy((PVOID)((UINT64)BatchEntry + SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY), Entry->Event, Entry->EventLength);
+
+    Offset = SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY + DEBUGGER_EVENTS_BATCH_ALIGN(Entry->EventLength);
+
+    for (UINT32 i = 0; i < DEBUGGER_EVENTS_BATCH_MAXIMUM_ACTIONS; i++)
+    {
+        if (Actions[i] == NULL)
+        {
+            continue;
+        }
+
+        memcpy((PVOID)((UINT64)BatchEntry + Offset), Actions[i], ActionLengths[i]);
+
+        BatchEntry->ActionLengths[BatchEntry->CountOfActions] = ActionLengths[i];
+        BatchEntry->CountOfActions++;
+
+        Offset += DEBUGGER_EVENTS_BATCH_ALIGN(ActionLengths[i]);
+    }
+}
+
+/**
+ * @brief Send a batch request to the kernel (or the debuggee)
+ *
+ * @param EventsBatch the batch request, the results are written to the
+ * same buffer
+ * @return BOOLEAN TRUE if the batch is sent and the results are received
+ */
+BOOLEAN
+EventBatchSendToKernel(PDEBUGGER_EVENTS_BATCH EventsBatch)
+{
+    BOOL                   Status;
+    ULONG                  ReturnedLength;
+    PDEBUGGER_EVENTS_BATCH Result;
+
+    if (g_IsSerialConnectedToRemoteDebuggee)
+    {
+        //
+        // Send the batch to the debuggee, the results come in the
+        // same layout
+        //
+        Result = KdSendRegisterEventsBatchPacketToDebuggee(EventsBatch);
+
+        if (Result == NULL)
+        {
+            return FALSE;
+        }
+
+        memcpy(EventsBatch, Result, EventsBatch->Size);
+    }
+    else
+    {
+        //
+        // Send IOCTL
+        //
+        Status = DeviceIoControl(g_DeviceHandle,                       // Handle to device
+                                 IOCTL_DEBUGGER_REGISTER_EVENTS_BATCH, // IO Control code
+                                 EventsBatch,                          // Input Buffer to driver.
+                                 EventsBatch->Size,                    // Input buffer length
+                                 EventsBatch,                          // Output Buffer from driver.
+                                 EventsBatch->Size,                    // Length of output buffer in bytes.
+                                 &ReturnedLength,                      // Bytes placed in buffer.
+                                 NULL                                  // synchronous call
+        );
+
+        if (!Status)
+        {
+            ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+            return FALSE;
+        }
+    }
+
+    if (EventsBatch->KernelStatus != DEBUGEER_OPERATION_WAS_SUCCESSFULL)
+    {
+        ShowErrorMessage(EventsBatch->KernelStatus);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Register a collected event that doesn't fit in a batch
+ * request by itself
+ *
+ * @param Entry the collected event
+ * @return BOOLEAN TRUE if the event and its actions are registered
+ */
+BOOLEAN
+EventBatchRegisterEntry(PDEBUGGER_EVENT_BATCH_ENTRY Entry)
+{
+    UINT64 Tag = Entry->Event->Tag;
+
+    if (!SendEventToKernel(Entry->Event, Entry->EventLength))
+    {
+        //
+        // The event and the string buffers are freed and the error
+        // is shown, only the actions remain
+        //
+        EventBatchFreeActions(Entry);
+        return FALSE;
+    }
+
+    //
+    // The actions are freed after sending them
+    //
+    if (!RegisterActionToEvent(Entry->ActionBreakToDebugger,
+                               Entry->ActionBreakToDebuggerLength,
+                               Entry->ActionCustomCode,
+                               Entry->ActionCustomCodeLength,
+                               Entry->ActionScript,
+                               Entry->ActionScriptLength))
+    {
+        return FALSE;
+    }
+
+    ShowMessages("event 0x%llx is registered\n", Tag);
+
+    return TRUE;
+}
+
+/**
+ * @brief Register the collected events and their actions and show
+ * the result of each of them
+ * @details The events are packed in as few batch requests as possible,
+ * each batch request is validated and applied by the kernel at once
+ *
+ * @return UINT32 count of the events that are registered
+ */
+UINT32
+EventBatchSubmit()
+{
+    PDEBUGGER_EVENTS_BATCH       EventsBatch;
+    PDEBUGGER_EVENTS_BATCH_ENTRY BatchEntry;
+    PDEBUGGER_EVENT_BATCH_ENTRY  Entry;
+    BOOLEAN                      IsSent;
+    UINT32                       MaximumSize;
+    UINT32                       Size;
+    UINT32                       First;
+    UINT32                       Last;
+    UINT32                       CountOfEntries;
+    UINT32                       CountOfRegisteredEvents = 0;
+
+    //
+    // From now on, the events are sent to the kernel
+    //
+    g_EventBatch.IsCollecting = FALSE;
+
+    if (!g_IsSerialConnectedToRemoteDebuggee && !g_DeviceHandle)
+    {
+        ShowMessages(
+            "handle not found, probably the driver is not loaded. Did you "
+            "use 'load' command?\n");
+
+        EventBatchDiscard();
+        return 0;
+    }
+
+    //
+    // The batches that are sent over serial should fit in a packet
+    //
+    MaximumSize = g_IsSerialConnectedToRemoteDebuggee ? MaximumEventsBatchSizeOverSerial : MaximumEventsBatchSize;
+
+    EventsBatch = (PDEBUGGER_EVENTS_BATCH)malloc(MaximumSize);
+
+    if (EventsBatch == NULL)
+    {
+        ShowMessages("err, unable to allocate the batch of events\n");
+
+        EventBatchDiscard();
+        return 0;
+    }
+
+    CountOfEntries = (UINT32)g_EventBatch.Entries.size();
+    First          = 0;
+
+    while (First < CountOfEntries)
+    {
+        //
+        // Find the events that fit in this batch
+        //
+        Size = SIZEOF_DEBUGGER_EVENTS_BATCH;
+        Last = First;
+
+        while (Last < CountOfEntries &&
+               Size + EventBatchGetEntrySize(&g_EventBatch.Entries[Last]) <= MaximumSize)
+        {
+            Size += EventBatchGetEntrySize(&g_EventBatch.Entries[Last]);
+            Last++;
+        }
+
+        if (Last == First)
+        {
+            //
+            // The event is too large for a batch, it's registered by itself
+            //
+            ShowMessages("line %d: ", g_EventBatch.Entries[First].Line);
+
+            if (EventBatchRegisterEntry(&g_EventBatch.Entries[First]))
+            {
+                CountOfRegisteredEvents++;
+            }
+
+            First++;
+            continue;
+        }
+
+        //
+        // Fill the batch
+        //
+        RtlZeroMemory(EventsBatch, Size);
+
+        EventsBatch->Size           = Size;
+        EventsBatch->CountOfEntries = Last - First;
+
+        BatchEntry = (PDEBUGGER_EVENTS_BATCH_ENTRY)((UINT64)EventsBatch + SIZEOF_DEBUGGER_EVENTS_BATCH);
+
+        for (UINT32 i = First; i < Last; i++)
+        {
+            EventBatchFillEntry(&g_EventBatch.Entries[i], BatchEntry);
+
+            BatchEntry = (PDEBUGGER_EVENTS_BATCH_ENTRY)((UINT64)BatchEntry + BatchEntry->Size);
+        }
+
+        IsSent = EventBatchSendToKernel(EventsBatch);
+
+        //
+        // Show the result of each event of the batch
+        //
+        BatchEntry = (PDEBUGGER_EVENTS_BATCH_ENTRY)((UINT64)EventsBatch + SIZEOF_DEBUGGER_EVENTS_BATCH);
+
+        for (UINT32 i = First; i < Last; i++)
+        {
+            Entry = &g_EventBatch.Entries[i];
+
+            ShowMessages("line %d: ", Entry->Line);
+
+            if (IsSent && BatchEntry->EventResult.IsSuccessful && BatchEntry->EventResult.Error == 0)
+            {
+                //
+                // The event and all of its actions are registered (the kernel
+                // removes the events that one of their actions is not added
+                // and returns the error of the action as the error of the event)
+                //
+                InsertHeadList(&g_EventTrace, &(Entry->Event->CommandsEventList));
+
+                ShowMessages("event 0x%llx is registered\n", Entry->Event->Tag);
+                CountOfRegisteredEvents++;
+            }
+            else
+            {
+                if (!IsSent)
+                {
+                    ShowMessages("err, the event is not registered\n");
+                }
+                else if (BatchEntry->EventResult.Error != 0)
+                {
+                    ShowErrorMessage(BatchEntry->EventResult.Error);
+                }
+                else
+                {
+                    ShowMessages("err, unable to register the event\n");
+                }
+
+                free(Entry->Event->CommandStringBuffer);
+                free(Entry->Event);
+            }
+
+            //
+            // The actions are copied to the batch and are not used anymore
+            //
+            EventBatchFreeActions(Entry);
+
+            BatchEntry = (PDEBUGGER_EVENTS_BATCH_ENTRY)((UINT64)BatchEntry + BatchEntry->Size);
+        }
+
+        First = Last;
+    }
+
+    free(EventsBatch);
+
+    g_EventBatch.Entries.clear();
+
+    //
+    // Check for auto-unpause mode
+    //
+    if (CountOfRegisteredEvents != 0)
+    {
+        CheckForAutoUnpause();
+    }
+
+    return CountOfRegisteredEvents;
+}
+
+/**
+ * @brief Stop collecting the events and free the collected events
+ * without registering them
+ *
+ * @return VOID
+ */
+VOID
+EventBatchDiscard()
+{
+    g_EventBatch.IsCollecting = FALSE;
+
+    for (auto & Entry : g_EventBatch.Entries)
+    {
+        free(Entry.Event->CommandStringBuffer);
+        free(Entry.Event);
+
+        EventBatchFreeActions(&Entry);
+    }
+
+    g_EventBatch.Entries.clear();
+}
+
 /**
  * @brief Get the New Debugger Event Tag object and increase the
  * global variable for tag
@@ -2744,6 +3266,13 @@ InterpretGeneralEventAndActionsFields(
     if (TempActionScript != NULL)
     {
         TempActionScript->ImmediateMessagePassing = ImmediateMessagePassing;
+
+        //
+        // The scripts send event records if the output is forwarded
+        // to the output sources (not in the debugger mode as the
+        // messages are shown in the debugger)
+        //
+        TempActionScript->SendEventRecords = HasOutputPath && !g_IsSerialConnectedToRemoteDebuggee;
     }
     if (TempActionCustomCode != NULL)
     {
@@ -26,6 +26,9 @@ ScriptEngineUnloadAllSymbolsWrapper();
 UINT32
 ScriptEngineSearchSymbolForMaskWrapper(const char * SearchMask);
 
+BOOLEAN
+ScriptEngineConvertAddressToObjectNameWrapper(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement);
+
 //////////////////////////////////////////////////
 //          Script Engine Wrapper               //
 //////////////////////////////////////////////////
@@ -66,6 +69,26 @@ SymbolConvertNameToAddress(string TextToConvert, PUINT64 Result);
 BOOLEAN
 SymbolLoadNtoskrnlSymbol(UINT64 BaseAddress);
 
+BOOLEAN
+SymbolConvertAddressToString(UINT64 Address, CHAR * Buffer, UINT32 BufferSize);
+
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result);
+
+VOID
+SymbolShowMessageWithSymbols(const char * Message);
+
+//////////////////////////////////////////////////
+//            	    Definitions                 //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum length of the symbol (module!name+offset) that is shown
+ * for an address
+ *
+ */
+#define SYMBOL_MAXIMUM_OBJECT_NAME_LENGTH 512
+
 //////////////////////////////////////////////////
 //            	    Structures                  //
 //////////////////////////////////////////////////
@@ -91,6 +114,38 @@ typedef struct _DEBUGGER_SYNCRONIZATION_EVENTS_STATE
     BOOLEAN IsOnWaitingState;
 } DEBUGGER_SYNCRONIZATION_EVENTS_STATE, *PDEBUGGER_SYNCRONIZATION_EVENTS_STATE;
 
+/**
+ * @brief An event (and its actions) that is collected by the batch
+ * registration of events ('.script batch')
+ *
+ */
+typedef struct _DEBUGGER_EVENT_BATCH_ENTRY
+{
+    UINT32                         Line;                        // Line of the command in the script file
+    PDEBUGGER_GENERAL_EVENT_DETAIL Event;                       // The event buffer
+    UINT32                         EventLength;                 // Length of the event buffer
+    PDEBUGGER_GENERAL_ACTION       ActionBreakToDebugger;       // Break to debugger action (if any)
+    UINT32                         ActionBreakToDebuggerLength; // Length of the break to debugger action
+    PDEBUGGER_GENERAL_ACTION       ActionCustomCode;            // Custom code action (if any)
+    UINT32                         ActionCustomCodeLength;      // Length of the custom code action
+    PDEBUGGER_GENERAL_ACTION       ActionScript;                // Script action (if any)
+    UINT32                         ActionScriptLength;          // Length of the script action
+} DEBUGGER_EVENT_BATCH_ENTRY, *PDEBUGGER_EVENT_BATCH_ENTRY;
+
+/**
+ * @brief State of the batch registration of events
+ * @details While the batch is collecting, the events and actions are
+ * not sent to the kernel (or the debuggee), instead they are kept here
+ * and are registered together when the batch is submitted
+ *
+ */
+typedef struct _DEBUGGER_EVENT_BATCH
+{
+    BOOLEAN                            IsCollecting; // Shows whether the events are collected or sent
+    UINT32                             CurrentLine;  // Line of the command that is interpreted
+    vector<DEBUGGER_EVENT_BATCH_ENTRY> Entries;      // The collected events
+} DEBUGGER_EVENT_BATCH, *PDEBUGGER_EVENT_BATCH;
+
 //////////////////////////////////////////////////
 //				    Functions                   //
 //////////////////////////////////////////////////
@@ -143,6 +198,18 @@ InterpretGeneralEventAndActionsFields(
     PDEBUGGER_GENERAL_ACTION *       ActionDetailsToFillScript,
     PUINT32                          ActionBufferLengthScript);
 
+VOID
+CheckForAutoUnpause();
+
+VOID
+EventBatchStart();
+
+UINT32
+EventBatchSubmit();
+
+VOID
+EventBatchDiscard();
+
 UINT64
 GetNewDebuggerEventTag();
 
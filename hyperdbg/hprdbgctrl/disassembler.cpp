@@ -43,29 +43,6 @@ all
 //
 extern UINT32 g_DisassemblerSyntax;
 
-/**
- * @brief   Defines the `ZydisSymbol` struct.
- */
-typedef struct ZydisSymbol_
-{
-    /**
-   * @brief   The symbol address.
-   */
-    ZyanU64 address;
-    /**
-   * @brief   The symbol name.
-   */
-    const char * name;
-} ZydisSymbol;
-
-/**
- * @brief   A static symbol table with some dummy symbols.
- */
-static const ZydisSymbol SYMBOL_TABLE[3] = {
-    {0x007FFFFFFF401000, "SomeModule.EntryPoint"},
-    {0x007FFFFFFF530040, "SomeModule.SomeData"},
-    {0x007FFFFFFF401100, "SomeModule.SomeFunction"}};
-
 ZydisFormatterFunc default_print_address_absolute;
 
 /**
@@ -81,21 +58,28 @@ ZydisFormatterPrintAddressAbsolute(const ZydisFormatter *  formatter,
                                    ZydisFormatterBuffer *  buffer,
                                    ZydisFormatterContext * context)
 {
-    ZyanU64 address;
+    ZyanU64      address;
+    ZyanString * string;
+    CHAR         ObjectName[SYMBOL_MAXIMUM_OBJECT_NAME_LENGTH] = {0};
+
     ZYAN_CHECK(ZydisCalcAbsoluteAddress(context->instruction, context->operand, context->runtime_address, &address));
 
-    for (ZyanUSize i = 0; i < ZYAN_ARRAY_LENGTH(SYMBOL_TABLE); ++i)
+    //
+    // Print the address itself
+    //
+    ZYAN_CHECK(default_print_address_absolute(formatter, buffer, context));
+
+    //
+    // Append the symbol of the address (if any) after the address
+    //
+    if (SymbolConvertAddressToString(address, ObjectName, sizeof(ObjectName)))
     {
-        if (SYMBOL_TABLE[i].address == address)
-        {
-            ZYAN_CHECK(ZydisFormatterBufferAppend(buffer, ZYDIS_TOKEN_SYMBOL));
-            ZyanString * string;
-            ZYAN_CHECK(ZydisFormatterBufferGetString(buffer, &string));
-            return ZyanStringAppendFormat(string, "<%s>", SYMBOL_TABLE[i].name);
-        }
+        ZYAN_CHECK(ZydisFormatterBufferAppend(buffer, ZYDIS_TOKEN_SYMBOL));
+        ZYAN_CHECK(ZydisFormatterBufferGetString(buffer, &string));
+        return ZyanStringAppendFormat(string, " <%s>", ObjectName);
     }
 
-    return default_print_address_absolute(formatter, buffer, context);
+    return ZYAN_STATUS_SUCCESS;
 }
 
 /**
@@ -154,9 +138,21 @@ DisassembleBuffer(ZydisDecoder * decoder,
 
     ZydisDecodedInstruction instruction;
     char                    buffer[256];
+    CHAR                    ObjectName[SYMBOL_MAXIMUM_OBJECT_NAME_LENGTH];
+    UINT64                  Displacement;
+
     while (ZYAN_SUCCESS(
         ZydisDecoderDecodeBuffer(decoder, data, length, &instruction)))
     {
+        //
+        // Show the label of the symbols that start at this instruction
+        //
+        if (ScriptEngineConvertAddressToObjectNameWrapper(runtime_address, ObjectName, sizeof(ObjectName), &Displacement) &&
+            Displacement == 0)
+        {
+            ShowMessages("%s:\n", ObjectName);
+        }
+
         // ZYAN_PRINTF("%016" PRIX64 "  ", runtime_address);
         ShowMessages("%s   ", SeparateTo64BitValue(runtime_address).c_str());
         //
@@ -54,5 +54,10 @@ CommandExit(vector<string> SplittedCommand, string Command)
         HyperdbgUnload();
     }
 
+    //
+    // Deliver the buffered output as the command never finishes
+    //
+    ShowMessagesFlush();
+
     exit(0);
 }
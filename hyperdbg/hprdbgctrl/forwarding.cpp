@@ -14,8 +14,9 @@
 //
 // Global Variables
 //
-extern UINT64     g_OutputSourceTag;
-extern LIST_ENTRY g_OutputSources;
+extern UINT64                     g_OutputSourceTag;
+extern LIST_ENTRY                 g_OutputSources;
+extern PDEBUGGER_EVENT_FORWARDING g_OutputSourcesIndex[EVENT_FORWARDING_MAXIMUM_SOURCES];
 
 /**
  * @brief Get the output source tag and increase the
@@ -29,6 +30,25 @@ ForwardingGetNewOutputSourceTag()
     return g_OutputSourceTag++;
 }
 
+/**
+ * @brief Find the output source by its tag
+ * @param OutputUniqueTag Tag of the output source
+ *
+ * @return PDEBUGGER_EVENT_FORWARDING the output source or NULL if
+ * it's not found
+ */
+PDEBUGGER_EVENT_FORWARDING
+ForwardingGetOutputSourceByTag(UINT64 OutputUniqueTag)
+{
+    if (OutputUniqueTag < DebuggerOutputSourceTagStartSeed ||
+        OutputUniqueTag - DebuggerOutputSourceTagStartSeed >= EVENT_FORWARDING_MAXIMUM_SOURCES)
+    {
+        return NULL;
+    }
+
+    return g_OutputSourcesIndex[OutputUniqueTag - DebuggerOutputSourceTagStartSeed];
+}
+
 /**
  * @brief Opens the output source
  * @param SourceDescriptor Descriptor of the source
@@ -54,11 +74,6 @@ ForwardingOpenOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
         return DEBUGGER_OUTPUT_SOURCE_STATUS_ALREADY_OPENED;
     }
 
-    //
-    // Set the status to opened
-    //
-    SourceDescriptor->State = EVENT_FORWARDING_STATE_OPENED;
-
     //
     // Now, it's time to open the source based on its type
     //
@@ -68,7 +83,6 @@ ForwardingOpenOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
         // Nothing special to do here, file is opened with CreateFile
         // and nothing should be called to open the handle
         //
-        return DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED;
     }
     else if (SourceDescriptor->Type == EVENT_FORWARDING_NAMEDPIPE)
     {
@@ -76,7 +90,6 @@ ForwardingOpenOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
         // Nothing special to do here, namedpipe is opened with CreateFile
         // and nothing should be called to open the handle
         //
-        return DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED;
     }
     else if (SourceDescriptor->Type == EVENT_FORWARDING_TCP)
     {
@@ -85,10 +98,41 @@ ForwardingOpenOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
         // CommunicationClientConnectToServer and nothing should be
         // called to open the socket
         //
-        return DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED;
+    }
+    else
+    {
+        return DEBUGGER_OUTPUT_SOURCE_STATUS_UNKNOWN_ERROR;
     }
 
-    return DEBUGGER_OUTPUT_SOURCE_STATUS_UNKNOWN_ERROR;
+    //
+    // Start the thread that writes the messages to the source
+    //
+    if (!ForwardingStartWriterThread(SourceDescriptor))
+    {
+        return DEBUGGER_OUTPUT_SOURCE_STATUS_UNKNOWN_ERROR;
+    }
+
+    //
+    // The binary streams start with a header
+    //
+    if (SourceDescriptor->Format == EVENT_FORWARDING_FORMAT_BINARY)
+    {
+        DEBUGGER_EVENT_RECORD_STREAM_HEADER StreamHeader = {0};
+
+        StreamHeader.Signature = DEBUGGER_EVENT_RECORD_SIGNATURE;
+        StreamHeader.Version   = DEBUGGER_EVENT_RECORD_VERSION;
+
+        ForwardingQueueMessage(SourceDescriptor, (CHAR *)&StreamHeader, sizeof(StreamHeader));
+    }
+
+    //
+    // Set the status to opened, the messages of the events are only
+    // forwarded to the opened sources so they are queued after the
+    // header and never before the writer thread is started
+    //
+    SourceDescriptor->State = EVENT_FORWARDING_STATE_OPENED;
+
+    return DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED;
 }
 
 /**
@@ -125,6 +169,11 @@ ForwardingCloseOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
     //
     SourceDescriptor->State = EVENT_FORWARDING_CLOSED;
 
+    //
+    // Write the queued messages and stop the writer thread
+    //
+    ForwardingStopWriterThread(SourceDescriptor);
+
     //
     // Now, it's time to close the source based on its type
     //
@@ -287,6 +336,18 @@ ForwardingCreateOutputSource(DEBUGGER_EVENT_FORWARDING_TYPE SourceType,
  * output source or not, the caller if this function should make
  * sure that the following event has valid output sources or not
  *
+ * The message is queued for each of the sources and is written
+ * by their writer threads, so a slow source doesn't stop the others
+ *
+ * The message might be an event record, the sources with the text
+ * format receive the text of the record and the sources with the
+ * binary format receive the records (text messages are converted
+ * to records)
+ *
+ * The marked addresses of the messages ('%y' of printf) are converted
+ * to their symbols before the message is forwarded, the sources never
+ * receive the markers
+ *
  * @return BOOLEAN whether sending results was successful or not
  */
 BOOLEAN
@@ -294,8 +355,44 @@ ForwardingPerformEventForwarding(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetail,
                                  CHAR *                         Message,
                                  UINT32                         MessageLength)
 {
-    BOOLEAN     Result   = FALSE;
-    PLIST_ENTRY TempList = 0;
+    BOOLEAN                    Result = FALSE;
+    PDEBUGGER_EVENT_FORWARDING CurrentOutputSourceDetails;
+    PDEBUGGER_EVENT_RECORD     Record;
+    CHAR *                     Buffer;
+    UINT32                     BufferLength;
+    CHAR                       TextBuffer[PacketChunkSize];
+    UINT32                     TextLength = 0;
+    CHAR                       RecordBuffer[SIZEOF_DEBUGGER_EVENT_RECORD + PacketChunkSize];
+    UINT32                     RecordLength = 0;
+    string                     MessageWithSymbols;
+
+    Record = RecordsGetEventRecord(Message, MessageLength);
+
+    //
+    // Convert the marked addresses to their symbols, the record with the
+    // new text is built in the buffer of the records as the messages are
+    // either records or text
+    //
+    if (Record != NULL)
+    {
+        if (SymbolReplaceMarkers((CHAR *)Record + Record->Length - Record->TextLength,
+                                 Record->TextLength,
+                                 MessageWithSymbols))
+        {
+            RecordsReplaceText(Record,
+                               MessageWithSymbols.c_str(),
+                               (UINT32)MessageWithSymbols.size(),
+                               RecordBuffer,
+                               sizeof(RecordBuffer));
+
+            Record = (PDEBUGGER_EVENT_RECORD)RecordBuffer;
+        }
+    }
+    else if (SymbolReplaceMarkers(Message, (UINT32)strnlen_s(Message, MessageLength), MessageWithSymbols))
+    {
+        Message       = (CHAR *)MessageWithSymbols.c_str();
+        MessageLength = (UINT32)MessageWithSymbols.size() + 1;
+    }
 
     for (size_t i = 0; i < DebuggerOutputSourceMaximumRemoteSourceForSingleEvent;
          i++)
@@ -305,69 +402,499 @@ ForwardingPerformEventForwarding(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetail,
         //
         if (EventDetail->OutputSourceTags[i] == NULL)
         {
-            return Result;
+            break;
         }
 
         //
         // If we reach here then the output tag is not null
-        // means that we should find the event tag from list
-        // of tags
+        // means that we should find the source from its tag
         //
-        TempList = &g_OutputSources;
+        CurrentOutputSourceDetails = ForwardingGetOutputSourceByTag(EventDetail->OutputSourceTags[i]);
 
-        while (&g_OutputSources != TempList->Flink)
+        //
+        // Now, we should check whether the output is opened or
+        // not closed
+        //
+        if (CurrentOutputSourceDetails == NULL ||
+            CurrentOutputSourceDetails->State != EVENT_FORWARDING_STATE_OPENED)
         {
-            TempList = TempList->Flink;
-
-            PDEBUGGER_EVENT_FORWARDING CurrentOutputSourceDetails = CONTAINING_RECORD(
-                TempList,
-                DEBUGGER_EVENT_FORWARDING,
-                OutputSourcesList);
+            continue;
+        }
 
-            if (EventDetail->OutputSourceTags[i] ==
-                CurrentOutputSourceDetails->OutputUniqueTag)
+        //
+        // Convert the message to the format of the source (only once
+        // for all of the sources)
+        //
+        if (CurrentOutputSourceDetails->Format == EVENT_FORWARDING_FORMAT_BINARY && Record != NULL)
+        {
+            Buffer       = (CHAR *)Record;
+            BufferLength = Record->Length;
+        }
+        else if (CurrentOutputSourceDetails->Format == EVENT_FORWARDING_FORMAT_BINARY)
+        {
+            if (RecordLength == 0)
             {
-                //
-                // Indicate that we found a tag that matches this item
-                // Now, we should check whether the output is opened or
-                // not closed
-                //
-                if (CurrentOutputSourceDetails->State ==
-                    EVENT_FORWARDING_STATE_OPENED)
-                {
-                    switch (CurrentOutputSourceDetails->Type)
-                    {
-                    case EVENT_FORWARDING_NAMEDPIPE:
-                        Result = ForwardingSendToNamedPipe(
-                            CurrentOutputSourceDetails->Handle,
-                            Message,
-                            MessageLength);
-                        break;
-                    case EVENT_FORWARDING_FILE:
-                        Result = ForwardingWriteToFile(CurrentOutputSourceDetails->Handle,
+                RecordLength = RecordsCreateTextRecord(EventDetail->Tag,
                                                        Message,
-                                                       MessageLength);
-                        break;
-                    case EVENT_FORWARDING_TCP:
-                        Result = ForwardingSendToTcpSocket(
-                            CurrentOutputSourceDetails->Socket,
-                            Message,
-                            MessageLength);
-                        break;
-                    default:
-                        break;
-                    }
-                }
+                                                       strnlen_s(Message, MessageLength),
+                                                       RecordBuffer,
+                                                       sizeof(RecordBuffer));
+            }
+
+            Buffer       = RecordBuffer;
+            BufferLength = RecordLength;
+        }
+        else if (Record != NULL)
+        {
+            if (TextLength == 0)
+            {
+                TextLength = RecordsToText(Record, TextBuffer, sizeof(TextBuffer)) + 1;
+            }
+
+            Buffer       = TextBuffer;
+            BufferLength = TextLength;
+        }
+        else
+        {
+            Buffer       = Message;
+            BufferLength = MessageLength;
+        }
+
+        if (ForwardingQueueMessage(CurrentOutputSourceDetails, Buffer, BufferLength))
+        {
+            Result = TRUE;
+        }
+    }
+
+    return Result;
+}
+
+/**
+ * @brief Copy a buffer to the queue of the output source
+ * @param SourceDescriptor Descriptor of the source
+ * @param Buffer The buffer that should be copied
+ * @param Length Length of the buffer
+ * @details The caller should hold the lock of the queue and make sure
+ * that there is enough space in the queue
+ *
+ * @return VOID
+ */
+VOID
+ForwardingQueueWrite(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, PVOID Buffer, UINT32 Length)
+{
+    UINT32 Tail;
+    UINT32 FirstPart;
+
+    Tail      = (SourceDescriptor->QueueHead + SourceDescriptor->QueueSize) % EVENT_FORWARDING_QUEUE_SIZE;
+    FirstPart = EVENT_FORWARDING_QUEUE_SIZE - Tail;
+
+    if (Length < FirstPart)
+    {
+        FirstPart = Length;
+    }
+
+    memcpy(SourceDescriptor->Queue + Tail, Buffer, FirstPart);
+    memcpy(SourceDescriptor->Queue, (CHAR *)Buffer + FirstPart, Length - FirstPart);
+
+    SourceDescriptor->QueueSize += Length;
+}
+
+/**
+ * @brief Copy the first bytes of the queue of the output source
+ * without removing them
+ * @param SourceDescriptor Descriptor of the source
+ * @param Buffer The buffer that receives the bytes
+ * @param Length Length of the buffer
+ * @details The caller should hold the lock of the queue and make sure
+ * that there are enough bytes in the queue
+ *
+ * @return VOID
+ */
+VOID
+ForwardingQueuePeek(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, PVOID Buffer, UINT32 Length)
+{
+    UINT32 FirstPart;
+
+    FirstPart = EVENT_FORWARDING_QUEUE_SIZE - SourceDescriptor->QueueHead;
+
+    if (Length < FirstPart)
+    {
+        FirstPart = Length;
+    }
+
+    memcpy(Buffer, SourceDescriptor->Queue + SourceDescriptor->QueueHead, FirstPart);
+    memcpy((CHAR *)Buffer + FirstPart, SourceDescriptor->Queue, Length - FirstPart);
+}
+
+/**
+ * @brief Remove a buffer from the queue of the output source
+ * @param SourceDescriptor Descriptor of the source
+ * @param Buffer The buffer that receives the bytes (or NULL to
+ * discard them)
+ * @param Length Length of the buffer
+ * @details The caller should hold the lock of the queue and make sure
+ * that there are enough bytes in the queue
+ *
+ * @return VOID
+ */
+VOID
+ForwardingQueueRead(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, PVOID Buffer, UINT32 Length)
+{
+    if (Buffer != NULL)
+    {
+        ForwardingQueuePeek(SourceDescriptor, Buffer, Length);
+    }
+
+    SourceDescriptor->QueueHead = (SourceDescriptor->QueueHead + Length) % EVENT_FORWARDING_QUEUE_SIZE;
+    SourceDescriptor->QueueSize -= Length;
+}
+
+/**
+ * @brief Discard all of the queued messages of the output source
+ * @param SourceDescriptor Descriptor of the source
+ * @details The caller should hold the lock of the queue
+ *
+ * @return VOID
+ */
+VOID
+ForwardingQueueDiscard(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
+{
+    UINT32 MessageLength;
+
+    while (SourceDescriptor->QueueSize != 0)
+    {
+        ForwardingQueueRead(SourceDescriptor, &MessageLength, sizeof(UINT32));
+        ForwardingQueueRead(SourceDescriptor, NULL, MessageLength);
+
+        InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfDroppedMessages);
+    }
+
+    WakeAllConditionVariable(&SourceDescriptor->QueueNotFull);
+}
+
+/**
+ * @brief Queue a message to be written to the output source
+ * @param SourceDescriptor Descriptor of the source
+ * @param Message The message that should be sent to the source
+ * @param MessageLength Length of the message
+ * @details If the queue is full, the message is dropped or the caller
+ * waits for the writer thread based on the policy of the source
+ *
+ * @return BOOLEAN TRUE if the message is queued or dropped because of
+ * the policy of the source, FALSE if the source is not usable anymore
+ */
+BOOLEAN
+ForwardingQueueMessage(PDEBUGGER_EVENT_FORWARDING SourceDescriptor,
+                       CHAR *                     Message,
+                       UINT32                     MessageLength)
+{
+    UINT32 RecordLength = sizeof(UINT32) + MessageLength;
+
+    if (MessageLength > EVENT_FORWARDING_MAXIMUM_WRITE_SIZE)
+    {
+        InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfDroppedMessages);
+        return FALSE;
+    }
+
+    EnterCriticalSection(&SourceDescriptor->QueueLock);
+
+    while (!SourceDescriptor->IsStopping &&
+           !SourceDescriptor->IsFailed &&
+           EVENT_FORWARDING_QUEUE_SIZE - SourceDescriptor->QueueSize < RecordLength)
+    {
+        if (SourceDescriptor->Policy == EVENT_FORWARDING_POLICY_DROP)
+        {
+            //
+            // The source doesn't keep up with the messages, the message
+            // is dropped instead of waiting for the source
+            //
+            LeaveCriticalSection(&SourceDescriptor->QueueLock);
+
+            InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfDroppedMessages);
+            return TRUE;
+        }
+
+        //
+        // Wait for the writer thread to write some of the messages
+        //
+        SleepConditionVariableCS(&SourceDescriptor->QueueNotFull, &SourceDescriptor->QueueLock, INFINITE);
+    }
+
+    if (SourceDescriptor->IsStopping || SourceDescriptor->IsFailed)
+    {
+        LeaveCriticalSection(&SourceDescriptor->QueueLock);
+
+        InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfDroppedMessages);
+        return FALSE;
+    }
+
+    ForwardingQueueWrite(SourceDescriptor, &MessageLength, sizeof(UINT32));
+    ForwardingQueueWrite(SourceDescriptor, Message, MessageLength);
+
+    WakeConditionVariable(&SourceDescriptor->QueueNotEmpty);
+
+    LeaveCriticalSection(&SourceDescriptor->QueueLock);
+
+    InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfQueuedMessages);
+
+    return TRUE;
+}
+
+/**
+ * @brief Write a buffer to the output source based on its type
+ * @param SourceDescriptor Descriptor of the source
+ * @param Buffer The buffer that should be written
+ * @param Length Length of the buffer
+ *
+ * @return BOOLEAN whether the writing was successful or not
+ */
+BOOLEAN
+ForwardingWriteToOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, CHAR * Buffer, UINT32 Length)
+{
+    switch (SourceDescriptor->Type)
+    {
+    case EVENT_FORWARDING_NAMEDPIPE:
+        return ForwardingSendToNamedPipe(SourceDescriptor->Handle, Buffer, Length);
+
+    case EVENT_FORWARDING_FILE:
+        return ForwardingWriteToFile(SourceDescriptor->Handle, Buffer, Length);
+
+    case EVENT_FORWARDING_TCP:
+        return ForwardingSendToTcpSocket(SourceDescriptor->Socket, Buffer, Length);
+
+    default:
+        break;
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Thread that writes the queued messages to the output source
+ * @param Parameter Descriptor of the source
+ * @details The queued messages are written together (up to
+ * EVENT_FORWARDING_MAXIMUM_WRITE_SIZE), except for the namedpipes as
+ * each message is sent as a separate message of the pipe
+ *
+ * @return DWORD
+ */
+DWORD WINAPI
+ForwardingWriterThread(LPVOID Parameter)
+{
+    PDEBUGGER_EVENT_FORWARDING SourceDescriptor = (PDEBUGGER_EVENT_FORWARDING)Parameter;
+    UINT32                     MessageLength;
+    UINT32                     WriteLength;
+
+    while (TRUE)
+    {
+        EnterCriticalSection(&SourceDescriptor->QueueLock);
+
+        while (SourceDescriptor->QueueSize == 0 && !SourceDescriptor->IsStopping)
+        {
+            SleepConditionVariableCS(&SourceDescriptor->QueueNotEmpty, &SourceDescriptor->QueueLock, INFINITE);
+        }
+
+        if (SourceDescriptor->QueueSize == 0)
+        {
+            //
+            // The source is closing and all of the messages are written
+            //
+            LeaveCriticalSection(&SourceDescriptor->QueueLock);
+            break;
+        }
+
+        //
+        // Take the messages that fit in one write
+        //
+        WriteLength = 0;
+
+        while (SourceDescriptor->QueueSize != 0)
+        {
+            ForwardingQueuePeek(SourceDescriptor, &MessageLength, sizeof(UINT32));
 
+            if (WriteLength + MessageLength > EVENT_FORWARDING_MAXIMUM_WRITE_SIZE)
+            {
                 //
-                // No need to search through the list anymore
+                // The message is written by the next write
                 //
                 break;
             }
+
+            ForwardingQueueRead(SourceDescriptor, NULL, sizeof(UINT32));
+            ForwardingQueueRead(SourceDescriptor, SourceDescriptor->WriteBuffer + WriteLength, MessageLength);
+            WriteLength += MessageLength;
+
+            if (SourceDescriptor->Type == EVENT_FORWARDING_NAMEDPIPE)
+            {
+                break;
+            }
+        }
+
+        WakeAllConditionVariable(&SourceDescriptor->QueueNotFull);
+
+        LeaveCriticalSection(&SourceDescriptor->QueueLock);
+
+        //
+        // Write the messages without holding the lock
+        //
+        InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfWrites);
+
+        if (ForwardingWriteToOutputSource(SourceDescriptor, SourceDescriptor->WriteBuffer, WriteLength))
+        {
+            InterlockedAdd64(&SourceDescriptor->Statistics.CountOfWrittenBytes, WriteLength);
+        }
+        else
+        {
+            InterlockedIncrement64(&SourceDescriptor->Statistics.CountOfFailedWrites);
+
+            //
+            // The source is not usable anymore (the handle or the socket
+            // is closed on errors), so the messages are discarded
+            //
+            EnterCriticalSection(&SourceDescriptor->QueueLock);
+
+            SourceDescriptor->IsFailed = TRUE;
+            ForwardingQueueDiscard(SourceDescriptor);
+
+            LeaveCriticalSection(&SourceDescriptor->QueueLock);
         }
     }
 
-    return FALSE;
+    return 0;
+}
+
+/**
+ * @brief Allocate the queue of the output source and start its
+ * writer thread
+ * @param SourceDescriptor Descriptor of the source
+ *
+ * @return BOOLEAN whether the thread is started or not
+ */
+BOOLEAN
+ForwardingStartWriterThread(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
+{
+    SourceDescriptor->Queue       = (CHAR *)malloc(EVENT_FORWARDING_QUEUE_SIZE);
+    SourceDescriptor->WriteBuffer = (CHAR *)malloc(EVENT_FORWARDING_MAXIMUM_WRITE_SIZE);
+
+    if (SourceDescriptor->Queue == NULL || SourceDescriptor->WriteBuffer == NULL)
+    {
+        free(SourceDescriptor->Queue);
+        free(SourceDescriptor->WriteBuffer);
+
+        SourceDescriptor->Queue       = NULL;
+        SourceDescriptor->WriteBuffer = NULL;
+
+        return FALSE;
+    }
+
+    SourceDescriptor->QueueHead  = 0;
+    SourceDescriptor->QueueSize  = 0;
+    SourceDescriptor->IsStopping = FALSE;
+    SourceDescriptor->IsFailed   = FALSE;
+
+    InitializeCriticalSection(&SourceDescriptor->QueueLock);
+    InitializeConditionVariable(&SourceDescriptor->QueueNotEmpty);
+    InitializeConditionVariable(&SourceDescriptor->QueueNotFull);
+
+    SourceDescriptor->WriterThread = CreateThread(NULL, 0, ForwardingWriterThread, SourceDescriptor, 0, NULL);
+
+    if (SourceDescriptor->WriterThread == NULL)
+    {
+        DeleteCriticalSection(&SourceDescriptor->QueueLock);
+
+        free(SourceDescriptor->Queue);
+        free(SourceDescriptor->WriteBuffer);
+
+        SourceDescriptor->Queue       = NULL;
+        SourceDescriptor->WriteBuffer = NULL;
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Write the queued messages of the output source and stop
+ * its writer thread
+ * @param SourceDescriptor Descriptor of the source
+ * @details If the source doesn't take the queued messages in
+ * EVENT_FORWARDING_CLOSE_TIMEOUT, the pending write is canceled and
+ * the remaining messages are discarded, if the write is not canceled
+ * in EVENT_FORWARDING_CLOSE_TIMEOUT either, the thread is left to exit
+ * by itself (e.g., when the handle is closed) and its buffers are not
+ * freed
+ *
+ * @return VOID
+ */
+VOID
+ForwardingStopWriterThread(PDEBUGGER_EVENT_FORWARDING SourceDescriptor)
+{
+    if (SourceDescriptor->WriterThread == NULL)
+    {
+        return;
+    }
+
+    //
+    // The callers that wait for the space in the queue, give up and
+    // the writer thread exits after writing the queued messages
+    //
+    EnterCriticalSection(&SourceDescriptor->QueueLock);
+
+    SourceDescriptor->IsStopping = TRUE;
+
+    WakeAllConditionVariable(&SourceDescriptor->QueueNotEmpty);
+    WakeAllConditionVariable(&SourceDescriptor->QueueNotFull);
+
+    LeaveCriticalSection(&SourceDescriptor->QueueLock);
+
+    if (WaitForSingleObject(SourceDescriptor->WriterThread, EVENT_FORWARDING_CLOSE_TIMEOUT) == WAIT_TIMEOUT)
+    {
+        EnterCriticalSection(&SourceDescriptor->QueueLock);
+        ForwardingQueueDiscard(SourceDescriptor);
+        LeaveCriticalSection(&SourceDescriptor->QueueLock);
+
+        //
+        // Cancel the write that the thread is waiting for
+        //
+        if (SourceDescriptor->Type == EVENT_FORWARDING_TCP)
+        {
+            CommunicationClientShutdownConnection(SourceDescriptor->Socket);
+        }
+        else
+        {
+            CancelSynchronousIo(SourceDescriptor->WriterThread);
+        }
+
+        if (WaitForSingleObject(SourceDescriptor->WriterThread, EVENT_FORWARDING_CLOSE_TIMEOUT) == WAIT_TIMEOUT)
+        {
+            //
+            // The write is not canceled, the thread still uses the buffers
+            // and exits after the write as the queue is discarded
+            //
+            CloseHandle(SourceDescriptor->WriterThread);
+            SourceDescriptor->WriterThread = NULL;
+
+            return;
+        }
+    }
+
+    CloseHandle(SourceDescriptor->WriterThread);
+    SourceDescriptor->WriterThread = NULL;
+
+    //
+    // The lock is not deleted as the other threads might still check
+    // the state of the source, but the buffers are not used anymore
+    //
+    EnterCriticalSection(&SourceDescriptor->QueueLock);
+
+    free(SourceDescriptor->Queue);
+    free(SourceDescriptor->WriteBuffer);
+
+    SourceDescriptor->Queue       = NULL;
+    SourceDescriptor->WriteBuffer = NULL;
+
+    LeaveCriticalSection(&SourceDescriptor->QueueLock);
 }
 
 /**
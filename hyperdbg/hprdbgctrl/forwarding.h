@@ -21,6 +21,35 @@
  */
 #define MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME 50
 
+/**
+ * @brief maximum count of the output sources that can be created,
+ * the sources are indexed by their tags
+ *
+ */
+#define EVENT_FORWARDING_MAXIMUM_SOURCES 0x100
+
+/**
+ * @brief size of the queue of the messages of each output source
+ *
+ */
+#define EVENT_FORWARDING_QUEUE_SIZE 0x100000
+
+/**
+ * @brief maximum size of each write to the output sources, the queued
+ * messages are written together up to this size
+ *
+ */
+#define EVENT_FORWARDING_MAXIMUM_WRITE_SIZE 0x10000
+
+/**
+ * @brief milliseconds to wait for the queued messages to be written
+ * before closing an output source (and for the canceled write after it)
+ *
+ */
+#ifndef EVENT_FORWARDING_CLOSE_TIMEOUT
+#    define EVENT_FORWARDING_CLOSE_TIMEOUT 5000
+#endif // !EVENT_FORWARDING_CLOSE_TIMEOUT
+
 /**
  * @brief event forwarding type
  *
@@ -43,6 +72,30 @@ typedef enum _DEBUGGER_EVENT_FORWARDING_STATE
     EVENT_FORWARDING_CLOSED
 } DEBUGGER_EVENT_FORWARDING_STATE;
 
+/**
+ * @brief event forwarding policy when the queue of an
+ * output source is full
+ *
+ */
+typedef enum _DEBUGGER_EVENT_FORWARDING_POLICY
+{
+    EVENT_FORWARDING_POLICY_BLOCK,
+    EVENT_FORWARDING_POLICY_DROP
+} DEBUGGER_EVENT_FORWARDING_POLICY;
+
+/**
+ * @brief event forwarding format
+ *
+ * @details the sources with the binary format receive a stream
+ * header and the event records (DEBUGGER_EVENT_RECORD) instead of
+ * the text of the messages
+ */
+typedef enum _DEBUGGER_EVENT_FORWARDING_FORMAT
+{
+    EVENT_FORWARDING_FORMAT_TEXT,
+    EVENT_FORWARDING_FORMAT_BINARY
+} DEBUGGER_EVENT_FORWARDING_FORMAT;
+
 /**
  * @brief output source status
  *
@@ -58,21 +111,53 @@ typedef enum _DEBUGGER_OUTPUT_SOURCE_STATUS
     DEBUGGER_OUTPUT_SOURCE_STATUS_UNKNOWN_ERROR,
 } DEBUGGER_OUTPUT_SOURCE_STATUS;
 
+/**
+ * @brief Counters of the messages of each output source
+ *
+ */
+typedef struct _DEBUGGER_EVENT_FORWARDING_STATISTICS
+{
+    volatile LONG64 CountOfQueuedMessages;  // Count of the messages that are queued
+    volatile LONG64 CountOfDroppedMessages; // Count of the messages that are dropped
+    volatile LONG64 CountOfWrites;          // Count of the writes to the source
+    volatile LONG64 CountOfWrittenBytes;    // Count of the bytes that are written
+    volatile LONG64 CountOfFailedWrites;    // Count of the writes that are failed
+
+} DEBUGGER_EVENT_FORWARDING_STATISTICS, *PDEBUGGER_EVENT_FORWARDING_STATISTICS;
+
 /**
  * @brief structures hold the detail of event forwarding
  *
+ * @details the messages are queued (each of them after its length) and
+ * are written to the source by the writer thread of the source
+ *
  */
 typedef struct _DEBUGGER_EVENT_FORWARDING
 {
-    DEBUGGER_EVENT_FORWARDING_TYPE  Type;
-    DEBUGGER_EVENT_FORWARDING_STATE State;
-    HANDLE                          Handle;
-    SOCKET                          Socket;
-    UINT64                          OutputUniqueTag;
+    DEBUGGER_EVENT_FORWARDING_TYPE   Type;
+    DEBUGGER_EVENT_FORWARDING_STATE  State;
+    DEBUGGER_EVENT_FORWARDING_POLICY Policy;
+    DEBUGGER_EVENT_FORWARDING_FORMAT Format;
+    HANDLE                           Handle;
+    SOCKET                           Socket;
+    UINT64                           OutputUniqueTag;
     LIST_ENTRY
     OutputSourcesList; // Linked-list of output sources list
     CHAR Name[MAXIMUM_CHARACTERS_FOR_EVENT_FORWARDING_NAME];
 
+    HANDLE             WriterThread;  // Thread that writes the queued messages
+    CRITICAL_SECTION   QueueLock;     // Lock of the queue
+    CONDITION_VARIABLE QueueNotEmpty; // Signaled when a message is queued
+    CONDITION_VARIABLE QueueNotFull;  // Signaled when the messages are dequeued
+    CHAR *             Queue;         // Queue of the messages (circular)
+    CHAR *             WriteBuffer;   // Buffer of the messages that are written together
+    UINT32             QueueHead;     // Offset of the first queued byte
+    UINT32             QueueSize;     // Count of the queued bytes
+    BOOLEAN            IsStopping;    // Shows whether the source is closing or not
+    BOOLEAN            IsFailed;      // Shows whether writing to the source is failed or not
+
+    DEBUGGER_EVENT_FORWARDING_STATISTICS Statistics;
+
 } DEBUGGER_EVENT_FORWARDING, *PDEBUGGER_EVENT_FORWARDING;
 
 //////////////////////////////////////////
@@ -93,11 +178,43 @@ ForwardingCreateOutputSource(DEBUGGER_EVENT_FORWARDING_TYPE SourceType,
                              string                         Description,
                              SOCKET *                       Socket);
 
+PDEBUGGER_EVENT_FORWARDING
+ForwardingGetOutputSourceByTag(UINT64 OutputUniqueTag);
+
+BOOLEAN
+ForwardingQueueMessage(PDEBUGGER_EVENT_FORWARDING SourceDescriptor,
+                       CHAR *                     Message,
+                       UINT32                     MessageLength);
+
 BOOLEAN
 ForwardingPerformEventForwarding(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetail,
                                  CHAR *                         Message,
                                  UINT32                         MessageLength);
 
+VOID
+ForwardingQueueWrite(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, PVOID Buffer, UINT32 Length);
+
+VOID
+ForwardingQueuePeek(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, PVOID Buffer, UINT32 Length);
+
+VOID
+ForwardingQueueRead(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, PVOID Buffer, UINT32 Length);
+
+VOID
+ForwardingQueueDiscard(PDEBUGGER_EVENT_FORWARDING SourceDescriptor);
+
+BOOLEAN
+ForwardingWriteToOutputSource(PDEBUGGER_EVENT_FORWARDING SourceDescriptor, CHAR * Buffer, UINT32 Length);
+
+DWORD WINAPI
+ForwardingWriterThread(LPVOID Parameter);
+
+BOOLEAN
+ForwardingStartWriterThread(PDEBUGGER_EVENT_FORWARDING SourceDescriptor);
+
+VOID
+ForwardingStopWriterThread(PDEBUGGER_EVENT_FORWARDING SourceDescriptor);
+
 BOOLEAN
 ForwardingWriteToFile(HANDLE FileHandle, CHAR * Message, UINT32 MessageLength);
 
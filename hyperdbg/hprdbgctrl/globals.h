@@ -223,6 +223,25 @@ DEBUGGER_EVENT_AND_ACTION_REG_BUFFER g_DebuggeeResultOfRegisteringEvent = {0};
 DEBUGGER_EVENT_AND_ACTION_REG_BUFFER g_DebuggeeResultOfAddingActionsToEvent = {
     0};
 
+/**
+ * @brief Holds the result of multi-pattern search from the remote debuggee
+ *
+ */
+BYTE g_DebuggeeResultOfMultiPatternSearch[DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE] = {0};
+
+/**
+ * @brief Holds the result of scatter-gather read from the remote debuggee
+ *
+ */
+BYTE g_DebuggeeResultOfScatterGatherRead[DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE] = {0};
+
+/**
+ * @brief Holds the result of registering a batch of events from the
+ * remote debuggee
+ *
+ */
+BYTE g_DebuggeeResultOfRegisteringEventsBatch[MaximumEventsBatchSizeOverSerial] = {0};
+
 /**
  * @brief This is an OVERLAPPED structure for managing simultaneous
  * read and writes for debugger (in current design debuggee is not needed
@@ -306,6 +325,13 @@ BOOLEAN g_EventTraceInitialized = FALSE;
  */
 LIST_ENTRY g_EventTrace = {0};
 
+/**
+ * @brief The events that are collected by '.script batch' and are
+ * registered together after parsing the script file
+ *
+ */
+DEBUGGER_EVENT_BATCH g_EventBatch;
+
 /**
  * @brief it shows whether the debugger started using
  * output sources or not or in other words, is g_OutputSources
@@ -323,6 +349,13 @@ BOOLEAN g_OutputSourcesInitialized = FALSE;
  */
 LIST_ENTRY g_OutputSources = {0};
 
+/**
+ * @brief The output sources indexed by their tags (minus the
+ * start seed of the tags)
+ *
+ */
+PDEBUGGER_EVENT_FORWARDING g_OutputSourcesIndex[EVENT_FORWARDING_MAXIMUM_SOURCES] = {0};
+
 /**
  * @brief Holds the location driver to install it
  *
@@ -344,6 +377,20 @@ TCHAR g_TestLocation[MAX_PATH] = {0};
  */
 Callback g_MessageHandler = 0;
 
+/**
+ * @brief The buffered output of ShowMessages for the commands
+ * that are executed on the current thread
+ *
+ */
+thread_local OUTPUT_SINK g_OutputSink = {0};
+
+/**
+ * @brief Counters of the messages, bytes and packets that
+ * are delivered by ShowMessages
+ *
+ */
+OUTPUT_SINK_STATISTICS g_OutputSinkStatistics = {0};
+
 /**
  * @brief Shows whether the vmxoff process start or not
  *
@@ -448,6 +495,14 @@ BOOLEAN g_AutoUnpause = TRUE;
  */
 BOOLEAN g_AutoFlush = FALSE;
 
+/**
+ * @brief Whether the output of commands is buffered before sending
+ * it to the remote debugger, log file and message handler or not
+ * @details it is enabled by default
+ *
+ */
+BOOLEAN g_OutputBuffering = TRUE;
+
 /**
  * @brief Shows the syntax used in !u !u2 u u2 commands
  * @details INTEL = 1, ATT = 2, MASM = 3
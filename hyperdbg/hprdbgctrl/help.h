@@ -21,6 +21,9 @@ CommandHelpHelp();
 VOID
 CommandReadMemoryAndDisassemblerHelp();
 
+VOID
+CommandReadMemoryLinkedListHelp();
+
 VOID
 CommandConnectHelp();
 
@@ -144,6 +147,9 @@ CommandEditMemoryHelp();
 VOID
 CommandSearchMemoryHelp();
 
+VOID
+CommandSearchMemoryMultiPatternHelp();
+
 VOID
 CommandMeasureHelp();
 
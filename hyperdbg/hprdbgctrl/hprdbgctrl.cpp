@@ -31,6 +31,8 @@ extern BOOLEAN    g_IsSerialConnectedToRemoteDebugger;
 extern BOOLEAN    g_IsConnectedToHyperDbgLocally;
 extern LIST_ENTRY g_OutputSources;
 
+extern OUTPUT_SINK_STATISTICS g_OutputSinkStatistics;
+
 /**
  * @brief Set the function callback that will be called if anything received
  * from the kernel
@@ -43,8 +45,49 @@ HyperdbgSetTextMessageCallback(Callback handler)
     g_MessageHandler = handler;
 }
 
+/**
+ * @brief Deliver a formatted message to the remote debugger, the log
+ * file and the message handler
+ *
+ * @param Message null-terminated message
+ * @param Length length of the message (without the null character)
+ * @return VOID
+ */
+VOID
+ShowMessagesDeliver(char * Message, UINT32 Length)
+{
+    InterlockedIncrement64(&g_OutputSinkStatistics.CountOfPackets);
+    InterlockedAdd64(&g_OutputSinkStatistics.CountOfBytes, Length);
+
+    if (g_IsConnectedToRemoteDebugger)
+    {
+        RemoteConnectionSendResultsToHost(Message, Length);
+    }
+    else if (g_IsSerialConnectedToRemoteDebugger)
+    {
+        KdSendUsermodePrints(Message, Length);
+    }
+
+    if (g_LogOpened)
+    {
+        //
+        // .logopen command executed
+        //
+        LogopenSaveToFile(Message);
+    }
+    if (g_MessageHandler != NULL)
+    {
+        //
+        // There is another handler
+        //
+        g_MessageHandler(Message);
+    }
+}
+
 /**
  * @brief Show messages received from kernel driver
+ * @details The output of commands is buffered and delivered on newline
+ * thresholds, a full buffer, end of the command or an explicit flush
  *
  * @param Fmt format string message
  */
@@ -71,41 +114,100 @@ ShowMessages(const char * Fmt, ...)
     int sprintfresult = vsprintf(TempMessage, Fmt, ArgList);
     va_end(ArgList);
 
-    if (sprintfresult != -1)
+    //
+    // vsprintf_s and vswprintf_s return the number of characters written,
+    // not including the terminating null character, or a negative value
+    // if an output error occurs.
+    //
+    if (sprintfresult > 0)
     {
-        if (g_IsConnectedToRemoteDebugger)
-        {
-            //
-            // vsprintf_s and vswprintf_s return the number of characters written,
-            // not including the terminating null character, or a negative value
-            // if an output error occurs.
-            //
-            RemoteConnectionSendResultsToHost(TempMessage, sprintfresult);
-        }
-        else if (g_IsSerialConnectedToRemoteDebugger)
+        ShowMessagesOutput(TempMessage, sprintfresult);
+    }
+}
+
+#if !UseDbgPrintInsteadOfUsermodeMessageTracking
+
+/**
+ * @brief Send a message of an event to the output sources of the
+ * event or show it if the event has no output source
+ *
+ * @param Tag The tag of the event (the operation code of the message)
+ * @param Message The message (the text or an event record)
+ * @param MessageLength Length of the message
+ */
+VOID
+ReadIrpBasedBufferDeliverEventMessage(UINT32 Tag, CHAR * Message, UINT32 MessageLength)
+{
+    BOOLEAN                OutputSourceFound = FALSE;
+    PLIST_ENTRY            TempList;
+    PDEBUGGER_EVENT_RECORD EventRecord;
+    CHAR                   EventRecordText[PacketChunkSize];
+
+    //
+    // Check if there are available output sources
+    //
+    if (g_OutputSourcesInitialized)
+    {
+        //
+        // Now, we should check whether the following flag matches
+        // with an output or not, also this is not where we want to
+        // check output resources
+        //
+        TempList = &g_EventTrace;
+        while (&g_EventTrace != TempList->Blink)
         {
-            KdSendUsermodePrints(TempMessage, sprintfresult);
+            TempList = TempList->Blink;
+
+            PDEBUGGER_GENERAL_EVENT_DETAIL EventDetail = CONTAINING_RECORD(
+                TempList,
+                DEBUGGER_GENERAL_EVENT_DETAIL,
+                CommandsEventList);
+
+            if (EventDetail->HasCustomOutput &&
+                (UINT32)EventDetail->Tag == Tag)
+            {
+                //
+                // Output source found
+                //
+                OutputSourceFound = TRUE;
+
+                //
+                // Send the event to output sources
+                //
+                if (!ForwardingPerformEventForwarding(EventDetail, Message, MessageLength))
+                {
+                    ShowMessages("err, there was an error transferring the "
+                                 "message to the remote sources\n");
+                }
+
+                break;
+            }
         }
+    }
 
-        if (g_LogOpened)
+    //
+    // Show the message if the source not found
+    //
+    if (!OutputSourceFound)
+    {
+        //
+        // The event records are shown as text (e.g., the
+        // event is removed before receiving its messages)
+        //
+        EventRecord = RecordsGetEventRecord(Message, MessageLength);
+
+        if (EventRecord != NULL)
         {
-            //
-            // .logopen command executed
-            //
-            LogopenSaveToFile(TempMessage);
+            RecordsToText(EventRecord, EventRecordText, sizeof(EventRecordText));
+            SymbolShowMessageWithSymbols(EventRecordText);
         }
-        if (g_MessageHandler != NULL)
+        else
         {
-            //
-            // There is another handler
-            //
-            g_MessageHandler(TempMessage);
+            SymbolShowMessageWithSymbols(Message);
         }
     }
 }
 
-#if !UseDbgPrintInsteadOfUsermodeMessageTracking
-
 /**
  * @brief Read kernel buffers using IRP Pending
  *
@@ -120,8 +222,7 @@ ReadIrpBasedBuffer()
     UINT32                 OperationCode;
     DWORD                  ErrorNum;
     HANDLE                 Handle;
-    BOOLEAN                OutputSourceFound;
-    PLIST_ENTRY            TempList;
+    PDEBUGGER_EVENT_RECORD EventRecord;
 
     RegisterEvent.hEvent = NULL;
     RegisterEvent.Type   = IRP_BASED;
@@ -230,7 +331,7 @@ ReadIrpBasedBuffer()
                         continue;
                     }
 
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
+                    SymbolShowMessageWithSymbols(OutputBuffer + sizeof(UINT32));
 
                     break;
                 case OPERATION_LOG_INFO_MESSAGE:
@@ -244,7 +345,7 @@ ReadIrpBasedBuffer()
                         continue;
                     }
 
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
+                    SymbolShowMessageWithSymbols(OutputBuffer + sizeof(UINT32));
 
                     break;
                 case OPERATION_LOG_ERROR_MESSAGE:
@@ -257,7 +358,7 @@ ReadIrpBasedBuffer()
                         continue;
                     }
 
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
+                    SymbolShowMessageWithSymbols(OutputBuffer + sizeof(UINT32));
 
                     break;
                 case OPERATION_LOG_WARNING_MESSAGE:
@@ -271,7 +372,7 @@ ReadIrpBasedBuffer()
                         continue;
                     }
 
-                    ShowMessages("%s", OutputBuffer + sizeof(UINT32));
+                    SymbolShowMessageWithSymbols(OutputBuffer + sizeof(UINT32));
 
                     break;
 
@@ -303,6 +404,14 @@ ReadIrpBasedBuffer()
 
                     break;
 
+                case OPERATION_DEBUGGEE_REGISTER_EVENTS_BATCH:
+
+                    KdRegisterEventsBatchInDebuggee(
+                        (PDEBUGGER_EVENTS_BATCH)(OutputBuffer + sizeof(UINT32)),
+                        ReturnedLength);
+
+                    break;
+
                 case OPERATION_DEBUGGEE_CLEAR_EVENTS:
 
                     KdSendModifyEventInDebuggee(
@@ -326,7 +435,7 @@ ReadIrpBasedBuffer()
                     //
                     break;
 
-                default:
+                case OPERATION_LOG_NON_IMMEDIATE_EVENT_RECORDS:
 
                     if (g_BreakPrintingOutput)
                     {
@@ -338,61 +447,35 @@ ReadIrpBasedBuffer()
                     }
 
                     //
-                    // Set output source to not found
+                    // The buffered records of the events, each of them is
+                    // sent to the output sources of its own event
                     //
-                    OutputSourceFound = FALSE;
+                    for (UINT32 Offset = 0;
+                         (EventRecord = RecordsGetEventRecord(OutputBuffer + sizeof(UINT32) + Offset,
+                                                              ReturnedLength - sizeof(UINT32) - Offset)) != NULL;
+                         Offset += EventRecord->Length)
+                    {
+                        ReadIrpBasedBufferDeliverEventMessage((UINT32)EventRecord->Tag,
+                                                              (CHAR *)EventRecord,
+                                                              EventRecord->Length);
+                    }
 
-                    //
-                    // Check if there are available output sources
-                    //
-                    if (g_OutputSourcesInitialized)
+                    break;
+
+                default:
+
+                    if (g_BreakPrintingOutput)
                     {
                         //
-                        // Now, we should check whether the following flag matches
-                        // with an output or not, also this is not where we want to
-                        // check output resources
+                        // means that the user asserts a CTRL+C or CTRL+BREAK Signal
+                        // we shouldn't show or save anything in this case
                         //
-                        TempList = &g_EventTrace;
-                        while (&g_EventTrace != TempList->Blink)
-                        {
-                            TempList = TempList->Blink;
-
-                            PDEBUGGER_GENERAL_EVENT_DETAIL EventDetail = CONTAINING_RECORD(
-                                TempList,
-                                DEBUGGER_GENERAL_EVENT_DETAIL,
-                                CommandsEventList);
-
-                            if (EventDetail->HasCustomOutput)
-                            {
-                                //
-                                // Output source found
-                                //
-                                OutputSourceFound = TRUE;
-
-                                //
-                                // Send the event to output sources
-                                //
-                                if (!ForwardingPerformEventForwarding(
-                                        EventDetail,
-                                        OutputBuffer + sizeof(UINT32),
-                                        ReturnedLength - sizeof(UINT32) + 1))
-                                {
-                                    ShowMessages("err, there was an error transferring the "
-                                                 "message to the remote sources\n");
-                                }
-
-                                break;
-                            }
-                        }
+                        continue;
                     }
 
-                    //
-                    // Show the message if the source not found
-                    //
-                    if (!OutputSourceFound)
-                    {
-                        ShowMessages("%s", OutputBuffer + sizeof(UINT32));
-                    }
+                    ReadIrpBasedBufferDeliverEventMessage(OperationCode,
+                                                          OutputBuffer + sizeof(UINT32),
+                                                          ReturnedLength - sizeof(UINT32) + 1);
 
                     break;
                 }
@@ -31,10 +31,20 @@ CommandIHelp()
         "(sysrets) and exceptions and page-faults and optionally displays all "
         "registers and flags' resulting values.\n\n");
 
-    ShowMessages("syntax : \ti[r] [count]\n");
+    ShowMessages("syntax : \ti[r] [count] [to address] [ret]\n");
     ShowMessages("\t\te.g : i\n");
     ShowMessages("\t\te.g : ir\n");
     ShowMessages("\t\te.g : ir 1f\n");
+    ShowMessages("\t\te.g : i 1000 to fffff8077356f010\n");
+    ShowMessages("\t\te.g : ir ret\n");
+
+    ShowMessages("\nmore than one instruction is traced on the debuggee and the "
+                 "instructions (and the registers that are changed by each "
+                 "instruction in the case of 'ir') are shown after the trace "
+                 "is finished, the trace stops after [count] instructions "
+                 "(default: %x), before executing [to address] or after "
+                 "executing a return instruction ([ret])\n",
+                 DebuggeeTraceDefaultMaximumSteps);
 }
 
 /**
@@ -47,66 +57,230 @@ CommandIHelp()
 VOID
 CommandI(vector<string> SplittedCommand, string Command)
 {
-    UINT32                           StepCount;
+    UINT32                           StepCount     = 1;
+    BOOLEAN                          SetStepCount  = FALSE;
+    BOOLEAN                          IsNextAddress = FALSE;
     DEBUGGER_REMOTE_STEPPING_REQUEST RequestFormat;
+    DEBUGGEE_TRACE_PACKET            TracePacket = {0};
+    vector<string>                   SplittedCommandCaseSensitive {Split(Command, ' ')};
+    UINT32                           IndexInCommandCaseSensitive = 0;
 
     //
     // Validate the commands
     //
-    if (SplittedCommand.size() != 1 && SplittedCommand.size() != 2)
+    if (SplittedCommand.size() > 5)
     {
         ShowMessages("incorrect use of 'i'\n\n");
         CommandIHelp();
         return;
     }
 
-    //
-    // Set type of step
-    //
-    RequestFormat = DEBUGGER_REMOTE_STEPPING_REQUEST_STEP_IN_INSTRUMENT;
-
-    //
-    // Check if the command has a counter parameter
-    //
-    if (SplittedCommand.size() == 2)
+    for (auto Section : SplittedCommand)
     {
-        if (!ConvertStringToUInt32(SplittedCommand.at(1), &StepCount))
+        IndexInCommandCaseSensitive++;
+
+        //
+        // Ignore the first argument as it's the command string itself (i or ir)
+        //
+        if (IndexInCommandCaseSensitive == 1)
+        {
+            continue;
+        }
+
+        if (IsNextAddress)
+        {
+            if (!SymbolConvertNameToAddress(SplittedCommandCaseSensitive.at(IndexInCommandCaseSensitive - 1),
+                                            &TracePacket.StopAddress))
+            {
+                ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                             SplittedCommandCaseSensitive.at(IndexInCommandCaseSensitive - 1).c_str());
+                CommandIHelp();
+                return;
+            }
+
+            IsNextAddress = FALSE;
+            continue;
+        }
+
+        if (!Section.compare("to"))
+        {
+            IsNextAddress = TRUE;
+            continue;
+        }
+
+        if (!Section.compare("ret"))
+        {
+            TracePacket.StopOnReturn = TRUE;
+            continue;
+        }
+
+        //
+        // Check if the command has a counter parameter
+        //
+        if (SetStepCount || !ConvertStringToUInt32(Section, &StepCount))
         {
             ShowMessages("please specify a correct hex value for [count]\n\n");
             CommandIHelp();
             return;
         }
+
+        SetStepCount = TRUE;
     }
-    else
+
+    if (IsNextAddress)
     {
-        StepCount = 1;
+        ShowMessages("please specify a correct hex value as the address\n\n");
+        CommandIHelp();
+        return;
     }
 
     //
     // Check if the remote serial debuggee is paused or not
     //
-    if (g_IsSerialConnectedToRemoteDebuggee)
+    if (!g_IsSerialConnectedToRemoteDebuggee)
+    {
+        ShowMessages("err, stepping (i) is not valid in the current context, you "
+                     "should connect to a debuggee\n");
+        return;
+    }
+
+    if (StepCount == 1 && TracePacket.StopAddress == NULL && !TracePacket.StopOnReturn)
     {
-        for (size_t i = 0; i < StepCount; i++)
+        //
+        // Set type of step
+        //
+        RequestFormat = DEBUGGER_REMOTE_STEPPING_REQUEST_STEP_IN_INSTRUMENT;
+
+        KdSendStepPacketToDebuggee(RequestFormat);
+
+        if (!SplittedCommand.at(0).compare("ir"))
         {
-            KdSendStepPacketToDebuggee(RequestFormat);
+            //
+            // Show registers
+            //
+            ShowAllRegisters();
+        }
+    }
+    else
+    {
+        //
+        // Trace the instructions on the debuggee, the records are
+        // shown once they're received
+        //
+        TracePacket.StepType        = DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT;
+        TracePacket.CountOfSteps    = SetStepCount ? StepCount : 0;
+        TracePacket.RecordRegisters = !SplittedCommand.at(0).compare("ir");
 
-            if (!SplittedCommand.at(0).compare("ir"))
+        KdSendTracePacketToDebuggee(&TracePacket);
+    }
+}
+
+/**
+ * @brief Show the records of the instructions that are traced by
+ * the debuggee
+ *
+ * @param RecordsPacket The packet of the records
+ * @param Length Length of the packet
+ *
+ * @return VOID
+ */
+VOID
+CommandIShowTraceRecords(PDEBUGGEE_TRACE_RECORDS_PACKET RecordsPacket, UINT32 Length)
+{
+    DEBUGGEE_TRACE_RECORD Record;
+    UINT64                Value;
+    BYTE *                Records = (BYTE *)RecordsPacket + sizeof(DEBUGGEE_TRACE_RECORDS_PACKET);
+    UINT32                Size    = RecordsPacket->Size;
+    UINT32                Offset  = 0;
+    const char *          RegisterNames[DEBUGGEE_TRACE_COUNT_OF_REGISTERS] =
+        {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "rflags"};
+
+    if (Length < sizeof(DEBUGGEE_TRACE_RECORDS_PACKET))
+    {
+        return;
+    }
+
+    if (Size > Length - sizeof(DEBUGGEE_TRACE_RECORDS_PACKET))
+    {
+        Size = Length - sizeof(DEBUGGEE_TRACE_RECORDS_PACKET);
+    }
+
+    for (UINT32 i = 0; i < RecordsPacket->CountOfRecords; i++)
+    {
+        //
+        // Decode the record and the instruction
+        //
+        if (Offset + sizeof(DEBUGGEE_TRACE_RECORD) > Size)
+        {
+            break;
+        }
+
+        memcpy(&Record, Records + Offset, sizeof(DEBUGGEE_TRACE_RECORD));
+        Offset += sizeof(DEBUGGEE_TRACE_RECORD);
+
+        if (Offset + Record.InstructionLength > Size)
+        {
+            break;
+        }
+
+        if (Record.Flags & DEBUGGEE_TRACE_RECORD_FLAG_32_BIT)
+        {
+            HyperDbgDisassembler32(Records + Offset, Record.Rip, Record.InstructionLength, 1, FALSE, NULL);
+        }
+        else
+        {
+            HyperDbgDisassembler64(Records + Offset, Record.Rip, Record.InstructionLength, 1, FALSE, NULL);
+        }
+
+        Offset += Record.InstructionLength;
+
+        //
+        // Show the registers that are changed by the instruction
+        //
+        if (Record.ChangedRegisters != 0)
+        {
+            ShowMessages("\t");
+
+            for (UINT32 j = 0; j < DEBUGGEE_TRACE_COUNT_OF_REGISTERS; j++)
             {
-                //
-                // Show registers
-                //
-                ShowAllRegisters();
-                if (i != StepCount - 1)
+                if (!(Record.ChangedRegisters & (1 << j)) || Offset + sizeof(UINT64) > Size)
                 {
-                    ShowMessages("\n");
+                    continue;
                 }
+
+                memcpy(&Value, Records + Offset, sizeof(UINT64));
+                Offset += sizeof(UINT64);
+
+                ShowMessages(" %s=%016llx", RegisterNames[j], Value);
             }
+
+            ShowMessages("\n");
         }
     }
-    else
+
+    //
+    // Show the result of the trace
+    //
+    if (RecordsPacket->IsFinished)
     {
-        ShowMessages("err, stepping (i) is not valid in the current context, you "
-                     "should connect to a debuggee\n");
+        switch (RecordsPacket->StopReason)
+        {
+        case DEBUGGEE_TRACE_STOP_REASON_COUNT_REACHED:
+            ShowMessages("traced %llx instruction(s)\n", RecordsPacket->CountOfSteps);
+            break;
+
+        case DEBUGGEE_TRACE_STOP_REASON_ADDRESS_REACHED:
+            ShowMessages("traced %llx instruction(s), the address is reached\n", RecordsPacket->CountOfSteps);
+            break;
+
+        case DEBUGGEE_TRACE_STOP_REASON_RETURN_EXECUTED:
+            ShowMessages("traced %llx instruction(s), a return instruction is executed\n", RecordsPacket->CountOfSteps);
+            break;
+
+        default:
+            ShowMessages("traced %llx instruction(s), the debuggee is halted before finishing the trace\n",
+                         RecordsPacket->CountOfSteps);
+            break;
+        }
     }
 }
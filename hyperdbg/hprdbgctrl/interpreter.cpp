@@ -34,14 +34,14 @@ extern string g_ServerPort;
 extern string g_ServerIp;
 
 /**
- * @brief Interpret commands
+ * @brief Interpret and execute a command
  *
  * @param Command The text of command
  * @return int returns return zero if it was successful or non-zero if there was
  * error
  */
 int
-HyperdbgInterpreter(const char * Command)
+HyperdbgInterpreterExecuteCommand(const char * Command)
 {
     string                CommandString(Command);
     BOOLEAN               HelpCommand = FALSE;
@@ -199,12 +199,39 @@ HyperdbgInterpreter(const char * Command)
     //
     if (g_LogOpened && !g_ExecutingScript)
     {
+        //
+        // Deliver the buffered output before the separator
+        //
+        ShowMessagesFlush();
         LogopenSaveToFile("\n");
     }
 
     return 0;
 }
 
+/**
+ * @brief Interpret commands
+ * @details The output of the command is buffered and delivered at once
+ * when the command is finished
+ *
+ * @param Command The text of command
+ * @return int returns return zero if it was successful or non-zero if there was
+ * error
+ */
+int
+HyperdbgInterpreter(const char * Command)
+{
+    int CommandExecutionResult;
+
+    ShowMessagesStartCommand();
+
+    CommandExecutionResult = HyperdbgInterpreterExecuteCommand(Command);
+
+    ShowMessagesFinishCommand();
+
+    return CommandExecutionResult;
+}
+
 /**
  * @brief Show signature of HyperDbg
  *
@@ -469,6 +496,12 @@ InitializeCommandsDictionary()
     g_CommandList["u2"]  = {&CommandReadMemoryAndDisassembler,
                            &CommandReadMemoryAndDisassemblerHelp,
                            DEBUGGER_COMMAND_D_AND_U_ATTRIBUTES};
+    g_CommandList["dl"]  = {&CommandReadMemoryLinkedList,
+                           &CommandReadMemoryLinkedListHelp,
+                           DEBUGGER_COMMAND_D_AND_U_ATTRIBUTES};
+    g_CommandList["!dl"] = {&CommandReadMemoryLinkedList,
+                            &CommandReadMemoryLinkedListHelp,
+                            DEBUGGER_COMMAND_D_AND_U_ATTRIBUTES};
 
     g_CommandList["eb"]  = {&CommandEditMemory, &CommandEditMemoryHelp, DEBUGGER_COMMAND_E_ATTRIBUTES};
     g_CommandList["ed"]  = {&CommandEditMemory, &CommandEditMemoryHelp, DEBUGGER_COMMAND_E_ATTRIBUTES};
@@ -483,6 +516,8 @@ InitializeCommandsDictionary()
     g_CommandList["!sb"] = {&CommandSearchMemory, &CommandSearchMemoryHelp, DEBUGGER_COMMAND_S_ATTRIBUTES};
     g_CommandList["!sd"] = {&CommandSearchMemory, &CommandSearchMemoryHelp, DEBUGGER_COMMAND_S_ATTRIBUTES};
     g_CommandList["!sq"] = {&CommandSearchMemory, &CommandSearchMemoryHelp, DEBUGGER_COMMAND_S_ATTRIBUTES};
+    g_CommandList["sm"]  = {&CommandSearchMemoryMultiPattern, &CommandSearchMemoryMultiPatternHelp, DEBUGGER_COMMAND_S_ATTRIBUTES};
+    g_CommandList["!sm"] = {&CommandSearchMemoryMultiPattern, &CommandSearchMemoryMultiPatternHelp, DEBUGGER_COMMAND_S_ATTRIBUTES};
 
     g_CommandList["r"] = {&CommandR, &CommandRHelp, DEBUGGER_COMMAND_R_ATTRIBUTES};
 
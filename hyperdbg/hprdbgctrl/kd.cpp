@@ -24,6 +24,9 @@ extern BOOLEAN                              g_IsConnectedToHyperDbgLocally;
 extern OVERLAPPED                           g_OverlappedIoStructureForReadDebugger;
 extern OVERLAPPED                           g_OverlappedIoStructureForWriteDebugger;
 extern DEBUGGER_EVENT_AND_ACTION_REG_BUFFER g_DebuggeeResultOfRegisteringEvent;
+extern BYTE                                 g_DebuggeeResultOfMultiPatternSearch[DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE];
+extern BYTE                                 g_DebuggeeResultOfScatterGatherRead[DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE];
+extern BYTE                                 g_DebuggeeResultOfRegisteringEventsBatch[MaximumEventsBatchSizeOverSerial];
 extern DEBUGGER_EVENT_AND_ACTION_REG_BUFFER
                g_DebuggeeResultOfAddingActionsToEvent;
 extern BOOLEAN g_IsSerialConnectedToRemoteDebuggee;
@@ -421,6 +424,88 @@ KdSendEditMemoryPacketToDebuggee(PDEBUGGER_EDIT_MEMORY EditMem, UINT32 Size)
     return TRUE;
 }
 
+/**
+ * @brief Send a multi-pattern search packet to the debuggee
+ * @details as this command uses one global variable to transfer the buffers
+ * so should not be called simultaneously
+ *
+ * @param SearchRequest The request followed by the patterns
+ * @param Size Size of the request and the patterns
+ *
+ * @return PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY The result followed by the
+ * found addresses or NULL if the packet is not sent
+ */
+PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY
+KdSendMultiPatternSearchPacketToDebuggee(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest, UINT32 Size)
+{
+    RtlZeroMemory(g_DebuggeeResultOfMultiPatternSearch, sizeof(g_DebuggeeResultOfMultiPatternSearch));
+
+    //
+    // Send the multi-pattern search packet
+    //
+    if (!KdCommandPacketAndBufferToDebuggee(
+            DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MULTI_PATTERN_SEARCH_MEMORY,
+            (CHAR *)SearchRequest,
+            Size))
+    {
+        return NULL;
+    }
+
+    //
+    // Wait until the result of searching received
+    //
+    g_SyncronizationObjectsHandleTable[DEBUGGER_SYNCRONIZATION_OBJECT_MULTI_PATTERN_SEARCH_MEMORY]
+        .IsOnWaitingState = TRUE;
+    WaitForSingleObject(g_SyncronizationObjectsHandleTable
+                            [DEBUGGER_SYNCRONIZATION_OBJECT_MULTI_PATTERN_SEARCH_MEMORY]
+                                .EventHandle,
+                        INFINITE);
+
+    return (PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY)g_DebuggeeResultOfMultiPatternSearch;
+}
+
+/**
+ * @brief Send a scatter-gather read packet to the debuggee
+ * @details as this command uses one global variable to transfer the buffers
+ * so should not be called simultaneously
+ *
+ * @param ReadRequest The request followed by the descriptors
+ * @param Size Size of the request and the descriptors
+ *
+ * @return PDEBUGGER_SCATTER_GATHER_READ_MEMORY The result followed by the
+ * descriptors and the read bytes or NULL if the packet is not sent
+ */
+PDEBUGGER_SCATTER_GATHER_READ_MEMORY
+KdSendScatterGatherReadPacketToDebuggee(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest, UINT32 Size)
+{
+    RtlZeroMemory(g_DebuggeeResultOfScatterGatherRead, sizeof(g_DebuggeeResultOfScatterGatherRead));
+
+    //
+    // Send the scatter-gather read packet
+    //
+    if (!KdCommandPacketAndBufferToDebuggee(
+            DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_SCATTER_GATHER_READ_MEMORY,
+            (CHAR *)ReadRequest,
+            Size))
+    {
+        return NULL;
+    }
+
+    //
+    // Wait until the result of reading received
+    //
+    g_SyncronizationObjectsHandleTable[DEBUGGER_SYNCRONIZATION_OBJECT_SCATTER_GATHER_READ_MEMORY]
+        .IsOnWaitingState = TRUE;
+    WaitForSingleObject(g_SyncronizationObjectsHandleTable
+                            [DEBUGGER_SYNCRONIZATION_OBJECT_SCATTER_GATHER_READ_MEMORY]
+                                .EventHandle,
+                        INFINITE);
+
+    return (PDEBUGGER_SCATTER_GATHER_READ_MEMORY)g_DebuggeeResultOfScatterGatherRead;
+}
+
 /**
  * @brief Send a register event request to the debuggee
  * @details as this command uses one global variable to transfer the buffers
@@ -567,6 +652,47 @@ KdSendAddActionToEventPacketToDebuggee(PDEBUGGER_GENERAL_ACTION GeneralAction,
     return &g_DebuggeeResultOfAddingActionsToEvent;
 }
 
+/**
+ * @brief Send a batch of events and their actions to the debuggee
+ * @details as this command uses one global variable to transfer the buffers
+ * so should not be called simultaneously
+ * @param EventsBatch The batch, its size should not exceed
+ * MaximumEventsBatchSizeOverSerial
+ *
+ * @return PDEBUGGER_EVENTS_BATCH The batch with the result of each entry
+ * or NULL if the packet is not sent
+ */
+PDEBUGGER_EVENTS_BATCH
+KdSendRegisterEventsBatchPacketToDebuggee(PDEBUGGER_EVENTS_BATCH EventsBatch)
+{
+    RtlZeroMemory(g_DebuggeeResultOfRegisteringEventsBatch, sizeof(g_DebuggeeResultOfRegisteringEventsBatch));
+
+    //
+    // Send register events batch packet
+    //
+    if (!KdCommandPacketAndBufferToDebuggee(
+            DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_REGISTER_EVENTS_BATCH,
+            (CHAR *)EventsBatch,
+            EventsBatch->Size))
+    {
+        return NULL;
+    }
+
+    //
+    // Wait until the result of registering received
+    //
+    g_SyncronizationObjectsHandleTable
+        [DEBUGGER_SYNCRONIZATION_OBJECT_REGISTER_EVENTS_BATCH]
+            .IsOnWaitingState = TRUE;
+    WaitForSingleObject(g_SyncronizationObjectsHandleTable
+                            [DEBUGGER_SYNCRONIZATION_OBJECT_REGISTER_EVENTS_BATCH]
+                                .EventHandle,
+                        INFINITE);
+
+    return (PDEBUGGER_EVENTS_BATCH)g_DebuggeeResultOfRegisteringEventsBatch;
+}
+
 /**
  * @brief Sends a change core or '.process pid x' command packet to the debuggee
  * @param GetRemotePid
@@ -892,6 +1018,45 @@ KdSendStepPacketToDebuggee(DEBUGGER_REMOTE_STEPPING_REQUEST StepRequestType)
     return TRUE;
 }
 
+/**
+ * @brief Sends an instrumentation trace packet to the debuggee
+ * @details the records are shown by the listener as soon as they're
+ * received, this function returns when the debuggee is halted again
+ *
+ * @param TracePacket
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdSendTracePacketToDebuggee(PDEBUGGEE_TRACE_PACKET TracePacket)
+{
+    //
+    // Send trace packet to the serial
+    //
+    if (!KdCommandPacketAndBufferToDebuggee(
+            DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGER_TO_DEBUGGEE_EXECUTE_ON_VMX_ROOT,
+            DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MODE_TRACE,
+            (CHAR *)TracePacket,
+            sizeof(DEBUGGEE_TRACE_PACKET)))
+    {
+        return FALSE;
+    }
+
+    //
+    // Wait until the debuggee is halted after the trace
+    //
+    g_SyncronizationObjectsHandleTable
+        [DEBUGGER_SYNCRONIZATION_OBJECT_IS_DEBUGGER_RUNNING]
+            .IsOnWaitingState = TRUE;
+    WaitForSingleObject(
+        g_SyncronizationObjectsHandleTable
+            [DEBUGGER_SYNCRONIZATION_OBJECT_IS_DEBUGGER_RUNNING]
+                .EventHandle,
+        INFINITE);
+
+    return TRUE;
+}
+
 /**
  * @brief Sends a PAUSE packet to the debuggee
  *
@@ -2191,6 +2356,69 @@ KdAddActionToEventInDebuggee(PDEBUGGER_GENERAL_ACTION ActionAddingBuffer,
         TRUE);
 }
 
+/**
+ * @brief Register a batch of events and their actions in the debuggee
+ * @param EventsBatch
+ * @param Length
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+KdRegisterEventsBatchInDebuggee(PDEBUGGER_EVENTS_BATCH EventsBatch,
+                                UINT32                 Length)
+{
+    BOOL  Status;
+    ULONG ReturnedLength;
+
+    if (!g_DeviceHandle)
+    {
+        ShowMessages("handle of the driver not found, probably the driver is not loaded. Did you "
+                     "use 'load' command?\n");
+        return FALSE;
+    }
+
+    //
+    // The received buffer might be larger than the batch
+    //
+    if (EventsBatch->Size < SIZEOF_DEBUGGER_EVENTS_BATCH || EventsBatch->Size > Length)
+    {
+        return FALSE;
+    }
+
+    Length = EventsBatch->Size;
+
+    //
+    // Send IOCTL, the result of each entry is written to the
+    // same buffer
+    //
+    Status =
+        DeviceIoControl(g_DeviceHandle,                       // Handle to device
+                        IOCTL_DEBUGGER_REGISTER_EVENTS_BATCH, // IO Control code
+                        EventsBatch,                          // Input Buffer to driver.
+                        Length,                               // Input buffer length
+                        EventsBatch,                          // Output Buffer from driver.
+                        Length,                               // Length of output buffer in bytes.
+                        &ReturnedLength,                      // Bytes placed in buffer.
+                        NULL                                  // synchronous call
+        );
+
+    if (!Status)
+    {
+        ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+        return FALSE;
+    }
+
+    //
+    // Now that we registered the events (with or without error),
+    // we should send the results back to the debugger
+    //
+    return KdSendGeneralBuffersFromDebuggeeToDebugger(
+        DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_REGISTERING_EVENTS_BATCH,
+        EventsBatch,
+        Length,
+        TRUE);
+}
+
 /**
  * @brief Modify event ioctl in the debuggee
  * @param ModifyEvent
@@ -99,6 +99,12 @@ KdSendReadMemoryPacketToDebuggee(PDEBUGGER_READ_MEMORY);
 BOOLEAN
 KdSendEditMemoryPacketToDebuggee(PDEBUGGER_EDIT_MEMORY EditMem, UINT32 Size);
 
+PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY
+KdSendMultiPatternSearchPacketToDebuggee(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest, UINT32 Size);
+
+PDEBUGGER_SCATTER_GATHER_READ_MEMORY
+KdSendScatterGatherReadPacketToDebuggee(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest, UINT32 Size);
+
 PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER
 KdSendRegisterEventPacketToDebuggee(PDEBUGGER_GENERAL_EVENT_DETAIL Event,
                                     UINT32                         EventBufferLength);
@@ -107,6 +113,9 @@ PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER
 KdSendAddActionToEventPacketToDebuggee(PDEBUGGER_GENERAL_ACTION GeneralAction,
                                        UINT32                   GeneralActionLength);
 
+PDEBUGGER_EVENTS_BATCH
+KdSendRegisterEventsBatchPacketToDebuggee(PDEBUGGER_EVENTS_BATCH EventsBatch);
+
 BOOLEAN
 KdSendSwitchProcessPacketToDebuggee(BOOLEAN GetRemotePid,
                                     UINT32  NewPid);
@@ -127,6 +136,9 @@ KdSendUserInputPacketToDebuggee(const char * Sendbuf, int Len);
 BOOLEAN
 KdSendStepPacketToDebuggee(DEBUGGER_REMOTE_STEPPING_REQUEST StepRequestType);
 
+BOOLEAN
+KdSendTracePacketToDebuggee(PDEBUGGEE_TRACE_PACKET TracePacket);
+
 BYTE
 KdComputeDataChecksum(PVOID Buffer, UINT32 Length);
 
@@ -141,6 +153,10 @@ BOOLEAN
 KdAddActionToEventInDebuggee(PDEBUGGER_GENERAL_ACTION ActionAddingBuffer,
                              UINT32                   Length);
 
+BOOLEAN
+KdRegisterEventsBatchInDebuggee(PDEBUGGER_EVENTS_BATCH EventsBatch,
+                                UINT32                 Length);
+
 BOOLEAN
 KdSendModifyEventInDebuggee(PDEBUGGER_MODIFY_EVENTS ModifyEvent);
 
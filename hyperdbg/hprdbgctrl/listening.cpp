@@ -28,6 +28,9 @@ extern BOOLEAN                              g_SharedEventStatus;
 extern BOOLEAN                              g_IsRunningInstruction32Bit;
 extern ULONG                                g_CurrentRemoteCore;
 extern DEBUGGER_EVENT_AND_ACTION_REG_BUFFER g_DebuggeeResultOfRegisteringEvent;
+extern BYTE                                 g_DebuggeeResultOfMultiPatternSearch[DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE];
+extern BYTE                                 g_DebuggeeResultOfScatterGatherRead[DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE];
+extern BYTE                                 g_DebuggeeResultOfRegisteringEventsBatch[MaximumEventsBatchSizeOverSerial];
 extern DEBUGGER_EVENT_AND_ACTION_REG_BUFFER
     g_DebuggeeResultOfAddingActionsToEvent;
 
@@ -56,6 +59,10 @@ ListeningSerialPortInDebugger()
     PDEBUGGER_EDIT_MEMORY                 EditMemoryPacket;
     PDEBUGGEE_BP_PACKET                   BpPacket;
     PDEBUGGEE_BP_LIST_OR_MODIFY_PACKET    ListOrModifyBreakpointPacket;
+    UINT32                                MultiPatternSearchResultSize;
+    UINT32                                ScatterGatherReadResultSize;
+    UINT32                                EventsBatchResultSize;
+    PDEBUGGEE_TRACE_RECORDS_PACKET        TraceRecordsPacket;
     PGUEST_REGS                           Regs;
     PGUEST_EXTRA_REGISTERS                ExtraRegs;
     unsigned char *                       MemoryBuffer;
@@ -174,7 +181,7 @@ StartAgain:
             //
             if (!g_IgnoreNewLoggingMessages)
             {
-                ShowMessages("%s", MessagePacket->Message);
+                SymbolShowMessageWithSymbols(MessagePacket->Message);
             }
 
             break;
@@ -857,6 +864,106 @@ StartAgain:
 
             break;
 
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_MULTI_PATTERN_SEARCH_MEMORY:
+
+            //
+            // Move the results to the global variable, the command
+            // itself shows the results and continues the search
+            //
+            MultiPatternSearchResultSize = LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET);
+
+            if (MultiPatternSearchResultSize > sizeof(g_DebuggeeResultOfMultiPatternSearch))
+            {
+                MultiPatternSearchResultSize = sizeof(g_DebuggeeResultOfMultiPatternSearch);
+            }
+
+            memcpy(g_DebuggeeResultOfMultiPatternSearch,
+                   ((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET),
+                   MultiPatternSearchResultSize);
+
+            //
+            // Signal the event relating to receiving result of multi-pattern search
+            //
+            g_SyncronizationObjectsHandleTable
+                [DEBUGGER_SYNCRONIZATION_OBJECT_MULTI_PATTERN_SEARCH_MEMORY]
+                    .IsOnWaitingState = FALSE;
+            SetEvent(g_SyncronizationObjectsHandleTable
+                         [DEBUGGER_SYNCRONIZATION_OBJECT_MULTI_PATTERN_SEARCH_MEMORY]
+                             .EventHandle);
+
+            break;
+
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_TRACE_RECORDS:
+
+            TraceRecordsPacket = (DEBUGGEE_TRACE_RECORDS_PACKET *)(((CHAR *)TheActualPacket) +
+                                                                   sizeof(DEBUGGER_REMOTE_PACKET));
+
+            //
+            // Show the traced instructions, the debuggee might send more
+            // records until it's halted
+            //
+            CommandIShowTraceRecords(TraceRecordsPacket, LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET));
+
+            break;
+
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_SCATTER_GATHER_READ_MEMORY:
+
+            //
+            // Move the results to the global variable, the command
+            // itself shows the read bytes
+            //
+            ScatterGatherReadResultSize = LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET);
+
+            if (ScatterGatherReadResultSize > sizeof(g_DebuggeeResultOfScatterGatherRead))
+            {
+                ScatterGatherReadResultSize = sizeof(g_DebuggeeResultOfScatterGatherRead);
+            }
+
+            memcpy(g_DebuggeeResultOfScatterGatherRead,
+                   ((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET),
+                   ScatterGatherReadResultSize);
+
+            //
+            // Signal the event relating to receiving result of scatter-gather read
+            //
+            g_SyncronizationObjectsHandleTable
+                [DEBUGGER_SYNCRONIZATION_OBJECT_SCATTER_GATHER_READ_MEMORY]
+                    .IsOnWaitingState = FALSE;
+            SetEvent(g_SyncronizationObjectsHandleTable
+                         [DEBUGGER_SYNCRONIZATION_OBJECT_SCATTER_GATHER_READ_MEMORY]
+                             .EventHandle);
+
+            break;
+
+        case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_REGISTERING_EVENTS_BATCH:
+
+            //
+            // Move the batch (with the result of each entry) to the
+            // global variable
+            //
+            EventsBatchResultSize = LengthReceived - sizeof(DEBUGGER_REMOTE_PACKET);
+
+            if (EventsBatchResultSize > sizeof(g_DebuggeeResultOfRegisteringEventsBatch))
+            {
+                EventsBatchResultSize = sizeof(g_DebuggeeResultOfRegisteringEventsBatch);
+            }
+
+            memcpy(g_DebuggeeResultOfRegisteringEventsBatch,
+                   ((CHAR *)TheActualPacket) + sizeof(DEBUGGER_REMOTE_PACKET),
+                   EventsBatchResultSize);
+
+            //
+            // Signal the event relating to receiving result of registering the batch
+            //
+            g_SyncronizationObjectsHandleTable
+                [DEBUGGER_SYNCRONIZATION_OBJECT_REGISTER_EVENTS_BATCH]
+                    .IsOnWaitingState = FALSE;
+            SetEvent(g_SyncronizationObjectsHandleTable
+                         [DEBUGGER_SYNCRONIZATION_OBJECT_REGISTER_EVENTS_BATCH]
+                             .EventHandle);
+
+            break;
+
         default:
             ShowMessages("err, unknown packet action received from the debugger\n");
             break;
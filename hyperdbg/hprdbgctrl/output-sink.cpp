@@ -0,0 +1,140 @@
+/**
+ * @file output-sink.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief The buffered output of ShowMessages
+ * @details The output of a command is accumulated per thread and delivered
+ * to the remote debugger, the log file and the message handler in larger
+ * chunks
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+//
+// Global Variables
+//
+extern BOOLEAN g_OutputBuffering;
+
+extern thread_local OUTPUT_SINK g_OutputSink;
+extern OUTPUT_SINK_STATISTICS   g_OutputSinkStatistics;
+
+/**
+ * @brief Deliver the buffered output of the current thread
+ *
+ * @return VOID
+ */
+VOID
+ShowMessagesFlush()
+{
+    if (g_OutputSink.Size == 0 || g_OutputSink.IsFlushing)
+    {
+        return;
+    }
+
+    //
+    // Messages that are shown while delivering the buffer (e.g., errors
+    // of sending the buffer) are delivered directly
+    //
+    g_OutputSink.IsFlushing = TRUE;
+
+    ShowMessagesDeliver(g_OutputSink.Buffer, g_OutputSink.Size);
+
+    g_OutputSink.Size            = 0;
+    g_OutputSink.CountOfNewlines = 0;
+    g_OutputSink.Buffer[0]       = '\0';
+    g_OutputSink.IsFlushing      = FALSE;
+}
+
+/**
+ * @brief Append a formatted message to the buffered output of the
+ * current thread
+ *
+ * @param Message null-terminated message
+ * @param Length length of the message (without the null character)
+ * @return VOID
+ */
+VOID
+ShowMessagesAppendToSink(char * Message, UINT32 Length)
+{
+    //
+    // Flush the buffer if the message doesn't fit in it, the buffer
+    // is as large as the largest formatted message
+    //
+    if (g_OutputSink.Size + Length >= PacketChunkSize)
+    {
+        ShowMessagesFlush();
+    }
+
+    memcpy(&g_OutputSink.Buffer[g_OutputSink.Size], Message, Length);
+    g_OutputSink.Size += Length;
+    g_OutputSink.Buffer[g_OutputSink.Size] = '\0';
+
+    for (UINT32 i = 0; i < Length; i++)
+    {
+        if (Message[i] == '\n')
+        {
+            g_OutputSink.CountOfNewlines++;
+        }
+    }
+
+    if (g_OutputSink.CountOfNewlines >= OUTPUT_SINK_NEWLINE_THRESHOLD)
+    {
+        ShowMessagesFlush();
+    }
+}
+
+/**
+ * @brief Start buffering the output of a command on the current thread
+ *
+ * @return VOID
+ */
+VOID
+ShowMessagesStartCommand()
+{
+    g_OutputSink.CommandDepth++;
+}
+
+/**
+ * @brief Deliver the buffered output of a command that is finished
+ *
+ * @return VOID
+ */
+VOID
+ShowMessagesFinishCommand()
+{
+    g_OutputSink.CommandDepth--;
+
+    //
+    // Nested commands (e.g., commands of a script or commands that are
+    // received by '.listen') also flush their output as the outer command
+    // might never finish
+    //
+    ShowMessagesFlush();
+}
+
+/**
+ * @brief Buffer or deliver a formatted message of ShowMessages
+ * @details Messages that are printed outside of commands (e.g., kernel
+ * messages from the IRP thread) are delivered immediately
+ *
+ * @param Message null-terminated message
+ * @param Length length of the message (without the null character)
+ * @return VOID
+ */
+VOID
+ShowMessagesOutput(char * Message, UINT32 Length)
+{
+    InterlockedIncrement64(&g_OutputSinkStatistics.CountOfMessages);
+
+    if (g_OutputBuffering && g_OutputSink.CommandDepth != 0 && !g_OutputSink.IsFlushing)
+    {
+        ShowMessagesAppendToSink(Message, Length);
+    }
+    else
+    {
+        ShowMessagesDeliver(Message, Length);
+    }
+}
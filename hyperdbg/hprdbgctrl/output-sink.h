@@ -0,0 +1,75 @@
+/**
+ * @file output-sink.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers for the buffered output of ShowMessages
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////
+//              Definitions	            //
+//////////////////////////////////////////
+
+/**
+ * @brief Count of lines that are buffered by ShowMessages before
+ * flushing the output of a command
+ *
+ */
+#define OUTPUT_SINK_NEWLINE_THRESHOLD 32
+
+//////////////////////////////////////////
+//              Structures	            //
+//////////////////////////////////////////
+
+/**
+ * @brief The buffered output of ShowMessages
+ * @details The output of a command is accumulated and delivered to the
+ * remote debugger, the log file and the message handler in larger chunks
+ *
+ */
+typedef struct _OUTPUT_SINK
+{
+    UINT32  CommandDepth;            // Count of the nested commands that are executing
+    BOOLEAN IsFlushing;              // Shows whether the buffer is being delivered or not
+    UINT32  Size;                    // Size of the buffered output
+    UINT32  CountOfNewlines;         // Count of the buffered lines
+    CHAR    Buffer[PacketChunkSize]; // The buffered output (null-terminated)
+} OUTPUT_SINK, *POUTPUT_SINK;
+
+/**
+ * @brief Counters of the output that is delivered by ShowMessages
+ *
+ */
+typedef struct _OUTPUT_SINK_STATISTICS
+{
+    volatile LONG64 CountOfMessages; // Count of the ShowMessages calls
+    volatile LONG64 CountOfBytes;    // Count of the delivered bytes
+    volatile LONG64 CountOfPackets;  // Count of the delivered buffers
+} OUTPUT_SINK_STATISTICS, *POUTPUT_SINK_STATISTICS;
+
+//////////////////////////////////////////
+//              Functions	            //
+//////////////////////////////////////////
+
+VOID
+ShowMessagesDeliver(char * Message, UINT32 Length);
+
+VOID
+ShowMessagesFlush();
+
+VOID
+ShowMessagesAppendToSink(char * Message, UINT32 Length);
+
+VOID
+ShowMessagesStartCommand();
+
+VOID
+ShowMessagesFinishCommand();
+
+VOID
+ShowMessagesOutput(char * Message, UINT32 Length);
@@ -14,8 +14,10 @@
 //
 // Global Variables
 //
-extern LIST_ENTRY g_OutputSources;
-extern BOOLEAN    g_OutputSourcesInitialized;
+extern LIST_ENTRY                 g_OutputSources;
+extern BOOLEAN                    g_OutputSourcesInitialized;
+extern UINT64                     g_OutputSourceTag;
+extern PDEBUGGER_EVENT_FORWARDING g_OutputSourcesIndex[EVENT_FORWARDING_MAXIMUM_SOURCES];
 
 /**
  * @brief help of output command
@@ -29,6 +31,9 @@ CommandOutputHelp()
                  "forwarding.\n\n");
     ShowMessages("syntax : \toutput [create|open|close] [type "
                  "(file|namedpipe|tcp)] [name|address]\n");
+    ShowMessages("syntax : \toutput [policy] [name] [block|drop]\n");
+    ShowMessages("syntax : \toutput [format] [name] [text|binary]\n");
+    ShowMessages("syntax : \toutput [convert] [records file] [json lines file]\n");
     ShowMessages("\t\te.g : output create MyOutputName1 file "
                  "c:\\users\\sina\\desktop\\output.txt\n");
     ShowMessages("\t\te.g : output create MyOutputName2 tcp 192.168.1.10:8080\n");
@@ -36,6 +41,19 @@ CommandOutputHelp()
                  "\\\\.\\Pipe\\HyperDbgOutput\n");
     ShowMessages("\t\te.g : output open MyOutputName1\n");
     ShowMessages("\t\te.g : output close MyOutputName1\n");
+    ShowMessages("\t\te.g : output policy MyOutputName2 drop\n");
+    ShowMessages("\t\te.g : output format MyOutputName1 binary\n");
+    ShowMessages("\t\te.g : output convert c:\\users\\sina\\desktop\\output.bin "
+                 "c:\\users\\sina\\desktop\\output.json\n");
+    ShowMessages("\n");
+    ShowMessages("the messages are queued for each output and are written by a "
+                 "separate thread, if the queue of an output is full, the messages "
+                 "either wait for the output (block, default) or are dropped (drop)\n");
+    ShowMessages("the outputs with the binary format receive the event records (tag, "
+                 "core, process id, thread id, time-stamp counter, and the values "
+                 "and the text of the script), the format should be set before "
+                 "opening the output and 'output convert' converts the saved records "
+                 "to JSON lines\n");
 }
 
 /**
@@ -48,16 +66,19 @@ CommandOutputHelp()
 VOID
 CommandOutput(vector<string> SplittedCommand, string Command)
 {
-    PDEBUGGER_EVENT_FORWARDING     EventForwardingObject;
-    DEBUGGER_EVENT_FORWARDING_TYPE Type;
-    DEBUGGER_OUTPUT_SOURCE_STATUS  Status;
-    string                         DetailsOfSource;
-    UINT32                         IndexToShowList;
-    PLIST_ENTRY                    TempList          = 0;
-    BOOLEAN                        OutputSourceFound = FALSE;
-    HANDLE                         SourceHandle      = INVALID_HANDLE_VALUE;
-    SOCKET                         Socket            = NULL;
-    vector<string>                 SplittedCommandCaseSensitive {Split(Command, ' ')};
+    PDEBUGGER_EVENT_FORWARDING       EventForwardingObject;
+    DEBUGGER_EVENT_FORWARDING_TYPE   Type;
+    DEBUGGER_EVENT_FORWARDING_POLICY Policy;
+    DEBUGGER_EVENT_FORWARDING_FORMAT Format;
+    DEBUGGER_OUTPUT_SOURCE_STATUS    Status;
+    string                           DetailsOfSource;
+    UINT32                           IndexToShowList;
+    UINT64                           CountOfRecords;
+    PLIST_ENTRY                      TempList          = 0;
+    BOOLEAN                          OutputSourceFound = FALSE;
+    HANDLE                           SourceHandle      = INVALID_HANDLE_VALUE;
+    SOCKET                           Socket            = NULL;
+    vector<string>                   SplittedCommandCaseSensitive {Split(Command, ' ')};
 
     //
     // Check if the user needs a list of outputs or not
@@ -115,6 +136,15 @@ CommandOutput(vector<string> SplittedCommand, string Command)
                 }
 
                 ShowMessages("%d  %s   %s\t%s\n", IndexToShowList, TempTypeString.c_str(), TempStateString.c_str(), CurrentOutputSourceDetails->Name);
+                ShowMessages("\t%s, %s, queued : %lld, dropped : %lld, writes : %lld, "
+                             "bytes : %lld, failed writes : %lld\n",
+                             CurrentOutputSourceDetails->Policy == EVENT_FORWARDING_POLICY_DROP ? "drop " : "block",
+                             CurrentOutputSourceDetails->Format == EVENT_FORWARDING_FORMAT_BINARY ? "binary" : "text  ",
+                             CurrentOutputSourceDetails->Statistics.CountOfQueuedMessages,
+                             CurrentOutputSourceDetails->Statistics.CountOfDroppedMessages,
+                             CurrentOutputSourceDetails->Statistics.CountOfWrites,
+                             CurrentOutputSourceDetails->Statistics.CountOfWrittenBytes,
+                             CurrentOutputSourceDetails->Statistics.CountOfFailedWrites);
             }
         }
         else
@@ -229,6 +259,17 @@ CommandOutput(vector<string> SplittedCommand, string Command)
             }
         }
 
+        //
+        // The sources are indexed by their tags, so the count of
+        // sources is limited
+        //
+        if (g_OutputSourceTag - DebuggerOutputSourceTagStartSeed >= EVENT_FORWARDING_MAXIMUM_SOURCES)
+        {
+            ShowMessages("err, maximum number of outputs (%d) is reached.\n\n",
+                         EVENT_FORWARDING_MAXIMUM_SOURCES);
+            return;
+        }
+
         //
         // try to open the source and get the handle
         //
@@ -309,6 +350,12 @@ CommandOutput(vector<string> SplittedCommand, string Command)
         //
         InsertHeadList(&g_OutputSources,
                        &(EventForwardingObject->OutputSourcesList));
+
+        //
+        // Add the source to the index of the tags
+        //
+        g_OutputSourcesIndex[EventForwardingObject->OutputUniqueTag - DebuggerOutputSourceTagStartSeed] =
+            EventForwardingObject;
     }
     else if (!SplittedCommand.at(1).compare("open"))
     {
@@ -447,6 +494,195 @@ CommandOutput(vector<string> SplittedCommand, string Command)
             return;
         }
     }
+    else if (!SplittedCommand.at(1).compare("policy"))
+    {
+        //
+        // It's a policy
+        //
+        if (SplittedCommand.size() != 4)
+        {
+            ShowMessages("incorrect use of 'output'\n\n");
+            CommandOutputHelp();
+            return;
+        }
+
+        if (!SplittedCommand.at(3).compare("block"))
+        {
+            Policy = EVENT_FORWARDING_POLICY_BLOCK;
+        }
+        else if (!SplittedCommand.at(3).compare("drop"))
+        {
+            Policy = EVENT_FORWARDING_POLICY_DROP;
+        }
+        else
+        {
+            ShowMessages("incorrect policy near '%s'\n\n",
+                         SplittedCommand.at(3).c_str());
+            CommandOutputHelp();
+            return;
+        }
+
+        if (!g_OutputSourcesInitialized)
+        {
+            ShowMessages("err, the name you entered, not found.\n\n");
+            return;
+        }
+
+        TempList = &g_OutputSources;
+
+        while (&g_OutputSources != TempList->Flink)
+        {
+            TempList = TempList->Flink;
+
+            PDEBUGGER_EVENT_FORWARDING CurrentOutputSourceDetails = CONTAINING_RECORD(
+                TempList,
+                DEBUGGER_EVENT_FORWARDING,
+                OutputSourcesList);
+
+            if (strcmp(CurrentOutputSourceDetails->Name,
+                       SplittedCommandCaseSensitive.at(2).c_str()) == 0)
+            {
+                //
+                // Indicate that we found this item
+                //
+                OutputSourceFound = TRUE;
+
+                //
+                // The policy is checked when the queue is full, so it
+                // can be changed while the output is opened
+                //
+                CurrentOutputSourceDetails->Policy = Policy;
+
+                //
+                // No need to search through the list anymore
+                //
+                break;
+            }
+        }
+
+        if (!OutputSourceFound)
+        {
+            ShowMessages("err, the name you entered, not found.\n\n");
+            return;
+        }
+    }
+    else if (!SplittedCommand.at(1).compare("format"))
+    {
+        //
+        // It's a format
+        //
+        if (SplittedCommand.size() != 4)
+        {
+            ShowMessages("incorrect use of 'output'\n\n");
+            CommandOutputHelp();
+            return;
+        }
+
+        if (!SplittedCommand.at(3).compare("text"))
+        {
+            Format = EVENT_FORWARDING_FORMAT_TEXT;
+        }
+        else if (!SplittedCommand.at(3).compare("binary"))
+        {
+            Format = EVENT_FORWARDING_FORMAT_BINARY;
+        }
+        else
+        {
+            ShowMessages("incorrect format near '%s'\n\n",
+                         SplittedCommand.at(3).c_str());
+            CommandOutputHelp();
+            return;
+        }
+
+        if (!g_OutputSourcesInitialized)
+        {
+            ShowMessages("err, the name you entered, not found.\n\n");
+            return;
+        }
+
+        TempList = &g_OutputSources;
+
+        while (&g_OutputSources != TempList->Flink)
+        {
+            TempList = TempList->Flink;
+
+            PDEBUGGER_EVENT_FORWARDING CurrentOutputSourceDetails = CONTAINING_RECORD(
+                TempList,
+                DEBUGGER_EVENT_FORWARDING,
+                OutputSourcesList);
+
+            if (strcmp(CurrentOutputSourceDetails->Name,
+                       SplittedCommandCaseSensitive.at(2).c_str()) == 0)
+            {
+                //
+                // Indicate that we found this item
+                //
+                OutputSourceFound = TRUE;
+
+                //
+                // The binary streams start with a header that is written
+                // when the output is opened, so the format cannot be
+                // changed after that
+                //
+                if (CurrentOutputSourceDetails->State != EVENT_FORWARDING_STATE_NOT_OPENED)
+                {
+                    ShowMessages("err, the format can only be changed before opening "
+                                 "the output.\n\n");
+                    return;
+                }
+
+                CurrentOutputSourceDetails->Format = Format;
+
+                //
+                // No need to search through the list anymore
+                //
+                break;
+            }
+        }
+
+        if (!OutputSourceFound)
+        {
+            ShowMessages("err, the name you entered, not found.\n\n");
+            return;
+        }
+    }
+    else if (!SplittedCommand.at(1).compare("convert"))
+    {
+        //
+        // It's a convert (of a saved binary output to JSON lines)
+        //
+        if (SplittedCommand.size() != 4)
+        {
+            ShowMessages("incorrect use of 'output'\n\n");
+            CommandOutputHelp();
+            return;
+        }
+
+        ifstream RecordsFile(SplittedCommandCaseSensitive.at(2).c_str(), ios::binary);
+
+        if (!RecordsFile.is_open())
+        {
+            ShowMessages("err, unable to open the records file.\n\n");
+            return;
+        }
+
+        ofstream JsonFile(SplittedCommandCaseSensitive.at(3).c_str(), ios::binary);
+
+        if (!JsonFile.is_open())
+        {
+            ShowMessages("err, unable to create the JSON lines file.\n\n");
+            return;
+        }
+
+        if (!RecordsConvertToJsonLines(RecordsFile, JsonFile, &CountOfRecords))
+        {
+            ShowMessages("err, invalid records file, %lld record(s) converted.\n\n",
+                         CountOfRecords);
+            return;
+        }
+
+        ShowMessages("%lld record(s) converted.\n", CountOfRecords);
+    }
     else
     {
         //
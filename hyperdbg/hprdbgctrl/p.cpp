@@ -31,6 +31,11 @@ CommandPHelp()
     ShowMessages("\t\te.g : p\n");
     ShowMessages("\t\te.g : pr\n");
     ShowMessages("\t\te.g : pr 1f\n");
+
+    ShowMessages("\nif [count] is more than one, the instructions are traced on "
+                 "the debuggee and the instructions (and the registers that are "
+                 "changed by each instruction in the case of 'pr') are shown "
+                 "after the trace is finished\n");
 }
 
 /**
@@ -45,6 +50,7 @@ CommandP(vector<string> SplittedCommand, string Command)
 {
     UINT32                           StepCount;
     DEBUGGER_REMOTE_STEPPING_REQUEST RequestFormat;
+    DEBUGGEE_TRACE_PACKET            TracePacket = {0};
 
     //
     // Validate the commands
@@ -83,15 +89,8 @@ CommandP(vector<string> SplittedCommand, string Command)
     //
     if (g_IsSerialConnectedToRemoteDebuggee)
     {
-        for (size_t i = 0; i < StepCount; i++)
+        if (StepCount == 1)
         {
-            //
-            // For logging purpose
-            //
-            // ShowMessages("percentage : %f %% (%x)\n", 100.0 * (i /
-            //   (float)StepCount), i);
-            //
-
             KdSendStepPacketToDebuggee(RequestFormat);
 
             if (!SplittedCommand.at(0).compare("pr"))
@@ -100,12 +99,21 @@ CommandP(vector<string> SplittedCommand, string Command)
                 // Show registers
                 //
                 ShowAllRegisters();
-                if (i != StepCount - 1)
-                {
-                    ShowMessages("\n");
-                }
             }
         }
+        else if (StepCount != 0)
+        {
+            //
+            // Trace the instructions on the debuggee instead of sending a
+            // step packet for each instruction, the records are shown once
+            // they're received
+            //
+            TracePacket.StepType        = DEBUGGEE_TRACE_STEP_TYPE_STEP_OVER;
+            TracePacket.CountOfSteps    = StepCount;
+            TracePacket.RecordRegisters = !SplittedCommand.at(0).compare("pr");
+
+            KdSendTracePacketToDebuggee(&TracePacket);
+        }
     }
     else
     {
@@ -24,6 +24,16 @@
 #ifndef PCH_H
 #    define PCH_H
 
+#    ifdef HYPERDBG_UNIT_TESTS
+
+//
+// The unit tests build the portable modules on other platforms, so the
+// definitions of Windows are provided by the tests
+//
+#        include "hprdbgctrl-unit-tests.h"
+
+#    else
+
 //
 // add headers that you want to pre-compile here
 //
@@ -77,10 +87,16 @@
 #    include "communication.h"
 #    include "namedpipe.h"
 #    include "forwarding.h"
+#    include "records.h"
+#    include "output-sink.h"
 #    include "kd.h"
 
+#    endif // HYPERDBG_UNIT_TESTS
+
 #endif // PCH_H
 
+#ifndef HYPERDBG_UNIT_TESTS
+
 #pragma comment(lib, "ntdll.lib")
 
 //
@@ -90,3 +106,5 @@
 #pragma comment(lib, "Ws2_32.lib")
 #pragma comment(lib, "Mswsock.lib")
 #pragma comment(lib, "AdvApi32.lib")
+
+#endif // !HYPERDBG_UNIT_TESTS
@@ -117,6 +117,85 @@ HyperDbgReadMemoryAndDisassemble(DEBUGGER_SHOW_MEMORY_STYLE Style,
     ShowMessages("\n");
 }
 
+/**
+ * @brief Read multiple ranges of memory (or the nodes of a list) at once
+ *
+ * @details the request is followed by CountOfDescriptors descriptors and the
+ * buffer should have DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE bytes, the
+ * results are saved in the same buffer
+ *
+ * @param ReadRequest The request followed by the descriptors
+ * @return BOOLEAN
+ */
+BOOLEAN
+HyperDbgReadMemoryScatterGather(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest)
+{
+    BOOL                                 Status;
+    ULONG                                ReturnedLength;
+    PDEBUGGER_SCATTER_GATHER_READ_MEMORY Result;
+    UINT32                               RequestSize;
+
+    if (ReadRequest->CountOfDescriptors > MaximumScatterGatherReadDescriptors)
+    {
+        ShowErrorMessage(DEBUGGER_ERROR_SCATTER_GATHER_READ_INVALID_DESCRIPTORS);
+        return FALSE;
+    }
+
+    RequestSize = SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY +
+                  (ReadRequest->CountOfDescriptors * sizeof(DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR));
+
+    //
+    // send the request
+    //
+    if (g_IsSerialConnectedToRemoteDebuggee)
+    {
+        //
+        // All of the ranges are read by the debuggee in one round trip
+        //
+        Result = KdSendScatterGatherReadPacketToDebuggee(ReadRequest, RequestSize);
+
+        if (Result == NULL)
+        {
+            return FALSE;
+        }
+
+        memcpy(ReadRequest, Result, DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE);
+    }
+    else
+    {
+        if (!g_DeviceHandle)
+        {
+            ShowMessages("handle of the driver not found, probably the driver is not loaded. Did you "
+                         "use 'load' command?\n");
+            return FALSE;
+        }
+
+        Status = DeviceIoControl(g_DeviceHandle,                                  // Handle to device
+                                 IOCTL_DEBUGGER_SCATTER_GATHER_READ_MEMORY,       // IO Control code
+                                 ReadRequest,                                     // Input Buffer to driver.
+                                 RequestSize,                                     // Input buffer length
+                                 ReadRequest,                                     // Output Buffer from driver.
+                                 DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE, // Length of output buffer in bytes.
+                                 &ReturnedLength,                                 // Bytes placed in buffer.
+                                 NULL                                             // synchronous call
+        );
+
+        if (!Status)
+        {
+            ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+            return FALSE;
+        }
+    }
+
+    if (ReadRequest->KernelStatus != DEBUGEER_OPERATION_WAS_SUCCESSFULL)
+    {
+        ShowErrorMessage(ReadRequest->KernelStatus);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 /**
  * @brief Show memory in bytes (DB)
  *
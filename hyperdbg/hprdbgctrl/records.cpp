@@ -0,0 +1,431 @@
+/**
+ * @file records.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Reading and converting the event records
+ * @details The event records are the structured form of the output of
+ * the events (DEBUGGER_EVENT_RECORD), the output sources with the binary
+ * format receive a stream header followed by the records and this file
+ * reads the streams and converts the records to text or JSON lines, it
+ * only uses the standard library so it can be built on other platforms
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Check whether a buffer is a valid event record
+ *
+ * @param Buffer The buffer
+ * @param BufferLength Length of the buffer (might be larger than
+ * the record)
+ * @return PDEBUGGER_EVENT_RECORD the record or NULL if the buffer is
+ * not a valid event record
+ */
+PDEBUGGER_EVENT_RECORD
+RecordsGetEventRecord(PVOID Buffer, UINT32 BufferLength)
+{
+    PDEBUGGER_EVENT_RECORD Record = (PDEBUGGER_EVENT_RECORD)Buffer;
+
+    if (BufferLength < SIZEOF_DEBUGGER_EVENT_RECORD ||
+        Record->Signature != DEBUGGER_EVENT_RECORD_SIGNATURE ||
+        Record->Length > BufferLength ||
+        Record->CountOfValues > DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES ||
+        (UINT64)SIZEOF_DEBUGGER_EVENT_RECORD + Record->CountOfValues * sizeof(UINT64) + Record->TextLength != Record->Length)
+    {
+        return NULL;
+    }
+
+    return Record;
+}
+
+/**
+ * @brief Create an event record from a text message of an event
+ * @details Used for the messages of the events that are not sent as
+ * records (e.g., the results of the custom codes), only the tag of
+ * the record is known
+ *
+ * @param Tag Tag of the event
+ * @param Text The text of the message
+ * @param TextLength Length of the text
+ * @param Buffer The buffer that receives the record
+ * @param BufferLength Length of the buffer
+ * @return UINT32 length of the record (the text is truncated if it
+ * doesn't fit in the buffer)
+ */
+UINT32
+RecordsCreateTextRecord(UINT64 Tag, CHAR * Text, UINT32 TextLength, PVOID Buffer, UINT32 BufferLength)
+{
+    PDEBUGGER_EVENT_RECORD Record = (PDEBUGGER_EVENT_RECORD)Buffer;
+
+    if (BufferLength < SIZEOF_DEBUGGER_EVENT_RECORD)
+    {
+        return 0;
+    }
+
+    if (TextLength > BufferLength - SIZEOF_DEBUGGER_EVENT_RECORD)
+    {
+        TextLength = BufferLength - SIZEOF_DEBUGGER_EVENT_RECORD;
+    }
+
+    memset(Record, 0, SIZEOF_DEBUGGER_EVENT_RECORD);
+
+    Record->Signature  = DEBUGGER_EVENT_RECORD_SIGNATURE;
+    Record->Length     = SIZEOF_DEBUGGER_EVENT_RECORD + TextLength;
+    Record->Kind       = DEBUGGER_EVENT_RECORD_KIND_TEXT;
+    Record->TextLength = TextLength;
+    Record->Tag        = Tag;
+
+    memcpy((CHAR *)Buffer + SIZEOF_DEBUGGER_EVENT_RECORD, Text, TextLength);
+
+    return Record->Length;
+}
+
+/**
+ * @brief Copy an event record with a different text
+ * @details Used for converting the marked addresses of the text to
+ * their symbols before the record is forwarded
+ *
+ * @param Record The event record
+ * @param Text The new text of the record
+ * @param TextLength Length of the new text
+ * @param Buffer The buffer that receives the record
+ * @param BufferLength Length of the buffer
+ * @return UINT32 length of the new record (the text is truncated if it
+ * doesn't fit in the buffer)
+ */
+UINT32
+RecordsReplaceText(PDEBUGGER_EVENT_RECORD Record, const CHAR * Text, UINT32 TextLength, PVOID Buffer, UINT32 BufferLength)
+{
+    PDEBUGGER_EVENT_RECORD NewRecord    = (PDEBUGGER_EVENT_RECORD)Buffer;
+    UINT32                 HeaderLength = SIZEOF_DEBUGGER_EVENT_RECORD + Record->CountOfValues * sizeof(UINT64);
+
+    if (BufferLength < HeaderLength)
+    {
+        return 0;
+    }
+
+    if (TextLength > BufferLength - HeaderLength)
+    {
+        TextLength = BufferLength - HeaderLength;
+    }
+
+    memcpy(NewRecord, Record, HeaderLength);
+    memcpy((CHAR *)Buffer + HeaderLength, Text, TextLength);
+
+    NewRecord->Length     = HeaderLength + TextLength;
+    NewRecord->TextLength = TextLength;
+
+    return NewRecord->Length;
+}
+
+/**
+ * @brief Convert an event record to the text that the script
+ * function shows
+ *
+ * @param Record The event record
+ * @param Buffer The buffer that receives the text (null-terminated)
+ * @param BufferLength Length of the buffer
+ * @return UINT32 length of the text
+ */
+UINT32
+RecordsToText(PDEBUGGER_EVENT_RECORD Record, CHAR * Buffer, UINT32 BufferLength)
+{
+    UINT64 * Values = (UINT64 *)((CHAR *)Record + SIZEOF_DEBUGGER_EVENT_RECORD);
+    CHAR *   Text   = (CHAR *)Values + Record->CountOfValues * sizeof(UINT64);
+    UINT32   Length = 0;
+    int      Result;
+
+    if (BufferLength == 0)
+    {
+        return 0;
+    }
+
+    switch (Record->Kind)
+    {
+    case DEBUGGER_EVENT_RECORD_KIND_PRINT:
+    case DEBUGGER_EVENT_RECORD_KIND_FORMATS:
+
+        if (Record->CountOfValues != 0)
+        {
+            Result = snprintf(Buffer,
+                              BufferLength,
+                              Record->Kind == DEBUGGER_EVENT_RECORD_KIND_PRINT ? "%llx" : "%llx\n",
+                              (unsigned long long)Values[0]);
+
+            Length = Result < 0 ? 0 : (UINT32)Result;
+        }
+
+        break;
+
+    default:
+
+        Length = Record->TextLength < BufferLength - 1 ? Record->TextLength : BufferLength - 1;
+        memcpy(Buffer, Text, Length);
+
+        break;
+    }
+
+    //
+    // The formatted text is truncated if it doesn't fit in the buffer
+    //
+    if (Length > BufferLength - 1)
+    {
+        Length = BufferLength - 1;
+    }
+
+    Buffer[Length] = '\0';
+
+    return Length;
+}
+
+/**
+ * @brief Append a number to a line of JSON
+ *
+ * @param Line The line
+ * @param Number The number
+ * @param IsHex Whether the number is written as a hex string (the 64-bit
+ * numbers are written as strings, as they don't fit in the numbers of
+ * many of the JSON parsers)
+ * @return VOID
+ */
+static VOID
+RecordsAppendNumber(string & Line, UINT64 Number, BOOLEAN IsHex)
+{
+    CHAR   Digits[24];
+    UINT32 Index = sizeof(Digits);
+
+    do
+    {
+        Digits[--Index] = IsHex ? "0123456789abcdef"[Number & 0xf] : (CHAR)('0' + Number % 10);
+        Number          = IsHex ? Number >> 4 : Number / 10;
+    } while (Number != 0);
+
+    if (IsHex)
+    {
+        Line.append("\"0x");
+        Line.append(Digits + Index, sizeof(Digits) - Index);
+        Line.push_back('"');
+    }
+    else
+    {
+        Line.append(Digits + Index, sizeof(Digits) - Index);
+    }
+}
+
+/**
+ * @brief Convert an event record to a line of JSON
+ *
+ * @param Record The event record
+ * @param Line The line (terminated by a newline)
+ * @return VOID
+ */
+VOID
+RecordsToJsonLine(PDEBUGGER_EVENT_RECORD Record, string & Line)
+{
+    UINT64 *     Values = (UINT64 *)((CHAR *)Record + SIZEOF_DEBUGGER_EVENT_RECORD);
+    CHAR *       Text   = (CHAR *)Values + Record->CountOfValues * sizeof(UINT64);
+    UINT32       Start  = 0;
+    const char * Kind;
+
+    switch (Record->Kind)
+    {
+    case DEBUGGER_EVENT_RECORD_KIND_PRINT:
+        Kind = "print";
+        break;
+    case DEBUGGER_EVENT_RECORD_KIND_PRINTF:
+        Kind = "printf";
+        break;
+    case DEBUGGER_EVENT_RECORD_KIND_FORMATS:
+        Kind = "formats";
+        break;
+    case DEBUGGER_EVENT_RECORD_KIND_TEXT:
+        Kind = "text";
+        break;
+    default:
+        Kind = "unknown";
+        break;
+    }
+
+    Line.append("{\"tag\":");
+    RecordsAppendNumber(Line, Record->Tag, FALSE);
+    Line.append(",\"kind\":\"");
+    Line.append(Kind);
+    Line.append("\",\"core\":");
+    RecordsAppendNumber(Line, Record->CoreId, FALSE);
+    Line.append(",\"pid\":");
+    RecordsAppendNumber(Line, Record->ProcessId, FALSE);
+    Line.append(",\"tid\":");
+    RecordsAppendNumber(Line, Record->ThreadId, FALSE);
+    Line.append(",\"tsc\":");
+    RecordsAppendNumber(Line, Record->Tsc, TRUE);
+    Line.append(",\"values\":[");
+
+    for (UINT32 i = 0; i < Record->CountOfValues; i++)
+    {
+        if (i != 0)
+        {
+            Line.push_back(',');
+        }
+
+        RecordsAppendNumber(Line, Values[i], TRUE);
+    }
+
+    Line.append("],\"text\":\"");
+
+    //
+    // The runs of the characters that don't need escaping are appended
+    // together
+    //
+    for (UINT32 i = 0; i < Record->TextLength; i++)
+    {
+        unsigned char Char = (unsigned char)Text[i];
+
+        if (Char >= 0x20 && Char < 0x7f && Char != '"' && Char != '\\')
+        {
+            continue;
+        }
+
+        Line.append(Text + Start, i - Start);
+        Start = i + 1;
+
+        if (Char == '"' || Char == '\\')
+        {
+            Line.push_back('\\');
+            Line.push_back(Char);
+        }
+        else if (Char == '\n')
+        {
+            Line.append("\\n");
+        }
+        else if (Char == '\r')
+        {
+            Line.append("\\r");
+        }
+        else if (Char == '\t')
+        {
+            Line.append("\\t");
+        }
+        else
+        {
+            //
+            // The other bytes are escaped (as Latin-1) to keep the
+            // line valid UTF-8
+            //
+            Line.append("\\u00");
+            Line.push_back("0123456789abcdef"[Char >> 4]);
+            Line.push_back("0123456789abcdef"[Char & 0xf]);
+        }
+    }
+
+    Line.append(Text + Start, Record->TextLength - Start);
+    Line.append("\"}\n");
+}
+
+/**
+ * @brief Read and check the header of a stream of event records
+ *
+ * @param Stream The stream
+ * @return BOOLEAN TRUE if the stream starts with a valid header
+ */
+BOOLEAN
+RecordsReadStreamHeader(istream & Stream)
+{
+    DEBUGGER_EVENT_RECORD_STREAM_HEADER Header = {0};
+
+    if (!Stream.read((char *)&Header, sizeof(Header)))
+    {
+        return FALSE;
+    }
+
+    return Header.Signature == DEBUGGER_EVENT_RECORD_SIGNATURE &&
+           Header.Version == DEBUGGER_EVENT_RECORD_VERSION;
+}
+
+/**
+ * @brief Read the next event record of a stream
+ *
+ * @param Stream The stream
+ * @param Buffer The buffer that keeps the record
+ * @param Record The record (points to the buffer)
+ * @return BOOLEAN TRUE if a valid record is read, FALSE at the end
+ * of the stream or if the record is invalid
+ */
+BOOLEAN
+RecordsReadNext(istream & Stream, vector<CHAR> & Buffer, PDEBUGGER_EVENT_RECORD * Record)
+{
+    DEBUGGER_EVENT_RECORD Header;
+
+    if (!Stream.read((char *)&Header, SIZEOF_DEBUGGER_EVENT_RECORD))
+    {
+        return FALSE;
+    }
+
+    //
+    // Check the length before reading the rest of the record
+    //
+    if (Header.Signature != DEBUGGER_EVENT_RECORD_SIGNATURE ||
+        Header.Length < SIZEOF_DEBUGGER_EVENT_RECORD ||
+        Header.Length > SIZEOF_DEBUGGER_EVENT_RECORD + DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES * sizeof(UINT64) + PacketChunkSize)
+    {
+        return FALSE;
+    }
+
+    if (Buffer.size() < Header.Length)
+    {
+        Buffer.resize(Header.Length);
+    }
+
+    memcpy(Buffer.data(), &Header, SIZEOF_DEBUGGER_EVENT_RECORD);
+
+    if (!Stream.read(Buffer.data() + SIZEOF_DEBUGGER_EVENT_RECORD, Header.Length - SIZEOF_DEBUGGER_EVENT_RECORD))
+    {
+        return FALSE;
+    }
+
+    *Record = RecordsGetEventRecord(Buffer.data(), Header.Length);
+
+    return *Record != NULL;
+}
+
+/**
+ * @brief Convert a stream of event records to JSON lines
+ *
+ * @param Input The stream of the records (starts with the header)
+ * @param Output The stream that receives a line for each record
+ * @param CountOfRecords Count of the converted records
+ * @return BOOLEAN TRUE if all of the input is converted, FALSE if the
+ * header or one of the records is invalid
+ */
+BOOLEAN
+RecordsConvertToJsonLines(istream & Input, ostream & Output, UINT64 * CountOfRecords)
+{
+    vector<CHAR>           Buffer;
+    string                 Line;
+    PDEBUGGER_EVENT_RECORD Record;
+
+    *CountOfRecords = 0;
+
+    if (!RecordsReadStreamHeader(Input))
+    {
+        return FALSE;
+    }
+
+    while (RecordsReadNext(Input, Buffer, &Record))
+    {
+        Line.clear();
+        RecordsToJsonLine(Record, Line);
+
+        Output.write(Line.data(), Line.size());
+
+        (*CountOfRecords)++;
+    }
+
+    //
+    // Stopping before the end of the input (or in the middle of a
+    // record) means an invalid record
+    //
+    return Input.eof() && Input.gcount() == 0 && Output.good();
+}
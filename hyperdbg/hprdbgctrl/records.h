@@ -0,0 +1,40 @@
+/**
+ * @file records.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers for reading and converting the event records
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////
+//              Functions	            //
+//////////////////////////////////////////
+
+PDEBUGGER_EVENT_RECORD
+RecordsGetEventRecord(PVOID Buffer, UINT32 BufferLength);
+
+UINT32
+RecordsCreateTextRecord(UINT64 Tag, CHAR * Text, UINT32 TextLength, PVOID Buffer, UINT32 BufferLength);
+
+UINT32
+RecordsReplaceText(PDEBUGGER_EVENT_RECORD Record, const CHAR * Text, UINT32 TextLength, PVOID Buffer, UINT32 BufferLength);
+
+UINT32
+RecordsToText(PDEBUGGER_EVENT_RECORD Record, CHAR * Buffer, UINT32 BufferLength);
+
+VOID
+RecordsToJsonLine(PDEBUGGER_EVENT_RECORD Record, string & Line);
+
+BOOLEAN
+RecordsReadStreamHeader(istream & Stream);
+
+BOOLEAN
+RecordsReadNext(istream & Stream, vector<CHAR> & Buffer, PDEBUGGER_EVENT_RECORD * Record);
+
+BOOLEAN
+RecordsConvertToJsonLines(istream & Input, ostream & Output, UINT64 * CountOfRecords);
@@ -42,6 +42,77 @@ CommandSearchMemoryHelp()
     ShowMessages("\t\te.g : !sq 100000 9090909090909090 l ffff\n");
     ShowMessages("\t\te.g : !sq 100000 9090909090909090 9090909090909090 "
                  "9090909090909090 l ffffff\n");
+    ShowMessages("\t\te.g : sb nt!ExAllocatePoolWithTag 48 ?? 5c 24 ?? 57 l ffff \n");
+    ShowMessages("\t\te.g : sd fffff8077356f010 ????3580 l ffff \n");
+
+    ShowMessages("\n '??' is a wildcard byte, it matches any value\n");
+}
+
+/**
+ * @brief convert a value of s* commands to the value and its mask
+ * @details each '??' in the value is a wildcard byte, the mask of the
+ * wildcard bytes is 0x00 and the mask of the other bytes is 0xff
+ *
+ * @param ValueString the value (without hex notations)
+ * @param SizeInBytes size of the value (1, 4 or 8)
+ * @param Value the converted value
+ * @param Mask the mask of the value
+ * @return BOOLEAN whether the value is valid or not
+ */
+BOOLEAN
+CommandSearchMemoryConvertValueAndMask(string ValueString, UINT32 SizeInBytes, UINT64 * Value, UINT64 * Mask)
+{
+    UINT64 TempMask = 0;
+
+    if (ValueString.empty() || ValueString.size() > SizeInBytes * 2)
+    {
+        return FALSE;
+    }
+
+    //
+    // Pad the value so each two characters show exactly one byte
+    //
+    ValueString.insert(0, (SizeInBytes * 2) - ValueString.size(), '0');
+
+    for (UINT32 i = 0; i < SizeInBytes; i++)
+    {
+        //
+        // The first characters are the most significant byte
+        //
+        char High = ValueString.at(i * 2);
+        char Low  = ValueString.at((i * 2) + 1);
+
+        TempMask <<= 8;
+
+        if (High == '?' && Low == '?')
+        {
+            //
+            // It's a wildcard byte
+            //
+            ValueString.at(i * 2)       = '0';
+            ValueString.at((i * 2) + 1) = '0';
+        }
+        else if (High == '?' || Low == '?')
+        {
+            //
+            // Nibble wildcards are not supported
+            //
+            return FALSE;
+        }
+        else
+        {
+            TempMask |= 0xff;
+        }
+    }
+
+    if (!ConvertStringToUInt64(ValueString, Value))
+    {
+        return FALSE;
+    }
+
+    *Mask = TempMask;
+
+    return TRUE;
 }
 
 /**
@@ -54,26 +125,31 @@ CommandSearchMemoryHelp()
 VOID
 CommandSearchMemory(vector<string> SplittedCommand, string Command)
 {
-    BOOL                   Status;
-    BOOL                   SetAddress          = FALSE;
-    BOOL                   SetValue            = FALSE;
-    BOOL                   SetProcId           = FALSE;
-    BOOL                   NextIsProcId        = FALSE;
-    BOOL                   SetLength           = FALSE;
-    BOOL                   NextIsLength        = FALSE;
-    DEBUGGER_SEARCH_MEMORY SearchMemoryRequest = {0};
-    PUINT64                ResultsBuffer;
-    UINT64                 CurrentValue;
-    UINT64                 Address;
-    UINT64                 Value         = 0;
-    UINT64                 Length        = 0;
-    UINT32                 ProcId        = 0;
-    UINT32                 CountOfValues = 0;
-    UINT32                 FinalSize     = 0;
-    UINT64 *               FinalBuffer;
-    vector<UINT64>         ValuesToEdit;
-    vector<string>         SplittedCommandCaseSensitive {Split(Command, ' ')};
-    UINT32                 IndexInCommandCaseSensitive = 0;
+    BOOL                    Status;
+    BOOL                    SetAddress          = FALSE;
+    BOOL                    SetValue            = FALSE;
+    BOOL                    SetProcId           = FALSE;
+    BOOL                    NextIsProcId        = FALSE;
+    BOOL                    SetLength           = FALSE;
+    BOOL                    NextIsLength        = FALSE;
+    DEBUGGER_SEARCH_MEMORY  SearchMemoryRequest = {0};
+    PDEBUGGER_SEARCH_MEMORY ResultsBuffer;
+    PUINT64                 ResultsAddresses;
+    UINT64                  Address;
+    UINT64                  Value          = 0;
+    UINT64                  Mask           = 0;
+    UINT64                  Length         = 0;
+    UINT64                  EndAddress     = 0;
+    UINT32                  ProcId         = 0;
+    UINT32                  CountOfValues  = 0;
+    UINT32                  CountOfResults = 0;
+    UINT32                  FinalSize      = 0;
+    UINT32                  ValueSize      = 0;
+    UINT64 *                FinalBuffer;
+    vector<UINT64>          ValuesToEdit;
+    vector<UINT64>          MasksOfValues;
+    vector<string>          SplittedCommandCaseSensitive {Split(Command, ' ')};
+    UINT32                  IndexInCommandCaseSensitive = 0;
 
     if (SplittedCommand.size() <= 4)
     {
@@ -232,6 +308,19 @@ CommandSearchMemory(vector<string> SplittedCommand, string Command)
             //
             // Check if the value is valid based on byte counts
             //
+            if (SearchMemoryRequest.ByteSize == SEARCH_BYTE)
+            {
+                ValueSize = sizeof(BYTE);
+            }
+            else if (SearchMemoryRequest.ByteSize == SEARCH_DWORD)
+            {
+                ValueSize = sizeof(DWORD);
+            }
+            else
+            {
+                ValueSize = sizeof(UINT64);
+            }
+
             if (SearchMemoryRequest.ByteSize == SEARCH_BYTE && Section.size() >= 3)
             {
                 ShowMessages("please specify a byte (hex) value for 'sb' or '!sb'\n\n");
@@ -252,10 +341,9 @@ CommandSearchMemory(vector<string> SplittedCommand, string Command)
             }
 
             //
-            // Qword is checked by the following function, no need to double
-            // check it above.
+            // Convert the value and build its mask based on the wildcards
             //
-            if (!ConvertStringToUInt64(Section, &Value))
+            if (!CommandSearchMemoryConvertValueAndMask(Section, ValueSize, &Value, &Mask))
             {
                 ShowMessages("please specify a correct hex value to search in the "
                              "memory content\n\n");
@@ -268,6 +356,7 @@ CommandSearchMemory(vector<string> SplittedCommand, string Command)
                 // Add it to the list
                 //
                 ValuesToEdit.push_back(Value);
+                MasksOfValues.push_back(Mask);
 
                 //
                 // Keep track of values to modify
@@ -349,10 +438,21 @@ CommandSearchMemory(vector<string> SplittedCommand, string Command)
         return;
     }
 
+    //
+    // Check the pattern length
+    //
+    if (CountOfValues * ValueSize > MaximumSearchPatternLength)
+    {
+        ShowMessages("err, the search pattern is too long, a pattern can have up to %d bytes\n\n",
+                     MaximumSearchPatternLength);
+        return;
+    }
+
     //
     // Now it's time to put everything together in one structure
+    // the structure is followed by the values and then the masks
     //
-    FinalSize = (CountOfValues * sizeof(UINT64)) + SIZEOF_DEBUGGER_SEARCH_MEMORY;
+    FinalSize = (CountOfValues * sizeof(UINT64) * 2) + SIZEOF_DEBUGGER_SEARCH_MEMORY;
 
     //
     // Set the size
@@ -375,79 +475,532 @@ CommandSearchMemory(vector<string> SplittedCommand, string Command)
         return;
     }
 
+    //
+    // Allocate a buffer to store the results
+    //
+    ResultsBuffer = (PDEBUGGER_SEARCH_MEMORY)malloc(DEBUGGER_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE);
+
+    if (!ResultsBuffer)
+    {
+        ShowMessages("unable to allocate memory\n\n");
+        free(FinalBuffer);
+        return;
+    }
+
     //
     // Zero the buffer
     //
     ZeroMemory(FinalBuffer, FinalSize);
 
     //
-    // Copy the structure on top of the allocated buffer
+    // Put the values and the masks in 64 bit structures
     //
-    memcpy(FinalBuffer, &SearchMemoryRequest, SIZEOF_DEBUGGER_SEARCH_MEMORY);
+    std::copy(ValuesToEdit.begin(), ValuesToEdit.end(), (UINT64 *)((UINT64)FinalBuffer + SIZEOF_DEBUGGER_SEARCH_MEMORY));
+    std::copy(MasksOfValues.begin(), MasksOfValues.end(), (UINT64 *)((UINT64)FinalBuffer + SIZEOF_DEBUGGER_SEARCH_MEMORY + (CountOfValues * sizeof(UINT64))));
+
+    ResultsAddresses = (PUINT64)((UINT64)ResultsBuffer + SIZEOF_DEBUGGER_SEARCH_MEMORY);
+    EndAddress       = Address + Length;
 
     //
-    // Put the values in 64 bit structures
+    // The kernel returns up to MaximumSearchResults results in each
+    // request, so we continue the search until the whole range is searched
     //
-    std::copy(ValuesToEdit.begin(), ValuesToEdit.end(), (UINT64 *)((UINT64)FinalBuffer + SIZEOF_DEBUGGER_SEARCH_MEMORY));
+    while (TRUE)
+    {
+        //
+        // Copy the structure on top of the allocated buffer
+        //
+        memcpy(FinalBuffer, &SearchMemoryRequest, SIZEOF_DEBUGGER_SEARCH_MEMORY);
+
+        ZeroMemory(ResultsBuffer, DEBUGGER_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE);
+
+        //
+        // Fire the IOCTL
+        //
+        Status =
+            DeviceIoControl(g_DeviceHandle,                            // Handle to device
+                            IOCTL_DEBUGGER_SEARCH_MEMORY,              // IO Control code
+                            FinalBuffer,                               // Input Buffer to driver.
+                            FinalSize,                                 // Input buffer length
+                            ResultsBuffer,                             // Output Buffer from driver.
+                            DEBUGGER_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE, // Length of output buffer in bytes.
+                            NULL,                                      // Bytes placed in buffer.
+                            NULL                                       // synchronous call
+            );
+
+        if (!Status)
+        {
+            ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+            free(FinalBuffer);
+            free(ResultsBuffer);
+            return;
+        }
+
+        if (ResultsBuffer->KernelStatus != DEBUGEER_OPERATION_WAS_SUCCESSFULL)
+        {
+            ShowErrorMessage(ResultsBuffer->KernelStatus);
+            free(FinalBuffer);
+            free(ResultsBuffer);
+            return;
+        }
+
+        //
+        // Show the results of this part
+        //
+        for (size_t i = 0; i < ResultsBuffer->CountOfResults; i++)
+        {
+            ShowMessages("%llx\n", ResultsAddresses[i]);
+        }
+
+        CountOfResults += ResultsBuffer->CountOfResults;
+
+        if (ResultsBuffer->IsSearchFinished ||
+            ResultsBuffer->NextAddressToSearch >= EndAddress ||
+            ResultsBuffer->NextAddressToSearch <= SearchMemoryRequest.Address)
+        {
+            break;
+        }
+
+        //
+        // Continue from where the kernel stopped
+        //
+        SearchMemoryRequest.Length  = EndAddress - ResultsBuffer->NextAddressToSearch;
+        SearchMemoryRequest.Address = ResultsBuffer->NextAddressToSearch;
+    }
+
+    if (CountOfResults == 0)
+    {
+        ShowMessages("not found\n");
+    }
 
     //
-    // Allocate a buffer to store the results
+    // Free the buffers
     //
-    ResultsBuffer = (PUINT64)malloc(MaximumSearchResults * sizeof(UINT64));
+    free(FinalBuffer);
+    free(ResultsBuffer);
+}
+
+/**
+ * @brief help of !sm sm commands
+ *
+ * @return VOID
+ */
+VOID
+CommandSearchMemoryMultiPatternHelp()
+{
+    ShowMessages("sm !sm : searches a contiguous memory for all of the patterns "
+                 "of a pattern file at once\n");
+    ShowMessages(
+        "\n If you want to search in physical (address) memory then add '!' "
+        "at the start of the command\n");
+
+    ShowMessages("syntax : \t[!]sm [address from] l [length (hex value)] "
+                 "pid [process id (hex)] file [pattern file path]\n");
+
+    ShowMessages("\t\te.g : sm nt!ExAllocatePoolWithTag l ffffff file c:\\patterns.txt\n");
+    ShowMessages("\t\te.g : sm fffff8077356f010 l ffff pid 1c0 file c:\\patterns.txt\n");
+    ShowMessages("\t\te.g : !sm 100000 l ffffff file c:\\patterns.txt\n");
+
+    ShowMessages("\n each line of the pattern file is a pattern, a pattern is either "
+                 "hex bytes (e.g., 48 8b 05) or a string in quotes (e.g., \"cmd.exe\"), "
+                 "empty lines and lines that start with '#' are ignored\n");
+    ShowMessages(" the file path should be the last parameter, up to %d patterns with "
+                 "the total length of %d bytes are supported\n",
+                 MaximumMultiPatternSearchPatternsCount,
+                 MaximumMultiPatternSearchPatternsTotalLength);
+}
+
+/**
+ * @brief parse the pattern file of !sm sm commands
+ *
+ * @param FilePath path of the pattern file
+ * @param PatternsText text of the patterns (to show in the results)
+ * @param PatternsLength length of the patterns
+ * @param PatternsBytes bytes of all patterns (one after another)
+ * @return BOOLEAN whether the file is valid or not
+ */
+BOOLEAN
+CommandSearchMemoryMultiPatternParseFile(string           FilePath,
+                                         vector<string> & PatternsText,
+                                         vector<UINT32> & PatternsLength,
+                                         vector<UCHAR> &  PatternsBytes)
+{
+    string   Line;
+    string   HexBytes;
+    UINT32   LineNumber = 0;
+    ifstream File(FilePath);
+
+    if (!File.is_open())
+    {
+        ShowMessages("err, unable to open the pattern file '%s'\n", FilePath.c_str());
+        return FALSE;
+    }
+
+    while (std::getline(File, Line))
+    {
+        LineNumber++;
+
+        Trim(Line);
+
+        if (Line.empty() || Line.at(0) == '#')
+        {
+            continue;
+        }
+
+        if (Line.at(0) == '"')
+        {
+            //
+            // It's a string, the bytes are the characters between the quotes
+            //
+            if (Line.size() < 3 || Line.back() != '"')
+            {
+                ShowMessages("err, invalid string at line %d of the pattern file\n", LineNumber);
+                return FALSE;
+            }
+
+            PatternsBytes.insert(PatternsBytes.end(), Line.begin() + 1, Line.end() - 1);
+            PatternsLength.push_back((UINT32)Line.size() - 2);
+        }
+        else
+        {
+            //
+            // It's hex bytes, remove the spaces
+            //
+            HexBytes = Line;
+            HexBytes.erase(remove_if(HexBytes.begin(), HexBytes.end(), [](unsigned char c) { return isspace(c); }), HexBytes.end());
+
+            if (!IsHexNotation(HexBytes) || HexBytes.size() % 2 != 0)
+            {
+                ShowMessages("err, invalid hex bytes at line %d of the pattern file\n", LineNumber);
+                return FALSE;
+            }
+
+            for (UCHAR Byte : HexToBytes(HexBytes))
+            {
+                PatternsBytes.push_back(Byte);
+            }
+
+            PatternsLength.push_back((UINT32)HexBytes.size() / 2);
+        }
+
+        PatternsText.push_back(Line);
+    }
+
+    File.close();
+
+    if (PatternsLength.empty())
+    {
+        ShowMessages("err, no pattern found in the pattern file\n");
+        return FALSE;
+    }
+
+    if (PatternsLength.size() > MaximumMultiPatternSearchPatternsCount ||
+        PatternsBytes.size() > MaximumMultiPatternSearchPatternsTotalLength)
+    {
+        ShowErrorMessage(DEBUGGER_ERROR_MULTI_PATTERN_SEARCH_INVALID_PATTERNS);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief !sm sm commands handler
+ *
+ * @param SplittedCommand
+ * @param Command
+ * @return VOID
+ */
+VOID
+CommandSearchMemoryMultiPattern(vector<string> SplittedCommand, string Command)
+{
+    BOOL                                  Status;
+    BOOL                                  SetAddress    = FALSE;
+    BOOL                                  SetLength     = FALSE;
+    BOOL                                  NextIsProcId  = FALSE;
+    BOOL                                  NextIsLength  = FALSE;
+    DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY  SearchRequest = {0};
+    PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY RequestBuffer;
+    PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY ResultsBuffer;
+    PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY OutputBuffer = NULL;
+    PDEBUGGER_MULTI_PATTERN_SEARCH_RESULT ResultsAddresses;
+    UINT64                                Address        = 0;
+    UINT64                                Length         = 0;
+    UINT64                                EndAddress     = 0;
+    UINT32                                ProcId         = 0;
+    UINT32                                RequestSize    = 0;
+    UINT32                                CountOfResults = 0;
+    string                                FilePath;
+    vector<string>                        PatternsText;
+    vector<UINT32>                        PatternsLength;
+    vector<UCHAR>                         PatternsBytes;
+    vector<string>                        SplittedCommandCaseSensitive {Split(Command, ' ')};
+    UINT32                                IndexInCommandCaseSensitive = 0;
+
+    if (SplittedCommand.size() <= 5)
+    {
+        ShowMessages("incorrect use of 'sm'\n\n");
+        CommandSearchMemoryMultiPatternHelp();
+        return;
+    }
+
+    SearchRequest.MemoryType = !SplittedCommand.at(0).compare("!sm") ? SEARCH_PHYSICAL_MEMORY : SEARCH_VIRTUAL_MEMORY;
+
+    for (auto Section : SplittedCommand)
+    {
+        IndexInCommandCaseSensitive++;
+
+        if (IndexInCommandCaseSensitive == 1)
+        {
+            continue;
+        }
+
+        if (NextIsProcId)
+        {
+            NextIsProcId = FALSE;
+
+            if (!ConvertStringToUInt32(Section, &ProcId))
+            {
+                ShowMessages("please specify a correct hex prcoess id\n\n");
+                CommandSearchMemoryMultiPatternHelp();
+                return;
+            }
+            continue;
+        }
+
+        if (NextIsLength)
+        {
+            NextIsLength = FALSE;
+
+            if (!ConvertStringToUInt64(Section, &Length))
+            {
+                ShowMessages("please specify a correct hex length\n\n");
+                CommandSearchMemoryMultiPatternHelp();
+                return;
+            }
+            SetLength = TRUE;
+            continue;
+        }
+
+        if (!Section.compare("pid"))
+        {
+            NextIsProcId = TRUE;
+            continue;
+        }
+
+        if (!SetLength && !Section.compare("l"))
+        {
+            NextIsLength = TRUE;
+            continue;
+        }
+
+        if (!Section.compare("file"))
+        {
+            //
+            // The rest of the command is the file path
+            //
+            for (size_t i = IndexInCommandCaseSensitive; i < SplittedCommandCaseSensitive.size(); i++)
+            {
+                FilePath += SplittedCommandCaseSensitive.at(i) + " ";
+            }
+
+            Trim(FilePath);
+            break;
+        }
+
+        if (!SetAddress)
+        {
+            if (!SymbolConvertNameToAddress(SplittedCommandCaseSensitive.at(IndexInCommandCaseSensitive - 1), &Address))
+            {
+                ShowMessages("err, couldn't resolve error at '%s'\n\n",
+                             SplittedCommandCaseSensitive.at(IndexInCommandCaseSensitive - 1).c_str());
+                CommandSearchMemoryMultiPatternHelp();
+                return;
+            }
+
+            SetAddress = TRUE;
+            continue;
+        }
+
+        ShowMessages("unknown parameter '%s'\n\n", Section.c_str());
+        CommandSearchMemoryMultiPatternHelp();
+        return;
+    }
+
+    if (!SetAddress || !SetLength || NextIsProcId || NextIsLength || FilePath.empty())
+    {
+        ShowMessages("please specify the address, the length and the pattern file\n\n");
+        CommandSearchMemoryMultiPatternHelp();
+        return;
+    }
 
     //
-    // Also it's better to Zero the memory; however it's not necessary
-    // as we zero the buffer in the search routines
+    // Check to prevent using process id in sm commands
     //
-    ZeroMemory(ResultsBuffer, MaximumSearchResults * sizeof(UINT64));
+    if (g_IsSerialConnectedToRemoteDebuggee && ProcId != 0)
+    {
+        ShowMessages("err, you cannot specify 'pid' in the debugger mode\n\n");
+        return;
+    }
+
+    if (!g_IsSerialConnectedToRemoteDebuggee && !g_DeviceHandle)
+    {
+        ShowMessages("handle of the driver not found, probably the driver is not loaded. Did you "
+                     "use 'load' command?\n");
+        return;
+    }
+
+    if (!CommandSearchMemoryMultiPatternParseFile(FilePath, PatternsText, PatternsLength, PatternsBytes))
+    {
+        return;
+    }
+
+    if (ProcId == 0)
+    {
+        ProcId = GetCurrentProcessId();
+    }
 
     //
-    // Fire the IOCTL
+    // Fill the structure
+    //
+    SearchRequest.Address             = Address;
+    SearchRequest.Length              = Length;
+    SearchRequest.ProcessId           = ProcId;
+    SearchRequest.CountOfPatterns     = (UINT32)PatternsLength.size();
+    SearchRequest.PatternsTotalLength = (UINT32)PatternsBytes.size();
+
     //
-    Status =
-        DeviceIoControl(g_DeviceHandle,               // Handle to device
-                        IOCTL_DEBUGGER_SEARCH_MEMORY, // IO Control code
-                        FinalBuffer,                  // Input Buffer to driver.
-                        FinalSize,                    // Input buffer length
-                        ResultsBuffer,                // Output Buffer from driver.
-                        MaximumSearchResults *
-                            sizeof(UINT64), // Length of output buffer in bytes.
-                        NULL,               // Bytes placed in buffer.
-                        NULL                // synchronous call
-        );
+    // The structure is followed by the lengths and then the bytes of the patterns
+    //
+    RequestSize = SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY +
+                  (SearchRequest.CountOfPatterns * sizeof(UINT32)) +
+                  SearchRequest.PatternsTotalLength;
+
+    RequestBuffer = (PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY)malloc(RequestSize);
 
-    if (!Status)
+    if (!RequestBuffer)
     {
-        ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
-        free(FinalBuffer);
+        ShowMessages("unable to allocate memory\n\n");
         return;
     }
 
+    std::copy(PatternsLength.begin(), PatternsLength.end(), (UINT32 *)((UINT64)RequestBuffer + SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY));
+    std::copy(PatternsBytes.begin(), PatternsBytes.end(), (UCHAR *)((UINT64)RequestBuffer + SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY + (SearchRequest.CountOfPatterns * sizeof(UINT32))));
+
+    if (!g_IsSerialConnectedToRemoteDebuggee)
+    {
+        OutputBuffer = (PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY)malloc(DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE);
+
+        if (!OutputBuffer)
+        {
+            ShowMessages("unable to allocate memory\n\n");
+            free(RequestBuffer);
+            return;
+        }
+    }
+
+    EndAddress = Address + Length;
+
     //
-    // Show the results (if any)
+    // Each request returns up to MaximumMultiPatternSearchResults results,
+    // so we continue the search until the whole range is searched
     //
-    for (size_t i = 0; i < MaximumSearchResults; i++)
+    while (TRUE)
     {
-        CurrentValue = ResultsBuffer[i];
+        memcpy(RequestBuffer, &SearchRequest, SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY);
+
+        if (g_IsSerialConnectedToRemoteDebuggee)
+        {
+            //
+            // Send the request over serial
+            //
+            ResultsBuffer = KdSendMultiPatternSearchPacketToDebuggee(RequestBuffer, RequestSize);
 
-        if (CurrentValue == NULL)
+            if (ResultsBuffer == NULL)
+            {
+                ShowMessages("err, unable to send the packet to the debuggee\n");
+                break;
+            }
+        }
+        else
         {
+            ZeroMemory(OutputBuffer, DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE);
+
             //
-            // We ended up the buffer, nothing else to show,
-            // just check whether we found anything or not
+            // Fire the IOCTL
             //
-            if (i == 0)
+            Status = DeviceIoControl(g_DeviceHandle,                                          // Handle to device
+                                     IOCTL_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY,              // IO Control code
+                                     RequestBuffer,                                           // Input Buffer to driver.
+                                     RequestSize,                                             // Input buffer length
+                                     OutputBuffer,                                            // Output Buffer from driver.
+                                     DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE, // Length of output buffer in bytes.
+                                     NULL,                                                    // Bytes placed in buffer.
+                                     NULL                                                     // synchronous call
+            );
+
+            if (!Status)
+            {
+                ShowMessages("ioctl failed with code 0x%x\n", GetLastError());
+                break;
+            }
+
+            ResultsBuffer = OutputBuffer;
+        }
+
+        if (ResultsBuffer->KernelStatus != DEBUGEER_OPERATION_WAS_SUCCESSFULL)
+        {
+            ShowErrorMessage(ResultsBuffer->KernelStatus);
+            break;
+        }
+
+        //
+        // Show the results of this part
+        //
+        ResultsAddresses = (PDEBUGGER_MULTI_PATTERN_SEARCH_RESULT)((UINT64)ResultsBuffer + SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY);
+
+        for (size_t i = 0; i < ResultsBuffer->CountOfResults && i < MaximumMultiPatternSearchResults; i++)
+        {
+            if (ResultsAddresses[i].PatternId >= PatternsText.size())
+            {
+                continue;
+            }
+
+            ShowMessages("%llx  [%d] %s\n",
+                         ResultsAddresses[i].Address,
+                         ResultsAddresses[i].PatternId,
+                         PatternsText.at(ResultsAddresses[i].PatternId).c_str());
+        }
+
+        CountOfResults += ResultsBuffer->CountOfResults;
+
+        if (ResultsBuffer->IsSearchFinished ||
+            ResultsBuffer->NextAddressToSearch >= EndAddress ||
+            ResultsBuffer->NextAddressToSearch < SearchRequest.Address ||
+            (ResultsBuffer->NextAddressToSearch == SearchRequest.Address && ResultsBuffer->CountOfResults == 0))
+        {
+            if (CountOfResults == 0)
             {
                 ShowMessages("not found\n");
             }
             break;
         }
-        ShowMessages("%llx\n", CurrentValue);
+
+        //
+        // Continue from where the search is stopped with the same state
+        //
+        SearchRequest.Length      = EndAddress - ResultsBuffer->NextAddressToSearch;
+        SearchRequest.Address     = ResultsBuffer->NextAddressToSearch;
+        SearchRequest.ResumeState = ResultsBuffer->ResumeState;
     }
 
     //
     // Free the buffers
     //
-    free(FinalBuffer);
-    free(ResultsBuffer);
+    free(RequestBuffer);
+
+    if (OutputBuffer != NULL)
+    {
+        free(OutputBuffer);
+    }
 }
@@ -80,6 +80,22 @@ ScriptEngineSearchSymbolForMaskWrapper(const char * SearchMask)
     return ScriptEngineSearchSymbolForMask(SearchMask);
 }
 
+/**
+ * @brief ScriptEngineConvertAddressToObjectName wrapper
+ *
+ * @param Address
+ * @param ObjectName
+ * @param ObjectNameSize
+ * @param Displacement
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+ScriptEngineConvertAddressToObjectNameWrapper(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement)
+{
+    return ScriptEngineConvertAddressToObjectName(Address, ObjectName, ObjectNameSize, Displacement);
+}
+
 //
 // *********************** Function links (wrapper) ***********************
 //
@@ -16,7 +16,8 @@ using namespace std;
 //
 // Global Variables
 //
-extern BOOLEAN g_ExecutingScript;
+extern BOOLEAN              g_ExecutingScript;
+extern DEBUGGER_EVENT_BATCH g_EventBatch;
 
 /**
  * @brief help of .script command
@@ -27,7 +28,43 @@ VOID
 CommandScriptHelp()
 {
     ShowMessages(".script : run a HyperDbg script.\n\n");
-    ShowMessages("syntax : \.script [FilePath]\n");
+    ShowMessages("syntax : \t.script [FilePath]\n");
+    ShowMessages("syntax : \t.script batch [FilePath]\n");
+
+    ShowMessages("\n");
+    ShowMessages("\t\te.g : .script C:\\scripts\\events.txt\n");
+    ShowMessages("\t\te.g : .script batch C:\\scripts\\events.txt\n");
+
+    ShowMessages("\n");
+    ShowMessages("in the batch mode, the events (and their scripts) are validated "
+                 "while the file is interpreted and all of them are registered "
+                 "after the last line, if an event is not valid then none of the "
+                 "events are registered. the file of a batch should only contain "
+                 "the commands of the events, as the other commands would run "
+                 "before the events are registered\n");
+}
+
+/**
+ * @brief Check whether the command of a line registers an event
+ *
+ * @param Line the line of the script file
+ * @return BOOLEAN
+ */
+BOOLEAN
+CommandScriptIsEventLine(const string & Line)
+{
+    vector<string> SplittedLine {Split(Line, ' ')};
+
+    if (SplittedLine.empty())
+    {
+        return FALSE;
+    }
+
+    string FirstCommand = SplittedLine.front();
+
+    transform(FirstCommand.begin(), FirstCommand.end(), FirstCommand.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    return (GetCommandAttributes(FirstCommand) & DEBUGGER_COMMAND_ATTRIBUTE_REGISTER_EVENT) ? TRUE : FALSE;
 }
 
 /**
@@ -40,10 +77,14 @@ CommandScriptHelp()
 VOID
 CommandScript(vector<string> SplittedCommand, string Command)
 {
-    std::string Line;
-    BOOLEAN     IsOpened = FALSE;
-    string      NewPath;
-    int         CommandExecutionResult = 0;
+    std::string    Line;
+    vector<string> Lines;
+    vector<UINT32> InvalidLines;
+    vector<UINT32> NonEventLines;
+    BOOLEAN        IsBatch                = FALSE;
+    size_t         CountOfEvents          = 0;
+    UINT32         CountOfRegisteredEvent = 0;
+    int            CommandExecutionResult = 0;
 
     if (SplittedCommand.size() == 1)
     {
@@ -68,52 +109,158 @@ CommandScript(vector<string> SplittedCommand, string Command)
     Trim(Command);
 
     //
-    // Parse the script file
+    // Check whether the events should be registered as a batch
+    //
+    if (SplittedCommand.size() >= 3 && !SplittedCommand.at(1).compare("batch"))
+    {
+        IsBatch = TRUE;
+
+        //
+        // Remove batch from it
+        //
+        Command.erase(0, 5);
+        Trim(Command);
+    }
+
+    //
+    // Read the script file
     //
     ifstream File(Command);
 
-    if (File.is_open())
+    if (!File.is_open())
+    {
+        ShowMessages("err, invalid file specified for .script command\n");
+        return;
+    }
+
+    while (std::getline(File, Line))
+    {
+        Lines.push_back(Line);
+    }
+
+    File.close();
+
+    //
+    // The events of a batch are registered after the last line, so the
+    // other commands (e.g., disabling an event or continuing the debuggee)
+    // would run out of the order of the file, these lines are not allowed
+    //
+    if (IsBatch)
     {
-        IsOpened = TRUE;
+        for (UINT32 i = 0; i < Lines.size(); i++)
+        {
+            if (!Split(Lines[i], ' ').empty() && !CommandScriptIsEventLine(Lines[i]))
+            {
+                NonEventLines.push_back(i + 1);
+            }
+        }
+
+        if (!NonEventLines.empty())
+        {
+            ShowMessages("err, only the commands of the events can be used in the batch mode, "
+                         "other commands at line(s):");
+
+            for (auto NonEventLine : NonEventLines)
+            {
+                ShowMessages(" %d", NonEventLine);
+            }
+
+            ShowMessages("\nnone of the commands are executed\n");
+            return;
+        }
+    }
 
+    //
+    // Indicate that it's a script
+    //
+    g_ExecutingScript = TRUE;
+
+    if (IsBatch)
+    {
         //
-        // Indicate that it's a script
+        // Collect the events instead of registering them
         //
-        g_ExecutingScript = TRUE;
+        EventBatchStart();
+    }
 
-        while (std::getline(File, Line))
+    for (UINT32 i = 0; i < Lines.size(); i++)
+    {
+        if (IsBatch)
         {
-            //
-            // Show current running command
-            //
-            HyperdbgShowSignature();
-            ShowMessages("%s\n", Line.c_str());
+            g_EventBatch.CurrentLine = i + 1;
+            CountOfEvents            = g_EventBatch.Entries.size();
+        }
+
+        //
+        // Show current running command
+        //
+        HyperdbgShowSignature();
+        ShowMessages("%s\n", Lines[i].c_str());
 
-            CommandExecutionResult = HyperdbgInterpreter(Line.c_str());
-            ShowMessages("\n");
+        CommandExecutionResult = HyperdbgInterpreter(Lines[i].c_str());
+        ShowMessages("\n");
 
+        //
+        // if the debugger encounters an exit state then the return will be 1
+        //
+        if (CommandExecutionResult == 1)
+        {
             //
-            // if the debugger encounters an exit state then the return will be 1
+            // Exit from the debugger
             //
-            if (CommandExecutionResult == 1)
+            if (IsBatch)
             {
-                //
-                // Exit from the debugger
-                //
-                exit(0);
+                EventBatchDiscard();
             }
+
+            exit(0);
         }
 
         //
-        // Indicate that script is finished
+        // An event command that is interpreted locally but is not collected
+        // is not valid (the error is already shown)
         //
-        g_ExecutingScript = FALSE;
-
-        File.close();
+        if (IsBatch && CommandExecutionResult != 2 &&
+            g_EventBatch.Entries.size() == CountOfEvents &&
+            CommandScriptIsEventLine(Lines[i]))
+        {
+            InvalidLines.push_back(i + 1);
+        }
     }
 
-    if (!IsOpened)
+    if (IsBatch)
     {
-        ShowMessages("err, invalid file specified for .script command\n");
+        if (!InvalidLines.empty())
+        {
+            ShowMessages("err, invalid event at line(s):");
+
+            for (auto InvalidLine : InvalidLines)
+            {
+                ShowMessages(" %d", InvalidLine);
+            }
+
+            ShowMessages("\nnone of the events are registered\n");
+
+            EventBatchDiscard();
+        }
+        else if (!g_EventBatch.Entries.empty())
+        {
+            CountOfEvents = g_EventBatch.Entries.size();
+
+            ShowMessages("registering %d event(s)\n", CountOfEvents);
+
+            CountOfRegisteredEvent = EventBatchSubmit();
+
+            ShowMessages("%d of %d event(s) are registered\n", CountOfRegisteredEvent, CountOfEvents);
+        }
+        else
+        {
+            EventBatchDiscard();
+        }
     }
+
+    //
+    // Indicate that script is finished
+    //
+    g_ExecutingScript = FALSE;
 }
@@ -16,9 +16,12 @@
 //
 extern BOOLEAN g_AutoUnpause;
 extern BOOLEAN g_AutoFlush;
+extern BOOLEAN g_OutputBuffering;
 extern BOOLEAN g_IsConnectedToRemoteDebuggee;
 extern UINT32  g_DisassemblerSyntax;
 
+extern OUTPUT_SINK_STATISTICS g_OutputSinkStatistics;
+
 /**
  * @brief help of settings command
  *
@@ -36,6 +39,9 @@ CommandSettingsHelp()
     ShowMessages("\t\te.g : settings autounpause off\n");
     ShowMessages("\t\te.g : settings autoflush on\n");
     ShowMessages("\t\te.g : settings autoflush off\n");
+    ShowMessages("\t\te.g : settings outputbuffer\n");
+    ShowMessages("\t\te.g : settings outputbuffer on\n");
+    ShowMessages("\t\te.g : settings outputbuffer off\n");
     ShowMessages("\t\te.g : settings syntax intel\n");
     ShowMessages("\t\te.g : settings syntax att\n");
     ShowMessages("\t\te.g : settings syntax masm\n");
@@ -101,6 +107,80 @@ CommandSettingsAutoFlush(vector<string> SplittedCommand)
     }
 }
 
+/**
+ * @brief set the output buffering mode to enabled and disable
+ * and query the status and counters of this mode
+ * @details changing the mode resets the counters so the messages, bytes
+ * and packets of a command (e.g., 'u') can be compared in both modes
+ *
+ * @param SplittedCommand
+ * @return VOID
+ */
+VOID
+CommandSettingsOutputBuffer(vector<string> SplittedCommand)
+{
+    if (SplittedCommand.size() == 2)
+    {
+        //
+        // It's a query
+        //
+        if (g_OutputBuffering)
+        {
+            ShowMessages("output buffering is enabled\n");
+        }
+        else
+        {
+            ShowMessages("output buffering is disabled\n");
+        }
+
+        ShowMessages("messages : %lld, bytes : %lld, packets : %lld\n",
+                     g_OutputSinkStatistics.CountOfMessages,
+                     g_OutputSinkStatistics.CountOfBytes,
+                     g_OutputSinkStatistics.CountOfPackets);
+    }
+    else if (SplittedCommand.size() == 3)
+    {
+        //
+        // The user tries to set a value as the output buffering
+        //
+        if (!SplittedCommand.at(2).compare("on"))
+        {
+            g_OutputBuffering = TRUE;
+            ShowMessages("set output buffering to enabled\n");
+        }
+        else if (!SplittedCommand.at(2).compare("off"))
+        {
+            g_OutputBuffering = FALSE;
+            ShowMessages("set output buffering to disabled\n");
+        }
+        else
+        {
+            //
+            // Sth is incorrect
+            //
+            ShowMessages("incorrect use of 'settings', please use 'help settings' "
+                         "for more details\n");
+            return;
+        }
+
+        //
+        // Reset the counters
+        //
+        InterlockedExchange64(&g_OutputSinkStatistics.CountOfMessages, 0);
+        InterlockedExchange64(&g_OutputSinkStatistics.CountOfBytes, 0);
+        InterlockedExchange64(&g_OutputSinkStatistics.CountOfPackets, 0);
+    }
+    else
+    {
+        //
+        // Sth is incorrect
+        //
+        ShowMessages("incorrect use of 'settings', please use 'help settings' "
+                     "for more details\n");
+        return;
+    }
+}
+
 /**
  * @brief set auto-unpause mode to enabled or disabled
  *
@@ -296,6 +376,25 @@ CommandSettings(vector<string> SplittedCommand, string Command)
             CommandSettingsAutoFlush(SplittedCommand);
         }
     }
+    else if (!SplittedCommand.at(1).compare("outputbuffer"))
+    {
+        //
+        // If it's a remote debugger then we send it to the remote debugger
+        // as the output is buffered where the commands are executed
+        //
+        if (g_IsConnectedToRemoteDebuggee)
+        {
+            RemoteConnectionSendCommand(Command.c_str(), strlen(Command.c_str()) + 1);
+        }
+        else
+        {
+            //
+            // If it's a connection over serial or a local debugging then
+            // we handle it locally
+            //
+            CommandSettingsOutputBuffer(SplittedCommand);
+        }
+    }
     else
     {
         //
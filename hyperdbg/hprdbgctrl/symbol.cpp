@@ -85,3 +85,131 @@ SymbolConvertNameToAddress(string TextToConvert, PUINT64 Result)
 
     return IsFound;
 }
+
+/**
+ * @brief convert an address to its symbol (module!name+offset)
+ * @details if the address is not in any of the loaded symbols then the
+ * address itself is converted to the string
+ *
+ * @param Address the target address
+ * @param Buffer the buffer to save the result
+ * @param BufferSize size of the buffer
+ *
+ * @return BOOLEAN shows whether the symbol is found or not
+ */
+BOOLEAN
+SymbolConvertAddressToString(UINT64 Address, CHAR * Buffer, UINT32 BufferSize)
+{
+    CHAR   ObjectName[SYMBOL_MAXIMUM_OBJECT_NAME_LENGTH] = {0};
+    UINT64 Displacement                                  = NULL;
+
+    if (!ScriptEngineConvertAddressToObjectNameWrapper(Address, ObjectName, sizeof(ObjectName), &Displacement))
+    {
+        //
+        // Not found, show the address itself
+        //
+        sprintf_s(Buffer, BufferSize, "%s", SeparateTo64BitValue(Address).c_str());
+        return FALSE;
+    }
+
+    if (Displacement == 0)
+    {
+        sprintf_s(Buffer, BufferSize, "%s", ObjectName);
+    }
+    else
+    {
+        sprintf_s(Buffer, BufferSize, "%s+0x%llx", ObjectName, Displacement);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief convert the marked addresses of a message that is received
+ * from the kernel to their symbols
+ * @details addresses are marked by the '%y' format specifier of the
+ * script engine's printf, the message doesn't need to be null-terminated
+ * (e.g., the text of the event records)
+ *
+ * @param Message the message
+ * @param MessageLength length of the message
+ * @param Result the message with the symbols (only set if the message
+ * has any marked address)
+ *
+ * @return BOOLEAN shows whether the message has any marked address
+ */
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result)
+{
+    const char * End = Message + MessageLength;
+    const char * Marker;
+    CHAR         Symbol[SYMBOL_MAXIMUM_OBJECT_NAME_LENGTH] = {0};
+    CHAR         AddressString[SYMBOLIZED_ADDRESS_MARKER_LENGTH];
+    UINT64       Address;
+
+    Marker = (const char *)memchr(Message, SYMBOLIZED_ADDRESS_MARKER, MessageLength);
+
+    if (Marker == NULL)
+    {
+        //
+        // Most of the messages don't have any symbolized address
+        //
+        return FALSE;
+    }
+
+    Result.clear();
+
+    while (Marker != NULL)
+    {
+        Result.append(Message, Marker - Message);
+
+        //
+        // Check whether all the hex digits of the address are available,
+        // otherwise the marker is removed
+        //
+        if (End - Marker < SYMBOLIZED_ADDRESS_MARKER_LENGTH ||
+            strnlen(Marker, SYMBOLIZED_ADDRESS_MARKER_LENGTH) != SYMBOLIZED_ADDRESS_MARKER_LENGTH)
+        {
+            Message = Marker + 1;
+            break;
+        }
+
+        memcpy(AddressString, Marker + 1, SYMBOLIZED_ADDRESS_MARKER_LENGTH - 1);
+        AddressString[SYMBOLIZED_ADDRESS_MARKER_LENGTH - 1] = '\0';
+
+        Address = strtoull(AddressString, NULL, 16);
+
+        SymbolConvertAddressToString(Address, Symbol, sizeof(Symbol));
+        Result.append(Symbol);
+
+        Message = Marker + SYMBOLIZED_ADDRESS_MARKER_LENGTH;
+        Marker  = (const char *)memchr(Message, SYMBOLIZED_ADDRESS_MARKER, End - Message);
+    }
+
+    Result.append(Message, strnlen(Message, End - Message));
+
+    return TRUE;
+}
+
+/**
+ * @brief show a message that is received from the kernel and convert
+ * the marked addresses in the message to their symbols
+ *
+ * @param Message the null-terminated message
+ *
+ * @return VOID
+ */
+VOID
+SymbolShowMessageWithSymbols(const char * Message)
+{
+    string Result;
+
+    if (SymbolReplaceMarkers(Message, (UINT32)strlen(Message), Result))
+    {
+        ShowMessages("%s", Result.c_str());
+    }
+    else
+    {
+        ShowMessages("%s", Message);
+    }
+}
@@ -31,6 +31,11 @@ CommandTHelp()
     ShowMessages("\t\te.g : t\n");
     ShowMessages("\t\te.g : tr\n");
     ShowMessages("\t\te.g : tr 1f\n");
+
+    ShowMessages("\nif [count] is more than one, the instructions are traced on "
+                 "the debuggee and the instructions (and the registers that are "
+                 "changed by each instruction in the case of 'tr') are shown "
+                 "after the trace is finished\n");
 }
 
 /**
@@ -45,6 +50,7 @@ CommandT(vector<string> SplittedCommand, string Command)
 {
     UINT32                           StepCount;
     DEBUGGER_REMOTE_STEPPING_REQUEST RequestFormat;
+    DEBUGGEE_TRACE_PACKET            TracePacket = {0};
 
     //
     // Validate the commands
@@ -83,7 +89,7 @@ CommandT(vector<string> SplittedCommand, string Command)
     //
     if (g_IsSerialConnectedToRemoteDebuggee)
     {
-        for (size_t i = 0; i < StepCount; i++)
+        if (StepCount == 1)
         {
             KdSendStepPacketToDebuggee(RequestFormat);
 
@@ -93,12 +99,21 @@ CommandT(vector<string> SplittedCommand, string Command)
                 // Show registers
                 //
                 ShowAllRegisters();
-                if (i != StepCount - 1)
-                {
-                    ShowMessages("\n");
-                }
             }
         }
+        else if (StepCount != 0)
+        {
+            //
+            // Trace the instructions on the debuggee instead of sending a
+            // step packet for each instruction, the records are shown once
+            // they're received
+            //
+            TracePacket.StepType        = DEBUGGEE_TRACE_STEP_TYPE_STEP_IN;
+            TracePacket.CountOfSteps    = StepCount;
+            TracePacket.RecordRegisters = !SplittedCommand.at(0).compare("tr");
+
+            KdSendTracePacketToDebuggee(&TracePacket);
+        }
     }
     else
     {
@@ -0,0 +1,292 @@
+/**
+ * @file AhoCorasick.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Multi-pattern (Aho-Corasick) matcher (used in !sm sm commands)
+ * @details The automaton is built once from all of the patterns and then
+ * each byte of the memory is a single lookup in the table of transitions,
+ * no matter how many patterns are searched; the state of the automaton can
+ * be kept between the buffers, so the matches that cross page boundaries
+ * are also found
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Find the child of a state in the trie
+ *
+ * @param Automaton The automaton
+ * @param State The parent state
+ * @param Byte The byte of the edge
+ * @return UINT16 The child state or AHO_CORASICK_NO_STATE
+ */
+UINT16
+AhoCorasickFindChild(PAHO_CORASICK_AUTOMATON Automaton, UINT16 State, UCHAR Byte)
+{
+    UINT16 Child = Automaton->States[State].FirstChild;
+
+    while (Child != AHO_CORASICK_NO_STATE)
+    {
+        if (Automaton->States[Child].Byte == Byte)
+        {
+            return Child;
+        }
+
+        Child = Automaton->States[Child].NextSibling;
+    }
+
+    return AHO_CORASICK_NO_STATE;
+}
+
+/**
+ * @brief Build the automaton from a list of patterns
+ *
+ * @param Automaton The automaton
+ * @param PatternsLength Length of each pattern
+ * @param PatternsBuffer Bytes of the patterns (one after another)
+ * @param CountOfPatterns Count of patterns
+ * @return BOOLEAN Returns TRUE if the patterns are valid
+ */
+BOOLEAN
+AhoCorasickBuild(PAHO_CORASICK_AUTOMATON Automaton,
+                 const UINT32 *          PatternsLength,
+                 const UCHAR *           PatternsBuffer,
+                 UINT32                  CountOfPatterns)
+{
+    UINT32 TotalLength = 0;
+    UINT32 QueueHead   = 0;
+    UINT32 QueueTail   = 0;
+    UINT16 State;
+    UINT16 Child;
+    UINT16 Failure;
+    UINT16 PatternId;
+
+    if (CountOfPatterns == 0 || CountOfPatterns > MaximumMultiPatternSearchPatternsCount)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < CountOfPatterns; i++)
+    {
+        if (PatternsLength[i] == 0 || PatternsLength[i] > MaximumMultiPatternSearchPatternsTotalLength)
+        {
+            return FALSE;
+        }
+
+        TotalLength += PatternsLength[i];
+
+        if (TotalLength > MaximumMultiPatternSearchPatternsTotalLength)
+        {
+            return FALSE;
+        }
+    }
+
+    Automaton->CountOfPatterns = CountOfPatterns;
+    Automaton->CountOfStates   = 1;
+
+    Automaton->States[AHO_CORASICK_ROOT_STATE].FirstChild       = AHO_CORASICK_NO_STATE;
+    Automaton->States[AHO_CORASICK_ROOT_STATE].NextSibling      = AHO_CORASICK_NO_STATE;
+    Automaton->States[AHO_CORASICK_ROOT_STATE].Failure          = AHO_CORASICK_ROOT_STATE;
+    Automaton->States[AHO_CORASICK_ROOT_STATE].DictionarySuffix = AHO_CORASICK_NO_STATE;
+    Automaton->States[AHO_CORASICK_ROOT_STATE].PatternId        = AHO_CORASICK_NO_PATTERN;
+    Automaton->States[AHO_CORASICK_ROOT_STATE].CountOfMatches   = 0;
+    Automaton->States[AHO_CORASICK_ROOT_STATE].Byte             = 0;
+
+    //
+    // Insert the patterns in the trie
+    //
+    for (UINT32 i = 0; i < CountOfPatterns; i++)
+    {
+        State = AHO_CORASICK_ROOT_STATE;
+
+        for (UINT32 j = 0; j < PatternsLength[i]; j++)
+        {
+            Child = AhoCorasickFindChild(Automaton, State, *PatternsBuffer);
+
+            if (Child == AHO_CORASICK_NO_STATE)
+            {
+                Child = (UINT16)Automaton->CountOfStates;
+                Automaton->CountOfStates++;
+
+                Automaton->States[Child].FirstChild       = AHO_CORASICK_NO_STATE;
+                Automaton->States[Child].NextSibling      = Automaton->States[State].FirstChild;
+                Automaton->States[Child].Failure          = AHO_CORASICK_ROOT_STATE;
+                Automaton->States[Child].DictionarySuffix = AHO_CORASICK_NO_STATE;
+                Automaton->States[Child].PatternId        = AHO_CORASICK_NO_PATTERN;
+                Automaton->States[Child].CountOfMatches   = 0;
+                Automaton->States[Child].Byte             = *PatternsBuffer;
+
+                Automaton->States[State].FirstChild = Child;
+            }
+
+            State = Child;
+            PatternsBuffer++;
+        }
+
+        Automaton->PatternsLength[i]           = PatternsLength[i];
+        Automaton->NextPatternWithSameState[i] = AHO_CORASICK_NO_PATTERN;
+        Automaton->States[State].CountOfMatches++;
+
+        //
+        // Duplicate patterns are chained to the first one
+        //
+        if (Automaton->States[State].PatternId == AHO_CORASICK_NO_PATTERN)
+        {
+            Automaton->States[State].PatternId = (UINT16)i;
+        }
+        else
+        {
+            PatternId = Automaton->States[State].PatternId;
+
+            while (Automaton->NextPatternWithSameState[PatternId] != AHO_CORASICK_NO_PATTERN)
+            {
+                PatternId = Automaton->NextPatternWithSameState[PatternId];
+            }
+
+            Automaton->NextPatternWithSameState[PatternId] = (UINT16)i;
+        }
+    }
+
+    //
+    // Fill the transitions of the root state, the bytes that don't
+    // start any pattern remain in the root state
+    //
+    for (UINT32 i = 0; i < 0x100; i++)
+    {
+        Automaton->Transitions[AHO_CORASICK_ROOT_STATE][i] = AHO_CORASICK_ROOT_STATE;
+    }
+
+    for (Child = Automaton->States[AHO_CORASICK_ROOT_STATE].FirstChild;
+         Child != AHO_CORASICK_NO_STATE;
+         Child = Automaton->States[Child].NextSibling)
+    {
+        Automaton->Transitions[AHO_CORASICK_ROOT_STATE][Automaton->States[Child].Byte] = Child;
+        Automaton->Queue[QueueTail++]                                                = Child;
+    }
+
+    //
+    // Compute the failure links, the dictionary suffix links and the
+    // transitions in breadth-first order, so the transitions of the
+    // failure state (which is shorter) are always ready
+    //
+    while (QueueHead < QueueTail)
+    {
+        State   = Automaton->Queue[QueueHead++];
+        Failure = Automaton->States[State].Failure;
+
+        //
+        // The bytes that don't have an edge follow the failure link
+        //
+        RtlCopyMemory(Automaton->Transitions[State], Automaton->Transitions[Failure], sizeof(Automaton->Transitions[State]));
+
+        //
+        // The patterns that end in the suffixes also end in this state
+        //
+        Automaton->States[State].CountOfMatches += Automaton->States[Failure].CountOfMatches;
+
+        for (Child = Automaton->States[State].FirstChild;
+             Child != AHO_CORASICK_NO_STATE;
+             Child = Automaton->States[Child].NextSibling)
+        {
+            Automaton->Transitions[State][Automaton->States[Child].Byte] = Child;
+
+            Failure = Automaton->Transitions[Automaton->States[State].Failure][Automaton->States[Child].Byte];
+
+            Automaton->States[Child].Failure = Failure;
+
+            if (Automaton->States[Failure].PatternId != AHO_CORASICK_NO_PATTERN)
+            {
+                Automaton->States[Child].DictionarySuffix = Failure;
+            }
+            else
+            {
+                Automaton->States[Child].DictionarySuffix = Automaton->States[Failure].DictionarySuffix;
+            }
+
+            Automaton->Queue[QueueTail++] = Child;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Scan a buffer for all of the patterns
+ *
+ * @details If reporting the matches of a byte needs more than MaximumMatches
+ * callbacks, then the scan is stopped before that byte and the state is
+ * not changed, so the caller can continue from the returned offset
+ *
+ * @param Automaton The automaton
+ * @param Buffer The buffer to scan
+ * @param BufferSize Size of the buffer
+ * @param BaseAddress Address of the first byte of the buffer
+ * @param State The state of the automaton, it should be AHO_CORASICK_ROOT_STATE
+ * for the first buffer and is updated for the next contiguous buffer
+ * @param MaximumMatches Maximum number of times that callback can be called
+ * @param Callback The callback which is called for each match
+ * @param Context Context of the callback
+ * @return UINT32 Count of bytes that are scanned
+ */
+UINT32
+AhoCorasickScanBuffer(PAHO_CORASICK_AUTOMATON     Automaton,
+                      const UCHAR *               Buffer,
+                      UINT32                      BufferSize,
+                      UINT64                      BaseAddress,
+                      UINT16 *                    State,
+                      UINT32                      MaximumMatches,
+                      AHO_CORASICK_MATCH_CALLBACK Callback,
+                      PVOID                       Context)
+{
+    UINT16 CurrentState = *State;
+    UINT16 NextState;
+    UINT16 OutputState;
+    UINT16 PatternId;
+    UINT32 CountOfMatches;
+    UINT32 i = 0;
+
+    while (i < BufferSize)
+    {
+        NextState = Automaton->Transitions[CurrentState][Buffer[i]];
+
+        CountOfMatches = Automaton->States[NextState].CountOfMatches;
+
+        if (CountOfMatches != 0)
+        {
+            OutputState = Automaton->States[NextState].PatternId != AHO_CORASICK_NO_PATTERN ? NextState : Automaton->States[NextState].DictionarySuffix;
+
+            if (CountOfMatches > MaximumMatches)
+            {
+                //
+                // Not enough space to report the matches of this byte
+                //
+                break;
+            }
+
+            MaximumMatches -= CountOfMatches;
+
+            while (OutputState != AHO_CORASICK_NO_STATE)
+            {
+                for (PatternId = Automaton->States[OutputState].PatternId;
+                     PatternId != AHO_CORASICK_NO_PATTERN;
+                     PatternId = Automaton->NextPatternWithSameState[PatternId])
+                {
+                    Callback(PatternId, BaseAddress + i + 1 - Automaton->PatternsLength[PatternId], Context);
+                }
+
+                OutputState = Automaton->States[OutputState].DictionarySuffix;
+            }
+        }
+
+        CurrentState = NextState;
+        i++;
+    }
+
+    *State = CurrentState;
+
+    return i;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file AhoCorasick.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the multi-pattern (Aho-Corasick) matcher
+ * @details The automaton has a fixed size and doesn't depend on any kernel
+ * routine, it can be built and used in both vmx-root and vmx non-root
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum number of states of the automaton
+ *
+ */
+#define AHO_CORASICK_MAXIMUM_STATES (MaximumMultiPatternSearchPatternsTotalLength + 1)
+
+/**
+ * @brief The root state of the automaton
+ *
+ */
+#define AHO_CORASICK_ROOT_STATE 0
+
+/**
+ * @brief Shows that there is no state
+ *
+ */
+#define AHO_CORASICK_NO_STATE 0xffff
+
+/**
+ * @brief Shows that there is no pattern
+ *
+ */
+#define AHO_CORASICK_NO_PATTERN 0xffff
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A state (node) of the automaton
+ *
+ */
+typedef struct _AHO_CORASICK_STATE
+{
+    UINT16 FirstChild;       // First child in the trie
+    UINT16 NextSibling;      // Next child of the parent in the trie
+    UINT16 Failure;          // Longest proper suffix which is also a state
+    UINT16 DictionarySuffix; // Longest proper suffix which is the end of a pattern
+    UINT16 PatternId;        // The first pattern that ends in this state
+    UINT16 CountOfMatches;   // Count of the patterns that end in this state or in its suffixes
+    UCHAR  Byte;             // The byte of the edge from the parent
+
+} AHO_CORASICK_STATE, *PAHO_CORASICK_STATE;
+
+/**
+ * @brief The Aho-Corasick automaton
+ * @details The transitions of all of the states are kept in a table (the
+ * failure links are already followed while building it), so each byte of
+ * the memory is a single lookup
+ *
+ */
+typedef struct _AHO_CORASICK_AUTOMATON
+{
+    UINT32             CountOfStates;
+    UINT32             CountOfPatterns;
+    UINT16             Transitions[AHO_CORASICK_MAXIMUM_STATES][0x100];
+    UINT32             PatternsLength[MaximumMultiPatternSearchPatternsCount];
+    UINT16             NextPatternWithSameState[MaximumMultiPatternSearchPatternsCount]; // Duplicate patterns
+    AHO_CORASICK_STATE States[AHO_CORASICK_MAXIMUM_STATES];
+    UINT16             Queue[AHO_CORASICK_MAXIMUM_STATES]; // Only used while building the automaton
+
+} AHO_CORASICK_AUTOMATON, *PAHO_CORASICK_AUTOMATON;
+
+/**
+ * @brief Callback that will be called for each match
+ *
+ */
+typedef VOID (*AHO_CORASICK_MATCH_CALLBACK)(UINT32 PatternId, UINT64 Address, PVOID Context);
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+AhoCorasickBuild(PAHO_CORASICK_AUTOMATON Automaton,
+                 const UINT32 *          PatternsLength,
+                 const UCHAR *           PatternsBuffer,
+                 UINT32                  CountOfPatterns);
+
+UINT32
+AhoCorasickScanBuffer(PAHO_CORASICK_AUTOMATON     Automaton,
+                      const UCHAR *               Buffer,
+                      UINT32                      BufferSize,
+                      UINT64                      BaseAddress,
+                      UINT16 *                    State,
+                      UINT32                      MaximumMatches,
+                      AHO_CORASICK_MATCH_CALLBACK Callback,
+                      PVOID                       Context);
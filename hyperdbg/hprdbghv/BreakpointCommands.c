@@ -11,6 +11,99 @@
  */
 #include "pch.h"
 
+/**
+ * @brief Allocate the index of breakpoints
+ * @details this function should be called on vmx non-root
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+BreakpointIndexInitialize()
+{
+    g_BreakpointsIndex = ExAllocatePoolWithTag(NonPagedPool, sizeof(BREAKPOINT_INDEX), POOLTAG);
+
+    if (g_BreakpointsIndex == NULL)
+    {
+        return FALSE;
+    }
+
+    RtlZeroMemory(g_BreakpointsIndex, sizeof(BREAKPOINT_INDEX));
+
+    return TRUE;
+}
+
+/**
+ * @brief Free the index of breakpoints
+ * @details this function should be called on vmx non-root
+ *
+ * @return VOID
+ */
+VOID
+BreakpointIndexUninitialize()
+{
+    if (g_BreakpointsIndex != NULL)
+    {
+        ExFreePoolWithTag(g_BreakpointsIndex, POOLTAG);
+        g_BreakpointsIndex = NULL;
+    }
+}
+
+/**
+ * @brief Restore the original bytes of the 'bp' breakpoints in a buffer
+ * which is read from the memory of a process
+ *
+ * @param ProcessCr3 The cr3 that the buffer is read with
+ * @param Address Virtual address of the buffer
+ * @param Buffer
+ * @param Size
+ *
+ * @return VOID
+ */
+VOID
+BreakpointRestoreOriginalBytesOfBuffer(CR3_TYPE ProcessCr3, UINT64 Address, UCHAR * Buffer, UINT32 Size)
+{
+    PBREAKPOINT_INDEX_ENTRY Entry;
+    UINT64                  OffsetInBuffer;
+
+    //
+    // Only iterate through the breakpoints in the range of the buffer
+    //
+    for (UINT32 i = BreakpointIndexLowerBound(g_BreakpointsIndex, Address, 0); i < g_BreakpointsIndex->CountOfBreakpoints; i++)
+    {
+        Entry = &g_BreakpointsIndex->SortedByAddress[i];
+
+        if (Entry->Address - Address >= Size)
+        {
+            break;
+        }
+
+        //
+        // The kernel addresses are shared between the processes and the
+        // user-mode addresses are checked with the cr3 of the breakpoint,
+        // if it's set on another process, the byte is only restored if
+        // the address is mapped to the same physical page (e.g., a shared
+        // image) in the process of the buffer
+        //
+        if (Entry->AddressSpace != NULL &&
+            Entry->BreakpointDesc->Cr3 != ProcessCr3.Flags &&
+            VirtualAddressToPhysicalAddressByProcessCr3(Entry->Address, ProcessCr3) != Entry->BreakpointDesc->PhysAddress)
+        {
+            continue;
+        }
+
+        //
+        // The address is found, we have to swap the byte if the target
+        // byte is 0xcc
+        //
+        OffsetInBuffer = Entry->Address - Address;
+
+        if (Buffer[OffsetInBuffer] == 0xcc)
+        {
+            Buffer[OffsetInBuffer] = Entry->BreakpointDesc->PreviousByte;
+        }
+    }
+}
+
 /**
  * @brief Check if the breakpoint vm-exit relates to !epthook command or not
  * 
@@ -23,65 +116,93 @@
 BOOLEAN
 BreakpointCheckAndHandleEptHookBreakpoints(UINT32 CurrentProcessorIndex, ULONG64 GuestRip, PGUEST_REGS GuestRegs)
 {
-    PLIST_ENTRY TempList           = 0;
-    BOOLEAN     IsHandledByEptHook = FALSE;
+    CR3_TYPE                GuestCr3;
+    PEPT_HOOKED_PAGE_DETAIL HookedEntry        = NULL;
+    PEPT_HOOKED_OFFSET      HookedOffset       = NULL;
+    UINT64                  GuestRipPhysical   = NULL;
+    BOOLEAN                 IsHandledByEptHook = FALSE;
 
     //
     // ***** Check breakpoint for !epthook *****
     //
 
     //
-    // Check whether the breakpoint was due to a !epthook command or not
+    // Find the current process cr3 and convert the rip to physical address
     //
-    TempList = &g_EptState->HookedPagesList;
+    NT_KPROCESS * CurrentProcess = (NT_KPROCESS *)(PsGetCurrentProcess());
+    GuestCr3.Flags               = CurrentProcess->DirectoryTableBase;
 
-    while (&g_EptState->HookedPagesList != TempList->Flink)
+    GuestRipPhysical = VirtualAddressToPhysicalAddressByProcessCr3(GuestRip, GuestCr3);
+
+    //
+    // Check whether the breakpoint was due to a !epthook command or not, the
+    // hooked pages are keyed by their page frame numbers and the hooks of the
+    // page are sorted by their offsets
+    //
+    if (GuestRipPhysical != NULL)
+    {
+        HookedEntry = EptHookFindHookedPage(PAGE_ALIGN(GuestRipPhysical));
+    }
+
+    if (HookedEntry != NULL && HookedEntry->IsExecutionHook)
     {
-        TempList                            = TempList->Flink;
-        PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
+        HookedOffset = EptHookFindHookedOffset(HookedEntry, PAGE_OFFSET(GuestRip));
+    }
 
-        if (HookedEntry->IsExecutionHook)
+    if (HookedOffset != NULL && HookedOffset->IsHiddenBreakpoint && HookedOffset->VirtualAddress == GuestRip)
+    {
+        if (HookedEntry->IsBeingRemoved)
         {
-            for (size_t i = 0; i < HookedEntry->CountOfBreakpoints; i++)
-            {
-                if (HookedEntry->BreakpointAddresses[i] == GuestRip)
-                {
-                    //
-                    // We found an address that matches the details, let's trigger the event
-                    //
-
-                    //
-                    // As the context to event trigger, we send the rip
-                    // of where triggered this event
-                    //
-                    DebuggerTriggerEvents(HIDDEN_HOOK_EXEC_CC, GuestRegs, GuestRip);
-
-                    //
-                    // Restore to its orginal entry for one instruction
-                    //
-                    EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->OriginalEntry, INVEPT_SINGLE_CONTEXT);
-
-                    //
-                    // Next we have to save the current hooked entry to restore on the next instruction's vm-exit
-                    //
-                    g_GuestState[KeGetCurrentProcessorNumber()].MtfEptHookRestorePoint = HookedEntry;
-
-                    //
-                    // We have to set Monitor trap flag and give it the HookedEntry to work with
-                    //
-                    HvSetMonitorTrapFlag(TRUE);
-
-                    //
-                    // Indicate that we handled the ept violation
-                    //
-                    IsHandledByEptHook = TRUE;
-
-                    //
-                    // Get out of the loop
-                    //
-                    break;
-                }
-            }
+            //
+            // The page is unhooked, so we restore its original entry (it's
+            // not restored on this core yet) and the instruction is executed
+            // again from the original page without triggering the event
+            //
+            EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->OriginalEntry, INVEPT_SINGLE_CONTEXT);
+
+            IsHandledByEptHook = TRUE;
+        }
+        else if (HookedOffset->IsBeingRemoved)
+        {
+            //
+            // The hook is removed from the page but the other hooks of the
+            // page remain, its original byte is already restored on the fake
+            // page, so the instruction is executed again without triggering
+            // the event
+            //
+            IsHandledByEptHook = TRUE;
+        }
+        else
+        {
+            //
+            // We found an address that matches the details, let's trigger the event
+            //
+
+            //
+            // As the context to event trigger, we send the rip
+            // of where triggered this event
+            //
+            DebuggerTriggerEvents(HIDDEN_HOOK_EXEC_CC, GuestRegs, GuestRip);
+
+            //
+            // Restore to its orginal entry for one instruction
+            //
+            EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->OriginalEntry, INVEPT_SINGLE_CONTEXT);
+
+            //
+            // Next we have to save the current hooked entry to restore on the next instruction's vm-exit
+            //
+            g_GuestState[KeGetCurrentProcessorNumber()].MtfEptHookRestorePoint = HookedEntry;
+
+            //
+            // We have to set Monitor trap flag and give it the HookedEntry to work with
+            //
+            HvSetMonitorTrapFlag(TRUE);
+
+            //
+            // Indicate that we handled the ept violation
+            //
+            IsHandledByEptHook = TRUE;
         }
     }
 
@@ -112,7 +233,7 @@ BreakpointCheckAndHandleDebuggerDefinedBreakpoints(UINT32                  Curre
 {
     CR3_TYPE                         GuestCr3;
     BOOLEAN                          IsHandledByBpRoutines = FALSE;
-    PLIST_ENTRY                      TempList              = 0;
+    PDEBUGGEE_BP_DESCRIPTOR          CurrentBreakpointDesc = NULL;
     UINT64                           GuestRipPhysical      = NULL;
     DEBUGGER_TRIGGERED_EVENT_DETAILS ContextAndTag         = {0};
     RFLAGS                           Rflags                = {0};
@@ -136,121 +257,110 @@ BreakpointCheckAndHandleDebuggerDefinedBreakpoints(UINT32                  Curre
     GuestRipPhysical = VirtualAddressToPhysicalAddressByProcessCr3(GuestRip, GuestCr3);
 
     //
-    // Iterate through the list of breakpoints
+    // Find the breakpoint by its physical address
     //
-    TempList = &g_BreakpointsListHead;
+    CurrentBreakpointDesc = BreakpointIndexFindByPhysicalAddress(g_BreakpointsIndex, GuestRipPhysical);
 
-    while (&g_BreakpointsListHead != TempList->Flink)
+    if (CurrentBreakpointDesc != NULL)
     {
-        TempList                                      = TempList->Flink;
-        PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(TempList, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
+        //
+        // It's a breakpoint by 'bp' command
+        //
+        IsHandledByBpRoutines = TRUE;
 
-        if (CurrentBreakpointDesc->PhysAddress == GuestRipPhysical)
+        //
+        // First, we remove the breakpoint
+        //
+        MemoryMapperWriteMemorySafeByPhysicalAddress(GuestRipPhysical,
+                                                     &CurrentBreakpointDesc->PreviousByte,
+                                                     sizeof(BYTE));
+
+        //
+        // Now, halt the debuggee
+        //
+        ContextAndTag.Context = g_GuestState[CurrentProcessorIndex].LastVmexitRip;
+
+        //
+        // In breakpoints tag is breakpoint id, not event tag
+        //
+        if (Reason == DEBUGGEE_PAUSING_REASON_DEBUGGEE_SOFTWARE_BREAKPOINT_HIT)
         {
-            //
-            // It's a breakpoint by 'bp' command
-            //
-            IsHandledByBpRoutines = TRUE;
+            ContextAndTag.Tag = CurrentBreakpointDesc->BreakpointId;
+        }
 
-            //
-            // First, we remove the breakpoint
-            //
-            MemoryMapperWriteMemorySafeByPhysicalAddress(GuestRipPhysical,
-                                                         &CurrentBreakpointDesc->PreviousByte,
-                                                         sizeof(BYTE));
+        //
+        // Hint debuggee about the length
+        //
+        g_GuestState[CurrentProcessorIndex].DebuggingState.InstructionLengthHint = CurrentBreakpointDesc->InstructionLength;
 
+        //
+        // Check constraints
+        //
+        if ((CurrentBreakpointDesc->Pid == DEBUGGEE_BP_APPLY_TO_ALL_PROCESSES || CurrentBreakpointDesc->Pid == PsGetCurrentProcessId()) &&
+            (CurrentBreakpointDesc->Tid == DEBUGGEE_BP_APPLY_TO_ALL_THREADS || CurrentBreakpointDesc->Tid == PsGetCurrentThreadId()) &&
+            (CurrentBreakpointDesc->Core == DEBUGGEE_BP_APPLY_TO_ALL_CORES || CurrentBreakpointDesc->Core == CurrentProcessorIndex))
+        {
             //
-            // Now, halt the debuggee
+            // *** It's not safe to access CurrentBreakpointDesc anymore as the
+            // breakpoint might be removed ***
             //
-            ContextAndTag.Context = g_GuestState[CurrentProcessorIndex].LastVmexitRip;
 
-            //
-            // In breakpoints tag is breakpoint id, not event tag
-            //
-            if (Reason == DEBUGGEE_PAUSING_REASON_DEBUGGEE_SOFTWARE_BREAKPOINT_HIT)
-            {
-                ContextAndTag.Tag = CurrentBreakpointDesc->BreakpointId;
-            }
+            KdHandleBreakpointAndDebugBreakpoints(CurrentProcessorIndex,
+                                                  GuestRegs,
+                                                  Reason,
+                                                  &ContextAndTag);
+        }
 
-            //
-            // Hint debuggee about the length
-            //
-            g_GuestState[CurrentProcessorIndex].DebuggingState.InstructionLengthHint = CurrentBreakpointDesc->InstructionLength;
+        //
+        // Reset hint to instruction length
+        //
+        g_GuestState[CurrentProcessorIndex].DebuggingState.InstructionLengthHint = 0;
 
+        //
+        // Check if we should re-apply the breakpoint after this instruction
+        // or not (in other words, is breakpoint still valid)
+        //
+        if (!CurrentBreakpointDesc->AvoidReApplyBreakpoint)
+        {
             //
-            // Check constraints
+            // We should re-apply the breakpoint on next mtf
             //
-            if ((CurrentBreakpointDesc->Pid == DEBUGGEE_BP_APPLY_TO_ALL_PROCESSES || CurrentBreakpointDesc->Pid == PsGetCurrentProcessId()) &&
-                (CurrentBreakpointDesc->Tid == DEBUGGEE_BP_APPLY_TO_ALL_THREADS || CurrentBreakpointDesc->Tid == PsGetCurrentThreadId()) &&
-                (CurrentBreakpointDesc->Core == DEBUGGEE_BP_APPLY_TO_ALL_CORES || CurrentBreakpointDesc->Core == CurrentProcessorIndex))
-            {
-                //
-                // *** It's not safe to access CurrentBreakpointDesc anymore as the
-                // breakpoint might be removed ***
-                //
-
-                KdHandleBreakpointAndDebugBreakpoints(CurrentProcessorIndex,
-                                                      GuestRegs,
-                                                      Reason,
-                                                      &ContextAndTag);
-            }
+            g_GuestState[CurrentProcessorIndex].DebuggingState.SoftwareBreakpointState = CurrentBreakpointDesc;
 
             //
-            // Reset hint to instruction length
+            // Fire and MTF
             //
-            g_GuestState[CurrentProcessorIndex].DebuggingState.InstructionLengthHint = 0;
+            HvSetMonitorTrapFlag(TRUE);
+            *AvoidUnsetMtf = TRUE;
 
             //
-            // Check if we should re-apply the breakpoint after this instruction
-            // or not (in other words, is breakpoint still valid)
+            // As we want to continue debuggee, the MTF might arrive when the
+            // host finish executing it's time slice; thus, a clock interrupt
+            // or an IPI might be arrived and the next instruction is not what
+            // we expect, becuase of that we check if the IF (Interrupt enable)
+            // flag of RFLAGS is enabled or not, if enabled then we remove it
+            // to avoid any clock-interrupt or IPI to arrive and the next
+            // instruction is our next instruction in the current execution
+            // context
             //
-            if (!CurrentBreakpointDesc->AvoidReApplyBreakpoint)
-            {
-                //
-                // We should re-apply the breakpoint on next mtf
-                //
-                g_GuestState[CurrentProcessorIndex].DebuggingState.SoftwareBreakpointState = CurrentBreakpointDesc;
+            __vmx_vmread(GUEST_RFLAGS, &Rflags);
 
-                //
-                // Fire and MTF
-                //
-                HvSetMonitorTrapFlag(TRUE);
-                *AvoidUnsetMtf = TRUE;
+            if (Rflags.InterruptEnableFlag)
+            {
+                Rflags.InterruptEnableFlag = FALSE;
+                __vmx_vmwrite(GUEST_RFLAGS, Rflags.Value);
 
                 //
-                // As we want to continue debuggee, the MTF might arrive when the
-                // host finish executing it's time slice; thus, a clock interrupt
-                // or an IPI might be arrived and the next instruction is not what
-                // we expect, becuase of that we check if the IF (Interrupt enable)
-                // flag of RFLAGS is enabled or not, if enabled then we remove it
-                // to avoid any clock-interrupt or IPI to arrive and the next
-                // instruction is our next instruction in the current execution
-                // context
+                // An indicator to restore RFLAGS if to enabled state
                 //
-                __vmx_vmread(GUEST_RFLAGS, &Rflags);
-
-                if (Rflags.InterruptEnableFlag)
-                {
-                    Rflags.InterruptEnableFlag = FALSE;
-                    __vmx_vmwrite(GUEST_RFLAGS, Rflags.Value);
-
-                    //
-                    // An indicator to restore RFLAGS if to enabled state
-                    //
-                    g_GuestState[CurrentProcessorIndex].DebuggingState.SoftwareBreakpointState->SetRflagsIFBitOnMtf = TRUE;
-                }
+                g_GuestState[CurrentProcessorIndex].DebuggingState.SoftwareBreakpointState->SetRflagsIFBitOnMtf = TRUE;
             }
-
-            //
-            // Do not increment rip
-            //
-            g_GuestState[CurrentProcessorIndex].IncrementRip = FALSE;
-
-            //
-            // No need to iterate anymore
-            //
-            break;
         }
+
+        //
+        // Do not increment rip
+        //
+        g_GuestState[CurrentProcessorIndex].IncrementRip = FALSE;
     }
 
     return IsHandledByBpRoutines;
@@ -433,17 +543,12 @@ BreakpointClear(PDEBUGGEE_BP_DESCRIPTOR BreakpointDescriptor)
 VOID
 BreakpointRemoveAllBreakpoints()
 {
-    PLIST_ENTRY TempList = 0;
-
     //
     // Iterate through the list of breakpoints
     //
-    TempList = &g_BreakpointsListHead;
-
-    while (&g_BreakpointsListHead != TempList->Flink)
+    while (!IsListEmpty(&g_BreakpointsListHead))
     {
-        TempList                                      = TempList->Flink;
-        PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(TempList, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
+        PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(g_BreakpointsListHead.Flink, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
 
         //
         // Clear the breakpoint
@@ -451,9 +556,10 @@ BreakpointRemoveAllBreakpoints()
         BreakpointClear(CurrentBreakpointDesc);
 
         //
-        // Remove breakpoint from the list of breakpoints
+        // Remove breakpoint from the list and the index of breakpoints
         //
         RemoveEntryList(&CurrentBreakpointDesc->BreakpointsList);
+        BreakpointIndexRemove(g_BreakpointsIndex, CurrentBreakpointDesc);
 
         //
         // Uninitialize the breakpoint descriptor (safely)
@@ -493,37 +599,6 @@ BreakpointGetEntryByBreakpointId(UINT64 BreakpointId)
     return NULL;
 }
 
-/**
- * @brief Find entry of breakpoint descriptor from list 
- * of breakpoints by address
- * @param Address  
- * 
- * @return PDEBUGGEE_BP_DESCRIPTOR
- */
-PDEBUGGEE_BP_DESCRIPTOR
-BreakpointGetEntryByAddress(UINT64 Address)
-{
-    PLIST_ENTRY TempList = 0;
-
-    TempList = &g_BreakpointsListHead;
-
-    while (&g_BreakpointsListHead != TempList->Flink)
-    {
-        TempList                                      = TempList->Flink;
-        PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(TempList, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
-
-        if (CurrentBreakpointDesc->Address == Address)
-        {
-            return CurrentBreakpointDesc;
-        }
-    }
-
-    //
-    // We didn't find anything, so return null
-    //
-    return NULL;
-}
-
 /**
  * @brief Add new breakpoints 
  * @param BpDescriptor  
@@ -536,6 +611,8 @@ BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg)
     PDEBUGGEE_BP_DESCRIPTOR BreakpointDescriptor = NULL;
     UINT32                  ProcessorCount;
     CR3_TYPE                GuestCr3;
+    UINT64                  AddressSpace;
+    UINT64                  PhysAddress;
 
     //
     // Find the current process cr3
@@ -543,6 +620,8 @@ BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg)
     NT_KPROCESS * CurrentProcess = (NT_KPROCESS *)(PsGetCurrentProcess());
     GuestCr3.Flags               = CurrentProcess->DirectoryTableBase;
 
+    AddressSpace = BreakpointIndexGetAddressSpace(BpDescriptorArg->Address, GuestCr3);
+
     //
     // *** Validate arguments ***
     //
@@ -572,9 +651,14 @@ BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg)
     }
 
     //
-    // Check if breakpoint already exists on list or not
+    // Check if breakpoint already exists on list or not, two different
+    // addresses might also be mapped to the same physical address and
+    // in that case, the second one would save 0xcc as the previous byte
     //
-    if (BreakpointGetEntryByAddress(BpDescriptorArg->Address) != NULL)
+    PhysAddress = VirtualAddressToPhysicalAddressByProcessCr3(BpDescriptorArg->Address, GuestCr3);
+
+    if (BreakpointIndexFindByAddress(g_BreakpointsIndex, BpDescriptorArg->Address, AddressSpace) != NULL ||
+        BreakpointIndexFindByPhysicalAddress(g_BreakpointsIndex, PhysAddress) != NULL)
     {
         //
         // Address is already on the list (Set the error)
@@ -583,6 +667,15 @@ BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg)
         return FALSE;
     }
 
+    //
+    // Check if there is a free entry in the index of breakpoints
+    //
+    if (g_BreakpointsIndex->CountOfBreakpoints >= MAXIMUM_NUMBER_OF_BREAKPOINTS)
+    {
+        BpDescriptorArg->Result = DEBUGGER_ERROR_MAXIMUM_NUMBER_OF_BREAKPOINTS_REACHED;
+        return FALSE;
+    }
+
     //
     // We won't check for process id and thread id, if these arguments are invalid
     // then the HyperDbg simply ignores the breakpoints but it makes the computer slow
@@ -615,8 +708,8 @@ BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg)
     g_MaximumBreakpointId++;
     BreakpointDescriptor->BreakpointId = g_MaximumBreakpointId;
     BreakpointDescriptor->Address      = BpDescriptorArg->Address;
-    BreakpointDescriptor->PhysAddress  = VirtualAddressToPhysicalAddressByProcessCr3(BpDescriptorArg->Address,
-                                                                                    GuestCr3);
+    BreakpointDescriptor->PhysAddress  = PhysAddress;
+    BreakpointDescriptor->Cr3          = GuestCr3.Flags;
     BreakpointDescriptor->Core         = BpDescriptorArg->Core;
     BreakpointDescriptor->Pid          = BpDescriptorArg->Pid;
     BreakpointDescriptor->Tid          = BpDescriptorArg->Tid;
@@ -633,8 +726,10 @@ BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg)
 
     //
     // Now we should add the breakpoint to the list of breakpoints (LIST_ENTRY)
+    // and to the index of breakpoints
     //
     InsertHeadList(&g_BreakpointsListHead, &(BreakpointDescriptor->BreakpointsList));
+    BreakpointIndexInsert(g_BreakpointsIndex, BreakpointDescriptor, AddressSpace);
 
     //
     // Apply the breakpoint
@@ -788,9 +883,10 @@ BreakpointListOrModify(PDEBUGGEE_BP_LIST_OR_MODIFY_PACKET ListOrModifyBreakpoint
         BreakpointClear(BreakpointDescriptor);
 
         //
-        // Remove breakpoint from the list of breakpoints
+        // Remove breakpoint from the list and the index of breakpoints
         //
         RemoveEntryList(&BreakpointDescriptor->BreakpointsList);
+        BreakpointIndexRemove(g_BreakpointsIndex, BreakpointDescriptor);
 
         //
         // Uninitialize the breakpoint descriptor (safely)
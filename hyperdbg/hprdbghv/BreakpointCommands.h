@@ -11,6 +11,19 @@
  */
 #pragma once
 
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+BreakpointIndexInitialize();
+
+VOID
+BreakpointIndexUninitialize();
+
+VOID
+BreakpointRestoreOriginalBytesOfBuffer(CR3_TYPE ProcessCr3, UINT64 Address, UCHAR * Buffer, UINT32 Size);
+
 BOOLEAN
 BreakpointAddNew(PDEBUGGEE_BP_PACKET BpDescriptorArg);
 
@@ -0,0 +1,282 @@
+/**
+ * @file BreakpointIndex.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Index of breakpoints of 'bp' command
+ * @details Breakpoints are kept in an array sorted by their virtual address
+ * and in an open addressing hash table of their physical address
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Get the address space of a virtual address
+ * @details kernel addresses are shared between all of the processes
+ * so they don't belong to a special cr3
+ *
+ * @param Address
+ * @param Cr3
+ *
+ * @return UINT64
+ */
+UINT64
+BreakpointIndexGetAddressSpace(UINT64 Address, CR3_TYPE Cr3)
+{
+    if (Address & 0x8000000000000000)
+    {
+        return 0;
+    }
+
+    return Cr3.Flags;
+}
+
+/**
+ * @brief Find the first sorted entry which is not less than the
+ * address and the address space
+ *
+ * @param Index
+ * @param Address
+ * @param AddressSpace
+ *
+ * @return UINT32
+ */
+UINT32
+BreakpointIndexLowerBound(PBREAKPOINT_INDEX Index, UINT64 Address, UINT64 AddressSpace)
+{
+    PBREAKPOINT_INDEX_ENTRY Entry;
+    UINT32                  Low  = 0;
+    UINT32                  High = Index->CountOfBreakpoints;
+    UINT32                  Middle;
+
+    while (Low < High)
+    {
+        Middle = Low + (High - Low) / 2;
+        Entry  = &Index->SortedByAddress[Middle];
+
+        if (Entry->Address < Address ||
+            (Entry->Address == Address && Entry->AddressSpace < AddressSpace))
+        {
+            Low = Middle + 1;
+        }
+        else
+        {
+            High = Middle;
+        }
+    }
+
+    return Low;
+}
+
+/**
+ * @brief Get the home slot of a physical address in the hash table
+ *
+ * @param PhysAddress
+ *
+ * @return UINT32
+ */
+UINT32
+BreakpointIndexHashPhysicalAddress(UINT64 PhysAddress)
+{
+    //
+    // Fibonacci hashing, the breakpoints are usually on the same pages
+    // so the low bits of the physical addresses are not enough
+    //
+    return (UINT32)((PhysAddress * 0x9E3779B97F4A7C15) >> 32) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1);
+}
+
+/**
+ * @brief Add a breakpoint to the index
+ * @details the caller should check that the index is not full and
+ * the breakpoint is not a duplicate
+ *
+ * @param Index
+ * @param BreakpointDesc
+ * @param AddressSpace
+ *
+ * @return VOID
+ */
+VOID
+BreakpointIndexInsert(PBREAKPOINT_INDEX Index, PDEBUGGEE_BP_DESCRIPTOR BreakpointDesc, UINT64 AddressSpace)
+{
+    UINT32 Position;
+    UINT32 Slot;
+
+    //
+    // Insert in the sorted array
+    //
+    Position = BreakpointIndexLowerBound(Index, BreakpointDesc->Address, AddressSpace);
+
+    RtlMoveMemory(&Index->SortedByAddress[Position + 1],
+                  &Index->SortedByAddress[Position],
+                  (Index->CountOfBreakpoints - Position) * sizeof(BREAKPOINT_INDEX_ENTRY));
+
+    Index->SortedByAddress[Position].Address        = BreakpointDesc->Address;
+    Index->SortedByAddress[Position].AddressSpace   = AddressSpace;
+    Index->SortedByAddress[Position].BreakpointDesc = BreakpointDesc;
+
+    Index->CountOfBreakpoints++;
+
+    //
+    // Insert in the hash table (linear probing)
+    //
+    Slot = BreakpointIndexHashPhysicalAddress(BreakpointDesc->PhysAddress);
+
+    while (Index->HashedByPhysicalAddress[Slot].BreakpointDesc != NULL)
+    {
+        Slot = (Slot + 1) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1);
+    }
+
+    Index->HashedByPhysicalAddress[Slot].Address        = BreakpointDesc->PhysAddress;
+    Index->HashedByPhysicalAddress[Slot].AddressSpace   = AddressSpace;
+    Index->HashedByPhysicalAddress[Slot].BreakpointDesc = BreakpointDesc;
+}
+
+/**
+ * @brief Remove a breakpoint from the index
+ *
+ * @param Index
+ * @param BreakpointDesc
+ *
+ * @return VOID
+ */
+VOID
+BreakpointIndexRemove(PBREAKPOINT_INDEX Index, PDEBUGGEE_BP_DESCRIPTOR BreakpointDesc)
+{
+    UINT32 Position;
+    UINT32 Slot;
+    UINT32 NextSlot;
+    UINT32 HomeSlot;
+
+    //
+    // Remove from the sorted array
+    //
+    for (Position = BreakpointIndexLowerBound(Index, BreakpointDesc->Address, 0);
+         Position < Index->CountOfBreakpoints &&
+         Index->SortedByAddress[Position].Address == BreakpointDesc->Address;
+         Position++)
+    {
+        if (Index->SortedByAddress[Position].BreakpointDesc == BreakpointDesc)
+        {
+            Index->CountOfBreakpoints--;
+
+            RtlMoveMemory(&Index->SortedByAddress[Position],
+                          &Index->SortedByAddress[Position + 1],
+                          (Index->CountOfBreakpoints - Position) * sizeof(BREAKPOINT_INDEX_ENTRY));
+            break;
+        }
+    }
+
+    //
+    // Remove from the hash table
+    //
+    Slot = BreakpointIndexHashPhysicalAddress(BreakpointDesc->PhysAddress);
+
+    while (Index->HashedByPhysicalAddress[Slot].BreakpointDesc != BreakpointDesc)
+    {
+        if (Index->HashedByPhysicalAddress[Slot].BreakpointDesc == NULL)
+        {
+            //
+            // Not indexed
+            //
+            return;
+        }
+
+        Slot = (Slot + 1) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1);
+    }
+
+    //
+    // Shift the next entries of the cluster back instead of leaving a
+    // tombstone, so the lookups never get slower after removals
+    //
+    NextSlot = Slot;
+
+    while (TRUE)
+    {
+        Index->HashedByPhysicalAddress[Slot].BreakpointDesc = NULL;
+
+        do
+        {
+            NextSlot = (NextSlot + 1) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1);
+
+            if (Index->HashedByPhysicalAddress[NextSlot].BreakpointDesc == NULL)
+            {
+                return;
+            }
+
+            HomeSlot = BreakpointIndexHashPhysicalAddress(Index->HashedByPhysicalAddress[NextSlot].Address);
+
+            //
+            // The entry can be moved only if its home slot is not
+            // cyclically between the empty slot and itself
+            //
+        } while (((NextSlot - HomeSlot) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1)) <
+                 ((NextSlot - Slot) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1)));
+
+        Index->HashedByPhysicalAddress[Slot] = Index->HashedByPhysicalAddress[NextSlot];
+        Slot                                 = NextSlot;
+    }
+}
+
+/**
+ * @brief Find a breakpoint by its virtual address and address space
+ *
+ * @param Index
+ * @param Address
+ * @param AddressSpace
+ *
+ * @return PDEBUGGEE_BP_DESCRIPTOR
+ */
+PDEBUGGEE_BP_DESCRIPTOR
+BreakpointIndexFindByAddress(PBREAKPOINT_INDEX Index, UINT64 Address, UINT64 AddressSpace)
+{
+    PBREAKPOINT_INDEX_ENTRY Entry;
+    UINT32                  Position;
+
+    Position = BreakpointIndexLowerBound(Index, Address, AddressSpace);
+
+    if (Position < Index->CountOfBreakpoints)
+    {
+        Entry = &Index->SortedByAddress[Position];
+
+        if (Entry->Address == Address && Entry->AddressSpace == AddressSpace)
+        {
+            return Entry->BreakpointDesc;
+        }
+    }
+
+    //
+    // We didn't find anything, so return null
+    //
+    return NULL;
+}
+
+/**
+ * @brief Find entry of breakpoint descriptor by physical address
+ * @details this function is called on each #BP vm-exit
+ *
+ * @param Index
+ * @param PhysAddress
+ *
+ * @return PDEBUGGEE_BP_DESCRIPTOR
+ */
+PDEBUGGEE_BP_DESCRIPTOR
+BreakpointIndexFindByPhysicalAddress(PBREAKPOINT_INDEX Index, UINT64 PhysAddress)
+{
+    UINT32 Slot = BreakpointIndexHashPhysicalAddress(PhysAddress);
+
+    while (Index->HashedByPhysicalAddress[Slot].BreakpointDesc != NULL)
+    {
+        if (Index->HashedByPhysicalAddress[Slot].Address == PhysAddress)
+        {
+            return Index->HashedByPhysicalAddress[Slot].BreakpointDesc;
+        }
+
+        Slot = (Slot + 1) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1);
+    }
+
+    return NULL;
+}
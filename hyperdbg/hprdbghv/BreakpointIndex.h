@@ -0,0 +1,83 @@
+/**
+ * @file BreakpointIndex.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the index of breakpoints of 'bp' command
+ * @details The index doesn't depend on any kernel routine, it's allocated
+ * once in vmx non-root and used in both vmx-root and vmx non-root
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum number of breakpoints that can be indexed
+ *
+ */
+#define MAXIMUM_NUMBER_OF_BREAKPOINTS 0x400
+
+/**
+ * @brief Count of slots of the physical address hash table (power of two)
+ *
+ */
+#define BREAKPOINT_INDEX_HASH_TABLE_SIZE (MAXIMUM_NUMBER_OF_BREAKPOINTS * 2)
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief An entry of the breakpoints index
+ *
+ */
+typedef struct _BREAKPOINT_INDEX_ENTRY
+{
+    UINT64                  Address;        // Virtual or physical address based on the table
+    UINT64                  AddressSpace;   // Cr3 of user-mode addresses, zero for kernel addresses
+    PDEBUGGEE_BP_DESCRIPTOR BreakpointDesc; // NULL means the slot is empty
+
+} BREAKPOINT_INDEX_ENTRY, *PBREAKPOINT_INDEX_ENTRY;
+
+/**
+ * @brief Index of breakpoints of 'bp' command
+ * @details Breakpoints are sorted by their virtual address (range queries of
+ * the memory reads) and hashed by their physical address (#BP vm-exits),
+ * it's allocated once as the vmx-root can't allocate memory
+ *
+ */
+typedef struct _BREAKPOINT_INDEX
+{
+    UINT32                 CountOfBreakpoints;
+    BREAKPOINT_INDEX_ENTRY SortedByAddress[MAXIMUM_NUMBER_OF_BREAKPOINTS];
+    BREAKPOINT_INDEX_ENTRY HashedByPhysicalAddress[BREAKPOINT_INDEX_HASH_TABLE_SIZE];
+
+} BREAKPOINT_INDEX, *PBREAKPOINT_INDEX;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT64
+BreakpointIndexGetAddressSpace(UINT64 Address, CR3_TYPE Cr3);
+
+UINT32
+BreakpointIndexLowerBound(PBREAKPOINT_INDEX Index, UINT64 Address, UINT64 AddressSpace);
+
+VOID
+BreakpointIndexInsert(PBREAKPOINT_INDEX Index, PDEBUGGEE_BP_DESCRIPTOR BreakpointDesc, UINT64 AddressSpace);
+
+VOID
+BreakpointIndexRemove(PBREAKPOINT_INDEX Index, PDEBUGGEE_BP_DESCRIPTOR BreakpointDesc);
+
+PDEBUGGEE_BP_DESCRIPTOR
+BreakpointIndexFindByAddress(PBREAKPOINT_INDEX Index, UINT64 Address, UINT64 AddressSpace);
+
+PDEBUGGEE_BP_DESCRIPTOR
+BreakpointIndexFindByPhysicalAddress(PBREAKPOINT_INDEX Index, UINT64 PhysAddress);
@@ -11,118 +11,6 @@
  */
 #include "pch.h"
 
-/**
- * @brief Broadcast to enable mov-to-cr3 exitings
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableMovToCr3Exiting(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enable mov-to-cr3 exiting from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_MOV_TO_CR3_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Broadcast to disable mov-to-cr3 exitings
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableMovToCr3Exiting(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disable mov-to-cr3 exiting from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_DISABLE_MOV_TO_CR3_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Broadcast syscall hook to all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableEferSyscallEvents(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enable Syscall hook from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_SYSCALL_HOOK_EFER, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Broadcast syscall unhook to all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableEferSyscallEvents(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disable Syscall hook from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_DISABLE_SYSCALL_HOOK_EFER, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
 /**
  * @brief Broadcast Msr Write
  * 
@@ -188,175 +76,7 @@ BroadcastDpcReadMsrToAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArg
 }
 
 /**
- * @brief Disable Msr Bitmaps on all cores (vm-exit on all msrs)
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcChangeMsrBitmapReadOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disable msr bitmaps from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_CHANGE_MSR_BITMAP_READ, DeferredContext, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Reset Msr Bitmaps on all cores (vm-exit on all msrs)
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcResetMsrBitmapReadOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Reset msr bitmaps from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_RESET_MSR_BITMAP_READ, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disable Msr Bitmaps on all cores (vm-exit on all msrs)
- * 
- * @param Dpc 
- * @param DeferredContext Msr index to be masked on msr bitmap
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcChangeMsrBitmapWriteOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disable msr bitmaps from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_CHANGE_MSR_BITMAP_WRITE, DeferredContext, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Reset Msr Bitmaps on all cores (vm-exit on all msrs)
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcResetMsrBitmapWriteOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Reset msr bitmaps from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_RESET_MSR_BITMAP_WRITE, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enables rdtsc/rdtscp exiting in primary cpu-based controls
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableRdtscExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enables rdtsc/rdtscp exiting in primary cpu-based controls
-    //
-    AsmVmxVmcall(VMCALL_SET_RDTSC_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disables rdtsc/rdtscp exiting in primary cpu-based controls
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableRdtscExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disables rdtsc/rdtscp exiting in primary cpu-based controls
-    //
-    AsmVmxVmcall(VMCALL_UNSET_RDTSC_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enables rdpmc exiting in primary cpu-based controls
+ * @brief vm-exit and halt the system
  * 
  * @param Dpc 
  * @param DeferredContext 
@@ -365,12 +85,12 @@ BroadcastDpcDisableRdtscExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID
  * @return VOID 
  */
 VOID
-BroadcastDpcEnableRdpmcExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
+BroadcastDpcVmExitAndHaltSystemAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
 {
     //
-    // Enables rdpmc exiting in primary cpu-based controls
+    // vm-exit and halt current core
     //
-    AsmVmxVmcall(VMCALL_SET_RDPMC_EXITING, 0, 0, 0);
+    AsmVmxVmcall(VMCALL_VM_EXIT_HALT_SYSTEM, 0, 0, 0);
 
     //
     // Wait for all DPCs to synchronize at this point
@@ -384,7 +104,7 @@ BroadcastDpcEnableRdpmcExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID
 }
 
 /**
- * @brief Disable rdpmc exiting in primary cpu-based controls
+ * @brief Broadcast to apply the pending updates of the controls
  * 
  * @param Dpc 
  * @param DeferredContext 
@@ -393,442 +113,16 @@ BroadcastDpcEnableRdpmcExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID
  * @return VOID 
  */
 VOID
-BroadcastDpcDisableRdpmcExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
+BroadcastDpcApplyPendingControls(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
 {
     //
-    // Disable rdpmc exiting in primary cpu-based controls
-    //
-    AsmVmxVmcall(VMCALL_UNSET_RDPMC_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enable Exception Bitmaps on all cores
- * 
- * @param Dpc 
- * @param DeferredContext Exception index on IDT
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcSetExceptionBitmapOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enable Exception Bitmaps from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_SET_EXCEPTION_BITMAP, DeferredContext, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Reset Exception Bitmaps on all cores
- * 
- * @param Dpc 
- * @param DeferredContext Exception index on IDT
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcResetExceptionBitmapOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Reset Exception Bitmaps from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_RESET_EXCEPTION_BITMAP, DeferredContext, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enables mov debug registers exitings
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableMovDebigRegisterExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enables mov debug registers exitings in primary cpu-based controls
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_MOV_TO_DEBUG_REGS_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disables mov debug registers exitings
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableMovDebigRegisterExitingAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disable mov debug registers exitings in primary cpu-based controls
-    //
-    AsmVmxVmcall(VMCALL_DISABLE_MOV_TO_DEBUG_REGS_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enable vm-exit on all cores for external interrupts
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcSetEnableExternalInterruptExitingOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enable External Interrupts vm-exit from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_EXTERNAL_INTERRUPT_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disable vm-exit on all cores for external interrupts
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcSetDisableExternalInterruptExitingOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Disable External Interrupts vm-exit from vmx-root
-    //
-    AsmVmxVmcall(VMCALL_DISABLE_EXTERNAL_INTERRUPT_EXITING, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Change I/O Bitmaps on all cores
- * 
- * @param Dpc 
- * @param DeferredContext I/O Port index
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcChangeIoBitmapOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Change I/O Bitmaps on all cores
-    //
-    AsmVmxVmcall(VMCALL_CHANGE_IO_BITMAP, DeferredContext, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Reset I/O Bitmaps on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcResetIoBitmapOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Reset I/O Bitmaps on all cores
-    //
-    AsmVmxVmcall(VMCALL_RESET_IO_BITMAP, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enable breakpoint exiting on exception bitmaps on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableBreakpointOnExceptionBitmapOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Change exception bitmap
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_BREAKPOINT_ON_EXCEPTION_BITMAP, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disable breakpoint exiting on exception bitmaps on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableBreakpointOnExceptionBitmapOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Change exception bitmap
-    //
-    AsmVmxVmcall(VMCALL_DISABLE_BREAKPOINT_ON_EXCEPTION_BITMAP, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enable vm-exit on NMIs on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableNmiVmexitOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Cause vm-exit on NMIs
-    //
-    AsmVmxVmcall(VMCALL_SET_VM_EXIT_ON_NMIS, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disable vm-exit on NMIs on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableNmiVmexitOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Cause no vm-exit on NMIs
-    //
-    AsmVmxVmcall(VMCALL_UNSET_VM_EXIT_ON_NMIS, NULL, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief vm-exit and halt the system
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcVmExitAndHaltSystemAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // vm-exit and halt current core
-    //
-    AsmVmxVmcall(VMCALL_VM_EXIT_HALT_SYSTEM, 0, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Enable vm-exit on #DBs and #BPs on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcEnableDbAndBpExitingOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Cause vm-exit on #BPs
-    //
-    AsmVmxVmcall(VMCALL_SET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_BREAKPOINT, 0, 0);
-
-    //
-    // Cause vm-exit on #DBs
-    //
-    AsmVmxVmcall(VMCALL_SET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_DEBUG_BREAKPOINT, 0, 0);
-
-    //
-    // Wait for all DPCs to synchronize at this point
-    //
-    KeSignalCallDpcSynchronize(SystemArgument2);
-
-    //
-    // Mark the DPC as being complete
-    //
-    KeSignalCallDpcDone(SystemArgument1);
-}
-
-/**
- * @brief Disable vm-exit on #DBs and #BPs on all cores
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-BroadcastDpcDisableDbAndBpExitingOnAllCores(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Cause no vm-exit on #BPs
-    //
-    AsmVmxVmcall(VMCALL_UNSET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_BREAKPOINT, 0, 0);
-
-    //
-    // Cause no vm-exit on #DBs
+    // Apply the pending updates from vmx-root (only if the current
+    // core has pending updates)
     //
-    AsmVmxVmcall(VMCALL_UNSET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_DEBUG_BREAKPOINT, 0, 0);
+    if (g_GuestState[KeGetCurrentProcessorNumber()].PendingControls.CountOfRequests != 0)
+    {
+        AsmVmxVmcall(VMCALL_APPLY_PENDING_CONTROLS, 0, 0, 0);
+    }
 
     //
     // Wait for all DPCs to synchronize at this point
@@ -81,7 +81,7 @@ TestBit(int nth, unsigned long * addr)
 }
 
 /**
- * @brief unset the bit
+ * @brief unset the bit (atomically)
  * 
  * @param nth 
  * @param addr 
@@ -89,11 +89,11 @@ TestBit(int nth, unsigned long * addr)
 void
 ClearBit(int nth, unsigned long * addr)
 {
-    BITMAP_ENTRY(nth, addr) &= ~(1UL << BITMAP_SHIFT(nth));
+    InterlockedAnd((volatile LONG *)&BITMAP_ENTRY(nth, addr), ~(1UL << BITMAP_SHIFT(nth)));
 }
 
 /**
- * @brief set the bit
+ * @brief set the bit (atomically)
  * 
  * @param nth 
  * @param addr 
@@ -101,7 +101,7 @@ ClearBit(int nth, unsigned long * addr)
 void
 SetBit(int nth, unsigned long * addr)
 {
-    BITMAP_ENTRY(nth, addr) |= (1UL << BITMAP_SHIFT(nth));
+    InterlockedOr((volatile LONG *)&BITMAP_ENTRY(nth, addr), 1UL << BITMAP_SHIFT(nth));
 }
 
 /**
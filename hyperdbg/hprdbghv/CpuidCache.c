@@ -0,0 +1,322 @@
+/**
+ * @file CpuidCache.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Per-core cache of CPUID results (used in CPUID vm-exits)
+ * @details CPUID always causes vm-exit, so instead of executing CPUID
+ * in vmx-root for each vm-exit, the results of the processor are kept
+ * in a table for each core
+ *
+ * The leaves that can't be cached are executed each time, and the bits
+ * that reflect the guest's CR4 are fixed after reading the cache
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Check whether the result of a leaf can be cached or not
+ *
+ * @details The sizes that are returned by the extended state enumeration
+ * leaf depend on XCR0 and IA32_XSS, so it's executed each time
+ *
+ * @param Leaf The CPUID leaf
+ * @return BOOLEAN
+ */
+BOOLEAN
+CpuidCacheIsLeafCacheable(UINT32 Leaf)
+{
+    switch (Leaf)
+    {
+    case CPUID_EXTENDED_STATE_ENUMERATION:
+        return FALSE;
+
+    default:
+        return TRUE;
+    }
+}
+
+/**
+ * @brief Ignore the subleaf of the leaves that don't have subleaves
+ *
+ * @details The processor ignores ECX for these leaves, so all of the
+ * subleaves share the same entry
+ *
+ * @param Leaf The CPUID leaf
+ * @param Subleaf The CPUID subleaf (ECX)
+ * @return UINT32 The subleaf to be used as the key of the cache
+ */
+UINT32
+CpuidCacheNormalizeSubleaf(UINT32 Leaf, UINT32 Subleaf)
+{
+    switch (Leaf)
+    {
+    case 0x00000004:
+    case 0x00000007:
+    case 0x0000000b:
+    case 0x0000000d:
+    case 0x0000000f:
+    case 0x00000010:
+    case 0x00000012:
+    case 0x00000014:
+    case 0x00000017:
+    case 0x00000018:
+    case 0x0000001b:
+    case 0x0000001d:
+    case 0x0000001e:
+    case 0x0000001f:
+    case 0x00000020:
+    case 0x00000023:
+    case 0x00000024:
+    case 0x8000001d:
+    case 0x80000020:
+    case 0x80000026:
+        return Subleaf;
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Compute the first slot of a leaf and subleaf in the cache
+ *
+ * @param Leaf The CPUID leaf
+ * @param Subleaf The normalized subleaf
+ * @return UINT32
+ */
+UINT32
+CpuidCacheHash(UINT32 Leaf, UINT32 Subleaf)
+{
+    UINT64 Key = ((UINT64)Leaf << 32) | Subleaf;
+
+    //
+    // Fibonacci hashing, the high bits are better mixed than the low bits
+    //
+    return (UINT32)((Key * 0x9E3779B97F4A7C15ull) >> 32) & (CPUID_CACHE_SIZE - 1);
+}
+
+/**
+ * @brief Find the result of a leaf and subleaf in the cache
+ *
+ * @param Cache The cache of the current core
+ * @param Leaf The CPUID leaf
+ * @param Subleaf The normalized subleaf
+ * @param Registers The array of 4 registers to save EAX, EBX, ECX, EDX
+ * @return BOOLEAN Returns TRUE if the result is in the cache
+ */
+BOOLEAN
+CpuidCacheLookup(PCPUID_CACHE Cache, UINT32 Leaf, UINT32 Subleaf, INT32 * Registers)
+{
+    UINT32             Slot = CpuidCacheHash(Leaf, Subleaf);
+    PCPUID_CACHE_ENTRY Entry;
+
+    //
+    // There is always at least one empty entry, so the probe is finished
+    //
+    while (TRUE)
+    {
+        Entry = &Cache->Entries[Slot];
+
+        if (!Entry->IsValid)
+        {
+            return FALSE;
+        }
+
+        if (Entry->Leaf == Leaf && Entry->Subleaf == Subleaf)
+        {
+            Registers[0] = Entry->Registers[0];
+            Registers[1] = Entry->Registers[1];
+            Registers[2] = Entry->Registers[2];
+            Registers[3] = Entry->Registers[3];
+
+            return TRUE;
+        }
+
+        Slot = (Slot + 1) & (CPUID_CACHE_SIZE - 1);
+    }
+}
+
+/**
+ * @brief Add the result of a leaf and subleaf to the cache
+ *
+ * @param Cache The cache of the current core
+ * @param Leaf The CPUID leaf
+ * @param Subleaf The normalized subleaf
+ * @param Registers The array of 4 registers (EAX, EBX, ECX, EDX)
+ * @return BOOLEAN Returns FALSE if the cache is full
+ */
+BOOLEAN
+CpuidCacheInsert(PCPUID_CACHE Cache, UINT32 Leaf, UINT32 Subleaf, const INT32 * Registers)
+{
+    UINT32             Slot = CpuidCacheHash(Leaf, Subleaf);
+    PCPUID_CACHE_ENTRY Entry;
+
+    if (Cache->CountOfEntries >= CPUID_CACHE_MAXIMUM_ENTRIES)
+    {
+        return FALSE;
+    }
+
+    while (TRUE)
+    {
+        Entry = &Cache->Entries[Slot];
+
+        if (!Entry->IsValid)
+        {
+            Cache->CountOfEntries++;
+            break;
+        }
+
+        if (Entry->Leaf == Leaf && Entry->Subleaf == Subleaf)
+        {
+            break;
+        }
+
+        Slot = (Slot + 1) & (CPUID_CACHE_SIZE - 1);
+    }
+
+    Entry->Leaf         = Leaf;
+    Entry->Subleaf      = Subleaf;
+    Entry->Registers[0] = Registers[0];
+    Entry->Registers[1] = Registers[1];
+    Entry->Registers[2] = Registers[2];
+    Entry->Registers[3] = Registers[3];
+    Entry->IsValid      = TRUE;
+
+    return TRUE;
+}
+
+/**
+ * @brief Remove all of the entries of the cache
+ *
+ * @param Cache The cache of the current core
+ * @return VOID
+ */
+VOID
+CpuidCacheInvalidate(PCPUID_CACHE Cache)
+{
+    RtlZeroMemory(Cache, sizeof(CPUID_CACHE));
+}
+
+/**
+ * @brief Fill the cache with the basic and extended leaves
+ *
+ * @details Should be called on the target core before virtualizing
+ * it, the leaves with subleaves are filled for the first subleaf and
+ * the rest of the leaves and subleaves are cached at the first use
+ *
+ * @param Cache The cache of the current core
+ * @return VOID
+ */
+VOID
+CpuidCacheInitialize(PCPUID_CACHE Cache)
+{
+    INT32  Registers[4];
+    UINT32 LastLeaf;
+
+    CpuidCacheInvalidate(Cache);
+
+    //
+    // Basic leaves
+    //
+    __cpuidex(Registers, 0, 0);
+    LastLeaf = min((UINT32)Registers[0], CPUID_CACHE_LAST_PREFILLED_BASIC_LEAF);
+
+    for (UINT32 Leaf = 0; Leaf <= LastLeaf; Leaf++)
+    {
+        if (CpuidCacheIsLeafCacheable(Leaf))
+        {
+            __cpuidex(Registers, Leaf, 0);
+            CpuidCacheInsert(Cache, Leaf, 0, Registers);
+        }
+    }
+
+    //
+    // Extended leaves
+    //
+    __cpuidex(Registers, CPUID_EXTENDED_FUNCTION_MAXIMUM_AND_IDENTIFIER, 0);
+    LastLeaf = min((UINT32)Registers[0], CPUID_CACHE_LAST_PREFILLED_EXTENDED_LEAF);
+
+    for (UINT32 Leaf = CPUID_EXTENDED_FUNCTION_MAXIMUM_AND_IDENTIFIER; Leaf <= LastLeaf; Leaf++)
+    {
+        __cpuidex(Registers, Leaf, 0);
+        CpuidCacheInsert(Cache, Leaf, 0, Registers);
+    }
+}
+
+/**
+ * @brief Get the result of CPUID from the cache or the processor
+ *
+ * @details The result of the processor is added to the cache if the
+ * leaf is cacheable and there is a free entry
+ *
+ * @param Cache The cache of the current core
+ * @param Leaf The CPUID leaf (EAX)
+ * @param Subleaf The CPUID subleaf (ECX)
+ * @param Registers The array of 4 registers to save EAX, EBX, ECX, EDX
+ * @return VOID
+ */
+VOID
+CpuidCacheQuery(PCPUID_CACHE Cache, UINT32 Leaf, UINT32 Subleaf, INT32 * Registers)
+{
+    if (!CpuidCacheIsLeafCacheable(Leaf))
+    {
+        __cpuidex(Registers, Leaf, Subleaf);
+        return;
+    }
+
+    Subleaf = CpuidCacheNormalizeSubleaf(Leaf, Subleaf);
+
+    if (CpuidCacheLookup(Cache, Leaf, Subleaf, Registers))
+    {
+        return;
+    }
+
+    __cpuidex(Registers, Leaf, Subleaf);
+    CpuidCacheInsert(Cache, Leaf, Subleaf, Registers);
+}
+
+/**
+ * @brief Set the bits of the CPUID result that reflect the guest's CR4
+ *
+ * @details In vmx-root, the CPUID reflects the host's CR4, so these bits
+ * are set based on the guest's CR4 for both cached and executed results
+ *
+ * @param Leaf The CPUID leaf (EAX)
+ * @param Subleaf The CPUID subleaf (ECX)
+ * @param Registers The array of 4 registers (EAX, EBX, ECX, EDX)
+ * @param GuestCr4 The guest's CR4
+ * @return VOID
+ */
+VOID
+CpuidCacheApplyGuestState(UINT32 Leaf, UINT32 Subleaf, INT32 * Registers, UINT64 GuestCr4)
+{
+    CONTROL_REGISTER_4 Cr4 = {0};
+
+    Cr4.Flags = GuestCr4;
+
+    if (Leaf == CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS)
+    {
+        //
+        // CR4.OSXSAVE can't be set if the processor doesn't support XSAVE
+        //
+        Registers[2] &= ~CPUID_FEATURE_ECX_OSXSAVE_BIT;
+
+        if (Cr4.OsXsave)
+        {
+            Registers[2] |= CPUID_FEATURE_ECX_OSXSAVE_BIT;
+        }
+    }
+    else if (Leaf == CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS && Subleaf == 0)
+    {
+        Registers[2] &= ~CPUID_EXTENDED_FEATURE_ECX_OSPKE_BIT;
+
+        if (Cr4.ProtectionKeyEnable)
+        {
+            Registers[2] |= CPUID_EXTENDED_FEATURE_ECX_OSPKE_BIT;
+        }
+    }
+}
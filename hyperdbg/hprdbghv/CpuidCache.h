@@ -0,0 +1,118 @@
+/**
+ * @file CpuidCache.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the per-core cache of CPUID results
+ * @details The lookup and the insertion don't depend on any kernel routine
+ * or vmx instruction, only filling the cache executes the CPUID
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the entries of the cache of each core (power of 2)
+ *
+ */
+#define CPUID_CACHE_SIZE 0x80
+
+/**
+ * @brief Maximum count of the valid entries, the rest of the entries
+ * are kept empty to keep the probes short
+ *
+ */
+#define CPUID_CACHE_MAXIMUM_ENTRIES ((CPUID_CACHE_SIZE * 3) / 4)
+
+/**
+ * @brief The last basic and extended leaves that are filled at the
+ * virtualization time, the other leaves are cached at the first use
+ *
+ */
+#define CPUID_CACHE_LAST_PREFILLED_BASIC_LEAF    0x20
+#define CPUID_CACHE_LAST_PREFILLED_EXTENDED_LEAF 0x80000008
+
+/**
+ * @brief The first extended leaf (returns the last extended leaf)
+ *
+ */
+#define CPUID_EXTENDED_FUNCTION_MAXIMUM_AND_IDENTIFIER 0x80000000
+
+/**
+ * @brief CPUID leaves that their results depend on the guest state
+ *
+ */
+#define CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS 0x00000007
+#define CPUID_EXTENDED_STATE_ENUMERATION        0x0000000d
+
+/**
+ * @brief Bits of the CPUID results that reflect the guest's CR4
+ *
+ */
+#define CPUID_FEATURE_ECX_OSXSAVE_BIT        (1 << 27)
+#define CPUID_EXTENDED_FEATURE_ECX_OSPKE_BIT (1 << 4)
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A cached result of CPUID
+ *
+ */
+typedef struct _CPUID_CACHE_ENTRY
+{
+    UINT32  Leaf;         // EAX of the CPUID
+    UINT32  Subleaf;      // ECX of the CPUID (zero if the leaf doesn't have subleaves)
+    INT32   Registers[4]; // EAX, EBX, ECX, EDX
+    BOOLEAN IsValid;
+
+} CPUID_CACHE_ENTRY, *PCPUID_CACHE_ENTRY;
+
+/**
+ * @brief The cache of CPUID results of a core
+ * @details The entries are kept in an open addressing hash table, the
+ * results are the values of the processor (before the modifications of
+ * HyperDbg)
+ *
+ */
+typedef struct _CPUID_CACHE
+{
+    UINT32            CountOfEntries;
+    CPUID_CACHE_ENTRY Entries[CPUID_CACHE_SIZE];
+
+} CPUID_CACHE, *PCPUID_CACHE;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+CpuidCacheIsLeafCacheable(UINT32 Leaf);
+
+UINT32
+CpuidCacheNormalizeSubleaf(UINT32 Leaf, UINT32 Subleaf);
+
+BOOLEAN
+CpuidCacheLookup(PCPUID_CACHE Cache, UINT32 Leaf, UINT32 Subleaf, INT32 * Registers);
+
+BOOLEAN
+CpuidCacheInsert(PCPUID_CACHE Cache, UINT32 Leaf, UINT32 Subleaf, const INT32 * Registers);
+
+VOID
+CpuidCacheInvalidate(PCPUID_CACHE Cache);
+
+VOID
+CpuidCacheInitialize(PCPUID_CACHE Cache);
+
+VOID
+CpuidCacheQuery(PCPUID_CACHE Cache, UINT32 Leaf, UINT32 Subleaf, INT32 * Registers);
+
+VOID
+CpuidCacheApplyGuestState(UINT32 Leaf, UINT32 Subleaf, INT32 * Registers, UINT64 GuestCr4);
@@ -124,6 +124,35 @@ DebuggerInitialize()
     //
     RtlZeroMemory(g_ScriptGlobalVariables, MAX_VAR_COUNT * sizeof(UINT64));
 
+    //
+    // Allocate the buffers of multi-pattern search, in vmx-root we're not
+    // able to allocate them while the debuggee is halted
+    //
+    if (!g_MultiPatternSearchBuffer)
+    {
+        g_MultiPatternSearchBuffer = ExAllocatePoolWithTag(NonPagedPool, sizeof(AHO_CORASICK_AUTOMATON) + PAGE_SIZE, POOLTAG);
+    }
+
+    if (!g_MultiPatternSearchBuffer)
+    {
+        return FALSE;
+    }
+
+    //
+    // Capture the physical memory ranges, MmGetPhysicalMemoryRanges
+    // can't be called from vmx-root to check the physical addresses
+    // before mapping them
+    //
+    if (!g_PhysicalMemoryRanges)
+    {
+        g_PhysicalMemoryRanges = MmGetPhysicalMemoryRanges();
+    }
+
+    if (!g_PhysicalMemoryRanges)
+    {
+        return FALSE;
+    }
+
     //
     // Initialize the stepping mechanism
     // (USER-MODE STEPPING IS NOT SUPPORTED IN THIS VERSION)
@@ -489,6 +518,7 @@ DebuggerAddActionToEvent(PDEBUGGER_EVENT Event, DEBUGGER_EVENT_ACTION_TYPE_ENUM
         Action->ScriptConfiguration.ScriptLength                = InTheCaseOfRunScript->ScriptLength;
         Action->ScriptConfiguration.ScriptPointer               = InTheCaseOfRunScript->ScriptPointer;
         Action->ScriptConfiguration.OptionalRequestedBufferSize = InTheCaseOfRunScript->OptionalRequestedBufferSize;
+        Action->ScriptConfiguration.SendEventRecords            = InTheCaseOfRunScript->SendEventRecords;
     }
 
     //
@@ -1273,6 +1303,11 @@ DebuggerTerminateAllEvents()
     PLIST_ENTRY TempList            = 0;
     PLIST_ENTRY TempList2           = 0;
 
+    //
+    // The cores are kicked once after all of the events are terminated
+    //
+    PendingControlsBeginBatch();
+
     //
     // We have to iterate through all events
     //
@@ -1301,6 +1336,8 @@ DebuggerTerminateAllEvents()
         }
     }
 
+    PendingControlsEndBatch();
+
     return FindAtLeastOneEvent;
 }
 
@@ -1691,6 +1728,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
     UINT64          PagesBytes;
     UINT32          TempPid;
     UINT32          ProcessorCount;
+    BOOLEAN         IsApplied = TRUE;
 
     ProcessorCount = KeQueryActiveProcessorCount(0);
 
@@ -1881,11 +1919,18 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
         PagesBytes = PAGE_ALIGN(EventDetails->OptionalParam1);
         PagesBytes = EventDetails->OptionalParam2 - PagesBytes;
 
+        //
+        // Hook all of the pages in a single transaction
+        //
+        EptTransactionBegin();
+
         for (size_t i = 0; i <= PagesBytes / PAGE_SIZE; i++)
         {
             DebuggerEventEnableMonitorReadAndWriteForAddress((UINT64)EventDetails->OptionalParam1 + (i * PAGE_SIZE), EventDetails->ProcessId, TRUE, TRUE);
         }
 
+        EptTransactionCommit();
+
         //
         // We convert the Event's optional parameters physical address because
         // vm-exit occurs and we have the physical address to compare in the case of
@@ -1899,11 +1944,18 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
         PagesBytes = PAGE_ALIGN(EventDetails->OptionalParam1);
         PagesBytes = EventDetails->OptionalParam2 - PagesBytes;
 
+        //
+        // Hook all of the pages in a single transaction
+        //
+        EptTransactionBegin();
+
         for (size_t i = 0; i <= PagesBytes / PAGE_SIZE; i++)
         {
             DebuggerEventEnableMonitorReadAndWriteForAddress((UINT64)EventDetails->OptionalParam1 + (i * PAGE_SIZE), EventDetails->ProcessId, TRUE, TRUE);
         }
 
+        EptTransactionCommit();
+
         //
         // We convert the Event's optional parameters physical address because
         // vm-exit occurs and we have the physical address to compare in the case of
@@ -1920,11 +1972,18 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
         PagesBytes = PAGE_ALIGN(EventDetails->OptionalParam1);
         PagesBytes = EventDetails->OptionalParam2 - PagesBytes;
 
+        //
+        // Hook all of the pages in a single transaction
+        //
+        EptTransactionBegin();
+
         for (size_t i = 0; i <= PagesBytes / PAGE_SIZE; i++)
         {
             DebuggerEventEnableMonitorReadAndWriteForAddress((UINT64)EventDetails->OptionalParam1 + (i * PAGE_SIZE), EventDetails->ProcessId, TRUE, TRUE);
         }
 
+        EptTransactionCommit();
+
         //
         // We convert the Event's optional parameters physical address because
         // vm-exit occurs and we have the physical address to compare in the case of
@@ -2009,7 +2068,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformChangeMsrBitmapReadOnSingleCore, EventDetails->OptionalParam1);
+            IsApplied = SharedBitmapsRequestChange(EventDetails->CoreId, VMCALL_CHANGE_MSR_BITMAP_READ, EventDetails->OptionalParam1);
         }
 
         //
@@ -2040,7 +2099,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformChangeMsrBitmapWriteOnSingleCore, EventDetails->OptionalParam1);
+            IsApplied = SharedBitmapsRequestChange(EventDetails->CoreId, VMCALL_CHANGE_MSR_BITMAP_WRITE, EventDetails->OptionalParam1);
         }
 
         //
@@ -2065,7 +2124,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformChangeIoBitmapOnSingleCore, EventDetails->OptionalParam1);
+            IsApplied = SharedBitmapsRequestChange(EventDetails->CoreId, VMCALL_CHANGE_IO_BITMAP, EventDetails->OptionalParam1);
         }
 
         //
@@ -2096,7 +2155,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformEnableRdtscExitingOnSingleCore, NULL);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_SET_RDTSC_EXITING, 0);
         }
     }
     else if (EventDetails->EventType == PMC_INSTRUCTION_EXECUTION)
@@ -2122,7 +2181,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformEnableRdpmcExitingOnSingleCore, NULL);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_SET_RDPMC_EXITING, 0);
         }
     }
     else if (EventDetails->EventType == DEBUG_REGISTERS_ACCESSED)
@@ -2148,7 +2207,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformEnableMovToDebugRegistersExiting, NULL);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_ENABLE_MOV_TO_DEBUG_REGS_EXITING, 0);
         }
     }
     else if (EventDetails->EventType == EXCEPTION_OCCURRED)
@@ -2175,7 +2234,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformSetExceptionBitmapOnSingleCore, EventDetails->OptionalParam1);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_SET_EXCEPTION_BITMAP, EventDetails->OptionalParam1);
         }
 
         //
@@ -2206,7 +2265,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformSetExternalInterruptExitingOnSingleCore, NULL);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_ENABLE_EXTERNAL_INTERRUPT_EXITING, 0);
         }
 
         //
@@ -2237,7 +2296,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformEnableEferSyscallHookOnSingleCore, NULL);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_ENABLE_SYSCALL_HOOK_EFER, 0);
         }
 
         //
@@ -2268,7 +2327,7 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
             //
             // Just one core
             //
-            DpcRoutineRunTaskOnSingleCore(EventDetails->CoreId, DpcRoutinePerformEnableEferSyscallHookOnSingleCore, NULL);
+            IsApplied = PendingControlsRequest(EventDetails->CoreId, VMCALL_ENABLE_SYSCALL_HOOK_EFER, 0);
         }
         //
         // Set the event's target syscall number
@@ -2307,6 +2366,20 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
         return FALSE;
     }
 
+    //
+    // The change of the controls or the bitmaps of the core is not queued,
+    // the event is removed as it would never be triggered
+    //
+    if (!IsApplied)
+    {
+        DebuggerTerminateEvent(Event->Tag);
+        DebuggerRemoveEvent(Event->Tag);
+
+        ResultsToReturnUsermode->IsSuccessful = FALSE;
+        ResultsToReturnUsermode->Error        = DEBUGGER_ERROR_UNABLE_TO_APPLY_EVENT;
+        return FALSE;
+    }
+
     //
     // Set the status
     //
@@ -2382,7 +2455,12 @@ DebuggerParseActionFromUsermode(PDEBUGGER_GENERAL_ACTION Action, UINT32 BufferLe
         //
         // Add action to event
         //
-        DebuggerAddActionToEvent(Event, RUN_CUSTOM_CODE, Action->ImmediateMessagePassing, &CustomCode, NULL);
+        if (DebuggerAddActionToEvent(Event, RUN_CUSTOM_CODE, Action->ImmediateMessagePassing, &CustomCode, NULL) == NULL)
+        {
+            ResultsToReturnUsermode->IsSuccessful = FALSE;
+            ResultsToReturnUsermode->Error        = DEBUGGER_ERROR_UNABLE_TO_ADD_ACTION_TO_EVENT;
+            return FALSE;
+        }
 
         //
         // Enable the event
@@ -2416,8 +2494,14 @@ DebuggerParseActionFromUsermode(PDEBUGGER_GENERAL_ACTION Action, UINT32 BufferLe
         UserScriptConfig.ScriptLength                                   = Action->ScriptBufferSize;
         UserScriptConfig.ScriptPointer                                  = Action->ScriptBufferPointer;
         UserScriptConfig.OptionalRequestedBufferSize                    = Action->PreAllocatedBuffer;
+        UserScriptConfig.SendEventRecords                               = Action->SendEventRecords;
 
-        DebuggerAddActionToEvent(Event, RUN_SCRIPT, Action->ImmediateMessagePassing, NULL, &UserScriptConfig);
+        if (DebuggerAddActionToEvent(Event, RUN_SCRIPT, Action->ImmediateMessagePassing, NULL, &UserScriptConfig) == NULL)
+        {
+            ResultsToReturnUsermode->IsSuccessful = FALSE;
+            ResultsToReturnUsermode->Error        = DEBUGGER_ERROR_UNABLE_TO_ADD_ACTION_TO_EVENT;
+            return FALSE;
+        }
 
         //
         // Enable the event
@@ -2429,7 +2513,12 @@ DebuggerParseActionFromUsermode(PDEBUGGER_GENERAL_ACTION Action, UINT32 BufferLe
         //
         // Add action BREAK_TO_DEBUGGER to event
         //
-        DebuggerAddActionToEvent(Event, BREAK_TO_DEBUGGER, Action->ImmediateMessagePassing, NULL, NULL);
+        if (DebuggerAddActionToEvent(Event, BREAK_TO_DEBUGGER, Action->ImmediateMessagePassing, NULL, NULL) == NULL)
+        {
+            ResultsToReturnUsermode->IsSuccessful = FALSE;
+            ResultsToReturnUsermode->Error        = DEBUGGER_ERROR_UNABLE_TO_ADD_ACTION_TO_EVENT;
+            return FALSE;
+        }
 
         //
         // Enable the event
@@ -2456,6 +2545,195 @@ DebuggerParseActionFromUsermode(PDEBUGGER_GENERAL_ACTION Action, UINT32 BufferLe
     return TRUE;
 }
 
+/**
+ * @brief Validate the layout of a batch of events that came from
+ * the user-mode
+ * @details The sizes of all of the entries, events and actions are
+ * checked before registering any of the events
+ *
+ * @param Batch The batch that came from user-mode
+ * @param BufferLength Length of the buffer
+ * @return BOOLEAN TRUE if the layout is valid, otherwise FALSE
+ */
+BOOLEAN
+DebuggerValidateEventsBatch(PDEBUGGER_EVENTS_BATCH Batch, UINT32 BufferLength)
+{
+    PDEBUGGER_EVENTS_BATCH_ENTRY   Entry;
+    PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails;
+    PDEBUGGER_GENERAL_ACTION       Action;
+    UINT64                         Offset;
+    UINT64                         EntryOffset;
+
+    if (Batch->Size < SIZEOF_DEBUGGER_EVENTS_BATCH ||
+        Batch->Size > BufferLength ||
+        Batch->CountOfEntries == 0)
+    {
+        return FALSE;
+    }
+
+    Offset = SIZEOF_DEBUGGER_EVENTS_BATCH;
+
+    for (UINT32 i = 0; i < Batch->CountOfEntries; i++)
+    {
+        if (Offset + SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY > Batch->Size)
+        {
+            return FALSE;
+        }
+
+        Entry = (PDEBUGGER_EVENTS_BATCH_ENTRY)((UINT64)Batch + Offset);
+
+        if (Entry->Size < SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY ||
+            Offset + Entry->Size > Batch->Size ||
+            Entry->CountOfActions > DEBUGGER_EVENTS_BATCH_MAXIMUM_ACTIONS ||
+            Entry->EventLength < sizeof(DEBUGGER_GENERAL_EVENT_DETAIL))
+        {
+            return FALSE;
+        }
+
+        //
+        // Check the event and its condition buffer
+        //
+        EntryOffset = SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY + DEBUGGER_EVENTS_BATCH_ALIGN((UINT64)Entry->EventLength);
+
+        if (EntryOffset > Entry->Size)
+        {
+            return FALSE;
+        }
+
+        EventDetails = (PDEBUGGER_GENERAL_EVENT_DETAIL)((UINT64)Entry + SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY);
+
+        if (sizeof(DEBUGGER_GENERAL_EVENT_DETAIL) + (UINT64)EventDetails->ConditionBufferSize > Entry->EventLength)
+        {
+            return FALSE;
+        }
+
+        //
+        // Check the actions, all of them should belong to this event
+        //
+        for (UINT32 j = 0; j < Entry->CountOfActions; j++)
+        {
+            if (Entry->ActionLengths[j] < sizeof(DEBUGGER_GENERAL_ACTION) ||
+                EntryOffset + DEBUGGER_EVENTS_BATCH_ALIGN((UINT64)Entry->ActionLengths[j]) > Entry->Size)
+            {
+                return FALSE;
+            }
+
+            Action = (PDEBUGGER_GENERAL_ACTION)((UINT64)Entry + EntryOffset);
+
+            if (Action->EventTag != EventDetails->Tag ||
+                sizeof(DEBUGGER_GENERAL_ACTION) + (UINT64)Action->CustomCodeBufferSize + (UINT64)Action->ScriptBufferSize > Entry->ActionLengths[j])
+            {
+                return FALSE;
+            }
+
+            EntryOffset += DEBUGGER_EVENTS_BATCH_ALIGN((UINT64)Entry->ActionLengths[j]);
+        }
+
+        Offset += Entry->Size;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Routine for validating and registering a batch of events and
+ * their actions that came from user-mode
+ * @details The layout of the whole batch is validated first, then all of
+ * the events are registered, the EPT changes of all of them are committed
+ * in one transaction and the cores are kicked once for all of the changes
+ * of the controls and the bitmaps, an event is removed if any of its
+ * actions is not added
+ *
+ * @param Batch The batch that came from user-mode, the result of each
+ * entry is written to the same buffer
+ * @param BufferLength Length of the buffer
+ * @return BOOLEAN TRUE if the batch was valid, otherwise FALSE
+ */
+BOOLEAN
+DebuggerParseEventsBatchFromUsermode(PDEBUGGER_EVENTS_BATCH Batch, UINT32 BufferLength)
+{
+    PDEBUGGER_EVENTS_BATCH_ENTRY   Entry;
+    PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails;
+    PDEBUGGER_GENERAL_ACTION       Action;
+    UINT64                         Offset;
+    UINT64                         EntryOffset;
+
+    Batch->CountOfRegisteredEvents = 0;
+
+    if (!DebuggerValidateEventsBatch(Batch, BufferLength))
+    {
+        Batch->KernelStatus = DEBUGGER_ERROR_EVENTS_BATCH_INVALID_LAYOUT;
+        return FALSE;
+    }
+
+    //
+    // Stage the changes of all of the events
+    //
+    EptTransactionBegin();
+    PendingControlsBeginBatch();
+
+    Offset = SIZEOF_DEBUGGER_EVENTS_BATCH;
+
+    for (UINT32 i = 0; i < Batch->CountOfEntries; i++)
+    {
+        Entry        = (PDEBUGGER_EVENTS_BATCH_ENTRY)((UINT64)Batch + Offset);
+        EventDetails = (PDEBUGGER_GENERAL_EVENT_DETAIL)((UINT64)Entry + SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY);
+
+        RtlZeroMemory(&Entry->ActionsResult, sizeof(DEBUGGER_EVENT_AND_ACTION_REG_BUFFER));
+
+        if (DebuggerParseEventFromUsermode(EventDetails, Entry->EventLength, &Entry->EventResult))
+        {
+            Batch->CountOfRegisteredEvents++;
+
+            //
+            // Add the actions, the event is enabled by its first action
+            //
+            Entry->ActionsResult.IsSuccessful = TRUE;
+            EntryOffset                       = SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY + DEBUGGER_EVENTS_BATCH_ALIGN((UINT64)Entry->EventLength);
+
+            for (UINT32 j = 0; j < Entry->CountOfActions; j++)
+            {
+                Action = (PDEBUGGER_GENERAL_ACTION)((UINT64)Entry + EntryOffset);
+
+                if (!DebuggerParseActionFromUsermode(Action, Entry->ActionLengths[j], &Entry->ActionsResult))
+                {
+                    break;
+                }
+
+                EntryOffset += DEBUGGER_EVENTS_BATCH_ALIGN((UINT64)Entry->ActionLengths[j]);
+            }
+
+            //
+            // An event without all of its actions is not registered, the
+            // event and the actions that are added are removed (the changes
+            // of the event are staged in the same transaction and batch)
+            //
+            if (!Entry->ActionsResult.IsSuccessful)
+            {
+                DebuggerTerminateEvent(EventDetails->Tag);
+                DebuggerRemoveEvent(EventDetails->Tag);
+
+                Entry->EventResult.IsSuccessful = FALSE;
+                Entry->EventResult.Error        = Entry->ActionsResult.Error;
+
+                Batch->CountOfRegisteredEvents--;
+            }
+        }
+
+        Offset += Entry->Size;
+    }
+
+    //
+    // Apply the changes of all of the events at once
+    //
+    PendingControlsEndBatch();
+    EptTransactionCommit();
+
+    Batch->KernelStatus = DEBUGEER_OPERATION_WAS_SUCCESSFULL;
+
+    return TRUE;
+}
+
 /**
  * @brief Terminate one event's effect by its tag
  * 
@@ -2485,6 +2763,12 @@ DebuggerTerminateEvent(UINT64 Tag)
         return FALSE;
     }
 
+    //
+    // The terminators reset the controls and re-apply the rest of the
+    // events, the cores are kicked once for all of these updates
+    //
+    PendingControlsBeginBatch();
+
     //
     // Check the event type of our specific tag
     //
@@ -2656,6 +2940,10 @@ DebuggerTerminateEvent(UINT64 Tag)
         LogError("Uknown event for termination.");
         break;
     }
+
+    PendingControlsEndBatch();
+
+    return TRUE;
 }
 
 /**
@@ -194,6 +194,12 @@ DebuggerParseEventFromUsermode(PDEBUGGER_GENERAL_EVENT_DETAIL EventDetails, UINT
 BOOLEAN
 DebuggerParseActionFromUsermode(PDEBUGGER_GENERAL_ACTION Action, UINT32 BufferLength, PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER ResultsToReturnUsermode);
 
+BOOLEAN
+DebuggerValidateEventsBatch(PDEBUGGER_EVENTS_BATCH Batch, UINT32 BufferLength);
+
+BOOLEAN
+DebuggerParseEventsBatchFromUsermode(PDEBUGGER_EVENTS_BATCH Batch, UINT32 BufferLength);
+
 BOOLEAN
 DebuggerParseEventsModificationFromUsermode(PDEBUGGER_MODIFY_EVENTS DebuggerEventModificationRequest);
 
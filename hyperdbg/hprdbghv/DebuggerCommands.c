@@ -57,9 +57,8 @@ DebuggerCommandReadMemoryVmxRoot(PDEBUGGER_READ_MEMORY ReadMemRequest, UCHAR * U
     UINT32                    Pid;
     UINT32                    Size;
     UINT64                    Address;
-    UINT64                    OffsetInUserBuffer;
     DEBUGGER_READ_MEMORY_TYPE MemType;
-    PLIST_ENTRY               TempList = 0;
+    CR3_TYPE                  ProcessCr3;
 
     Pid     = ReadMemRequest->Pid;
     Size    = ReadMemRequest->Size;
@@ -93,37 +92,10 @@ DebuggerCommandReadMemoryVmxRoot(PDEBUGGER_READ_MEMORY ReadMemRequest, UCHAR * U
         //
         // Check if the target memory is filled with breakpoint of 'bp' commands
         // if the memory is changed due to this command, then we'll changes it to
-        // the previous byte
+        // the previous byte (the memory is read from the current process)
         //
-
-        //
-        // Iterate through the breakpoint list
-        //
-        TempList = &g_BreakpointsListHead;
-
-        while (&g_BreakpointsListHead != TempList->Flink)
-        {
-            TempList                                      = TempList->Flink;
-            PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(TempList, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
-
-            if (CurrentBreakpointDesc->Address >= Address && CurrentBreakpointDesc->Address <= Address + Size)
-            {
-                //
-                // The address is found, we have to swap the byte if the target
-                // byte is 0xcc
-                //
-
-                //
-                // Find the address location at user buffer
-                //
-                OffsetInUserBuffer = CurrentBreakpointDesc->Address - Address;
-
-                if (UserBuffer[OffsetInUserBuffer] == 0xcc)
-                {
-                    UserBuffer[OffsetInUserBuffer] = CurrentBreakpointDesc->PreviousByte;
-                }
-            }
-        }
+        ProcessCr3.Flags = ((NT_KPROCESS *)PsGetCurrentProcess())->DirectoryTableBase;
+        BreakpointRestoreOriginalBytesOfBuffer(ProcessCr3, Address, UserBuffer, Size);
     }
     else
     {
@@ -501,454 +473,969 @@ DebuggerCommandEditMemoryVmxRoot(PDEBUGGER_EDIT_MEMORY EditMemRequest)
 }
 
 /**
- * @brief Search on virtual memory (not work on physical memory)
- * 
+ * @brief Check whether a physical page is a part of the RAM
+ * @details Pages that are not described in the physical memory ranges
+ * (MMIO, etc.) should not be mapped and read by the search routines
+ *
+ * @param PhysicalMemoryRanges Result of MmGetPhysicalMemoryRanges
+ * @param PhysicalAddress Physical address to check
+ * @return BOOLEAN
+ */
+BOOLEAN
+SearchMemoryIsPhysicalAddressValid(PPHYSICAL_MEMORY_RANGE PhysicalMemoryRanges, UINT64 PhysicalAddress)
+{
+    for (UINT32 i = 0; PhysicalMemoryRanges[i].NumberOfBytes.QuadPart != 0; i++)
+    {
+        if (PhysicalAddress >= PhysicalMemoryRanges[i].BaseAddress.QuadPart &&
+            PhysicalAddress < PhysicalMemoryRanges[i].BaseAddress.QuadPart + PhysicalMemoryRanges[i].NumberOfBytes.QuadPart)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Translate a batch of virtual pages to their physical addresses
+ * based on the target process memory layout
+ *
  * @details This function should NOT be called from vmx-root mode
- * Do NOT directly call this function as the virtual addresses
- * should be valid on the target process memory layout
- * instead call : SearchAddressWrapper
- * the address between StartAddress and EndAddress should be contiguous
- * 
- * @param AddressToSaveResults Address to save the search results
- * @param SearchMemRequest request structure of searching memory
- * @param StartAddress valid start address based on target process
- * @param EndAddress valid end address based on target process
- * @return VOID the results won't be returned, instead will be
- * saved into AddressToSaveResults
+ * the non-present pages are translated to NULL
+ *
+ * @param TargetCr3 Kernel cr3 of the target process
+ * @param StartAddress The first virtual address
+ * @param PhysicalAddresses Array to save the physical addresses
+ * @param Count Count of pages
+ * @return VOID
  */
 VOID
-PerformSearchAddress(UINT64 *                AddressToSaveResults,
-                     PDEBUGGER_SEARCH_MEMORY SearchMemRequest,
-                     UINT64                  StartAddress,
-                     UINT64                  EndAddress)
+SearchMemoryTranslateVirtualPages(CR3_TYPE TargetCr3, UINT64 StartAddress, UINT64 * PhysicalAddresses, UINT32 Count)
 {
-    UINT64   Cmp64                 = 0;
-    UINT32   IndexToArrayOfResults = 0;
-    UINT32   LengthOfEachChunk     = 0;
-    PVOID    DestinationAddress    = 0;
-    PVOID    SourceAddress         = 0;
-    PVOID    TempSourceAddress     = 0;
-    BOOLEAN  StillMatch            = FALSE;
     CR3_TYPE CurrentProcessCr3;
+    KIRQL    OldIrql;
 
     //
-    // set chunk size in each modification
+    // We don't want to be scheduled out while the cr3 is changed
     //
-    if (SearchMemRequest->ByteSize == SEARCH_BYTE)
-    {
-        LengthOfEachChunk = 1;
-    }
-    else if (SearchMemRequest->ByteSize == SEARCH_DWORD)
+    OldIrql = KeRaiseIrqlToDpcLevel();
+
+    CurrentProcessCr3 = SwitchOnAnotherProcessMemoryLayoutByCr3(TargetCr3);
+
+    for (UINT32 i = 0; i < Count; i++)
     {
-        LengthOfEachChunk = 4;
+        PhysicalAddresses[i] = VirtualAddressToPhysicalAddress((PVOID)((UINT64)PAGE_ALIGN(StartAddress) + (i * PAGE_SIZE)));
+
+        if (PhysicalAddresses[i] != NULL)
+        {
+            //
+            // Keep the offset of the first address
+            //
+            PhysicalAddresses[i] = (UINT64)PAGE_ALIGN(PhysicalAddresses[i]) + (i == 0 ? (StartAddress & PAGE_4KB_OFFSET) : 0);
+        }
     }
-    else if (SearchMemRequest->ByteSize == SEARCH_QWORD)
+
+    RestoreToPreviousProcess(CurrentProcessCr3);
+
+    KeLowerIrql(OldIrql);
+}
+
+/**
+ * @brief Search a range of virtual or physical memory page-by-page
+ *
+ * @details This function should NOT be called from vmx-root mode
+ * each run of valid pages is read through the memory mapper (scatter/gather)
+ * into a window that also holds the last (pattern length - 1) bytes of the
+ * previous run, so the matches that cross the page boundaries are also
+ * found; non-present virtual pages and physical pages that are not a part
+ * of the RAM are skipped
+ *
+ * @param SearchMemRequest request structure of searching memory
+ * @param Pattern The compiled pattern
+ * @param ResultsContext Context to save the results
+ * @param Window Buffer of SEARCH_MEMORY_WINDOW_SIZE bytes
+ * @return BOOLEAN Returns TRUE if the whole range is searched and FALSE if
+ * the search is stopped because the results buffer is full
+ */
+BOOLEAN
+SearchMemoryPerformSearch(PDEBUGGER_SEARCH_MEMORY        SearchMemRequest,
+                          PSEARCH_ENGINE_PATTERN         Pattern,
+                          PSEARCH_ENGINE_RESULTS_CONTEXT ResultsContext,
+                          UCHAR *                        Window)
+{
+    UINT64                             CurrentAddress       = SearchMemRequest->Address;
+    UINT64                             EndAddress           = SearchMemRequest->Address + SearchMemRequest->Length;
+    UINT64                             RunAddress           = 0;
+    UINT64                             ChunkSize            = 0;
+    UINT32                             CarrySize            = 0;
+    UINT32                             RunSize              = 0;
+    UINT32                             IndexInBatch         = SEARCH_MEMORY_PAGES_PER_BATCH;
+    UINT32                             CountOfEntries       = 0;
+    UINT64                             PhysicalAddress      = 0;
+    BOOLEAN                            IsRunBroken          = FALSE;
+    BOOLEAN                            UseAvx2              = FALSE;
+    BOOLEAN                            Result               = TRUE;
+    KIRQL                              OldIrql;
+    CR3_TYPE                           TargetCr3            = {0};
+    XSTATE_SAVE                        XStateSave           = {0};
+    PPHYSICAL_MEMORY_RANGE             PhysicalMemoryRanges = NULL;
+    UINT64                             PhysicalAddresses[SEARCH_MEMORY_PAGES_PER_BATCH];
+    MEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries[MEMORY_MAPPER_WINDOW_PAGES];
+
+    if (SearchMemRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
     {
-        LengthOfEachChunk = 8;
+        TargetCr3 = GetCr3FromProcessId(SearchMemRequest->ProcessId);
+
+        if (TargetCr3.Flags == NULL)
+        {
+            return TRUE;
+        }
     }
     else
     {
-        //
-        // Invalid parameter
-        //
-        return;
+        PhysicalMemoryRanges = MmGetPhysicalMemoryRanges();
+
+        if (PhysicalMemoryRanges == NULL)
+        {
+            return TRUE;
+        }
     }
 
     //
-    // Check if address is virtual address or physical address
+    // The extended state should be saved before using ymm registers
     //
-    if (SearchMemRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
+    if (SearchEngineIsAvx2Supported() && NT_SUCCESS(KeSaveExtendedProcessorState(XSTATE_MASK_AVX, &XStateSave)))
     {
-        //
-        // Search the memory
-        //
+        UseAvx2 = TRUE;
+    }
 
-        //
-        // Change the memory layout (cr3), if the user specified a
-        // special process
-        //
-        if (SearchMemRequest->ProcessId != PsGetCurrentProcessId())
-        {
-            CurrentProcessCr3 = SwitchOnAnotherProcessMemoryLayout(SearchMemRequest->ProcessId);
-        }
+    while (CurrentAddress < EndAddress && CurrentAddress >= SearchMemRequest->Address)
+    {
+        RunAddress     = CurrentAddress;
+        RunSize        = 0;
+        CountOfEntries = 0;
+        IsRunBroken    = FALSE;
 
         //
-        // Here we iterate through the buffer we received from
-        // user-mode
+        // Collect a run of valid pages to be read at once
         //
-        SourceAddress = (UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY;
-
-        for (size_t BaseIterator = (size_t)StartAddress; BaseIterator < ((DWORD64)EndAddress); BaseIterator += LengthOfEachChunk)
+        while (CountOfEntries < MEMORY_MAPPER_WINDOW_PAGES &&
+               CurrentAddress < EndAddress &&
+               CurrentAddress >= SearchMemRequest->Address)
         {
             //
-            // Copy 64bit, 32bit or one byte value into Cmp64 buffer and then compare it
+            // Read until the end of the current page or the end of the range
             //
-            RtlCopyMemory(&Cmp64, (PVOID)BaseIterator, LengthOfEachChunk);
+            ChunkSize = min((UINT64)PAGE_ALIGN(CurrentAddress) + PAGE_SIZE, EndAddress) - CurrentAddress;
 
-            //
-            // Search the memory
-            //
-            // Check whether the byte matches the source or not
-            //
-            if (Cmp64 == *(UINT64 *)SourceAddress)
+            if (SearchMemRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
             {
                 //
-                // Indicate that it matches until now
-                //
-                StillMatch = TRUE;
-
-                //
-                // Try to check each element (we don't start from the very first element as
-                // it checked before )
+                // Translate the pages in batches to avoid changing cr3 for each page
                 //
-                for (size_t i = LengthOfEachChunk; i < SearchMemRequest->CountOf64Chunks; i++)
+                if (IndexInBatch == SEARCH_MEMORY_PAGES_PER_BATCH)
                 {
-                    //
-                    // I know, we have a double check here ;)
-                    //
-                    TempSourceAddress = (UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY + (i * sizeof(UINT64));
-
-                    //
-                    // Add i to BaseIterator and recompute the Cmp64
-                    //
-                    RtlCopyMemory(&Cmp64, (PVOID)(BaseIterator + (LengthOfEachChunk * i)), LengthOfEachChunk);
-
-                    if (!(Cmp64 == *(UINT64 *)TempSourceAddress))
-                    {
-                        //
-                        // One thing didn't match so this is not the pattern
-                        //
-                        StillMatch = FALSE;
-
-                        //
-                        // Break from the loop
-                        //
-                        break;
-                    }
+                    SearchMemoryTranslateVirtualPages(TargetCr3, CurrentAddress, PhysicalAddresses, SEARCH_MEMORY_PAGES_PER_BATCH);
+                    IndexInBatch = 0;
                 }
 
+                PhysicalAddress = PhysicalAddresses[IndexInBatch];
+                IndexInBatch++;
+            }
+            else
+            {
+                PhysicalAddress = SearchMemoryIsPhysicalAddressValid(PhysicalMemoryRanges, CurrentAddress) ? CurrentAddress : NULL;
+            }
+
+            CurrentAddress += ChunkSize;
+
+            if (PhysicalAddress == NULL)
+            {
                 //
-                // Check if we find the pattern or not
+                // The page is not valid, the memory is not contiguous anymore
                 //
-                if (StillMatch)
-                {
-                    //
-                    // We found the a matching address, let's save the
-                    // address for future use
-                    //
-                    AddressToSaveResults[IndexToArrayOfResults] = BaseIterator;
-                    //
-                    // Increase the array pointer if it doesn't exceed the limitation
-                    //
-                    if (MaximumSearchResults > IndexToArrayOfResults)
-                    {
-                        IndexToArrayOfResults++;
-                    }
-                    else
-                    {
-                        //
-                        // The result buffer is full !
-                        //
-                        return;
-                    }
-                }
+                IsRunBroken = TRUE;
+                break;
             }
-            else
+
+            Entries[CountOfEntries].PhysicalAddress = PhysicalAddress;
+            Entries[CountOfEntries].Buffer          = Window + CarrySize + RunSize;
+            Entries[CountOfEntries].Size            = ChunkSize;
+            CountOfEntries++;
+
+            RunSize += (UINT32)ChunkSize;
+        }
+
+        if (CountOfEntries != 0)
+        {
+            //
+            // We don't want to move to another core while the per-core
+            // window of the memory mapper is used
+            //
+            OldIrql = KeRaiseIrqlToDpcLevel();
+            MemoryMapperReadMemoryScatterGather(Entries, CountOfEntries);
+            KeLowerIrql(OldIrql);
+
+            //
+            // The last bytes are carried for the matches that cross the boundary
+            //
+            if (!SearchEngineScanRun(Pattern,
+                                     Window,
+                                     &CarrySize,
+                                     RunSize,
+                                     RunAddress,
+                                     UseAvx2,
+                                     SearchEngineSaveResultCallback,
+                                     ResultsContext))
             {
                 //
-                // Not found in the place
+                // Results buffer is full
                 //
-                continue;
+                Result = FALSE;
+                break;
             }
         }
 
-        //
-        // Restore the previous memory layout (cr3), if the user specified a
-        // special process
-        //
-        if (SearchMemRequest->ProcessId != PsGetCurrentProcessId())
+        if (IsRunBroken)
         {
-            RestoreToPreviousProcess(CurrentProcessCr3);
+            CarrySize = 0;
         }
     }
-    else if (SearchMemRequest->MemoryType == SEARCH_PHYSICAL_MEMORY)
+
+    if (UseAvx2)
     {
-        DbgBreakPoint();
+        KeRestoreExtendedProcessorState(&XStateSave);
     }
-    else
+
+    if (PhysicalMemoryRanges != NULL)
     {
-        //
-        // Invalid parameter
-        //
-        return;
+        ExFreePool(PhysicalMemoryRanges);
     }
+
+    return Result;
 }
 
 /**
- * @brief The wrapper to check for validity of addresses and call
- * the search routines for both physical and virtual memory
- * 
- * @details This function should NOT be called from vmx-root mode
- * The address between start address and end address will be checked
- * to make a contiguous address
- * 
- * @param AddressToSaveResults Address to save the search results
- * @param SearchMemRequest request structure of searching memory
- * @param StartAddress start address of searching based on target process
- * @param EndAddress start address of searching based on target process
- * @return VOID the results won't be returned, instead will be
- * saved into AddressToSaveResults 
+ * @brief Start searching memory
+ *
+ * @details The results are saved after the SearchMemRequest structure, if
+ * there are more than MaximumSearchResults results, then IsSearchFinished is
+ * FALSE and the user-mode should continue the search from NextAddressToSearch
+ *
+ * @param SearchMemRequest Request to search memory
+ * @return NTSTATUS
  */
-VOID
-SearchAddressWrapper(PUINT64 AddressToSaveResults, PDEBUGGER_SEARCH_MEMORY SearchMemRequest, UINT64 StartAddress, UINT64 EndAddress)
+NTSTATUS
+DebuggerCommandSearchMemory(PDEBUGGER_SEARCH_MEMORY SearchMemRequest)
 {
-    CR3_TYPE CurrentProcessCr3;
-    UINT32   ProcId              = 0;
-    UINT64   BaseAddress         = 0;
-    UINT64   CurrentValue        = 0;
-    UINT64   RealPhysicalAddress = 0;
-    BOOLEAN  DoesBaseAddrSaved   = FALSE;
+    PSEARCH_ENGINE_PATTERN        Pattern        = NULL;
+    UCHAR *                       Window         = NULL;
+    SEARCH_ENGINE_RESULTS_CONTEXT ResultsContext = {0};
+    BOOLEAN                       IsFinished;
 
-    if (SearchMemRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
+    SearchMemRequest->CountOfResults   = 0;
+    SearchMemRequest->IsSearchFinished = TRUE;
+
+    //
+    // Check if process id is valid or not
+    //
+    if (SearchMemRequest->MemoryType == SEARCH_VIRTUAL_MEMORY &&
+        SearchMemRequest->ProcessId != PsGetCurrentProcessId() &&
+        !IsProcessExist(SearchMemRequest->ProcessId))
     {
-        //
-        // It's a virtual address search
-        //
+        SearchMemRequest->KernelStatus = DEBUGEER_ERROR_INVALID_PROCESS_ID;
+        return STATUS_INVALID_PARAMETER;
+    }
 
-        //
-        // Align the page and search with alignement
-        //
-        StartAddress = PAGE_ALIGN(StartAddress);
+    if (SearchMemRequest->MemoryType != SEARCH_VIRTUAL_MEMORY && SearchMemRequest->MemoryType != SEARCH_PHYSICAL_MEMORY)
+    {
+        SearchMemRequest->KernelStatus = DEBUGGER_ERROR_MEMORY_TYPE_INVALID;
+        return STATUS_INVALID_PARAMETER;
+    }
 
-        //
-        // Switch to new process's memory layout
-        //
-        CurrentProcessCr3 = SwitchOnAnotherProcessMemoryLayout(SearchMemRequest->ProcessId);
+    Pattern = ExAllocatePoolWithTag(NonPagedPool, sizeof(SEARCH_ENGINE_PATTERN), POOLTAG);
+    Window  = ExAllocatePoolWithTag(NonPagedPool, SEARCH_MEMORY_WINDOW_SIZE, POOLTAG);
 
-        //
-        // We will try to find a contigues address
-        //
-        while (StartAddress < EndAddress)
+    if (Pattern == NULL || Window == NULL)
+    {
+        SearchMemRequest->KernelStatus = DEBUGGER_ERROR_SEARCH_MEMORY_INSUFFICIENT_RESOURCES;
+
+        if (Pattern != NULL)
         {
-            //
-            // Check if address is valid or not
-            // Generally, we can use VirtualAddressToPhysicalAddressByProcessId
-            // but let's not change the cr3 multiple times
-            //
-            if (VirtualAddressToPhysicalAddress(StartAddress, SearchMemRequest->ProcessId) != 0)
-            {
-                //
-                // Address is valid, let's add a page size to it
-                // nothing to do
-                //
-                if (!DoesBaseAddrSaved)
-                {
-                    BaseAddress       = StartAddress;
-                    DoesBaseAddrSaved = TRUE;
-                }
-            }
-            else
-            {
-                //
-                // Address is not valid anymore
-                //
-                break;
-            }
-            StartAddress += PAGE_SIZE;
+            ExFreePoolWithTag(Pattern, POOLTAG);
+        }
+        if (Window != NULL)
+        {
+            ExFreePoolWithTag(Window, POOLTAG);
         }
 
-        //
-        // Restore the original process
-        //
-        RestoreToPreviousProcess(CurrentProcessCr3);
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    //
+    // Compile the pattern before overwriting the values with the results
+    //
+    if (!SearchEngineCompilePatternFromSearchRequest(Pattern, SearchMemRequest))
+    {
+        SearchMemRequest->KernelStatus = DEBUGGER_ERROR_SEARCH_MEMORY_INVALID_PATTERN;
+
+        ExFreePoolWithTag(Pattern, POOLTAG);
+        ExFreePoolWithTag(Window, POOLTAG);
+
+        return STATUS_INVALID_PARAMETER;
+    }
 
+    //
+    // The results are saved right after the request structure
+    //
+    ResultsContext.Results        = (UINT64 *)((UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY);
+    ResultsContext.MaximumResults = MaximumSearchResults;
+
+    IsFinished = SearchMemoryPerformSearch(SearchMemRequest, Pattern, &ResultsContext, Window);
+
+    SearchMemRequest->CountOfResults   = ResultsContext.CountOfResults;
+    SearchMemRequest->IsSearchFinished = IsFinished;
+
+    if (!IsFinished)
+    {
         //
-        // All of the address chunk was valid
+        // Continue right after the last result
         //
-        if (DoesBaseAddrSaved && StartAddress > BaseAddress)
-        {
-            PerformSearchAddress(AddressToSaveResults, SearchMemRequest, BaseAddress, StartAddress);
-        }
-        else
+        SearchMemRequest->NextAddressToSearch = SearchEngineGetNextAddressToSearch(&ResultsContext);
+    }
+
+    SearchMemRequest->KernelStatus = DEBUGEER_OPERATION_WAS_SUCCESSFULL;
+
+    ExFreePoolWithTag(Pattern, POOLTAG);
+    ExFreePoolWithTag(Window, POOLTAG);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Callback of the multi-pattern matcher to save the search results
+ *
+ * @param PatternId Index of the pattern
+ * @param Address Address of the first byte of the match
+ * @param Context The search results context
+ * @return VOID
+ */
+VOID
+MultiPatternSearchSaveResultCallback(UINT32 PatternId, UINT64 Address, PVOID Context)
+{
+    PMULTI_PATTERN_SEARCH_RESULTS_CONTEXT ResultsContext = (PMULTI_PATTERN_SEARCH_RESULTS_CONTEXT)Context;
+
+    ResultsContext->Results[ResultsContext->CountOfResults].Address   = Address;
+    ResultsContext->Results[ResultsContext->CountOfResults].PatternId = PatternId;
+    ResultsContext->CountOfResults++;
+}
+
+/**
+ * @brief Validate the patterns of the request and build the automaton
+ *
+ * @param SearchRequest Request to search multiple patterns
+ * @param Automaton The automaton to build
+ * @return BOOLEAN
+ */
+BOOLEAN
+MultiPatternSearchBuildAutomaton(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest, PAHO_CORASICK_AUTOMATON Automaton)
+{
+    UINT32 * PatternsLength;
+    UINT32   TotalLength = 0;
+
+    if (SearchRequest->CountOfPatterns == 0 ||
+        SearchRequest->CountOfPatterns > MaximumMultiPatternSearchPatternsCount ||
+        SearchRequest->PatternsTotalLength > MaximumMultiPatternSearchPatternsTotalLength)
+    {
+        return FALSE;
+    }
+
+    PatternsLength = (UINT32 *)((UINT64)SearchRequest + SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY);
+
+    //
+    // The lengths should match the size of the patterns buffer
+    //
+    for (UINT32 i = 0; i < SearchRequest->CountOfPatterns; i++)
+    {
+        if (PatternsLength[i] > MaximumMultiPatternSearchPatternsTotalLength)
         {
-            return;
+            return FALSE;
         }
+
+        TotalLength += PatternsLength[i];
     }
-    else if (SearchMemRequest->MemoryType == SEARCH_PHYSICAL_MEMORY)
+
+    if (TotalLength != SearchRequest->PatternsTotalLength)
     {
-        //
-        // when we reached here, we know that it's a valid physical memory,
-        // so we change the structure and pass it as a virtual address to
-        // the search function
-        //
-        RealPhysicalAddress = SearchMemRequest->Address;
+        return FALSE;
+    }
 
-        //
-        // Change the start address
-        //
-        if (SearchMemRequest->ProcessId == PsGetCurrentProcessId())
+    return AhoCorasickBuild(Automaton,
+                            PatternsLength,
+                            (UCHAR *)((UINT64)PatternsLength + (SearchRequest->CountOfPatterns * sizeof(UINT32))),
+                            SearchRequest->CountOfPatterns);
+}
+
+/**
+ * @brief Search multiple patterns in a range of virtual or physical memory
+ *
+ * @details In vmx non-root the virtual pages are translated based on the
+ * target process and the physical pages are checked to be a part of the RAM,
+ * in vmx-root the memory is read from the current process memory layout
+ *
+ * @param SearchRequest Request to search multiple patterns
+ * @param Automaton The built automaton
+ * @param ResultsContext Context to save the results
+ * @param PageBuffer Buffer of PAGE_SIZE bytes
+ * @param IsVmxRoot Whether it's called from vmx-root mode or not
+ * @return BOOLEAN Returns TRUE if the whole range is searched and FALSE if
+ * the search is stopped because the results buffer is full
+ */
+BOOLEAN
+MultiPatternSearchPerformSearch(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest,
+                                PAHO_CORASICK_AUTOMATON               Automaton,
+                                PMULTI_PATTERN_SEARCH_RESULTS_CONTEXT ResultsContext,
+                                UCHAR *                               PageBuffer,
+                                BOOLEAN                               IsVmxRoot)
+{
+    UINT64                 CurrentAddress       = SearchRequest->Address;
+    UINT64                 EndAddress           = SearchRequest->Address + SearchRequest->Length;
+    UINT64                 ChunkSize            = 0;
+    UINT32                 ScannedSize          = 0;
+    UINT32                 IndexInBatch         = SEARCH_MEMORY_PAGES_PER_BATCH;
+    UINT64                 PhysicalAddress      = 0;
+    BOOLEAN                IsValidPage          = FALSE;
+    UINT16                 State                = AHO_CORASICK_ROOT_STATE;
+    BOOLEAN                Result               = TRUE;
+    KIRQL                  OldIrql;
+    CR3_TYPE               TargetCr3            = {0};
+    PPHYSICAL_MEMORY_RANGE PhysicalMemoryRanges = NULL;
+    UINT64                 PhysicalAddresses[SEARCH_MEMORY_PAGES_PER_BATCH];
+
+    //
+    // Continue from the previous state of the matcher (if any)
+    //
+    if (SearchRequest->ResumeState < Automaton->CountOfStates)
+    {
+        State = (UINT16)SearchRequest->ResumeState;
+    }
+
+    if (!IsVmxRoot)
+    {
+        if (SearchRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
         {
-            SearchMemRequest->Address = PhysicalAddressToVirtualAddress(StartAddress);
-            EndAddress                = PhysicalAddressToVirtualAddress(EndAddress);
+            TargetCr3 = GetCr3FromProcessId(SearchRequest->ProcessId);
+
+            if (TargetCr3.Flags == NULL)
+            {
+                return TRUE;
+            }
         }
         else
         {
-            SearchMemRequest->Address = PhysicalAddressToVirtualAddressByProcessId(StartAddress, SearchMemRequest->ProcessId);
-            EndAddress                = PhysicalAddressToVirtualAddressByProcessId(EndAddress, SearchMemRequest->ProcessId);
-        }
-
-        //
-        // Change the type of memory
-        //
-        SearchMemRequest->MemoryType = SEARCH_VIRTUAL_MEMORY;
+            PhysicalMemoryRanges = MmGetPhysicalMemoryRanges();
 
-        //
-        // Call the wrapper
-        //
-        PerformSearchAddress(AddressToSaveResults, SearchMemRequest, SearchMemRequest->Address, EndAddress);
-
-        //
-        // Restore the previous state
-        //
-        SearchMemRequest->MemoryType = SEARCH_PHYSICAL_MEMORY;
-        SearchMemRequest->Address    = RealPhysicalAddress;
+            if (PhysicalMemoryRanges == NULL)
+            {
+                return TRUE;
+            }
+        }
+    }
 
+    while (CurrentAddress < EndAddress && CurrentAddress >= SearchRequest->Address)
+    {
         //
-        // Save the process id to avoid calling PsGetCurrentProcessId()
-        // multiple times
+        // Read until the end of the current page or the end of the range
         //
-        ProcId = PsGetCurrentProcessId();
+        ChunkSize = min((UINT64)PAGE_ALIGN(CurrentAddress) + PAGE_SIZE, EndAddress) - CurrentAddress;
 
-        //
-        // Results should be ready (if any) in AddressToSaveResults
-        // we should convert it to a physical format as the search
-        // was on virtual format
-        //
-        for (size_t i = 0; i < MaximumSearchResults; i++)
+        if (IsVmxRoot)
         {
-            CurrentValue = AddressToSaveResults[i];
+            if (SearchRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
+            {
+                IsValidPage = CheckMemoryAccessSafety(CurrentAddress, (UINT32)ChunkSize);
 
-            if (SearchMemRequest->ProcessId == ProcId && CurrentValue != NULL)
+                if (IsValidPage)
+                {
+                    MemoryMapperReadMemorySafeOnTargetProcess(CurrentAddress, PageBuffer, ChunkSize);
+                }
+            }
+            else
             {
-                AddressToSaveResults[i] = VirtualAddressToPhysicalAddress(CurrentValue);
+                //
+                // Only the RAM is read, reading MMIO might have side effects
+                //
+                IsValidPage = SearchMemoryIsPhysicalAddressValid(g_PhysicalMemoryRanges, CurrentAddress);
+
+                if (IsValidPage)
+                {
+                    MemoryMapperReadMemorySafeByPhysicalAddress(CurrentAddress, PageBuffer, ChunkSize);
+                }
             }
-            else if (CurrentValue != NULL)
+        }
+        else
+        {
+            if (SearchRequest->MemoryType == SEARCH_VIRTUAL_MEMORY)
             {
-                AddressToSaveResults[i] = VirtualAddressToPhysicalAddressByProcessId(CurrentValue, SearchMemRequest->ProcessId);
+                if (IndexInBatch == SEARCH_MEMORY_PAGES_PER_BATCH)
+                {
+                    SearchMemoryTranslateVirtualPages(TargetCr3, CurrentAddress, PhysicalAddresses, SEARCH_MEMORY_PAGES_PER_BATCH);
+                    IndexInBatch = 0;
+                }
+
+                PhysicalAddress = PhysicalAddresses[IndexInBatch];
+                IndexInBatch++;
             }
             else
             {
-                break;
+                PhysicalAddress = SearchMemoryIsPhysicalAddressValid(PhysicalMemoryRanges, CurrentAddress) ? CurrentAddress : NULL;
             }
+
+            IsValidPage = PhysicalAddress != NULL;
+
+            if (IsValidPage)
+            {
+                OldIrql = KeRaiseIrqlToDpcLevel();
+                MemoryMapperReadMemorySafeByPhysicalAddress(PhysicalAddress, PageBuffer, ChunkSize);
+                KeLowerIrql(OldIrql);
+            }
+        }
+
+        if (!IsValidPage)
+        {
+            //
+            // The page is not valid, the memory is not contiguous anymore
+            //
+            State = AHO_CORASICK_ROOT_STATE;
+            CurrentAddress += ChunkSize;
+            continue;
+        }
+
+        ScannedSize = AhoCorasickScanBuffer(Automaton,
+                                            PageBuffer,
+                                            (UINT32)ChunkSize,
+                                            CurrentAddress,
+                                            &State,
+                                            MaximumMultiPatternSearchResults - ResultsContext->CountOfResults,
+                                            MultiPatternSearchSaveResultCallback,
+                                            ResultsContext);
+
+        if (ScannedSize != ChunkSize)
+        {
+            //
+            // Results buffer is full, the next request continues from
+            // the first byte that is not scanned with the same state
+            //
+            SearchRequest->NextAddressToSearch = CurrentAddress + ScannedSize;
+            SearchRequest->ResumeState         = State;
+            Result                             = FALSE;
+            break;
         }
 
-        return;
+        CurrentAddress += ChunkSize;
+    }
+
+    if (PhysicalMemoryRanges != NULL)
+    {
+        ExFreePool(PhysicalMemoryRanges);
+    }
+
+    return Result;
+}
+
+/**
+ * @brief Search multiple patterns in memory
+ *
+ * @details The patterns are replaced by the results after the automaton
+ * is built
+ *
+ * @param SearchRequest Request to search multiple patterns
+ * @param Automaton Buffer to build the automaton
+ * @param PageBuffer Buffer of PAGE_SIZE bytes
+ * @param IsVmxRoot Whether it's called from vmx-root mode or not
+ * @return BOOLEAN
+ */
+BOOLEAN
+MultiPatternSearchMemory(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest,
+                         PAHO_CORASICK_AUTOMATON               Automaton,
+                         UCHAR *                               PageBuffer,
+                         BOOLEAN                               IsVmxRoot)
+{
+    MULTI_PATTERN_SEARCH_RESULTS_CONTEXT ResultsContext = {0};
+
+    SearchRequest->CountOfResults   = 0;
+    SearchRequest->IsSearchFinished = TRUE;
+
+    if (SearchRequest->MemoryType != SEARCH_VIRTUAL_MEMORY && SearchRequest->MemoryType != SEARCH_PHYSICAL_MEMORY)
+    {
+        SearchRequest->KernelStatus = DEBUGGER_ERROR_MEMORY_TYPE_INVALID;
+        return FALSE;
+    }
+
+    if (!MultiPatternSearchBuildAutomaton(SearchRequest, Automaton))
+    {
+        SearchRequest->KernelStatus = DEBUGGER_ERROR_MULTI_PATTERN_SEARCH_INVALID_PATTERNS;
+        return FALSE;
     }
+
+    //
+    // The results are saved right after the request structure
+    //
+    ResultsContext.Results = (PDEBUGGER_MULTI_PATTERN_SEARCH_RESULT)((UINT64)SearchRequest + SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY);
+
+    SearchRequest->IsSearchFinished = MultiPatternSearchPerformSearch(SearchRequest, Automaton, &ResultsContext, PageBuffer, IsVmxRoot);
+    SearchRequest->CountOfResults   = ResultsContext.CountOfResults;
+    SearchRequest->KernelStatus     = DEBUGEER_OPERATION_WAS_SUCCESSFULL;
+
+    return TRUE;
 }
 
 /**
- * @brief Start searching memory
- * 
- * @param SearchMemRequest Request to search memory
- * @return NTSTATUS 
+ * @brief Search multiple patterns in memory (vmx non-root)
+ *
+ * @param SearchRequest Request to search multiple patterns
+ * @return NTSTATUS
  */
 NTSTATUS
-DebuggerCommandSearchMemory(PDEBUGGER_SEARCH_MEMORY SearchMemRequest)
+DebuggerCommandMultiPatternSearchMemory(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest)
 {
-    PUINT64 SearchResultsStorage = NULL;
-    PUINT64 UsermodeBuffer       = NULL;
-    UINT64  AddressFrom          = 0;
-    UINT64  AddressTo            = 0;
-    UINT64  CurrentValue         = 0;
-    UINT32  ResultsIndex         = 0;
+    PAHO_CORASICK_AUTOMATON Automaton;
+    UCHAR *                 PageBuffer;
+    BOOLEAN                 Result;
 
     //
     // Check if process id is valid or not
     //
-    if (SearchMemRequest->ProcessId != PsGetCurrentProcessId() && !IsProcessExist(SearchMemRequest->ProcessId))
+    if (SearchRequest->MemoryType == SEARCH_VIRTUAL_MEMORY &&
+        SearchRequest->ProcessId != PsGetCurrentProcessId() &&
+        !IsProcessExist(SearchRequest->ProcessId))
     {
+        SearchRequest->KernelStatus = DEBUGEER_ERROR_INVALID_PROCESS_ID;
         return STATUS_INVALID_PARAMETER;
     }
 
+    Automaton  = ExAllocatePoolWithTag(NonPagedPool, sizeof(AHO_CORASICK_AUTOMATON), POOLTAG);
+    PageBuffer = ExAllocatePoolWithTag(NonPagedPool, PAGE_SIZE, POOLTAG);
+
+    if (Automaton == NULL || PageBuffer == NULL)
+    {
+        SearchRequest->KernelStatus = DEBUGGER_ERROR_SEARCH_MEMORY_INSUFFICIENT_RESOURCES;
+
+        if (Automaton != NULL)
+        {
+            ExFreePoolWithTag(Automaton, POOLTAG);
+        }
+        if (PageBuffer != NULL)
+        {
+            ExFreePoolWithTag(PageBuffer, POOLTAG);
+        }
+
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    Result = MultiPatternSearchMemory(SearchRequest, Automaton, PageBuffer, FALSE);
+
+    ExFreePoolWithTag(Automaton, POOLTAG);
+    ExFreePoolWithTag(PageBuffer, POOLTAG);
+
+    return Result ? STATUS_SUCCESS : STATUS_INVALID_PARAMETER;
+}
+
+/**
+ * @brief Search multiple patterns in memory (vmx-root)
+ *
+ * @details The search is performed on the current process memory layout
+ * and uses the buffers that are allocated at the initialization of the
+ * debugger, so the process id of the request is ignored, the physical
+ * addresses are checked against the physical memory ranges that are
+ * captured at the initialization of the debugger
+ *
+ * @param SearchRequest Request to search multiple patterns
+ * @param RequestLength Length of the received request
+ * @return BOOLEAN
+ */
+BOOLEAN
+DebuggerCommandMultiPatternSearchMemoryVmxRoot(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest, UINT32 RequestLength)
+{
+    SearchRequest->CountOfResults   = 0;
+    SearchRequest->IsSearchFinished = TRUE;
+
     //
-    // User-mode buffer is same as SearchMemRequest
+    // Check whether we recieved the lengths and the bytes of
+    // all patterns or not (like the IOCTL)
     //
-    UsermodeBuffer = SearchMemRequest;
+    if (RequestLength < SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY ||
+        SearchRequest->CountOfPatterns > MaximumMultiPatternSearchPatternsCount ||
+        SearchRequest->PatternsTotalLength > MaximumMultiPatternSearchPatternsTotalLength ||
+        RequestLength != SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY +
+                             (SearchRequest->CountOfPatterns * sizeof(UINT32)) +
+                             SearchRequest->PatternsTotalLength)
+    {
+        SearchRequest->KernelStatus = DEBUGGER_ERROR_MULTI_PATTERN_SEARCH_INVALID_PATTERNS;
+        return FALSE;
+    }
+
+    if (g_MultiPatternSearchBuffer == NULL || g_PhysicalMemoryRanges == NULL)
+    {
+        SearchRequest->KernelStatus = DEBUGGER_ERROR_SEARCH_MEMORY_INSUFFICIENT_RESOURCES;
+        return FALSE;
+    }
+
+    return MultiPatternSearchMemory(SearchRequest,
+                                    (PAHO_CORASICK_AUTOMATON)g_MultiPatternSearchBuffer,
+                                    (UCHAR *)((UINT64)g_MultiPatternSearchBuffer + sizeof(AHO_CORASICK_AUTOMATON)),
+                                    TRUE);
+}
+
+/**
+ * @brief Read a range of memory for the scatter-gather read
+ *
+ * @param ReadRequest Request to read multiple ranges of memory
+ * @param Address Address of the range
+ * @param Buffer Buffer to save the bytes
+ * @param Size Size of the range
+ * @param IsVmxRoot Whether it's called from vmx-root mode or not
+ * @return BOOLEAN
+ */
+BOOLEAN
+ScatterGatherReadRange(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest,
+                       UINT64                               Address,
+                       UCHAR *                              Buffer,
+                       UINT32                               Size,
+                       BOOLEAN                              IsVmxRoot)
+{
+    SIZE_T   ReturnSize = 0;
+    CR3_TYPE ProcessCr3;
+
+    if (Address == NULL)
+    {
+        return FALSE;
+    }
+
+    if (!IsVmxRoot)
+    {
+        if (MemoryManagerReadProcessMemoryNormal((HANDLE)ReadRequest->ProcessId,
+                                                 Address,
+                                                 ReadRequest->MemoryType,
+                                                 Buffer,
+                                                 Size,
+                                                 &ReturnSize) != STATUS_SUCCESS)
+        {
+            return FALSE;
+        }
+
+        return ReturnSize == Size;
+    }
+
+    if (ReadRequest->MemoryType == DEBUGGER_READ_PHYSICAL_ADDRESS)
+    {
+        return MemoryMapperReadMemorySafeByPhysicalAddress(Address, Buffer, Size);
+    }
 
     //
-    // We store the user-mode data in a seprate variable because
-    // we will use them later when we Zeroed the SearchMemRequest
+    // Check whether the virtual memory is available in the current
+    // memory layout and also is present in the RAM
     //
-    AddressFrom = SearchMemRequest->Address;
-    AddressTo   = SearchMemRequest->Address + SearchMemRequest->Length;
+    if (!CheckMemoryAccessSafety(Address, Size) ||
+        !MemoryMapperReadMemorySafeOnTargetProcess(Address, Buffer, Size))
+    {
+        return FALSE;
+    }
 
     //
-    // We support up to MaximumSearchResults search results
+    // Show the original bytes instead of the 'bp' breakpoints (the
+    // memory is read from the current process)
     //
-    SearchResultsStorage = ExAllocatePoolWithTag(NonPagedPool, MaximumSearchResults * sizeof(UINT64), POOLTAG);
+    ProcessCr3.Flags = ((NT_KPROCESS *)PsGetCurrentProcess())->DirectoryTableBase;
+    BreakpointRestoreOriginalBytesOfBuffer(ProcessCr3, Address, Buffer, Size);
+
+    return TRUE;
+}
+
+/**
+ * @brief Check the descriptors of the scatter-gather read
+ *
+ * @param ReadRequest Request to read multiple ranges of memory
+ * @param Descriptors The descriptors after the request
+ * @return BOOLEAN
+ */
+BOOLEAN
+ScatterGatherReadCheckDescriptors(PDEBUGGER_SCATTER_GATHER_READ_MEMORY     ReadRequest,
+                                  PDEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR Descriptors)
+{
+    UINT32 TotalSize = 0;
 
-    if (SearchResultsStorage == NULL)
+    if (ReadRequest->CountOfDescriptors == 0 ||
+        ReadRequest->CountOfDescriptors > MaximumScatterGatherReadDescriptors)
+    {
+        return FALSE;
+    }
+
+    if (ReadRequest->Mode == DEBUGGER_SCATTER_GATHER_READ_FOLLOW_POINTER)
     {
         //
-        // Not enough memory
+        // The pointer to the next node should be in the read bytes
         //
-        return STATUS_INSUFFICIENT_RESOURCES;
+        return ReadRequest->FollowPointerSize >= sizeof(UINT64) &&
+               ReadRequest->FollowPointerSize <= MaximumScatterGatherReadTotalSize &&
+               ReadRequest->FollowPointerOffset <= ReadRequest->FollowPointerSize - sizeof(UINT64);
     }
 
-    //
-    // Make sure there is nothing else in the buffer
-    //
-    RtlZeroMemory(SearchResultsStorage, MaximumSearchResults * sizeof(UINT64));
+    if (ReadRequest->Mode != DEBUGGER_SCATTER_GATHER_READ_DESCRIPTORS)
+    {
+        return FALSE;
+    }
 
-    //
-    // Call the wrapper
-    //
-    SearchAddressWrapper(SearchResultsStorage, SearchMemRequest, AddressFrom, AddressTo);
+    for (UINT32 i = 0; i < ReadRequest->CountOfDescriptors; i++)
+    {
+        if (Descriptors[i].Size == 0 || Descriptors[i].Size > MaximumScatterGatherReadTotalSize)
+        {
+            return FALSE;
+        }
 
-    //
-    // In this point, we to store the results (if any) to the user-mode
-    // buffer SearchMemRequest itself is the user-mode buffer and we also
-    // checked from the previous function that the output buffer is at
-    // least SearchMemRequest bigger or equal to MaximumSearchResults * sizeof(UINT64)
-    // so we need to clear everything here, and also we should keep in mind that
-    // SearchMemRequest is no longer valid
-    //
-    RtlZeroMemory(SearchMemRequest, MaximumSearchResults * sizeof(UINT64));
+        TotalSize += Descriptors[i].Size;
+
+        if (TotalSize > MaximumScatterGatherReadTotalSize)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Read multiple ranges of memory at once
+ *
+ * @details The bytes of the ranges are saved right after the descriptors,
+ * the ranges that are not readable are filled with zeros
+ *
+ * @param ReadRequest Request to read multiple ranges of memory
+ * @param IsVmxRoot Whether it's called from vmx-root mode or not
+ * @return BOOLEAN
+ */
+BOOLEAN
+ScatterGatherReadMemory(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest, BOOLEAN IsVmxRoot)
+{
+    PDEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR Descriptors;
+    UCHAR *                                  Buffer;
+    UINT64                                   Address;
+
+    Descriptors = (PDEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR)((UINT64)ReadRequest + SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY);
+
+    ReadRequest->CountOfReadDescriptors = 0;
+    ReadRequest->TotalSize              = 0;
+
+    if (ReadRequest->MemoryType != DEBUGGER_READ_VIRTUAL_ADDRESS && ReadRequest->MemoryType != DEBUGGER_READ_PHYSICAL_ADDRESS)
+    {
+        ReadRequest->KernelStatus = DEBUGGER_ERROR_MEMORY_TYPE_INVALID;
+        return FALSE;
+    }
+
+    if (!ScatterGatherReadCheckDescriptors(ReadRequest, Descriptors))
+    {
+        ReadRequest->KernelStatus = DEBUGGER_ERROR_SCATTER_GATHER_READ_INVALID_DESCRIPTORS;
+        return FALSE;
+    }
 
     //
-    // It's time to move the results from our temporary buffer to the user-mode
-    // buffer, also there is something that we should check and that's the fact
-    // that we used aligned page addresses so the results should be checked to
-    // see whether the results are between the user's entered addresses or not
+    // The bytes are saved right after the descriptors
     //
-    for (size_t i = 0; i < MaximumSearchResults; i++)
-    {
-        CurrentValue = SearchResultsStorage[i];
+    Buffer  = (UCHAR *)&Descriptors[ReadRequest->CountOfDescriptors];
+    Address = ReadRequest->FollowPointerAddress;
 
-        if (CurrentValue == NULL)
+    for (UINT32 i = 0; i < ReadRequest->CountOfDescriptors; i++)
+    {
+        if (ReadRequest->Mode == DEBUGGER_SCATTER_GATHER_READ_FOLLOW_POINTER)
         {
             //
-            // Nothing left to move
+            // Stop if there is no space for another node
             //
-            break;
+            if (ReadRequest->TotalSize + ReadRequest->FollowPointerSize > MaximumScatterGatherReadTotalSize)
+            {
+                break;
+            }
+
+            Descriptors[i].Address = Address;
+            Descriptors[i].Size    = ReadRequest->FollowPointerSize;
+        }
+
+        if (ScatterGatherReadRange(ReadRequest, Descriptors[i].Address, Buffer, Descriptors[i].Size, IsVmxRoot))
+        {
+            Descriptors[i].KernelStatus = DEBUGEER_OPERATION_WAS_SUCCESSFULL;
         }
+        else
+        {
+            Descriptors[i].KernelStatus = DEBUGEER_ERROR_INVALID_ADDRESS;
+            RtlZeroMemory(Buffer, Descriptors[i].Size);
+        }
+
+        ReadRequest->CountOfReadDescriptors++;
+        ReadRequest->TotalSize += Descriptors[i].Size;
 
-        if (CurrentValue >= AddressFrom && CurrentValue <= AddressTo)
+        if (ReadRequest->Mode == DEBUGGER_SCATTER_GATHER_READ_FOLLOW_POINTER)
         {
             //
-            // Move the variable
+            // The list is finished if the node is not readable, or the next
+            // pointer is null or points to the first node again
             //
-            UsermodeBuffer[ResultsIndex] = CurrentValue;
-            ResultsIndex++;
+            if (Descriptors[i].KernelStatus != DEBUGEER_OPERATION_WAS_SUCCESSFULL)
+            {
+                break;
+            }
+
+            Address = *(UINT64 *)(Buffer + ReadRequest->FollowPointerOffset);
+
+            if (Address == NULL || Address == ReadRequest->FollowPointerAddress)
+            {
+                break;
+            }
         }
+
+        Buffer += Descriptors[i].Size;
     }
 
+    ReadRequest->KernelStatus = DEBUGEER_OPERATION_WAS_SUCCESSFULL;
+
+    return TRUE;
+}
+
+/**
+ * @brief Read multiple ranges of memory at once (vmx non-root)
+ *
+ * @param ReadRequest Request to read multiple ranges of memory
+ * @return NTSTATUS
+ */
+NTSTATUS
+DebuggerCommandScatterGatherReadMemory(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest)
+{
     //
-    // Free the results pool
+    // Check if process id is valid or not
     //
-    ExFreePoolWithTag(SearchResultsStorage, POOLTAG);
+    if (ReadRequest->MemoryType == DEBUGGER_READ_VIRTUAL_ADDRESS &&
+        ReadRequest->ProcessId != PsGetCurrentProcessId() &&
+        !IsProcessExist(ReadRequest->ProcessId))
+    {
+        ReadRequest->KernelStatus = DEBUGEER_ERROR_INVALID_PROCESS_ID;
+        return STATUS_INVALID_PARAMETER;
+    }
 
-    return STATUS_SUCCESS;
+    return ScatterGatherReadMemory(ReadRequest, FALSE) ? STATUS_SUCCESS : STATUS_INVALID_PARAMETER;
+}
+
+/**
+ * @brief Read multiple ranges of memory at once (vmx-root)
+ *
+ * @details The ranges are read from the current process memory layout
+ * so the process id of the request is ignored
+ *
+ * @param ReadRequest Request to read multiple ranges of memory
+ * @return BOOLEAN
+ */
+BOOLEAN
+DebuggerCommandScatterGatherReadMemoryVmxRoot(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest)
+{
+    return ScatterGatherReadMemory(ReadRequest, TRUE);
 }
 
 /**
@@ -13,6 +13,43 @@
  */
 #pragma once
 
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of pages that are translated at once while
+ * searching the virtual memory
+ *
+ */
+#define SEARCH_MEMORY_PAGES_PER_BATCH 64
+
+/**
+ * @brief Size of the buffer that holds a run of pages which are read
+ * at once and the carried bytes of the previous run
+ *
+ */
+#define SEARCH_MEMORY_WINDOW_SIZE ((MEMORY_MAPPER_WINDOW_PAGES * PAGE_SIZE) + MaximumSearchPatternLength)
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Context of saving the multi-pattern search results
+ *
+ */
+typedef struct _MULTI_PATTERN_SEARCH_RESULTS_CONTEXT
+{
+    PDEBUGGER_MULTI_PATTERN_SEARCH_RESULT Results;
+    UINT32                                CountOfResults;
+
+} MULTI_PATTERN_SEARCH_RESULTS_CONTEXT, *PMULTI_PATTERN_SEARCH_RESULTS_CONTEXT;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
 NTSTATUS
 DebuggerCommandReadMemory(PDEBUGGER_READ_MEMORY ReadMemRequest, PVOID UserBuffer, PSIZE_T ReturnSize);
 
@@ -31,6 +68,18 @@ DebuggerCommandEditMemory(PDEBUGGER_EDIT_MEMORY EditMemRequest);
 NTSTATUS
 DebuggerCommandSearchMemory(PDEBUGGER_SEARCH_MEMORY SearchMemRequest);
 
+NTSTATUS
+DebuggerCommandMultiPatternSearchMemory(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest);
+
+BOOLEAN
+DebuggerCommandMultiPatternSearchMemoryVmxRoot(PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY SearchRequest, UINT32 RequestLength);
+
+NTSTATUS
+DebuggerCommandScatterGatherReadMemory(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest);
+
+BOOLEAN
+DebuggerCommandScatterGatherReadMemoryVmxRoot(PDEBUGGER_SCATTER_GATHER_READ_MEMORY ReadRequest);
+
 NTSTATUS
 DebuggerCommandFlush(PDEBUGGER_FLUSH_LOGGING_BUFFERS DebuggerFlushBuffersRequest);
 
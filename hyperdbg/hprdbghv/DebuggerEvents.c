@@ -19,7 +19,7 @@
 VOID
 DebuggerEventEnableEferOnAllProcessors()
 {
-    KeGenericCallDpc(BroadcastDpcEnableEferSyscallEvents, 0x0);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_ENABLE_SYSCALL_HOOK_EFER, 0);
 }
 
 /**
@@ -30,7 +30,7 @@ DebuggerEventEnableEferOnAllProcessors()
 VOID
 DebuggerEventDisableEferOnAllProcessors()
 {
-    KeGenericCallDpc(BroadcastDpcDisableEferSyscallEvents, 0x0);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_DISABLE_SYSCALL_HOOK_EFER, 0);
 }
 
 /**
@@ -41,7 +41,7 @@ DebuggerEventDisableEferOnAllProcessors()
 VOID
 DebuggerEventEnableMovToCr3ExitingOnAllProcessors()
 {
-    KeGenericCallDpc(BroadcastDpcEnableMovToCr3Exiting, 0x0);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_ENABLE_MOV_TO_CR3_EXITING, 0);
 }
 
 /**
@@ -52,7 +52,7 @@ DebuggerEventEnableMovToCr3ExitingOnAllProcessors()
 VOID
 DebuggerEventDisableMovToCr3ExitingOnAllProcessors()
 {
-    KeGenericCallDpc(BroadcastDpcDisableMovToCr3Exiting, 0x0);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_DISABLE_MOV_TO_CR3_EXITING, 0);
 }
 
 /**
@@ -170,218 +170,3 @@ DpcRoutinePerformReadMsr(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument
     SpinlockUnlock(&OneCoreLock);
 }
 
-/**
- * @brief change msr bitmap read on a single core
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformChangeMsrBitmapReadOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // change msr bitmap (read)
-    //
-    AsmVmxVmcall(VMCALL_CHANGE_MSR_BITMAP_READ, DeferredContext, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief change msr bitmap write on a single core
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformChangeMsrBitmapWriteOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // change msr bitmap (write)
-    //
-    AsmVmxVmcall(VMCALL_CHANGE_MSR_BITMAP_WRITE, DeferredContext, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief set rdtsc/rdtscp exiting
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformEnableRdtscExitingOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // enable rdtsc/rdtscp exiting
-    //
-    AsmVmxVmcall(VMCALL_SET_RDTSC_EXITING, 0, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief set rdpmc exiting
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformEnableRdpmcExitingOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // enable rdtsc/rdtscp exiting
-    //
-    AsmVmxVmcall(VMCALL_SET_RDPMC_EXITING, 0, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief change exception bitmap on a single core
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformSetExceptionBitmapOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // change exception bitmap
-    //
-    AsmVmxVmcall(VMCALL_SET_EXCEPTION_BITMAP, DeferredContext, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief Set the Mov to Debug Registers Exitings
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformEnableMovToDebugRegistersExiting(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // enable Mov to Debug Registers Exitings
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_MOV_TO_DEBUG_REGS_EXITING, 0, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief Enable external interrupt exiting on a single core
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformSetExternalInterruptExitingOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enable external interrupt exiting
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_EXTERNAL_INTERRUPT_EXITING, NULL, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief Enable syscall hook EFER on a single core
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformEnableEferSyscallHookOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // Enable syscall hook EFER
-    //
-    AsmVmxVmcall(VMCALL_ENABLE_SYSCALL_HOOK_EFER, NULL, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
-
-/**
- * @brief change I/O bitmap on a single core
- * 
- * @param Dpc 
- * @param DeferredContext 
- * @param SystemArgument1 
- * @param SystemArgument2 
- * @return VOID 
- */
-VOID
-DpcRoutinePerformChangeIoBitmapOnSingleCore(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
-{
-    //
-    // change I/O bitmap
-    //
-    AsmVmxVmcall(VMCALL_CHANGE_IO_BITMAP, DeferredContext, 0, 0);
-
-    //
-    // As this function is designed for a single,
-    // we have to release the synchronization lock here
-    //
-    SpinlockUnlock(&OneCoreLock);
-}
@@ -0,0 +1,189 @@
+/**
+ * @file Emulator.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Emulator of the simple memory accesses
+ * @details The accesses to the monitored pages (!monitor) are emulated in
+ * vmx-root instead of restoring the original entry and single-stepping the
+ * instruction with MTF, the instructions are decoded by EmulatorDecoder.c
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Get the value of a general purpose register
+ *
+ * @param Regs The registers
+ * @param Register Index of the register
+ * @return UINT64
+ */
+UINT64
+EmulatorGetRegister(PGUEST_REGS Regs, UINT8 Register)
+{
+    return ((UINT64 *)Regs)[Register];
+}
+
+/**
+ * @brief Compute the address of the memory operand of a decoded instruction
+ *
+ * @param Instruction The decoded instruction
+ * @param Regs The registers
+ * @param Rip Address of the instruction
+ * @return UINT64 The (linear) address of the memory operand
+ */
+UINT64
+EmulatorGetMemoryAddress(PEMULATOR_INSTRUCTION Instruction, PGUEST_REGS Regs, UINT64 Rip)
+{
+    UINT64 Address = (UINT64)Instruction->Displacement;
+
+    if (Instruction->BaseRegister == EMULATOR_REGISTER_RIP)
+    {
+        //
+        // rip-relative addresses are based on the next instruction
+        //
+        Address += Rip + Instruction->Length;
+    }
+    else if (Instruction->BaseRegister != EMULATOR_REGISTER_NONE)
+    {
+        Address += EmulatorGetRegister(Regs, Instruction->BaseRegister);
+    }
+
+    if (Instruction->IndexRegister != EMULATOR_REGISTER_NONE)
+    {
+        Address += EmulatorGetRegister(Regs, Instruction->IndexRegister) * Instruction->Scale;
+    }
+
+    return Address;
+}
+
+/**
+ * @brief Get the value that a decoded instruction writes to the memory
+ *
+ * @param Instruction The decoded instruction
+ * @param Regs The registers
+ * @return UINT64 The value (only the first AccessSize bytes are valid)
+ */
+UINT64
+EmulatorGetWriteValue(PEMULATOR_INSTRUCTION Instruction, PGUEST_REGS Regs)
+{
+    if (Instruction->HasImmediate)
+    {
+        return Instruction->Immediate;
+    }
+
+    if (Instruction->IsHighByteRegister)
+    {
+        return EmulatorGetRegister(Regs, Instruction->Register) >> 8;
+    }
+
+    return EmulatorGetRegister(Regs, Instruction->Register);
+}
+
+/**
+ * @brief Set the value that a decoded instruction reads from the memory
+ * to its register
+ *
+ * @param Instruction The decoded instruction
+ * @param Regs The registers
+ * @param Value The value that is read from the memory
+ * @return VOID
+ */
+VOID
+EmulatorSetReadValue(PEMULATOR_INSTRUCTION Instruction, PGUEST_REGS Regs, UINT64 Value)
+{
+    UINT64 * Register = &((UINT64 *)Regs)[Instruction->Register];
+    UINT32   Shift    = 64 - Instruction->AccessSize * 8;
+
+    //
+    // Extend the value of the access to 64 bits
+    //
+    if (Instruction->IsSignExtended)
+    {
+        Value = (UINT64)((INT64)(Value << Shift) >> Shift);
+    }
+    else
+    {
+        Value = (Value << Shift) >> Shift;
+    }
+
+    //
+    // The 32-bit registers are zero extended, the 8-bit and the 16-bit
+    // registers keep the rest of the register
+    //
+    switch (Instruction->RegisterSize)
+    {
+    case 1:
+        if (Instruction->IsHighByteRegister)
+        {
+            *Register = (*Register & ~0xff00ull) | ((Value & 0xff) << 8);
+        }
+        else
+        {
+            *Register = (*Register & ~0xffull) | (Value & 0xff);
+        }
+        break;
+
+    case 2:
+        *Register = (*Register & ~0xffffull) | (Value & 0xffff);
+        break;
+
+    case 4:
+        *Register = Value & 0xffffffff;
+        break;
+
+    default:
+        *Register = Value;
+        break;
+    }
+}
+
+/**
+ * @brief Get the data breakpoints (DR0 to DR3) that are hit by a memory
+ * access, the processor doesn't check them for the emulated accesses
+ *
+ * @param Dr7 The debug control register
+ * @param BreakpointAddresses The addresses of the breakpoints (DR0 to DR3)
+ * @param Address The (linear) address of the access
+ * @param Size Size of the access
+ * @param IsWrite The access is a write (otherwise it's a read)
+ * @return UINT32 The breakpoints that are hit (as the B0 to B3 bits of DR6)
+ */
+UINT32
+EmulatorGetDataBreakpoints(UINT64 Dr7, const UINT64 * BreakpointAddresses, UINT64 Address, UINT32 Size, BOOLEAN IsWrite)
+{
+    UINT32 Breakpoints = 0;
+
+    for (UINT32 i = 0; i < EMULATOR_DEBUG_REGISTERS; i++)
+    {
+        UINT32 ReadWrite = (Dr7 >> (16 + i * 4)) & 0x3;
+        UINT32 Length    = (Dr7 >> (18 + i * 4)) & 0x3;
+        UINT64 Start;
+
+        //
+        // The breakpoint should be enabled (locally or globally) and break on
+        // the data writes (01b) or on the data reads and writes (11b)
+        //
+        if (!((Dr7 >> (i * 2)) & 0x3) || (ReadWrite != 3 && (ReadWrite != 1 || !IsWrite)))
+        {
+            continue;
+        }
+
+        //
+        // The lengths are 1, 2, 8 and 4 bytes and the low bits of the address
+        // are ignored (the breakpoints are aligned to their lengths)
+        //
+        Length = Length == 2 ? 8 : Length == 3 ? 4 : Length + 1;
+        Start  = BreakpointAddresses[i] & ~((UINT64)Length - 1);
+
+        if (Start < Address + Size && Address < Start + Length)
+        {
+            Breakpoints |= 1 << i;
+        }
+    }
+
+    return Breakpoints;
+}
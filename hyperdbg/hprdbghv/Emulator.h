@@ -0,0 +1,43 @@
+/**
+ * @file Emulator.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the emulator of the simple memory accesses
+ * @details The emulation of the registers doesn't depend on any kernel
+ * routine, the memory access itself is performed by the caller
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the breakpoints of the debug registers (DR0 to DR3)
+ *
+ */
+#define EMULATOR_DEBUG_REGISTERS 4
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT64
+EmulatorGetRegister(PGUEST_REGS Regs, UINT8 Register);
+
+UINT64
+EmulatorGetMemoryAddress(PEMULATOR_INSTRUCTION Instruction, PGUEST_REGS Regs, UINT64 Rip);
+
+UINT64
+EmulatorGetWriteValue(PEMULATOR_INSTRUCTION Instruction, PGUEST_REGS Regs);
+
+VOID
+EmulatorSetReadValue(PEMULATOR_INSTRUCTION Instruction, PGUEST_REGS Regs, UINT64 Value);
+
+UINT32
+EmulatorGetDataBreakpoints(UINT64 Dr7, const UINT64 * BreakpointAddresses, UINT64 Address, UINT32 Size, BOOLEAN IsWrite);
@@ -0,0 +1,322 @@
+/**
+ * @file EmulatorDecoder.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Decoder of the instructions of the emulator
+ * @details Only the common forms of mov, movzx, movsx and movsxd in 64-bit
+ * mode are decoded, other instructions are executed with MTF. The decoder
+ * doesn't use any kernel routine or the state of the guest
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Read a little-endian signed value (displacement or immediate)
+ * from the bytes of an instruction and sign extend it
+ *
+ * @param Buffer The bytes of the value
+ * @param Size Size of the value (zero, 1, 2 or 4)
+ * @return UINT64
+ */
+UINT64
+EmulatorReadSignedValue(const UINT8 * Buffer, UINT32 Size)
+{
+    UINT64 Value = 0;
+    UINT32 Shift = 64 - Size * 8;
+
+    if (Size == 0)
+    {
+        return 0;
+    }
+
+    for (UINT32 i = 0; i < Size; i++)
+    {
+        Value |= (UINT64)Buffer[i] << (i * 8);
+    }
+
+    return (UINT64)((INT64)(Value << Shift) >> Shift);
+}
+
+/**
+ * @brief Decode an instruction that moves data between a register (or an
+ * immediate) and the memory
+ *
+ * @param Buffer The bytes of the instruction
+ * @param BufferSize Size of the buffer
+ * @param Instruction The decoded instruction
+ * @return BOOLEAN Returns TRUE if the instruction is supported by the emulator
+ */
+BOOLEAN
+EmulatorDecodeInstruction(const UINT8 * Buffer, UINT32 BufferSize, PEMULATOR_INSTRUCTION Instruction)
+{
+    UINT32  Position          = 0;
+    UINT32  Opcode            = 0;
+    UINT8   Rex               = 0;
+    UINT8   ModRm             = 0;
+    UINT8   Sib               = 0;
+    UINT8   Mod               = 0;
+    UINT8   Rm                = 0;
+    UINT8   OperandSize       = 4;
+    UINT8   ImmediateSize     = 0;
+    UINT8   DisplacementSize  = 0;
+    BOOLEAN OperandSizePrefix = FALSE;
+
+    RtlZeroMemory(Instruction, sizeof(EMULATOR_INSTRUCTION));
+
+    if (BufferSize > EMULATOR_MAXIMUM_INSTRUCTION_LENGTH)
+    {
+        BufferSize = EMULATOR_MAXIMUM_INSTRUCTION_LENGTH;
+    }
+
+    //
+    // Legacy prefixes, the cs, ds, es and ss overrides are ignored in 64-bit
+    // mode, other prefixes (lock, rep, fs, gs and the address size) are not
+    // supported
+    //
+    while (Position < BufferSize)
+    {
+        if (Buffer[Position] == 0x66)
+        {
+            OperandSizePrefix = TRUE;
+        }
+        else if (Buffer[Position] != 0x2e && Buffer[Position] != 0x3e &&
+                 Buffer[Position] != 0x26 && Buffer[Position] != 0x36)
+        {
+            break;
+        }
+
+        Position++;
+    }
+
+    //
+    // The rex prefix should be right before the opcode
+    //
+    if (Position < BufferSize && (Buffer[Position] & 0xf0) == 0x40)
+    {
+        Rex = Buffer[Position++];
+    }
+
+    if (Position >= BufferSize)
+    {
+        return FALSE;
+    }
+
+    Opcode = Buffer[Position++];
+
+    if (Opcode == 0x0f)
+    {
+        if (Position >= BufferSize)
+        {
+            return FALSE;
+        }
+
+        Opcode = 0x0f00 | Buffer[Position++];
+    }
+
+    if (Rex & 0x8)
+    {
+        OperandSize = 8;
+    }
+    else if (OperandSizePrefix)
+    {
+        OperandSize = 2;
+    }
+
+    switch (Opcode)
+    {
+    case 0x88:
+        //
+        // mov r/m8, r8
+        //
+        Instruction->IsWrite      = TRUE;
+        Instruction->AccessSize   = 1;
+        Instruction->RegisterSize = 1;
+        break;
+
+    case 0x89:
+        //
+        // mov r/m, r
+        //
+        Instruction->IsWrite      = TRUE;
+        Instruction->AccessSize   = OperandSize;
+        Instruction->RegisterSize = OperandSize;
+        break;
+
+    case 0x8a:
+        //
+        // mov r8, r/m8
+        //
+        Instruction->AccessSize   = 1;
+        Instruction->RegisterSize = 1;
+        break;
+
+    case 0x8b:
+        //
+        // mov r, r/m
+        //
+        Instruction->AccessSize   = OperandSize;
+        Instruction->RegisterSize = OperandSize;
+        break;
+
+    case 0xc6:
+        //
+        // mov r/m8, imm8
+        //
+        Instruction->IsWrite      = TRUE;
+        Instruction->HasImmediate = TRUE;
+        Instruction->AccessSize   = 1;
+        ImmediateSize             = 1;
+        break;
+
+    case 0xc7:
+        //
+        // mov r/m, imm (the 32-bit immediate is sign extended in 64-bit accesses)
+        //
+        Instruction->IsWrite      = TRUE;
+        Instruction->HasImmediate = TRUE;
+        Instruction->AccessSize   = OperandSize;
+        ImmediateSize             = OperandSize == 2 ? 2 : 4;
+        break;
+
+    case 0x0fb6:
+    case 0x0fbe:
+        //
+        // movzx r, r/m8 and movsx r, r/m8
+        //
+        Instruction->AccessSize     = 1;
+        Instruction->RegisterSize   = OperandSize;
+        Instruction->IsSignExtended = Opcode == 0x0fbe;
+        break;
+
+    case 0x0fb7:
+    case 0x0fbf:
+        //
+        // movzx r, r/m16 and movsx r, r/m16
+        //
+        Instruction->AccessSize     = 2;
+        Instruction->RegisterSize   = OperandSize;
+        Instruction->IsSignExtended = Opcode == 0x0fbf;
+        break;
+
+    case 0x63:
+        //
+        // movsxd r64, r/m32 (without rex.w it's not a sign extension)
+        //
+        if (OperandSize != 8)
+        {
+            return FALSE;
+        }
+
+        Instruction->AccessSize     = 4;
+        Instruction->RegisterSize   = 8;
+        Instruction->IsSignExtended = TRUE;
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    //
+    // Decode the ModR/M byte, the emulator only supports memory operands
+    //
+    if (Position >= BufferSize)
+    {
+        return FALSE;
+    }
+
+    ModRm = Buffer[Position++];
+    Mod   = ModRm >> 6;
+    Rm    = ModRm & 0x7;
+
+    if (Mod == 3)
+    {
+        return FALSE;
+    }
+
+    Instruction->Register = ((ModRm >> 3) & 0x7) | ((Rex & 0x4) ? 0x8 : 0);
+
+    if (Instruction->HasImmediate && Instruction->Register != 0)
+    {
+        return FALSE;
+    }
+
+    //
+    // Without the rex prefix, the byte registers 4 to 7 are ah, ch, dh and bh
+    //
+    if (Instruction->RegisterSize == 1 && Rex == 0 && Instruction->Register >= 4)
+    {
+        Instruction->Register -= 4;
+        Instruction->IsHighByteRegister = TRUE;
+    }
+
+    Instruction->IndexRegister = EMULATOR_REGISTER_NONE;
+    Instruction->Scale         = 1;
+
+    if (Mod == 1)
+    {
+        DisplacementSize = 1;
+    }
+    else if (Mod == 2)
+    {
+        DisplacementSize = 4;
+    }
+
+    if (Rm == 4)
+    {
+        //
+        // The memory operand has a SIB byte
+        //
+        if (Position >= BufferSize)
+        {
+            return FALSE;
+        }
+
+        Sib = Buffer[Position++];
+
+        Instruction->Scale         = 1 << (Sib >> 6);
+        Instruction->IndexRegister = ((Sib >> 3) & 0x7) | ((Rex & 0x2) ? 0x8 : 0);
+        Instruction->BaseRegister  = (Sib & 0x7) | ((Rex & 0x1) ? 0x8 : 0);
+
+        if (Instruction->IndexRegister == EMULATOR_REGISTER_RSP)
+        {
+            Instruction->IndexRegister = EMULATOR_REGISTER_NONE;
+        }
+
+        if ((Sib & 0x7) == 5 && Mod == 0)
+        {
+            Instruction->BaseRegister = EMULATOR_REGISTER_NONE;
+            DisplacementSize          = 4;
+        }
+    }
+    else if (Rm == 5 && Mod == 0)
+    {
+        //
+        // rip-relative memory operand
+        //
+        Instruction->BaseRegister = EMULATOR_REGISTER_RIP;
+        DisplacementSize          = 4;
+    }
+    else
+    {
+        Instruction->BaseRegister = Rm | ((Rex & 0x1) ? 0x8 : 0);
+    }
+
+    if (Position + DisplacementSize + ImmediateSize > BufferSize)
+    {
+        return FALSE;
+    }
+
+    Instruction->Displacement = (INT64)EmulatorReadSignedValue(&Buffer[Position], DisplacementSize);
+    Position += DisplacementSize;
+
+    Instruction->Immediate = EmulatorReadSignedValue(&Buffer[Position], ImmediateSize);
+    Position += ImmediateSize;
+
+    Instruction->Length = (UINT8)Position;
+
+    return TRUE;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file EmulatorDecoder.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the decoder of the instructions of the emulator
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum length of an instruction
+ *
+ */
+#define EMULATOR_MAXIMUM_INSTRUCTION_LENGTH 15
+
+/**
+ * @brief Indexes of the registers that are not general purpose registers
+ * (the general purpose registers are indexed by their order in GUEST_REGS)
+ *
+ */
+#define EMULATOR_REGISTER_RSP  4
+#define EMULATOR_REGISTER_RIP  0x10
+#define EMULATOR_REGISTER_NONE 0xff
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A decoded instruction that moves data between a register (or an
+ * immediate) and the memory (mov, movzx, movsx and movsxd)
+ *
+ */
+typedef struct _EMULATOR_INSTRUCTION
+{
+    UINT8   Length;             // Length of the instruction
+    UINT8   AccessSize;         // Size of the memory access (1, 2, 4 or 8)
+    UINT8   RegisterSize;       // Size of the register operand (larger than the access in movzx and movsx)
+    BOOLEAN IsWrite;            // The instruction writes to the memory (otherwise it reads the memory)
+    BOOLEAN IsSignExtended;     // The value that is read is sign extended to the register (movsx and movsxd)
+    BOOLEAN HasImmediate;       // The value that is written is an immediate
+    BOOLEAN IsHighByteRegister; // The register operand is ah, ch, dh or bh
+    UINT8   Register;           // The register operand
+    UINT8   BaseRegister;       // Base register of the memory operand (or rip or none)
+    UINT8   IndexRegister;      // Index register of the memory operand (or none)
+    UINT8   Scale;              // Scale of the index register
+    INT64   Displacement;       // Displacement of the memory operand
+    UINT64  Immediate;          // The immediate (sign extended to the access size)
+
+} EMULATOR_INSTRUCTION, *PEMULATOR_INSTRUCTION;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT64
+EmulatorReadSignedValue(const UINT8 * Buffer, UINT32 Size);
+
+BOOLEAN
+EmulatorDecodeInstruction(const UINT8 * Buffer, UINT32 BufferSize, PEMULATOR_INSTRUCTION Instruction);
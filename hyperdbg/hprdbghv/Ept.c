@@ -51,11 +51,72 @@ EptCheckFeatures()
         return FALSE;
     }
 
+    //
+    // 1GB pages are used in the identity map if the processor supports them
+    //
+    g_EptState->Is1GbPagesSupported = VpidRegister.Pdpte1GbPages;
+
+    if (!g_EptState->Is1GbPagesSupported)
+    {
+        LogDebugInfo("The processor doesn't support 1GB pages in EPT, 2MB pages are used instead");
+    }
+
+    g_EptState->IdentityMapSize = EptGetIdentityMapSize(g_EptState->Is1GbPagesSupported);
+
+    LogDebugInfo("Size of the identity map: 0x%llx", g_EptState->IdentityMapSize);
+
     LogDebugInfo(" *** All EPT features are present *** ");
 
     return TRUE;
 }
 
+/**
+ * @brief Compute the size of the physical memory that should be identity mapped
+ *
+ * @param Is1GbPagesSupported Whether 1GB pages are used in the identity map or not
+ * @return UINT64 Size of the identity map
+ */
+UINT64
+EptGetIdentityMapSize(BOOLEAN Is1GbPagesSupported)
+{
+    INT32                  Registers[4];
+    UINT32                 PhysicalAddressWidth = 0;
+    UINT64                 PhysicalMemoryEnd    = 0;
+    PPHYSICAL_MEMORY_RANGE PhysicalMemoryRanges;
+
+    //
+    // Bits 7:0 of EAX in CPUID.80000008H is the physical address width
+    //
+    __cpuidex(Registers, CPUID_EXTENDED_FUNCTION_MAXIMUM_AND_IDENTIFIER, 0);
+
+    if ((UINT32)Registers[0] >= CPUID_EXTENDED_FUNCTION_ADDRESS_SIZES)
+    {
+        __cpuidex(Registers, CPUID_EXTENDED_FUNCTION_ADDRESS_SIZES, 0);
+        PhysicalAddressWidth = Registers[0] & 0xff;
+    }
+
+    //
+    // Find the end of the RAM, it's only needed if 1GB pages are not supported
+    //
+    if (!Is1GbPagesSupported)
+    {
+        PhysicalMemoryRanges = MmGetPhysicalMemoryRanges();
+
+        if (PhysicalMemoryRanges != NULL)
+        {
+            for (UINT32 i = 0; PhysicalMemoryRanges[i].NumberOfBytes.QuadPart != 0; i++)
+            {
+                PhysicalMemoryEnd = max(PhysicalMemoryEnd,
+                                        PhysicalMemoryRanges[i].BaseAddress.QuadPart + PhysicalMemoryRanges[i].NumberOfBytes.QuadPart);
+            }
+
+            ExFreePool(PhysicalMemoryRanges);
+        }
+    }
+
+    return EptBuilderGetIdentityMapSize(PhysicalAddressWidth, Is1GbPagesSupported, PhysicalMemoryEnd);
+}
+
 /**
  * @brief Build MTRR Map of current physical addresses
  * 
@@ -130,6 +191,36 @@ EptBuildMtrrMap()
     return TRUE;
 }
 
+/**
+ * @brief Get the PML3 entry for this physical address
+ * 
+ * @param EptPageTable The EPT Page Table
+ * @param PhysicalAddress Physical Address that we want to get its PML3
+ * @return PEPT_PML3_POINTER Return NULL if the address is not identity mapped
+ */
+PEPT_PML3_POINTER
+EptGetPml3Entry(PVMM_EPT_PAGE_TABLE EptPageTable, SIZE_T PhysicalAddress)
+{
+    PEPT_PML3_POINTER PML3;
+
+    //
+    // Addresses above the identity map are invalid because they are > physical address bus width
+    //
+    if (PhysicalAddress >= EptPageTable->IdentityMapSize)
+    {
+        return NULL;
+    }
+
+    PML3 = EptPageTable->PML3[ADDRMASK_EPT_PML4_INDEX(PhysicalAddress)];
+
+    if (!PML3)
+    {
+        return NULL;
+    }
+
+    return &PML3[ADDRMASK_EPT_PML3_INDEX(PhysicalAddress)];
+}
+
 /**
  * @brief Get the PML1 entry for this physical address if the page is split
  * 
@@ -140,29 +231,16 @@ EptBuildMtrrMap()
 PEPT_PML1_ENTRY
 EptGetPml1Entry(PVMM_EPT_PAGE_TABLE EptPageTable, SIZE_T PhysicalAddress)
 {
-    SIZE_T            Directory, DirectoryPointer, PML4Entry;
     PEPT_PML2_ENTRY   PML2;
     PEPT_PML1_ENTRY   PML1;
     PEPT_PML2_POINTER PML2Pointer;
 
-    Directory        = ADDRMASK_EPT_PML2_INDEX(PhysicalAddress);
-    DirectoryPointer = ADDRMASK_EPT_PML3_INDEX(PhysicalAddress);
-    PML4Entry        = ADDRMASK_EPT_PML4_INDEX(PhysicalAddress);
-
-    //
-    // Addresses above 512GB are invalid because it is > physical address bus width
-    //
-    if (PML4Entry > 0)
-    {
-        return NULL;
-    }
-
-    PML2 = &EptPageTable->PML2[DirectoryPointer][Directory];
+    PML2 = EptGetPml2Entry(EptPageTable, PhysicalAddress);
 
     //
     // Check to ensure the page is split
     //
-    if (PML2->LargePage)
+    if (!PML2 || PML2->LargePage)
     {
         return NULL;
     }
@@ -196,35 +274,40 @@ EptGetPml1Entry(PVMM_EPT_PAGE_TABLE EptPageTable, SIZE_T PhysicalAddress)
  * 
  * @param EptPageTable The EPT Page Table
  * @param PhysicalAddress Physical Address that we want to get its PML2
- * @return PEPT_PML2_ENTRY The PML2 Entry Structure
+ * @return PEPT_PML2_ENTRY The PML2 Entry Structure or NULL if the address is
+ * invalid or it's in a 1GB page
  */
 PEPT_PML2_ENTRY
 EptGetPml2Entry(PVMM_EPT_PAGE_TABLE EptPageTable, SIZE_T PhysicalAddress)
 {
-    SIZE_T          Directory, DirectoryPointer, PML4Entry;
-    PEPT_PML2_ENTRY PML2;
+    PEPT_PML3_POINTER PML3;
+    PEPT_PML2_ENTRY   PML2;
 
-    Directory        = ADDRMASK_EPT_PML2_INDEX(PhysicalAddress);
-    DirectoryPointer = ADDRMASK_EPT_PML3_INDEX(PhysicalAddress);
-    PML4Entry        = ADDRMASK_EPT_PML4_INDEX(PhysicalAddress);
+    PML3 = EptGetPml3Entry(EptPageTable, PhysicalAddress);
 
     //
-    // Addresses above 512GB are invalid because it is > physical address bus width
+    // 1GB pages don't have PML2 entries
     //
-    if (PML4Entry > 0)
+    if (!PML3 || ((PEPT_PML3_ENTRY)PML3)->LargePage)
     {
         return NULL;
     }
 
-    PML2 = &EptPageTable->PML2[DirectoryPointer][Directory];
-    return PML2;
+    PML2 = (PEPT_PML2_ENTRY)PhysicalAddressToVirtualAddress((PVOID)(PML3->PageFrameNumber * PAGE_SIZE));
+
+    if (!PML2)
+    {
+        return NULL;
+    }
+
+    return &PML2[ADDRMASK_EPT_PML2_INDEX(PhysicalAddress)];
 }
 
 /**
  * @brief Split 2MB (LargePage) into 4kb pages
  * 
  * @param EptPageTable The EPT Page Table
- * @param PreAllocatedBuffer The address of pre-allocated buffer
+ * @param PreAllocatedBuffer The address of pre-allocated buffer (taken from EptSplitPoolAcquire)
  * @param PhysicalAddress Physical address of where we want to split
  * @param CoreIndex The index of core
  * @return BOOLEAN Returns true if it was successfull or false if there was an error
@@ -235,9 +318,40 @@ EptSplitLargePage(PVMM_EPT_PAGE_TABLE EptPageTable, PVOID PreAllocatedBuffer, SI
     PVMM_EPT_DYNAMIC_SPLIT NewSplit;
     EPT_PML1_ENTRY         EntryTemplate;
     SIZE_T                 EntryIndex;
+    PEPT_PML3_POINTER      TargetPml3;
+    PVMM_EPT_PML2_TABLE    NewPml2Table;
     PEPT_PML2_ENTRY        TargetEntry;
     EPT_PML2_POINTER       NewPointer;
 
+    //
+    // Find the PML3 entry that's currently used
+    //
+    TargetPml3 = EptGetPml3Entry(EptPageTable, PhysicalAddress);
+    if (!TargetPml3)
+    {
+        LogError("An invalid physical address passed");
+        return FALSE;
+    }
+
+    //
+    // If it's a 1GB page, then it should be split to 2MB pages first,
+    // the table of the 2MB entries is also pre-allocated
+    //
+    if (((PEPT_PML3_ENTRY)TargetPml3)->LargePage)
+    {
+        NewPml2Table = (PVMM_EPT_PML2_TABLE)PoolManagerRequestPool(SPLIT_1GB_PAGING_TO_2MB_PAGE, TRUE, sizeof(VMM_EPT_PML2_TABLE));
+        if (!NewPml2Table)
+        {
+            LogError("There is no pre-allocated buffer available for splitting the 1GB page");
+            return FALSE;
+        }
+        RtlZeroMemory(NewPml2Table, sizeof(VMM_EPT_PML2_TABLE));
+
+        EptBuilderSplitPml3Entry((PEPT_PML3_ENTRY)TargetPml3,
+                                 NewPml2Table,
+                                 VirtualAddressToPhysicalAddress(&NewPml2Table->PML2[0]));
+    }
+
     //
     // Find the PML2 entry that's currently used
     //
@@ -255,10 +369,10 @@ EptSplitLargePage(PVMM_EPT_PAGE_TABLE EptPageTable, PVOID PreAllocatedBuffer, SI
     if (!TargetEntry->LargePage)
     {
         //
-        // As it's a large page and we request a pool for it, we need to
-        // free the pool because it's not used anymore
+        // As it's a large page and we request a table for it, we need to
+        // return the table to the pool because it's not used anymore
         //
-        PoolManagerFreePool(PreAllocatedBuffer);
+        EptSplitPoolRelease(PreAllocatedBuffer);
 
         return TRUE;
     }
@@ -272,7 +386,10 @@ EptSplitLargePage(PVMM_EPT_PAGE_TABLE EptPageTable, PVOID PreAllocatedBuffer, SI
         LogError("Failed to allocate dynamic split memory");
         return FALSE;
     }
-    RtlZeroMemory(NewSplit, sizeof(VMM_EPT_DYNAMIC_SPLIT));
+    //
+    // The list entry of the table is used by the split pool, so it's not zeroed
+    //
+    RtlZeroMemory(&NewSplit->PML1[0], sizeof(NewSplit->PML1));
 
     //
     // Point back to the entry in the dynamic split for easy reference for which entry that
@@ -322,114 +439,78 @@ EptSplitLargePage(PVMM_EPT_PAGE_TABLE EptPageTable, PVOID PreAllocatedBuffer, SI
 }
 
 /**
- * @brief Set up PML2 Entries
+ * @brief Allocate a table of the identity map (used by the EPT builder)
  * 
- * @param NewEntry The PML2 Entry
- * @param PageFrameNumber PFN (Physical Address)
- * @return VOID 
+ * @param Size Size of the table
+ * @param PhysicalAddress Physical address of the table
+ * @return PVOID Virtual address of the table or NULL if it's not allocated
  */
-VOID
-EptSetupPML2Entry(PEPT_PML2_ENTRY NewEntry, SIZE_T PageFrameNumber)
+PVOID
+EptAllocateTable(SIZE_T Size, UINT64 * PhysicalAddress)
 {
-    SIZE_T AddressOfPage;
-    SIZE_T CurrentMtrrRange;
-    SIZE_T TargetMemoryType;
+    PVOID Table;
 
     //
-    // Each of the 512 collections of 512 PML2 entries is setup here
-    // This will, in total, identity map every physical address from 0x0
-    // to physical address 0x8000000000 (512GB of memory)
-    // ((EntryGroupIndex * VMM_EPT_PML2E_COUNT) + EntryIndex) * 2MB is
-    // the actual physical address we're mapping
+    // Allocations of at least a page are page aligned, so the table itself
+    // is in a single physical page
     //
-    NewEntry->PageFrameNumber = PageFrameNumber;
+    Table = ExAllocatePoolWithTag(NonPagedPool, Size, POOLTAG);
 
-    //
-    // Size of 2MB page * PageFrameNumber == AddressOfPage (physical memory)
-    //
-    AddressOfPage = PageFrameNumber * SIZE_2_MB;
-
-    //
-    // To be safe, we will map the first page as UC as to not bring up any
-    // kind of undefined behavior from the fixed MTRR section which we are
-    // not formally recognizing (typically there is MMIO memory in the first MB)
-    //
-    // I suggest reading up on the fixed MTRR section of the manual to see why the
-    // first entry is likely going to need to be UC.
-    //
-    if (PageFrameNumber == 0)
+    if (Table == NULL)
     {
-        NewEntry->MemoryType = MEMORY_TYPE_UNCACHEABLE;
-        return;
+        return NULL;
     }
 
-    //
-    // Default memory type is always WB for performance
-    //
-    TargetMemoryType = MEMORY_TYPE_WRITE_BACK;
+    RtlZeroMemory(Table, Size);
 
-    //
-    // For each MTRR range
-    //
-    for (CurrentMtrrRange = 0; CurrentMtrrRange < g_EptState->NumberOfEnabledMemoryRanges; CurrentMtrrRange++)
-    {
-        //
-        // If this page's address is below or equal to the max physical address of the range
-        //
-        if (AddressOfPage <= g_EptState->MemoryRanges[CurrentMtrrRange].PhysicalEndAddress)
-        {
-            //
-            // And this page's last address is above or equal to the base physical address of the range
-            //
-            if ((AddressOfPage + SIZE_2_MB - 1) >= g_EptState->MemoryRanges[CurrentMtrrRange].PhysicalBaseAddress)
-            {
-                //
-                // If we're here, this page fell within one of the ranges specified by the variable MTRRs
-                // Therefore, we must mark this page as the same cache type exposed by the MTRR
-                //
-                TargetMemoryType = g_EptState->MemoryRanges[CurrentMtrrRange].MemoryType;
+    *PhysicalAddress = VirtualAddressToPhysicalAddress(Table);
 
-                // LogInfo("0x%X> Range=%llX -> %llX | Begin=%llX End=%llX", PageFrameNumber, AddressOfPage, AddressOfPage + SIZE_2_MB - 1, EptState->MemoryRanges[CurrentMtrrRange].PhysicalBaseAddress, EptState->MemoryRanges[CurrentMtrrRange].PhysicalEndAddress);
+    return Table;
+}
 
-                //
-                // 11.11.4.1 MTRR Precedences
-                //
-                if (TargetMemoryType == MEMORY_TYPE_UNCACHEABLE)
-                {
-                    //
-                    // If this is going to be marked uncacheable, then we stop the search as UC always
-                    // takes precedent
-                    //
-                    break;
-                }
-            }
+/**
+ * @brief Free the identity page table and its PML3 and PML2 tables
+ * @details The PML2 and PML1 tables of the pages that are split later
+ * are freed by the pool manager
+ * 
+ * @param PageTable The page table
+ * @return VOID
+ */
+VOID
+EptFreeIdentityPageTable(PVMM_EPT_PAGE_TABLE PageTable)
+{
+    PVMM_EPT_PML2_TABLE PML2Table;
+
+    while (!IsListEmpty(&PageTable->PML2TablesList))
+    {
+        PML2Table = CONTAINING_RECORD(RemoveHeadList(&PageTable->PML2TablesList), VMM_EPT_PML2_TABLE, PML2TablesList);
+        ExFreePoolWithTag(PML2Table, POOLTAG);
+    }
+
+    for (SIZE_T PML4Index = 0; PML4Index < VMM_EPT_PML4E_COUNT; PML4Index++)
+    {
+        if (PageTable->PML3[PML4Index] != NULL)
+        {
+            ExFreePoolWithTag(PageTable->PML3[PML4Index], POOLTAG);
         }
     }
-    //
-    // Finally, commit the memory type to the entry
-    //
-    NewEntry->MemoryType = TargetMemoryType;
+
+    MmFreeContiguousMemory(PageTable);
 }
 
 /**
  * @brief Allocates page maps and create identity page table
+ * @details 1GB pages are used where the MTRRs allow, the rest of the
+ * regions are mapped by 2MB pages
  * 
  * @return PVMM_EPT_PAGE_TABLE identity map page-table
  */
 PVMM_EPT_PAGE_TABLE
 EptAllocateAndCreateIdentityPageTable()
 {
-    PVMM_EPT_PAGE_TABLE PageTable;
-    EPT_PML3_POINTER    RWXTemplate;
-    EPT_PML2_ENTRY      PML2EntryTemplate;
-    SIZE_T              EntryGroupIndex;
-    SIZE_T              EntryIndex;
-
-    //
-    // Allocate all paging structures as 4KB aligned pages
-    //
-    PHYSICAL_ADDRESS MaxSize;
-    PVOID            Output;
+    PVMM_EPT_PAGE_TABLE       PageTable;
+    EPT_BUILDER_CONFIGURATION Configuration = {0};
+    PHYSICAL_ADDRESS          MaxSize;
 
     //
     // Allocate address anywhere in the OS's memory space
@@ -449,87 +530,17 @@ EptAllocateAndCreateIdentityPageTable()
     //
     RtlZeroMemory(PageTable, sizeof(VMM_EPT_PAGE_TABLE));
 
-    //
-    // Mark the first 512GB PML4 entry as present, which allows us to manage up
-    // to 512GB of discrete paging structures.
-    //
-    PageTable->PML4[0].PageFrameNumber = (SIZE_T)VirtualAddressToPhysicalAddress(&PageTable->PML3[0]) / PAGE_SIZE;
-    PageTable->PML4[0].ReadAccess      = 1;
-    PageTable->PML4[0].WriteAccess     = 1;
-    PageTable->PML4[0].ExecuteAccess   = 1;
-
-    //
-    // Now mark each 1GB PML3 entry as RWX and map each to their PML2 entry
-    //
-
-    //
-    // Ensure stack memory is cleared
-    //
-    RWXTemplate.Flags = 0;
-
-    //
-    // Set up one 'template' RWX PML3 entry and copy it into each of the 512 PML3 entries
-    // Using the same method as SimpleVisor for copying each entry using intrinsics.
-    //
-    RWXTemplate.ReadAccess    = 1;
-    RWXTemplate.WriteAccess   = 1;
-    RWXTemplate.ExecuteAccess = 1;
-
-    //
-    // Copy the template into each of the 512 PML3 entry slots
-    //
-    __stosq((SIZE_T *)&PageTable->PML3[0], RWXTemplate.Flags, VMM_EPT_PML3E_COUNT);
-
-    //
-    // For each of the 512 PML3 entries
-    //
-    for (EntryIndex = 0; EntryIndex < VMM_EPT_PML3E_COUNT; EntryIndex++)
-    {
-        //
-        // Map the 1GB PML3 entry to 512 PML2 (2MB) entries to describe each large page.
-        // NOTE: We do *not* manage any PML1 (4096 byte) entries and do not allocate them.
-        //
-        PageTable->PML3[EntryIndex].PageFrameNumber = (SIZE_T)VirtualAddressToPhysicalAddress(&PageTable->PML2[EntryIndex][0]) / PAGE_SIZE;
-    }
-
-    PML2EntryTemplate.Flags = 0;
-
-    //
-    // All PML2 entries will be RWX and 'present'
-    //
-    PML2EntryTemplate.WriteAccess   = 1;
-    PML2EntryTemplate.ReadAccess    = 1;
-    PML2EntryTemplate.ExecuteAccess = 1;
-
-    //
-    // We are using 2MB large pages, so we must mark this 1 here
-    //
-    PML2EntryTemplate.LargePage = 1;
-
-    //
-    // For each collection of 512 PML2 entries (512 collections * 512 entries per collection),
-    // mark it RWX using the same template above.
-    // This marks the entries as "Present" regardless of if the actual system has memory at
-    // this region or not. We will cause a fault in our EPT handler if the guest access a page
-    // outside a usable range, despite the EPT frame being present here.
-    //
-    __stosq((SIZE_T *)&PageTable->PML2[0], PML2EntryTemplate.Flags, VMM_EPT_PML3E_COUNT * VMM_EPT_PML2E_COUNT);
+    Configuration.MemoryRanges         = g_EptState->MemoryRanges;
+    Configuration.NumberOfMemoryRanges = g_EptState->NumberOfEnabledMemoryRanges;
+    Configuration.IdentityMapSize      = g_EptState->IdentityMapSize;
+    Configuration.Use1GbPages          = g_EptState->Is1GbPagesSupported;
+    Configuration.AllocateTable        = EptAllocateTable;
 
-    //
-    // For each of the 512 collections of 512 2MB PML2 entries
-    //
-    for (EntryGroupIndex = 0; EntryGroupIndex < VMM_EPT_PML3E_COUNT; EntryGroupIndex++)
+    if (!EptBuilderBuildIdentityMap(&Configuration, PageTable))
     {
-        //
-        // For each 2MB PML2 entry in the collection
-        //
-        for (EntryIndex = 0; EntryIndex < VMM_EPT_PML2E_COUNT; EntryIndex++)
-        {
-            //
-            // Setup the memory type and frame number of the PML2 entry
-            //
-            EptSetupPML2Entry(&PageTable->PML2[EntryGroupIndex][EntryIndex], (EntryGroupIndex * VMM_EPT_PML2E_COUNT) + EntryIndex);
-        }
+        LogError("Failed to allocate memory for the tables of the identity map");
+        EptFreeIdentityPageTable(PageTable);
+        return NULL;
     }
 
     return PageTable;
@@ -668,15 +679,27 @@ EptInitializeSeconadaryEpt()
 BOOLEAN
 EptHandlePageHookExit(PGUEST_REGS Regs, VMX_EXIT_QUALIFICATION_EPT_VIOLATION ViolationQualification, UINT64 GuestPhysicalAddr)
 {
-    BOOLEAN     IsHandled = FALSE;
-    PLIST_ENTRY TempList  = 0;
+    BOOLEAN                 IsHandled = FALSE;
+    PEPT_HOOKED_PAGE_DETAIL HookedEntry;
 
-    TempList = &g_EptState->HookedPagesList;
-    while (&g_EptState->HookedPagesList != TempList->Flink)
+    //
+    // The hooked pages are keyed by their page frame numbers, so we don't
+    // walk all of the hooked pages on each violation
+    //
+    HookedEntry = EptHookFindHookedPage(PAGE_ALIGN(GuestPhysicalAddr));
+
+    if (HookedEntry != NULL)
     {
-        TempList                            = TempList->Flink;
-        PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
-        if (HookedEntry->PhysicalBaseAddress == PAGE_ALIGN(GuestPhysicalAddr))
+        if (HookedEntry->IsBeingRemoved)
+        {
+            //
+            // The page is unhooked, so we restore its original entry (it's
+            // not restored on this core yet) and there is nothing to restore
+            // on MTF, the page might be freed after all of the cores restore it
+            //
+            EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->OriginalEntry, INVEPT_SINGLE_CONTEXT);
+        }
+        else if (EptHookHandleHookedPage(Regs, HookedEntry, ViolationQualification, GuestPhysicalAddr))
         {
             //
             // We found an address that matches the details
@@ -686,30 +709,24 @@ EptHandlePageHookExit(PGUEST_REGS Regs, VMX_EXIT_QUALIFICATION_EPT_VIOLATION Vio
             // by setting the Monitor Trap Flag. Return false means that nothing special
             // for the caller to do
             //
-            if (EptHookHandleHookedPage(Regs, HookedEntry, ViolationQualification, GuestPhysicalAddr))
-            {
-                //
-                // Next we have to save the current hooked entry to restore on the next instruction's vm-exit
-                //
-                g_GuestState[KeGetCurrentProcessorNumber()].MtfEptHookRestorePoint = HookedEntry;
-
-                //
-                // We have to set Monitor trap flag and give it the HookedEntry to work with
-                //
-                HvSetMonitorTrapFlag(TRUE);
-            }
 
             //
-            // Indicate that we handled the ept violation
+            // Next we have to save the current hooked entry to restore on the next instruction's vm-exit
             //
-            IsHandled = TRUE;
+            g_GuestState[KeGetCurrentProcessorNumber()].MtfEptHookRestorePoint = HookedEntry;
 
             //
-            // Get out of the loop
+            // We have to set Monitor trap flag and give it the HookedEntry to work with
             //
-            break;
+            HvSetMonitorTrapFlag(TRUE);
         }
+
+        //
+        // Indicate that we handled the ept violation
+        //
+        IsHandled = TRUE;
     }
+
     //
     // Redo the instruction
     //
@@ -761,9 +778,17 @@ VOID
 EptHandleMonitorTrapFlag(PEPT_HOOKED_PAGE_DETAIL HookedEntry)
 {
     //
-    // restore the hooked state
+    // restore the hooked state, if the page is unhooked meanwhile then
+    // its original entry is restored instead
     //
-    EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->ChangedEntry, INVEPT_SINGLE_CONTEXT);
+    if (HookedEntry->IsBeingRemoved)
+    {
+        EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->OriginalEntry, INVEPT_SINGLE_CONTEXT);
+    }
+    else
+    {
+        EptSetPML1AndInvalidateTLB(HookedEntry->EntryAddress, HookedEntry->ChangedEntry, INVEPT_SINGLE_CONTEXT);
+    }
 }
 
 /**
@@ -15,7 +15,20 @@
 //				Debugger Config                 //
 //////////////////////////////////////////////////
 
-#define MaximumHiddenBreakpointsOnPage 40
+#define MaximumHiddenHooksOnPage 40
+
+/**
+ * @brief Count of the buckets of the hooked pages (keyed by their page
+ * frame numbers), should be a power of two
+ * 
+ */
+#define EPT_HOOKED_PAGES_BUCKETS 256
+
+/**
+ * @brief The bucket of the hooked pages of a physical address
+ * 
+ */
+#define EPT_HOOKED_PAGES_BUCKET(PhysicalAddress) (((PhysicalAddress) >> 12) & (EPT_HOOKED_PAGES_BUCKETS - 1))
 
 //////////////////////////////////////////////////
 //					Constants					//
@@ -88,6 +101,12 @@
  */
 #define MSR_IA32_MTRR_CAPABILITIES 0x000000FE
 
+/**
+ * @brief CPUID leaf of the physical and linear address sizes
+ * 
+ */
+#define CPUID_EXTENDED_FUNCTION_ADDRESS_SIZES 0x80000008
+
 /**
  * @brief The number of 512GB PML4 entries in the page table
  * 
@@ -120,6 +139,18 @@
  */
 #define SIZE_2_MB ((SIZE_T)(512 * PAGE_SIZE))
 
+/**
+ * @brief Integer 1GB
+ * 
+ */
+#define SIZE_1_GB ((SIZE_T)(512 * SIZE_2_MB))
+
+/**
+ * @brief Integer 512GB (size of the memory described by each PML4 entry)
+ * 
+ */
+#define SIZE_512_GB ((SIZE_T)(512 * SIZE_1_GB))
+
 /**
  * @brief Offset into the 1st paging structure (4096 byte)
  * 
@@ -744,11 +775,12 @@ typedef union _EPTE
 //				      typedefs         			 //
 //////////////////////////////////////////////////
 
-typedef EPT_PML4 EPT_PML4_POINTER, *PEPT_PML4_POINTER;
-typedef EPDPTE   EPT_PML3_POINTER, *PEPT_PML3_POINTER;
-typedef EPDE_2MB EPT_PML2_ENTRY, *PEPT_PML2_ENTRY;
-typedef EPDE     EPT_PML2_POINTER, *PEPT_PML2_POINTER;
-typedef EPTE     EPT_PML1_ENTRY, *PEPT_PML1_ENTRY;
+typedef EPT_PML4   EPT_PML4_POINTER, *PEPT_PML4_POINTER;
+typedef EPDPTE_1GB EPT_PML3_ENTRY, *PEPT_PML3_ENTRY;
+typedef EPDPTE     EPT_PML3_POINTER, *PEPT_PML3_POINTER;
+typedef EPDE_2MB   EPT_PML2_ENTRY, *PEPT_PML2_ENTRY;
+typedef EPDE       EPT_PML2_POINTER, *PEPT_PML2_POINTER;
+typedef EPTE       EPT_PML1_ENTRY, *PEPT_PML1_ENTRY;
 
 //////////////////////////////////////////////////
 //			     Structs Cont.                	//
@@ -767,21 +799,50 @@ typedef struct _VMM_EPT_PAGE_TABLE
     EPT_PML4_POINTER PML4[VMM_EPT_PML4E_COUNT];
 
     /**
-	 * @brief Describes exactly 512 contiguous 1GB memory regions within a our singular 512GB PML4 region.
+	 * @brief The virtual address of the PML3 table of each PML4 entry, the tables are
+	 * only allocated for the 512GB regions which are below the size of the identity map.
+	 * Each PML3 entry is either a 1GB page or a pointer to a VMM_EPT_PML2_TABLE.
 	 */
-    DECLSPEC_ALIGN(PAGE_SIZE)
-    EPT_PML3_POINTER PML3[VMM_EPT_PML3E_COUNT];
+    PEPT_PML3_POINTER PML3[VMM_EPT_PML4E_COUNT];
 
     /**
-	 * @brief For each 1GB PML3 entry, create 512 2MB entries to map identity.
-	 * NOTE: We are using 2MB pages as the smallest paging size in our map, so we do not manage individiual 4096 byte pages.
-	 * Therefore, we do not allocate any PML1 (4096 byte) paging structures.
+	 * @brief The PML2 tables (VMM_EPT_PML2_TABLE) that are allocated while building the
+	 * identity map, these are the 1GB regions that can't be mapped by a single 1GB page.
+	 * The PML2 tables of 1GB pages that are split later are not in this list.
 	 */
-    DECLSPEC_ALIGN(PAGE_SIZE)
-    EPT_PML2_ENTRY PML2[VMM_EPT_PML3E_COUNT][VMM_EPT_PML2E_COUNT];
+    LIST_ENTRY PML2TablesList;
+
+    /**
+	 * @brief Size of the physical memory that is identity mapped (starting from 0x0)
+	 */
+    UINT64 IdentityMapSize;
 
 } VMM_EPT_PAGE_TABLE, *PVMM_EPT_PAGE_TABLE;
 
+/**
+ * @brief The 512 2MB entries of a 1GB region
+ * 
+ */
+typedef struct _VMM_EPT_PML2_TABLE
+{
+    /**
+	 * @brief The 2MB entries that correspond to the 1GB region
+	 */
+    DECLSPEC_ALIGN(PAGE_SIZE)
+    EPT_PML2_ENTRY PML2[VMM_EPT_PML2E_COUNT];
+
+    /**
+	 * @brief The pointer to the PML3 entry in the page table which points to this table
+	 */
+    PEPT_PML3_POINTER Entry;
+
+    /**
+	 * @brief Linked list entries of the tables which are allocated while building the identity map
+	 */
+    LIST_ENTRY PML2TablesList;
+
+} VMM_EPT_PML2_TABLE, *PVMM_EPT_PML2_TABLE;
+
 /**
  * @brief EPT Pointer (EPTP or GUEST_EPTP)
  * 
@@ -990,10 +1051,13 @@ typedef struct _MTRR_RANGE_DESCRIPTOR
 typedef struct _EPT_STATE
 {
     LIST_ENTRY            HookedPagesList;             // A list of the details about hooked pages
+    LIST_ENTRY            HookedPagesBuckets[EPT_HOOKED_PAGES_BUCKETS]; // The hooked pages keyed by their page frame numbers
     MTRR_RANGE_DESCRIPTOR MemoryRanges[9];             // Physical memory ranges described by the BIOS in the MTRRs. Used to build the EPT identity mapping.
     ULONG                 NumberOfEnabledMemoryRanges; // Number of memory ranges specified in MemoryRanges
     EPTP                  EptPointer;                  // Extended-Page-Table Pointer
     PVMM_EPT_PAGE_TABLE   EptPageTable;                // Page table entries for EPT operation
+    UINT64                IdentityMapSize;             // Size of the physical memory that is identity mapped in the EPT tables
+    BOOLEAN               Is1GbPagesSupported;         // Whether the processor supports 1GB pages in EPT or not
 
     PVMM_EPT_PAGE_TABLE SecondaryEptPageTable; // Secondary Page table entries for EPT operation (Used in debugger mechanisms)
     BOOLEAN             SecondaryInitialized;  // Is Secondary Page table entries initialized or not (Used in debugger mechanisms)
@@ -1137,8 +1201,27 @@ typedef union _VMX_EXIT_QUALIFICATION_EPT_VIOLATION
     UINT64 Flags;
 } VMX_EXIT_QUALIFICATION_EPT_VIOLATION, *PVMX_EXIT_QUALIFICATION_EPT_VIOLATION;
 
+/**
+ * @brief A hidden breakpoint or a hidden detours on a hooked page
+ *
+ */
+typedef struct _EPT_HOOKED_OFFSET
+{
+    UINT64  VirtualAddress;     // The hooked address from the caller prespective view (cr3)
+    PCHAR   Trampoline;         // The trampoline of the detours (contains the original bytes)
+    PVOID   DetourHookDetails;  // The entry of the detours on g_EptHook2sDetourListHead
+    UINT16  Offset;             // Offset of the hook in the page (the table is sorted by it)
+    UINT16  Length;             // Count of the bytes that are changed on the fake page
+    BOOLEAN IsHiddenBreakpoint; // 0xcc (!epthook) or detours (!epthook2)
+    BOOLEAN IsBeingRemoved;     // The original bytes are restored but the cores might still see the hook
+    CHAR    PreviousByte;       // The byte that is replaced by 0xcc
+
+} EPT_HOOKED_OFFSET, *PEPT_HOOKED_OFFSET;
+
 /**
  * @brief Structure to save the state of each hooked pages
+ * @details There is a single structure for each physical page, all of the
+ * hidden breakpoints and hidden detours of the page share its fake page
  * 
  */
 typedef struct _EPT_HOOKED_PAGE_DETAIL
@@ -1152,15 +1235,14 @@ typedef struct _EPT_HOOKED_PAGE_DETAIL
     LIST_ENTRY PageHookList;
 
     /**
-	* @brief The virtual address from the caller prespective view (cr3)
-	*/
-    UINT64 VirtualAddress;
+	 * @brief Linked list entry of the bucket of the page (keyed by its page frame number).
+	 */
+    LIST_ENTRY PageHookBucketList;
 
     /**
-	* @brief The virtual address of it's enty on g_EptHook2sDetourListHead 
-	* this way we can de-allocate the list whenever the hook is finished
+	* @brief The virtual address from the caller prespective view (cr3)
 	*/
-    UINT64 AddressOfEptHook2sDetourListEntry;
+    UINT64 VirtualAddress;
 
     /**
 	 * @brief The base address of the page. Used to find this structure in the list of page hooks
@@ -1190,39 +1272,27 @@ typedef struct _EPT_HOOKED_PAGE_DETAIL
 	 */
     EPT_PML1_ENTRY ChangedEntry;
 
-    /**
-	* @brief The buffer of the trampoline function which is used in the inline hook.
-	*/
-    PCHAR Trampoline;
-
     /**
 	 * @brief This field shows whether the hook contains a hidden hook for execution or not
 	 */
     BOOLEAN IsExecutionHook;
 
     /**
-	 * @brief If TRUE shows that this is the information about 
-	 * a hidden breakpoint command (not a monitor or hidden detours)
+	 * @brief The hidden breakpoints and hidden detours of the page (sorted by
+	 * their offsets), it's empty if the page is hooked for read or write
 	 */
-    BOOLEAN IsHiddenBreakpoint;
+    EPT_HOOKED_OFFSET HookedOffsets[MaximumHiddenHooksOnPage];
 
     /**
-	 * @brief Address of hooked pages (multiple breakpoints on a single page)
-	 * this is only used in hidden breakpoints (not hidden detours)
+	 * @brief Count of the hidden breakpoints and hidden detours of the page
 	 */
-    UINT64 BreakpointAddresses[MaximumHiddenBreakpointsOnPage];
+    UINT32 CountOfHookedOffsets;
 
     /**
-	 * @brief Character that was previously used in BreakpointAddresses
-	 * this is only used in hidden breakpoints (not hidden detours)
+	 * @brief The page is unhooked but it's not restored on all of the cores yet,
+	 * the cores restore its original entry instead of its hook
 	 */
-    CHAR PreviousBytesOnBreakpointAddresses[MaximumHiddenBreakpointsOnPage];
-
-    /**
-	 * @brief Count of breakpoints (multiple breakpoints on a single page)
-	 * this is only used in hidden breakpoints (not hidden detours)
-	 */
-    UINT64 CountOfBreakpoints;
+    BOOLEAN IsBeingRemoved;
 
 } EPT_HOOKED_PAGE_DETAIL, *PEPT_HOOKED_PAGE_DETAIL;
 
@@ -1260,6 +1330,24 @@ EptCheckFeatures();
 BOOLEAN
 EptBuildMtrrMap();
 
+/**
+ * @brief Compute the size of the identity map
+ * 
+ * @param Is1GbPagesSupported 
+ * @return UINT64 
+ */
+UINT64
+EptGetIdentityMapSize(BOOLEAN Is1GbPagesSupported);
+
+/**
+ * @brief Free the identity page table
+ * 
+ * @param PageTable 
+ * @return VOID 
+ */
+VOID
+EptFreeIdentityPageTable(PVMM_EPT_PAGE_TABLE PageTable);
+
 /**
  * @brief Convert 2MB pages to 4KB pages
  * 
@@ -1299,6 +1387,26 @@ EptInitializeSeconadaryEpt();
 BOOLEAN
 EptHandleEptViolation(PGUEST_REGS Regs, ULONG ExitQualification, UINT64 GuestPhysicalAddr);
 
+/**
+ * @brief Get the PML3 Entry of a special address
+ * 
+ * @param EptPageTable 
+ * @param PhysicalAddress 
+ * @return PEPT_PML3_POINTER 
+ */
+PEPT_PML3_POINTER
+EptGetPml3Entry(PVMM_EPT_PAGE_TABLE EptPageTable, SIZE_T PhysicalAddress);
+
+/**
+ * @brief Get the PML2 Entry of a special address
+ * 
+ * @param EptPageTable 
+ * @param PhysicalAddress 
+ * @return PEPT_PML2_ENTRY 
+ */
+PEPT_PML2_ENTRY
+EptGetPml2Entry(PVMM_EPT_PAGE_TABLE EptPageTable, SIZE_T PhysicalAddress);
+
 /**
  * @brief Get the PML1 Entry of a special address
  * 
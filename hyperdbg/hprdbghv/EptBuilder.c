@@ -0,0 +1,297 @@
+/**
+ * @file EptBuilder.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Builder of the identity mapped EPT tables
+ * @details The identity map covers the physical address width of the
+ * processor, the 1GB regions that have a single memory type are mapped
+ * by 1GB pages and the PML2 tables are only allocated for the rest of
+ * the regions (and later for the regions that are split)
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Compute the size of the physical memory that should be identity mapped
+ *
+ * @details With 1GB pages, each 1GB region needs a single entry so the whole
+ * physical address space is mapped; otherwise each 1GB region needs a PML2
+ * table, so the map covers the first 512GB and the regions of the RAM
+ *
+ * @param PhysicalAddressWidth The physical address width (MAXPHYADDR) or zero
+ * if the processor doesn't report it
+ * @param Use1GbPages Whether 1GB pages can be used or not
+ * @param PhysicalMemoryEnd The end of the last range of the RAM
+ * @return UINT64 Size of the identity map (1GB granularity)
+ */
+UINT64
+EptBuilderGetIdentityMapSize(UINT32 PhysicalAddressWidth, BOOLEAN Use1GbPages, UINT64 PhysicalMemoryEnd)
+{
+    UINT64 MaximumSize;
+    UINT64 Size;
+
+    if (PhysicalAddressWidth == 0)
+    {
+        PhysicalAddressWidth = EPT_BUILDER_DEFAULT_PHYSICAL_ADDRESS_WIDTH;
+    }
+
+    PhysicalAddressWidth = min(PhysicalAddressWidth, EPT_BUILDER_MAXIMUM_PHYSICAL_ADDRESS_WIDTH);
+    MaximumSize          = max(1ULL << PhysicalAddressWidth, SIZE_1_GB);
+
+    if (Use1GbPages)
+    {
+        return MaximumSize;
+    }
+
+    Size = SIZE_512_GB;
+
+    if (PhysicalMemoryEnd > Size)
+    {
+        Size = (PhysicalMemoryEnd + SIZE_512_GB - 1) & ~(SIZE_512_GB - 1);
+    }
+
+    return min(Size, MaximumSize);
+}
+
+/**
+ * @brief Compute the memory type of a physical range based on the MTRR ranges
+ *
+ * @details The type of the range is the type of the MTRR ranges that overlap
+ * with it (UC takes precedence), the range is uniform if none of these MTRR
+ * ranges partially overlaps with it. The first 2MB is always UC as the fixed
+ * MTRRs (typically there is MMIO memory in the first MB) are not recognized
+ *
+ * @param MemoryRanges The ranges that their memory type is not WB
+ * @param NumberOfMemoryRanges Count of the ranges in MemoryRanges
+ * @param BaseAddress Base physical address of the range
+ * @param Size Size of the range
+ * @param IsUniform Shows whether all of the range has the returned memory type
+ * @return UCHAR The memory type
+ */
+UCHAR
+EptBuilderGetMemoryType(const MTRR_RANGE_DESCRIPTOR * MemoryRanges,
+                        UINT32                        NumberOfMemoryRanges,
+                        UINT64                        BaseAddress,
+                        UINT64                        Size,
+                        BOOLEAN *                     IsUniform)
+{
+    UINT64 EndAddress       = BaseAddress + Size - 1;
+    UCHAR  TargetMemoryType = MEMORY_TYPE_WRITE_BACK;
+
+    *IsUniform = TRUE;
+
+    if (BaseAddress == 0)
+    {
+        *IsUniform = Size <= SIZE_2_MB;
+        return MEMORY_TYPE_UNCACHEABLE;
+    }
+
+    for (UINT32 i = 0; i < NumberOfMemoryRanges; i++)
+    {
+        if (BaseAddress > MemoryRanges[i].PhysicalEndAddress || EndAddress < MemoryRanges[i].PhysicalBaseAddress)
+        {
+            continue;
+        }
+
+        if (BaseAddress < MemoryRanges[i].PhysicalBaseAddress || EndAddress > MemoryRanges[i].PhysicalEndAddress)
+        {
+            *IsUniform = FALSE;
+        }
+
+        TargetMemoryType = MemoryRanges[i].MemoryType;
+
+        //
+        // 11.11.4.1 MTRR Precedences, if the whole range is UC then the
+        // other ranges don't matter, otherwise it's already not uniform
+        //
+        if (TargetMemoryType == MEMORY_TYPE_UNCACHEABLE)
+        {
+            break;
+        }
+    }
+
+    return TargetMemoryType;
+}
+
+/**
+ * @brief Fill the 512 2MB entries of a 1GB region
+ *
+ * @param Configuration The configuration of the identity map
+ * @param PML2 The PML2 table
+ * @param BaseAddress Base physical address of the 1GB region
+ * @return VOID
+ */
+VOID
+EptBuilderSetupPml2Table(PEPT_BUILDER_CONFIGURATION Configuration, PEPT_PML2_ENTRY PML2, UINT64 BaseAddress)
+{
+    EPT_PML2_ENTRY EntryTemplate = {0};
+    BOOLEAN        IsUniform;
+
+    //
+    // All of the entries are RWX 2MB pages, they're present regardless of
+    // if the actual system has memory at this region or not
+    //
+    EntryTemplate.ReadAccess    = 1;
+    EntryTemplate.WriteAccess   = 1;
+    EntryTemplate.ExecuteAccess = 1;
+    EntryTemplate.LargePage     = 1;
+
+    for (UINT32 EntryIndex = 0; EntryIndex < VMM_EPT_PML2E_COUNT; EntryIndex++)
+    {
+        PML2[EntryIndex].Flags           = EntryTemplate.Flags;
+        PML2[EntryIndex].PageFrameNumber = (BaseAddress / SIZE_2_MB) + EntryIndex;
+        PML2[EntryIndex].MemoryType      = EptBuilderGetMemoryType(Configuration->MemoryRanges,
+                                                                   Configuration->NumberOfMemoryRanges,
+                                                                   BaseAddress + (EntryIndex * SIZE_2_MB),
+                                                                   SIZE_2_MB,
+                                                                   &IsUniform);
+    }
+}
+
+/**
+ * @brief Build the identity map in a zeroed page table
+ *
+ * @details If an allocation fails, the tables that are already allocated
+ * are kept in the page table, so the caller can free them
+ *
+ * @param Configuration The configuration of the identity map
+ * @param PageTable The page table
+ * @return BOOLEAN Returns FALSE if a table can't be allocated
+ */
+BOOLEAN
+EptBuilderBuildIdentityMap(PEPT_BUILDER_CONFIGURATION Configuration, PVMM_EPT_PAGE_TABLE PageTable)
+{
+    EPT_PML4_POINTER    PML4Template = {0};
+    EPT_PML3_POINTER    PML3Template = {0};
+    PEPT_PML3_POINTER   PML3;
+    PEPT_PML3_ENTRY     LargeEntry;
+    PVMM_EPT_PML2_TABLE PML2Table;
+    UINT64              PhysicalAddress;
+    UINT64              PML4Index;
+    UCHAR               MemoryType;
+    BOOLEAN             IsUniform;
+
+    PML4Template.ReadAccess    = 1;
+    PML4Template.WriteAccess   = 1;
+    PML4Template.ExecuteAccess = 1;
+
+    PML3Template.ReadAccess    = 1;
+    PML3Template.WriteAccess   = 1;
+    PML3Template.ExecuteAccess = 1;
+
+    InitializeListHead(&PageTable->PML2TablesList);
+    PageTable->IdentityMapSize = Configuration->IdentityMapSize;
+
+    for (UINT64 Address = 0; Address < Configuration->IdentityMapSize; Address += SIZE_1_GB)
+    {
+        PML4Index = ADDRMASK_EPT_PML4_INDEX(Address);
+
+        //
+        // Allocate the PML3 table of this 512GB region at the first 1GB region
+        //
+        if (PageTable->PML3[PML4Index] == NULL)
+        {
+            PML3 = Configuration->AllocateTable(PAGE_SIZE, &PhysicalAddress);
+
+            if (PML3 == NULL)
+            {
+                return FALSE;
+            }
+
+            PageTable->PML3[PML4Index]                 = PML3;
+            PageTable->PML4[PML4Index].Flags           = PML4Template.Flags;
+            PageTable->PML4[PML4Index].PageFrameNumber = PhysicalAddress / PAGE_SIZE;
+        }
+
+        PML3       = &PageTable->PML3[PML4Index][ADDRMASK_EPT_PML3_INDEX(Address)];
+        MemoryType = EptBuilderGetMemoryType(Configuration->MemoryRanges,
+                                             Configuration->NumberOfMemoryRanges,
+                                             Address,
+                                             SIZE_1_GB,
+                                             &IsUniform);
+
+        if (Configuration->Use1GbPages && IsUniform)
+        {
+            //
+            // The whole region has a single memory type, so it's mapped as a 1GB page
+            //
+            LargeEntry                  = (PEPT_PML3_ENTRY)PML3;
+            LargeEntry->Flags           = 0;
+            LargeEntry->ReadAccess      = 1;
+            LargeEntry->WriteAccess     = 1;
+            LargeEntry->ExecuteAccess   = 1;
+            LargeEntry->LargePage       = 1;
+            LargeEntry->MemoryType      = MemoryType;
+            LargeEntry->PageFrameNumber = Address / SIZE_1_GB;
+
+            continue;
+        }
+
+        //
+        // Otherwise, the region is described by 512 2MB entries
+        //
+        PML2Table = Configuration->AllocateTable(sizeof(VMM_EPT_PML2_TABLE), &PhysicalAddress);
+
+        if (PML2Table == NULL)
+        {
+            return FALSE;
+        }
+
+        EptBuilderSetupPml2Table(Configuration, &PML2Table->PML2[0], Address);
+
+        PML2Table->Entry = PML3;
+        InsertHeadList(&PageTable->PML2TablesList, &PML2Table->PML2TablesList);
+
+        PML3->Flags           = PML3Template.Flags;
+        PML3->PageFrameNumber = PhysicalAddress / PAGE_SIZE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Split a 1GB page into 512 2MB pages
+ *
+ * @details The 2MB pages have the same memory type and access rights of
+ * the 1GB page, it can be used in vmx-root as the table is pre-allocated
+ *
+ * @param Entry The PML3 entry of the 1GB page
+ * @param NewTable The table of the 2MB entries
+ * @param PhysicalAddressOfNewTable The physical address of NewTable
+ * @return VOID
+ */
+VOID
+EptBuilderSplitPml3Entry(PEPT_PML3_ENTRY Entry, PVMM_EPT_PML2_TABLE NewTable, UINT64 PhysicalAddressOfNewTable)
+{
+    EPT_PML2_ENTRY   EntryTemplate = {0};
+    EPT_PML3_POINTER NewPointer    = {0};
+
+    EntryTemplate.ReadAccess    = Entry->ReadAccess;
+    EntryTemplate.WriteAccess   = Entry->WriteAccess;
+    EntryTemplate.ExecuteAccess = Entry->ExecuteAccess;
+    EntryTemplate.MemoryType    = Entry->MemoryType;
+    EntryTemplate.IgnorePat     = Entry->IgnorePat;
+    EntryTemplate.LargePage     = 1;
+
+    for (UINT32 EntryIndex = 0; EntryIndex < VMM_EPT_PML2E_COUNT; EntryIndex++)
+    {
+        NewTable->PML2[EntryIndex].Flags           = EntryTemplate.Flags;
+        NewTable->PML2[EntryIndex].PageFrameNumber = ((Entry->PageFrameNumber * SIZE_1_GB) / SIZE_2_MB) + EntryIndex;
+    }
+
+    NewTable->Entry = (PEPT_PML3_POINTER)Entry;
+
+    NewPointer.ReadAccess      = 1;
+    NewPointer.WriteAccess     = 1;
+    NewPointer.ExecuteAccess   = 1;
+    NewPointer.PageFrameNumber = PhysicalAddressOfNewTable / PAGE_SIZE;
+
+    //
+    // Replace the 1GB page with the pointer to the 2MB entries
+    //
+    Entry->Flags = NewPointer.Flags;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file EptBuilder.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the builder of the identity mapped EPT tables
+ * @details The builder doesn't depend on any kernel routine or vmx
+ * instruction, the tables are allocated by the routine that is passed
+ * in the configuration and the memory types are computed from the
+ * MTRR ranges of the configuration
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The maximum physical address width that can be mapped with
+ * a 4-level EPT page-walk (256TB)
+ *
+ */
+#define EPT_BUILDER_MAXIMUM_PHYSICAL_ADDRESS_WIDTH 48
+
+/**
+ * @brief The physical address width if the processor doesn't report it
+ *
+ */
+#define EPT_BUILDER_DEFAULT_PHYSICAL_ADDRESS_WIDTH 36
+
+/**
+ * @brief Allocate a zeroed, page-aligned and physically contiguous table
+ *
+ * @param Size Size of the table
+ * @param PhysicalAddress Physical address of the table
+ * @return PVOID Virtual address of the table or NULL if it's not allocated
+ */
+typedef PVOID (*EPT_BUILDER_ALLOCATE_TABLE)(SIZE_T Size, UINT64 * PhysicalAddress);
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The configuration of the identity map
+ *
+ */
+typedef struct _EPT_BUILDER_CONFIGURATION
+{
+    const MTRR_RANGE_DESCRIPTOR * MemoryRanges;         // The ranges that their memory type is not WB
+    UINT32                        NumberOfMemoryRanges; // Count of the ranges in MemoryRanges
+    UINT64                        IdentityMapSize;      // Size of the mapped physical memory (1GB granularity)
+    BOOLEAN                       Use1GbPages;          // Whether 1GB pages can be used or not
+    EPT_BUILDER_ALLOCATE_TABLE    AllocateTable;        // The routine that allocates the PML3 and PML2 tables
+
+} EPT_BUILDER_CONFIGURATION, *PEPT_BUILDER_CONFIGURATION;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT64
+EptBuilderGetIdentityMapSize(UINT32 PhysicalAddressWidth, BOOLEAN Use1GbPages, UINT64 PhysicalMemoryEnd);
+
+UCHAR
+EptBuilderGetMemoryType(const MTRR_RANGE_DESCRIPTOR * MemoryRanges,
+                        UINT32                        NumberOfMemoryRanges,
+                        UINT64                        BaseAddress,
+                        UINT64                        Size,
+                        BOOLEAN *                     IsUniform);
+
+VOID
+EptBuilderSetupPml2Table(PEPT_BUILDER_CONFIGURATION Configuration, PEPT_PML2_ENTRY PML2, UINT64 BaseAddress);
+
+BOOLEAN
+EptBuilderBuildIdentityMap(PEPT_BUILDER_CONFIGURATION Configuration, PVMM_EPT_PAGE_TABLE PageTable);
+
+VOID
+EptBuilderSplitPml3Entry(PEPT_PML3_ENTRY Entry, PVMM_EPT_PML2_TABLE NewTable, UINT64 PhysicalAddressOfNewTable);
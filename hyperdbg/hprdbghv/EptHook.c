@@ -31,6 +31,170 @@ ExAllocatePoolWithTagHook(
     return ExAllocatePoolWithTagOrig(PoolType, NumberOfBytes, Tag);
 }
 
+/**
+ * @brief Find the hooked page of a physical page
+ * 
+ * @param PhysicalBaseAddress The physical address of the page
+ * @return PEPT_HOOKED_PAGE_DETAIL Returns the hooked page or NULL if the page is not hooked
+ */
+PEPT_HOOKED_PAGE_DETAIL
+EptHookFindHookedPage(SIZE_T PhysicalBaseAddress)
+{
+    PLIST_ENTRY TempList = 0;
+    PLIST_ENTRY Bucket   = &g_EptState->HookedPagesBuckets[EPT_HOOKED_PAGES_BUCKET(PhysicalBaseAddress)];
+
+    //
+    // Only the pages of the same bucket (page frame number) are compared
+    //
+    TempList = Bucket;
+
+    while (Bucket != TempList->Flink)
+    {
+        TempList                            = TempList->Flink;
+        PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookBucketList);
+
+        if (HookedEntry->PhysicalBaseAddress == PhysicalBaseAddress)
+        {
+            return HookedEntry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find the first hook of a page which its offset is not less than
+ * the target offset
+ * 
+ * @param HookedPage The hooked page
+ * @param Offset The offset in the page
+ * @return UINT32 
+ */
+UINT32
+EptHookLowerBoundOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset)
+{
+    UINT32 Low  = 0;
+    UINT32 High = HookedPage->CountOfHookedOffsets;
+    UINT32 Middle;
+
+    while (Low < High)
+    {
+        Middle = Low + (High - Low) / 2;
+
+        if (HookedPage->HookedOffsets[Middle].Offset < Offset)
+        {
+            Low = Middle + 1;
+        }
+        else
+        {
+            High = Middle;
+        }
+    }
+
+    return Low;
+}
+
+/**
+ * @brief Find the hook of a page at the target offset
+ * 
+ * @param HookedPage The hooked page
+ * @param Offset The offset in the page
+ * @return PEPT_HOOKED_OFFSET Returns the hook or NULL if there is no hook at this offset
+ */
+PEPT_HOOKED_OFFSET
+EptHookFindHookedOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset)
+{
+    UINT32 Position = EptHookLowerBoundOffset(HookedPage, Offset);
+
+    if (Position < HookedPage->CountOfHookedOffsets && HookedPage->HookedOffsets[Position].Offset == Offset)
+    {
+        return &HookedPage->HookedOffsets[Position];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check whether a range of the fake page is changed by the hooks of the page
+ * 
+ * @param HookedPage The hooked page
+ * @param Offset Start of the range in the page
+ * @param Length Length of the range
+ * @return BOOLEAN Returns TRUE if any hook overlaps with the range
+ */
+BOOLEAN
+EptHookIsRangeHooked(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset, UINT64 Length)
+{
+    UINT32             Position = EptHookLowerBoundOffset(HookedPage, Offset);
+    PEPT_HOOKED_OFFSET Previous;
+
+    //
+    // The previous hook should end before the range and the next
+    // hook should start after the range
+    //
+    if (Position > 0)
+    {
+        Previous = &HookedPage->HookedOffsets[Position - 1];
+
+        if ((UINT64)Previous->Offset + Previous->Length > Offset)
+        {
+            return TRUE;
+        }
+    }
+
+    if (Position < HookedPage->CountOfHookedOffsets && HookedPage->HookedOffsets[Position].Offset < Offset + Length)
+    {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Add a hook to the sorted hooks of a page
+ * @details the caller should check that the table is not full and
+ * the hook doesn't overlap with other hooks
+ * 
+ * @param HookedPage The hooked page
+ * @param Offset The offset of the hook in the page
+ * @return PEPT_HOOKED_OFFSET The new (zeroed) hook
+ */
+PEPT_HOOKED_OFFSET
+EptHookInsertHookedOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset)
+{
+    UINT32 Position = EptHookLowerBoundOffset(HookedPage, Offset);
+
+    RtlMoveMemory(&HookedPage->HookedOffsets[Position + 1],
+                  &HookedPage->HookedOffsets[Position],
+                  (HookedPage->CountOfHookedOffsets - Position) * sizeof(EPT_HOOKED_OFFSET));
+
+    RtlZeroMemory(&HookedPage->HookedOffsets[Position], sizeof(EPT_HOOKED_OFFSET));
+
+    HookedPage->HookedOffsets[Position].Offset = (UINT16)Offset;
+    HookedPage->CountOfHookedOffsets++;
+
+    return &HookedPage->HookedOffsets[Position];
+}
+
+/**
+ * @brief Remove a hook from the sorted hooks of a page
+ * 
+ * @param HookedPage The hooked page
+ * @param HookedOffset The hook
+ * @return VOID 
+ */
+VOID
+EptHookRemoveHookedOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, PEPT_HOOKED_OFFSET HookedOffset)
+{
+    UINT32 Position = (UINT32)(HookedOffset - &HookedPage->HookedOffsets[0]);
+
+    HookedPage->CountOfHookedOffsets--;
+
+    RtlMoveMemory(&HookedPage->HookedOffsets[Position],
+                  &HookedPage->HookedOffsets[Position + 1],
+                  (HookedPage->CountOfHookedOffsets - Position) * sizeof(EPT_HOOKED_OFFSET));
+}
+
 /**
  * @brief The main function that performs EPT page hook with hidden breakpoint
  * @details This function returns false in VMX Non-Root Mode if the VM is already initialized
@@ -52,12 +216,11 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
     UINT64                  PageOffset;
     PEPT_PML1_ENTRY         TargetPage;
     PEPT_HOOKED_PAGE_DETAIL HookedPage;
+    PEPT_HOOKED_OFFSET      HookedOffset;
     ULONG                   LogicalCoreIndex;
     CR3_TYPE                Cr3OfCurrentProcess;
     BYTE                    OriginalByte;
-    PEPT_HOOKED_PAGE_DETAIL HookedEntry      = NULL;
-    BOOLEAN                 HookedEntryFound = FALSE;
-    PLIST_ENTRY             TempList         = 0;
+    PEPT_HOOKED_PAGE_DETAIL HookedEntry = NULL;
 
     //
     // Check whether we are in VMX Root Mode or Not
@@ -96,40 +259,50 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
     //
     // try to see if we can find the address
     //
-    TempList = &g_EptState->HookedPagesList;
+    HookedEntry = EptHookFindHookedPage(PhysicalBaseAddress);
 
-    while (&g_EptState->HookedPagesList != TempList->Flink)
+    //
+    // Check if this address is previously splitted and converted to a hooked page structure or not
+    //
+    if (HookedEntry != NULL)
     {
-        TempList    = TempList->Flink;
-        HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
+        //
+        // The page is unhooked but it's not restored on all of the cores yet
+        //
+        if (HookedEntry->IsBeingRemoved)
+        {
+            LogError("The page is being unhooked");
+            return FALSE;
+        }
 
-        if (HookedEntry->PhysicalBaseAddress == PhysicalBaseAddress)
+        //
+        // The breakpoints can only be added to the pages that have a
+        // fake page (not the pages that are hooked for read or write)
+        //
+        if (!HookedEntry->IsExecutionHook)
         {
-            //
-            // Means that we find the address
-            //
-            HookedEntryFound = TRUE;
-            break;
+            LogError("The page is already hooked for read or write");
+            return FALSE;
         }
-    }
 
-    //
-    // Check if this address is previously splitted and converted to a breakpoint structure or not
-    //
-    if (HookedEntryFound && HookedEntry)
-    {
         //
-        // Here we should add the breakpoint to previous breakpoint
+        // Here we should add the breakpoint to the previous hooks of the page
         //
-        if (HookedEntry->CountOfBreakpoints >= MaximumHiddenBreakpointsOnPage)
+        if (HookedEntry->CountOfHookedOffsets >= MaximumHiddenHooksOnPage)
         {
             //
-            // Means that breakpoint is full !
+            // Means that the page is full !
             // we can't apply this breakpoint
             //
             return FALSE;
         }
 
+        if (EptHookIsRangeHooked(HookedEntry, PAGE_OFFSET(TargetAddress), 1))
+        {
+            LogError("The address is already hooked");
+            return FALSE;
+        }
+
         //
         // Apply the hook 0xcc
         //
@@ -155,27 +328,21 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
         *(BYTE *)TargetAddressInFakePageContent = 0xcc;
 
         //
-        // Add target address to the list of breakpoints
+        // Add target address to the hooks of the page and save the original byte
         //
-        HookedEntry->BreakpointAddresses[HookedEntry->CountOfBreakpoints] = TargetAddress;
-
-        //
-        // Save the original byte
-        //
-        HookedEntry->PreviousBytesOnBreakpointAddresses[HookedEntry->CountOfBreakpoints] = OriginalByte;
-
-        //
-        // Add to the breakpoint counts
-        //
-        HookedEntry->CountOfBreakpoints = HookedEntry->CountOfBreakpoints + 1;
+        HookedOffset                     = EptHookInsertHookedOffset(HookedEntry, PageOffset);
+        HookedOffset->VirtualAddress     = TargetAddress;
+        HookedOffset->IsHiddenBreakpoint = TRUE;
+        HookedOffset->Length             = 1;
+        HookedOffset->PreviousByte       = OriginalByte;
     }
     else
     {
         //
-        // Set target buffer, request buffer from pool manager,
-        // we also need to allocate new page to replace the current page ASAP
+        // Set target buffer, take a table from the split pool, the pool
+        // is refilled in the background if it's running low
         //
-        TargetBuffer = PoolManagerRequestPool(SPLIT_2MB_PAGING_TO_4KB_PAGE, TRUE, sizeof(VMM_EPT_DYNAMIC_SPLIT));
+        TargetBuffer = EptSplitPoolAcquire();
 
         if (!TargetBuffer)
         {
@@ -219,11 +386,6 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
             return FALSE;
         }
 
-        //
-        // This is a hidden breakpoint
-        //
-        HookedPage->IsHiddenBreakpoint = TRUE;
-
         //
         // Save the virtual address
         //
@@ -254,16 +416,6 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
         //
         HookedPage->IsExecutionHook = TRUE;
 
-        //
-        // Save the address of (first) new breakpoint
-        //
-        HookedPage->BreakpointAddresses[0] = TargetAddress;
-
-        //
-        // Change the counter (set it to 1)
-        //
-        HookedPage->CountOfBreakpoints = 1;
-
         //
         // In execution hook, we have to make sure to unset read, write because
         // an EPT violation should occur for these cases and we can swap the original page
@@ -299,6 +451,11 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
         //
         MemoryMapperReadMemorySafe(VirtualTarget, &HookedPage->FakePageContents, PAGE_SIZE);
 
+        //
+        // Read the original byte
+        //
+        OriginalByte = *(BYTE *)TargetAddressInFakePageContent;
+
         //
         // Set the breakpoint on the fake page
         //
@@ -309,15 +466,28 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
         //
         RestoreToPreviousProcess(Cr3OfCurrentProcess);
 
+        //
+        // Save the (first) hook of the page and the original byte
+        //
+        HookedPage->CountOfHookedOffsets = 0;
+        HookedPage->IsBeingRemoved       = FALSE;
+
+        HookedOffset                     = EptHookInsertHookedOffset(HookedPage, PageOffset);
+        HookedOffset->VirtualAddress     = TargetAddress;
+        HookedOffset->IsHiddenBreakpoint = TRUE;
+        HookedOffset->Length             = 1;
+        HookedOffset->PreviousByte       = OriginalByte;
+
         //
         // Save the modified entry
         //
         HookedPage->ChangedEntry = ChangedEntry;
 
         //
-        // Add it to the list
+        // Add it to the list and to the bucket of its page frame number
         //
         InsertHeadList(&g_EptState->HookedPagesList, &(HookedPage->PageHookList));
+        InsertHeadList(&g_EptState->HookedPagesBuckets[EPT_HOOKED_PAGES_BUCKET(HookedPage->PhysicalBaseAddress)], &(HookedPage->PageHookBucketList));
 
         //
         // if not launched, there is no need to modify it on a safe environment
@@ -332,9 +502,9 @@ EptHookPerformPageHook(PVOID TargetAddress, CR3_TYPE ProcessCr3)
         else
         {
             //
-            // Apply the hook to EPT
+            // Apply the hook to EPT (or stage it in the current transaction)
             //
-            EptSetPML1AndInvalidateTLB(TargetPage, ChangedEntry, INVEPT_SINGLE_CONTEXT);
+            EptTransactionSetPml1Entry(TargetPage, ChangedEntry);
         }
     }
 
@@ -374,20 +544,36 @@ EptHook(PVOID TargetAddress, UINT32 ProcessId)
         //
         HvEnableBreakpointExitingOnExceptionBitmapAllCores();
 
+        //
+        // The pages that are unhooked in the current transaction are freed
+        // first, so they can be hooked again
+        //
+        if (EptTransactionIsActive())
+        {
+            EptTransactionFlushRemovedPages();
+        }
+
         if (AsmVmxVmcall(VMCALL_SET_HIDDEN_CC_BREAKPOINT, TargetAddress, GetCr3FromProcessId(ProcessId).Flags, NULL) == STATUS_SUCCESS)
         {
             LogDebugInfo("Hidden breakpoint hook applied from VMX Root Mode");
 
-            if (!g_GuestState[LogicalCoreIndex].IsOnVmxRootMode)
-            {
-                //
-                // Now we have to notify all the core to invalidate their EPT
-                //
-                HvNotifyAllToInvalidateEpt();
-            }
-            else
+            //
+            // If there is a transaction then the hook is staged, all of the
+            // cores are notified when the transaction is committed
+            //
+            if (!EptTransactionIsActive())
             {
-                LogError("Unable to notify all cores to invalidate their TLB caches as you called hook on vmx-root mode.");
+                if (!g_GuestState[LogicalCoreIndex].IsOnVmxRootMode)
+                {
+                    //
+                    // Now we have to notify all the core to invalidate their EPT
+                    //
+                    HvNotifyAllToInvalidateEpt();
+                }
+                else
+                {
+                    LogError("Unable to notify all cores to invalidate their TLB caches as you called hook on vmx-root mode.");
+                }
             }
 
             return TRUE;
@@ -480,6 +666,69 @@ EptHookRestoreAllHooksToOrginalEntry()
     }
 }
 
+/**
+ * @brief Restore the hooked pages that are removed in a transaction and
+ * invalidate TLB
+ * @details Should be called from vmx-root on all of the cores (by the
+ * corresponding VMCALL), a core that restored the hook of a page on its
+ * MTF before this call doesn't use the page after this call
+ * 
+ * @param Transaction The transaction of the removed pages
+ * @return VOID 
+ */
+VOID
+EptHookRestoreRemovedHooksToOrginalEntry(PEPT_TRANSACTION Transaction)
+{
+    //
+    // Should be called from vmx-root, for calling from vmx non-root use the corresponding VMCALL
+    //
+    if (!g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode)
+    {
+        return;
+    }
+
+    SpinlockLock(&Pml1ModificationAndInvalidationLock);
+
+    for (UINT32 i = 0; i < Transaction->CountOfRemovedPages; i++)
+    {
+        Transaction->RemovedPages[i]->EntryAddress->Flags = Transaction->RemovedPages[i]->OriginalEntry.Flags;
+    }
+
+    //
+    // Invalidate the entries (and the other changes of the transaction) once
+    //
+    InveptSingleContext(g_EptState->EptPointer.Flags);
+
+    SpinlockUnlock(&Pml1ModificationAndInvalidationLock);
+}
+
+/**
+ * @brief Remove a hooked page from the hooked pages list and free it
+ * @details Should be called from vmx non-root, after the original entry
+ * of the page is restored on all of the cores
+ * 
+ * @param HookedEntry The hooked page
+ * @return VOID 
+ */
+VOID
+EptHookFreeHookedPage(PEPT_HOOKED_PAGE_DETAIL HookedEntry)
+{
+    //
+    // remove the entry from the list
+    //
+    RemoveEntryList(&HookedEntry->PageHookList);
+    RemoveEntryList(&HookedEntry->PageHookBucketList);
+
+    //
+    // we add the hooked entry to the list
+    // of pools that will be deallocated on next IOCTL
+    //
+    if (!PoolManagerFreePool(HookedEntry))
+    {
+        LogError("Something goes wrong ! the pool not found in the list of previously allocated pools by pool manager.");
+    }
+}
+
 /**
  * @brief Write an absolute x64 jump to an arbitrary address to a buffer
  * 
@@ -556,7 +805,9 @@ EptHookWriteAbsoluteJump2(PCHAR TargetBuffer, SIZE_T TargetAddress)
 }
 
 /**
- * @brief Hook ins
+ * @brief Hook instructions of a page with a detour
+ * @details The hook is added to the sorted hooks of the page, so a page
+ * can have multiple detours (and hidden breakpoints) on its fake page
  * 
  * @param Hook The details of hooked pages
  * @param ProcessCr3 The target Process CR3
@@ -569,6 +820,8 @@ BOOLEAN
 EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOID TargetFunction, PVOID TargetFunctionInSafeMemory, PVOID HookFunction)
 {
     PHIDDEN_HOOKS_DETOUR_DETAILS DetourHookDetails;
+    PEPT_HOOKED_OFFSET           HookedOffset;
+    PCHAR                        Trampoline;
     SIZE_T                       SizeOfHookedInstructions;
     SIZE_T                       OffsetIntoPage;
     CR3_TYPE                     Cr3OfCurrentProcess;
@@ -582,6 +835,22 @@ EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOI
         return FALSE;
     }
 
+    if (Hook->CountOfHookedOffsets >= MaximumHiddenHooksOnPage)
+    {
+        LogError("Maximum number of hooks on this page is reached");
+        return FALSE;
+    }
+
+    //
+    // The instructions should be disassembled from the original bytes, so
+    // the jump shouldn't overwrite other hooks of the page
+    //
+    if (EptHookIsRangeHooked(Hook, OffsetIntoPage, 18))
+    {
+        LogError("The hook overlaps with other hooks of the page");
+        return FALSE;
+    }
+
     //
     // Determine the number of instructions necessary to overwrite using Length Disassembler Engine
     //
@@ -595,6 +864,12 @@ EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOI
     }
     LogInfo("Number of bytes of instruction mem: %d", SizeOfHookedInstructions);
 
+    if (EptHookIsRangeHooked(Hook, OffsetIntoPage, SizeOfHookedInstructions))
+    {
+        LogError("The hook overlaps with other hooks of the page");
+        return FALSE;
+    }
+
     //
     // Build a trampoline
     //
@@ -602,9 +877,9 @@ EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOI
     //
     // Allocate some executable memory for the trampoline
     //
-    Hook->Trampoline = PoolManagerRequestPool(EXEC_TRAMPOLINE, TRUE, MAX_EXEC_TRAMPOLINE_SIZE);
+    Trampoline = PoolManagerRequestPool(EXEC_TRAMPOLINE, TRUE, MAX_EXEC_TRAMPOLINE_SIZE);
 
-    if (!Hook->Trampoline)
+    if (!Trampoline)
     {
         LogError("Could not allocate trampoline function buffer.");
         return FALSE;
@@ -620,9 +895,9 @@ EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOI
 
     //
     // The following line can't be used in user mode addresses
-    // RtlCopyMemory(Hook->Trampoline, TargetFunction, SizeOfHookedInstructions);
+    // RtlCopyMemory(Trampoline, TargetFunction, SizeOfHookedInstructions);
     //
-    MemoryMapperReadMemorySafe(TargetFunction, Hook->Trampoline, SizeOfHookedInstructions);
+    MemoryMapperReadMemorySafe(TargetFunction, Trampoline, SizeOfHookedInstructions);
 
     //
     // Restore to original process
@@ -632,15 +907,15 @@ EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOI
     //
     // Add the absolute jump back to the original function
     //
-    EptHookWriteAbsoluteJump2(&Hook->Trampoline[SizeOfHookedInstructions], (SIZE_T)TargetFunction + SizeOfHookedInstructions);
+    EptHookWriteAbsoluteJump2(&Trampoline[SizeOfHookedInstructions], (SIZE_T)TargetFunction + SizeOfHookedInstructions);
 
-    LogInfo("Trampoline: 0x%llx", Hook->Trampoline);
+    LogInfo("Trampoline: 0x%llx", Trampoline);
     LogInfo("HookFunction: 0x%llx", HookFunction);
 
     //
     // Let the hook function call the original function
     //
-    // *OrigFunction = Hook->Trampoline;
+    // *OrigFunction = Trampoline;
     //
 
     //
@@ -648,15 +923,29 @@ EptHookInstructionMemory(PEPT_HOOKED_PAGE_DETAIL Hook, CR3_TYPE ProcessCr3, PVOI
     // function that changes the original function and if our structure is no ready after this
     // fucntion then we probably see BSOD on other cores
     //
-    DetourHookDetails                        = PoolManagerRequestPool(DETOUR_HOOK_DETAILS, TRUE, sizeof(HIDDEN_HOOKS_DETOUR_DETAILS));
+    DetourHookDetails = PoolManagerRequestPool(DETOUR_HOOK_DETAILS, TRUE, sizeof(HIDDEN_HOOKS_DETOUR_DETAILS));
+
+    if (!DetourHookDetails)
+    {
+        LogError("There is no pre-allocated pool for saving the detour details");
+        PoolManagerFreePool(Trampoline);
+        return FALSE;
+    }
+
     DetourHookDetails->HookedFunctionAddress = TargetFunction;
-    DetourHookDetails->ReturnAddress         = Hook->Trampoline;
+    DetourHookDetails->ReturnAddress         = Trampoline;
 
     //
-    // Save the address of DetourHookDetails because we want to
+    // Save the hook in the page, the trampoline contains the original bytes
+    // and the address of DetourHookDetails is kept because we want to
     // deallocate it when the hook is finished
     //
-    Hook->AddressOfEptHook2sDetourListEntry = DetourHookDetails;
+    HookedOffset                     = EptHookInsertHookedOffset(Hook, OffsetIntoPage);
+    HookedOffset->VirtualAddress     = TargetFunction;
+    HookedOffset->Trampoline         = Trampoline;
+    HookedOffset->DetourHookDetails  = DetourHookDetails;
+    HookedOffset->Length             = (UINT16)SizeOfHookedInstructions;
+    HookedOffset->IsHiddenBreakpoint = FALSE;
 
     //
     // Insert it to the list of hooked pages
@@ -698,7 +987,6 @@ EptHookPerformPageHook2(PVOID TargetAddress, PVOID HookFunction, CR3_TYPE Proces
     PEPT_HOOKED_PAGE_DETAIL HookedPage;
     ULONG                   LogicalCoreIndex;
     CR3_TYPE                Cr3OfCurrentProcess;
-    PLIST_ENTRY             TempList    = 0;
     PEPT_HOOKED_PAGE_DETAIL HookedEntry = NULL;
 
     //
@@ -738,28 +1026,51 @@ EptHookPerformPageHook2(PVOID TargetAddress, PVOID HookFunction, CR3_TYPE Proces
     //
     // try to see if we can find the address
     //
-    TempList = &g_EptState->HookedPagesList;
+    HookedEntry = EptHookFindHookedPage(PhysicalBaseAddress);
 
-    while (&g_EptState->HookedPagesList != TempList->Flink)
+    if (HookedEntry != NULL)
     {
-        TempList    = TempList->Flink;
-        HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
+        //
+        // The page is unhooked but it's not restored on all of the cores yet
+        //
+        if (HookedEntry->IsBeingRemoved)
+        {
+            LogError("The page is being unhooked");
+            return FALSE;
+        }
 
-        if (HookedEntry->PhysicalBaseAddress == PhysicalBaseAddress)
+        //
+        // Only the detours can be added to a page that is already hooked, they
+        // share the fake page with other hidden breakpoints and detours of the
+        // page, the pages that are hooked for read or write can't be changed
+        //
+        if (!UnsetExecute || !HookedEntry->IsExecutionHook)
         {
-            //
-            // Means that we find the address and !epthook2 doesn't support
-            // multiple breakpoints in on page
-            //
             return FALSE;
         }
+
+        TargetAddressInSafeMemory = &HookedEntry->FakePageContents;
+        TargetAddressInSafeMemory = PAGE_ALIGN(TargetAddressInSafeMemory);
+        PageOffset                = PAGE_OFFSET(TargetAddress);
+        TargetAddressInSafeMemory = TargetAddressInSafeMemory + PageOffset;
+
+        if (!EptHookInstructionMemory(HookedEntry, ProcessCr3, TargetAddress, TargetAddressInSafeMemory, HookFunction))
+        {
+            LogError("Could not build the hook.");
+            return FALSE;
+        }
+
+        //
+        // The fake page is already in use, so there is no need to change the entry
+        //
+        return TRUE;
     }
 
     //
-    // Set target buffer, request buffer from pool manager,
-    // we also need to allocate new page to replace the current page ASAP
+    // Set target buffer, take a table from the split pool, the pool
+    // is refilled in the background if it's running low
     //
-    TargetBuffer = PoolManagerRequestPool(SPLIT_2MB_PAGING_TO_4KB_PAGE, TRUE, sizeof(VMM_EPT_DYNAMIC_SPLIT));
+    TargetBuffer = EptSplitPoolAcquire();
 
     if (!TargetBuffer)
     {
@@ -841,6 +1152,13 @@ EptHookPerformPageHook2(PVOID TargetAddress, PVOID HookFunction, CR3_TYPE Proces
     //
     HookedPage->OriginalEntry = *TargetPage;
 
+    //
+    // The page has no hooked offsets yet
+    //
+    HookedPage->IsExecutionHook      = FALSE;
+    HookedPage->CountOfHookedOffsets = 0;
+    HookedPage->IsBeingRemoved       = FALSE;
+
     //
     // If it's Execution hook then we have to set extra fields
     //
@@ -907,9 +1225,10 @@ EptHookPerformPageHook2(PVOID TargetAddress, PVOID HookFunction, CR3_TYPE Proces
     HookedPage->ChangedEntry = ChangedEntry;
 
     //
-    // Add it to the list
+    // Add it to the list and to the bucket of its page frame number
     //
     InsertHeadList(&g_EptState->HookedPagesList, &(HookedPage->PageHookList));
+    InsertHeadList(&g_EptState->HookedPagesBuckets[EPT_HOOKED_PAGES_BUCKET(HookedPage->PhysicalBaseAddress)], &(HookedPage->PageHookBucketList));
 
     //
     // if not launched, there is no need to modify it on a safe environment
@@ -924,9 +1243,9 @@ EptHookPerformPageHook2(PVOID TargetAddress, PVOID HookFunction, CR3_TYPE Proces
     else
     {
         //
-        // Apply the hook to EPT
+        // Apply the hook to EPT (or stage it in the current transaction)
         //
-        EptSetPML1AndInvalidateTLB(TargetPage, ChangedEntry, INVEPT_SINGLE_CONTEXT);
+        EptTransactionSetPml1Entry(TargetPage, ChangedEntry);
     }
 
     return TRUE;
@@ -1004,19 +1323,35 @@ EptHook2(PVOID TargetAddress, PVOID HookFunction, UINT32 ProcessId, BOOLEAN SetH
         //
         UINT64 VmcallNumber = ((UINT64)PageHookMask) << 32 | VMCALL_CHANGE_PAGE_ATTRIB;
 
+        //
+        // The pages that are unhooked in the current transaction are freed
+        // first, so they can be hooked again
+        //
+        if (EptTransactionIsActive())
+        {
+            EptTransactionFlushRemovedPages();
+        }
+
         if (AsmVmxVmcall(VmcallNumber, TargetAddress, HookFunction, GetCr3FromProcessId(ProcessId).Flags) == STATUS_SUCCESS)
         {
             LogInfo("Hook applied from VMX Root Mode");
-            if (!g_GuestState[LogicalCoreIndex].IsOnVmxRootMode)
-            {
-                //
-                // Now we have to notify all the core to invalidate their EPT
-                //
-                HvNotifyAllToInvalidateEpt();
-            }
-            else
+            //
+            // If there is a transaction then the hook is staged, all of the
+            // cores are notified when the transaction is committed
+            //
+            if (!EptTransactionIsActive())
             {
-                LogError("Unable to notify all cores to invalidate their TLB caches as you called hook on vmx-root mode.");
+                if (!g_GuestState[LogicalCoreIndex].IsOnVmxRootMode)
+                {
+                    //
+                    // Now we have to notify all the core to invalidate their EPT
+                    //
+                    HvNotifyAllToInvalidateEpt();
+                }
+                else
+                {
+                    LogError("Unable to notify all cores to invalidate their TLB caches as you called hook on vmx-root mode.");
+                }
             }
 
             return TRUE;
@@ -1035,6 +1370,177 @@ EptHook2(PVOID TargetAddress, PVOID HookFunction, UINT32 ProcessId, BOOLEAN SetH
     return FALSE;
 }
 
+/**
+ * @brief Emulate an access to a monitored page (!monitor)
+ * @details The instruction is decoded from the guest memory, if it's a
+ * simple mov then the access is performed on the physical address of the
+ * page (which is not affected by the hook) and the rip is advanced,
+ * otherwise the caller should single-step the instruction with MTF, the
+ * aligned accesses are performed by a single load or store (as the
+ * processor does) and the data breakpoints of the guest are triggered
+ * 
+ * @param Regs Guest registers
+ * @param ViolationQualification The exit qualification of vm-exit
+ * @param PhysicalAddress The physical address that cause this vm-exit
+ * @return BOOLEAN Returns TRUE if the access is emulated
+ */
+BOOLEAN
+EptHookEmulateMonitorAccess(PGUEST_REGS Regs, VMX_EXIT_QUALIFICATION_EPT_VIOLATION ViolationQualification, SIZE_T PhysicalAddress)
+{
+    EMULATOR_INSTRUCTION Instruction;
+    UINT8                InstructionBytes[EMULATOR_MAXIMUM_INSTRUCTION_LENGTH];
+    UINT32               SizeOfInstructionBytes;
+    UINT64               GuestRip;
+    UINT64               GuestRflags;
+    UINT64               GuestCsAccessRights;
+    UINT64               GuestLinearAddress;
+    UINT64               GuestInterruptibility;
+    UINT64               AccessedAddress;
+    UINT64               Dr7;
+    UINT64               BreakpointAddresses[EMULATOR_DEBUG_REGISTERS];
+    UINT32               Breakpoints;
+    DEBUG_REGISTER_6     Dr6;
+    UINT64               Value = 0;
+
+    //
+    // The guest should be in 64-bit mode (cs.l) and it shouldn't expect a
+    // debug trap after the instruction (single-stepping the guest)
+    //
+    __vmx_vmread(GUEST_CS_AR_BYTES, &GuestCsAccessRights);
+    __vmx_vmread(GUEST_RFLAGS, &GuestRflags);
+
+    if (!(GuestCsAccessRights & (1 << 13)) || (GuestRflags & X86_FLAGS_TF))
+    {
+        return FALSE;
+    }
+
+    //
+    // Read the instruction, it might be at the end of a page that its next
+    // page is not present
+    //
+    __vmx_vmread(GUEST_RIP, &GuestRip);
+
+    SizeOfInstructionBytes = EMULATOR_MAXIMUM_INSTRUCTION_LENGTH;
+
+    if (!MemoryMapperReadMemorySafeOnTargetProcess(GuestRip, InstructionBytes, SizeOfInstructionBytes))
+    {
+        SizeOfInstructionBytes = PAGE_SIZE - PAGE_OFFSET(GuestRip);
+
+        if (SizeOfInstructionBytes >= EMULATOR_MAXIMUM_INSTRUCTION_LENGTH ||
+            !MemoryMapperReadMemorySafeOnTargetProcess(GuestRip, InstructionBytes, SizeOfInstructionBytes))
+        {
+            return FALSE;
+        }
+    }
+
+    if (!EmulatorDecodeInstruction(InstructionBytes, SizeOfInstructionBytes, &Instruction))
+    {
+        return FALSE;
+    }
+
+    //
+    // The stack pointer is not restored from the registers on vm-entry
+    //
+    if (!Instruction.IsWrite && Instruction.Register == EMULATOR_REGISTER_RSP && !Instruction.IsHighByteRegister)
+    {
+        return FALSE;
+    }
+
+    //
+    // Make sure that the decoded instruction is the instruction that caused
+    // the violation and the access is in the same page
+    //
+    if (Instruction.IsWrite != (BOOLEAN)ViolationQualification.WriteAccess)
+    {
+        return FALSE;
+    }
+
+    //
+    // The violation should be caused by the access of the instruction to
+    // the translation of its linear address, not by the page walk (or the
+    // accessed and dirty bits) of a page table on the monitored page
+    //
+    if (!ViolationQualification.ValidGuestLinearAddress || !ViolationQualification.CausedByTranslation)
+    {
+        return FALSE;
+    }
+
+    AccessedAddress = EmulatorGetMemoryAddress(&Instruction, Regs, GuestRip);
+
+    __vmx_vmread(GUEST_LINEAR_ADDRESS, &GuestLinearAddress);
+
+    if (GuestLinearAddress != AccessedAddress)
+    {
+        return FALSE;
+    }
+
+    if (PAGE_OFFSET(AccessedAddress) != PAGE_OFFSET(PhysicalAddress) ||
+        PAGE_OFFSET(AccessedAddress) + Instruction.AccessSize > PAGE_SIZE)
+    {
+        return FALSE;
+    }
+
+    //
+    // Perform the access
+    //
+    if (Instruction.IsWrite)
+    {
+        Value = EmulatorGetWriteValue(&Instruction, Regs);
+
+        if (!MemoryMapperWriteMemorySafeByPhysicalAddress(PhysicalAddress, &Value, Instruction.AccessSize))
+        {
+            return FALSE;
+        }
+    }
+    else
+    {
+        if (!MemoryMapperReadMemorySafeByPhysicalAddress(PhysicalAddress, &Value, Instruction.AccessSize))
+        {
+            return FALSE;
+        }
+
+        EmulatorSetReadValue(&Instruction, Regs, Value);
+    }
+
+    //
+    // Go to the next instruction, the instruction is executed so the blocking
+    // by sti or mov ss is finished
+    //
+    __vmx_vmwrite(GUEST_RIP, GuestRip + Instruction.Length);
+
+    __vmx_vmread(GUEST_INTERRUPTIBILITY_INFO, &GuestInterruptibility);
+
+    if (GuestInterruptibility & 0x3)
+    {
+        __vmx_vmwrite(GUEST_INTERRUPTIBILITY_INFO, GuestInterruptibility & ~0x3ull);
+    }
+
+    //
+    // The data breakpoints of the guest are not checked by the processor for
+    // the emulated access, so the debug trap is injected after the instruction
+    // (as the processor does for the breakpoints that are hit)
+    //
+    __vmx_vmread(GUEST_DR7, &Dr7);
+
+    BreakpointAddresses[0] = __readdr(0);
+    BreakpointAddresses[1] = __readdr(1);
+    BreakpointAddresses[2] = __readdr(2);
+    BreakpointAddresses[3] = __readdr(3);
+
+    Breakpoints = EmulatorGetDataBreakpoints(Dr7, BreakpointAddresses, AccessedAddress, Instruction.AccessSize, Instruction.IsWrite);
+
+    if (Breakpoints != 0)
+    {
+        Dr6.Flags               = __readdr(6);
+        Dr6.BreakpointCondition = Breakpoints;
+        __writedr(6, Dr6.Flags);
+
+        EventInjectDebugBreakpoint();
+    }
+
+    return TRUE;
+}
+
 /**
  * @brief Handles page hooks
  * 
@@ -1042,8 +1548,9 @@ EptHook2(PVOID TargetAddress, PVOID HookFunction, UINT32 ProcessId, BOOLEAN SetH
  * @param HookedEntryDetails The entry that describes the hooked page
  * @param ViolationQualification The exit qualification of vm-exit
  * @param PhysicalAddress The physical address that cause this vm-exit
- * @return BOOLEAN Returns TRUE if the function was hook was handled or returns false 
- * if there was an unexpected ept violation
+ * @return BOOLEAN Returns TRUE if the entry is restored and the instruction should be
+ * single-stepped with MTF or returns false if the access is emulated or there was an
+ * unexpected ept violation
  */
 BOOLEAN
 EptHookHandleHookedPage(PGUEST_REGS Regs, EPT_HOOKED_PAGE_DETAIL * HookedEntryDetails, VMX_EXIT_QUALIFICATION_EPT_VIOLATION ViolationQualification, SIZE_T PhysicalAddress)
@@ -1124,6 +1631,19 @@ EptHookHandleHookedPage(PGUEST_REGS Regs, EPT_HOOKED_PAGE_DETAIL * HookedEntryDe
         return FALSE;
     }
 
+#if EmulateMonitorMemoryAccesses
+
+    //
+    // Try to perform the access on behalf of the guest, so there is no need
+    // to restore the entry and single-step the instruction with MTF
+    //
+    if (EptHookEmulateMonitorAccess(Regs, ViolationQualification, PhysicalAddress))
+    {
+        return FALSE;
+    }
+
+#endif
+
     //
     // Restore to its orginal entry for one instruction
     //
@@ -1181,9 +1701,72 @@ EptHookRemoveEntryAndFreePoolFromEptHook2sDetourList(UINT64 Address)
     return FALSE;
 }
 
+/**
+ * @brief Release the detour details and the trampoline of a hook
+ * 
+ * @param HookedOffset The hook
+ * @return VOID 
+ */
+VOID
+EptHookReleaseHookedOffset(PEPT_HOOKED_OFFSET HookedOffset)
+{
+    if (HookedOffset->IsHiddenBreakpoint)
+    {
+        return;
+    }
+
+    //
+    // Now that we removed this hidden detours hook, it is
+    // time to remove it from g_EptHook2sDetourListHead
+    //
+    EptHookRemoveEntryAndFreePoolFromEptHook2sDetourList(HookedOffset->VirtualAddress);
+
+    //
+    // The trampoline is not reused until the next IOCTL, so the threads
+    // that are still on the trampoline can return to the original function
+    //
+    if (!PoolManagerFreePool(HookedOffset->Trampoline))
+    {
+        LogError("Something goes wrong ! the pool not found in the list of previously allocated pools by pool manager.");
+    }
+}
+
+/**
+ * @brief Check whether there is any hidden breakpoint on the hooked pages
+ * @details The pages that are being removed are counted, their 0xcc might
+ * still be hit until they're restored on all of the cores
+ * 
+ * @return BOOLEAN 
+ */
+BOOLEAN
+EptHookIsAnyHiddenBreakpoint()
+{
+    PLIST_ENTRY TempList = 0;
+
+    TempList = &g_EptState->HookedPagesList;
+
+    while (&g_EptState->HookedPagesList != TempList->Flink)
+    {
+        TempList                            = TempList->Flink;
+        PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
+
+        for (UINT32 i = 0; i < HookedEntry->CountOfHookedOffsets; i++)
+        {
+            if (HookedEntry->HookedOffsets[i].IsHiddenBreakpoint)
+            {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
 /**
  * @brief Remove single hook from the hooked pages list and invalidate TLB
- * @details Should be called from vmx non-root
+ * @details Should be called from vmx non-root, if the page has other hooks
+ * then only the bytes of this hook are restored on the fake page, otherwise
+ * the page is unhooked entirely
  * 
  * @param VirtualAddress Virtual address to unhook
  * @param ProcessId The process id of target process
@@ -1192,11 +1775,10 @@ EptHookRemoveEntryAndFreePoolFromEptHook2sDetourList(UINT64 Address)
 BOOLEAN
 EptHookUnHookSingleAddress(UINT64 VirtualAddress, UINT32 ProcessId)
 {
-    SIZE_T      PhysicalAddress;
-    UINT64      TargetAddressInFakePageContent;
-    UINT64      PageOffset;
-    PLIST_ENTRY TempList                   = 0;
-    BOOLEAN     FoundHiddenBreakpointEntry = FALSE;
+    SIZE_T                  PhysicalAddress;
+    PEPT_HOOKED_PAGE_DETAIL HookedEntry;
+    PEPT_HOOKED_OFFSET      HookedOffset;
+    BOOLEAN                 IsHiddenBreakpoint = FALSE;
 
     if (ProcessId == DEBUGGER_EVENT_APPLY_TO_ALL_PROCESSES || ProcessId == 0)
     {
@@ -1213,162 +1795,90 @@ EptHookUnHookSingleAddress(UINT64 VirtualAddress, UINT32 ProcessId)
         return FALSE;
     }
 
-    TempList = &g_EptState->HookedPagesList;
-    while (&g_EptState->HookedPagesList != TempList->Flink)
-    {
-        TempList                            = TempList->Flink;
-        PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
+    HookedEntry = EptHookFindHookedPage(PhysicalAddress);
 
+    if (HookedEntry == NULL || HookedEntry->IsBeingRemoved)
+    {
         //
-        // Check if it's a hidden breakpoint or hidden detours
+        // Nothing found , probably the list is not found
         //
-        if (HookedEntry->IsHiddenBreakpoint)
+        return FALSE;
+    }
+
+    //
+    // The pages that are hooked for read or write don't have any hooked
+    // offset and they're unhooked entirely
+    //
+    if (HookedEntry->CountOfHookedOffsets == 0)
+    {
+        EptTransactionRemoveHookedPage(HookedEntry);
+    }
+    else
+    {
+        HookedOffset = EptHookFindHookedOffset(HookedEntry, PAGE_OFFSET(VirtualAddress));
+
+        if (HookedOffset == NULL)
+        {
+            return FALSE;
+        }
+
+        IsHiddenBreakpoint = HookedOffset->IsHiddenBreakpoint;
+
+        if (HookedEntry->CountOfHookedOffsets != 1)
         {
             //
-            // It's a hidden breakpoint (we have to search through an array of addresses)
+            // There are other hooks on the page, so we just restore the original
+            // bytes of this hook on the fake page (0xcc or the detour jump), a
+            // core that already hit the 0xcc sees that the hook is being removed
+            // and executes the restored instruction again
             //
-            for (size_t i = 0; i < HookedEntry->CountOfBreakpoints; i++)
-            {
-                if (HookedEntry->BreakpointAddresses[i] == VirtualAddress)
-                {
-                    //
-                    // We found an address that matches this entry
-                    //
+            HookedOffset->IsBeingRemoved = TRUE;
 
-                    //
-                    // Check if it's a single breakpoint
-                    //
-                    if (HookedEntry->CountOfBreakpoints == 1)
-                    {
-                        //
-                        // Remove the hook entirely on all cores
-                        //
-                        KeGenericCallDpc(HvDpcBroadcastRemoveHookAndInvalidateSingleEntry, HookedEntry->PhysicalBaseAddress);
-
-                        //
-                        // remove the entry from the list
-                        //
-                        RemoveEntryList(HookedEntry->PageHookList.Flink);
-
-                        //
-                        // we add the hooked entry to the list
-                        // of pools that will be deallocated on next IOCTL
-                        //
-                        if (!PoolManagerFreePool(HookedEntry))
-                        {
-                            LogError("Something goes wrong ! the pool not found in the list of previously allocated pools by pool manager.");
-                        }
-
-                        //
-                        // Check if there is any other breakpoints, if no then we have to disalbe
-                        // exception bitmaps on vm-exits for breakpoint, for this purpose, we have
-                        // to visit all the entries to see if there is any entries
-                        //
-                        TempList = &g_EptState->HookedPagesList;
-                        while (&g_EptState->HookedPagesList != TempList->Flink)
-                        {
-                            TempList                            = TempList->Flink;
-                            PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
-
-                            if (HookedEntry->IsHiddenBreakpoint)
-                            {
-                                FoundHiddenBreakpointEntry = TRUE;
-                                break;
-                            }
-                        }
-
-                        if (!FoundHiddenBreakpointEntry)
-                        {
-                            //
-                            // Did not find any entry, let's disable the breakpoints vm-exits
-                            // on exception bitmaps
-                            //
-                            HvDisableBreakpointExitingOnExceptionBitmapAllCores();
-                        }
-                        return TRUE;
-                    }
-                    else
-                    {
-                        //
-                        // Set 0xcc to its previous value
-                        //
-                        TargetAddressInFakePageContent = &HookedEntry->FakePageContents;
-                        TargetAddressInFakePageContent = PAGE_ALIGN(TargetAddressInFakePageContent);
-                        PageOffset                     = PAGE_OFFSET(VirtualAddress);
-                        TargetAddressInFakePageContent = TargetAddressInFakePageContent + PageOffset;
-
-                        //
-                        // Set the previous value
-                        //
-                        *(BYTE *)TargetAddressInFakePageContent = HookedEntry->PreviousBytesOnBreakpointAddresses[i];
-
-                        //
-                        // Remove just that special entry
-                        // Btw, No need to remove it, it will be replace automatically
-                        //
-                        HookedEntry->BreakpointAddresses[i]                = NULL;
-                        HookedEntry->PreviousBytesOnBreakpointAddresses[i] = 0x0;
-
-                        //
-                        // all addresses to a lower array index (because one entry is
-                        // missing and might) be in the middle of the array
-                        //
-                        for (size_t j = i; j < MaximumHiddenBreakpointsOnPage - 1; j++)
-                        {
-                            HookedEntry->BreakpointAddresses[j]                = HookedEntry->BreakpointAddresses[j + 1];
-                            HookedEntry->PreviousBytesOnBreakpointAddresses[j] = HookedEntry->PreviousBytesOnBreakpointAddresses[j + 1];
-                        }
-
-                        //
-                        // Decrease the count of breakpoints
-                        //
-                        HookedEntry->CountOfBreakpoints = HookedEntry->CountOfBreakpoints - 1;
-
-                        return TRUE;
-                    }
-                }
+            if (IsHiddenBreakpoint)
+            {
+                HookedEntry->FakePageContents[HookedOffset->Offset] = HookedOffset->PreviousByte;
+            }
+            else
+            {
+                RtlCopyMemory(&HookedEntry->FakePageContents[HookedOffset->Offset], HookedOffset->Trampoline, HookedOffset->Length);
             }
+
+            //
+            // The vm-exit handlers of the other cores read the hooked offsets
+            // of the page, so the table is only shifted after all of the cores
+            // acknowledge the removal (like the removed pages)
+            //
+            KeGenericCallDpc(HvDpcBroadcastAcknowledgeRemovedHookedOffsets, NULL);
+
+            EptHookReleaseHookedOffset(HookedOffset);
+            EptHookRemoveHookedOffset(HookedEntry, HookedOffset);
         }
         else
         {
             //
-            // It's a hidden detours
+            // Remove the hook entirely on all cores, the hook is kept on the
+            // page, so a core that hits its 0xcc before the page is restored
+            // still finds it
             //
-            if (HookedEntry->PhysicalBaseAddress == PhysicalAddress)
-            {
-                //
-                // Remove it in all the cores
-                //
-                KeGenericCallDpc(HvDpcBroadcastRemoveHookAndInvalidateSingleEntry, HookedEntry->PhysicalBaseAddress);
-
-                //
-                // Now that we removed this hidden detours hook, it is
-                // time to remove it from g_EptHook2sDetourListHead
-                //
-                EptHookRemoveEntryAndFreePoolFromEptHook2sDetourList(HookedEntry->VirtualAddress);
-
-                //
-                // remove the entry from the list
-                //
-                RemoveEntryList(HookedEntry->PageHookList.Flink);
-
-                //
-                // we add the hooked entry to the list
-                // of pools that will be deallocated on next IOCTL
-                //
-                if (!PoolManagerFreePool(HookedEntry))
-                {
-                    LogError("Something goes wrong ! the pool not found in the list of previously allocated pools by pool manager.");
-                }
-
-                return TRUE;
-            }
+            EptHookReleaseHookedOffset(HookedOffset);
+            EptTransactionRemoveHookedPage(HookedEntry);
         }
     }
+
     //
-    // Nothing found , probably the list is not found
+    // Check if there is any other breakpoints, if no then we have to disalbe
+    // exception bitmaps on vm-exits for breakpoint
     //
-    return FALSE;
+    if (IsHiddenBreakpoint && !EptHookIsAnyHiddenBreakpoint())
+    {
+        //
+        // Did not find any entry, let's disable the breakpoints vm-exits
+        // on exception bitmaps
+        //
+        HvDisableBreakpointExitingOnExceptionBitmapAllCores();
+    }
+
+    return TRUE;
 }
 
 /**
@@ -1391,15 +1901,11 @@ EptHookUnHookAll()
     }
 
     //
-    // Remove it in all the cores
-    //
-    KeGenericCallDpc(HvDpcBroadcastRemoveHookAndInvalidateAllEntries, 0x0);
-
-    //
-    // In the case of unhooking all pages, we remove the hooked
-    // from EPT table in vmx-root and at last, we need to deallocate
-    // it from the buffers
+    // Remove them in all the cores, the entries are restored in a single
+    // transaction so the cores invalidate their EPT once, the pages are
+    // freed after all of the cores restore them
     //
+    EptTransactionBegin();
 
     TempList = &g_EptState->HookedPagesList;
 
@@ -1408,23 +1914,25 @@ EptHookUnHookAll()
         TempList                            = TempList->Flink;
         PEPT_HOOKED_PAGE_DETAIL HookedEntry = CONTAINING_RECORD(TempList, EPT_HOOKED_PAGE_DETAIL, PageHookList);
 
-        //
-        // Now that we removed this hidden detours hook, it is
-        // time to remove it from g_EptHook2sDetourListHead
-        // if the hook is detours
-        //
-        if (!HookedEntry->IsHiddenBreakpoint)
+        if (HookedEntry->IsBeingRemoved)
         {
-            EptHookRemoveEntryAndFreePoolFromEptHook2sDetourList(HookedEntry->VirtualAddress);
+            continue;
         }
 
         //
-        // As we are in vmx-root here, we add the hooked entry to the list
-        // of pools that will be deallocated on next IOCTL
+        // Release the details of the detours of the page
         //
-        if (!PoolManagerFreePool(HookedEntry))
+        for (UINT32 i = 0; i < HookedEntry->CountOfHookedOffsets; i++)
         {
-            LogError("Something goes wrong ! the pool not found in the list of previously allocated pools by pool manager.");
+            EptHookReleaseHookedOffset(&HookedEntry->HookedOffsets[i]);
         }
+
+        //
+        // The page stays in the list until it's freed (at the latest on
+        // commit), so the walk is not changed
+        //
+        EptTransactionRemoveHookedPage(HookedEntry);
     }
+
+    EptTransactionCommit();
 }
@@ -0,0 +1,353 @@
+/**
+ * @file EptSplitPool.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Pool of pre-allocated tables for splitting 2MB pages to 4KB pages
+ * @details Vmx-root can't allocate memory, so the tables (VMM_EPT_DYNAMIC_SPLIT)
+ * are allocated before they're needed; each core has its own free list and
+ * there is an overflow list that is shared between the cores. When a list
+ * is below its low watermark, a worker thread refills the lists up to their
+ * high watermarks, so the bursts of EPT hooks don't wait for the next IOCTL
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Allocate a new table and add it to the list of allocated tables
+ * @details Should be called from vmx non-root (PASSIVE_LEVEL), the tables are
+ * only allocated by the worker or the initialization so no lock is needed
+ *
+ * @return PSLIST_ENTRY The table as a free list entry or NULL if the allocation fails
+ */
+PSLIST_ENTRY
+EptSplitPoolAllocateTable()
+{
+    PVMM_EPT_DYNAMIC_SPLIT NewSplit;
+
+    NewSplit = ExAllocatePoolWithTag(NonPagedPool, sizeof(VMM_EPT_DYNAMIC_SPLIT), POOLTAG);
+
+    if (NewSplit == NULL)
+    {
+        return NULL;
+    }
+
+    RtlZeroMemory(NewSplit, sizeof(VMM_EPT_DYNAMIC_SPLIT));
+
+    InsertHeadList(&g_EptSplitPool.AllocatedTablesList, &NewSplit->DynamicSplitList);
+    InterlockedIncrement64(&g_EptSplitPool.Counters.AllocatedTables);
+
+    //
+    // The table is page aligned, so its first entries are used as the
+    // (16-byte aligned) free list entry while it's not used
+    //
+    return (PSLIST_ENTRY)&NewSplit->PML1[0];
+}
+
+/**
+ * @brief Fill the free lists of all cores and the overflow list up to
+ * their high watermarks
+ * @details Should be called from vmx non-root (PASSIVE_LEVEL)
+ *
+ * @return BOOLEAN Returns FALSE if there was an allocation failure
+ */
+BOOLEAN
+EptSplitPoolRefill()
+{
+    ULONG        ProcessorsCount = KeQueryActiveProcessorCount(0);
+    PSLIST_ENTRY Entry;
+
+    for (ULONG i = 0; i < ProcessorsCount; i++)
+    {
+        while (ExQueryDepthSList(&g_EptSplitPool.Cores[i].FreeList) < EPT_SPLIT_POOL_CORE_HIGH_WATERMARK)
+        {
+            //
+            // The tables of the overflow list are used before allocating new tables
+            //
+            Entry = InterlockedPopEntrySList(&g_EptSplitPool.Overflow);
+
+            if (Entry == NULL)
+            {
+                Entry = EptSplitPoolAllocateTable();
+            }
+
+            if (Entry == NULL)
+            {
+                return FALSE;
+            }
+
+            InterlockedPushEntrySList(&g_EptSplitPool.Cores[i].FreeList, Entry);
+        }
+    }
+
+    while (ExQueryDepthSList(&g_EptSplitPool.Overflow) < EPT_SPLIT_POOL_OVERFLOW_HIGH_WATERMARK)
+    {
+        Entry = EptSplitPoolAllocateTable();
+
+        if (Entry == NULL)
+        {
+            return FALSE;
+        }
+
+        InterlockedPushEntrySList(&g_EptSplitPool.Overflow, Entry);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief The worker thread that refills the lists
+ * @details The refill requests of vmx non-root wake up the worker immediately,
+ * the requests of vmx-root are checked periodically as the event can't be
+ * signaled from vmx-root
+ *
+ * @param Context Unused
+ * @return VOID
+ */
+VOID
+EptSplitPoolWorker(PVOID Context)
+{
+    LARGE_INTEGER Interval;
+    LONG64        ExhaustionEvents;
+
+    UNREFERENCED_PARAMETER(Context);
+
+    Interval.QuadPart = -EPT_SPLIT_POOL_WORKER_INTERVAL;
+
+    while (!g_EptSplitPool.IsWorkerStopped)
+    {
+        KeWaitForSingleObject(&g_EptSplitPool.RefillEvent, Executive, KernelMode, FALSE, &Interval);
+
+        if (g_EptSplitPool.IsWorkerStopped)
+        {
+            break;
+        }
+
+        if (!InterlockedExchange(&g_EptSplitPool.IsRefillRequested, FALSE))
+        {
+            continue;
+        }
+
+        if (!EptSplitPoolRefill())
+        {
+            LogError("Insufficient memory for refilling the pool of split tables");
+        }
+
+        //
+        // Report the requests that failed because of an empty pool
+        //
+        ExhaustionEvents = g_EptSplitPool.Counters.ExhaustionEvents;
+
+        if (ExhaustionEvents != g_EptSplitPool.ReportedExhaustions)
+        {
+            LogWarning("The pool of split tables was exhausted %lld time(s), allocated tables: %lld",
+                       ExhaustionEvents - g_EptSplitPool.ReportedExhaustions,
+                       g_EptSplitPool.Counters.AllocatedTables);
+
+            g_EptSplitPool.ReportedExhaustions = ExhaustionEvents;
+        }
+    }
+
+    PsTerminateSystemThread(STATUS_SUCCESS);
+}
+
+/**
+ * @brief Initialize the split pool, fill the lists and start the worker
+ * @details Should be called from vmx non-root (PASSIVE_LEVEL)
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+EptSplitPoolInitialize()
+{
+    ULONG    ProcessorsCount = KeQueryActiveProcessorCount(0);
+    HANDLE   ThreadHandle;
+    NTSTATUS Status;
+
+    RtlZeroMemory(&g_EptSplitPool, sizeof(EPT_SPLIT_POOL));
+
+    g_EptSplitPool.Cores = ExAllocatePoolWithTag(NonPagedPool, sizeof(EPT_SPLIT_POOL_CORE) * ProcessorsCount, POOLTAG);
+
+    if (g_EptSplitPool.Cores == NULL)
+    {
+        LogError("Insufficient memory");
+        return FALSE;
+    }
+
+    for (ULONG i = 0; i < ProcessorsCount; i++)
+    {
+        InitializeSListHead(&g_EptSplitPool.Cores[i].FreeList);
+    }
+
+    InitializeSListHead(&g_EptSplitPool.Overflow);
+    InitializeListHead(&g_EptSplitPool.AllocatedTablesList);
+    KeInitializeEvent(&g_EptSplitPool.RefillEvent, SynchronizationEvent, FALSE);
+
+    if (!EptSplitPoolRefill())
+    {
+        LogError("Insufficient memory");
+        EptSplitPoolUninitialize();
+        return FALSE;
+    }
+
+    Status = PsCreateSystemThread(&ThreadHandle, THREAD_ALL_ACCESS, NULL, NULL, NULL, EptSplitPoolWorker, NULL);
+
+    if (!NT_SUCCESS(Status))
+    {
+        LogError("Unable to create the worker of the pool of split tables");
+        EptSplitPoolUninitialize();
+        return FALSE;
+    }
+
+    //
+    // Keep the object of the thread to wait for it on uninitialization
+    //
+    ObReferenceObjectByHandle(ThreadHandle, THREAD_ALL_ACCESS, NULL, KernelMode, &g_EptSplitPool.WorkerThread, NULL);
+    ZwClose(ThreadHandle);
+
+    return TRUE;
+}
+
+/**
+ * @brief Stop the worker and free all of the tables
+ * @details Should be called from vmx non-root (PASSIVE_LEVEL) after
+ * terminating vmx, as the tables that are used in the EPT tables are
+ * also freed
+ *
+ * @return VOID
+ */
+VOID
+EptSplitPoolUninitialize()
+{
+    PVMM_EPT_DYNAMIC_SPLIT Split;
+
+    if (g_EptSplitPool.WorkerThread != NULL)
+    {
+        g_EptSplitPool.IsWorkerStopped = TRUE;
+        KeSetEvent(&g_EptSplitPool.RefillEvent, IO_NO_INCREMENT, FALSE);
+
+        KeWaitForSingleObject(g_EptSplitPool.WorkerThread, Executive, KernelMode, FALSE, NULL);
+        ObDereferenceObject(g_EptSplitPool.WorkerThread);
+
+        g_EptSplitPool.WorkerThread = NULL;
+    }
+
+    LogDebugInfo("Split pool counters, allocated: %lld, from core: %lld, from overflow: %lld, exhaustions: %lld, refill requests: %lld",
+                 g_EptSplitPool.Counters.AllocatedTables,
+                 g_EptSplitPool.Counters.AcquiredFromCore,
+                 g_EptSplitPool.Counters.AcquiredFromOverflow,
+                 g_EptSplitPool.Counters.ExhaustionEvents,
+                 g_EptSplitPool.Counters.RefillRequests);
+
+    while (!IsListEmpty(&g_EptSplitPool.AllocatedTablesList))
+    {
+        Split = CONTAINING_RECORD(RemoveHeadList(&g_EptSplitPool.AllocatedTablesList), VMM_EPT_DYNAMIC_SPLIT, DynamicSplitList);
+        ExFreePoolWithTag(Split, POOLTAG);
+    }
+
+    if (g_EptSplitPool.Cores != NULL)
+    {
+        ExFreePoolWithTag(g_EptSplitPool.Cores, POOLTAG);
+        g_EptSplitPool.Cores = NULL;
+    }
+}
+
+/**
+ * @brief Request the worker to refill the lists
+ * @details Can be called from both vmx-root and vmx non-root
+ *
+ * @return VOID
+ */
+VOID
+EptSplitPoolRequestRefill()
+{
+    if (InterlockedExchange(&g_EptSplitPool.IsRefillRequested, TRUE))
+    {
+        //
+        // Already requested
+        //
+        return;
+    }
+
+    InterlockedIncrement64(&g_EptSplitPool.Counters.RefillRequests);
+
+    //
+    // The event can't be signaled from vmx-root, in that case the worker
+    // sees the request in its next interval
+    //
+    if (!g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode && KeGetCurrentIrql() <= DISPATCH_LEVEL)
+    {
+        KeSetEvent(&g_EptSplitPool.RefillEvent, IO_NO_INCREMENT, FALSE);
+    }
+}
+
+/**
+ * @brief Take a free table for splitting a 2MB page
+ * @details Can be called from both vmx-root and vmx non-root, the table
+ * should be passed to EptSplitLargePage
+ *
+ * @return PVOID The table or NULL if there is no free table
+ */
+PVOID
+EptSplitPoolAcquire()
+{
+    PEPT_SPLIT_POOL_CORE Core = &g_EptSplitPool.Cores[KeGetCurrentProcessorNumber()];
+    PSLIST_ENTRY         Entry;
+
+    Entry = InterlockedPopEntrySList(&Core->FreeList);
+
+    if (Entry != NULL)
+    {
+        InterlockedIncrement64(&g_EptSplitPool.Counters.AcquiredFromCore);
+    }
+    else
+    {
+        Entry = InterlockedPopEntrySList(&g_EptSplitPool.Overflow);
+
+        if (Entry != NULL)
+        {
+            InterlockedIncrement64(&g_EptSplitPool.Counters.AcquiredFromOverflow);
+        }
+        else
+        {
+            InterlockedIncrement64(&g_EptSplitPool.Counters.ExhaustionEvents);
+        }
+    }
+
+    if (ExQueryDepthSList(&Core->FreeList) < EPT_SPLIT_POOL_CORE_LOW_WATERMARK ||
+        ExQueryDepthSList(&g_EptSplitPool.Overflow) < EPT_SPLIT_POOL_OVERFLOW_LOW_WATERMARK)
+    {
+        EptSplitPoolRequestRefill();
+    }
+
+    //
+    // The free list entry is at the start of the table
+    //
+    return Entry;
+}
+
+/**
+ * @brief Return a table that is not used to the pool
+ * @details Can be called from both vmx-root and vmx non-root
+ *
+ * @param Table The table that is taken by EptSplitPoolAcquire
+ * @return VOID
+ */
+VOID
+EptSplitPoolRelease(PVOID Table)
+{
+    PEPT_SPLIT_POOL_CORE Core  = &g_EptSplitPool.Cores[KeGetCurrentProcessorNumber()];
+    PSLIST_ENTRY         Entry = (PSLIST_ENTRY)Table;
+
+    if (ExQueryDepthSList(&Core->FreeList) < EPT_SPLIT_POOL_CORE_HIGH_WATERMARK)
+    {
+        InterlockedPushEntrySList(&Core->FreeList, Entry);
+    }
+    else
+    {
+        InterlockedPushEntrySList(&g_EptSplitPool.Overflow, Entry);
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file EptSplitPool.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the pool of pre-allocated tables for splitting 2MB pages
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief If the free tables of a core are below the low watermark, the
+ * worker is requested to refill them up to the high watermark
+ *
+ */
+#define EPT_SPLIT_POOL_CORE_LOW_WATERMARK  2
+#define EPT_SPLIT_POOL_CORE_HIGH_WATERMARK 8
+
+/**
+ * @brief Watermarks of the global overflow list, the tables are taken from
+ * this list when the list of the current core is empty
+ *
+ */
+#define EPT_SPLIT_POOL_OVERFLOW_LOW_WATERMARK  8
+#define EPT_SPLIT_POOL_OVERFLOW_HIGH_WATERMARK 32
+
+/**
+ * @brief Interval of checking the refill requests of vmx-root by the
+ * worker (in 100-nanosecond units, 100 milliseconds)
+ *
+ */
+#define EPT_SPLIT_POOL_WORKER_INTERVAL 1000000
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Free tables of a core
+ *
+ */
+typedef struct _EPT_SPLIT_POOL_CORE
+{
+    SLIST_HEADER FreeList;
+
+} EPT_SPLIT_POOL_CORE, *PEPT_SPLIT_POOL_CORE;
+
+/**
+ * @brief Counters of the split pool
+ *
+ */
+typedef struct _EPT_SPLIT_POOL_COUNTERS
+{
+    volatile LONG64 AllocatedTables;      // Count of the tables that are allocated
+    volatile LONG64 AcquiredFromCore;     // Count of the tables that are taken from the list of a core
+    volatile LONG64 AcquiredFromOverflow; // Count of the tables that are taken from the overflow list
+    volatile LONG64 ExhaustionEvents;     // Count of the requests that there was no free table for them
+    volatile LONG64 RefillRequests;       // Count of the times that the worker is requested to refill the lists
+
+} EPT_SPLIT_POOL_COUNTERS, *PEPT_SPLIT_POOL_COUNTERS;
+
+/**
+ * @brief State of the split pool
+ * @details The free lists are lock-free (interlocked singly linked lists), so
+ * the tables can be taken and returned in both vmx-root and vmx non-root; the
+ * allocations are only performed by the worker thread in vmx non-root
+ *
+ */
+typedef struct _EPT_SPLIT_POOL
+{
+    PEPT_SPLIT_POOL_CORE    Cores;                // Free tables of each core
+    SLIST_HEADER            Overflow;             // Free tables that are shared between the cores
+    LIST_ENTRY              AllocatedTablesList;  // All of the allocated tables (VMM_EPT_DYNAMIC_SPLIT)
+    volatile LONG           IsRefillRequested;    // Shows whether the worker should refill the lists or not
+    BOOLEAN                 IsWorkerStopped;      // Shows whether the worker should exit or not
+    KEVENT                  RefillEvent;          // Signaled to wake up the worker from vmx non-root
+    PVOID                   WorkerThread;         // The object of the worker thread
+    LONG64                  ReportedExhaustions;  // Count of the exhaustion events that are already reported
+    EPT_SPLIT_POOL_COUNTERS Counters;             // Counters of the pool
+
+} EPT_SPLIT_POOL, *PEPT_SPLIT_POOL;
+
+//////////////////////////////////////////////////
+//                   Variables	    			//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The state of the split pool
+ *
+ */
+EPT_SPLIT_POOL g_EptSplitPool;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+EptSplitPoolInitialize();
+
+VOID
+EptSplitPoolUninitialize();
+
+PVOID
+EptSplitPoolAcquire();
+
+VOID
+EptSplitPoolRelease(PVOID Table);
+
+VOID
+EptSplitPoolRequestRefill();
+
+BOOLEAN
+EptSplitPoolRefill();
+
+VOID
+EptSplitPoolWorker(PVOID Context);
@@ -0,0 +1,262 @@
+/**
+ * @file EptTransaction.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Transactions of EPT changes
+ * @details Changing a PML1 entry needs an invalidation of EPT on all of the
+ * cores, when many hooks are applied or removed at once (e.g. hooking a range
+ * of pages) the changes are staged in a transaction and all of the cores are
+ * notified to invalidate their EPT once when the transaction is committed
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Begin a transaction (or a nested transaction)
+ * @details Should be called from vmx non-root, each call should be
+ * paired with EptTransactionCommit before returning from the IOCTL, if
+ * another thread has a transaction then we wait until it's committed
+ *
+ * @return VOID
+ */
+VOID
+EptTransactionBegin()
+{
+    PVOID CurrentThread = PsGetCurrentThread();
+
+    if (g_EptTransaction.Owner == CurrentThread)
+    {
+        g_EptTransaction.Depth++;
+        return;
+    }
+
+    while (InterlockedCompareExchangePointer(&g_EptTransaction.Owner, CurrentThread, NULL) != NULL)
+    {
+        _mm_pause();
+    }
+
+    g_EptTransaction.Depth = 1;
+}
+
+/**
+ * @brief Check whether the EPT changes should be staged or not
+ * @details Can be called from both vmx-root and vmx non-root, the changes
+ * are only staged for the thread that owns the transaction, the hooks of
+ * the other threads (or cores) are applied and invalidated immediately
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+EptTransactionIsActive()
+{
+    return g_EptTransaction.Owner == PsGetCurrentThread();
+}
+
+/**
+ * @brief Write the staged changes to the EPT tables without invalidation
+ * @details Should be called by the owner of the transaction
+ *
+ * @return VOID
+ */
+VOID
+EptTransactionApplyStagedChanges()
+{
+    if (g_EptTransaction.CountOfChanges == 0)
+    {
+        return;
+    }
+
+    SpinlockLock(&Pml1ModificationAndInvalidationLock);
+
+    for (UINT32 i = 0; i < g_EptTransaction.CountOfChanges; i++)
+    {
+        g_EptTransaction.Changes[i].EntryAddress->Flags = g_EptTransaction.Changes[i].EntryValue.Flags;
+    }
+
+    SpinlockUnlock(&Pml1ModificationAndInvalidationLock);
+
+    g_EptTransaction.CountOfCommittedChanges += g_EptTransaction.CountOfChanges;
+
+    g_EptTransaction.CountOfChanges       = 0;
+    g_EptTransaction.IsInvalidationNeeded = TRUE;
+}
+
+/**
+ * @brief Stage a change of a PML1 entry in the current transaction
+ * @details Can be called from both vmx-root and vmx non-root by the owner
+ * of the transaction, if the entry is already staged then the new value
+ * replaces the previous value
+ *
+ * @param EntryAddress The target entry
+ * @param EntryValue The value that should be written to the entry
+ * @return VOID
+ */
+VOID
+EptTransactionStageChange(PEPT_PML1_ENTRY EntryAddress, EPT_PML1_ENTRY EntryValue)
+{
+    for (UINT32 i = 0; i < g_EptTransaction.CountOfChanges; i++)
+    {
+        if (g_EptTransaction.Changes[i].EntryAddress == EntryAddress)
+        {
+            g_EptTransaction.Changes[i].EntryValue = EntryValue;
+            return;
+        }
+    }
+
+    //
+    // There is no room, the staged changes are written to the tables and
+    // they're invalidated with the rest of the changes on commit
+    //
+    if (g_EptTransaction.CountOfChanges == EPT_TRANSACTION_MAXIMUM_CHANGES)
+    {
+        EptTransactionApplyStagedChanges();
+    }
+
+    g_EptTransaction.Changes[g_EptTransaction.CountOfChanges].EntryAddress = EntryAddress;
+    g_EptTransaction.Changes[g_EptTransaction.CountOfChanges].EntryValue   = EntryValue;
+    g_EptTransaction.CountOfChanges++;
+}
+
+/**
+ * @brief Commit the current transaction
+ * @details Should be called from vmx non-root, if it's the outermost
+ * transaction then the staged changes are applied, the removed hooked pages
+ * are restored and freed and all of the cores are notified to invalidate
+ * their EPT (once for all of the changes)
+ *
+ * @return VOID
+ */
+VOID
+EptTransactionCommit()
+{
+    if (--g_EptTransaction.Depth != 0)
+    {
+        return;
+    }
+
+    if (g_EptTransaction.CountOfRemovedPages != 0)
+    {
+        //
+        // The cores invalidate their EPT when they restore the removed pages
+        //
+        EptTransactionFlushRemovedPages();
+    }
+    else
+    {
+        EptTransactionApplyStagedChanges();
+
+        if (g_EptTransaction.IsInvalidationNeeded)
+        {
+            g_EptTransaction.IsInvalidationNeeded = FALSE;
+            g_EptTransaction.CountOfInvalidations++;
+
+            if (!g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode)
+            {
+                //
+                // Now we have to notify all the core to invalidate their EPT
+                //
+                HvNotifyAllToInvalidateEpt();
+            }
+            else
+            {
+                InveptSingleContext(g_EptState->EptPointer.Flags);
+
+                LogError("Unable to notify all cores to invalidate their TLB caches as you committed the transaction on vmx-root mode.");
+            }
+        }
+    }
+
+    //
+    // Let the other threads begin their transactions
+    //
+    InterlockedExchangePointer(&g_EptTransaction.Owner, NULL);
+}
+
+/**
+ * @brief Change a PML1 entry of a hook, the change is staged if there is
+ * a transaction, otherwise it's applied and invalidated immediately
+ * @details Should be called from vmx-root
+ *
+ * @param EntryAddress The target entry
+ * @param EntryValue The value that should be written to the entry
+ * @return VOID
+ */
+VOID
+EptTransactionSetPml1Entry(PEPT_PML1_ENTRY EntryAddress, EPT_PML1_ENTRY EntryValue)
+{
+    if (EptTransactionIsActive())
+    {
+        EptTransactionStageChange(EntryAddress, EntryValue);
+    }
+    else
+    {
+        EptSetPML1AndInvalidateTLB(EntryAddress, EntryValue, INVEPT_SINGLE_CONTEXT);
+    }
+}
+
+/**
+ * @brief Remove a hooked page in the current transaction
+ * @details Should be called from vmx non-root, the page is kept in the list
+ * of the hooked pages (as being removed) until all of the cores restore its
+ * original entry in vmx-root, so a core that is on the page (e.g., waiting
+ * for its MTF to restore the hook) never touches a freed page
+ *
+ * @param HookedEntry The hooked page
+ * @return VOID
+ */
+VOID
+EptTransactionRemoveHookedPage(PEPT_HOOKED_PAGE_DETAIL HookedEntry)
+{
+    HookedEntry->IsBeingRemoved = TRUE;
+
+    EptTransactionBegin();
+
+    if (g_EptTransaction.CountOfRemovedPages == EPT_TRANSACTION_MAXIMUM_REMOVALS)
+    {
+        EptTransactionFlushRemovedPages();
+    }
+
+    g_EptTransaction.RemovedPages[g_EptTransaction.CountOfRemovedPages++] = HookedEntry;
+
+    EptTransactionCommit();
+}
+
+/**
+ * @brief Restore the removed hooked pages on all of the cores and free them
+ * @details Should be called from vmx non-root by the owner of the transaction,
+ * the staged changes are applied first, then each core restores the original
+ * entries of the removed pages and invalidates its EPT in vmx-root, after that
+ * none of the cores is on the removed pages and they're freed
+ *
+ * @return VOID
+ */
+VOID
+EptTransactionFlushRemovedPages()
+{
+    if (g_EptTransaction.CountOfRemovedPages == 0)
+    {
+        return;
+    }
+
+    EptTransactionApplyStagedChanges();
+
+    //
+    // Each core restores the entries and invalidates its EPT, so the applied
+    // changes are invalidated too
+    //
+    KeGenericCallDpc(HvDpcBroadcastRemoveHookAndInvalidateRemovedEntries, &g_EptTransaction);
+
+    g_EptTransaction.IsInvalidationNeeded = FALSE;
+    g_EptTransaction.CountOfInvalidations++;
+
+    for (UINT32 i = 0; i < g_EptTransaction.CountOfRemovedPages; i++)
+    {
+        EptHookFreeHookedPage(g_EptTransaction.RemovedPages[i]);
+    }
+
+    g_EptTransaction.CountOfRemovedPages = 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file EptTransaction.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the transactions of EPT changes
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum count of the staged changes, if there are more changes
+ * then the staged changes are applied (without invalidation) to make room
+ *
+ */
+#define EPT_TRANSACTION_MAXIMUM_CHANGES 128
+
+/**
+ * @brief Maximum count of the hooked pages that are removed in a transaction,
+ * if there are more pages then the removed pages are restored on all of the
+ * cores and freed to make room
+ *
+ */
+#define EPT_TRANSACTION_MAXIMUM_REMOVALS 64
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A staged change of a PML1 entry
+ *
+ */
+typedef struct _EPT_TRANSACTION_CHANGE
+{
+    PEPT_PML1_ENTRY EntryAddress; // The target entry
+    EPT_PML1_ENTRY  EntryValue;   // The value that should be written to the entry
+
+} EPT_TRANSACTION_CHANGE, *PEPT_TRANSACTION_CHANGE;
+
+/**
+ * @brief State of the current transaction
+ * @details The transactions are nested, the changes are applied and all of
+ * the cores are notified to invalidate their EPT once the outermost
+ * transaction is committed, a transaction belongs to the thread that began
+ * it and the other threads wait for it to be committed
+ *
+ */
+typedef struct _EPT_TRANSACTION
+{
+    volatile PVOID          Owner;                                         // The thread of the transaction
+    LONG                    Depth;                                         // Count of the nested transactions of the owner
+    UINT32                  CountOfChanges;                                // Count of the staged changes
+    BOOLEAN                 IsInvalidationNeeded;                          // Some changes are applied but not invalidated yet
+    UINT64                  CountOfCommittedChanges;                       // Count of the changes of the committed transactions
+    UINT64                  CountOfInvalidations;                          // Count of the invalidations of the committed transactions
+    EPT_TRANSACTION_CHANGE  Changes[EPT_TRANSACTION_MAXIMUM_CHANGES];      // The staged changes
+    UINT32                  CountOfRemovedPages;                           // Count of the removed hooked pages
+    PEPT_HOOKED_PAGE_DETAIL RemovedPages[EPT_TRANSACTION_MAXIMUM_REMOVALS]; // The hooked pages that are freed after they're restored on all of the cores
+
+} EPT_TRANSACTION, *PEPT_TRANSACTION;
+
+//////////////////////////////////////////////////
+//                   Variables	    			//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The current transaction of EPT changes
+ *
+ */
+EPT_TRANSACTION g_EptTransaction;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+VOID
+EptTransactionBegin();
+
+BOOLEAN
+EptTransactionIsActive();
+
+VOID
+EptTransactionStageChange(PEPT_PML1_ENTRY EntryAddress, EPT_PML1_ENTRY EntryValue);
+
+VOID
+EptTransactionCommit();
+
+VOID
+EptTransactionApplyStagedChanges();
+
+VOID
+EptTransactionSetPml1Entry(PEPT_PML1_ENTRY EntryAddress, EPT_PML1_ENTRY EntryValue);
+
+VOID
+EptTransactionRemoveHookedPage(PEPT_HOOKED_PAGE_DETAIL HookedEntry);
+
+VOID
+EptTransactionFlushRemovedPages();
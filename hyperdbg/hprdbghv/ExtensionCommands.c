@@ -186,9 +186,9 @@ VOID
 ExtensionCommandChangeAllMsrBitmapReadAllCores(UINT64 BitmapMask)
 {
     //
-    // Broadcast to all cores
+    // Change the shared bitmaps and queue the update for the cores with private bitmaps
     //
-    KeGenericCallDpc(BroadcastDpcChangeMsrBitmapReadOnAllCores, BitmapMask);
+    SharedBitmapsRequestChange(PENDING_CONTROLS_ALL_CORES, VMCALL_CHANGE_MSR_BITMAP_READ, BitmapMask);
 }
 
 /**
@@ -199,9 +199,9 @@ VOID
 ExtensionCommandResetChangeAllMsrBitmapReadAllCores()
 {
     //
-    // Broadcast to all cores
+    // Change the shared bitmaps and queue the update for the cores with private bitmaps
     //
-    KeGenericCallDpc(BroadcastDpcResetMsrBitmapReadOnAllCores, NULL);
+    SharedBitmapsRequestChange(PENDING_CONTROLS_ALL_CORES, VMCALL_RESET_MSR_BITMAP_READ, 0);
 }
 
 /**
@@ -213,9 +213,9 @@ VOID
 ExtensionCommandChangeAllMsrBitmapWriteAllCores(UINT64 BitmapMask)
 {
     //
-    // Broadcast to all cores
+    // Change the shared bitmaps and queue the update for the cores with private bitmaps
     //
-    KeGenericCallDpc(BroadcastDpcChangeMsrBitmapWriteOnAllCores, BitmapMask);
+    SharedBitmapsRequestChange(PENDING_CONTROLS_ALL_CORES, VMCALL_CHANGE_MSR_BITMAP_WRITE, BitmapMask);
 }
 
 /**
@@ -226,9 +226,9 @@ VOID
 ExtensionCommandResetAllMsrBitmapWriteAllCores()
 {
     //
-    // Broadcast to all cores
+    // Change the shared bitmaps and queue the update for the cores with private bitmaps
     //
-    KeGenericCallDpc(BroadcastDpcResetMsrBitmapWriteOnAllCores, NULL);
+    SharedBitmapsRequestChange(PENDING_CONTROLS_ALL_CORES, VMCALL_RESET_MSR_BITMAP_WRITE, 0);
 }
 
 /**
@@ -240,9 +240,9 @@ VOID
 ExtensionCommandEnableRdtscExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcEnableRdtscExitingAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_SET_RDTSC_EXITING, 0);
 }
 
 /**
@@ -253,9 +253,9 @@ VOID
 ExtensionCommandDisableRdtscExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcDisableRdtscExitingAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_UNSET_RDTSC_EXITING, 0);
 }
 
 /**
@@ -267,9 +267,9 @@ VOID
 ExtensionCommandEnableRdpmcExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcEnableRdpmcExitingAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_SET_RDPMC_EXITING, 0);
 }
 
 /**
@@ -280,9 +280,9 @@ VOID
 ExtensionCommandDisableRdpmcExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcDisableRdpmcExitingAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_UNSET_RDPMC_EXITING, 0);
 }
 
 /**
@@ -295,9 +295,9 @@ VOID
 ExtensionCommandSetExceptionBitmapAllCores(UINT64 ExceptionIndex)
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcSetExceptionBitmapOnAllCores, ExceptionIndex);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_SET_EXCEPTION_BITMAP, ExceptionIndex);
 }
 
 /**
@@ -308,9 +308,9 @@ VOID
 ExtensionCommandResetExceptionBitmapAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcResetExceptionBitmapOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_RESET_EXCEPTION_BITMAP, 0);
 }
 
 /**
@@ -322,9 +322,9 @@ VOID
 ExtensionCommandEnableMovDebugRegistersExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcEnableMovDebigRegisterExitingAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_ENABLE_MOV_TO_DEBUG_REGS_EXITING, 0);
 }
 
 /**
@@ -335,9 +335,9 @@ VOID
 ExtensionCommandDisableMovDebugRegistersExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcDisableMovDebigRegisterExitingAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_DISABLE_MOV_TO_DEBUG_REGS_EXITING, 0);
 }
 
 /**
@@ -349,9 +349,9 @@ VOID
 ExtensionCommandSetExternalInterruptExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcSetEnableExternalInterruptExitingOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_ENABLE_EXTERNAL_INTERRUPT_EXITING, 0);
 }
 
 /**
@@ -362,9 +362,9 @@ VOID
 ExtensionCommandUnsetExternalInterruptExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcSetDisableExternalInterruptExitingOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_DISABLE_EXTERNAL_INTERRUPT_EXITING, 0);
 }
 
 /**
@@ -376,9 +376,9 @@ VOID
 ExtensionCommandIoBitmapChangeAllCores(UINT64 Port)
 {
     //
-    // Broadcast to all cores
+    // Change the shared bitmaps and queue the update for the cores with private bitmaps
     //
-    KeGenericCallDpc(BroadcastDpcChangeIoBitmapOnAllCores, Port);
+    SharedBitmapsRequestChange(PENDING_CONTROLS_ALL_CORES, VMCALL_CHANGE_IO_BITMAP, Port);
 }
 
 /**
@@ -389,7 +389,7 @@ VOID
 ExtensionCommandIoBitmapResetAllCores()
 {
     //
-    // Broadcast to all cores
+    // Change the shared bitmaps and queue the update for the cores with private bitmaps
     //
-    KeGenericCallDpc(BroadcastDpcResetIoBitmapOnAllCores, NULL);
+    SharedBitmapsRequestChange(PENDING_CONTROLS_ALL_CORES, VMCALL_RESET_IO_BITMAP, 0);
 }
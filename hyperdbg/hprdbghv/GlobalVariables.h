@@ -42,6 +42,21 @@ DEBUGGER_CORE_EVENTS * g_Events;
  */
 UINT64 * g_ScriptGlobalVariables;
 
+/**
+ * @brief Buffer of the multi-pattern search automaton and its page
+ * buffer, used when the search is requested from vmx-root mode
+ * 
+ */
+PVOID g_MultiPatternSearchBuffer;
+
+/**
+ * @brief Physical memory ranges (RAM) that are captured at the
+ * initialization of the debugger, used to check the physical
+ * addresses in vmx-root mode
+ * 
+ */
+PPHYSICAL_MEMORY_RANGE g_PhysicalMemoryRanges;
+
 /**
  * @brief Save the state of the thread that waits for messages to deliver to user-mode
  * 
@@ -92,6 +107,13 @@ LIST_ENTRY g_BreakpointsListHead;
  */
 UINT64 g_MaximumBreakpointId;
 
+/**
+ * @brief Index of breakpoints (by address and physical address)
+ * for debugger-mode
+ *
+ */
+PBREAKPOINT_INDEX g_BreakpointsIndex;
+
 /**
  * @brief Shows whether the debugger transparent mode 
  * is enabled (true) or not (false)
@@ -105,6 +127,14 @@ BOOLEAN g_TransparentMode;
  */
 TRANSPARENCY_MEASUREMENTS * g_TransparentModeMeasurements;
 
+/**
+ * @brief version of the transparency list, it's increased each time
+ * that the list is changed so the cached decisions of the cores
+ * become invalid
+ * 
+ */
+volatile LONG g_TransparentModeProcessListVersion;
+
 /**
  * @brief details relating to nop-sled page
  * 
@@ -178,6 +178,17 @@ EptHook(PVOID TargetAddress, UINT32 ProcessId);
 BOOLEAN
 EptHook2(PVOID TargetAddress, PVOID HookFunction, UINT32 ProcessId, BOOLEAN SetHookForRead, BOOLEAN SetHookForWrite, BOOLEAN SetHookForExec);
 
+/**
+ * @brief Emulate an access to a monitored page in Vmx-root mode
+ * 
+ * @param Regs 
+ * @param ViolationQualification 
+ * @param PhysicalAddress 
+ * @return BOOLEAN 
+ */
+BOOLEAN
+EptHookEmulateMonitorAccess(PGUEST_REGS Regs, VMX_EXIT_QUALIFICATION_EPT_VIOLATION ViolationQualification, SIZE_T PhysicalAddress);
+
 /**
  * @brief Handle hooked pages in Vmx-root mode
  * 
@@ -207,6 +218,24 @@ EptHookRestoreSingleHookToOrginalEntry(SIZE_T PhysicalAddress);
 VOID
 EptHookRestoreAllHooksToOrginalEntry();
 
+/**
+ * @brief Remove the hooks of the pages that are removed in a transaction (Should be called in vmx-root)
+ * 
+ * @param Transaction 
+ * @return VOID
+ */
+VOID
+EptHookRestoreRemovedHooksToOrginalEntry(PEPT_TRANSACTION Transaction);
+
+/**
+ * @brief Remove a hooked page from the hooked pages list and free it
+ * 
+ * @param HookedEntry 
+ * @return VOID
+ */
+VOID
+EptHookFreeHookedPage(PEPT_HOOKED_PAGE_DETAIL HookedEntry);
+
 /**
  * @brief Remove all hooks from the hooked pages lists
  * 
@@ -233,3 +262,80 @@ EptHookUnHookSingleAddress(UINT64 VirtualAddress, UINT32 ProcessId);
  */
 BOOLEAN
 EptHookRemoveEntryAndFreePoolFromEptHook2sDetourList(UINT64 Address);
+
+/**
+ * @brief Find the hooked page of a physical page
+ * 
+ * @param PhysicalBaseAddress 
+ * @return PEPT_HOOKED_PAGE_DETAIL 
+ */
+PEPT_HOOKED_PAGE_DETAIL
+EptHookFindHookedPage(SIZE_T PhysicalBaseAddress);
+
+/**
+ * @brief Find the position of an offset in the sorted hooks of a page
+ * 
+ * @param HookedPage 
+ * @param Offset 
+ * @return UINT32 
+ */
+UINT32
+EptHookLowerBoundOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset);
+
+/**
+ * @brief Find the hook of a page at an offset
+ * 
+ * @param HookedPage 
+ * @param Offset 
+ * @return PEPT_HOOKED_OFFSET 
+ */
+PEPT_HOOKED_OFFSET
+EptHookFindHookedOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset);
+
+/**
+ * @brief Check whether a range of a page overlaps with its hooks
+ * 
+ * @param HookedPage 
+ * @param Offset 
+ * @param Length 
+ * @return BOOLEAN 
+ */
+BOOLEAN
+EptHookIsRangeHooked(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset, UINT64 Length);
+
+/**
+ * @brief Add a hook to the sorted hooks of a page
+ * 
+ * @param HookedPage 
+ * @param Offset 
+ * @return PEPT_HOOKED_OFFSET 
+ */
+PEPT_HOOKED_OFFSET
+EptHookInsertHookedOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, UINT64 Offset);
+
+/**
+ * @brief Remove a hook from the sorted hooks of a page
+ * 
+ * @param HookedPage 
+ * @param HookedOffset 
+ * @return VOID 
+ */
+VOID
+EptHookRemoveHookedOffset(PEPT_HOOKED_PAGE_DETAIL HookedPage, PEPT_HOOKED_OFFSET HookedOffset);
+
+/**
+ * @brief Release the detour details and the trampoline of a hook
+ * 
+ * @param HookedOffset 
+ * @return VOID 
+ */
+VOID
+EptHookReleaseHookedOffset(PEPT_HOOKED_OFFSET HookedOffset);
+
+/**
+ * @brief Check whether there is any hidden breakpoint on the hooked pages
+ * 
+ * @return BOOLEAN 
+ */
+BOOLEAN
+EptHookIsAnyHiddenBreakpoint();
@@ -213,6 +213,8 @@ HvHandleCpuid(PGUEST_REGS RegistersState)
     INT32  cpu_info[4];
     ULONG  Mode    = 0;
     UINT64 Context = 0;
+    UINT64 GuestCr4;
+    UINT32 CurrentProcessorIndex;
 
     //
     // Set the context (save eax for the debugger)
@@ -220,10 +222,23 @@ HvHandleCpuid(PGUEST_REGS RegistersState)
     Context = RegistersState->rax;
 
     //
-    // Otherwise, issue the CPUID to the logical processor based on the indexes
-    // on the VP's GPRs.
+    // Otherwise, get the result of the CPUID based on the indexes on the
+    // VP's GPRs, from the cache of this logical processor or the processor
+    // itself
     //
-    __cpuidex(cpu_info, (INT32)RegistersState->rax, (INT32)RegistersState->rcx);
+    CurrentProcessorIndex = KeGetCurrentProcessorNumber();
+
+    CpuidCacheQuery(&g_GuestState[CurrentProcessorIndex].CpuidCache,
+                    (UINT32)RegistersState->rax,
+                    (UINT32)RegistersState->rcx,
+                    cpu_info);
+
+    if ((UINT32)RegistersState->rax == CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS ||
+        (UINT32)RegistersState->rax == CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS)
+    {
+        __vmx_vmread(GUEST_CR4, &GuestCr4);
+        CpuidCacheApplyGuestState((UINT32)RegistersState->rax, (UINT32)RegistersState->rcx, cpu_info, GuestCr4);
+    }
 
     //
     // check whether we are in transparent mode or not
@@ -760,13 +775,28 @@ HvTerminateVmx()
     //
     // Free Identity Page Table
     //
-    MmFreeContiguousMemory(g_EptState->EptPageTable);
+    EptFreeIdentityPageTable(g_EptState->EptPageTable);
 
     //
     // Free EptState
     //
     ExFreePoolWithTag(g_EptState, POOLTAG);
 
+    //
+    // Free the bitmaps that are shared between the cores
+    //
+    SharedBitmapsUninitialize();
+
+    //
+    // Free the tables of splitting 2MB pages
+    //
+    EptSplitPoolUninitialize();
+
+    //
+    // Show the statistics of the updates of the controls
+    //
+    PendingControlsLogCounters();
+
     //
     // Free the Pool manager
     //
@@ -999,6 +1029,62 @@ HvDpcBroadcastRemoveHookAndInvalidateSingleEntry(KDPC * Dpc, PVOID DeferredConte
     KeSignalCallDpcDone(SystemArgument1);
 }
 
+/**
+ * @brief The broadcast function which restores the hooked pages that are
+ * removed in a transaction and invalidate TLB
+ * 
+ * @param Dpc 
+ * @param DeferredContext The transaction
+ * @param SystemArgument1 
+ * @param SystemArgument2 
+ * @return VOID 
+ */
+VOID
+HvDpcBroadcastRemoveHookAndInvalidateRemovedEntries(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
+{
+    //
+    // Execute the VMCALL to remove the hooks and invalidate
+    //
+    AsmVmxVmcall(VMCALL_UNHOOK_REMOVED_PAGES, DeferredContext, NULL, NULL);
+
+    //
+    // Wait for all DPCs to synchronize at this point
+    //
+    KeSignalCallDpcSynchronize(SystemArgument2);
+
+    //
+    // Mark the DPC as being complete
+    //
+    KeSignalCallDpcDone(SystemArgument1);
+}
+
+/**
+ * @brief The broadcast function which makes sure that none of the cores
+ * still handles a vm-exit with the hooked offsets that are being removed
+ * @details the DPC runs in vmx non-root, so when it runs on a core, that
+ * core has already left the vm-exit handler that might have used the old
+ * hooked offsets of the page
+ * 
+ * @param Dpc 
+ * @param DeferredContext 
+ * @param SystemArgument1 
+ * @param SystemArgument2 
+ * @return VOID 
+ */
+VOID
+HvDpcBroadcastAcknowledgeRemovedHookedOffsets(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2)
+{
+    //
+    // Wait for all DPCs to synchronize at this point
+    //
+    KeSignalCallDpcSynchronize(SystemArgument2);
+
+    //
+    // Mark the DPC as being complete
+    //
+    KeSignalCallDpcDone(SystemArgument1);
+}
+
 /**
  * @brief Change MSR Bitmap for read
  * @details should be called in vmx-root mode
@@ -1726,9 +1812,9 @@ VOID
 HvEnableBreakpointExitingOnExceptionBitmapAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcEnableBreakpointOnExceptionBitmapOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_ENABLE_BREAKPOINT_ON_EXCEPTION_BITMAP, 0);
 }
 
 /**
@@ -1740,9 +1826,9 @@ VOID
 HvDisableBreakpointExitingOnExceptionBitmapAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcDisableBreakpointOnExceptionBitmapOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_DISABLE_BREAKPOINT_ON_EXCEPTION_BITMAP, 0);
 }
 
 /**
@@ -1754,9 +1840,9 @@ VOID
 HvEnableNmiExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcEnableNmiVmexitOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_SET_VM_EXIT_ON_NMIS, 0);
 }
 
 /**
@@ -1768,9 +1854,9 @@ VOID
 HvDisableNmiExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the update for all cores
     //
-    KeGenericCallDpc(BroadcastDpcDisableNmiVmexitOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_UNSET_VM_EXIT_ON_NMIS, 0);
 }
 
 /**
@@ -1782,9 +1868,22 @@ VOID
 HvEnableDbAndBpExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the updates for all cores, the cores are kicked once for both
+    // of the updates
+    //
+    PendingControlsBeginBatch();
+
+    //
+    // Cause vm-exit on #BPs
+    //
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_SET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_BREAKPOINT);
+
+    //
+    // Cause vm-exit on #DBs
     //
-    KeGenericCallDpc(BroadcastDpcEnableDbAndBpExitingOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_SET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_DEBUG_BREAKPOINT);
+
+    PendingControlsEndBatch();
 }
 
 /**
@@ -1796,7 +1895,20 @@ VOID
 HvDisableDbAndBpExitingAllCores()
 {
     //
-    // Broadcast to all cores
+    // Queue the updates for all cores, the cores are kicked once for both
+    // of the updates
+    //
+    PendingControlsBeginBatch();
+
+    //
+    // Cause no vm-exit on #BPs
     //
-    KeGenericCallDpc(BroadcastDpcDisableDbAndBpExitingOnAllCores, NULL);
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_UNSET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_BREAKPOINT);
+
+    //
+    // Cause no vm-exit on #DBs
+    //
+    PendingControlsRequest(PENDING_CONTROLS_ALL_CORES, VMCALL_UNSET_EXCEPTION_BITMAP, EXCEPTION_VECTOR_DEBUG_BREAKPOINT);
+
+    PendingControlsEndBatch();
 }
@@ -487,3 +487,29 @@ HvDpcBroadcastRemoveHookAndInvalidateSingleEntry(KDPC * Dpc, PVOID DeferredConte
  */
 VOID
 HvDpcBroadcastRemoveHookAndInvalidateAllEntries(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2);
+
+/**
+ * @brief The broadcast function which restores the hooked pages that are
+ * removed in a transaction and invalidate TLB
+ * 
+ * @param Dpc 
+ * @param DeferredContext 
+ * @param SystemArgument1 
+ * @param SystemArgument2 
+ * @return VOID 
+ */
+VOID
+HvDpcBroadcastRemoveHookAndInvalidateRemovedEntries(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2);
+
+/**
+ * @brief The broadcast function which makes sure that none of the cores
+ * still handles a vm-exit with the hooked offsets that are being removed
+ * 
+ * @param Dpc 
+ * @param DeferredContext 
+ * @param SystemArgument1 
+ * @param SystemArgument2 
+ * @return VOID 
+ */
+VOID
+HvDpcBroadcastAcknowledgeRemovedHookedOffsets(KDPC * Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2);
@@ -0,0 +1,552 @@
+/**
+ * @file InstrumentTrace.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Tracing multiple instructions on the debuggee
+ * @details The instructions are stepped by MTF in vmx-root (or by the trap
+ * flag for 't' and 'p') and a compact record of each instruction is saved
+ * in the trace buffer, the records are sent to the debugger in large
+ * packets instead of halting the debuggee after each instruction
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Allocate the trace buffer
+ * @details this function should be called on vmx non-root
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+InstrumentTraceInitialize()
+{
+    RtlZeroMemory(&g_InstrumentTrace, sizeof(INSTRUMENT_TRACE_STATE));
+
+    g_InstrumentTrace.Buffer = ExAllocatePoolWithTag(NonPagedPool, DebuggeeTraceBufferSize, POOLTAG);
+
+    if (g_InstrumentTrace.Buffer == NULL)
+    {
+        return FALSE;
+    }
+
+    RtlZeroMemory(g_InstrumentTrace.Buffer, DebuggeeTraceBufferSize);
+
+    return TRUE;
+}
+
+/**
+ * @brief Free the trace buffer
+ * @details this function should be called on vmx non-root
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceUninitialize()
+{
+    g_InstrumentTrace.IsActive = FALSE;
+
+    if (g_InstrumentTrace.Buffer != NULL)
+    {
+        ExFreePoolWithTag(g_InstrumentTrace.Buffer, POOLTAG);
+        g_InstrumentTrace.Buffer = NULL;
+    }
+}
+
+/**
+ * @brief Read the traced registers of the guest
+ * @details rsp of GuestRegs is already updated at the start of the vm-exit
+ *
+ * @param GuestRegs
+ * @param Registers
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceReadRegisters(PGUEST_REGS GuestRegs, UINT64 * Registers)
+{
+    RFLAGS Rflags = {0};
+
+    //
+    // The general purpose registers are in the order of GUEST_REGS
+    //
+    memcpy(Registers, GuestRegs, sizeof(GUEST_REGS));
+
+    __vmx_vmread(GUEST_RFLAGS, &Rflags);
+
+    //
+    // The trap flag of stepping is not a change of the instruction
+    //
+    if (g_InstrumentTrace.Options.StepType != DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT)
+    {
+        Rflags.TrapFlag = FALSE;
+    }
+
+    Registers[DEBUGGEE_TRACE_COUNT_OF_REGISTERS - 1] = Rflags.Value;
+}
+
+/**
+ * @brief Check whether the instruction is a call instruction or not
+ *
+ * @param InstructionBytes
+ * @param InstructionLength
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+InstrumentTraceIsCallInstruction(BYTE * InstructionBytes, UINT32 InstructionLength)
+{
+    UINT32 Index = 0;
+
+    //
+    // Skip the prefixes (e.g. rex.w, bnd or the segments)
+    //
+    while (Index < InstructionLength &&
+           (InstructionBytes[Index] == 0xf2 || InstructionBytes[Index] == 0xf3 || InstructionBytes[Index] == 0x66 ||
+            InstructionBytes[Index] == 0x67 || InstructionBytes[Index] == 0x2e || InstructionBytes[Index] == 0x3e ||
+            InstructionBytes[Index] == 0x26 || InstructionBytes[Index] == 0x36 || InstructionBytes[Index] == 0x64 ||
+            InstructionBytes[Index] == 0x65 || (InstructionBytes[Index] >= 0x40 && InstructionBytes[Index] <= 0x4f)))
+    {
+        Index++;
+    }
+
+    if (Index >= InstructionLength)
+    {
+        return FALSE;
+    }
+
+    //
+    // call rel32 and call far ptr16:32
+    //
+    if (InstructionBytes[Index] == 0xe8 || InstructionBytes[Index] == 0x9a)
+    {
+        return TRUE;
+    }
+
+    //
+    // call r/m and call far m16:64 (ff /2 and ff /3)
+    //
+    return InstructionBytes[Index] == 0xff && Index + 1 < InstructionLength &&
+           (((InstructionBytes[Index + 1] >> 3) & 7) == 2 || ((InstructionBytes[Index + 1] >> 3) & 7) == 3);
+}
+
+/**
+ * @brief Save the instruction that is executed on the next MTF
+ *
+ * @param CoreId
+ * @param GuestRegs
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceSaveInstruction(UINT32 CoreId, PGUEST_REGS GuestRegs)
+{
+    UINT64  Rip                    = g_GuestState[CoreId].LastVmexitRip;
+    UINT32  SizeOfSafeBufferToRead = 0;
+    UINT32  InstructionLength      = 0;
+    BOOLEAN Is32Bit                = KdIsGuestOnUsermode32Bit();
+
+    RtlZeroMemory(g_InstrumentTrace.PendingInstruction, MAXIMUM_INSTR_SIZE);
+
+    //
+    // Compute the amount of buffer we can read without problem (the
+    // same as the paused packet)
+    //
+    SizeOfSafeBufferToRead = (Rip & 0xfff) + MAXIMUM_INSTR_SIZE;
+
+    if (SizeOfSafeBufferToRead >= PAGE_SIZE)
+    {
+        SizeOfSafeBufferToRead = MAXIMUM_INSTR_SIZE - (SizeOfSafeBufferToRead - PAGE_SIZE);
+    }
+    else
+    {
+        SizeOfSafeBufferToRead = MAXIMUM_INSTR_SIZE;
+    }
+
+    MemoryMapperReadMemorySafeOnTargetProcess(Rip, g_InstrumentTrace.PendingInstruction, SizeOfSafeBufferToRead);
+
+    InstructionLength = ldisasm(g_InstrumentTrace.PendingInstruction, !Is32Bit);
+
+    if (InstructionLength == 0 || InstructionLength > MAXIMUM_INSTR_SIZE)
+    {
+        InstructionLength = MAXIMUM_INSTR_SIZE;
+    }
+
+    g_InstrumentTrace.PendingRecord.Rip               = Rip;
+    g_InstrumentTrace.PendingRecord.InstructionLength = (BYTE)InstructionLength;
+    g_InstrumentTrace.PendingRecord.Flags             = Is32Bit ? DEBUGGEE_TRACE_RECORD_FLAG_32_BIT : 0;
+    g_InstrumentTrace.PendingRecord.ChangedRegisters  = 0;
+
+    //
+    // The calls are executed at once in the step-over
+    //
+    g_InstrumentTrace.IsPendingInstructionACall =
+        g_InstrumentTrace.Options.StepType == DEBUGGEE_TRACE_STEP_TYPE_STEP_OVER &&
+        InstrumentTraceIsCallInstruction(g_InstrumentTrace.PendingInstruction, InstructionLength);
+
+    //
+    // Keep the registers to find the changes of this instruction
+    //
+    if (g_InstrumentTrace.Options.RecordRegisters)
+    {
+        InstrumentTraceReadRegisters(GuestRegs, g_InstrumentTrace.PreviousRegisters);
+    }
+}
+
+/**
+ * @brief Send the records of the trace buffer to the debugger
+ * @details The records are sent in packets of up to
+ * DebuggeeTraceRecordsChunkSize bytes, a record is never split
+ * between two packets
+ *
+ * @param IsFinished Whether the trace is finished or not
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceSendRecords(BOOLEAN IsFinished)
+{
+    PDEBUGGEE_TRACE_RECORDS_PACKET RecordsPacket = (PDEBUGGEE_TRACE_RECORDS_PACKET)g_InstrumentTrace.Packet;
+    PDEBUGGEE_TRACE_RECORD         Record;
+    UINT32                         RecordSize;
+    UINT32                         Offset = 0;
+
+    while (TRUE)
+    {
+        RtlZeroMemory(RecordsPacket, sizeof(DEBUGGEE_TRACE_RECORDS_PACKET));
+
+        //
+        // Add as many records as fit in the packet
+        //
+        while (Offset < g_InstrumentTrace.SizeOfRecords)
+        {
+            Record     = (PDEBUGGEE_TRACE_RECORD)(g_InstrumentTrace.Buffer + Offset);
+            RecordSize = sizeof(DEBUGGEE_TRACE_RECORD) + Record->InstructionLength;
+
+            for (UINT32 i = 0; i < DEBUGGEE_TRACE_COUNT_OF_REGISTERS; i++)
+            {
+                if (Record->ChangedRegisters & (1 << i))
+                {
+                    RecordSize += sizeof(UINT64);
+                }
+            }
+
+            if (RecordsPacket->Size + RecordSize > DebuggeeTraceRecordsChunkSize)
+            {
+                break;
+            }
+
+            memcpy(g_InstrumentTrace.Packet + sizeof(DEBUGGEE_TRACE_RECORDS_PACKET) + RecordsPacket->Size,
+                   Record,
+                   RecordSize);
+
+            RecordsPacket->Size += RecordSize;
+            RecordsPacket->CountOfRecords++;
+            Offset += RecordSize;
+        }
+
+        //
+        // The last packet of a finished trace also has the result of the trace
+        //
+        if (IsFinished && Offset >= g_InstrumentTrace.SizeOfRecords)
+        {
+            RecordsPacket->IsFinished   = TRUE;
+            RecordsPacket->StopReason   = g_InstrumentTrace.StopReason;
+            RecordsPacket->CountOfSteps = g_InstrumentTrace.CountOfSteps;
+        }
+
+        if (RecordsPacket->CountOfRecords != 0 || RecordsPacket->IsFinished)
+        {
+            KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                       DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_TRACE_RECORDS,
+                                       g_InstrumentTrace.Packet,
+                                       sizeof(DEBUGGEE_TRACE_RECORDS_PACKET) + RecordsPacket->Size);
+        }
+
+        if (Offset >= g_InstrumentTrace.SizeOfRecords)
+        {
+            break;
+        }
+    }
+
+    //
+    // The buffer is empty now
+    //
+    g_InstrumentTrace.SizeOfRecords  = 0;
+    g_InstrumentTrace.CountOfRecords = 0;
+}
+
+/**
+ * @brief Save the record of the pending instruction after it's executed
+ *
+ * @param GuestRegs
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceSaveRecord(PGUEST_REGS GuestRegs)
+{
+    UINT64                 Registers[DEBUGGEE_TRACE_COUNT_OF_REGISTERS];
+    PDEBUGGEE_TRACE_RECORD Record;
+    BYTE *                 Values;
+
+    //
+    // Send the records if the buffer is full
+    //
+    if (g_InstrumentTrace.SizeOfRecords + INSTRUMENT_TRACE_MAXIMUM_RECORD_SIZE > DebuggeeTraceBufferSize)
+    {
+        InstrumentTraceSendRecords(FALSE);
+    }
+
+    Record = (PDEBUGGEE_TRACE_RECORD)(g_InstrumentTrace.Buffer + g_InstrumentTrace.SizeOfRecords);
+
+    memcpy(Record, &g_InstrumentTrace.PendingRecord, sizeof(DEBUGGEE_TRACE_RECORD));
+    memcpy((BYTE *)Record + sizeof(DEBUGGEE_TRACE_RECORD),
+           g_InstrumentTrace.PendingInstruction,
+           Record->InstructionLength);
+
+    Values = (BYTE *)Record + sizeof(DEBUGGEE_TRACE_RECORD) + Record->InstructionLength;
+
+    //
+    // Only the registers that are changed by the instruction are saved
+    //
+    if (g_InstrumentTrace.Options.RecordRegisters)
+    {
+        InstrumentTraceReadRegisters(GuestRegs, Registers);
+
+        for (UINT32 i = 0; i < DEBUGGEE_TRACE_COUNT_OF_REGISTERS; i++)
+        {
+            if (Registers[i] != g_InstrumentTrace.PreviousRegisters[i])
+            {
+                Record->ChangedRegisters |= (1 << i);
+
+                memcpy(Values, &Registers[i], sizeof(UINT64));
+                Values += sizeof(UINT64);
+            }
+        }
+    }
+
+    g_InstrumentTrace.SizeOfRecords += (UINT32)(Values - (BYTE *)Record);
+    g_InstrumentTrace.CountOfRecords++;
+    g_InstrumentTrace.CountOfSteps++;
+}
+
+/**
+ * @brief Check whether the instruction is a return instruction or not
+ *
+ * @param InstructionBytes
+ * @param InstructionLength
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+InstrumentTraceIsReturnInstruction(BYTE * InstructionBytes, UINT32 InstructionLength)
+{
+    UINT32 Index = 0;
+
+    //
+    // Skip the prefixes (e.g. rex.w or bnd)
+    //
+    while (Index < InstructionLength &&
+           (InstructionBytes[Index] == 0xf2 || InstructionBytes[Index] == 0xf3 || InstructionBytes[Index] == 0x66 ||
+            (InstructionBytes[Index] >= 0x40 && InstructionBytes[Index] <= 0x4f)))
+    {
+        Index++;
+    }
+
+    if (Index >= InstructionLength)
+    {
+        return FALSE;
+    }
+
+    //
+    // ret, ret imm16, retf and retf imm16
+    //
+    return InstructionBytes[Index] == 0xc3 || InstructionBytes[Index] == 0xc2 ||
+           InstructionBytes[Index] == 0xcb || InstructionBytes[Index] == 0xca;
+}
+
+/**
+ * @brief Step the pending instruction by the trap flag
+ * @details The calls of the step-over are stepped by a hardware debug
+ * breakpoint on the next instruction (the same as the 'p' command)
+ *
+ * @param CoreId
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceStepPendingInstruction(UINT32 CoreId)
+{
+    UINT64 NextAddress;
+
+    if (!g_InstrumentTrace.IsPendingInstructionACall)
+    {
+        KdRegularStepInInstruction(CoreId);
+        return;
+    }
+
+    NextAddress = g_InstrumentTrace.PendingRecord.Rip + g_InstrumentTrace.PendingRecord.InstructionLength;
+
+    g_WaitForStepTrap = TRUE;
+
+    //
+    // Store the detail of the hardware debug register to avoid trigger
+    // in other threads
+    //
+    g_HardwareDebugRegisterDetailsForStepOver.Address   = NextAddress;
+    g_HardwareDebugRegisterDetailsForStepOver.ProcessId = PsGetCurrentProcessId();
+    g_HardwareDebugRegisterDetailsForStepOver.ThreadId  = PsGetCurrentThreadId();
+
+    SteppingsSetDebugRegister(0, BREAK_ON_INSTRUCTION_FETCH, FALSE, NextAddress);
+}
+
+/**
+ * @brief Start tracing the instructions on the current core
+ * @details should be called from vmx-root when the debuggee is halted,
+ * in the case of MTF the other cores remain halted until the trace is
+ * finished, otherwise the caller continues all of the cores
+ *
+ * @param CoreId
+ * @param GuestRegs
+ * @param TracePacket
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceStart(UINT32 CoreId, PGUEST_REGS GuestRegs, PDEBUGGEE_TRACE_PACKET TracePacket)
+{
+    memcpy(&g_InstrumentTrace.Options, TracePacket, sizeof(DEBUGGEE_TRACE_PACKET));
+
+    if (g_InstrumentTrace.Options.CountOfSteps == 0)
+    {
+        g_InstrumentTrace.Options.CountOfSteps = DebuggeeTraceDefaultMaximumSteps;
+    }
+
+    g_InstrumentTrace.CoreId         = CoreId;
+    g_InstrumentTrace.StopReason     = DEBUGGEE_TRACE_STOP_REASON_NOT_STOPPED;
+    g_InstrumentTrace.CountOfSteps   = 0;
+    g_InstrumentTrace.SizeOfRecords  = 0;
+    g_InstrumentTrace.CountOfRecords = 0;
+
+    //
+    // Save the first instruction
+    //
+    InstrumentTraceSaveInstruction(CoreId, GuestRegs);
+
+    g_InstrumentTrace.IsActive = TRUE;
+
+    if (g_InstrumentTrace.Options.StepType != DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT)
+    {
+        InstrumentTraceStepPendingInstruction(CoreId);
+        return;
+    }
+
+    //
+    // Not unset again
+    //
+    g_GuestState[CoreId].IgnoreMtfUnset = TRUE;
+
+    //
+    // External interrupts are not delivered during the trace (the same
+    // as the guaranteed step-in)
+    //
+    HvSetExternalInterruptExiting(TRUE);
+    HvSetInterruptWindowExiting(FALSE);
+
+    g_GuestState[CoreId].DebuggingState.EnableExternalInterruptsOnContinue = TRUE;
+
+    //
+    // Set the MTF flag
+    //
+    HvSetMonitorTrapFlag(TRUE);
+}
+
+/**
+ * @brief Handle the MTF (or the step trap) of the traced instruction
+ * @details In the case of the trap flag, the next instruction is stepped
+ * if the trace continues
+ *
+ * @param CoreId
+ * @param GuestRegs
+ *
+ * @return BOOLEAN Returns true if the trace continues and false if
+ * the trace is stopped and the debuggee should be halted
+ */
+BOOLEAN
+InstrumentTraceHandleStep(UINT32 CoreId, PGUEST_REGS GuestRegs)
+{
+    //
+    // The pending instruction is executed
+    //
+    InstrumentTraceSaveRecord(GuestRegs);
+
+    //
+    // Check the conditions of stopping the trace
+    //
+    if (g_InstrumentTrace.Options.StopOnReturn &&
+        InstrumentTraceIsReturnInstruction(g_InstrumentTrace.PendingInstruction,
+                                           g_InstrumentTrace.PendingRecord.InstructionLength))
+    {
+        g_InstrumentTrace.StopReason = DEBUGGEE_TRACE_STOP_REASON_RETURN_EXECUTED;
+    }
+    else if (g_InstrumentTrace.Options.StopAddress != NULL &&
+             g_InstrumentTrace.Options.StopAddress == g_GuestState[CoreId].LastVmexitRip)
+    {
+        g_InstrumentTrace.StopReason = DEBUGGEE_TRACE_STOP_REASON_ADDRESS_REACHED;
+    }
+    else if (g_InstrumentTrace.CountOfSteps >= g_InstrumentTrace.Options.CountOfSteps)
+    {
+        g_InstrumentTrace.StopReason = DEBUGGEE_TRACE_STOP_REASON_COUNT_REACHED;
+    }
+
+    if (g_InstrumentTrace.StopReason != DEBUGGEE_TRACE_STOP_REASON_NOT_STOPPED)
+    {
+        return FALSE;
+    }
+
+    //
+    // Continue with the next instruction
+    //
+    InstrumentTraceSaveInstruction(CoreId, GuestRegs);
+
+    if (g_InstrumentTrace.Options.StepType != DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT)
+    {
+        InstrumentTraceStepPendingInstruction(CoreId);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Finish the trace and send the remaining records
+ * @details called before halting the debuggee, if the trace is not
+ * stopped by its conditions, then the debuggee is halted by a breakpoint
+ * or an event in the middle of the trace
+ *
+ * @param CoreId
+ *
+ * @return VOID
+ */
+VOID
+InstrumentTraceFinish(UINT32 CoreId)
+{
+    if (g_InstrumentTrace.StopReason == DEBUGGEE_TRACE_STOP_REASON_NOT_STOPPED)
+    {
+        g_InstrumentTrace.StopReason = DEBUGGEE_TRACE_STOP_REASON_DEBUGGEE_HALTED;
+    }
+
+    g_InstrumentTrace.IsActive = FALSE;
+
+    //
+    // No need to step the instructions anymore
+    //
+    if (g_InstrumentTrace.Options.StepType == DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT)
+    {
+        HvSetMonitorTrapFlag(FALSE);
+    }
+
+    InstrumentTraceSendRecords(TRUE);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file InstrumentTrace.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of tracing multiple instructions on the debuggee
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum size of a record (the record, the instruction and
+ * all of the registers)
+ *
+ */
+#define INSTRUMENT_TRACE_MAXIMUM_RECORD_SIZE \
+    (sizeof(DEBUGGEE_TRACE_RECORD) + MAXIMUM_INSTR_SIZE + (DEBUGGEE_TRACE_COUNT_OF_REGISTERS * sizeof(UINT64)))
+
+/**
+ * @brief Size of each packet of the records (the header and the records)
+ *
+ */
+#define INSTRUMENT_TRACE_PACKET_SIZE \
+    (sizeof(DEBUGGEE_TRACE_RECORDS_PACKET) + DebuggeeTraceRecordsChunkSize)
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The state of the instrumentation trace
+ * @details Only one thread is traced at a time, in the case of MTF the
+ * other cores are halted during the trace
+ *
+ */
+typedef struct _INSTRUMENT_TRACE_STATE
+{
+    BOOLEAN                    IsActive;                                             // Shows whether a trace is running or not
+    UINT32                     CoreId;                                               // The core that traces the instructions
+    DEBUGGEE_TRACE_PACKET      Options;                                              // The conditions of the trace
+    DEBUGGEE_TRACE_STOP_REASON StopReason;                                           // The reason of stopping the trace
+    UINT64                     CountOfSteps;                                         // Count of the traced instructions
+    BYTE *                     Buffer;                                               // Buffer of the records
+    UINT32                     SizeOfRecords;                                        // Size of the records in the buffer
+    UINT32                     CountOfRecords;                                       // Count of the records in the buffer
+    DEBUGGEE_TRACE_RECORD      PendingRecord;                                        // The instruction that is executed on the next MTF
+    BOOLEAN                    IsPendingInstructionACall;                            // The pending instruction is a call that is stepped over
+    BYTE                       PendingInstruction[MAXIMUM_INSTR_SIZE];               // Bytes of the pending instruction
+    UINT64                     PreviousRegisters[DEBUGGEE_TRACE_COUNT_OF_REGISTERS]; // Registers before executing the pending instruction
+    BYTE                       Packet[INSTRUMENT_TRACE_PACKET_SIZE];                 // Packet of sending the records
+
+} INSTRUMENT_TRACE_STATE, *PINSTRUMENT_TRACE_STATE;
+
+//////////////////////////////////////////////////
+//                   Variables	    			//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The state of the instrumentation trace
+ *
+ */
+INSTRUMENT_TRACE_STATE g_InstrumentTrace;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+InstrumentTraceInitialize();
+
+VOID
+InstrumentTraceUninitialize();
+
+VOID
+InstrumentTraceStart(UINT32 CoreId, PGUEST_REGS GuestRegs, PDEBUGGEE_TRACE_PACKET TracePacket);
+
+BOOLEAN
+InstrumentTraceHandleStep(UINT32 CoreId, PGUEST_REGS GuestRegs);
+
+VOID
+InstrumentTraceFinish(UINT32 CoreId);
@@ -31,6 +31,8 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
     PDEBUGGER_VA2PA_AND_PA2VA_COMMANDS                      DebuggerVa2paAndPa2vaRequest;
     PDEBUGGER_EDIT_MEMORY                                   DebuggerEditMemoryRequest;
     PDEBUGGER_SEARCH_MEMORY                                 DebuggerSearchMemoryRequest;
+    PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY                   DebuggerMultiPatternSearchRequest;
+    PDEBUGGER_SCATTER_GATHER_READ_MEMORY                    DebuggerScatterGatherReadRequest;
     PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER                   RegBufferResult;
     PDEBUGGER_GENERAL_EVENT_DETAIL                          DebuggerNewEventRequest;
     PDEBUGGER_MODIFY_EVENTS                                 DebuggerModifyEventRequest;
@@ -45,6 +47,7 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
     PDEBUGGER_PREPARE_DEBUGGEE                              DebuggeeRequest;
     PDEBUGGER_PAUSE_PACKET_RECEIVED                         DebuggerPauseKernelRequest;
     PDEBUGGER_GENERAL_ACTION                                DebuggerNewActionRequest;
+    PDEBUGGER_EVENTS_BATCH                                  DebuggerEventsBatchRequest;
     NTSTATUS                                                Status;
     ULONG                                                   InBuffLength;  // Input buffer length
     ULONG                                                   OutBuffLength; // Output buffer length
@@ -353,6 +356,51 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
 
             break;
 
+        case IOCTL_DEBUGGER_REGISTER_EVENTS_BATCH:
+
+            //
+            // First validate the parameters.
+            //
+            if (IrpStack->Parameters.DeviceIoControl.InputBufferLength < SIZEOF_DEBUGGER_EVENTS_BATCH ||
+                IrpStack->Parameters.DeviceIoControl.InputBufferLength > MaximumEventsBatchSize ||
+                Irp->AssociatedIrp.SystemBuffer == NULL)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                LogError("Invalid parameter to IOCTL Dispatcher.");
+                break;
+            }
+
+            InBuffLength  = IrpStack->Parameters.DeviceIoControl.InputBufferLength;
+            OutBuffLength = IrpStack->Parameters.DeviceIoControl.OutputBufferLength;
+
+            //
+            // The results are written to the entries, so the whole
+            // batch is returned
+            //
+            if (!InBuffLength || OutBuffLength < InBuffLength)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                break;
+            }
+
+            DebuggerEventsBatchRequest = (PDEBUGGER_EVENTS_BATCH)Irp->AssociatedIrp.SystemBuffer;
+
+            //
+            // Both usermode and to send to usermode and the comming buffer are
+            // at the same place
+            //
+            DebuggerParseEventsBatchFromUsermode(DebuggerEventsBatchRequest, InBuffLength);
+
+            Irp->IoStatus.Information = InBuffLength;
+            Status                    = STATUS_SUCCESS;
+
+            //
+            // Avoid zeroing it
+            //
+            DoNotChangeInformation = TRUE;
+
+            break;
+
         case IOCTL_DEBUGGER_HIDE_AND_UNHIDE_TO_TRANSPARENT_THE_DEBUGGER:
 
             //
@@ -557,10 +605,10 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
             OutBuffLength = IrpStack->Parameters.DeviceIoControl.OutputBufferLength;
 
             //
-            // The OutBuffLength should have at least MaximumSearchResults * sizeof(UINT64)
-            // free space to store the results
+            // The OutBuffLength should have at least the structure and
+            // MaximumSearchResults * sizeof(UINT64) free space to store the results
             //
-            if (!InBuffLength || OutBuffLength < MaximumSearchResults * sizeof(UINT64))
+            if (!InBuffLength || OutBuffLength < DEBUGGER_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE)
             {
                 Status = STATUS_INVALID_PARAMETER;
                 break;
@@ -574,9 +622,10 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
             //
             // Here we should validate whether the input parameter is
             // valid or in other words whether we recieved enough space or not
+            // (values and masks)
             //
             if (IrpStack->Parameters.DeviceIoControl.InputBufferLength !=
-                SIZEOF_DEBUGGER_SEARCH_MEMORY + DebuggerSearchMemoryRequest->CountOf64Chunks * sizeof(UINT64))
+                SIZEOF_DEBUGGER_SEARCH_MEMORY + DebuggerSearchMemoryRequest->CountOf64Chunks * sizeof(UINT64) * 2)
             {
                 Status = STATUS_INVALID_PARAMETER;
                 break;
@@ -584,23 +633,17 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
 
             //
             // Both usermode and to send to usermode and the comming buffer are
-            // at the same place
+            // at the same place,
+            // the status and the count of results are filled in the
+            // structure even if the search is failed
             //
-            if (DebuggerCommandSearchMemory(DebuggerSearchMemoryRequest) != STATUS_SUCCESS)
-            {
-                //
-                // It is because it was not valid in any of the ways to the function
-                // then we're sure that the usermode code won't interpret it's previous
-                // buffer as a valid buffer and will not show it to the user
-                //
-                RtlZeroMemory(DebuggerSearchMemoryRequest, MaximumSearchResults * sizeof(UINT64));
-            }
+            DebuggerCommandSearchMemory(DebuggerSearchMemoryRequest);
 
             //
             // Configure IRP status, and also we send the results
-            // buffer, with it's null values (if any)
+            // buffer
             //
-            Irp->IoStatus.Information = MaximumSearchResults * sizeof(UINT64);
+            Irp->IoStatus.Information = DEBUGGER_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE;
             Status                    = STATUS_SUCCESS;
 
             //
@@ -1107,6 +1150,126 @@ DrvDispatchIoControl(PDEVICE_OBJECT DeviceObject, PIRP Irp)
 
             break;
 
+        case IOCTL_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY:
+
+            //
+            // First validate the parameters.
+            //
+            if (IrpStack->Parameters.DeviceIoControl.InputBufferLength < SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY ||
+                Irp->AssociatedIrp.SystemBuffer == NULL)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                LogError("Invalid parameter to IOCTL Dispatcher.");
+                break;
+            }
+
+            InBuffLength  = IrpStack->Parameters.DeviceIoControl.InputBufferLength;
+            OutBuffLength = IrpStack->Parameters.DeviceIoControl.OutputBufferLength;
+
+            //
+            // The OutBuffLength should have enough space to store the
+            // structure and the results
+            //
+            if (!InBuffLength || OutBuffLength < DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                break;
+            }
+
+            //
+            // Cast buffer to understandable buffer
+            //
+            DebuggerMultiPatternSearchRequest = (PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY)Irp->AssociatedIrp.SystemBuffer;
+
+            //
+            // Check whether we recieved the lengths and the bytes of
+            // all patterns or not
+            //
+            if (DebuggerMultiPatternSearchRequest->CountOfPatterns > MaximumMultiPatternSearchPatternsCount ||
+                InBuffLength != SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY +
+                                    (DebuggerMultiPatternSearchRequest->CountOfPatterns * sizeof(UINT32)) +
+                                    DebuggerMultiPatternSearchRequest->PatternsTotalLength)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                break;
+            }
+
+            //
+            // Both usermode and to send to usermode and the comming buffer are
+            // at the same place, the status and the results are filled in the
+            // structure even if the search is failed
+            //
+            DebuggerCommandMultiPatternSearchMemory(DebuggerMultiPatternSearchRequest);
+
+            Irp->IoStatus.Information = DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE;
+            Status                    = STATUS_SUCCESS;
+
+            //
+            // Avoid zeroing it
+            //
+            DoNotChangeInformation = TRUE;
+
+            break;
+
+        case IOCTL_DEBUGGER_SCATTER_GATHER_READ_MEMORY:
+
+            //
+            // First validate the parameters.
+            //
+            if (IrpStack->Parameters.DeviceIoControl.InputBufferLength < SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY ||
+                Irp->AssociatedIrp.SystemBuffer == NULL)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                LogError("Invalid parameter to IOCTL Dispatcher.");
+                break;
+            }
+
+            InBuffLength  = IrpStack->Parameters.DeviceIoControl.InputBufferLength;
+            OutBuffLength = IrpStack->Parameters.DeviceIoControl.OutputBufferLength;
+
+            //
+            // The OutBuffLength should have enough space to store the
+            // structure, the descriptors and the read bytes
+            //
+            if (!InBuffLength || OutBuffLength < DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE)
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                break;
+            }
+
+            //
+            // Cast buffer to understandable buffer
+            //
+            DebuggerScatterGatherReadRequest = (PDEBUGGER_SCATTER_GATHER_READ_MEMORY)Irp->AssociatedIrp.SystemBuffer;
+
+            //
+            // Check whether we recieved all of the descriptors or not
+            //
+            if (DebuggerScatterGatherReadRequest->CountOfDescriptors > MaximumScatterGatherReadDescriptors ||
+                InBuffLength < SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY +
+                                   (DebuggerScatterGatherReadRequest->CountOfDescriptors * sizeof(DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR)))
+            {
+                Status = STATUS_INVALID_PARAMETER;
+                break;
+            }
+
+            //
+            // Both usermode and to send to usermode and the comming buffer are
+            // at the same place, the status and the results are filled in the
+            // structure even if the read is failed
+            //
+            DebuggerCommandScatterGatherReadMemory(DebuggerScatterGatherReadRequest);
+
+            Irp->IoStatus.Information = DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE;
+            Status                    = STATUS_SUCCESS;
+
+            //
+            // Avoid zeroing it
+            //
+            DoNotChangeInformation = TRUE;
+
+            break;
+
         default:
             LogError("Unknow IOCTL");
             Status = STATUS_NOT_IMPLEMENTED;
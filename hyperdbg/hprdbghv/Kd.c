@@ -37,11 +37,37 @@ KdInitializeKernelDebugger()
         return;
     }
 
+    //
+    // Allocate the index of breakpoints, as we can't allocate it in vmx-root
+    //
+    if (!BreakpointIndexInitialize())
+    {
+        ExFreePoolWithTag(g_DebuggeeDpc, POOLTAG);
+        LogError("err, allocating index of breakpoints for debuggee");
+        return;
+    }
+
+    //
+    // Allocate the buffer of tracing instructions, as we can't allocate it in vmx-root
+    //
+    if (!InstrumentTraceInitialize())
+    {
+        BreakpointIndexUninitialize();
+        ExFreePoolWithTag(g_DebuggeeDpc, POOLTAG);
+        LogError("err, allocating trace buffer for debuggee");
+        return;
+    }
+
     //
     // Register NMI handler for vmx-root
     //
     g_NmiHandlerForKeDeregisterNmiCallback = KeRegisterNmiCallback(&KdNmiCallback, NULL);
 
+    //
+    // The cores are kicked once for all of the following updates
+    //
+    PendingControlsBeginBatch();
+
     //
     // Broadcast on all core to cause exit for NMIs
     //
@@ -53,6 +79,8 @@ KdInitializeKernelDebugger()
     //
     HvEnableDbAndBpExitingAllCores();
 
+    PendingControlsEndBatch();
+
     //
     // Reset pause break requests
     //
@@ -97,11 +125,26 @@ KdUninitializeKernelDebugger()
         //
         BreakpointRemoveAllBreakpoints();
 
+        //
+        // Free the index of breakpoints
+        //
+        BreakpointIndexUninitialize();
+
+        //
+        // Free the buffer of tracing instructions
+        //
+        InstrumentTraceUninitialize();
+
         //
         // De-register NMI handler
         //
         KeDeregisterNmiCallback(g_NmiHandlerForKeDeregisterNmiCallback);
 
+        //
+        // The cores are kicked once for all of the following updates
+        //
+        PendingControlsBeginBatch();
+
         //
         // Broadcast on all core to cause not to exit for NMIs
         //
@@ -113,6 +156,8 @@ KdUninitializeKernelDebugger()
         //
         HvDisableDbAndBpExitingAllCores();
 
+        PendingControlsEndBatch();
+
         //
         // Free DPC holder
         //
@@ -545,6 +590,23 @@ KdHandleDebugEventsWhenKernelDebuggerIsAttached(UINT32 CurrentProcessorIndex, PG
                 }
             }
 
+            //
+            // If a thread is traced by the trap flag, then the step is
+            // recorded and the next instruction is stepped without halting
+            //
+            if (!IgnoreDebugEvent && g_InstrumentTrace.IsActive &&
+                g_InstrumentTrace.Options.StepType != DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT)
+            {
+                SpinlockLock(&DebuggerHandleBreakpointLock);
+
+                //
+                // The trace might be finished by other cores
+                //
+                IgnoreDebugEvent = g_InstrumentTrace.IsActive && InstrumentTraceHandleStep(CurrentProcessorIndex, GuestRegs);
+
+                SpinlockUnlock(&DebuggerHandleBreakpointLock);
+            }
+
             if (!IgnoreDebugEvent)
             {
                 //
@@ -1110,6 +1172,18 @@ KdHandleBreakpointAndDebugBreakpoints(UINT32                            CurrentP
     //
     SpinlockLock(&DebuggerHandleBreakpointLock);
 
+    //
+    // If the core is tracing instructions (or a thread is traced by the
+    // trap flag), then the trace is finished and the remaining records are
+    // sent before halting the debuggee
+    //
+    if (g_InstrumentTrace.IsActive &&
+        (g_InstrumentTrace.CoreId == CurrentProcessorIndex ||
+         g_InstrumentTrace.Options.StepType != DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT))
+    {
+        InstrumentTraceFinish(CurrentProcessorIndex);
+    }
+
     //
     // Check if we should ignore this break request or not
     //
@@ -1421,6 +1495,27 @@ KdPerformAddActionToEvent(PDEBUGGEE_EVENT_AND_ACTION_HEADER_FOR_REMOTE_PACKET Ac
                   ActionDetailHeader->Length);
 }
 
+/**
+ * @brief Send a batch of events and their actions to user-mode to
+ * register all of them at once
+ * @param EventsBatch 
+ * 
+ * @return BOOLEAN 
+ */
+BOOLEAN
+KdPerformRegisterEventsBatch(PDEBUGGER_EVENTS_BATCH EventsBatch)
+{
+    if (EventsBatch->Size < SIZEOF_DEBUGGER_EVENTS_BATCH ||
+        EventsBatch->Size > MaximumEventsBatchSizeOverSerial)
+    {
+        return FALSE;
+    }
+
+    return LogSendBuffer(OPERATION_DEBUGGEE_REGISTER_EVENTS_BATCH,
+                         EventsBatch,
+                         EventsBatch->Size);
+}
+
 /**
  * @brief Perform modify and query events
  * @param ModifyAndQueryEvent 
@@ -1559,6 +1654,7 @@ KdDispatchAndPerformCommandsFromDebugger(ULONG CurrentCore, PGUEST_REGS GuestReg
 {
     PDEBUGGEE_CHANGE_CORE_PACKET                        ChangeCorePacket;
     PDEBUGGEE_STEP_PACKET                               SteppingPacket;
+    PDEBUGGEE_TRACE_PACKET                              TracePacket;
     PDEBUGGER_FLUSH_LOGGING_BUFFERS                     FlushPacket;
     PDEBUGGEE_REGISTER_READ_DESCRIPTION                 ReadRegisterPacket;
     PDEBUGGER_READ_MEMORY                               ReadMemoryPacket;
@@ -1570,7 +1666,10 @@ KdDispatchAndPerformCommandsFromDebugger(ULONG CurrentCore, PGUEST_REGS GuestReg
     PDEBUGGEE_BP_LIST_OR_MODIFY_PACKET                  BpListOrModifyPacket;
     PDEBUGGEE_EVENT_AND_ACTION_HEADER_FOR_REMOTE_PACKET EventRegPacket;
     PDEBUGGEE_EVENT_AND_ACTION_HEADER_FOR_REMOTE_PACKET AddActionPacket;
+    PDEBUGGER_EVENTS_BATCH                              EventsBatchPacket;
     PDEBUGGER_MODIFY_EVENTS                             QueryAndModifyEventPacket;
+    PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY               MultiPatternSearchPacket;
+    PDEBUGGER_SCATTER_GATHER_READ_MEMORY                ScatterGatherReadPacket;
     UINT64                                              NextAddressForHardwareDebugBp = 0;
     UINT32                                              SizeToSend                    = 0;
     ULONG                                               CoreCount;
@@ -1741,6 +1840,39 @@ KdDispatchAndPerformCommandsFromDebugger(ULONG CurrentCore, PGUEST_REGS GuestReg
 
                 break;
 
+            case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MODE_TRACE:
+
+                TracePacket = (DEBUGGEE_TRACE_PACKET *)(((CHAR *)TheActualPacket) +
+                                                        sizeof(DEBUGGER_REMOTE_PACKET));
+
+                //
+                // Trace the instructions in vmx-root, the records are sent
+                // before the debuggee is halted again
+                //
+                InstrumentTraceStart(CurrentCore, GuestRegs, TracePacket);
+
+                if (TracePacket->StepType == DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT)
+                {
+                    //
+                    // Unlock just on core
+                    //
+                    KdContinueDebuggeeJustCurrentCore(CurrentCore);
+                }
+                else
+                {
+                    //
+                    // Unlock other cores (the same as the regular steps)
+                    //
+                    KdContinueDebuggee(CurrentCore, FALSE, DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_NO_ACTION);
+                }
+
+                //
+                // No need to wait for new commands
+                //
+                EscapeFromTheLoop = TRUE;
+
+                break;
+
             case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MODE_CLOSE_AND_UNLOAD_DEBUGGEE:
 
                 //
@@ -2043,6 +2175,37 @@ KdDispatchAndPerformCommandsFromDebugger(ULONG CurrentCore, PGUEST_REGS GuestReg
 
                 break;
 
+            case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_REGISTER_EVENTS_BATCH:
+
+                EventsBatchPacket = (DEBUGGER_EVENTS_BATCH *)(((CHAR *)TheActualPacket) +
+                                                              sizeof(DEBUGGER_REMOTE_PACKET));
+
+                //
+                // Send the batch to user-mode debuggee
+                //
+                if (!KdPerformRegisterEventsBatch(EventsBatchPacket))
+                {
+                    //
+                    // The batch is not sent, none of the events are registered
+                    //
+                    EventsBatchPacket->CountOfRegisteredEvents = 0;
+                    EventsBatchPacket->KernelStatus            = DEBUGGER_ERROR_EVENTS_BATCH_INVALID_LAYOUT;
+
+                    KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                               DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_REGISTERING_EVENTS_BATCH,
+                                               EventsBatchPacket,
+                                               SIZEOF_DEBUGGER_EVENTS_BATCH);
+                    break;
+                }
+
+                //
+                // Continue Debuggee
+                //
+                KdContinueDebuggee(CurrentCore, TRUE, DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_REGISTERING_EVENTS_BATCH);
+                EscapeFromTheLoop = TRUE;
+
+                break;
+
             case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_QUERY_AND_MODIFY_EVENT:
 
                 QueryAndModifyEventPacket = (DEBUGGER_MODIFY_EVENTS *)(((CHAR *)TheActualPacket) +
@@ -2117,6 +2280,54 @@ KdDispatchAndPerformCommandsFromDebugger(ULONG CurrentCore, PGUEST_REGS GuestReg
 
                 break;
 
+            case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MULTI_PATTERN_SEARCH_MEMORY:
+
+                MultiPatternSearchPacket = (DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY *)(((CHAR *)TheActualPacket) +
+                                                                                    sizeof(DEBUGGER_REMOTE_PACKET));
+
+                //
+                // Search the patterns, the results are saved in the same packet
+                //
+                DebuggerCommandMultiPatternSearchMemoryVmxRoot(MultiPatternSearchPacket,
+                                                               RecvBufferLength - sizeof(DEBUGGER_REMOTE_PACKET));
+
+                //
+                // Send the result of searching back to the debugger
+                //
+                KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                           DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_MULTI_PATTERN_SEARCH_MEMORY,
+                                           MultiPatternSearchPacket,
+                                           SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY +
+                                               (MultiPatternSearchPacket->CountOfResults * sizeof(DEBUGGER_MULTI_PATTERN_SEARCH_RESULT)));
+
+                break;
+
+            case DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_SCATTER_GATHER_READ_MEMORY:
+
+                ScatterGatherReadPacket = (DEBUGGER_SCATTER_GATHER_READ_MEMORY *)(((CHAR *)TheActualPacket) +
+                                                                                  sizeof(DEBUGGER_REMOTE_PACKET));
+
+                //
+                // Read all of the ranges (or nodes), the descriptors and the bytes
+                // are saved in the same packet
+                //
+                if (!DebuggerCommandScatterGatherReadMemoryVmxRoot(ScatterGatherReadPacket))
+                {
+                    ScatterGatherReadPacket->CountOfDescriptors = 0;
+                }
+
+                //
+                // Send the result of reading memory back to the debugger
+                //
+                KdResponsePacketToDebugger(DEBUGGER_REMOTE_PACKET_TYPE_DEBUGGEE_TO_DEBUGGER,
+                                           DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_SCATTER_GATHER_READ_MEMORY,
+                                           ScatterGatherReadPacket,
+                                           SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY +
+                                               (ScatterGatherReadPacket->CountOfDescriptors * sizeof(DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR)) +
+                                               ScatterGatherReadPacket->TotalSize);
+
+                break;
+
             default:
                 LogError("err, unknown packet action received from the debugger\n");
                 break;
@@ -2349,9 +2560,15 @@ StartAgain:
 
         //
         // Lock and unlock the lock so all core can get the lock
-        // and continue their normal execution
+        // and continue their normal execution, the pending updates of
+        // the controls of this core are applied while it's halted as
+        // the operating core might wait for them
         //
-        SpinlockLock(&g_GuestState[CurrentCore].DebuggingState.Lock);
+        while (!SpinlockTryLock(&g_GuestState[CurrentCore].DebuggingState.Lock))
+        {
+            PendingControlsApply(CurrentCore, GuestRegs, FALSE);
+            _mm_pause();
+        }
 
         //
         // Check if it's a change core event or not
@@ -109,3 +109,9 @@ KdLoggingResponsePacketToDebugger(CHAR * OptionalBuffer, UINT32 OptionalBufferLe
 
 BOOLEAN
 KdCheckGuestOperatingModeChanges(UINT16 PreviousCsSelector, UINT16 CurrentCsSelector);
+
+BOOLEAN
+KdIsGuestOnUsermode32Bit();
+
+VOID
+KdRegularStepInInstruction(UINT32 CoreId);
@@ -60,8 +60,10 @@ LogInitialize()
         //
         MessageBufferInformation[i].BufferStartAddress                   = ExAllocatePoolWithTag(NonPagedPool, LogBufferSize, POOLTAG);
         MessageBufferInformation[i].BufferForMultipleNonImmediateMessage = ExAllocatePoolWithTag(NonPagedPool, PacketChunkSize, POOLTAG);
+        MessageBufferInformation[i].BufferForMultipleNonImmediateRecords = ExAllocatePoolWithTag(NonPagedPool, PacketChunkSize, POOLTAG);
 
-        if (!MessageBufferInformation[i].BufferStartAddress)
+        if (!MessageBufferInformation[i].BufferStartAddress ||
+            !MessageBufferInformation[i].BufferForMultipleNonImmediateRecords)
         {
             return FALSE; // STATUS_INSUFFICIENT_RESOURCES
         }
@@ -76,6 +78,19 @@ LogInitialize()
         //
         MessageBufferInformation[i].BufferEndAddress = (UINT64)MessageBufferInformation[i].BufferStartAddress + LogBufferSize;
     }
+
+    //
+    // Allocate the buffers of the cores for building the event records
+    // (one for vmx-root and one for vmx non-root of each core)
+    //
+    EventRecordBuffers = ExAllocatePoolWithTag(NonPagedPool, KeQueryActiveProcessorCount(0) * 2 * PacketChunkSize, POOLTAG);
+
+    if (!EventRecordBuffers)
+    {
+        return FALSE; // STATUS_INSUFFICIENT_RESOURCES
+    }
+
+    return TRUE;
 }
 
 /**
@@ -96,8 +111,14 @@ LogUnInitialize()
         //
         ExFreePoolWithTag(MessageBufferInformation[i].BufferStartAddress, POOLTAG);
         ExFreePoolWithTag(MessageBufferInformation[i].BufferForMultipleNonImmediateMessage, POOLTAG);
+        ExFreePoolWithTag(MessageBufferInformation[i].BufferForMultipleNonImmediateRecords, POOLTAG);
     }
 
+    //
+    // de-allocate the buffers of the cores for building the event records
+    //
+    ExFreePoolWithTag(EventRecordBuffers, POOLTAG);
+
     //
     // de-allocate buffers for trace message and data messages
     //
@@ -895,6 +916,125 @@ LogSendMessageToQueue(UINT32 OperationCode, BOOLEAN IsImmediateMessage, BOOLEAN
 #endif
 }
 
+/**
+ * @brief Send a structured record of the output of an event
+ * @details The immediate records are built in the buffer of the core and
+ * are sent with the tag of the event as their operation code, the other
+ * records are accumulated in the buffer of non-immediate records (like the
+ * non-immediate messages) and are sent together when the buffer is full,
+ * the user-mode forwards each record to the output sources of its event
+ *
+ * @param Tag Tag of the event
+ * @param IsImmediateMessage Should be sent immediately
+ * @param Kind The script function that creates the record
+ * @param Values The raw values
+ * @param CountOfValues Count of the raw values
+ * @param Text The text of the record (if any)
+ * @param TextLength Length of the text
+ * @return BOOLEAN if it was successful then return TRUE, otherwise returns FALSE
+ */
+BOOLEAN
+LogSendEventRecord(UINT64                     Tag,
+                   BOOLEAN                    IsImmediateMessage,
+                   DEBUGGER_EVENT_RECORD_KIND Kind,
+                   UINT64 *                   Values,
+                   UINT32                     CountOfValues,
+                   const char *               Text,
+                   UINT32                     TextLength)
+{
+    BOOLEAN Result = TRUE;
+    UINT32  Index;
+    UINT32  RecordLength;
+    KIRQL   OldIRQL      = PASSIVE_LEVEL;
+    BOOLEAN IsIrqlRaised = FALSE;
+    BOOLEAN IsVmxRootMode;
+    CHAR *  RecordBuffer;
+
+    //
+    // Set Vmx State
+    //
+    IsVmxRootMode = g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode;
+    Index         = IsVmxRootMode ? 1 : 0;
+
+    RecordLength = LogGetEventRecordLength(&CountOfValues, &TextLength);
+
+    if (IsImmediateMessage)
+    {
+        //
+        // The vmx non-root mode doesn't switch to another thread that uses
+        // the same buffer while the record is built and sent
+        //
+        if (!IsVmxRootMode && KeGetCurrentIrql() < DISPATCH_LEVEL)
+        {
+            KeRaiseIrql(DISPATCH_LEVEL, &OldIRQL);
+            IsIrqlRaised = TRUE;
+        }
+
+        RecordBuffer = EventRecordBuffers + (KeGetCurrentProcessorNumber() * 2 + Index) * PacketChunkSize;
+
+        LogFillEventRecord(RecordBuffer, Tag, Kind, Values, CountOfValues, Text, TextLength);
+
+        Result = LogSendBuffer((UINT32)Tag, RecordBuffer, RecordLength);
+
+        if (IsIrqlRaised)
+        {
+            KeLowerIrql(OldIRQL);
+        }
+
+        return Result;
+    }
+
+    //
+    // Check if we're in Vmx-root, if it is then we use our customized HIGH_IRQL Spinlock,
+    // if not we use the windows spinlock
+    //
+    if (IsVmxRootMode)
+    {
+        SpinlockLock(&VmxRootLoggingLockForNonImmBuffers);
+    }
+    else
+    {
+        KeAcquireSpinLock(&MessageBufferInformation[Index].BufferLockForNonImmMessage, &OldIRQL);
+    }
+
+    //
+    // If the record doesn't fit in the buffer then we have to send the previous records
+    //
+    if (MessageBufferInformation[Index].CurrentLengthOfNonImmRecords + RecordLength > PacketChunkSize - 1)
+    {
+        Result = LogSendBuffer(OPERATION_LOG_NON_IMMEDIATE_EVENT_RECORDS,
+                               MessageBufferInformation[Index].BufferForMultipleNonImmediateRecords,
+                               MessageBufferInformation[Index].CurrentLengthOfNonImmRecords);
+
+        MessageBufferInformation[Index].CurrentLengthOfNonImmRecords = 0;
+    }
+
+    //
+    // Build the record after the previous records
+    //
+    LogFillEventRecord((CHAR *)MessageBufferInformation[Index].BufferForMultipleNonImmediateRecords +
+                           MessageBufferInformation[Index].CurrentLengthOfNonImmRecords,
+                       Tag,
+                       Kind,
+                       Values,
+                       CountOfValues,
+                       Text,
+                       TextLength);
+
+    MessageBufferInformation[Index].CurrentLengthOfNonImmRecords += RecordLength;
+
+    if (IsVmxRootMode)
+    {
+        SpinlockUnlock(&VmxRootLoggingLockForNonImmBuffers);
+    }
+    else
+    {
+        KeReleaseSpinLock(&MessageBufferInformation[Index].BufferLockForNonImmMessage, OldIRQL);
+    }
+
+    return Result;
+}
+
 /**
  * @brief Complete the IRP in IRP Pending state and fill the usermode buffers with pool data
  * 
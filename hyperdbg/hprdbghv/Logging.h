@@ -55,6 +55,9 @@ typedef struct _LOG_BUFFER_INFORMATION
     UINT64 BufferForMultipleNonImmediateMessage; // Start address of the buffer for accumulating non-immadiate messages
     UINT32 CurrentLengthOfNonImmBuffer;          // the current size of the buffer for accumulating non-immadiate messages
 
+    UINT64 BufferForMultipleNonImmediateRecords; // Start address of the buffer for accumulating non-immadiate event records
+    UINT32 CurrentLengthOfNonImmRecords;         // the current size of the buffer for accumulating non-immadiate event records
+
     KSPIN_LOCK BufferLock;                 // SpinLock to protect access to the queue
     KSPIN_LOCK BufferLockForNonImmMessage; // SpinLock to protect access to the queue of non-imm messages
 
@@ -85,6 +88,13 @@ volatile LONG VmxRootLoggingLock;
  */
 volatile LONG VmxRootLoggingLockForNonImmBuffers;
 
+/**
+ * @brief Buffers for building the event records that are sent immediately
+ * (PacketChunkSize for vmx-root and for vmx non-root of each core)
+ * 
+ */
+CHAR * EventRecordBuffers;
+
 //////////////////////////////////////////////////
 //					Illustration				//
 //////////////////////////////////////////////////
@@ -159,6 +169,15 @@ LogCheckForNewMessage(BOOLEAN IsVmxRoot);
 BOOLEAN
 LogSendMessageToQueue(UINT32 OperationCode, BOOLEAN IsImmediateMessage, BOOLEAN ShowCurrentSystemTime, const char * Fmt, ...);
 
+BOOLEAN
+LogSendEventRecord(UINT64                     Tag,
+                   BOOLEAN                    IsImmediateMessage,
+                   DEBUGGER_EVENT_RECORD_KIND Kind,
+                   UINT64 *                   Values,
+                   UINT32                     CountOfValues,
+                   const char *               Text,
+                   UINT32                     TextLength);
+
 VOID
 LogNotifyUsermodeCallback(PKDPC Dpc, PVOID DeferredContext, PVOID SystemArgument1, PVOID SystemArgument2);
 
@@ -0,0 +1,86 @@
+/**
+ * @file LoggingRecords.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Building the structured records of the output of the events
+ * @details The records are sent by LogSendEventRecord, building them
+ * doesn't depend on the buffers of the messages so the unit tests build
+ * this file too
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Compute the length of an event record
+ * @details The count of the values and the length of the text are
+ * truncated if the record doesn't fit in a message
+ *
+ * @param CountOfValues Count of the raw values
+ * @param TextLength Length of the text
+ * @return UINT32 Length of the record
+ */
+UINT32
+LogGetEventRecordLength(UINT32 * CountOfValues, UINT32 * TextLength)
+{
+    UINT32 ValuesLength;
+
+    if (*CountOfValues > DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES)
+    {
+        *CountOfValues = DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES;
+    }
+
+    ValuesLength = *CountOfValues * sizeof(UINT64);
+
+    if (SIZEOF_DEBUGGER_EVENT_RECORD + ValuesLength + *TextLength > PacketChunkSize - 1)
+    {
+        *TextLength = PacketChunkSize - 1 - SIZEOF_DEBUGGER_EVENT_RECORD - ValuesLength;
+    }
+
+    return SIZEOF_DEBUGGER_EVENT_RECORD + ValuesLength + *TextLength;
+}
+
+/**
+ * @brief Fill an event record
+ * @details The count of the values and the length of the text should be
+ * truncated by LogGetEventRecordLength
+ *
+ * @param Buffer The buffer that receives the record
+ * @param Tag Tag of the event
+ * @param Kind The script function that creates the record
+ * @param Values The raw values
+ * @param CountOfValues Count of the raw values
+ * @param Text The text of the record (if any)
+ * @param TextLength Length of the text
+ * @return VOID
+ */
+VOID
+LogFillEventRecord(PVOID                      Buffer,
+                   UINT64                     Tag,
+                   DEBUGGER_EVENT_RECORD_KIND Kind,
+                   UINT64 *                   Values,
+                   UINT32                     CountOfValues,
+                   const char *               Text,
+                   UINT32                     TextLength)
+{
+    PDEBUGGER_EVENT_RECORD Record       = (PDEBUGGER_EVENT_RECORD)Buffer;
+    UINT32                 ValuesLength = CountOfValues * sizeof(UINT64);
+
+    Record->Signature     = DEBUGGER_EVENT_RECORD_SIGNATURE;
+    Record->Length        = SIZEOF_DEBUGGER_EVENT_RECORD + ValuesLength + TextLength;
+    Record->Kind          = (UINT16)Kind;
+    Record->CountOfValues = (UINT16)CountOfValues;
+    Record->TextLength    = TextLength;
+    Record->Tag           = Tag;
+    Record->Tsc           = __rdtsc();
+    Record->CoreId        = KeGetCurrentProcessorNumber();
+    Record->ProcessId     = (UINT32)(UINT64)PsGetCurrentProcessId();
+    Record->ThreadId      = (UINT32)(UINT64)PsGetCurrentThreadId();
+    Record->Reserved      = 0;
+
+    memcpy((CHAR *)Buffer + SIZEOF_DEBUGGER_EVENT_RECORD, Values, ValuesLength);
+    memcpy((CHAR *)Buffer + SIZEOF_DEBUGGER_EVENT_RECORD + ValuesLength, Text, TextLength);
+}
@@ -0,0 +1,29 @@
+/**
+ * @file LoggingRecords.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of building the structured records of the output of
+ * the events
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT32
+LogGetEventRecordLength(UINT32 * CountOfValues, UINT32 * TextLength);
+
+VOID
+LogFillEventRecord(PVOID                      Buffer,
+                   UINT64                     Tag,
+                   DEBUGGER_EVENT_RECORD_KIND Kind,
+                   UINT64 *                   Values,
+                   UINT32                     CountOfValues,
+                   const char *               Text,
+                   UINT32                     TextLength);
@@ -322,8 +322,9 @@ MemoryMapperMapPageAndGetPte(PUINT64 PteAddress)
 VOID
 MemoryMapperInitialize()
 {
-    UINT64 TempPte;
-    UINT32 ProcessorCount = KeQueryActiveProcessorCount(0);
+    UINT64                TempPte;
+    PMEMORY_MAPPER_WINDOW Window;
+    UINT32                ProcessorCount = KeQueryActiveProcessorCount(0);
 
     //
     // Reserve the address for all cores (read pte and va)
@@ -332,6 +333,25 @@ MemoryMapperInitialize()
     {
         g_GuestState[i].MemoryMapper.VirualAddress     = MemoryMapperMapPageAndGetPte(&TempPte);
         g_GuestState[i].MemoryMapper.PteVirtualAddress = TempPte;
+
+        //
+        // Reserve the windows of pages and find the PTE of each page, the
+        // PTEs are not necessarily contiguous as the window might cross
+        // a page table
+        //
+        for (UINT32 k = 0; k < MEMORY_MAPPER_COUNT_OF_WINDOWS; k++)
+        {
+            Window                 = &g_GuestState[i].MemoryMapper.Windows[k];
+            Window->VirtualAddress = MemoryMapperMapReservedPageRange(MEMORY_MAPPER_WINDOW_PAGES * PAGE_SIZE);
+
+            if (Window->VirtualAddress != NULL)
+            {
+                for (UINT32 j = 0; j < MEMORY_MAPPER_WINDOW_PAGES; j++)
+                {
+                    Window->PteVirtualAddresses[j] = MemoryMapperGetPte(Window->VirtualAddress + (j * PAGE_SIZE));
+                }
+            }
+        }
     }
 }
 
@@ -345,7 +365,8 @@ MemoryMapperInitialize()
 VOID
 MemoryMapperUninitialize()
 {
-    UINT32 ProcessorCount = KeQueryActiveProcessorCount(0);
+    PMEMORY_MAPPER_WINDOW Window;
+    UINT32                ProcessorCount = KeQueryActiveProcessorCount(0);
 
     for (size_t i = 0; i < ProcessorCount; i++)
     {
@@ -355,6 +376,29 @@ MemoryMapperUninitialize()
         MemoryMapperUnmapReservedPageRange(g_GuestState[i].MemoryMapper.VirualAddress);
         g_GuestState[i].MemoryMapper.VirualAddress     = NULL;
         g_GuestState[i].MemoryMapper.PteVirtualAddress = NULL;
+
+        for (UINT32 k = 0; k < MEMORY_MAPPER_COUNT_OF_WINDOWS; k++)
+        {
+            Window = &g_GuestState[i].MemoryMapper.Windows[k];
+
+            if (Window->VirtualAddress == NULL)
+            {
+                continue;
+            }
+
+            //
+            // The pages of the window remain mapped after the copies, so
+            // they should be unmapped before freeing the reserved range
+            //
+            for (UINT32 j = 0; j < MEMORY_MAPPER_WINDOW_PAGES; j++)
+            {
+                ((PPAGE_ENTRY)Window->PteVirtualAddresses[j])->Flags = NULL;
+                Window->PteVirtualAddresses[j]                     = NULL;
+            }
+
+            MemoryMapperUnmapReservedPageRange(Window->VirtualAddress);
+            Window->VirtualAddress = NULL;
+        }
     }
 }
 
@@ -509,78 +553,417 @@ MemoryMapperWriteMemorySafeByPte(PVOID SourceVA, PHYSICAL_ADDRESS PaAddressToWri
 }
 
 /**
- * @brief Read memory safely by mapping the buffer by physical address (It's a wrapper)
- * 
- * @param PaAddressToRead Physical Address to read
- * @param BufferToSaveMemory Destination to save 
- * @param SizeToRead Size
- * @return BOOLEAN if it was successful the returns TRUE and if it was 
- * unsuccessful then it returns FALSE
+ * @brief Map a physical page in the window of the memory mapper
+ * @details if the page is already mapped by the current batch, then it's
+ * used without changing the PTE, otherwise a page which is not used by
+ * the current batch is mapped and its TLB entry is invalidated before
+ * the copies
+ *
+ * @param Window The window of the current core and mode
+ * @param Batch The current batch
+ * @param PageFrameNumber Page frame number of the physical page
+ * @return UINT32 Index of the page in the window
+ */
+UINT32
+MemoryMapperWindowMapPage(PMEMORY_MAPPER_WINDOW Window, PMEMORY_MAPPER_WINDOW_BATCH Batch, UINT64 PageFrameNumber)
+{
+    UINT32      Slot;
+    PAGE_ENTRY  PageEntry;
+    PPAGE_ENTRY Pte;
+
+    //
+    // Only the pages of the current batch are reused, the pages of the
+    // previous batches are unmapped and their TLB entries might be stale
+    // in another context (e.g., vmx non-root)
+    //
+    for (Slot = 0; Slot < MEMORY_MAPPER_WINDOW_PAGES; Slot++)
+    {
+        Pte = Window->PteVirtualAddresses[Slot];
+
+        if ((Batch->UsedSlots & (1 << Slot)) && Pte->PageFrameNumber == PageFrameNumber)
+        {
+            return Slot;
+        }
+    }
+
+    //
+    // Find a page that is not used by the copies of this batch
+    //
+    Slot = 0;
+
+    while (Batch->UsedSlots & (1 << Slot))
+    {
+        Slot++;
+    }
+
+    Pte = Window->PteVirtualAddresses[Slot];
+
+    //
+    // Copy the previous entry into the new entry, the page should be
+    // writable and shouldn't be flushed from the TLB on CR3 switch
+    //
+    PageEntry.Flags           = Pte->Flags;
+    PageEntry.Present         = 1;
+    PageEntry.Write           = 1;
+    PageEntry.Global          = 1;
+    PageEntry.PageFrameNumber = PageFrameNumber;
+
+    //
+    // Apply the page entry in a single instruction
+    //
+    Pte->Flags = PageEntry.Flags;
+
+    Batch->UsedSlots |= 1 << Slot;
+
+    return Slot;
+}
+
+/**
+ * @brief Copy the memory of a page of the window
+ * @details the aligned copies of 1, 2, 4 and 8 bytes are performed by a
+ * single load and a single store, so they're atomic (e.g., the emulated
+ * accesses of the guest are seen as the accesses of the processor)
+ *
+ * @param Destination
+ * @param Source
+ * @param Size
+ * @return VOID
+ */
+VOID
+MemoryMapperWindowCopy(PVOID Destination, PVOID Source, SIZE_T Size)
+{
+    if (Size > sizeof(UINT64) || (Size & (Size - 1)) != 0 ||
+        (((UINT64)Destination | (UINT64)Source) & (Size - 1)) != 0)
+    {
+        memcpy(Destination, Source, Size);
+        return;
+    }
+
+    switch (Size)
+    {
+    case 1:
+        *(volatile UINT8 *)Destination = *(volatile UINT8 *)Source;
+        break;
+
+    case 2:
+        *(volatile UINT16 *)Destination = *(volatile UINT16 *)Source;
+        break;
+
+    case 4:
+        *(volatile UINT32 *)Destination = *(volatile UINT32 *)Source;
+        break;
+
+    case 8:
+        *(volatile UINT64 *)Destination = *(volatile UINT64 *)Source;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Invalidate the mapped pages of the window, perform the copies
+ * of the batch and unmap the pages
+ *
+ * @param Window The window of the current core and mode
+ * @param Batch The current batch
+ * @param IsWrite Whether the buffers should be written to the memory or not
+ * @return VOID
+ */
+VOID
+MemoryMapperWindowPerformBatch(PMEMORY_MAPPER_WINDOW Window, PMEMORY_MAPPER_WINDOW_BATCH Batch, BOOLEAN IsWrite)
+{
+    //
+    // Invalidate the caches for all of the mapped pages at once, invlpg
+    // only invalidates the current context (VPID), so each mapping is
+    // invalidated in the context that uses it
+    //
+    for (UINT32 Slot = 0; Slot < MEMORY_MAPPER_WINDOW_PAGES; Slot++)
+    {
+        if (Batch->UsedSlots & (1 << Slot))
+        {
+            __invlpg((PVOID)(Window->VirtualAddress + (Slot * PAGE_SIZE)));
+        }
+    }
+
+    //
+    // Move the memory in a safe manner
+    //
+    for (UINT32 i = 0; i < Batch->CountOfCopies; i++)
+    {
+        if (IsWrite)
+        {
+            MemoryMapperWindowCopy(Batch->MappedAddresses[i], Batch->Buffers[i], Batch->Sizes[i]);
+        }
+        else
+        {
+            MemoryMapperWindowCopy(Batch->Buffers[i], Batch->MappedAddresses[i], Batch->Sizes[i]);
+        }
+    }
+
+    //
+    // Unmap the pages
+    //
+    for (UINT32 Slot = 0; Slot < MEMORY_MAPPER_WINDOW_PAGES; Slot++)
+    {
+        if (Batch->UsedSlots & (1 << Slot))
+        {
+            ((PPAGE_ENTRY)Window->PteVirtualAddresses[Slot])->Flags = NULL;
+        }
+    }
+
+    Batch->CountOfCopies = 0;
+    Batch->UsedSlots     = 0;
+}
+
+/**
+ * @brief Read or write a list of physical memory ranges by mapping
+ * them in the window of the memory mapper
+ *
+ * @details the pages of each batch are mapped and invalidated together
+ * and are unmapped after the copies of the batch
+ *
+ * @param Entries List of the physical memory ranges
+ * @param CountOfEntries Count of entries
+ * @param IsWrite Whether the buffers should be written to the memory or not
+ * @return BOOLEAN returns TRUE if it was successfull and FALSE if there was error
  */
 BOOLEAN
-MemoryMapperReadMemorySafeByPhysicalAddress(UINT64 PaAddressToRead, PVOID BufferToSaveMemory, SIZE_T SizeToRead)
+MemoryMapperCopyScatterGather(PMEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries, UINT32 CountOfEntries, BOOLEAN IsWrite)
 {
-    ULONG            ProcessorIndex = KeGetCurrentProcessorNumber();
-    PHYSICAL_ADDRESS PhysicalAddress;
+    MEMORY_MAPPER_WINDOW_BATCH Batch        = {0};
+    BOOLEAN                    IsIrqlRaised = FALSE;
+    PVIRTUAL_MACHINE_STATE     CurrentVmState;
+    PMEMORY_MAPPER_WINDOW      Window;
+    KIRQL                      OldIrql;
+    UINT64                     PhysicalAddress;
+    UCHAR *                    Buffer;
+    SIZE_T                     RemainingSize;
+    SIZE_T                     SizeInPage;
+    UINT32                     Slot;
+
+    //
+    // We shouldn't move to another core while using the window of the
+    // current core in vmx non-root
+    //
+    if (KeGetCurrentIrql() < DISPATCH_LEVEL && !g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode)
+    {
+        OldIrql      = KeRaiseIrqlToDpcLevel();
+        IsIrqlRaised = TRUE;
+    }
 
     //
-    // Check to see if PTE and Reserved VA already initialized
+    // The vm-exits might happen in the middle of a batch of vmx non-root,
+    // so the vm-exit handlers use another window and never change the
+    // pages of the interrupted batch
     //
-    if (g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress == NULL ||
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress == NULL)
+    CurrentVmState = &g_GuestState[KeGetCurrentProcessorNumber()];
+    Window         = &CurrentVmState->MemoryMapper.Windows[CurrentVmState->IsOnVmxRootMode ? MEMORY_MAPPER_WINDOW_VMX_ROOT : MEMORY_MAPPER_WINDOW_VMX_NON_ROOT];
+
+    //
+    // Check to see if the window already initialized
+    //
+    if (Window->VirtualAddress == NULL)
     {
         //
         // Not initialized
         //
+        if (IsIrqlRaised)
+        {
+            KeLowerIrql(OldIrql);
+        }
+
         return FALSE;
     }
 
-    PhysicalAddress.QuadPart = PaAddressToRead;
+    for (UINT32 i = 0; i < CountOfEntries; i++)
+    {
+        PhysicalAddress = Entries[i].PhysicalAddress;
+        Buffer          = Entries[i].Buffer;
+        RemainingSize   = Entries[i].Size;
 
-    return MemoryMapperReadMemorySafeByPte(
-        PhysicalAddress,
-        BufferToSaveMemory,
-        SizeToRead,
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress,
-        g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress,
-        g_GuestState[ProcessorIndex].IsOnVmxRootMode);
+        while (RemainingSize != 0)
+        {
+            //
+            // Each copy uses at most one new page, so if there is room for
+            // another copy then there is also a free page in the window
+            //
+            if (Batch.CountOfCopies == MEMORY_MAPPER_WINDOW_PAGES)
+            {
+                MemoryMapperWindowPerformBatch(Window, &Batch, IsWrite);
+            }
+
+            SizeInPage = min(RemainingSize, PAGE_SIZE - (PhysicalAddress & PAGE_4KB_OFFSET));
+            Slot       = MemoryMapperWindowMapPage(Window, &Batch, PhysicalAddress >> 12);
+
+            Batch.MappedAddresses[Batch.CountOfCopies] = (PVOID)(Window->VirtualAddress + (Slot * PAGE_SIZE) + (PhysicalAddress & PAGE_4KB_OFFSET));
+            Batch.Buffers[Batch.CountOfCopies]         = Buffer;
+            Batch.Sizes[Batch.CountOfCopies]           = SizeInPage;
+            Batch.CountOfCopies++;
+
+            PhysicalAddress += SizeInPage;
+            Buffer += SizeInPage;
+            RemainingSize -= SizeInPage;
+        }
+    }
+
+    MemoryMapperWindowPerformBatch(Window, &Batch, IsWrite);
+
+    if (IsIrqlRaised)
+    {
+        KeLowerIrql(OldIrql);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Read a list of physical memory ranges (scatter/gather)
+ *
+ * @details the ranges might cross the pages, this function CAN be called
+ * from vmx-root mode
+ *
+ * @param Entries List of the physical memory ranges and the buffers
+ * @param CountOfEntries Count of entries
+ * @return BOOLEAN returns TRUE if it was successfull and FALSE if there was error
+ */
+BOOLEAN
+MemoryMapperReadMemoryScatterGather(PMEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries, UINT32 CountOfEntries)
+{
+    return MemoryMapperCopyScatterGather(Entries, CountOfEntries, FALSE);
 }
+
 /**
- * @brief Read memory safely by mapping the buffer (It's a wrapper)
+ * @brief Write a list of physical memory ranges (scatter/gather)
+ *
+ * @details the ranges might cross the pages, this function CAN be called
+ * from vmx-root mode
+ *
+ * @param Entries List of the physical memory ranges and the buffers
+ * @param CountOfEntries Count of entries
+ * @return BOOLEAN returns TRUE if it was successfull and FALSE if there was error
+ */
+BOOLEAN
+MemoryMapperWriteMemoryScatterGather(PMEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries, UINT32 CountOfEntries)
+{
+    return MemoryMapperCopyScatterGather(Entries, CountOfEntries, TRUE);
+}
+
+/**
+ * @brief Read or write a virtual memory range by translating it page-by-page
+ * and copying the pages through the window of the memory mapper
+ *
+ * @param VirtualAddress Virtual address of the memory
+ * @param Buffer Buffer to read into or write from
+ * @param Size Size of the memory
+ * @param TargetProcessCr3 CR3 of target process (NULL means the current cr3)
+ * @param IsWrite Whether the buffer should be written to the memory or not
+ * @return BOOLEAN returns TRUE if it was successfull and FALSE if there was error
+ */
+BOOLEAN
+MemoryMapperCopyVirtualMemory(UINT64 VirtualAddress, PVOID Buffer, SIZE_T Size, CR3_TYPE TargetProcessCr3, BOOLEAN IsWrite)
+{
+    MEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries[MEMORY_MAPPER_WINDOW_PAGES];
+    UINT32                             CountOfEntries = 0;
+    UINT64                             PhysicalAddress;
+    SIZE_T                             SizeInPage;
+
+    while (Size != 0)
+    {
+        SizeInPage = min(Size, PAGE_SIZE - (VirtualAddress & PAGE_4KB_OFFSET));
+
+        if (TargetProcessCr3.Flags == NULL)
+        {
+            PhysicalAddress = VirtualAddressToPhysicalAddress(VirtualAddress);
+        }
+        else
+        {
+            PhysicalAddress = VirtualAddressToPhysicalAddressByProcessCr3(VirtualAddress, TargetProcessCr3);
+        }
+
+        if (PhysicalAddress == NULL)
+        {
+            //
+            // The page is not present
+            //
+            return FALSE;
+        }
+
+        //
+        // The pages which are physically contiguous are copied as one entry
+        //
+        if (CountOfEntries != 0 &&
+            Entries[CountOfEntries - 1].PhysicalAddress + Entries[CountOfEntries - 1].Size == PhysicalAddress)
+        {
+            Entries[CountOfEntries - 1].Size += SizeInPage;
+        }
+        else
+        {
+            if (CountOfEntries == MEMORY_MAPPER_WINDOW_PAGES)
+            {
+                if (!MemoryMapperCopyScatterGather(Entries, CountOfEntries, IsWrite))
+                {
+                    return FALSE;
+                }
+
+                CountOfEntries = 0;
+            }
+
+            Entries[CountOfEntries].PhysicalAddress = PhysicalAddress;
+            Entries[CountOfEntries].Buffer          = Buffer;
+            Entries[CountOfEntries].Size            = SizeInPage;
+            CountOfEntries++;
+        }
+
+        VirtualAddress += SizeInPage;
+        Buffer = (PVOID)((UINT64)Buffer + SizeInPage);
+        Size -= SizeInPage;
+    }
+
+    return MemoryMapperCopyScatterGather(Entries, CountOfEntries, IsWrite);
+}
+
+/**
+ * @brief Read memory safely by mapping the buffer by physical address (It's a wrapper)
  * 
- * @param VaAddressToRead Virtual Address to read
+ * @param PaAddressToRead Physical Address to read
  * @param BufferToSaveMemory Destination to save 
  * @param SizeToRead Size
  * @return BOOLEAN if it was successful the returns TRUE and if it was 
  * unsuccessful then it returns FALSE
  */
 BOOLEAN
-MemoryMapperReadMemorySafe(UINT64 VaAddressToRead, PVOID BufferToSaveMemory, SIZE_T SizeToRead)
+MemoryMapperReadMemorySafeByPhysicalAddress(UINT64 PaAddressToRead, PVOID BufferToSaveMemory, SIZE_T SizeToRead)
 {
-    ULONG            ProcessorIndex = KeGetCurrentProcessorNumber();
-    PHYSICAL_ADDRESS PhysicalAddress;
+    MEMORY_MAPPER_SCATTER_GATHER_ENTRY Entry;
+
+    Entry.PhysicalAddress = PaAddressToRead;
+    Entry.Buffer          = BufferToSaveMemory;
+    Entry.Size            = SizeToRead;
 
     //
-    // Check to see if PTE and Reserved VA already initialized
+    // The window maps all of the pages, even if the buffer crosses the
+    // page boundary
     //
-    if (g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress == NULL ||
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress == NULL)
-    {
-        //
-        // Not initialized
-        //
-        return FALSE;
-    }
+    return MemoryMapperReadMemoryScatterGather(&Entry, 1);
+}
 
-    PhysicalAddress.QuadPart = VirtualAddressToPhysicalAddress(VaAddressToRead);
+/**
+ * @brief Read memory safely by mapping the buffer (It's a wrapper)
+ * 
+ * @param VaAddressToRead Virtual Address to read
+ * @param BufferToSaveMemory Destination to save 
+ * @param SizeToRead Size
+ * @return BOOLEAN if it was successful the returns TRUE and if it was 
+ * unsuccessful then it returns FALSE
+ */
+BOOLEAN
+MemoryMapperReadMemorySafe(UINT64 VaAddressToRead, PVOID BufferToSaveMemory, SIZE_T SizeToRead)
+{
+    CR3_TYPE CurrentCr3 = {0};
 
-    return MemoryMapperReadMemorySafeByPte(
-        PhysicalAddress,
-        BufferToSaveMemory,
-        SizeToRead,
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress,
-        g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress,
-        g_GuestState[ProcessorIndex].IsOnVmxRootMode);
+    return MemoryMapperCopyVirtualMemory(VaAddressToRead, BufferToSaveMemory, SizeToRead, CurrentCr3, FALSE);
 }
 
 /**
@@ -688,37 +1071,7 @@ MemoryMapperWriteMemorySafeOnTargetProcess(UINT64 Destination, PVOID Source, SIZ
 BOOLEAN
 MemoryMapperWriteMemorySafe(UINT64 Destination, PVOID Source, SIZE_T SizeToRead, CR3_TYPE TargetProcessCr3)
 {
-    ULONG            ProcessorIndex = KeGetCurrentProcessorNumber();
-    PHYSICAL_ADDRESS PhysicalAddress;
-
-    //
-    // Check to see if PTE and Reserved VA already initialized
-    //
-    if (g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress == NULL ||
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress == NULL)
-    {
-        //
-        // Not initialized
-        //
-        return FALSE;
-    }
-
-    if (TargetProcessCr3.Flags == NULL)
-    {
-        PhysicalAddress.QuadPart = VirtualAddressToPhysicalAddress(Destination);
-    }
-    else
-    {
-        PhysicalAddress.QuadPart = VirtualAddressToPhysicalAddressByProcessCr3(Destination, TargetProcessCr3);
-    }
-
-    return MemoryMapperWriteMemorySafeByPte(
-        Source,
-        PhysicalAddress,
-        SizeToRead,
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress,
-        g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress,
-        g_GuestState[ProcessorIndex].IsOnVmxRootMode);
+    return MemoryMapperCopyVirtualMemory(Destination, Source, SizeToRead, TargetProcessCr3, TRUE);
 }
 
 /**
@@ -782,30 +1135,13 @@ MemoryMapperWriteMemoryUnsafe(UINT64 Destination, PVOID Source, SIZE_T SizeToRea
 BOOLEAN
 MemoryMapperWriteMemorySafeByPhysicalAddress(UINT64 DestinationPa, PVOID Source, SIZE_T SizeToRead)
 {
-    ULONG            ProcessorIndex = KeGetCurrentProcessorNumber();
-    PHYSICAL_ADDRESS PhysicalAddress;
+    MEMORY_MAPPER_SCATTER_GATHER_ENTRY Entry;
 
-    //
-    // Check to see if PTE and Reserved VA already initialized
-    //
-    if (g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress == NULL ||
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress == NULL)
-    {
-        //
-        // Not initialized
-        //
-        return FALSE;
-    }
+    Entry.PhysicalAddress = DestinationPa;
+    Entry.Buffer          = Source;
+    Entry.Size            = SizeToRead;
 
-    PhysicalAddress.QuadPart = DestinationPa;
-
-    return MemoryMapperWriteMemorySafeByPte(
-        Source,
-        PhysicalAddress,
-        SizeToRead,
-        g_GuestState[ProcessorIndex].MemoryMapper.PteVirtualAddress,
-        g_GuestState[ProcessorIndex].MemoryMapper.VirualAddress,
-        g_GuestState[ProcessorIndex].IsOnVmxRootMode);
+    return MemoryMapperWriteMemoryScatterGather(&Entry, 1);
 }
 
 /**
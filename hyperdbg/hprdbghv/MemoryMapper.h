@@ -23,6 +23,24 @@
 #define PAGE_4MB_OFFSET ((UINT64)(1 << 22) - 1)
 #define PAGE_1GB_OFFSET ((UINT64)(1 << 30) - 1)
 
+/**
+ * @brief Count of pages in the per-core window of the memory mapper
+ * @details a multi-page read or write maps a run of pages at once
+ *
+ */
+#define MEMORY_MAPPER_WINDOW_PAGES 16
+
+/**
+ * @brief Windows of each core of the memory mapper
+ * @details vmx-root and vmx non-root have separate windows, a vm-exit
+ * might happen in the middle of a batch of vmx non-root and the batch
+ * of the vm-exit handler shouldn't change the pages of that batch
+ *
+ */
+#define MEMORY_MAPPER_WINDOW_VMX_NON_ROOT 0
+#define MEMORY_MAPPER_WINDOW_VMX_ROOT     1
+#define MEMORY_MAPPER_COUNT_OF_WINDOWS    2
+
 //////////////////////////////////////////////////
 //					   Enums  					//
 //////////////////////////////////////////////////
@@ -43,16 +61,53 @@ typedef enum _PML
 //					Structures					//
 //////////////////////////////////////////////////
 
+/**
+ * @brief A window of pages of the memory mapper
+ *
+ */
+typedef struct _MEMORY_MAPPER_WINDOW
+{
+    UINT64 VirtualAddress;                                  // The reserved virtual address of the window of pages
+    UINT64 PteVirtualAddresses[MEMORY_MAPPER_WINDOW_PAGES]; // The virtual address of PTE of each page of the window
+} MEMORY_MAPPER_WINDOW, *PMEMORY_MAPPER_WINDOW;
+
 /**
  * @brief Memory mapper PTE and reserved virtual address
  * 
  */
 typedef struct _MEMORY_MAPPER_ADDRESSES
 {
-    UINT64 PteVirtualAddress; // The virtual address of PTE
-    UINT64 VirualAddress;     // The actual kernel virtual address to read or write
+    UINT64               PteVirtualAddress;                       // The virtual address of PTE
+    UINT64               VirualAddress;                           // The actual kernel virtual address to read or write
+    MEMORY_MAPPER_WINDOW Windows[MEMORY_MAPPER_COUNT_OF_WINDOWS]; // The windows of vmx non-root and vmx-root
 } MEMORY_MAPPER_ADDRESSES, *PMEMORY_MAPPER_ADDRESSES;
 
+/**
+ * @brief An entry of scatter/gather reads and writes
+ *
+ */
+typedef struct _MEMORY_MAPPER_SCATTER_GATHER_ENTRY
+{
+    UINT64 PhysicalAddress; // Physical address of the memory
+    PVOID  Buffer;          // Buffer to read into or write from
+    SIZE_T Size;            // Size of the memory (might cross the pages)
+} MEMORY_MAPPER_SCATTER_GATHER_ENTRY, *PMEMORY_MAPPER_SCATTER_GATHER_ENTRY;
+
+/**
+ * @brief Copies that are waiting for the pages of the window to be mapped
+ * @details the TLB entries of all of the mapped pages are invalidated
+ * at once, right before the copies of the batch
+ *
+ */
+typedef struct _MEMORY_MAPPER_WINDOW_BATCH
+{
+    UINT32 CountOfCopies;
+    UINT32 UsedSlots; // Bitmap of pages of the window that are mapped by the batch
+    PVOID  MappedAddresses[MEMORY_MAPPER_WINDOW_PAGES];
+    PVOID  Buffers[MEMORY_MAPPER_WINDOW_PAGES];
+    SIZE_T Sizes[MEMORY_MAPPER_WINDOW_PAGES];
+} MEMORY_MAPPER_WINDOW_BATCH, *PMEMORY_MAPPER_WINDOW_BATCH;
+
 /**
  * @brief Page Table Entry Structure
  * 
@@ -342,3 +397,9 @@ MemoryMapperWriteMemoryUnsafe(UINT64 Destination, PVOID Source, SIZE_T SizeToRea
 
 BOOLEAN
 MemoryMapperWriteMemorySafeByPhysicalAddress(UINT64 DestinationPa, PVOID Source, SIZE_T SizeToRead);
+
+BOOLEAN
+MemoryMapperReadMemoryScatterGather(PMEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries, UINT32 CountOfEntries);
+
+BOOLEAN
+MemoryMapperWriteMemoryScatterGather(PMEMORY_MAPPER_SCATTER_GATHER_ENTRY Entries, UINT32 CountOfEntries);
@@ -22,6 +22,7 @@ VOID
 MtfHandleVmexit(ULONG CurrentProcessorIndex, PGUEST_REGS GuestRegs)
 {
     BOOLEAN                          IsMtfForReApplySoftwareBreakpoint = FALSE;
+    BOOLEAN                          IsMtfForInstrumentTrace           = FALSE;
     DEBUGGER_TRIGGERED_EVENT_DETAILS ContextAndTag                     = {0};
     BOOLEAN                          AvoidUnsetMtf;
     UINT16                           CsSel;
@@ -72,6 +73,11 @@ MtfHandleVmexit(ULONG CurrentProcessorIndex, PGUEST_REGS GuestRegs)
         g_GuestState[CurrentProcessorIndex].DebuggingState.SoftwareBreakpointState = NULL;
     }
 
+    //
+    // Check if the core is tracing instructions
+    //
+    IsMtfForInstrumentTrace = g_InstrumentTrace.IsActive && g_InstrumentTrace.CoreId == CurrentProcessorIndex;
+
     //
     // *** Regular Monitor Trap Flag functionalities ***
     //
@@ -137,11 +143,53 @@ MtfHandleVmexit(ULONG CurrentProcessorIndex, PGUEST_REGS GuestRegs)
         SteppingsHandleThreadChanges(GuestRegs, CurrentProcessorIndex);
         g_GuestState[CurrentProcessorIndex].MtfTest = FALSE;
     }
-    else if (!IsMtfForReApplySoftwareBreakpoint)
+    else if (!IsMtfForReApplySoftwareBreakpoint && !IsMtfForInstrumentTrace)
     {
         LogError("Why MTF occurred?!");
     }
 
+    //
+    // Handle the traced instruction, we check it separately because the traced
+    // instruction might also need other MTF functionalities (e.g. restoring EPT
+    // hooks) and the debuggee might be halted here
+    //
+    if (IsMtfForInstrumentTrace)
+    {
+        if (InstrumentTraceHandleStep(CurrentProcessorIndex, GuestRegs))
+        {
+            //
+            // Continue tracing, not unset MTF
+            //
+            g_GuestState[CurrentProcessorIndex].IgnoreMtfUnset = TRUE;
+        }
+        else
+        {
+            //
+            // The trace is finished, check and handle if there is a software
+            // defined breakpoint, otherwise halt the debuggee
+            //
+            if (!BreakpointCheckAndHandleDebuggerDefinedBreakpoints(CurrentProcessorIndex,
+                                                                    g_GuestState[CurrentProcessorIndex].LastVmexitRip,
+                                                                    DEBUGGEE_PAUSING_REASON_DEBUGGEE_STEPPED,
+                                                                    GuestRegs,
+                                                                    &AvoidUnsetMtf))
+            {
+                ContextAndTag.Context = g_GuestState[CurrentProcessorIndex].LastVmexitRip;
+                KdHandleBreakpointAndDebugBreakpoints(CurrentProcessorIndex,
+                                                      GuestRegs,
+                                                      DEBUGGEE_PAUSING_REASON_DEBUGGEE_STEPPED,
+                                                      &ContextAndTag);
+            }
+            else
+            {
+                //
+                // Not unset again (it needs to restore the breakpoint byte)
+                //
+                g_GuestState[CurrentProcessorIndex].IgnoreMtfUnset = AvoidUnsetMtf;
+            }
+        }
+    }
+
     //
     // Final check to unset mtf
     //
@@ -0,0 +1,551 @@
+/**
+ * @file PendingControls.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Lazy updates of the execution controls of each core
+ * @details The changes of the VMCS controls, the exception bitmap and the
+ * MSR and I/O bitmaps are queued for the target cores instead of sending a
+ * DPC to the cores for each of the changes. Each core applies its pending
+ * updates (in order) at its next vm-exit, the updates that are superseded
+ * by a later update of the same control are removed from the queue and if
+ * the updates are requested in a batch, the cores are kicked once when the
+ * batch of the thread is finished
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Get the control that an update changes
+ *
+ * @param VmcallNumber The VMCALL that applies the update
+ * @param IsReset Whether the update overwrites the whole control or not
+ * @return PENDING_CONTROLS_FAMILY
+ */
+PENDING_CONTROLS_FAMILY
+PendingControlsGetFamily(UINT64 VmcallNumber, BOOLEAN * IsReset)
+{
+    *IsReset = FALSE;
+
+    switch (VmcallNumber)
+    {
+    case VMCALL_ENABLE_SYSCALL_HOOK_EFER:
+    case VMCALL_DISABLE_SYSCALL_HOOK_EFER:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_EFER_SYSCALL_HOOK;
+
+    case VMCALL_ENABLE_MOV_TO_CR3_EXITING:
+    case VMCALL_DISABLE_MOV_TO_CR3_EXITING:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_MOV_TO_CR3_EXITING;
+
+    case VMCALL_SET_RDTSC_EXITING:
+    case VMCALL_UNSET_RDTSC_EXITING:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_RDTSC_EXITING;
+
+    case VMCALL_SET_RDPMC_EXITING:
+    case VMCALL_UNSET_RDPMC_EXITING:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_RDPMC_EXITING;
+
+    case VMCALL_ENABLE_MOV_TO_DEBUG_REGS_EXITING:
+    case VMCALL_DISABLE_MOV_TO_DEBUG_REGS_EXITING:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_MOV_TO_DEBUG_REGS_EXITING;
+
+    case VMCALL_ENABLE_EXTERNAL_INTERRUPT_EXITING:
+    case VMCALL_DISABLE_EXTERNAL_INTERRUPT_EXITING:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_EXTERNAL_INTERRUPT_EXITING;
+
+    case VMCALL_SET_VM_EXIT_ON_NMIS:
+    case VMCALL_UNSET_VM_EXIT_ON_NMIS:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_NMI_EXITING;
+
+    case VMCALL_RESET_EXCEPTION_BITMAP:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_EXCEPTION_BITMAP;
+
+    case VMCALL_SET_EXCEPTION_BITMAP:
+    case VMCALL_UNSET_EXCEPTION_BITMAP:
+        return PENDING_CONTROLS_FAMILY_EXCEPTION_BITMAP;
+
+    case VMCALL_RESET_MSR_BITMAP_READ:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_MSR_BITMAP_READ;
+
+    case VMCALL_CHANGE_MSR_BITMAP_READ:
+        return PENDING_CONTROLS_FAMILY_MSR_BITMAP_READ;
+
+    case VMCALL_RESET_MSR_BITMAP_WRITE:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_MSR_BITMAP_WRITE;
+
+    case VMCALL_CHANGE_MSR_BITMAP_WRITE:
+        return PENDING_CONTROLS_FAMILY_MSR_BITMAP_WRITE;
+
+    case VMCALL_RESET_IO_BITMAP:
+        *IsReset = TRUE;
+        return PENDING_CONTROLS_FAMILY_IO_BITMAP;
+
+    case VMCALL_CHANGE_IO_BITMAP:
+        return PENDING_CONTROLS_FAMILY_IO_BITMAP;
+
+    default:
+        return PENDING_CONTROLS_FAMILY_UNSUPPORTED;
+    }
+}
+
+/**
+ * @brief Insert an update to the pending updates of a core
+ * @details The lock of the pending updates should be held by the caller,
+ * the pending updates that are superseded by the new update are removed
+ *
+ * @param PendingControls The pending updates of the target core
+ * @param VmcallNumber The VMCALL that applies the update
+ * @param Parameter Parameter of the VMCALL
+ * @return BOOLEAN Returns FALSE if there is no room for the update
+ */
+BOOLEAN
+PendingControlsInsertRequest(PPENDING_CONTROLS PendingControls, UINT64 VmcallNumber, UINT64 Parameter)
+{
+    PENDING_CONTROLS_FAMILY Family;
+    PENDING_CONTROLS_FAMILY PendingFamily;
+    BOOLEAN                 IsReset;
+    BOOLEAN                 IsPendingReset;
+    UINT32                  Count = 0;
+
+    Family = PendingControlsGetFamily(VmcallNumber, &IsReset);
+
+    //
+    // Changing all of the exceptions, the MSRs or the I/O ports overwrites
+    // the whole bitmap
+    //
+    if ((Family == PENDING_CONTROLS_FAMILY_EXCEPTION_BITMAP && Parameter == DEBUGGER_EVENT_EXCEPTIONS_ALL_FIRST_32_ENTRIES) ||
+        (Family == PENDING_CONTROLS_FAMILY_MSR_BITMAP_READ && Parameter == DEBUGGER_EVENT_MSR_READ_OR_WRITE_ALL_MSRS) ||
+        (Family == PENDING_CONTROLS_FAMILY_MSR_BITMAP_WRITE && Parameter == DEBUGGER_EVENT_MSR_READ_OR_WRITE_ALL_MSRS) ||
+        (Family == PENDING_CONTROLS_FAMILY_IO_BITMAP && Parameter == DEBUGGER_EVENT_ALL_IO_PORTS))
+    {
+        IsReset = TRUE;
+    }
+
+    //
+    // Remove the pending updates that are superseded by this update, a reset
+    // supersedes all of the updates of its control, otherwise only the
+    // updates of the same entry of the bitmap are superseded. The updates
+    // that don't belong to a family (e.g., switching to the private bitmaps)
+    // are never superseded and never supersede other updates
+    //
+    if (Family == PENDING_CONTROLS_FAMILY_UNSUPPORTED)
+    {
+        Count = PendingControls->CountOfRequests;
+    }
+    else
+    {
+        for (UINT32 i = 0; i < PendingControls->CountOfRequests; i++)
+        {
+            PendingFamily = PendingControlsGetFamily(PendingControls->Requests[i].VmcallNumber, &IsPendingReset);
+
+            if (PendingFamily == Family &&
+                (IsReset || (!IsPendingReset && PendingControls->Requests[i].Parameter == Parameter)))
+            {
+                PendingControls->CountOfCoalescedUpdates++;
+                continue;
+            }
+
+            PendingControls->Requests[Count++] = PendingControls->Requests[i];
+        }
+
+        PendingControls->CountOfRequests = Count;
+    }
+
+    if (Count == PENDING_CONTROLS_MAXIMUM_REQUESTS)
+    {
+        return FALSE;
+    }
+
+    PendingControls->Requests[Count].VmcallNumber = VmcallNumber;
+    PendingControls->Requests[Count].Parameter    = Parameter;
+    PendingControls->CountOfRequests++;
+
+    PendingControls->CountOfRequestedUpdates++;
+
+    return TRUE;
+}
+
+/**
+ * @brief Apply the pending updates of the current core
+ * @details Should be called from vmx-root, the lock of the pending updates
+ * should be held by the caller
+ *
+ * @param CoreIndex Index of the current core
+ * @param GuestRegs Guest registers
+ * @return VOID
+ */
+VOID
+PendingControlsApplyRequests(UINT32 CoreIndex, PGUEST_REGS GuestRegs)
+{
+    PPENDING_CONTROLS PendingControls = &g_GuestState[CoreIndex].PendingControls;
+
+    for (UINT32 i = 0; i < PendingControls->CountOfRequests; i++)
+    {
+        VmxVmcallHandler(PendingControls->Requests[i].VmcallNumber,
+                         PendingControls->Requests[i].Parameter,
+                         0,
+                         0,
+                         GuestRegs,
+                         CoreIndex);
+    }
+
+    PendingControls->CountOfAppliedUpdates += PendingControls->CountOfRequests;
+    PendingControls->CountOfRequests = 0;
+}
+
+/**
+ * @brief Insert an update to the pending updates of a core that has no
+ * room for more updates from vmx-root
+ * @details The cores can't be kicked from vmx-root and the current core
+ * shouldn't wait for another core in vmx-root (that core might be waiting
+ * for the current core, e.g., halted by the debugger), so only the pending
+ * updates of the current core are applied here to make room, the updates of
+ * other cores fail like the updates of vmx non-root
+ *
+ * @param CoreIndex The target core
+ * @param VmcallNumber The VMCALL that applies the update
+ * @param Parameter Parameter of the VMCALL
+ * @return BOOLEAN Returns FALSE if there is no room for the update
+ */
+BOOLEAN
+PendingControlsInsertRequestOnVmxRoot(UINT32 CoreIndex, UINT64 VmcallNumber, UINT64 Parameter)
+{
+    PPENDING_CONTROLS PendingControls = &g_GuestState[CoreIndex].PendingControls;
+    BOOLEAN           Result;
+
+    if (CoreIndex != KeGetCurrentProcessorNumber())
+    {
+        return FALSE;
+    }
+
+    SpinlockLock(&PendingControls->Lock);
+
+    PendingControlsApplyRequests(CoreIndex, NULL);
+
+    Result = PendingControlsInsertRequest(PendingControls, VmcallNumber, Parameter);
+
+    SpinlockUnlock(&PendingControls->Lock);
+
+    return Result;
+}
+
+/**
+ * @brief Request an update of the controls of a core or all of the cores
+ * @details Can be called from both vmx-root and vmx non-root, if it's
+ * called from vmx non-root and the current thread is not in a batch then
+ * the cores are kicked to apply the update immediately, otherwise the
+ * update is applied at the next vm-exit of the target cores
+ *
+ * @param CoreId The target core or PENDING_CONTROLS_ALL_CORES
+ * @param VmcallNumber The VMCALL that applies the update
+ * @param Parameter Parameter of the VMCALL
+ * @return BOOLEAN Returns FALSE if the update can't be queued for a core
+ */
+BOOLEAN
+PendingControlsRequest(UINT32 CoreId, UINT64 VmcallNumber, UINT64 Parameter)
+{
+    PPENDING_CONTROLS PendingControls;
+    KIRQL             OldIrql;
+    BOOLEAN           IsOnVmxRoot;
+    BOOLEAN           Result;
+    BOOLEAN           IsSuccessful    = TRUE;
+    UINT32            ProcessorsCount = KeQueryActiveProcessorCount(0);
+
+    //
+    // The exception bitmap of the breakpoints is changed by the same handlers
+    // as the other exceptions
+    //
+    if (VmcallNumber == VMCALL_ENABLE_BREAKPOINT_ON_EXCEPTION_BITMAP)
+    {
+        VmcallNumber = VMCALL_SET_EXCEPTION_BITMAP;
+        Parameter    = EXCEPTION_VECTOR_BREAKPOINT;
+    }
+    else if (VmcallNumber == VMCALL_DISABLE_BREAKPOINT_ON_EXCEPTION_BITMAP)
+    {
+        VmcallNumber = VMCALL_UNSET_EXCEPTION_BITMAP;
+        Parameter    = EXCEPTION_VECTOR_BREAKPOINT;
+    }
+
+    IsOnVmxRoot = g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode;
+
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        if (CoreId != PENDING_CONTROLS_ALL_CORES && CoreId != i)
+        {
+            continue;
+        }
+
+        PendingControls = &g_GuestState[i].PendingControls;
+
+        //
+        // The target core applies its updates from vm-exits, the lock should
+        // not be held when a DPC is executed on the current core
+        //
+        if (!IsOnVmxRoot)
+        {
+            KeRaiseIrql(DISPATCH_LEVEL, &OldIrql);
+        }
+
+        SpinlockLock(&PendingControls->Lock);
+        Result = PendingControlsInsertRequest(PendingControls, VmcallNumber, Parameter);
+        SpinlockUnlock(&PendingControls->Lock);
+
+        if (!IsOnVmxRoot)
+        {
+            KeLowerIrql(OldIrql);
+        }
+
+        if (Result)
+        {
+            continue;
+        }
+
+        if (IsOnVmxRoot)
+        {
+            //
+            // There is no room, only the pending updates of the current core
+            // can be applied from vmx-root
+            //
+            Result = PendingControlsInsertRequestOnVmxRoot(i, VmcallNumber, Parameter);
+        }
+        else
+        {
+            //
+            // There is no room, apply the pending updates and retry
+            //
+            PendingControlsKick();
+
+            KeRaiseIrql(DISPATCH_LEVEL, &OldIrql);
+            SpinlockLock(&PendingControls->Lock);
+            Result = PendingControlsInsertRequest(PendingControls, VmcallNumber, Parameter);
+            SpinlockUnlock(&PendingControls->Lock);
+            KeLowerIrql(OldIrql);
+        }
+
+        if (!Result)
+        {
+            LogError("Err, unable to queue the update of the controls of core %d as there are too many pending updates",
+                     i);
+            IsSuccessful = FALSE;
+        }
+    }
+
+    if (!IsOnVmxRoot && !PendingControlsIsInBatch())
+    {
+        PendingControlsKick();
+    }
+
+    return IsSuccessful;
+}
+
+/**
+ * @brief Find the batch of the current thread
+ *
+ * @return PPENDING_CONTROLS_BATCH Returns NULL if the thread is not in a batch
+ */
+PPENDING_CONTROLS_BATCH
+PendingControlsFindBatch()
+{
+    PVOID CurrentThread = PsGetCurrentThread();
+
+    for (UINT32 i = 0; i < PENDING_CONTROLS_MAXIMUM_BATCHES; i++)
+    {
+        if (g_PendingControlsBatches[i].Thread == CurrentThread)
+        {
+            return &g_PendingControlsBatches[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check whether the current thread is in a batch or not
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+PendingControlsIsInBatch()
+{
+    return PendingControlsFindBatch() != NULL;
+}
+
+/**
+ * @brief Begin a batch of updates (or a nested batch)
+ * @details Each call should be paired with PendingControlsEndBatch on the
+ * same thread, the batches of other threads are not affected. The updates
+ * that are requested from vmx-root are never kicked so there is no batch
+ * in vmx-root
+ *
+ * @return VOID
+ */
+VOID
+PendingControlsBeginBatch()
+{
+    PPENDING_CONTROLS_BATCH Batch;
+    PVOID                   CurrentThread;
+
+    if (g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode)
+    {
+        return;
+    }
+
+    Batch = PendingControlsFindBatch();
+
+    if (Batch != NULL)
+    {
+        Batch->Depth++;
+        return;
+    }
+
+    CurrentThread = PsGetCurrentThread();
+
+    for (UINT32 i = 0; i < PENDING_CONTROLS_MAXIMUM_BATCHES; i++)
+    {
+        if (InterlockedCompareExchangePointer(&g_PendingControlsBatches[i].Thread, CurrentThread, NULL) == NULL)
+        {
+            g_PendingControlsBatches[i].Depth = 1;
+            return;
+        }
+    }
+
+    //
+    // There is no free batch, the updates of this thread are applied
+    // immediately (without a batch)
+    //
+}
+
+/**
+ * @brief Finish a batch of updates
+ * @details If it's the outermost batch of the current thread then the
+ * cores are kicked to apply all of the pending updates at once
+ *
+ * @return VOID
+ */
+VOID
+PendingControlsEndBatch()
+{
+    PPENDING_CONTROLS_BATCH Batch;
+
+    if (g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode)
+    {
+        return;
+    }
+
+    Batch = PendingControlsFindBatch();
+
+    if (Batch == NULL || --Batch->Depth != 0)
+    {
+        return;
+    }
+
+    InterlockedExchangePointer(&Batch->Thread, NULL);
+
+    PendingControlsKick();
+}
+
+/**
+ * @brief Kick the cores that have pending updates to apply them
+ * @details Should be called from vmx non-root, returns after all of the
+ * cores applied their updates
+ *
+ * @return VOID
+ */
+VOID
+PendingControlsKick()
+{
+    BOOLEAN IsPending       = FALSE;
+    UINT32  ProcessorsCount = KeQueryActiveProcessorCount(0);
+
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        if (g_GuestState[i].PendingControls.CountOfRequests != 0)
+        {
+            IsPending = TRUE;
+            break;
+        }
+    }
+
+    if (!IsPending)
+    {
+        return;
+    }
+
+    InterlockedIncrement64(&g_PendingControlsCountOfKicks);
+
+    //
+    // Broadcast to the cores to apply their updates
+    //
+    KeGenericCallDpc(BroadcastDpcApplyPendingControls, NULL);
+}
+
+/**
+ * @brief Apply the pending updates of the current core
+ * @details Should be called from vmx-root, if the updates are being
+ * changed by another core (or by the current core before the vm-exit) and
+ * the caller doesn't wait for them, they're applied in the next vm-exit
+ *
+ * @param CoreIndex Index of the current core
+ * @param GuestRegs Guest registers
+ * @param Wait Wait for the lock of the pending updates
+ * @return VOID
+ */
+VOID
+PendingControlsApply(UINT32 CoreIndex, PGUEST_REGS GuestRegs, BOOLEAN Wait)
+{
+    PPENDING_CONTROLS PendingControls = &g_GuestState[CoreIndex].PendingControls;
+
+    if (PendingControls->CountOfRequests == 0)
+    {
+        return;
+    }
+
+    if (Wait)
+    {
+        SpinlockLock(&PendingControls->Lock);
+    }
+    else if (!SpinlockTryLock(&PendingControls->Lock))
+    {
+        return;
+    }
+
+    PendingControlsApplyRequests(CoreIndex, GuestRegs);
+
+    SpinlockUnlock(&PendingControls->Lock);
+}
+
+/**
+ * @brief Show the statistics of the updates of the controls
+ *
+ * @return VOID
+ */
+VOID
+PendingControlsLogCounters()
+{
+    UINT32 ProcessorsCount = KeQueryActiveProcessorCount(0);
+
+    LogDebugInfo("Pending controls kicks: %lld", g_PendingControlsCountOfKicks);
+
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        LogDebugInfo("Pending controls of core %d, requested: %lld, coalesced: %lld, applied: %lld, pending: %d",
+                     i,
+                     g_GuestState[i].PendingControls.CountOfRequestedUpdates,
+                     g_GuestState[i].PendingControls.CountOfCoalescedUpdates,
+                     g_GuestState[i].PendingControls.CountOfAppliedUpdates,
+                     g_GuestState[i].PendingControls.CountOfRequests);
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * @file PendingControls.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the lazy updates of the execution controls of each core
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum count of the pending updates of each core, if there are
+ * more updates then the core is kicked to apply the pending updates
+ *
+ */
+#define PENDING_CONTROLS_MAXIMUM_REQUESTS 64
+
+/**
+ * @brief Apply the update on all of the cores
+ *
+ */
+#define PENDING_CONTROLS_ALL_CORES 0xffffffff
+
+/**
+ * @brief Maximum count of the threads that are in a batch at the same time,
+ * the updates of other threads are applied immediately
+ *
+ */
+#define PENDING_CONTROLS_MAXIMUM_BATCHES 16
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The controls that the updates change, the updates of a family
+ * might supersede each other
+ *
+ */
+typedef enum _PENDING_CONTROLS_FAMILY
+{
+    PENDING_CONTROLS_FAMILY_UNSUPPORTED,
+    PENDING_CONTROLS_FAMILY_EFER_SYSCALL_HOOK,
+    PENDING_CONTROLS_FAMILY_MOV_TO_CR3_EXITING,
+    PENDING_CONTROLS_FAMILY_RDTSC_EXITING,
+    PENDING_CONTROLS_FAMILY_RDPMC_EXITING,
+    PENDING_CONTROLS_FAMILY_MOV_TO_DEBUG_REGS_EXITING,
+    PENDING_CONTROLS_FAMILY_EXTERNAL_INTERRUPT_EXITING,
+    PENDING_CONTROLS_FAMILY_NMI_EXITING,
+    PENDING_CONTROLS_FAMILY_EXCEPTION_BITMAP,
+    PENDING_CONTROLS_FAMILY_MSR_BITMAP_READ,
+    PENDING_CONTROLS_FAMILY_MSR_BITMAP_WRITE,
+    PENDING_CONTROLS_FAMILY_IO_BITMAP,
+
+} PENDING_CONTROLS_FAMILY;
+
+/**
+ * @brief A pending update, it's applied by the handler of its VMCALL
+ *
+ */
+typedef struct _PENDING_CONTROLS_REQUEST
+{
+    UINT64 VmcallNumber; // The VMCALL that applies the update
+    UINT64 Parameter;    // Parameter of the VMCALL
+
+} PENDING_CONTROLS_REQUEST, *PPENDING_CONTROLS_REQUEST;
+
+/**
+ * @brief Pending updates of the controls of a core
+ * @details The updates are applied in order by the core at its next vm-exit
+ *
+ */
+typedef struct _PENDING_CONTROLS
+{
+    volatile LONG            Lock;                                        // Lock of the pending updates
+    volatile LONG            CountOfRequests;                             // Count of the pending updates
+    PENDING_CONTROLS_REQUEST Requests[PENDING_CONTROLS_MAXIMUM_REQUESTS]; // The pending updates
+    volatile LONG64          CountOfRequestedUpdates;                     // Count of the updates that are requested
+    volatile LONG64          CountOfCoalescedUpdates;                     // Count of the updates that are superseded before they're applied
+    volatile LONG64          CountOfAppliedUpdates;                       // Count of the updates that are applied
+
+} PENDING_CONTROLS, *PPENDING_CONTROLS;
+
+/**
+ * @brief A batch of updates of a thread
+ *
+ */
+typedef struct _PENDING_CONTROLS_BATCH
+{
+    volatile PVOID Thread; // The thread that owns the batch (NULL if the batch is free)
+    LONG           Depth;  // Count of the nested batches of the thread
+
+} PENDING_CONTROLS_BATCH, *PPENDING_CONTROLS_BATCH;
+
+//////////////////////////////////////////////////
+//                   Variables	    			//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Batches of the threads, the cores are kicked once the outermost
+ * batch of a thread is finished
+ *
+ */
+PENDING_CONTROLS_BATCH g_PendingControlsBatches[PENDING_CONTROLS_MAXIMUM_BATCHES];
+
+/**
+ * @brief Count of the broadcasts that kicked the cores to apply their
+ * pending updates
+ *
+ */
+volatile LONG64 g_PendingControlsCountOfKicks;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+PENDING_CONTROLS_FAMILY
+PendingControlsGetFamily(UINT64 VmcallNumber, BOOLEAN * IsReset);
+
+BOOLEAN
+PendingControlsInsertRequest(PPENDING_CONTROLS PendingControls, UINT64 VmcallNumber, UINT64 Parameter);
+
+VOID
+PendingControlsApplyRequests(UINT32 CoreIndex, PGUEST_REGS GuestRegs);
+
+BOOLEAN
+PendingControlsInsertRequestOnVmxRoot(UINT32 CoreIndex, UINT64 VmcallNumber, UINT64 Parameter);
+
+BOOLEAN
+PendingControlsRequest(UINT32 CoreId, UINT64 VmcallNumber, UINT64 Parameter);
+
+VOID
+PendingControlsBeginBatch();
+
+VOID
+PendingControlsEndBatch();
+
+PPENDING_CONTROLS_BATCH
+PendingControlsFindBatch();
+
+BOOLEAN
+PendingControlsIsInBatch();
+
+VOID
+PendingControlsKick();
+
+VOID
+PendingControlsApply(UINT32 CoreIndex, PGUEST_REGS GuestRegs, BOOLEAN Wait);
+
+VOID
+PendingControlsLogCounters();
@@ -3,45 +3,64 @@
  * @author Sina Karvandi (sina@rayanfam.com)
  * @brief The pool manager used in vmx root
  * @details As we cannot allocate pools in vmx root, we need a pool
- * manager to manage the pools
- * 
+ * manager to manage the pools; each intention has a cache of the slab
+ * allocator, the objects are allocated and freed in vmx-root and the
+ * caches are grown in vmx non-root (on the next IOCTL)
+ *
  * @version 0.1
  * @date 2020-04-11
- * 
+ *
  * @copyright This project is released under the GNU Public License v3.
- * 
+ *
  */
 #include "pch.h"
 
+/**
+ * @brief Allocate an arena (or the magazines) of the slab allocator
+ *
+ * @param Size Size of the memory
+ * @return PVOID
+ */
+PVOID
+PoolManagerAllocateMemory(SIZE_T Size)
+{
+    return ExAllocatePoolWithTag(NonPagedPool, Size, POOLTAG);
+}
+
+/**
+ * @brief Free an arena (or the magazines) of the slab allocator
+ *
+ * @param Memory The memory
+ * @return VOID
+ */
+VOID
+PoolManagerFreeMemory(PVOID Memory)
+{
+    ExFreePoolWithTag(Memory, POOLTAG);
+}
+
 /**
  * @brief Initializes the pool manager
- * 
- * @return BOOLEAN 
+ *
+ * @return BOOLEAN
  */
 BOOLEAN
 PoolManagerInitialize()
 {
     //
-    // Allocate global requesting variable
+    // Initialize the allocator, each core has its own magazines
     //
-    g_RequestNewAllocation = ExAllocatePoolWithTag(NonPagedPool, MaximumRequestsQueueDepth * sizeof(REQUEST_NEW_ALLOCATION), POOLTAG);
-
-    if (!g_RequestNewAllocation)
-    {
-        LogError("Insufficient memory");
-        return FALSE;
-    }
-    RtlZeroMemory(g_RequestNewAllocation, MaximumRequestsQueueDepth * sizeof(REQUEST_NEW_ALLOCATION));
+    SlabInitializeAllocator(&g_PoolManagerAllocator,
+                            KeQueryActiveProcessorCount(0),
+                            PoolManagerAllocateMemory,
+                            PoolManagerFreeMemory);
 
-    //
-    // Initialize list head
-    //
-    InitializeListHead(&g_ListOfAllocatedPoolsHead);
+    RtlZeroMemory(g_PoolManagerCaches, sizeof(g_PoolManagerCaches));
 
     //
-    // Request pages to be allocated for converting 2MB to 4KB pages
+    // Request pages to be allocated for converting 1GB to 2MB pages
     //
-    PoolManagerRequestAllocation(sizeof(VMM_EPT_DYNAMIC_SPLIT), 5, SPLIT_2MB_PAGING_TO_4KB_PAGE);
+    PoolManagerRequestAllocation(sizeof(VMM_EPT_PML2_TABLE), 5, SPLIT_1GB_PAGING_TO_2MB_PAGE);
 
     //
     // Request pages to be allocated for paged hook details
@@ -83,98 +102,65 @@ PoolManagerInitialize()
 
 /**
  * @brief Uninitialize the pool manager (free the buffers, etc.)
- * 
- * @return VOID 
+ *
+ * @return VOID
  */
 VOID
 PoolManagerUninitialize()
 {
-    PLIST_ENTRY ListTemp = 0;
-    UINT64      Address  = 0;
-    ListTemp             = &g_ListOfAllocatedPoolsHead;
-
-    while (&g_ListOfAllocatedPoolsHead != ListTemp->Flink)
+    for (UINT32 i = 0; i < POOL_ALLOCATION_INTENTION_COUNT; i++)
     {
-        ListTemp = ListTemp->Flink;
-
-        //
-        // Get the head of the record
-        //
-        PPOOL_TABLE PoolTable = (PPOOL_TABLE)CONTAINING_RECORD(ListTemp, POOL_TABLE, PoolsList);
-
-        //
-        // Free the alloocated buffer (if not already changed)
-        //
-        if (!PoolTable->AlreadyFreed)
+        if (g_PoolManagerCaches[i].IsInitialized)
         {
-            ExFreePoolWithTag(PoolTable->Address, POOLTAG);
+            LogDebugInfo("Pool manager cache %d, object size: 0x%x, slabs: %lld, free objects: %lld, exhaustions: %lld",
+                         i,
+                         g_PoolManagerCaches[i].Slabs.ObjectSize,
+                         g_PoolManagerCaches[i].Slabs.CountOfSlabs,
+                         g_PoolManagerCaches[i].Slabs.FreeObjects,
+                         g_PoolManagerCaches[i].Slabs.Exhaustions);
+
+            SlabUninitializeCache(&g_PoolManagerAllocator, &g_PoolManagerCaches[i].Slabs);
         }
-
-        //
-        // Unlink the PoolTable
-        //
-        RemoveEntryList(&PoolTable->PoolsList);
-
-        //
-        // Free the record itself
-        //
-        ExFreePoolWithTag(PoolTable, POOLTAG);
     }
 
-    ExFreePoolWithTag(g_RequestNewAllocation, POOLTAG);
+    //
+    // Free the slabs of all of the caches
+    //
+    SlabUninitializeAllocator(&g_PoolManagerAllocator);
+
+    RtlZeroMemory(g_PoolManagerCaches, sizeof(g_PoolManagerCaches));
 }
 
 /**
  * @brief This function set a pool flag to be freed, and it will be freed
  * on the next IOCTL when it's safe to remove
- * 
+ * @details The pool is not reused until the next IOCTL as some threads might
+ * still use it, the address is validated by the directory of the slabs
+ *
  * @param AddressToFree The pool address that was previously obtained from the pool manager
- * @return BOOLEAN If the address was already in the list of allocated pools by pool 
- * manager then it returns TRUE; otherwise, FALSE
+ * @return BOOLEAN If the address was allocated by the pool manager (and is not already
+ * freed) then it returns TRUE; otherwise, FALSE
  */
 BOOLEAN
 PoolManagerFreePool(UINT64 AddressToFree)
 {
-    PLIST_ENTRY ListTemp = 0;
-    BOOLEAN     Result   = FALSE;
-    ListTemp             = &g_ListOfAllocatedPoolsHead;
-
-    SpinlockLock(&LockForReadingPool);
-
-    while (&g_ListOfAllocatedPoolsHead != ListTemp->Flink)
+    if (!SlabDeferFree(&g_PoolManagerAllocator, (PVOID)AddressToFree))
     {
-        ListTemp = ListTemp->Flink;
-
-        //
-        // Get the head of the record
-        //
-        PPOOL_TABLE PoolTable = (PPOOL_TABLE)CONTAINING_RECORD(ListTemp, POOL_TABLE, PoolsList);
-
-        if (PoolTable->Address == AddressToFree)
-        {
-            //
-            // We found an entry that matched the detailed from
-            // previously allocated pools
-            //
-            PoolTable->ShouldBeFreed = TRUE;
-            Result                   = TRUE;
-
-            g_IsNewRequestForDeAllocation = TRUE;
-            break;
-        }
+        return FALSE;
     }
 
-    SpinlockUnlock(&LockForReadingPool);
-    return Result;
+    g_IsNewRequestForDeAllocation = TRUE;
+
+    return TRUE;
 }
 
 /**
  * @brief This function should be called from vmx-root in order to get a pool from the list
  * @details If RequestNewPool is TRUE then Size is used, otherwise Size is useless
  * Note : Most of the times this function called from vmx root but not all the time
- * 
+ *
  * @param Intention The intention why we need this pool for (buffer tag)
- * @param RequestNewPool Create a request to allocate a new pool with the same size, next time
+ * @param RequestNewPool Create a request to refill the pools of this intention, next time
  * that it's safe to allocate (this way we never ran out of pools for this "Intention")
  * @param Size If the RequestNewPool is true the we should specify a size for the new pool
  * @return UINT64 Returns a pool address or retuns null if there was an error
@@ -182,109 +168,55 @@ PoolManagerFreePool(UINT64 AddressToFree)
 UINT64
 PoolManagerRequestPool(POOL_ALLOCATION_INTENTION Intention, BOOLEAN RequestNewPool, UINT32 Size)
 {
-    PLIST_ENTRY ListTemp = 0;
-    UINT64      Address  = 0;
-    ListTemp             = &g_ListOfAllocatedPoolsHead;
-
-    SpinlockLock(&LockForReadingPool);
+    PPOOL_MANAGER_CACHE Cache;
+    PVOID               Address = NULL;
 
-    while (&g_ListOfAllocatedPoolsHead != ListTemp->Flink)
+    if (Intention >= POOL_ALLOCATION_INTENTION_COUNT)
     {
-        ListTemp = ListTemp->Flink;
+        return 0;
+    }
 
-        //
-        // Get the head of the record
-        //
-        PPOOL_TABLE PoolTable = (PPOOL_TABLE)CONTAINING_RECORD(ListTemp, POOL_TABLE, PoolsList);
+    Cache = &g_PoolManagerCaches[Intention];
 
-        if (PoolTable->Intention == Intention && PoolTable->IsBusy == FALSE)
-        {
-            PoolTable->IsBusy = TRUE;
-            Address           = PoolTable->Address;
-            break;
-        }
+    if (Cache->IsInitialized)
+    {
+        Address = SlabAllocate(&Cache->Slabs, KeGetCurrentProcessorNumber());
     }
 
-    SpinlockUnlock(&LockForReadingPool);
-
     //
     // Check if we need additional pools e.g another pool or the pool
     // will be available for the next use blah blah
     //
     if (RequestNewPool)
     {
-        PoolManagerRequestAllocation(Size, 1, Intention);
-    }
-
-    //
-    // return Address might be null indicating there is no valid pools
-    //
-    return Address;
-}
-
-/**
- * @brief Allocate the new pools and add them to pool table
- * @details This function doesn't need lock as it just calls once from PASSIVE_LEVEL
- * 
- * @param Size Size of each chunk
- * @param Count Count of chunks
- * @param Intention The Intention of the buffer (buffer tag)
- * @return BOOLEAN If the allocation was successfull it returns true and if it was
- * unsuccessful then it returns false
- */
-BOOLEAN
-PoolManagerAllocateAndAddToPoolTable(SIZE_T Size, UINT32 Count, POOL_ALLOCATION_INTENTION Intention)
-{
-    for (size_t i = 0; i < Count; i++)
-    {
-        POOL_TABLE * SinglePool = ExAllocatePoolWithTag(NonPagedPool, sizeof(POOL_TABLE), POOLTAG);
-
-        if (!SinglePool)
+        if (Cache->ObjectSize == 0)
         {
-            LogError("Insufficient memory");
-            return FALSE;
+            PoolManagerRequestAllocation(Size, 1, Intention);
         }
-
-        RtlZeroMemory(SinglePool, sizeof(POOL_TABLE));
-
-        //
-        // Allocate the buffer
-        //
-        SinglePool->Address = ExAllocatePoolWithTag(NonPagedPool, Size, POOLTAG);
-
-        if (!SinglePool->Address)
+        else if (Cache->Slabs.FreeObjects < Cache->TargetFreeObjects)
         {
-            LogError("Insufficient memory");
-            return FALSE;
+            g_IsNewRequestForAllocationRecieved = TRUE;
         }
-
-        RtlZeroMemory(SinglePool->Address, Size);
-
-        SinglePool->Intention     = Intention;
-        SinglePool->IsBusy        = FALSE;
-        SinglePool->ShouldBeFreed = FALSE;
-        SinglePool->AlreadyFreed  = FALSE;
-        SinglePool->Size          = Size;
-
-        //
-        // Add it to the list
-        //
-        InsertHeadList(&g_ListOfAllocatedPoolsHead, &(SinglePool->PoolsList));
     }
+
+    //
+    // return Address might be null indicating there is no valid pools
+    //
+    return (UINT64)Address;
 }
 
 /**
- * @brief This function performs allocations from VMX non-root based on g_RequestNewAllocation
- * 
+ * @brief This function performs allocations from VMX non-root based on the
+ * requests of the caches
+ *
  * @return BOOLEAN If the the pool manager allocates buffer or there was no buffer to allocate
  * then it returns true, if there was any error then it returns false
  */
 BOOLEAN
 PoolManagerCheckAndPerformAllocationAndDeallocation()
 {
-    BOOLEAN     Result   = TRUE;
-    PLIST_ENTRY ListTemp = 0;
-    UINT64      Address  = 0;
+    BOOLEAN             Result = TRUE;
+    PPOOL_MANAGER_CACHE Cache;
 
     //
     // let's make sure we're on vmx non-root and also we have new allocation
@@ -299,89 +231,74 @@ PoolManagerCheckAndPerformAllocationAndDeallocation()
 
     PAGED_CODE();
 
+    SpinlockLock(&LockForPoolManagerAllocations);
+
     //
-    // Check for new allocation
+    // Check for deallocation, the freed pools are reusable from now on
     //
-    if (g_IsNewRequestForAllocationRecieved)
+    if (InterlockedExchange(&g_IsNewRequestForDeAllocation, FALSE))
     {
-        for (size_t i = 0; i < MaximumRequestsQueueDepth; i++)
+        for (UINT32 i = 0; i < POOL_ALLOCATION_INTENTION_COUNT; i++)
         {
-            if (g_RequestNewAllocation[i].Size != 0)
+            if (g_PoolManagerCaches[i].IsInitialized)
             {
-                Result = PoolManagerAllocateAndAddToPoolTable(g_RequestNewAllocation[i].Size, g_RequestNewAllocation[i].Count, g_RequestNewAllocation[i].Intention);
-
-                //
-                // Free the data for future use
-                //
-                g_RequestNewAllocation[i].Count     = 0;
-                g_RequestNewAllocation[i].Intention = 0;
-                g_RequestNewAllocation[i].Size      = 0;
+                SlabReclaimDeferred(&g_PoolManagerCaches[i].Slabs);
             }
         }
     }
 
     //
-    // Check for deallocation
+    // Check for new allocation
     //
-    if (g_IsNewRequestForDeAllocation)
+    if (InterlockedExchange(&g_IsNewRequestForAllocationRecieved, FALSE))
     {
-        ListTemp = &g_ListOfAllocatedPoolsHead;
-
-        SpinlockLock(&LockForReadingPool);
-
-        while (&g_ListOfAllocatedPoolsHead != ListTemp->Flink)
+        for (UINT32 i = 0; i < POOL_ALLOCATION_INTENTION_COUNT; i++)
         {
-            ListTemp = ListTemp->Flink;
+            Cache = &g_PoolManagerCaches[i];
 
-            //
-            // Get the head of the record
-            //
-            PPOOL_TABLE PoolTable = (PPOOL_TABLE)CONTAINING_RECORD(ListTemp, POOL_TABLE, PoolsList);
+            if (Cache->ObjectSize == 0)
+            {
+                continue;
+            }
+
+            if (!Cache->IsInitialized)
+            {
+                if (!SlabInitializeCache(&g_PoolManagerAllocator, &Cache->Slabs, Cache->ObjectSize))
+                {
+                    LogError("Insufficient memory");
+                    Result = FALSE;
+                    continue;
+                }
+
+                Cache->IsInitialized = TRUE;
+            }
 
             //
-            // Check whther this pool should be freed or not and
-            // also check whether it's already freed or not
+            // Each slab adds multiple objects to the cache
             //
-            if (PoolTable->ShouldBeFreed && !PoolTable->AlreadyFreed)
+            while (Cache->Slabs.FreeObjects < Cache->TargetFreeObjects)
             {
-                //
-                // Set the flag to indicate that we freed
-                //
-                PoolTable->AlreadyFreed = TRUE;
-
-                //
-                // This item should be freed
-                //
-                ExFreePoolWithTag(PoolTable->Address, POOLTAG);
-
-                //
-                // Now we should remove the entry from the g_ListOfAllocatedPoolsHead
-                //
-                RemoveEntryList(&PoolTable->PoolsList);
-
-                //
-                // Free the structure pool
-                //
-                ExFreePoolWithTag(PoolTable, POOLTAG);
+                if (!SlabGrowCache(&g_PoolManagerAllocator, &Cache->Slabs))
+                {
+                    LogError("Insufficient memory");
+                    Result = FALSE;
+                    break;
+                }
             }
         }
-
-        SpinlockUnlock(&LockForReadingPool);
     }
 
-    //
-    // All allocation and deallocation are preformed
-    //
-    g_IsNewRequestForDeAllocation       = FALSE;
-    g_IsNewRequestForAllocationRecieved = FALSE;
+    SpinlockUnlock(&LockForPoolManagerAllocations);
 
     return Result;
 }
 
 /**
  * @brief Request to allocate new buffers
- * 
- * @param Size Request new buffer to allocate 
+ * @details The count is added to the free pools that are kept for this intention,
+ * it can be called from vmx-root and the pools are allocated on the next IOCTL
+ *
+ * @param Size Request new buffer to allocate
  * @param Count Count of chunks
  * @param Intention The intention of chunks (buffer tag)
  * @return BOOLEAN If the request is save it returns true otherwise it returns false
@@ -389,39 +306,33 @@ PoolManagerCheckAndPerformAllocationAndDeallocation()
 BOOLEAN
 PoolManagerRequestAllocation(SIZE_T Size, UINT32 Count, POOL_ALLOCATION_INTENTION Intention)
 {
-    BOOLEAN FoundAPlace = FALSE;
-
-    //
-    // ******** We check to find a free place to store ********
-    //
+    PPOOL_MANAGER_CACHE Cache;
+    LONG64              ObjectSize;
 
-    SpinlockLock(&LockForRequestAllocation);
-
-    for (size_t i = 0; i < MaximumRequestsQueueDepth; i++)
+    if (Intention >= POOL_ALLOCATION_INTENTION_COUNT || Size == 0 || SlabGetSizeClass(Size) == 0)
     {
-        if (g_RequestNewAllocation[i].Size == 0)
-        {
-            g_RequestNewAllocation[i].Count     = Count;
-            g_RequestNewAllocation[i].Intention = Intention;
-            g_RequestNewAllocation[i].Size      = Size;
+        return FALSE;
+    }
 
-            FoundAPlace = TRUE;
+    Cache = &g_PoolManagerCaches[Intention];
 
-            break;
-        }
-    }
+    //
+    // All of the pools of an intention have the same size
+    //
+    ObjectSize = InterlockedCompareExchange64(&Cache->ObjectSize, Size, 0);
 
-    if (!FoundAPlace)
+    if (ObjectSize != 0 && SlabGetSizeClass(Size) > SlabGetSizeClass(ObjectSize))
     {
-        SpinlockUnlock(&LockForRequestAllocation);
+        LogError("Invalid pool size for the intention %d", Intention);
         return FALSE;
     }
 
+    InterlockedAdd64(&Cache->TargetFreeObjects, Count);
+
     //
     // Signals to show that we have new allocations
     //
     g_IsNewRequestForAllocationRecieved = TRUE;
 
-    SpinlockUnlock(&LockForRequestAllocation);
     return TRUE;
 }
@@ -11,17 +11,6 @@
  */
 #pragma once
 
-//////////////////////////////////////////////////
-//                   Definition	    			//
-//////////////////////////////////////////////////
-
-/**
- * @brief Maximum Pool Requests (while not allocated)
- * 
- */
-#define MaximumRequestsQueueDepth   100
-#define NumberOfPreAllocatedBuffers 10
-
 //////////////////////////////////////////////////
 //                    Enums		    			//
 //////////////////////////////////////////////////
@@ -34,11 +23,13 @@ typedef enum
 {
     TRACKING_HOOKED_PAGES,
     EXEC_TRAMPOLINE,
-    SPLIT_2MB_PAGING_TO_4KB_PAGE,
+    SPLIT_1GB_PAGING_TO_2MB_PAGE,
     DETOUR_HOOK_DETAILS,
     THREAD_STEPPINGS_DETAIIL,
     BREAKPOINT_DEFINITION_STRUCTURE,
 
+    POOL_ALLOCATION_INTENTION_COUNT
+
 } POOL_ALLOCATION_INTENTION;
 
 //////////////////////////////////////////////////
@@ -46,72 +37,51 @@ typedef enum
 //////////////////////////////////////////////////
 
 /**
- * @brief Table of holding pools detail structure
+ * @brief The pools of an intention (buffer tag)
  * 
  */
-typedef struct _POOL_TABLE
+typedef struct _POOL_MANAGER_CACHE
 {
-    UINT64                    Address; // Should be the start of the list as we compute it as the start address
-    SIZE_T                    Size;
-    POOL_ALLOCATION_INTENTION Intention;
-    LIST_ENTRY                PoolsList;
-    BOOLEAN                   IsBusy;
-    BOOLEAN                   ShouldBeFreed;
-    BOOLEAN                   AlreadyFreed;
+    SLAB_CACHE      Slabs;             // The cache of the slab allocator
+    volatile LONG64 ObjectSize;        // Size of the pools (set by the first request)
+    volatile LONG64 TargetFreeObjects; // Count of the free pools that should be available
+    BOOLEAN         IsInitialized;     // Shows whether the cache is initialized or not
 
-} POOL_TABLE, *PPOOL_TABLE;
-
-/**
- * @brief Manage the requests for new allocations
- * 
- */
-typedef struct _REQUEST_NEW_ALLOCATION
-{
-    SIZE_T                    Size;
-    UINT32                    Count;
-    POOL_ALLOCATION_INTENTION Intention;
-
-} REQUEST_NEW_ALLOCATION, *PREQUEST_NEW_ALLOCATION;
+} POOL_MANAGER_CACHE, *PPOOL_MANAGER_CACHE;
 
 //////////////////////////////////////////////////
 //                   Variables	    			//
 //////////////////////////////////////////////////
 
 /**
- * @brief If sb wants allocation from vmx root, adds it's request to this structure
+ * @brief The slab allocator of all of the pools
  * 
  */
-REQUEST_NEW_ALLOCATION * g_RequestNewAllocation;
+SLAB_ALLOCATOR g_PoolManagerAllocator;
 
 /**
- * @brief Request allocation Spinlock
+ * @brief The pools of each intention
  * 
  */
-volatile LONG LockForRequestAllocation;
+POOL_MANAGER_CACHE g_PoolManagerCaches[POOL_ALLOCATION_INTENTION_COUNT];
 
 /**
- * @brief Spinlock for reading pool
- * 
- */
-volatile LONG LockForReadingPool;
-
-/**
- * @brief We set it when there is a new allocation
+ * @brief Spinlock for growing the caches and reclaiming the freed pools
  * 
  */
-BOOLEAN g_IsNewRequestForAllocationRecieved;
+volatile LONG LockForPoolManagerAllocations;
 
 /**
  * @brief We set it when there is a new allocation
  * 
  */
-BOOLEAN g_IsNewRequestForDeAllocation;
+volatile LONG g_IsNewRequestForAllocationRecieved;
 
 /**
- * @brief Create a list from all pools
+ * @brief We set it when there is a new deallocation
  * 
  */
-LIST_ENTRY g_ListOfAllocatedPoolsHead;
+volatile LONG g_IsNewRequestForDeAllocation;
 
 //////////////////////////////////////////////////
 //                   Functions		  			//
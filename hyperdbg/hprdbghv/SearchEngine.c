@@ -0,0 +1,491 @@
+/**
+ * @file SearchEngine.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Vectorized pattern search engine (used in !s* s* commands)
+ * @details The engine first filters the candidates by comparing two
+ * anchor bytes of the pattern (the first and the last non-wildcard bytes)
+ * on 16 (SSE2) or 32 (AVX2) positions at once, then each candidate is
+ * fully compared against the pattern and its wildcard mask
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Compile a pattern for the search engine
+ *
+ * @param Pattern The compiled pattern
+ * @param Bytes Bytes of the pattern
+ * @param Mask Mask of the pattern (0xff compare, 0x00 wildcard)
+ * if it's NULL, then all bytes are compared
+ * @param Length Length of the pattern
+ * @param Alignment Only the addresses that are aligned to this value
+ * are reported
+ * @return BOOLEAN Returns TRUE if the pattern is valid
+ */
+BOOLEAN
+SearchEngineCompilePattern(PSEARCH_ENGINE_PATTERN Pattern,
+                           const UCHAR *          Bytes,
+                           const UCHAR *          Mask,
+                           UINT32                 Length,
+                           UINT32                 Alignment)
+{
+    BOOLEAN FirstAnchorFound = FALSE;
+
+    if (Length == 0 || Length > MaximumSearchPatternLength)
+    {
+        return FALSE;
+    }
+
+    //
+    // Alignment should be a power of two
+    //
+    if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0)
+    {
+        return FALSE;
+    }
+
+    RtlZeroMemory(Pattern, sizeof(SEARCH_ENGINE_PATTERN));
+
+    Pattern->Length    = Length;
+    Pattern->Alignment = Alignment;
+
+    for (UINT32 i = 0; i < Length; i++)
+    {
+        Pattern->Mask[i] = Mask == NULL ? SEARCH_ENGINE_MASK_COMPARE : Mask[i];
+
+        //
+        // Masked bytes are zeroed so the full compare can xor and mask
+        // the chunks without any special case for wildcards
+        //
+        Pattern->Bytes[i] = Bytes[i] & Pattern->Mask[i];
+
+        if (Pattern->Mask[i] == SEARCH_ENGINE_MASK_COMPARE)
+        {
+            if (!FirstAnchorFound)
+            {
+                Pattern->FirstAnchorOffset = i;
+                FirstAnchorFound           = TRUE;
+            }
+
+            Pattern->SecondAnchorOffset = i;
+        }
+    }
+
+    Pattern->HasAnchor = FirstAnchorFound;
+
+    return TRUE;
+}
+
+/**
+ * @brief Compile the values of a search request (!s* s*) into
+ * a search engine pattern
+ * @details The values (UINT64) are followed by their masks (UINT64) in
+ * the request buffer, each value contributes 1, 4 or 8 bytes (based on
+ * the ByteSize) to the pattern in little-endian
+ *
+ * @param Pattern The compiled pattern
+ * @param SearchMemRequest The search request
+ * @return BOOLEAN Returns TRUE if the request contains a valid pattern
+ */
+BOOLEAN
+SearchEngineCompilePatternFromSearchRequest(PSEARCH_ENGINE_PATTERN Pattern, PDEBUGGER_SEARCH_MEMORY SearchMemRequest)
+{
+    UINT32   LengthOfEachChunk = 0;
+    UINT32   PatternLength     = 0;
+    UINT64   Value             = 0;
+    UINT64   ValueMask         = 0;
+    UINT64 * Values            = NULL;
+    UINT64 * Masks             = NULL;
+    UCHAR    Bytes[MaximumSearchPatternLength];
+    UCHAR    Mask[MaximumSearchPatternLength];
+
+    //
+    // set chunk size of each value
+    //
+    if (SearchMemRequest->ByteSize == SEARCH_BYTE)
+    {
+        LengthOfEachChunk = 1;
+    }
+    else if (SearchMemRequest->ByteSize == SEARCH_DWORD)
+    {
+        LengthOfEachChunk = 4;
+    }
+    else if (SearchMemRequest->ByteSize == SEARCH_QWORD)
+    {
+        LengthOfEachChunk = 8;
+    }
+    else
+    {
+        //
+        // Invalid parameter
+        //
+        return FALSE;
+    }
+
+    if (SearchMemRequest->CountOf64Chunks == 0 ||
+        SearchMemRequest->CountOf64Chunks * LengthOfEachChunk > MaximumSearchPatternLength)
+    {
+        return FALSE;
+    }
+
+    Values = (UINT64 *)((UINT64)SearchMemRequest + SIZEOF_DEBUGGER_SEARCH_MEMORY);
+    Masks  = Values + SearchMemRequest->CountOf64Chunks;
+
+    for (UINT32 i = 0; i < SearchMemRequest->CountOf64Chunks; i++)
+    {
+        Value     = Values[i];
+        ValueMask = Masks[i];
+
+        for (UINT32 j = 0; j < LengthOfEachChunk; j++)
+        {
+            Bytes[PatternLength] = (UCHAR)(Value >> (j * 8));
+            Mask[PatternLength]  = (UCHAR)(ValueMask >> (j * 8));
+            PatternLength++;
+        }
+    }
+
+    //
+    // Dwords and qwords are only searched on their natural alignment
+    //
+    return SearchEngineCompilePattern(Pattern, Bytes, Mask, PatternLength, LengthOfEachChunk);
+}
+
+/**
+ * @brief Check whether the processor and the OS support AVX2
+ * @details The caller should still save the extended processor
+ * state before using the AVX2 path in kernel-mode and it should
+ * never be used in vmx-root mode as the guest's ymm registers are
+ * not saved on vm-exits
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SearchEngineIsAvx2Supported()
+{
+    int Regs[4];
+
+    //
+    // Check OSXSAVE and AVX
+    //
+    __cpuidex(Regs, 1, 0);
+
+    if ((Regs[2] & (1 << 27)) == 0 || (Regs[2] & (1 << 28)) == 0)
+    {
+        return FALSE;
+    }
+
+    //
+    // Check whether the OS saves xmm and ymm registers
+    //
+    if ((_xgetbv(0) & 0x6) != 0x6)
+    {
+        return FALSE;
+    }
+
+    //
+    // Check AVX2
+    //
+    __cpuidex(Regs, 7, 0);
+
+    return (Regs[1] & (1 << 5)) != 0;
+}
+
+/**
+ * @brief Fully compare a candidate with the pattern
+ *
+ * @param Pattern The compiled pattern
+ * @param Candidate Address of the candidate in the buffer
+ * @return BOOLEAN
+ */
+BOOLEAN
+SearchEngineCompareCandidate(PSEARCH_ENGINE_PATTERN Pattern, const UCHAR * Candidate)
+{
+    UINT32 Index = 0;
+
+    //
+    // Compare 8 bytes at a time
+    //
+    for (; Index + sizeof(UINT64) <= Pattern->Length; Index += sizeof(UINT64))
+    {
+        if (((*(UNALIGNED UINT64 *)(Candidate + Index) ^ *(UNALIGNED UINT64 *)&Pattern->Bytes[Index]) &
+             *(UNALIGNED UINT64 *)&Pattern->Mask[Index]) != 0)
+        {
+            return FALSE;
+        }
+    }
+
+    //
+    // Compare the remaining bytes
+    //
+    for (; Index < Pattern->Length; Index++)
+    {
+        if (((Candidate[Index] ^ Pattern->Bytes[Index]) & Pattern->Mask[Index]) != 0)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Check and report the candidates of a filter mask
+ *
+ * @param Pattern The compiled pattern
+ * @param Buffer The buffer
+ * @param Position Position of the first bit of the filter mask
+ * @param FilterMask The bit mask of candidates
+ * @param BaseAddress Address of the first byte of the buffer
+ * @param Callback Match callback
+ * @param Context Callback context
+ * @return BOOLEAN FALSE if the callback asked to stop the scan
+ */
+BOOLEAN
+SearchEngineCheckCandidates(PSEARCH_ENGINE_PATTERN       Pattern,
+                            const UCHAR *                Buffer,
+                            UINT32                       Position,
+                            UINT32                       FilterMask,
+                            UINT64                       BaseAddress,
+                            SEARCH_ENGINE_MATCH_CALLBACK Callback,
+                            PVOID                        Context)
+{
+    unsigned long BitIndex;
+    UINT32        Offset;
+
+    while (FilterMask != 0)
+    {
+        _BitScanForward(&BitIndex, FilterMask);
+        FilterMask &= FilterMask - 1;
+
+        Offset = Position + BitIndex;
+
+        if (((BaseAddress + Offset) & (Pattern->Alignment - 1)) != 0)
+        {
+            continue;
+        }
+
+        if (SearchEngineCompareCandidate(Pattern, &Buffer[Offset]))
+        {
+            if (!Callback(BaseAddress, Offset, Context))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Scan a buffer for the compiled pattern
+ * @details Only the matches that are completely inside the buffer
+ * are reported, the caller should carry the last (Length - 1) bytes
+ * to the next buffer if the memory is contiguous
+ *
+ * @param Pattern The compiled pattern
+ * @param Buffer Buffer to scan
+ * @param BufferSize Size of the buffer
+ * @param BaseAddress Address of the first byte of the buffer (only used
+ * for the alignment and passed to the callback)
+ * @param UseAvx2 Use 32-byte filters (the caller should check the support
+ * and save the extended state)
+ * @param Callback Match callback
+ * @param Context Callback context
+ * @return BOOLEAN FALSE if the callback asked to stop the scan
+ */
+BOOLEAN
+SearchEngineScanBuffer(PSEARCH_ENGINE_PATTERN       Pattern,
+                       const UCHAR *                Buffer,
+                       UINT32                       BufferSize,
+                       UINT64                       BaseAddress,
+                       BOOLEAN                      UseAvx2,
+                       SEARCH_ENGINE_MATCH_CALLBACK Callback,
+                       PVOID                        Context)
+{
+    UINT32        Position = 0;
+    UINT32        CandidatesCount;
+    const UCHAR * FirstAnchor;
+    const UCHAR * SecondAnchor;
+
+    if (BufferSize < Pattern->Length)
+    {
+        return TRUE;
+    }
+
+    //
+    // Every position in [0, CandidatesCount) can hold a complete match
+    //
+    CandidatesCount = BufferSize - Pattern->Length + 1;
+
+    if (!Pattern->HasAnchor)
+    {
+        //
+        // The pattern is full of wildcards, everything (aligned) matches
+        //
+        for (; Position < CandidatesCount; Position++)
+        {
+            if (((BaseAddress + Position) & (Pattern->Alignment - 1)) == 0 &&
+                !Callback(BaseAddress, Position, Context))
+            {
+                return FALSE;
+            }
+        }
+
+        return TRUE;
+    }
+
+    FirstAnchor  = Buffer + Pattern->FirstAnchorOffset;
+    SecondAnchor = Buffer + Pattern->SecondAnchorOffset;
+
+    if (UseAvx2)
+    {
+        __m256i FirstValue  = _mm256_set1_epi8(Pattern->Bytes[Pattern->FirstAnchorOffset]);
+        __m256i SecondValue = _mm256_set1_epi8(Pattern->Bytes[Pattern->SecondAnchorOffset]);
+
+        for (; Position + 32 <= CandidatesCount; Position += 32)
+        {
+            __m256i FirstBlock  = _mm256_loadu_si256((const __m256i *)(FirstAnchor + Position));
+            __m256i SecondBlock = _mm256_loadu_si256((const __m256i *)(SecondAnchor + Position));
+            __m256i Equal       = _mm256_and_si256(_mm256_cmpeq_epi8(FirstBlock, FirstValue),
+                                             _mm256_cmpeq_epi8(SecondBlock, SecondValue));
+
+            UINT32 FilterMask = (UINT32)_mm256_movemask_epi8(Equal);
+
+            if (FilterMask != 0 &&
+                !SearchEngineCheckCandidates(Pattern, Buffer, Position, FilterMask, BaseAddress, Callback, Context))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    {
+        __m128i FirstValue  = _mm_set1_epi8(Pattern->Bytes[Pattern->FirstAnchorOffset]);
+        __m128i SecondValue = _mm_set1_epi8(Pattern->Bytes[Pattern->SecondAnchorOffset]);
+
+        for (; Position + 16 <= CandidatesCount; Position += 16)
+        {
+            __m128i FirstBlock  = _mm_loadu_si128((const __m128i *)(FirstAnchor + Position));
+            __m128i SecondBlock = _mm_loadu_si128((const __m128i *)(SecondAnchor + Position));
+            __m128i Equal       = _mm_and_si128(_mm_cmpeq_epi8(FirstBlock, FirstValue),
+                                          _mm_cmpeq_epi8(SecondBlock, SecondValue));
+
+            UINT32 FilterMask = (UINT32)_mm_movemask_epi8(Equal);
+
+            if (FilterMask != 0 &&
+                !SearchEngineCheckCandidates(Pattern, Buffer, Position, FilterMask, BaseAddress, Callback, Context))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    //
+    // Check the tail of the buffer byte by byte
+    //
+    for (; Position < CandidatesCount; Position++)
+    {
+        if (FirstAnchor[Position] == Pattern->Bytes[Pattern->FirstAnchorOffset] &&
+            SecondAnchor[Position] == Pattern->Bytes[Pattern->SecondAnchorOffset] &&
+            !SearchEngineCheckCandidates(Pattern, Buffer, Position, 1, BaseAddress, Callback, Context))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Scan a run of contiguous memory after the bytes that are
+ * carried from the previous run
+ * @details The run should be read right after the carried bytes of the
+ * window, then the last (Length - 1) bytes are moved to the start of the
+ * window so the matches that cross the boundary of the next run are also
+ * found, the caller should set the carried size to zero if the next run
+ * isn't contiguous with this run
+ *
+ * @param Pattern The compiled pattern
+ * @param Window The carried bytes followed by the run
+ * @param CarrySize Count of the carried bytes (updated for the next run)
+ * @param RunSize Size of the run
+ * @param RunAddress Address of the first byte of the run
+ * @param UseAvx2 Use 32-byte filters
+ * @param Callback Match callback
+ * @param Context Callback context
+ * @return BOOLEAN FALSE if the callback asked to stop the scan
+ */
+BOOLEAN
+SearchEngineScanRun(PSEARCH_ENGINE_PATTERN       Pattern,
+                    UCHAR *                      Window,
+                    UINT32 *                     CarrySize,
+                    UINT32                       RunSize,
+                    UINT64                       RunAddress,
+                    BOOLEAN                      UseAvx2,
+                    SEARCH_ENGINE_MATCH_CALLBACK Callback,
+                    PVOID                        Context)
+{
+    UINT32 WindowSize = *CarrySize + RunSize;
+
+    if (!SearchEngineScanBuffer(Pattern,
+                                Window,
+                                WindowSize,
+                                RunAddress - *CarrySize,
+                                UseAvx2,
+                                Callback,
+                                Context))
+    {
+        return FALSE;
+    }
+
+    //
+    // Keep the last bytes for the matches that cross the boundary
+    //
+    *CarrySize = min(Pattern->Length - 1, WindowSize);
+    RtlMoveMemory(Window, Window + WindowSize - *CarrySize, *CarrySize);
+
+    return TRUE;
+}
+
+/**
+ * @brief Callback of the search engine to save the search results
+ *
+ * @param BaseAddress Address of the first byte of the scanned buffer
+ * @param OffsetInBuffer Offset of the match in the scanned buffer
+ * @param Context The search results context
+ * @return BOOLEAN Returns FALSE if the results buffer is full
+ */
+BOOLEAN
+SearchEngineSaveResultCallback(UINT64 BaseAddress, UINT32 OffsetInBuffer, PVOID Context)
+{
+    PSEARCH_ENGINE_RESULTS_CONTEXT ResultsContext = (PSEARCH_ENGINE_RESULTS_CONTEXT)Context;
+
+    ResultsContext->Results[ResultsContext->CountOfResults] = BaseAddress + OffsetInBuffer;
+    ResultsContext->CountOfResults++;
+
+    //
+    // Stop the search if the results buffer is full, the user-mode
+    // continues the search from the next address
+    //
+    return ResultsContext->CountOfResults < ResultsContext->MaximumResults;
+}
+
+/**
+ * @brief Get the address that the next request continues the search
+ * from when the results buffer is full
+ * @details The search continues right after the last result, so the
+ * overlapping matches are neither missed nor reported twice
+ *
+ * @param ResultsContext The search results context (full)
+ * @return UINT64
+ */
+UINT64
+SearchEngineGetNextAddressToSearch(PSEARCH_ENGINE_RESULTS_CONTEXT ResultsContext)
+{
+    return ResultsContext->Results[ResultsContext->CountOfResults - 1] + 1;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file SearchEngine.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the vectorized pattern search engine
+ * @details The matcher in this file doesn't depend on any kernel
+ * routine, it only works on buffers so it can be used in both vmx-root
+ * and vmx non-root and also on any type of memory (physical or virtual)
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The mask value of bytes that should be compared
+ *
+ */
+#define SEARCH_ENGINE_MASK_COMPARE 0xff
+
+/**
+ * @brief The mask value of wildcard bytes
+ *
+ */
+#define SEARCH_ENGINE_MASK_WILDCARD 0x00
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Compiled pattern of the search engine
+ * @details Bytes and masks are padded with zeros to the next 8 byte
+ * boundary so the full compare can be performed on 64-bit chunks
+ *
+ */
+typedef struct _SEARCH_ENGINE_PATTERN
+{
+    UINT32  Length;             // Length of the pattern (in bytes)
+    UINT32  Alignment;          // Only report the matches that are aligned to this value
+    BOOLEAN HasAnchor;          // Shows whether the pattern has at least one non-wildcard byte
+    UINT32  FirstAnchorOffset;  // Offset of the first non-wildcard byte
+    UINT32  SecondAnchorOffset; // Offset of the last non-wildcard byte
+    UCHAR   Bytes[MaximumSearchPatternLength + sizeof(UINT64)];
+    UCHAR   Mask[MaximumSearchPatternLength + sizeof(UINT64)];
+
+} SEARCH_ENGINE_PATTERN, *PSEARCH_ENGINE_PATTERN;
+
+/**
+ * @brief Context of saving the search results
+ *
+ */
+typedef struct _SEARCH_ENGINE_RESULTS_CONTEXT
+{
+    UINT64 * Results;
+    UINT32   CountOfResults;
+    UINT32   MaximumResults;
+
+} SEARCH_ENGINE_RESULTS_CONTEXT, *PSEARCH_ENGINE_RESULTS_CONTEXT;
+
+/**
+ * @brief Callback that will be called for each match
+ * @details If the callback returns FALSE, then the scan is stopped
+ *
+ */
+typedef BOOLEAN (*SEARCH_ENGINE_MATCH_CALLBACK)(UINT64 BaseAddress, UINT32 OffsetInBuffer, PVOID Context);
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SearchEngineCompilePattern(PSEARCH_ENGINE_PATTERN Pattern,
+                           const UCHAR *          Bytes,
+                           const UCHAR *          Mask,
+                           UINT32                 Length,
+                           UINT32                 Alignment);
+
+BOOLEAN
+SearchEngineCompilePatternFromSearchRequest(PSEARCH_ENGINE_PATTERN Pattern, PDEBUGGER_SEARCH_MEMORY SearchMemRequest);
+
+BOOLEAN
+SearchEngineIsAvx2Supported();
+
+BOOLEAN
+SearchEngineCompareCandidate(PSEARCH_ENGINE_PATTERN Pattern, const UCHAR * Candidate);
+
+BOOLEAN
+SearchEngineCheckCandidates(PSEARCH_ENGINE_PATTERN       Pattern,
+                            const UCHAR *                Buffer,
+                            UINT32                       Position,
+                            UINT32                       FilterMask,
+                            UINT64                       BaseAddress,
+                            SEARCH_ENGINE_MATCH_CALLBACK Callback,
+                            PVOID                        Context);
+
+BOOLEAN
+SearchEngineScanBuffer(PSEARCH_ENGINE_PATTERN       Pattern,
+                       const UCHAR *                Buffer,
+                       UINT32                       BufferSize,
+                       UINT64                       BaseAddress,
+                       BOOLEAN                      UseAvx2,
+                       SEARCH_ENGINE_MATCH_CALLBACK Callback,
+                       PVOID                        Context);
+
+BOOLEAN
+SearchEngineScanRun(PSEARCH_ENGINE_PATTERN       Pattern,
+                    UCHAR *                      Window,
+                    UINT32 *                     CarrySize,
+                    UINT32                       RunSize,
+                    UINT64                       RunAddress,
+                    BOOLEAN                      UseAvx2,
+                    SEARCH_ENGINE_MATCH_CALLBACK Callback,
+                    PVOID                        Context);
+
+BOOLEAN
+SearchEngineSaveResultCallback(UINT64 BaseAddress, UINT32 OffsetInBuffer, PVOID Context);
+
+UINT64
+SearchEngineGetNextAddressToSearch(PSEARCH_ENGINE_RESULTS_CONTEXT ResultsContext);
@@ -0,0 +1,433 @@
+/**
+ * @file SharedBitmaps.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief MSR and I/O bitmaps that are shared between the cores
+ * @details All of the cores use one set of MSR and I/O bitmaps, the changes
+ * that target all of the cores are written to the shared bitmaps (with
+ * atomic bit operations) without notifying the cores. Once a core-specific
+ * event changes the bitmaps of a core, a private copy of the bitmaps is
+ * allocated for that core and the core switches to its private copy in
+ * vmx-root, the changes of all cores are then also requested for the cores
+ * that have a private copy
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Allocate the shared MSR bitmap (if it's not already allocated)
+ * @details Should be called from vmx non-root
+ *
+ * @return BOOLEAN Returns true if allocation was successfull otherwise returns false
+ */
+BOOLEAN
+SharedBitmapsAllocateMsrBitmap()
+{
+    if (g_SharedBitmaps.MsrBitmapVirtualAddress != NULL)
+    {
+        return TRUE;
+    }
+
+    g_SharedBitmaps.MsrBitmapVirtualAddress = ExAllocatePoolWithTag(NonPagedPool, PAGE_SIZE, POOLTAG);
+
+    if (g_SharedBitmaps.MsrBitmapVirtualAddress == NULL)
+    {
+        LogError("Insufficient memory in allocationg shared Msr Bitmap");
+        return FALSE;
+    }
+    RtlZeroMemory(g_SharedBitmaps.MsrBitmapVirtualAddress, PAGE_SIZE);
+
+    g_SharedBitmaps.MsrBitmapPhysicalAddress = VirtualAddressToPhysicalAddress(g_SharedBitmaps.MsrBitmapVirtualAddress);
+
+    LogDebugInfo("Shared Msr Bitmap Virtual Address : 0x%llx", g_SharedBitmaps.MsrBitmapVirtualAddress);
+    LogDebugInfo("Shared Msr Bitmap Physical Address : 0x%llx", g_SharedBitmaps.MsrBitmapPhysicalAddress);
+
+    return TRUE;
+}
+
+/**
+ * @brief Allocate the shared I/O bitmaps (if they're not already allocated)
+ * @details Should be called from vmx non-root
+ *
+ * @return BOOLEAN Returns true if allocation was successfull otherwise returns false
+ */
+BOOLEAN
+SharedBitmapsAllocateIoBitmaps()
+{
+    if (g_SharedBitmaps.IoBitmapVirtualAddressA != NULL)
+    {
+        return TRUE;
+    }
+
+    //
+    // Both of the bitmaps (A and B) are allocated at once
+    //
+    g_SharedBitmaps.IoBitmapVirtualAddressA = ExAllocatePoolWithTag(NonPagedPool, PAGE_SIZE * 2, POOLTAG);
+
+    if (g_SharedBitmaps.IoBitmapVirtualAddressA == NULL)
+    {
+        LogError("Insufficient memory in allocationg shared I/O Bitmaps");
+        return FALSE;
+    }
+    RtlZeroMemory(g_SharedBitmaps.IoBitmapVirtualAddressA, PAGE_SIZE * 2);
+
+    g_SharedBitmaps.IoBitmapVirtualAddressB  = g_SharedBitmaps.IoBitmapVirtualAddressA + PAGE_SIZE;
+    g_SharedBitmaps.IoBitmapPhysicalAddressA = VirtualAddressToPhysicalAddress(g_SharedBitmaps.IoBitmapVirtualAddressA);
+    g_SharedBitmaps.IoBitmapPhysicalAddressB = VirtualAddressToPhysicalAddress(g_SharedBitmaps.IoBitmapVirtualAddressB);
+
+    LogDebugInfo("Shared I/O Bitmap A Virtual Address : 0x%llx", g_SharedBitmaps.IoBitmapVirtualAddressA);
+    LogDebugInfo("Shared I/O Bitmap B Virtual Address : 0x%llx", g_SharedBitmaps.IoBitmapVirtualAddressB);
+
+    return TRUE;
+}
+
+/**
+ * @brief Free the shared bitmaps
+ * @details Should be called from vmx non-root after all of the cores
+ * are terminated
+ *
+ * @return VOID
+ */
+VOID
+SharedBitmapsUninitialize()
+{
+    LogDebugInfo("Shared bitmaps, changes: %lld, private Msr Bitmaps: %d, private I/O Bitmaps: %d",
+                 g_SharedBitmaps.CountOfSharedChanges,
+                 g_SharedBitmaps.CountOfPrivateMsrBitmaps,
+                 g_SharedBitmaps.CountOfPrivateIoBitmaps);
+
+    if (g_SharedBitmaps.MsrBitmapVirtualAddress != NULL)
+    {
+        ExFreePoolWithTag(g_SharedBitmaps.MsrBitmapVirtualAddress, POOLTAG);
+    }
+
+    if (g_SharedBitmaps.IoBitmapVirtualAddressA != NULL)
+    {
+        ExFreePoolWithTag(g_SharedBitmaps.IoBitmapVirtualAddressA, POOLTAG);
+    }
+
+    RtlZeroMemory(&g_SharedBitmaps, sizeof(SHARED_BITMAPS));
+}
+
+/**
+ * @brief Allocate a private copy of the MSR bitmap or the I/O bitmaps of a
+ * core and request the core to use it
+ * @details The private copy can only be allocated from vmx non-root, from
+ * vmx-root it only checks whether the core already has a private copy or not
+ *
+ * @param CoreId The target core
+ * @param IsMsrBitmap Whether the MSR bitmap or the I/O bitmaps are targeted
+ * @return BOOLEAN Returns TRUE if the core has (or will have) a private copy
+ */
+BOOLEAN
+SharedBitmapsMakePrivate(UINT32 CoreId, BOOLEAN IsMsrBitmap)
+{
+    PVOID * PrivateBitmap;
+    PVOID   Buffer;
+    UINT32  Size;
+
+    if (IsMsrBitmap)
+    {
+        PrivateBitmap = &g_GuestState[CoreId].PrivateMsrBitmapVirtualAddress;
+        Size          = PAGE_SIZE;
+    }
+    else
+    {
+        PrivateBitmap = &g_GuestState[CoreId].PrivateIoBitmapsVirtualAddress;
+        Size          = PAGE_SIZE * 2;
+    }
+
+    if (*PrivateBitmap != NULL)
+    {
+        return TRUE;
+    }
+
+    if (g_GuestState[KeGetCurrentProcessorNumber()].IsOnVmxRootMode)
+    {
+        return FALSE;
+    }
+
+    Buffer = ExAllocatePoolWithTag(NonPagedPool, Size, POOLTAG);
+
+    if (Buffer == NULL)
+    {
+        return FALSE;
+    }
+
+    //
+    // The changes of all cores are requested for this core from now on,
+    // the changes before this point are copied from the shared bitmaps
+    // when the core switches to the private copy
+    //
+    if (InterlockedCompareExchangePointer(PrivateBitmap, Buffer, NULL) != NULL)
+    {
+        ExFreePoolWithTag(Buffer, POOLTAG);
+        return TRUE;
+    }
+
+    //
+    // The physical addresses are resolved here as the core switches to the
+    // private copy in vmx-root (the switch is requested after this point)
+    //
+    if (IsMsrBitmap)
+    {
+        g_GuestState[CoreId].PrivateMsrBitmapPhysicalAddress = VirtualAddressToPhysicalAddress(Buffer);
+
+        InterlockedIncrement(&g_SharedBitmaps.CountOfPrivateMsrBitmaps);
+        return PendingControlsRequest(CoreId, VMCALL_USE_PRIVATE_MSR_BITMAP, 0);
+    }
+    else
+    {
+        g_GuestState[CoreId].PrivateIoBitmapsPhysicalAddressA = VirtualAddressToPhysicalAddress(Buffer);
+        g_GuestState[CoreId].PrivateIoBitmapsPhysicalAddressB = VirtualAddressToPhysicalAddress((UINT64)Buffer + PAGE_SIZE);
+
+        InterlockedIncrement(&g_SharedBitmaps.CountOfPrivateIoBitmaps);
+        return PendingControlsRequest(CoreId, VMCALL_USE_PRIVATE_IO_BITMAPS, 0);
+    }
+}
+
+/**
+ * @brief Switch the current core to its private MSR bitmap
+ * @details Should be called from vmx-root
+ *
+ * @param CoreIndex Index of the current core
+ * @return VOID
+ */
+VOID
+SharedBitmapsUsePrivateMsrBitmap(UINT32 CoreIndex)
+{
+    PVIRTUAL_MACHINE_STATE CurrentGuestState = &g_GuestState[CoreIndex];
+
+    if (CurrentGuestState->PrivateMsrBitmapVirtualAddress == NULL ||
+        CurrentGuestState->MsrBitmapVirtualAddress == (UINT64)CurrentGuestState->PrivateMsrBitmapVirtualAddress)
+    {
+        return;
+    }
+
+    memcpy(CurrentGuestState->PrivateMsrBitmapVirtualAddress, g_SharedBitmaps.MsrBitmapVirtualAddress, PAGE_SIZE);
+
+    CurrentGuestState->MsrBitmapVirtualAddress  = (UINT64)CurrentGuestState->PrivateMsrBitmapVirtualAddress;
+    CurrentGuestState->MsrBitmapPhysicalAddress = CurrentGuestState->PrivateMsrBitmapPhysicalAddress;
+
+    __vmx_vmwrite(MSR_BITMAP, CurrentGuestState->MsrBitmapPhysicalAddress);
+}
+
+/**
+ * @brief Switch the current core to its private I/O bitmaps
+ * @details Should be called from vmx-root
+ *
+ * @param CoreIndex Index of the current core
+ * @return VOID
+ */
+VOID
+SharedBitmapsUsePrivateIoBitmaps(UINT32 CoreIndex)
+{
+    PVIRTUAL_MACHINE_STATE CurrentGuestState = &g_GuestState[CoreIndex];
+
+    if (CurrentGuestState->PrivateIoBitmapsVirtualAddress == NULL ||
+        CurrentGuestState->IoBitmapVirtualAddressA == (UINT64)CurrentGuestState->PrivateIoBitmapsVirtualAddress)
+    {
+        return;
+    }
+
+    memcpy(CurrentGuestState->PrivateIoBitmapsVirtualAddress, g_SharedBitmaps.IoBitmapVirtualAddressA, PAGE_SIZE);
+    memcpy((UINT64)CurrentGuestState->PrivateIoBitmapsVirtualAddress + PAGE_SIZE, g_SharedBitmaps.IoBitmapVirtualAddressB, PAGE_SIZE);
+
+    CurrentGuestState->IoBitmapVirtualAddressA  = (UINT64)CurrentGuestState->PrivateIoBitmapsVirtualAddress;
+    CurrentGuestState->IoBitmapVirtualAddressB  = CurrentGuestState->IoBitmapVirtualAddressA + PAGE_SIZE;
+    CurrentGuestState->IoBitmapPhysicalAddressA = CurrentGuestState->PrivateIoBitmapsPhysicalAddressA;
+    CurrentGuestState->IoBitmapPhysicalAddressB = CurrentGuestState->PrivateIoBitmapsPhysicalAddressB;
+
+    __vmx_vmwrite(IO_BITMAP_A, CurrentGuestState->IoBitmapPhysicalAddressA);
+    __vmx_vmwrite(IO_BITMAP_B, CurrentGuestState->IoBitmapPhysicalAddressB);
+}
+
+/**
+ * @brief Free the private bitmaps of a core
+ * @details Should be called after the core is terminated
+ *
+ * @param CoreIndex Index of the core
+ * @return VOID
+ */
+VOID
+SharedBitmapsFreePrivateBitmaps(UINT32 CoreIndex)
+{
+    if (g_GuestState[CoreIndex].PrivateMsrBitmapVirtualAddress != NULL)
+    {
+        ExFreePoolWithTag(g_GuestState[CoreIndex].PrivateMsrBitmapVirtualAddress, POOLTAG);
+        g_GuestState[CoreIndex].PrivateMsrBitmapVirtualAddress  = NULL;
+        g_GuestState[CoreIndex].PrivateMsrBitmapPhysicalAddress = 0;
+    }
+
+    if (g_GuestState[CoreIndex].PrivateIoBitmapsVirtualAddress != NULL)
+    {
+        ExFreePoolWithTag(g_GuestState[CoreIndex].PrivateIoBitmapsVirtualAddress, POOLTAG);
+        g_GuestState[CoreIndex].PrivateIoBitmapsVirtualAddress   = NULL;
+        g_GuestState[CoreIndex].PrivateIoBitmapsPhysicalAddressA = 0;
+        g_GuestState[CoreIndex].PrivateIoBitmapsPhysicalAddressB = 0;
+    }
+}
+
+/**
+ * @brief Apply a change to the shared bitmaps
+ * @details Can be called from both vmx-root and vmx non-root, the bits
+ * are set atomically so the cores see the change in their next access
+ *
+ * @param VmcallNumber The VMCALL that applies the change to a core
+ * @param Parameter Parameter of the VMCALL
+ * @return VOID
+ */
+VOID
+SharedBitmapsApplyChange(UINT64 VmcallNumber, UINT64 Parameter)
+{
+    UINT64 MsrBitmap = g_SharedBitmaps.MsrBitmapVirtualAddress;
+
+    switch (VmcallNumber)
+    {
+    case VMCALL_CHANGE_MSR_BITMAP_READ:
+    case VMCALL_CHANGE_MSR_BITMAP_WRITE:
+
+        //
+        // The write bitmaps are after the read bitmaps
+        //
+        if (VmcallNumber == VMCALL_CHANGE_MSR_BITMAP_WRITE)
+        {
+            MsrBitmap += 2048;
+        }
+
+        if (Parameter == DEBUGGER_EVENT_MSR_READ_OR_WRITE_ALL_MSRS)
+        {
+            memset(MsrBitmap, 0xff, 2048);
+        }
+        else if (Parameter <= 0x00001FFF)
+        {
+            SetBit(Parameter, MsrBitmap);
+        }
+        else if ((0xC0000000 <= Parameter) && (Parameter <= 0xC0001FFF))
+        {
+            SetBit(Parameter - 0xC0000000, MsrBitmap + 1024);
+        }
+        break;
+
+    case VMCALL_RESET_MSR_BITMAP_READ:
+        memset(MsrBitmap, 0x0, 2048);
+        break;
+
+    case VMCALL_RESET_MSR_BITMAP_WRITE:
+        memset(MsrBitmap + 2048, 0x0, 2048);
+        break;
+
+    case VMCALL_CHANGE_IO_BITMAP:
+
+        if (Parameter == DEBUGGER_EVENT_ALL_IO_PORTS)
+        {
+            memset(g_SharedBitmaps.IoBitmapVirtualAddressA, 0xff, PAGE_SIZE);
+            memset(g_SharedBitmaps.IoBitmapVirtualAddressB, 0xff, PAGE_SIZE);
+        }
+        else if (Parameter <= 0x7FFF)
+        {
+            SetBit(Parameter, g_SharedBitmaps.IoBitmapVirtualAddressA);
+        }
+        else if ((0x8000 <= Parameter) && (Parameter <= 0xFFFF))
+        {
+            SetBit(Parameter - 0x8000, g_SharedBitmaps.IoBitmapVirtualAddressB);
+        }
+        break;
+
+    case VMCALL_RESET_IO_BITMAP:
+        memset(g_SharedBitmaps.IoBitmapVirtualAddressA, 0x0, PAGE_SIZE);
+        memset(g_SharedBitmaps.IoBitmapVirtualAddressB, 0x0, PAGE_SIZE);
+        break;
+
+    default:
+        LogError("Err, the change of the bitmaps is not supported");
+        return;
+    }
+
+    InterlockedIncrement64(&g_SharedBitmaps.CountOfSharedChanges);
+}
+
+/**
+ * @brief Request a change of the MSR bitmap or the I/O bitmaps of a core
+ * or all of the cores
+ * @details Can be called from both vmx-root and vmx non-root
+ *
+ * @param CoreId The target core or PENDING_CONTROLS_ALL_CORES
+ * @param VmcallNumber The VMCALL that applies the change to a core
+ * @param Parameter Parameter of the VMCALL
+ * @return BOOLEAN Returns FALSE if the change can't be requested for a core
+ */
+BOOLEAN
+SharedBitmapsRequestChange(UINT32 CoreId, UINT64 VmcallNumber, UINT64 Parameter)
+{
+#if ShareMsrAndIoBitmaps
+
+    BOOLEAN IsMsrBitmap;
+    BOOLEAN IsReset;
+    BOOLEAN IsSuccessful = TRUE;
+    UINT32  ProcessorsCount;
+
+    IsMsrBitmap = PendingControlsGetFamily(VmcallNumber, &IsReset) != PENDING_CONTROLS_FAMILY_IO_BITMAP;
+
+    if (CoreId != PENDING_CONTROLS_ALL_CORES)
+    {
+        if (SharedBitmapsMakePrivate(CoreId, IsMsrBitmap))
+        {
+            return PendingControlsRequest(CoreId, VmcallNumber, Parameter);
+        }
+        else
+        {
+            //
+            // The private copy can't be allocated, the change is applied to
+            // all cores (the events of other cores are ignored by the
+            // dispatcher so it only causes extra vm-exits)
+            //
+            LogError("Err, unable to allocate private bitmaps for core %d, the change is applied to all cores",
+                     CoreId);
+
+            SharedBitmapsApplyChange(VmcallNumber, Parameter);
+        }
+
+        return TRUE;
+    }
+
+    //
+    // The shared bitmaps are changed directly, then the change is requested
+    // for the cores that have a private copy (the memory barrier makes sure
+    // that a core that is switching to a private copy either copies this
+    // change or it's requested for it)
+    //
+    SharedBitmapsApplyChange(VmcallNumber, Parameter);
+
+    MemoryBarrier();
+
+    ProcessorsCount = KeQueryActiveProcessorCount(0);
+
+    PendingControlsBeginBatch();
+
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        if ((IsMsrBitmap && g_GuestState[i].PrivateMsrBitmapVirtualAddress != NULL) ||
+            (!IsMsrBitmap && g_GuestState[i].PrivateIoBitmapsVirtualAddress != NULL))
+        {
+            if (!PendingControlsRequest(i, VmcallNumber, Parameter))
+            {
+                IsSuccessful = FALSE;
+            }
+        }
+    }
+
+    PendingControlsEndBatch();
+
+    return IsSuccessful;
+
+#else
+
+    return PendingControlsRequest(CoreId, VmcallNumber, Parameter);
+
+#endif
+}
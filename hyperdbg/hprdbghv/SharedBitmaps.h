@@ -0,0 +1,76 @@
+/**
+ * @file SharedBitmaps.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the MSR and I/O bitmaps that are shared between the cores
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The MSR and I/O bitmaps that are used by all of the cores that
+ * don't have core-specific events
+ *
+ */
+typedef struct _SHARED_BITMAPS
+{
+    UINT64        MsrBitmapVirtualAddress;   // Msr Bitmap Virtual Address
+    UINT64        MsrBitmapPhysicalAddress;  // Msr Bitmap Physical Address
+    UINT64        IoBitmapVirtualAddressA;   // I/O Bitmap Virtual Address (A)
+    UINT64        IoBitmapPhysicalAddressA;  // I/O Bitmap Physical Address (A)
+    UINT64        IoBitmapVirtualAddressB;   // I/O Bitmap Virtual Address (B)
+    UINT64        IoBitmapPhysicalAddressB;  // I/O Bitmap Physical Address (B)
+    volatile LONG CountOfPrivateMsrBitmaps;  // Count of the cores that use a private MSR bitmap
+    volatile LONG CountOfPrivateIoBitmaps;   // Count of the cores that use private I/O bitmaps
+    UINT64        CountOfSharedChanges;      // Count of the changes that are applied to the shared bitmaps
+
+} SHARED_BITMAPS, *PSHARED_BITMAPS;
+
+//////////////////////////////////////////////////
+//                   Variables	    			//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The bitmaps that are shared between the cores
+ *
+ */
+SHARED_BITMAPS g_SharedBitmaps;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SharedBitmapsAllocateMsrBitmap();
+
+BOOLEAN
+SharedBitmapsAllocateIoBitmaps();
+
+VOID
+SharedBitmapsUninitialize();
+
+BOOLEAN
+SharedBitmapsMakePrivate(UINT32 CoreId, BOOLEAN IsMsrBitmap);
+
+VOID
+SharedBitmapsUsePrivateMsrBitmap(UINT32 CoreIndex);
+
+VOID
+SharedBitmapsUsePrivateIoBitmaps(UINT32 CoreIndex);
+
+VOID
+SharedBitmapsFreePrivateBitmaps(UINT32 CoreIndex);
+
+VOID
+SharedBitmapsApplyChange(UINT64 VmcallNumber, UINT64 Parameter);
+
+BOOLEAN
+SharedBitmapsRequestChange(UINT32 CoreId, UINT64 VmcallNumber, UINT64 Parameter);
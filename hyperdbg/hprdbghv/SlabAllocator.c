@@ -0,0 +1,484 @@
+/**
+ * @file SlabAllocator.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief The slab allocator of the pool manager
+ * @details The objects of each size class are carved from 64KB slabs that
+ * are aligned to their size, the header of each slab is at its start so the
+ * slab (and the cache) of an object is found by masking its address. The
+ * base addresses of the slabs are kept in a directory (open addressing hash)
+ * to validate the freed addresses without walking any list. The free objects
+ * are kept in lock-free lists (a magazine for each core and a shared depot)
+ * so the allocations and the frees are O(1) and safe in vmx-root
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Get the size class of an object
+ *
+ * @param Size Size of the object
+ * @return UINT32 The size class or zero if the object is larger than the
+ * largest size class
+ */
+UINT32
+SlabGetSizeClass(SIZE_T Size)
+{
+    UINT32 SizeClass = SLAB_MINIMUM_OBJECT_SIZE;
+
+    if (Size > SLAB_MAXIMUM_OBJECT_SIZE)
+    {
+        return 0;
+    }
+
+    if (Size > PAGE_SIZE)
+    {
+        return (UINT32)((Size + PAGE_SIZE - 1) & ~((SIZE_T)PAGE_SIZE - 1));
+    }
+
+    while (SizeClass < Size)
+    {
+        SizeClass <<= 1;
+    }
+
+    return SizeClass;
+}
+
+/**
+ * @brief Get the index of the first entry of the directory that might
+ * contain a slab
+ *
+ * @param SlabBase Base address of the slab
+ * @return UINT32
+ */
+UINT32
+SlabDirectoryHash(UINT64 SlabBase)
+{
+    return (UINT32)(((SlabBase / SLAB_SIZE) * 0x9E3779B97F4A7C15ULL) >> 32) & (SLAB_DIRECTORY_SIZE - 1);
+}
+
+/**
+ * @brief Add a slab to the directory
+ * @details Should be called after the header of the slab is initialized,
+ * the slabs are only added by SlabGrowCache so no lock is needed
+ *
+ * @param Allocator The allocator
+ * @param SlabBase Base address of the slab
+ * @return VOID
+ */
+VOID
+SlabDirectoryInsert(PSLAB_ALLOCATOR Allocator, UINT64 SlabBase)
+{
+    UINT32 Index = SlabDirectoryHash(SlabBase);
+
+    while (Allocator->Directory[Index] != 0)
+    {
+        Index = (Index + 1) & (SLAB_DIRECTORY_SIZE - 1);
+    }
+
+    //
+    // The lookups on other cores read the header after they see the entry
+    //
+    MemoryBarrier();
+
+    Allocator->Directory[Index] = SlabBase;
+    Allocator->CountOfSlabs++;
+}
+
+/**
+ * @brief Initialize the allocator
+ *
+ * @param Allocator The allocator
+ * @param CountOfCores Count of the magazines of each cache
+ * @param AllocateMemory The routine that allocates the arenas
+ * @param FreeMemory The routine that frees the arenas
+ * @return VOID
+ */
+VOID
+SlabInitializeAllocator(PSLAB_ALLOCATOR Allocator, UINT32 CountOfCores, SLAB_ALLOCATE_MEMORY AllocateMemory, SLAB_FREE_MEMORY FreeMemory)
+{
+    RtlZeroMemory(Allocator, sizeof(SLAB_ALLOCATOR));
+
+    Allocator->CountOfCores   = CountOfCores;
+    Allocator->AllocateMemory = AllocateMemory;
+    Allocator->FreeMemory     = FreeMemory;
+}
+
+/**
+ * @brief Free all of the arenas of the allocator
+ * @details The caches should be uninitialized separately
+ *
+ * @param Allocator The allocator
+ * @return VOID
+ */
+VOID
+SlabUninitializeAllocator(PSLAB_ALLOCATOR Allocator)
+{
+    for (UINT32 i = 0; i < Allocator->CountOfArenas; i++)
+    {
+        Allocator->FreeMemory(Allocator->Arenas[i]);
+    }
+
+    Allocator->CountOfArenas = 0;
+    Allocator->CountOfSlabs  = 0;
+    Allocator->NextSlab      = 0;
+    Allocator->EndOfArena    = 0;
+
+    RtlZeroMemory((PVOID)Allocator->Directory, sizeof(Allocator->Directory));
+}
+
+/**
+ * @brief Initialize a cache, the cache doesn't have any object until
+ * it's grown
+ *
+ * @param Allocator The allocator
+ * @param Cache The cache
+ * @param ObjectSize Size of the objects of the cache
+ * @return BOOLEAN Returns FALSE if the size is not supported or the
+ * magazines can't be allocated
+ */
+BOOLEAN
+SlabInitializeCache(PSLAB_ALLOCATOR Allocator, PSLAB_CACHE Cache, SIZE_T ObjectSize)
+{
+    UINT32 SizeClass = SlabGetSizeClass(ObjectSize);
+
+    if (SizeClass == 0)
+    {
+        return FALSE;
+    }
+
+    RtlZeroMemory(Cache, sizeof(SLAB_CACHE));
+
+    Cache->Magazines = Allocator->AllocateMemory(sizeof(SLIST_HEADER) * Allocator->CountOfCores);
+
+    if (Cache->Magazines == NULL)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 0; i < Allocator->CountOfCores; i++)
+    {
+        InitializeSListHead(&Cache->Magazines[i]);
+    }
+
+    InitializeSListHead(&Cache->Depot);
+    InitializeSListHead(&Cache->Deferred);
+
+    Cache->CountOfMagazines = Allocator->CountOfCores;
+    Cache->ObjectSize       = SizeClass;
+
+    return TRUE;
+}
+
+/**
+ * @brief Uninitialize a cache
+ * @details The slabs of the cache are freed with the arenas of the allocator
+ *
+ * @param Allocator The allocator
+ * @param Cache The cache
+ * @return VOID
+ */
+VOID
+SlabUninitializeCache(PSLAB_ALLOCATOR Allocator, PSLAB_CACHE Cache)
+{
+    if (Cache->Magazines != NULL)
+    {
+        Allocator->FreeMemory(Cache->Magazines);
+    }
+
+    RtlZeroMemory(Cache, sizeof(SLAB_CACHE));
+}
+
+/**
+ * @brief Add a new slab to a cache and put its objects in the depot
+ * @details Should not be called from vmx-root (it might allocate a new arena)
+ * and the calls should be serialized by the caller
+ *
+ * @param Allocator The allocator
+ * @param Cache The cache
+ * @return BOOLEAN Returns FALSE if there is no memory for a new slab
+ */
+BOOLEAN
+SlabGrowCache(PSLAB_ALLOCATOR Allocator, PSLAB_CACHE Cache)
+{
+    PSLAB_HEADER Slab;
+    PVOID        Arena;
+    UINT64       Object;
+
+    if (Allocator->CountOfSlabs >= SLAB_DIRECTORY_MAXIMUM_SLABS)
+    {
+        return FALSE;
+    }
+
+    if (Allocator->NextSlab == Allocator->EndOfArena)
+    {
+        if (Allocator->CountOfArenas == SLAB_MAXIMUM_ARENAS)
+        {
+            return FALSE;
+        }
+
+        //
+        // An extra slab is allocated so the slabs can be aligned to their size
+        //
+        Arena = Allocator->AllocateMemory((SLAB_ARENA_SLABS + 1) * SLAB_SIZE);
+
+        if (Arena == NULL)
+        {
+            return FALSE;
+        }
+
+        Allocator->Arenas[Allocator->CountOfArenas++] = Arena;
+
+        Allocator->NextSlab   = ((UINT64)Arena + SLAB_SIZE - 1) & ~((UINT64)SLAB_SIZE - 1);
+        Allocator->EndOfArena = Allocator->NextSlab + (SLAB_ARENA_SLABS * SLAB_SIZE);
+    }
+
+    Slab = (PSLAB_HEADER)Allocator->NextSlab;
+    Allocator->NextSlab += SLAB_SIZE;
+
+    RtlZeroMemory(Slab, SLAB_SIZE);
+
+    //
+    // The objects are aligned to their size (up to a page), so the objects
+    // that are larger than a page start at page boundaries
+    //
+    Slab->Cache             = Cache;
+    Slab->ObjectSize        = Cache->ObjectSize;
+    Slab->FirstObjectOffset = (sizeof(SLAB_HEADER) + min(Cache->ObjectSize, PAGE_SIZE) - 1) & ~(min(Cache->ObjectSize, PAGE_SIZE) - 1);
+    Slab->CountOfObjects    = (SLAB_SIZE - Slab->FirstObjectOffset) / Cache->ObjectSize;
+
+    SlabDirectoryInsert(Allocator, (UINT64)Slab);
+
+    for (UINT32 i = 0; i < Slab->CountOfObjects; i++)
+    {
+        Object = (UINT64)Slab + Slab->FirstObjectOffset + ((UINT64)i * Cache->ObjectSize);
+
+        InterlockedPushEntrySList(&Cache->Depot, (PSLIST_ENTRY)Object);
+    }
+
+    InterlockedAdd64(&Cache->FreeObjects, Slab->CountOfObjects);
+    InterlockedIncrement64(&Cache->CountOfSlabs);
+
+    return TRUE;
+}
+
+/**
+ * @brief Find the slab of an object
+ * @details Can be called from both vmx-root and vmx non-root
+ *
+ * @param Allocator The allocator
+ * @param Address Address of the object
+ * @param Index Index of the object in the slab
+ * @return PSLAB_HEADER The slab or NULL if the address is not the start
+ * of an object
+ */
+PSLAB_HEADER
+SlabLookup(PSLAB_ALLOCATOR Allocator, UINT64 Address, UINT32 * Index)
+{
+    UINT64       SlabBase = Address & ~((UINT64)SLAB_SIZE - 1);
+    UINT32       Entry    = SlabDirectoryHash(SlabBase);
+    PSLAB_HEADER Slab;
+    UINT64       Offset;
+
+    while (Allocator->Directory[Entry] != SlabBase)
+    {
+        if (Allocator->Directory[Entry] == 0)
+        {
+            return NULL;
+        }
+
+        Entry = (Entry + 1) & (SLAB_DIRECTORY_SIZE - 1);
+    }
+
+    Slab   = (PSLAB_HEADER)SlabBase;
+    Offset = Address - SlabBase;
+
+    if (Offset < Slab->FirstObjectOffset || (Offset - Slab->FirstObjectOffset) % Slab->ObjectSize != 0)
+    {
+        return NULL;
+    }
+
+    *Index = (UINT32)((Offset - Slab->FirstObjectOffset) / Slab->ObjectSize);
+
+    if (*Index >= Slab->CountOfObjects)
+    {
+        return NULL;
+    }
+
+    return Slab;
+}
+
+/**
+ * @brief Allocate an object from a cache
+ * @details Can be called from both vmx-root and vmx non-root, the object
+ * is zeroed
+ *
+ * @param Cache The cache
+ * @param Core The current core (index of its magazine)
+ * @return PVOID The object or NULL if the cache doesn't have a free object
+ */
+PVOID
+SlabAllocate(PSLAB_CACHE Cache, UINT32 Core)
+{
+    PSLIST_ENTRY Entry;
+    PSLAB_HEADER Slab;
+    UINT32       Index;
+
+    Entry = InterlockedPopEntrySList(&Cache->Magazines[Core]);
+
+    if (Entry == NULL)
+    {
+        Entry = InterlockedPopEntrySList(&Cache->Depot);
+    }
+
+    //
+    // The objects that are freed on the other cores stay in their magazines
+    // until those cores allocate them, so they're taken before giving up
+    //
+    for (UINT32 i = 1; Entry == NULL && i < Cache->CountOfMagazines; i++)
+    {
+        Entry = InterlockedPopEntrySList(&Cache->Magazines[(Core + i) % Cache->CountOfMagazines]);
+    }
+
+    if (Entry == NULL)
+    {
+        InterlockedIncrement64(&Cache->Exhaustions);
+        return NULL;
+    }
+
+    InterlockedDecrement64(&Cache->FreeObjects);
+
+    Slab  = (PSLAB_HEADER)((UINT64)Entry & ~((UINT64)SLAB_SIZE - 1));
+    Index = (UINT32)(((UINT64)Entry - (UINT64)Slab - Slab->FirstObjectOffset) / Slab->ObjectSize);
+
+    InterlockedBitTestAndSet64(&Slab->InUseBitmap[Index / 64], Index % 64);
+
+    //
+    // The rest of the object is zeroed when it's freed
+    //
+    RtlZeroMemory(Entry, sizeof(SLIST_ENTRY));
+
+    return Entry;
+}
+
+/**
+ * @brief Mark an object as free
+ *
+ * @param Allocator The allocator
+ * @param Object The object
+ * @return PSLAB_HEADER The slab of the object or NULL if it's not an
+ * allocated object
+ */
+PSLAB_HEADER
+SlabRelease(PSLAB_ALLOCATOR Allocator, PVOID Object)
+{
+    PSLAB_HEADER Slab;
+    UINT32       Index;
+
+    Slab = SlabLookup(Allocator, (UINT64)Object, &Index);
+
+    if (Slab == NULL)
+    {
+        return NULL;
+    }
+
+    //
+    // The object is already free (double free)
+    //
+    if (!InterlockedBitTestAndReset64(&Slab->InUseBitmap[Index / 64], Index % 64))
+    {
+        return NULL;
+    }
+
+    return Slab;
+}
+
+/**
+ * @brief Free an object, the object is immediately reusable
+ * @details Can be called from both vmx-root and vmx non-root
+ *
+ * @param Allocator The allocator
+ * @param Object The object
+ * @param Core The current core (index of its magazine)
+ * @return BOOLEAN Returns FALSE if the address is not an allocated object
+ */
+BOOLEAN
+SlabFree(PSLAB_ALLOCATOR Allocator, PVOID Object, UINT32 Core)
+{
+    PSLAB_HEADER Slab = SlabRelease(Allocator, Object);
+    PSLAB_CACHE  Cache;
+
+    if (Slab == NULL)
+    {
+        return FALSE;
+    }
+
+    Cache = Slab->Cache;
+
+    RtlZeroMemory(Object, Cache->ObjectSize);
+
+    if (ExQueryDepthSList(&Cache->Magazines[Core]) < SLAB_MAGAZINE_SIZE)
+    {
+        InterlockedPushEntrySList(&Cache->Magazines[Core], Object);
+    }
+    else
+    {
+        InterlockedPushEntrySList(&Cache->Depot, Object);
+    }
+
+    InterlockedIncrement64(&Cache->FreeObjects);
+
+    return TRUE;
+}
+
+/**
+ * @brief Free an object, the object is not reusable until the deferred
+ * objects of its cache are reclaimed
+ * @details Can be called from both vmx-root and vmx non-root
+ *
+ * @param Allocator The allocator
+ * @param Object The object
+ * @return BOOLEAN Returns FALSE if the address is not an allocated object
+ */
+BOOLEAN
+SlabDeferFree(PSLAB_ALLOCATOR Allocator, PVOID Object)
+{
+    PSLAB_HEADER Slab = SlabRelease(Allocator, Object);
+
+    if (Slab == NULL)
+    {
+        return FALSE;
+    }
+
+    InterlockedPushEntrySList(&Slab->Cache->Deferred, Object);
+
+    return TRUE;
+}
+
+/**
+ * @brief Zero the deferred objects of a cache and put them in the depot
+ *
+ * @param Cache The cache
+ * @return VOID
+ */
+VOID
+SlabReclaimDeferred(PSLAB_CACHE Cache)
+{
+    PSLIST_ENTRY Entry = InterlockedFlushSList(&Cache->Deferred);
+    PSLIST_ENTRY Next;
+
+    while (Entry != NULL)
+    {
+        Next = Entry->Next;
+
+        RtlZeroMemory(Entry, Cache->ObjectSize);
+        InterlockedPushEntrySList(&Cache->Depot, Entry);
+        InterlockedIncrement64(&Cache->FreeObjects);
+
+        Entry = Next;
+    }
+}
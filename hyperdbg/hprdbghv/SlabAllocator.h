@@ -0,0 +1,186 @@
+/**
+ * @file SlabAllocator.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the slab allocator (used in the pool manager)
+ * @details The allocations and the frees of the objects don't depend on
+ * any kernel routine, the memory of the slabs is allocated by the routine
+ * that is passed to the allocator
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Size of each slab, the slabs are aligned to their size so the
+ * slab of an object is found by masking its address
+ *
+ */
+#define SLAB_SIZE 0x10000
+
+/**
+ * @brief Count of the slabs of each arena (the memory that is allocated at once)
+ *
+ */
+#define SLAB_ARENA_SLABS 16
+
+/**
+ * @brief Maximum count of the arenas
+ *
+ */
+#define SLAB_MAXIMUM_ARENAS 0x100
+
+/**
+ * @brief The smallest and the largest size classes, the classes are powers
+ * of two up to a page and multiples of pages after that
+ *
+ */
+#define SLAB_MINIMUM_OBJECT_SIZE 0x40
+#define SLAB_MAXIMUM_OBJECT_SIZE 0x8000
+
+/**
+ * @brief Maximum count of the objects of a slab
+ *
+ */
+#define SLAB_MAXIMUM_OBJECTS (SLAB_SIZE / SLAB_MINIMUM_OBJECT_SIZE)
+
+/**
+ * @brief Maximum count of the free objects in the magazine of each core,
+ * the rest of the free objects are kept in the depot of the cache
+ *
+ */
+#define SLAB_MAGAZINE_SIZE 16
+
+/**
+ * @brief Count of the entries of the directory of slabs (power of 2), at
+ * most 3/4 of them are used
+ *
+ */
+#define SLAB_DIRECTORY_SIZE          0x1000
+#define SLAB_DIRECTORY_MAXIMUM_SLABS ((SLAB_DIRECTORY_SIZE * 3) / 4)
+
+/**
+ * @brief Allocate the memory of an arena
+ *
+ * @param Size Size of the memory
+ * @return PVOID The memory or NULL if it's not allocated
+ */
+typedef PVOID (*SLAB_ALLOCATE_MEMORY)(SIZE_T Size);
+
+/**
+ * @brief Free the memory of an arena
+ *
+ * @param Memory The memory
+ * @return VOID
+ */
+typedef VOID (*SLAB_FREE_MEMORY)(PVOID Memory);
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Cache of the objects of a single size
+ * @details The free lists are lock-free (interlocked singly linked lists) and
+ * the free list entry of each object is kept in the object itself
+ *
+ */
+typedef struct _SLAB_CACHE
+{
+    SLIST_HEADER    Depot;             // Free objects that are shared between the cores
+    SLIST_HEADER    Deferred;          // Freed objects that are not reusable until they're reclaimed
+    PSLIST_HEADER   Magazines;         // Free objects of each core
+    UINT32          CountOfMagazines;  // Count of the magazines (cores)
+    UINT32          ObjectSize;        // Size of each object (the size class)
+    volatile LONG64 FreeObjects;       // Count of the objects in the magazines and the depot
+    volatile LONG64 CountOfSlabs;      // Count of the slabs of this cache
+    volatile LONG64 Exhaustions;       // Count of the allocations that there was no free object for them
+
+} SLAB_CACHE, *PSLAB_CACHE;
+
+/**
+ * @brief The header of a slab (at the start of the slab)
+ *
+ */
+typedef struct _SLAB_HEADER
+{
+    PSLAB_CACHE     Cache;                                  // The cache that the objects belong to
+    UINT32          ObjectSize;                             // Size of each object
+    UINT32          FirstObjectOffset;                      // Offset of the first object from the start of the slab
+    UINT32          CountOfObjects;                         // Count of the objects
+    volatile LONG64 InUseBitmap[SLAB_MAXIMUM_OBJECTS / 64]; // A bit for each allocated object
+
+} SLAB_HEADER, *PSLAB_HEADER;
+
+/**
+ * @brief State of the allocator
+ * @details Growing the caches should be serialized by the caller, the
+ * allocations and the frees can be performed concurrently on all cores
+ *
+ */
+typedef struct _SLAB_ALLOCATOR
+{
+    SLAB_ALLOCATE_MEMORY AllocateMemory;                 // The routine that allocates the arenas
+    SLAB_FREE_MEMORY     FreeMemory;                     // The routine that frees the arenas
+    UINT32               CountOfCores;                   // Count of the magazines of each cache
+    PVOID                Arenas[SLAB_MAXIMUM_ARENAS];    // The allocated arenas
+    UINT32               CountOfArenas;                  // Count of the allocated arenas
+    UINT64               NextSlab;                       // The next unused slab of the last arena
+    UINT64               EndOfArena;                     // The end of the slabs of the last arena
+    UINT32               CountOfSlabs;                   // Count of the slabs in the directory
+    volatile UINT64      Directory[SLAB_DIRECTORY_SIZE]; // Base address of the slabs (open addressing)
+
+} SLAB_ALLOCATOR, *PSLAB_ALLOCATOR;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+UINT32
+SlabGetSizeClass(SIZE_T Size);
+
+UINT32
+SlabDirectoryHash(UINT64 SlabBase);
+
+VOID
+SlabDirectoryInsert(PSLAB_ALLOCATOR Allocator, UINT64 SlabBase);
+
+VOID
+SlabInitializeAllocator(PSLAB_ALLOCATOR Allocator, UINT32 CountOfCores, SLAB_ALLOCATE_MEMORY AllocateMemory, SLAB_FREE_MEMORY FreeMemory);
+
+VOID
+SlabUninitializeAllocator(PSLAB_ALLOCATOR Allocator);
+
+BOOLEAN
+SlabInitializeCache(PSLAB_ALLOCATOR Allocator, PSLAB_CACHE Cache, SIZE_T ObjectSize);
+
+VOID
+SlabUninitializeCache(PSLAB_ALLOCATOR Allocator, PSLAB_CACHE Cache);
+
+BOOLEAN
+SlabGrowCache(PSLAB_ALLOCATOR Allocator, PSLAB_CACHE Cache);
+
+PSLAB_HEADER
+SlabLookup(PSLAB_ALLOCATOR Allocator, UINT64 Address, UINT32 * Index);
+
+PVOID
+SlabAllocate(PSLAB_CACHE Cache, UINT32 Core);
+
+PSLAB_HEADER
+SlabRelease(PSLAB_ALLOCATOR Allocator, PVOID Object);
+
+BOOLEAN
+SlabFree(PSLAB_ALLOCATOR Allocator, PVOID Object, UINT32 Core);
+
+BOOLEAN
+SlabDeferFree(PSLAB_ALLOCATOR Allocator, PVOID Object);
+
+VOID
+SlabReclaimDeferred(PSLAB_CACHE Cache);
@@ -144,7 +144,7 @@ SteppingsUninitialize()
         //
         // Free the buffer
         //
-        MmFreeContiguousMemory(g_EptState->SecondaryEptPageTable);
+        EptFreeIdentityPageTable(g_EptState->SecondaryEptPageTable);
     }
 
     //
@@ -653,10 +653,10 @@ SteppingsSwapPageWithInfiniteLoop(PVOID TargetAddress, CR3_TYPE ProcessCr3, UINT
     }
 
     //
-    // Set target buffer, request buffer from pool manager,
-    // we also need to allocate new page to replace the current page ASAP
+    // Set target buffer, take a table from the split pool, the pool
+    // is refilled in the background if it's running low
     //
-    TargetBuffer = PoolManagerRequestPool(SPLIT_2MB_PAGING_TO_4KB_PAGE, TRUE, sizeof(VMM_EPT_DYNAMIC_SPLIT));
+    TargetBuffer = EptSplitPoolAcquire();
 
     if (!TargetBuffer)
     {
@@ -72,7 +72,7 @@ TerminateExternalInterruptEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformSetExternalInterruptExitingOnSingleCore, NULL);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_ENABLE_EXTERNAL_INTERRUPT_EXITING, 0);
                 }
             }
         }
@@ -118,10 +118,17 @@ TerminateHiddenHookReadAndWriteEvent(PDEBUGGER_EVENT Event)
     PagesBytes = PAGE_ALIGN(TempOptionalParam1);
     PagesBytes = PhysicalAddressToVirtualAddressByProcessId(Event->OptionalParam2, Event->ProcessId) - PagesBytes;
 
+    //
+    // Unhook all of the pages in a single transaction
+    //
+    EptTransactionBegin();
+
     for (size_t i = 0; i <= PagesBytes / PAGE_SIZE; i++)
     {
         EptHookUnHookSingleAddress((UINT64)TempOptionalParam1 + (i * PAGE_SIZE), Event->ProcessId);
     }
+
+    EptTransactionCommit();
 }
 
 /**
@@ -151,10 +158,17 @@ TerminateHiddenHookReadEvent(PDEBUGGER_EVENT Event)
     PagesBytes = PAGE_ALIGN(TempOptionalParam1);
     PagesBytes = PhysicalAddressToVirtualAddressByProcessId(Event->OptionalParam2, Event->ProcessId) - PagesBytes;
 
+    //
+    // Unhook all of the pages in a single transaction
+    //
+    EptTransactionBegin();
+
     for (size_t i = 0; i <= PagesBytes / PAGE_SIZE; i++)
     {
         EptHookUnHookSingleAddress((UINT64)TempOptionalParam1 + (i * PAGE_SIZE), Event->ProcessId);
     }
+
+    EptTransactionCommit();
 }
 
 /**
@@ -184,10 +198,17 @@ TerminateHiddenHookWriteEvent(PDEBUGGER_EVENT Event)
     PagesBytes = PAGE_ALIGN(TempOptionalParam1);
     PagesBytes = PhysicalAddressToVirtualAddressByProcessId(Event->OptionalParam2, Event->ProcessId) - PagesBytes;
 
+    //
+    // Unhook all of the pages in a single transaction
+    //
+    EptTransactionBegin();
+
     for (size_t i = 0; i <= PagesBytes / PAGE_SIZE; i++)
     {
         EptHookUnHookSingleAddress((UINT64)TempOptionalParam1 + (i * PAGE_SIZE), Event->ProcessId);
     }
+
+    EptTransactionCommit();
 }
 
 /**
@@ -306,7 +327,7 @@ TerminateRdmsrExecutionEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformChangeMsrBitmapReadOnSingleCore, CurrentEvent->OptionalParam1);
+                    SharedBitmapsRequestChange(CurrentEvent->CoreId, VMCALL_CHANGE_MSR_BITMAP_READ, CurrentEvent->OptionalParam1);
                 }
             }
         }
@@ -385,7 +406,7 @@ TerminateWrmsrExecutionEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformChangeMsrBitmapWriteOnSingleCore, CurrentEvent->OptionalParam1);
+                    SharedBitmapsRequestChange(CurrentEvent->CoreId, VMCALL_CHANGE_MSR_BITMAP_WRITE, CurrentEvent->OptionalParam1);
                 }
             }
         }
@@ -465,7 +486,7 @@ TerminateExceptionEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformSetExceptionBitmapOnSingleCore, CurrentEvent->OptionalParam1);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_SET_EXCEPTION_BITMAP, CurrentEvent->OptionalParam1);
                 }
             }
         }
@@ -551,7 +572,7 @@ TerminateInInstructionExecutionEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformChangeIoBitmapOnSingleCore, CurrentEvent->OptionalParam1);
+                    SharedBitmapsRequestChange(CurrentEvent->CoreId, VMCALL_CHANGE_IO_BITMAP, CurrentEvent->OptionalParam1);
                 }
             }
         }
@@ -637,7 +658,7 @@ TerminateOutInstructionExecutionEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformChangeIoBitmapOnSingleCore, CurrentEvent->OptionalParam1);
+                    SharedBitmapsRequestChange(CurrentEvent->CoreId, VMCALL_CHANGE_IO_BITMAP, CurrentEvent->OptionalParam1);
                 }
             }
         }
@@ -792,7 +813,7 @@ TerminateTscEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformEnableRdtscExitingOnSingleCore, NULL);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_SET_RDTSC_EXITING, 0);
                 }
             }
         }
@@ -871,7 +892,7 @@ TerminatePmcEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformEnableRdpmcExitingOnSingleCore, NULL);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_SET_RDPMC_EXITING, 0);
                 }
             }
         }
@@ -950,7 +971,7 @@ TerminateDebugRegistersEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformEnableMovToDebugRegistersExiting, NULL);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_ENABLE_MOV_TO_DEBUG_REGS_EXITING, 0);
                 }
             }
         }
@@ -1036,7 +1057,7 @@ TerminateSyscallHookEferEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformEnableEferSyscallHookOnSingleCore, NULL);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_ENABLE_SYSCALL_HOOK_EFER, 0);
                 }
             }
         }
@@ -1122,7 +1143,7 @@ TerminateSysretHookEferEvent(PDEBUGGER_EVENT Event)
                     //
                     // Just one core
                     //
-                    DpcRoutineRunTaskOnSingleCore(CurrentEvent->CoreId, DpcRoutinePerformEnableEferSyscallHookOnSingleCore, NULL);
+                    PendingControlsRequest(CurrentEvent->CoreId, VMCALL_ENABLE_SYSCALL_HOOK_EFER, 0);
                 }
             }
         }
@@ -355,6 +355,14 @@ TransparentAddNameOrProcessIdToTheList(PDEBUGGER_HIDE_AND_TRANSPARENT_DEBUGGER_M
     // vm-exits for them
     //
     InsertHeadList(&g_TransparentModeMeasurements->ProcessList, &(PidAndNameBuffer->OtherProcesses));
+
+    //
+    // The list is changed, the decisions that are cached on the cores
+    // are no longer valid
+    //
+    InterlockedIncrement(&g_TransparentModeProcessListVersion);
+
+    return TRUE;
 }
 
 /**
@@ -433,6 +441,38 @@ TransparentHideDebugger(PDEBUGGER_HIDE_AND_TRANSPARENT_DEBUGGER_MODE Measurement
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Log the average cycles of finding whether the current process
+ * is on the transparency list or not and reset the counters
+ * @details The misses show the cost of walking the list and matching the
+ * process names, the hits show the cost of using the cached decisions
+ * 
+ * @return VOID 
+ */
+VOID
+TransparentLogProcessCacheCounters()
+{
+    UINT32                ProcessorsCount = KeQueryActiveProcessorCount(0);
+    PVM_EXIT_TRANSPARENCY TransparencyState;
+
+    for (UINT32 i = 0; i < ProcessorsCount; i++)
+    {
+        TransparencyState = &g_GuestState[i].TransparencyState;
+
+        LogDebugInfo("Transparency process cache of core %d, hits: %lld (avg. %lld cycles), misses: %lld (avg. %lld cycles)",
+                     i,
+                     TransparencyState->CountOfProcessCacheHits,
+                     TransparencyState->CountOfProcessCacheHits == 0 ? 0 : TransparencyState->CyclesOfProcessCacheHits / TransparencyState->CountOfProcessCacheHits,
+                     TransparencyState->CountOfProcessCacheMisses,
+                     TransparencyState->CountOfProcessCacheMisses == 0 ? 0 : TransparencyState->CyclesOfProcessCacheMisses / TransparencyState->CountOfProcessCacheMisses);
+
+        TransparencyState->CountOfProcessCacheHits    = 0;
+        TransparencyState->CyclesOfProcessCacheHits   = 0;
+        TransparencyState->CountOfProcessCacheMisses  = 0;
+        TransparencyState->CyclesOfProcessCacheMisses = 0;
+    }
+}
+
 /**
  * @brief Deactive transparent-mode
  * 
@@ -451,6 +491,11 @@ TransparentUnhideDebugger()
         //
         g_TransparentMode = FALSE;
 
+        //
+        // Show the cost of finding the processes on the transparency list
+        //
+        TransparentLogProcessCacheCounters();
+
         //
         // Disable RDTSC and RDTSCP emulation
         //
@@ -483,6 +528,11 @@ TransparentUnhideDebugger()
             ExFreePoolWithTag(BufferToDeAllocate, POOLTAG);
         }
 
+        //
+        // The list is empty now, invalidate the cached decisions
+        //
+        InterlockedIncrement(&g_TransparentModeProcessListVersion);
+
         //
         // Deallocate the measurements buffer
         //
@@ -497,43 +547,18 @@ TransparentUnhideDebugger()
 }
 
 /**
- * @brief VM-Exit handler for different exit reasons 
+ * @brief Check whether a process is on the list of processes that
+ * transparent-mode is applied on them or not
  * @details Should be called from vmx-root
  * 
- * @param GuestRegs Registers that are automatically saved by AsmVmexitHandler (HOST_RIP)
- * @param ProcessorIndex Processor Index
- * @param ExitReason Exit Reason
- * @return BOOLEAN Return True we should emulate RDTSCP
- *  or return false if we should not emulate RDTSCP
+ * @param ProcessId Process Id of the process
+ * @param ProcessName Image file name of the process (might be null)
+ * @return BOOLEAN Returns true if the process is on the list
  */
 BOOLEAN
-TransparentModeStart(PGUEST_REGS GuestRegs, ULONG ProcessorIndex, UINT32 ExitReason)
+TransparentIsProcessOnTransparencyList(HANDLE ProcessId, PCHAR ProcessName)
 {
-    int         Aux                = 0;
-    ULONG64     GuestCsSel         = 0;
-    PLIST_ENTRY TempList           = 0;
-    PCHAR       CurrentProcessName = 0;
-    PCHAR       CurrentProcessId;
-    ULONG64     CurrrentTime;
-    HANDLE      CurrentThreadId;
-    BOOLEAN     Result                      = TRUE;
-    BOOLEAN     IsProcessOnTransparencyList = FALSE;
-
-    //
-    // Save the current time
-    //
-    CurrrentTime = __rdtscp(&Aux);
-
-    //
-    // Save time of vm-exit on each logical processor separately
-    //
-    g_GuestState[ProcessorIndex].TransparencyState.PreviousTimeStampCounter = CurrrentTime;
-
-    //
-    // Find the current process id and name
-    //
-    CurrentProcessId   = PsGetCurrentProcessId();
-    CurrentProcessName = GetProcessNameFromEprocess(PsGetCurrentProcess());
+    PLIST_ENTRY TempList = 0;
 
     //
     // Check for process id and process name, if not match then we don't emulate it
@@ -548,13 +573,9 @@ TransparentModeStart(PGUEST_REGS GuestRegs, ULONG ProcessorIndex, UINT32 ExitRea
             //
             // This entry is process id
             //
-            if (ProcessDetails->ProcessId == CurrentProcessId)
+            if ((HANDLE)ProcessDetails->ProcessId == ProcessId)
             {
-                //
-                // Let the transparency handler to handle it
-                //
-                IsProcessOnTransparencyList = TRUE;
-                break;
+                return TRUE;
             }
         }
         else
@@ -562,17 +583,89 @@ TransparentModeStart(PGUEST_REGS GuestRegs, ULONG ProcessorIndex, UINT32 ExitRea
             //
             // This entry is a process name
             //
-            if (CurrentProcessName != NULL && StartsWith(CurrentProcessName, ProcessDetails->ProcessName))
+            if (ProcessName != NULL && StartsWith(ProcessName, ProcessDetails->ProcessName))
             {
-                //
-                // Let the transparency handler to handle it
-                //
-                IsProcessOnTransparencyList = TRUE;
-                break;
+                return TRUE;
             }
         }
     }
 
+    return FALSE;
+}
+
+/**
+ * @brief VM-Exit handler for different exit reasons 
+ * @details Should be called from vmx-root
+ * 
+ * @param GuestRegs Registers that are automatically saved by AsmVmexitHandler (HOST_RIP)
+ * @param ProcessorIndex Processor Index
+ * @param ExitReason Exit Reason
+ * @return BOOLEAN Return True we should emulate RDTSCP
+ *  or return false if we should not emulate RDTSCP
+ */
+BOOLEAN
+TransparentModeStart(PGUEST_REGS GuestRegs, ULONG ProcessorIndex, UINT32 ExitReason)
+{
+    int     Aux                = 0;
+    ULONG64 GuestCsSel         = 0;
+    UINT64  GuestCr3           = 0;
+    LONG    ProcessListVersion = 0;
+    HANDLE  CurrentProcessId;
+    ULONG64 CurrrentTime;
+    HANDLE  CurrentThreadId;
+    BOOLEAN Result                      = TRUE;
+    BOOLEAN IsProcessOnTransparencyList = FALSE;
+
+    //
+    // Save the current time
+    //
+    CurrrentTime = __rdtscp(&Aux);
+
+    //
+    // Save time of vm-exit on each logical processor separately
+    //
+    g_GuestState[ProcessorIndex].TransparencyState.PreviousTimeStampCounter = CurrrentTime;
+
+    //
+    // Find the current process, the cr3 is used to find the cached decision
+    // and the process id avoids using a decision of a terminated process
+    // that its cr3 is reused
+    //
+    __vmx_vmread(GUEST_CR3, &GuestCr3);
+    CurrentProcessId   = PsGetCurrentProcessId();
+    ProcessListVersion = g_TransparentModeProcessListVersion;
+
+    if (TransparentProcessCacheLookup(g_GuestState[ProcessorIndex].TransparencyState.ProcessCache,
+                                      GuestCr3,
+                                      CurrentProcessId,
+                                      ProcessListVersion,
+                                      &IsProcessOnTransparencyList))
+    {
+        //
+        // The decision is made before for this process
+        //
+        g_GuestState[ProcessorIndex].TransparencyState.CountOfProcessCacheHits++;
+        g_GuestState[ProcessorIndex].TransparencyState.CyclesOfProcessCacheHits += __rdtsc() - CurrrentTime;
+    }
+    else
+    {
+        //
+        // It's a new process (or the list is changed), check the process id
+        // and the process name against the list and cache the decision
+        //
+        IsProcessOnTransparencyList = TransparentIsProcessOnTransparencyList(CurrentProcessId,
+                                                                             GetProcessNameFromEprocess(PsGetCurrentProcess()));
+
+        TransparentProcessCacheInsert(g_GuestState[ProcessorIndex].TransparencyState.ProcessCache,
+                                      GuestCr3,
+                                      CurrentProcessId,
+                                      ProcessListVersion,
+                                      IsProcessOnTransparencyList);
+
+        g_GuestState[ProcessorIndex].TransparencyState.CountOfProcessCacheMisses++;
+        g_GuestState[ProcessorIndex].TransparencyState.CyclesOfProcessCacheMisses += __rdtsc() - CurrrentTime;
+    }
+
     //
     // Check whether we find this process on transparency list or not
     //
@@ -18,12 +18,18 @@
 BOOLEAN
 TransparentModeStart(PGUEST_REGS GuestRegs, ULONG ProcessorIndex, UINT32 ExitReason);
 
+BOOLEAN
+TransparentIsProcessOnTransparencyList(HANDLE ProcessId, PCHAR ProcessName);
+
 NTSTATUS
 TransparentHideDebugger(PDEBUGGER_HIDE_AND_TRANSPARENT_DEBUGGER_MODE Measurements);
 
 NTSTATUS
 TransparentUnhideDebugger();
 
+VOID
+TransparentLogProcessCacheCounters();
+
 //////////////////////////////////////////////////
 //				   Definitions					//
 //////////////////////////////////////////////////
@@ -56,6 +62,12 @@ typedef struct _VM_EXIT_TRANSPARENCY
     UINT64  RevealedTimeStampCounterByRdtsc;
     BOOLEAN CpuidAfterRdtscDetected;
 
+    TRANSPARENCY_PROCESS_CACHE_ENTRY ProcessCache[TRANSPARENCY_PROCESS_CACHE_ENTRIES]; // Decisions of the recently seen processes
+    UINT64                           CountOfProcessCacheHits;                          // Count of the vm-exits that used a cached decision
+    UINT64                           CyclesOfProcessCacheHits;                         // Total cycles of finding the decision from the cache
+    UINT64                           CountOfProcessCacheMisses;                        // Count of the vm-exits that walked the transparency list
+    UINT64                           CyclesOfProcessCacheMisses;                       // Total cycles of walking the transparency list
+
 } VM_EXIT_TRANSPARENCY, *PVM_EXIT_TRANSPARENCY;
 
 /**
@@ -0,0 +1,77 @@
+/**
+ * @file TransparencyCache.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Per-core cache of the transparency decisions
+ * @details The decisions of whether the processes are on the transparency
+ * list or not are kept in a direct-mapped table indexed by the guest cr3
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+/**
+ * @brief Find the cached decision of a process
+ * @details The process id avoids using a decision of a terminated process
+ * that its cr3 is reused and the version of the list avoids using the
+ * decisions that are made before the list is changed
+ *
+ * @param Cache The cache of the current core
+ * @param GuestCr3 Guest cr3 of the process
+ * @param ProcessId Process id of the process
+ * @param ProcessListVersion Current version of the transparency list
+ * @param IsProcessOnTransparencyList The cached decision (if it's found)
+ *
+ * @return BOOLEAN Returns true if the decision is found
+ */
+BOOLEAN
+TransparentProcessCacheLookup(PTRANSPARENCY_PROCESS_CACHE_ENTRY Cache,
+                              UINT64                            GuestCr3,
+                              HANDLE                            ProcessId,
+                              LONG                              ProcessListVersion,
+                              BOOLEAN *                         IsProcessOnTransparencyList)
+{
+    PTRANSPARENCY_PROCESS_CACHE_ENTRY CacheEntry = &Cache[(GuestCr3 >> PAGE_SHIFT) & (TRANSPARENCY_PROCESS_CACHE_ENTRIES - 1)];
+
+    if (CacheEntry->GuestCr3 != GuestCr3 ||
+        CacheEntry->ProcessId != ProcessId ||
+        CacheEntry->ProcessListVersion != ProcessListVersion)
+    {
+        return FALSE;
+    }
+
+    *IsProcessOnTransparencyList = CacheEntry->IsProcessOnTransparencyList;
+
+    return TRUE;
+}
+
+/**
+ * @brief Cache the decision of a process
+ * @details The previous process of the same entry is replaced
+ *
+ * @param Cache The cache of the current core
+ * @param GuestCr3 Guest cr3 of the process
+ * @param ProcessId Process id of the process
+ * @param ProcessListVersion Version of the transparency list that the
+ * decision is made based on it
+ * @param IsProcessOnTransparencyList The decision
+ *
+ * @return VOID
+ */
+VOID
+TransparentProcessCacheInsert(PTRANSPARENCY_PROCESS_CACHE_ENTRY Cache,
+                              UINT64                            GuestCr3,
+                              HANDLE                            ProcessId,
+                              LONG                              ProcessListVersion,
+                              BOOLEAN                           IsProcessOnTransparencyList)
+{
+    PTRANSPARENCY_PROCESS_CACHE_ENTRY CacheEntry = &Cache[(GuestCr3 >> PAGE_SHIFT) & (TRANSPARENCY_PROCESS_CACHE_ENTRIES - 1)];
+
+    CacheEntry->GuestCr3                    = GuestCr3;
+    CacheEntry->ProcessId                   = ProcessId;
+    CacheEntry->ProcessListVersion          = ProcessListVersion;
+    CacheEntry->IsProcessOnTransparencyList = IsProcessOnTransparencyList;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file TransparencyCache.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the per-core cache of the transparency decisions
+ * @details The cache doesn't depend on any kernel routine, it's a part of
+ * the state of each core and used in vmx-root
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//				    Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the entries of the per-core cache of the processes
+ * that are (or are not) on the transparency list
+ * @details Should be a power of two
+ *
+ */
+#define TRANSPARENCY_PROCESS_CACHE_ENTRIES 16
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The cached decision of whether a process is on the transparency
+ * list or not
+ * @details The entry is valid as long as the guest cr3 and the process id
+ * are the same and the transparency list is not changed
+ *
+ */
+typedef struct _TRANSPARENCY_PROCESS_CACHE_ENTRY
+{
+    UINT64  GuestCr3;                    // Guest cr3 of the process
+    HANDLE  ProcessId;                   // Process id of the process
+    LONG    ProcessListVersion;          // Version of the transparency list that the decision is made based on it
+    BOOLEAN IsProcessOnTransparencyList; // The cached decision
+
+} TRANSPARENCY_PROCESS_CACHE_ENTRY, *PTRANSPARENCY_PROCESS_CACHE_ENTRY;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+TransparentProcessCacheLookup(PTRANSPARENCY_PROCESS_CACHE_ENTRY Cache,
+                              UINT64                            GuestCr3,
+                              HANDLE                            ProcessId,
+                              LONG                              ProcessListVersion,
+                              BOOLEAN *                         IsProcessOnTransparencyList);
+
+VOID
+TransparentProcessCacheInsert(PTRANSPARENCY_PROCESS_CACHE_ENTRY Cache,
+                              UINT64                            GuestCr3,
+                              HANDLE                            ProcessId,
+                              LONG                              ProcessListVersion,
+                              BOOLEAN                           IsProcessOnTransparencyList);
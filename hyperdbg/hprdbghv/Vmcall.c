@@ -167,6 +167,12 @@ VmxVmcallHandler(UINT64      VmcallNumber,
         }
         break;
     }
+    case VMCALL_UNHOOK_REMOVED_PAGES:
+    {
+        EptHookRestoreRemovedHooksToOrginalEntry((PEPT_TRANSACTION)OptionalParam1);
+        VmcallStatus = STATUS_SUCCESS;
+        break;
+    }
     case VMCALL_ENABLE_SYSCALL_HOOK_EFER:
     {
         SyscallHookConfigureEFER(TRUE);
@@ -433,6 +439,24 @@ VmxVmcallHandler(UINT64      VmcallNumber,
         VmcallStatus = STATUS_SUCCESS;
         break;
     }
+    case VMCALL_APPLY_PENDING_CONTROLS:
+    {
+        PendingControlsApply(CurrentCoreIndex, GuestRegs, TRUE);
+        VmcallStatus = STATUS_SUCCESS;
+        break;
+    }
+    case VMCALL_USE_PRIVATE_MSR_BITMAP:
+    {
+        SharedBitmapsUsePrivateMsrBitmap(CurrentCoreIndex);
+        VmcallStatus = STATUS_SUCCESS;
+        break;
+    }
+    case VMCALL_USE_PRIVATE_IO_BITMAPS:
+    {
+        SharedBitmapsUsePrivateIoBitmaps(CurrentCoreIndex);
+        VmcallStatus = STATUS_SUCCESS;
+        break;
+    }
     default:
     {
         LogError("Unsupported VMCALL");
@@ -277,6 +277,32 @@
  */
 #define VMCALL_SEND_GENERAL_BUFFER_TO_DEBUGGER 0x2a
 
+/**
+ * @brief VMCALL to apply the pending updates of the controls
+ * of the current core
+ * 
+ */
+#define VMCALL_APPLY_PENDING_CONTROLS 0x2b
+
+/**
+ * @brief VMCALL to switch the current core to its private MSR bitmap
+ * 
+ */
+#define VMCALL_USE_PRIVATE_MSR_BITMAP 0x2c
+
+/**
+ * @brief VMCALL to switch the current core to its private I/O bitmaps
+ * 
+ */
+#define VMCALL_USE_PRIVATE_IO_BITMAPS 0x2d
+
+/**
+ * @brief VMCALL to restore the hooked pages that are removed in
+ * a transaction and invalidate EPT
+ * 
+ */
+#define VMCALL_UNHOOK_REMOVED_PAGES 0x2e
+
 //////////////////////////////////////////////////
 //				    Functions					//
 //////////////////////////////////////////////////
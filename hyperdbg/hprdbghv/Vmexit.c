@@ -429,6 +429,14 @@ VmxVmexitHandler(PGUEST_REGS GuestRegs)
     }
     }
 
+    //
+    // Apply the pending updates of the controls of this core
+    //
+    if (!g_GuestState[CurrentProcessorIndex].VmxoffState.IsVmxoffExecuted)
+    {
+        PendingControlsApply(CurrentProcessorIndex, GuestRegs, FALSE);
+    }
+
     //
     // Check whether we need to increment the guest's ip or not
     // Also, we should not increment rip if a vmxoff executed
@@ -50,6 +50,11 @@ VmxInitializer()
     //
     InitializeListHead(&g_EptState->HookedPagesList);
 
+    for (UINT32 i = 0; i < EPT_HOOKED_PAGES_BUCKETS; i++)
+    {
+        InitializeListHead(&g_EptState->HookedPagesBuckets[i]);
+    }
+
     //
     // Check whether EPT is supported or not
     //
@@ -94,6 +99,17 @@ VmxInitializer()
         return FALSE;
     }
 
+    //
+    // Initialize the pool of tables for splitting 2MB pages, it's initialized
+    // after the EPT tables so the pool (and the worker thread of it) is not
+    // left behind if the EPT tables can't be built
+    //
+    if (!EptSplitPoolInitialize())
+    {
+        LogError("Could not initialize the pool of split tables");
+        return FALSE;
+    }
+
     //
     // Allocate and run Vmxon and Vmptrld on all logical cores
     //
@@ -204,6 +220,12 @@ VmxVirtualizeCurrentSystem(PVOID GuestStack)
         return FALSE;
     }
 
+    //
+    // Fill the CPUID cache of this core, it's executed before the
+    // virtualization, so the results are the processor's values
+    //
+    CpuidCacheInitialize(&g_GuestState[ProcessorID].CpuidCache);
+
     LogDebugInfo("Setting up VMCS for current logical core");
 
     VmxSetupVmcs(&g_GuestState[ProcessorID], GuestStack);
@@ -271,9 +293,17 @@ VmxTerminate()
         MmFreeContiguousMemory(g_GuestState[CurrentCoreIndex].VmxonRegionVirtualAddress);
         MmFreeContiguousMemory(g_GuestState[CurrentCoreIndex].VmcsRegionVirtualAddress);
         ExFreePoolWithTag(g_GuestState[CurrentCoreIndex].VmmStack, POOLTAG);
+
+#if ShareMsrAndIoBitmaps
+        //
+        // The shared bitmaps are freed after all of the cores are terminated
+        //
+        SharedBitmapsFreePrivateBitmaps(CurrentCoreIndex);
+#else
         ExFreePoolWithTag(g_GuestState[CurrentCoreIndex].MsrBitmapVirtualAddress, POOLTAG);
         ExFreePoolWithTag(g_GuestState[CurrentCoreIndex].IoBitmapVirtualAddressA, POOLTAG);
         ExFreePoolWithTag(g_GuestState[CurrentCoreIndex].IoBitmapVirtualAddressB, POOLTAG);
+#endif
 
         return TRUE;
     }
@@ -569,6 +569,11 @@ typedef struct _VIRTUAL_MACHINE_STATE
     UINT64  IoBitmapPhysicalAddressA;                                      // I/O Bitmap Physical Address (A)
     UINT64  IoBitmapVirtualAddressB;                                       // I/O Bitmap Virtual Address (B)
     UINT64  IoBitmapPhysicalAddressB;                                      // I/O Bitmap Physical Address (B)
+    PVOID   PrivateMsrBitmapVirtualAddress;                                // Private copy of the Msr Bitmap (if the core has core-specific Msr events)
+    PVOID   PrivateIoBitmapsVirtualAddress;                                // Private copy of the I/O Bitmaps A and B (if the core has core-specific I/O events)
+    UINT64  PrivateMsrBitmapPhysicalAddress;                               // Physical address of the private copy of the Msr Bitmap
+    UINT64  PrivateIoBitmapsPhysicalAddressA;                              // Physical address of the private copy of the I/O Bitmap (A)
+    UINT64  PrivateIoBitmapsPhysicalAddressB;                              // Physical address of the private copy of the I/O Bitmap (B)
     UINT32  PendingExternalInterrupts[PENDING_INTERRUPTS_BUFFER_CAPACITY]; // This list holds a buffer for external-interrupts that are in pending state due to the external-interrupt
                                                                            // blocking and waits for interrupt-window exiting
                                                                            // From hvpp :
@@ -583,6 +588,8 @@ typedef struct _VIRTUAL_MACHINE_STATE
     BOOLEAN                                 MtfTest;                         // It shows the detail of the hooked paged that should be restore in MTF vm-exit
     DEBUGGER_STEPPING_CORE_SPECIFIC_DETAILS DebuggerUserModeSteppingDetails; // It shows the detail of stepping for debugger in user-mode
     MEMORY_MAPPER_ADDRESSES                 MemoryMapper;                    // Memory mapper details for each core, contains PTE Virtual Address, Actual Kernel Virtual Address
+    CPUID_CACHE                             CpuidCache;                      // Results of CPUID instructions of each core, used in CPUID vm-exits
+    PENDING_CONTROLS                        PendingControls;                 // Updates of the controls that should be applied in the next vm-exit of the core
 } VIRTUAL_MACHINE_STATE, *PVIRTUAL_MACHINE_STATE;
 
 /**
@@ -253,6 +253,23 @@ VmxAllocateVmmStack(INT ProcessorID)
 BOOLEAN
 VmxAllocateMsrBitmap(INT ProcessorID)
 {
+#if ShareMsrAndIoBitmaps
+
+    //
+    // All of the cores use the shared bitmap until they need a private copy
+    //
+    if (!SharedBitmapsAllocateMsrBitmap())
+    {
+        return FALSE;
+    }
+
+    g_GuestState[ProcessorID].MsrBitmapVirtualAddress  = g_SharedBitmaps.MsrBitmapVirtualAddress;
+    g_GuestState[ProcessorID].MsrBitmapPhysicalAddress = g_SharedBitmaps.MsrBitmapPhysicalAddress;
+
+    return TRUE;
+
+#else
+
     //
     // Allocate memory for MSR Bitmap
     //
@@ -271,6 +288,8 @@ VmxAllocateMsrBitmap(INT ProcessorID)
     LogDebugInfo("Msr Bitmap Physical Address : 0x%llx", g_GuestState[ProcessorID].MsrBitmapPhysicalAddress);
 
     return TRUE;
+
+#endif
 }
 
 /**
@@ -282,6 +301,25 @@ VmxAllocateMsrBitmap(INT ProcessorID)
 BOOLEAN
 VmxAllocateIoBitmaps(INT ProcessorID)
 {
+#if ShareMsrAndIoBitmaps
+
+    //
+    // All of the cores use the shared bitmaps until they need a private copy
+    //
+    if (!SharedBitmapsAllocateIoBitmaps())
+    {
+        return FALSE;
+    }
+
+    g_GuestState[ProcessorID].IoBitmapVirtualAddressA  = g_SharedBitmaps.IoBitmapVirtualAddressA;
+    g_GuestState[ProcessorID].IoBitmapPhysicalAddressA = g_SharedBitmaps.IoBitmapPhysicalAddressA;
+    g_GuestState[ProcessorID].IoBitmapVirtualAddressB  = g_SharedBitmaps.IoBitmapVirtualAddressB;
+    g_GuestState[ProcessorID].IoBitmapPhysicalAddressB = g_SharedBitmaps.IoBitmapPhysicalAddressB;
+
+    return TRUE;
+
+#else
+
     //
     // Allocate memory for I/O Bitmap (A)
     //
@@ -317,4 +355,6 @@ VmxAllocateIoBitmaps(INT ProcessorID)
     LogDebugInfo("I/O Bitmap B Physical Address : 0x%llx", g_GuestState[ProcessorID].IoBitmapPhysicalAddressB);
 
     return TRUE;
+
+#endif
 }
@@ -12,6 +12,17 @@
  * 
  */
 #pragma once
+
+#ifdef HYPERDBG_UNIT_TESTS
+
+//
+// The unit tests build the portable modules on other platforms, so the
+// definitions of the kernel are provided by the tests
+//
+#    include "hprdbghv-unit-tests.h"
+
+#else
+
 #define _NO_CRT_STDIO_INLINE
 //
 // Windows defined functions
@@ -31,21 +42,36 @@
 #include "Dpc.h"
 #include "LengthDisassemblerEngine.h"
 #include "Logging.h"
+#include "LoggingRecords.h"
 #include "MemoryMapper.h"
+#include "SearchEngine.h"
+#include "AhoCorasick.h"
+#include "BreakpointIndex.h"
+#include "TransparencyCache.h"
+#include "CpuidCache.h"
+#include "PendingControls.h"
+#include "SharedBitmaps.h"
 #include "Msr.h"
 #include "KernelTests.h"
+#include "SlabAllocator.h"
 #include "PoolManager.h"
 #include "Trace.h"
 #include "DpcRoutines.h"
 #include "InlineAsm.h"
 #include "Vpid.h"
 #include "Ept.h"
+#include "EptBuilder.h"
+#include "EptSplitPool.h"
+#include "EptTransaction.h"
+#include "EmulatorDecoder.h"
+#include "Emulator.h"
 #include "Events.h"
 #include "Common.h"
 #include "Debugger.h"
 #include "Apic.h"
 #include "Kd.h"
 #include "Mtf.h"
+#include "InstrumentTrace.h"
 #include "GdbStub.h"
 #include "DebuggerEvents.h"
 #include "Hooks.h"
@@ -71,3 +97,5 @@
 // Global Variables should be the last header to include
 //
 #include "GlobalVariables.h"
+
+#endif // HYPERDBG_UNIT_TESTS
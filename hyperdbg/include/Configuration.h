@@ -62,3 +62,17 @@
  * case of errors
  */
 #define DebugMode FALSE
+
+/**
+ * @brief Emulate the simple memory accesses (mov) to the monitored pages
+ * (!monitor) in vmx-root instead of single-stepping them with MTF, other
+ * instructions are still executed with MTF
+ */
+#define EmulateMonitorMemoryAccesses TRUE
+
+/**
+ * @brief All of the cores share one set of MSR and I/O bitmaps, only the
+ * cores that have core-specific events (!msrread, !msrwrite, !ioin and
+ * !ioout on one core) use a private copy of the bitmaps
+ */
+#define ShareMsrAndIoBitmaps TRUE
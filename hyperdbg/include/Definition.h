@@ -135,6 +135,85 @@
  */
 #define MaximumSearchResults 0x1000
 
+/**
+ * @brief maximum length of the pattern (in bytes) that can be
+ * searched by !s* s* command
+ *
+ */
+#define MaximumSearchPatternLength 0x100
+
+/**
+ * @brief maximum number of patterns that can be searched
+ * by !sm sm command at once
+ *
+ */
+#define MaximumMultiPatternSearchPatternsCount 0x40
+
+/**
+ * @brief maximum length of all patterns (in bytes) that can
+ * be searched by !sm sm command at once
+ *
+ */
+#define MaximumMultiPatternSearchPatternsTotalLength 0x400
+
+/**
+ * @brief maximum results that will be returned by each request
+ * of !sm sm command (should fit in a serial packet)
+ *
+ */
+#define MaximumMultiPatternSearchResults 0x80
+
+/**
+ * @brief maximum number of descriptors (or nodes) that can be
+ * read by each scatter-gather read request
+ *
+ */
+#define MaximumScatterGatherReadDescriptors 0x20
+
+/**
+ * @brief maximum size of all of the bytes that can be read by
+ * each scatter-gather read request (should fit in a serial packet)
+ *
+ */
+#define MaximumScatterGatherReadTotalSize 0x800
+
+/**
+ * @brief maximum size of each batch of events and their actions
+ * that is registered at once
+ *
+ */
+#define MaximumEventsBatchSize 0x10000
+
+/**
+ * @brief maximum size of each batch of events and their actions
+ * that is registered at once in the debugger-mode (should fit in
+ * a serial packet)
+ *
+ */
+#define MaximumEventsBatchSizeOverSerial 0xa00
+
+/**
+ * @brief size of the buffer that keeps the records of the instrumentation
+ * trace on the debuggee, the records are sent to the debugger whenever the
+ * buffer is full and at the end of the trace
+ *
+ */
+#define DebuggeeTraceBufferSize 0x40000
+
+/**
+ * @brief maximum size of the trace records that are sent in each
+ * packet (should fit in a serial packet)
+ *
+ */
+#define DebuggeeTraceRecordsChunkSize 0xb00
+
+/**
+ * @brief maximum count of the traced instructions if the trace
+ * is stopped by an address or a return instruction
+ *
+ */
+#define DebuggeeTraceDefaultMaximumSteps 0x10000
+
 /**
  * @brief name of HyperDbg driver
  *
@@ -184,6 +263,9 @@
     0xB | OPERATION_MANDATORY_DEBUGGEE_BIT
 #define OPERATION_HYPERVISOR_DRIVER_END_OF_IRPS \
     0xC | OPERATION_MANDATORY_DEBUGGEE_BIT
+#define OPERATION_DEBUGGEE_REGISTER_EVENTS_BATCH \
+    0xD | OPERATION_MANDATORY_DEBUGGEE_BIT
+#define OPERATION_LOG_NON_IMMEDIATE_EVENT_RECORDS 0xE
 
 //////////////////////////////////////////////////
 //				   Test Cases                   //
@@ -240,6 +322,9 @@
 #define DEBUGGER_SYNCRONIZATION_OBJECT_LIST_OR_MODIFY_BREAKPOINTS          0xe
 #define DEBUGGER_SYNCRONIZATION_OBJECT_READ_MEMORY                         0xf
 #define DEBUGGER_SYNCRONIZATION_OBJECT_EDIT_MEMORY                         0x10
+#define DEBUGGER_SYNCRONIZATION_OBJECT_MULTI_PATTERN_SEARCH_MEMORY         0x11
+#define DEBUGGER_SYNCRONIZATION_OBJECT_SCATTER_GATHER_READ_MEMORY          0x12
+#define DEBUGGER_SYNCRONIZATION_OBJECT_REGISTER_EVENTS_BATCH               0x13
 
 //////////////////////////////////////////////////
 //            End of Buffer Detection           //
@@ -273,6 +358,21 @@
 #define TCP_END_OF_BUFFER_CHAR_3 0x33
 #define TCP_END_OF_BUFFER_CHAR_4 0x44
 
+//////////////////////////////////////////////////
+//             Symbolized Addresses             //
+//////////////////////////////////////////////////
+
+/**
+ * @brief The character that marks an address in the messages of the
+ * kernel to be converted to its symbol (module!name+offset) by the
+ * debugger
+ * @details the marker is followed by 16 hex digits of the address, it's
+ * used for the '%y' format specifier of the script engine's printf
+ *
+ */
+#define SYMBOLIZED_ADDRESS_MARKER        '\x1e'
+#define SYMBOLIZED_ADDRESS_MARKER_LENGTH (1 + 16)
+
 //////////////////////////////////////////////////
 //              Processor Details               //
 //////////////////////////////////////////////////
@@ -500,6 +600,7 @@ typedef struct _DEBUGGER_GENERAL_ACTION
     UINT64                          EventTag;
     DEBUGGER_EVENT_ACTION_TYPE_ENUM ActionType;
     BOOLEAN                         ImmediateMessagePassing;
+    BOOLEAN                         SendEventRecords; // Send the results of the script as event records
     UINT32                          PreAllocatedBuffer;
 
     UINT32 CustomCodeBufferSize;
@@ -519,6 +620,130 @@ typedef struct _DEBUGGER_EVENT_AND_ACTION_REG_BUFFER
 
 } DEBUGGER_EVENT_AND_ACTION_REG_BUFFER, *PDEBUGGER_EVENT_AND_ACTION_REG_BUFFER;
 
+/**
+ * @brief Maximum count of the actions of each event in a batch
+ * (break to debugger, custom code and script)
+ *
+ */
+#define DEBUGGER_EVENTS_BATCH_MAXIMUM_ACTIONS 3
+
+/**
+ * @brief Alignment of the events and the actions in a batch
+ *
+ */
+#define DEBUGGER_EVENTS_BATCH_ALIGN(Size) (((Size) + 7) & ~7)
+
+/**
+ * @brief request for registering multiple events and their actions
+ * at once
+ * @details the entries (DEBUGGER_EVENTS_BATCH_ENTRY) come after this
+ * structure, the same buffer is returned with the result of each entry
+ *
+ */
+typedef struct _DEBUGGER_EVENTS_BATCH
+{
+    UINT32 Size;                    // Size of the batch (this structure and all of the entries)
+    UINT32 CountOfEntries;          // Count of the entries
+    UINT32 CountOfRegisteredEvents; // Count of the registered events (result)
+    UINT32 KernelStatus;            // Result of validating the batch
+
+} DEBUGGER_EVENTS_BATCH, *PDEBUGGER_EVENTS_BATCH;
+
+/**
+ * @brief An event and its actions in a batch
+ * @details The event buffer comes after this structure and each of
+ * the action buffers comes after that, all of them are aligned by
+ * DEBUGGER_EVENTS_BATCH_ALIGN
+ *
+ */
+typedef struct _DEBUGGER_EVENTS_BATCH_ENTRY
+{
+    UINT32                               Size;                                                // Size of the entry (this structure, the event and the actions)
+    UINT32                               EventLength;                                         // Length of the event buffer
+    UINT32                               CountOfActions;                                      // Count of the actions
+    UINT32                               ActionLengths[DEBUGGER_EVENTS_BATCH_MAXIMUM_ACTIONS]; // Length of each of the action buffers
+    DEBUGGER_EVENT_AND_ACTION_REG_BUFFER EventResult;                                         // Result of registering the event
+    DEBUGGER_EVENT_AND_ACTION_REG_BUFFER ActionsResult;                                       // Result of adding the actions
+
+} DEBUGGER_EVENTS_BATCH_ENTRY, *PDEBUGGER_EVENTS_BATCH_ENTRY;
+
+#define SIZEOF_DEBUGGER_EVENTS_BATCH       sizeof(DEBUGGER_EVENTS_BATCH)
+#define SIZEOF_DEBUGGER_EVENTS_BATCH_ENTRY sizeof(DEBUGGER_EVENTS_BATCH_ENTRY)
+
+//////////////////////////////////////////////////
+//                 Event Records                //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Signature of the event records ('HER' followed by a
+ * zero byte so a text message can't be taken as a record)
+ *
+ */
+#define DEBUGGER_EVENT_RECORD_SIGNATURE 0x00524548
+
+/**
+ * @brief Version of the layout of the event records
+ *
+ */
+#define DEBUGGER_EVENT_RECORD_VERSION 1
+
+/**
+ * @brief Maximum count of the raw values of each event record
+ *
+ */
+#define DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES 16
+
+/**
+ * @brief The functions of the scripts that create event records
+ *
+ */
+typedef enum _DEBUGGER_EVENT_RECORD_KIND
+{
+    DEBUGGER_EVENT_RECORD_KIND_PRINT = 1,
+    DEBUGGER_EVENT_RECORD_KIND_PRINTF,
+    DEBUGGER_EVENT_RECORD_KIND_FORMATS,
+    DEBUGGER_EVENT_RECORD_KIND_TEXT // A text message of the event that is converted
+                                    // to a record in user-mode
+
+} DEBUGGER_EVENT_RECORD_KIND;
+
+/**
+ * @brief The structured record of the output of an event
+ * @details The raw values (UINT64) come after this structure and the
+ * text (not null-terminated) comes after the values, print and formats
+ * have no text and the text of printf is the formatted string
+ *
+ */
+typedef struct _DEBUGGER_EVENT_RECORD
+{
+    UINT32 Signature;     // DEBUGGER_EVENT_RECORD_SIGNATURE
+    UINT32 Length;        // Length of the record (this structure, the values and the text)
+    UINT16 Kind;          // DEBUGGER_EVENT_RECORD_KIND
+    UINT16 CountOfValues; // Count of the raw values
+    UINT32 TextLength;    // Length of the text
+    UINT64 Tag;           // Tag of the event
+    UINT64 Tsc;           // Time-stamp counter when the record is created
+    UINT32 CoreId;        // The core that runs the event
+    UINT32 ProcessId;     // The process that triggers the event
+    UINT32 ThreadId;      // The thread that triggers the event
+    UINT32 Reserved;
+
+} DEBUGGER_EVENT_RECORD, *PDEBUGGER_EVENT_RECORD;
+
+/**
+ * @brief The header of a stream of event records, it's written once
+ * at the start of each output source with the binary format
+ *
+ */
+typedef struct _DEBUGGER_EVENT_RECORD_STREAM_HEADER
+{
+    UINT32 Signature; // DEBUGGER_EVENT_RECORD_SIGNATURE
+    UINT32 Version;   // DEBUGGER_EVENT_RECORD_VERSION
+
+} DEBUGGER_EVENT_RECORD_STREAM_HEADER, *PDEBUGGER_EVENT_RECORD_STREAM_HEADER;
+
+#define SIZEOF_DEBUGGER_EVENT_RECORD sizeof(DEBUGGER_EVENT_RECORD)
+
 //////////////////////////////////////////////////
 //            Debuggee Communication            //
 //////////////////////////////////////////////////
@@ -602,6 +827,10 @@ typedef enum _DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION
     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_EDIT_MEMORY,
     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_BP,
     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_LIST_OR_MODIFY_BREAKPOINTS,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MULTI_PATTERN_SEARCH_MEMORY,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_SCATTER_GATHER_READ_MEMORY,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_MODE_TRACE,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_ON_VMX_ROOT_REGISTER_EVENTS_BATCH,
 
     //
     // Debuggee to debugger
@@ -623,6 +852,10 @@ typedef enum _DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION
     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_EDITING_MEMORY,
     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_BP,
     DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_LIST_OR_MODIFY_BREAKPOINTS,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_MULTI_PATTERN_SEARCH_MEMORY,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_SCATTER_GATHER_READ_MEMORY,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_TRACE_RECORDS,
+    DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION_DEBUGGEE_RESULT_OF_REGISTERING_EVENTS_BATCH,
 
 } DEBUGGER_REMOTE_PACKET_REQUESTED_ACTION;
 
@@ -791,6 +1024,72 @@ typedef struct _DEBUGGER_READ_MEMORY
 
 } DEBUGGER_READ_MEMORY, *PDEBUGGER_READ_MEMORY;
 
+/* ==============================================================================================
+ */
+
+#define SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY \
+    sizeof(DEBUGGER_SCATTER_GATHER_READ_MEMORY)
+
+/**
+ * @brief different modes of scatter-gather read
+ *
+ */
+typedef enum _DEBUGGER_SCATTER_GATHER_READ_MODE
+{
+    DEBUGGER_SCATTER_GATHER_READ_DESCRIPTORS,
+    DEBUGGER_SCATTER_GATHER_READ_FOLLOW_POINTER
+
+} DEBUGGER_SCATTER_GATHER_READ_MODE;
+
+/**
+ * @brief request for reading multiple ranges of memory at once
+ * @details the structure is followed by CountOfDescriptors
+ * DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR and then the bytes that are
+ * read (in the order of the descriptors)
+ *
+ * in the follow pointer mode, the descriptors are filled by the kernel,
+ * FollowPointerSize bytes are read from FollowPointerAddress, then the
+ * pointer at FollowPointerOffset of the read bytes is the address of the
+ * next node, it continues until CountOfDescriptors nodes are read or the
+ * pointer is null or points to the first node again
+ *
+ */
+typedef struct _DEBUGGER_SCATTER_GATHER_READ_MEMORY
+{
+    UINT32                            ProcessId;              // specifies the process id
+    DEBUGGER_READ_MEMORY_TYPE         MemoryType;             // Type of memory
+    DEBUGGER_SCATTER_GATHER_READ_MODE Mode;                   // Descriptors or follow pointer
+    UINT32                            CountOfDescriptors;     // Count of descriptors (maximum nodes)
+    UINT64                            FollowPointerAddress;   // Address of the first node
+    UINT32                            FollowPointerSize;      // Size of each node
+    UINT32                            FollowPointerOffset;    // Offset of the next pointer in each node
+    UINT32                            CountOfReadDescriptors; // Count of read descriptors (results)
+    UINT32                            TotalSize;              // Size of the read bytes (results)
+    UINT32                            KernelStatus;           // Kernel put the status in this field
+
+} DEBUGGER_SCATTER_GATHER_READ_MEMORY, *PDEBUGGER_SCATTER_GATHER_READ_MEMORY;
+
+/**
+ * @brief a range of memory in the scatter-gather read request
+ *
+ */
+typedef struct _DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR
+{
+    UINT64 Address;      // Address of the range
+    UINT32 Size;         // Size of the range
+    UINT32 KernelStatus; // Status of reading this range (results)
+
+} DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR, *PDEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR;
+
+/**
+ * @brief size of the buffer of scatter-gather read (request and results)
+ *
+ */
+#define DEBUGGER_SCATTER_GATHER_READ_MEMORY_BUFFER_SIZE                                        \
+    (SIZEOF_DEBUGGER_SCATTER_GATHER_READ_MEMORY +                                              \
+     (MaximumScatterGatherReadDescriptors * sizeof(DEBUGGER_SCATTER_GATHER_READ_DESCRIPTOR)) + \
+     MaximumScatterGatherReadTotalSize)
+
 /* ==============================================================================================
  */
 
@@ -1040,6 +1339,13 @@ typedef enum _DEBUGGER_SEARCH_MEMORY_BYTE_SIZE
 
 /**
  * @brief request for searching memory
+ * @details the structure is followed by CountOf64Chunks values (UINT64) and
+ * then CountOf64Chunks masks (UINT64), each byte of the mask is 0xff if the
+ * corresponding byte should be compared and 0x00 if it's a wildcard
+ *
+ * the results are returned in the same structure followed by
+ * CountOfResults addresses (UINT64), if IsSearchFinished is FALSE then the
+ * search should be continued from NextAddressToSearch
  *
  */
 typedef struct _DEBUGGER_SEARCH_MEMORY
@@ -1051,9 +1357,72 @@ typedef struct _DEBUGGER_SEARCH_MEMORY
     DEBUGGER_SEARCH_MEMORY_BYTE_SIZE ByteSize;   // Modification size
     UINT32                           CountOf64Chunks;
     UINT32                           FinalStructureSize;
+    UINT64                           NextAddressToSearch; // Address to continue the search (results)
+    UINT32                           CountOfResults;      // Count of found addresses (results)
+    BOOLEAN                          IsSearchFinished;    // Whether the whole range is searched (results)
+    UINT32                           KernelStatus;        // Kernel put the status in this field
 
 } DEBUGGER_SEARCH_MEMORY, *PDEBUGGER_SEARCH_MEMORY;
 
+/**
+ * @brief size of the output buffer of searching memory
+ *
+ */
+#define DEBUGGER_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE \
+    (SIZEOF_DEBUGGER_SEARCH_MEMORY + (MaximumSearchResults * sizeof(UINT64)))
+
+/* ==============================================================================================
+ */
+
+#define SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY \
+    sizeof(DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY)
+
+/**
+ * @brief request for searching multiple patterns in memory
+ * @details the structure is followed by CountOfPatterns lengths (UINT32)
+ * and then the bytes of all patterns (one after another)
+ *
+ * the results are returned in the same structure followed by
+ * CountOfResults DEBUGGER_MULTI_PATTERN_SEARCH_RESULT, if IsSearchFinished
+ * is FALSE then the search should be continued from NextAddressToSearch
+ * and ResumeState
+ *
+ */
+typedef struct _DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY
+{
+    UINT64                      Address;             // Target adddress to start searching
+    UINT64                      Length;              // Length of bytes to search
+    UINT32                      ProcessId;           // specifies the process id
+    DEBUGGER_SEARCH_MEMORY_TYPE MemoryType;          // Type of memory
+    UINT32                      CountOfPatterns;     // Count of patterns
+    UINT32                      PatternsTotalLength; // Length of all patterns
+    UINT32                      ResumeState;         // State of the matcher to continue the search
+    UINT64                      NextAddressToSearch; // Address to continue the search (results)
+    UINT32                      CountOfResults;      // Count of found patterns (results)
+    BOOLEAN                     IsSearchFinished;    // Whether the whole range is searched (results)
+    UINT32                      KernelStatus;        // Kernel put the status in this field
+
+} DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY, *PDEBUGGER_MULTI_PATTERN_SEARCH_MEMORY;
+
+/**
+ * @brief result of searching multiple patterns in memory
+ *
+ */
+typedef struct _DEBUGGER_MULTI_PATTERN_SEARCH_RESULT
+{
+    UINT64 Address;   // Address of the first byte of the match
+    UINT32 PatternId; // Index of the pattern
+
+} DEBUGGER_MULTI_PATTERN_SEARCH_RESULT, *PDEBUGGER_MULTI_PATTERN_SEARCH_RESULT;
+
+/**
+ * @brief size of the output buffer of searching multiple patterns
+ *
+ */
+#define DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY_OUTPUT_BUFFER_SIZE \
+    (SIZEOF_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY +              \
+     (MaximumMultiPatternSearchResults * sizeof(DEBUGGER_MULTI_PATTERN_SEARCH_RESULT)))
+
 /* ==============================================================================================
  */
 
@@ -1196,10 +1565,11 @@ typedef struct _DEBUGGER_ATTACH_DETACH_USER_MODE_PROCESS
  */
 typedef struct _DEBUGGER_EVENT_ACTION_RUN_SCRIPT_CONFIGURATION
 {
-    UINT64 ScriptBuffer;
-    UINT32 ScriptLength;
-    UINT32 ScriptPointer;
-    UINT32 OptionalRequestedBufferSize;
+    UINT64  ScriptBuffer;
+    UINT32  ScriptLength;
+    UINT32  ScriptPointer;
+    UINT32  OptionalRequestedBufferSize;
+    BOOLEAN SendEventRecords; // Send the results of print functions as event records
 
 } DEBUGGER_EVENT_ACTION_RUN_SCRIPT_CONFIGURATION,
     *PDEBUGGER_EVENT_ACTION_RUN_SCRIPT_CONFIGURATION;
@@ -1403,6 +1773,92 @@ typedef struct _DEBUGGEE_STEP_PACKET
 
 } DEBUGGEE_STEP_PACKET, *PDEBUGGEE_STEP_PACKET;
 
+/**
+ * @brief The ways of stepping the instructions of the trace
+ *
+ */
+typedef enum _DEBUGGEE_TRACE_STEP_TYPE
+{
+    DEBUGGEE_TRACE_STEP_TYPE_INSTRUMENT = 0, // Step every instruction by MTF, other cores are halted ('i')
+    DEBUGGEE_TRACE_STEP_TYPE_STEP_IN,        // Step by the trap flag, other cores continue ('t')
+    DEBUGGEE_TRACE_STEP_TYPE_STEP_OVER,      // Step by the trap flag and step over the calls ('p')
+
+} DEBUGGEE_TRACE_STEP_TYPE;
+
+/**
+ * @brief The structure of instrumentation trace packet in HyperDbg
+ * @details The debuggee steps the instructions and stops when one of the
+ * conditions is met
+ *
+ */
+typedef struct _DEBUGGEE_TRACE_PACKET
+{
+    DEBUGGEE_TRACE_STEP_TYPE StepType;        // The way of stepping the instructions
+    UINT32                   CountOfSteps;    // Maximum count of the traced instructions
+    UINT64                   StopAddress;     // Stop before executing this address (null means no address)
+    BOOLEAN                  StopOnReturn;    // Stop after executing a return instruction
+    BOOLEAN                  RecordRegisters; // Record the registers that are changed by each instruction
+
+} DEBUGGEE_TRACE_PACKET, *PDEBUGGEE_TRACE_PACKET;
+
+/**
+ * @brief The reasons of stopping the instrumentation trace
+ *
+ */
+typedef enum _DEBUGGEE_TRACE_STOP_REASON
+{
+    DEBUGGEE_TRACE_STOP_REASON_NOT_STOPPED = 0,
+    DEBUGGEE_TRACE_STOP_REASON_COUNT_REACHED,
+    DEBUGGEE_TRACE_STOP_REASON_ADDRESS_REACHED,
+    DEBUGGEE_TRACE_STOP_REASON_RETURN_EXECUTED,
+    DEBUGGEE_TRACE_STOP_REASON_DEBUGGEE_HALTED,
+
+} DEBUGGEE_TRACE_STOP_REASON;
+
+/**
+ * @brief The record is executed in 32-bit mode
+ *
+ */
+#define DEBUGGEE_TRACE_RECORD_FLAG_32_BIT 0x1
+
+/**
+ * @brief Count of the registers that are traced, the general purpose
+ * registers (in the order of GUEST_REGS) and then the rflags
+ *
+ */
+#define DEBUGGEE_TRACE_COUNT_OF_REGISTERS 17
+
+/**
+ * @brief The record of each traced instruction
+ * @details The record is followed by InstructionLength bytes of the
+ * instruction and then the new value (UINT64) of each of the registers
+ * that their bit is set in ChangedRegisters
+ *
+ */
+typedef struct _DEBUGGEE_TRACE_RECORD
+{
+    UINT64 Rip;               // Address of the instruction
+    UINT32 ChangedRegisters;  // The registers that are changed by the instruction
+    BYTE   InstructionLength; // Length of the instruction
+    BYTE   Flags;             // DEBUGGEE_TRACE_RECORD_FLAG_*
+
+} DEBUGGEE_TRACE_RECORD, *PDEBUGGEE_TRACE_RECORD;
+
+/**
+ * @brief The structure of the packet of trace records in HyperDbg
+ * @details The structure is followed by Size bytes of records
+ *
+ */
+typedef struct _DEBUGGEE_TRACE_RECORDS_PACKET
+{
+    UINT32                     CountOfRecords; // Count of the records in this packet
+    UINT32                     Size;           // Size of the records in this packet
+    BOOLEAN                    IsFinished;     // Shows whether it's the last packet of the trace
+    DEBUGGEE_TRACE_STOP_REASON StopReason;     // The reason of stopping the trace (last packet)
+    UINT64                     CountOfSteps;   // Count of the traced instructions (last packet)
+
+} DEBUGGEE_TRACE_RECORDS_PACKET, *PDEBUGGEE_TRACE_RECORDS_PACKET;
+
 /**
  * @brief The structure of .formats result packet in HyperDbg
  *
@@ -1457,6 +1913,7 @@ typedef struct _DEBUGGEE_BP_DESCRIPTOR
     BOOLEAN    Enabled;
     UINT64     Address;
     UINT64     PhysAddress;
+    UINT64     Cr3; // The cr3 of the process that the breakpoint is set on
     UINT32     Pid;
     UINT32     Tid;
     UINT32     Core;
@@ -1780,6 +2237,55 @@ typedef struct _DEBUGGEE_EVENT_AND_ACTION_HEADER_FOR_REMOTE_PACKET
  */
 #define DEBUGEER_ERROR_INVALID_PROCESS_ID 0xc000001e
 
+/**
+ * @brief error, the search pattern is invalid
+ *
+ */
+#define DEBUGGER_ERROR_SEARCH_MEMORY_INVALID_PATTERN 0xc000001f
+
+/**
+ * @brief error, unable to allocate the search buffers
+ *
+ */
+#define DEBUGGER_ERROR_SEARCH_MEMORY_INSUFFICIENT_RESOURCES 0xc0000020
+
+/**
+ * @brief error, the patterns of multi-pattern search are invalid
+ *
+ */
+#define DEBUGGER_ERROR_MULTI_PATTERN_SEARCH_INVALID_PATTERNS 0xc0000021
+
+/**
+ * @brief error, maximum number of breakpoints is reached
+ *
+ */
+#define DEBUGGER_ERROR_MAXIMUM_NUMBER_OF_BREAKPOINTS_REACHED 0xc0000022
+
+/**
+ * @brief error, the descriptors of scatter-gather read are invalid
+ *
+ */
+#define DEBUGGER_ERROR_SCATTER_GATHER_READ_INVALID_DESCRIPTORS 0xc0000023
+
+/**
+ * @brief error, the layout of the batch of events is invalid
+ *
+ */
+#define DEBUGGER_ERROR_EVENTS_BATCH_INVALID_LAYOUT 0xc0000024
+
+/**
+ * @brief error, the change of the controls or the bitmaps of the core
+ * for the event is not queued
+ *
+ */
+#define DEBUGGER_ERROR_UNABLE_TO_APPLY_EVENT 0xc0000025
+
+/**
+ * @brief error, the action is not added to the event
+ *
+ */
+#define DEBUGGER_ERROR_UNABLE_TO_ADD_ACTION_TO_EVENT 0xc0000026
+
 //
 // WHEN YOU ADD ANYTHING TO THIS LIST OF ERRORS, THEN
 // MAKE SURE TO ADD AN ERROR MESSAGE TO ShowErrorMessage(UINT32 Error)
@@ -1958,3 +2464,27 @@ typedef struct _DEBUGGEE_EVENT_AND_ACTION_HEADER_FOR_REMOTE_PACKET
  */
 #define IOCTL_PERFROM_KERNEL_SIDE_TESTS \
     CTL_CODE(FILE_DEVICE_UNKNOWN, 0x817, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+/**
+ * @brief ioctl, request to search multiple patterns in virtual and
+ * physical memory
+ *
+ */
+#define IOCTL_DEBUGGER_MULTI_PATTERN_SEARCH_MEMORY \
+    CTL_CODE(FILE_DEVICE_UNKNOWN, 0x818, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+/**
+ * @brief ioctl, request to read multiple ranges of virtual and
+ * physical memory at once
+ *
+ */
+#define IOCTL_DEBUGGER_SCATTER_GATHER_READ_MEMORY \
+    CTL_CODE(FILE_DEVICE_UNKNOWN, 0x819, METHOD_BUFFERED, FILE_ANY_ACCESS)
+
+/**
+ * @brief ioctl, request to register multiple events and their
+ * actions at once
+ *
+ */
+#define IOCTL_DEBUGGER_REGISTER_EVENTS_BATCH \
+    CTL_CODE(FILE_DEVICE_UNKNOWN, 0x81a, METHOD_BUFFERED, FILE_ANY_ACCESS)
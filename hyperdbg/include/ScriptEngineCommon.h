@@ -142,6 +142,8 @@ __declspec(dllimport) UINT32
     ScriptEngineUnloadAllSymbols();
 __declspec(dllimport) UINT32
     ScriptEngineSearchSymbolForMask(const char * SearchMask);
+__declspec(dllimport) BOOLEAN
+    ScriptEngineConvertAddressToObjectName(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement);
 }
 #endif // SCRIPT_ENGINE_USER_MODE
 
@@ -617,8 +619,24 @@ ScriptEngineKeywordDq(PUINT64 Address, BOOL * HasError)
 // *** Functions ***
 //
 
+BOOLEAN
+ScriptEngineIsEventRecordRequested(ACTION_BUFFER ActionDetail)
+{
+#ifdef SCRIPT_ENGINE_KERNEL_MODE
+    if (ActionDetail.CurrentAction)
+    {
+        //
+        // The events with output sources send their results as records
+        //
+        return ((PDEBUGGER_EVENT_ACTION)ActionDetail.CurrentAction)->ScriptConfiguration.SendEventRecords;
+    }
+#endif // SCRIPT_ENGINE_KERNEL_MODE
+
+    return FALSE;
+}
+
 VOID
-ScriptEngineFunctionPrint(UINT64 Tag, BOOLEAN ImmediateMessagePassing, UINT64 Value)
+ScriptEngineFunctionPrint(UINT64 Tag, BOOLEAN ImmediateMessagePassing, BOOLEAN SendEventRecord, UINT64 Value)
 {
 #ifdef SCRIPT_ENGINE_USER_MODE
     ShowMessages("%llx\n", Value);
@@ -626,7 +644,14 @@ ScriptEngineFunctionPrint(UINT64 Tag, BOOLEAN ImmediateMessagePassing, UINT64 Va
 #endif // SCRIPT_ENGINE_USER_MODE
 
 #ifdef SCRIPT_ENGINE_KERNEL_MODE
-    LogSimpleWithTag(Tag, ImmediateMessagePassing, "%llx", Value);
+    if (SendEventRecord)
+    {
+        LogSendEventRecord(Tag, ImmediateMessagePassing, DEBUGGER_EVENT_RECORD_KIND_PRINT, &Value, 1, NULL, 0);
+    }
+    else
+    {
+        LogSimpleWithTag(Tag, ImmediateMessagePassing, "%llx", Value);
+    }
 #endif // SCRIPT_ENGINE_KERNEL_MODE
 }
 
@@ -700,7 +725,7 @@ ScriptEngineFunctionBreak(UINT64 Tag, BOOLEAN ImmediateMessagePassing, PGUEST_RE
 }
 
 VOID
-ScriptEngineFunctionFormats(UINT64 Tag, BOOLEAN ImmediateMessagePassing, UINT64 Value)
+ScriptEngineFunctionFormats(UINT64 Tag, BOOLEAN ImmediateMessagePassing, BOOLEAN SendEventRecord, UINT64 Value)
 {
 #ifdef SCRIPT_ENGINE_USER_MODE
     ShowMessages("%llx\n", Value);
@@ -712,6 +737,10 @@ ScriptEngineFunctionFormats(UINT64 Tag, BOOLEAN ImmediateMessagePassing, UINT64
     {
         KdSendFormatsFunctionResult(Value);
     }
+    else if (SendEventRecord)
+    {
+        LogSendEventRecord(Tag, ImmediateMessagePassing, DEBUGGER_EVENT_RECORD_KIND_FORMATS, &Value, 1, NULL, 0);
+    }
     else
     {
         LogSimpleWithTag(Tag, ImmediateMessagePassing, "%llx\n", Value);
@@ -811,6 +840,59 @@ ApplyFormatSpecifier(const CHAR * CurrentSpecifier, CHAR * FinalBuffer, PUINT32
     *CurrentPositionInFinalBuffer = *CurrentPositionInFinalBuffer + TempBufferLen;
 }
 
+VOID
+ApplySymbolFormatSpecifier(const CHAR * CurrentSpecifier, CHAR * FinalBuffer, PUINT32 CurrentProcessedPositionFromStartOfFormat, PUINT32 CurrentPositionInFinalBuffer, UINT64 Val, UINT32 SizeOfFinalBuffer)
+{
+    UINT32 TempBufferLen = 0;
+
+#ifdef SCRIPT_ENGINE_USER_MODE
+    CHAR TempBuffer[SYMBOL_MAXIMUM_OBJECT_NAME_LENGTH] = {0};
+#endif // SCRIPT_ENGINE_USER_MODE
+
+#ifdef SCRIPT_ENGINE_KERNEL_MODE
+    CHAR TempBuffer[SYMBOLIZED_ADDRESS_MARKER_LENGTH + 1] = {0};
+#endif // SCRIPT_ENGINE_KERNEL_MODE
+
+    *CurrentProcessedPositionFromStartOfFormat =
+        *CurrentProcessedPositionFromStartOfFormat + strlen(CurrentSpecifier);
+
+#ifdef SCRIPT_ENGINE_USER_MODE
+
+    //
+    // Convert the address to its symbol (module!name+offset) here
+    //
+    SymbolConvertAddressToString(Val, TempBuffer, sizeof(TempBuffer));
+
+#endif // SCRIPT_ENGINE_USER_MODE
+
+#ifdef SCRIPT_ENGINE_KERNEL_MODE
+
+    //
+    // Symbols are not available in the kernel, so the address is marked
+    // to be converted by the debugger when it receives the message
+    //
+    sprintf(TempBuffer, "%c%016llx", SYMBOLIZED_ADDRESS_MARKER, Val);
+
+#endif // SCRIPT_ENGINE_KERNEL_MODE
+
+    TempBufferLen = strlen(TempBuffer);
+
+    //
+    // Check final buffer capacity
+    //
+    if (*CurrentPositionInFinalBuffer + TempBufferLen > SizeOfFinalBuffer)
+    {
+        //
+        // Over passed buffer
+        //
+        return;
+    }
+
+    memcpy(&FinalBuffer[*CurrentPositionInFinalBuffer], TempBuffer, TempBufferLen);
+
+    *CurrentPositionInFinalBuffer = *CurrentPositionInFinalBuffer + TempBufferLen;
+}
+
 size_t
 WcharToChar(const wchar_t * src, char * dest, size_t dest_len)
 {
@@ -1018,6 +1100,7 @@ ScriptEngineFunctionPrintf(PGUEST_REGS   GuestRegs,
 
             if (Temp == 'd' || Temp == 'i' || Temp == 'u' || Temp == 'o' ||
                 Temp == 'x' || Temp == 'c' || Temp == 'p' || Temp == 's' ||
+                Temp == 'y' ||
 
                 !strncmp(Str, "%ws", 3) || !strncmp(Str, "%ls", 3) ||
 
@@ -1075,6 +1158,8 @@ ScriptEngineFunctionPrintf(PGUEST_REGS   GuestRegs,
     UINT64  Val;
     UINT32  Position;
     UINT32  LenOfFormats = strlen(Format) + 1;
+    UINT64  Values[DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES];
+    UINT32  CountOfValues = 0;
 
     for (int i = 0; i < ArgCount; i++)
     {
@@ -1089,6 +1174,14 @@ ScriptEngineFunctionPrintf(PGUEST_REGS   GuestRegs,
         Symbol->Type &= 0x7fffffff;
         Val = GetValue(GuestRegs, ActionDetail, g_TempList, g_VariableList, Symbol);
 
+        //
+        // Keep the raw values for the event records
+        //
+        if (CountOfValues < DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES)
+        {
+            Values[CountOfValues++] = Val;
+        }
+
         CHAR PercentageChar = Format[Position];
 
         /*
@@ -1214,6 +1307,19 @@ ScriptEngineFunctionPrintf(PGUEST_REGS   GuestRegs,
                     return;
                 }
             }
+            else if (!strncmp(FormatSpecifier, "%y", 2))
+            {
+                //
+                // for symbols (module!name+offset)
+                //
+                ApplySymbolFormatSpecifier(
+                    "%y",
+                    FinalBuffer,
+                    &CurrentProcessedPositionFromStartOfFormat,
+                    &CurrentPositionInFinalBuffer,
+                    Val,
+                    sizeof(FinalBuffer));
+            }
             else
             {
                 ApplyFormatSpecifier(FormatSpecifier, FinalBuffer, &CurrentProcessedPositionFromStartOfFormat, &CurrentPositionInFinalBuffer, Val, sizeof(FinalBuffer));
@@ -1258,7 +1364,20 @@ ScriptEngineFunctionPrintf(PGUEST_REGS   GuestRegs,
 #endif // SCRIPT_ENGINE_USER_MODE
 
 #ifdef SCRIPT_ENGINE_KERNEL_MODE
-    LogSimpleWithTag(Tag, ImmediateMessagePassing, "%s", FinalBuffer);
+    if (ScriptEngineIsEventRecordRequested(ActionDetail))
+    {
+        LogSendEventRecord(Tag,
+                           ImmediateMessagePassing,
+                           DEBUGGER_EVENT_RECORD_KIND_PRINTF,
+                           Values,
+                           CountOfValues,
+                           FinalBuffer,
+                           strnlen_s(FinalBuffer, sizeof(FinalBuffer)));
+    }
+    else
+    {
+        LogSimpleWithTag(Tag, ImmediateMessagePassing, "%s", FinalBuffer);
+    }
 #endif // SCRIPT_ENGINE_KERNEL_MODE
 }
 
@@ -2607,6 +2726,7 @@ ScriptEngineExecute(PGUEST_REGS GuestRegs, ACTION_BUFFER ActionDetail, UINT64 *
         //
         ScriptEngineFunctionPrint(ActionDetail.Tag,
                                   ActionDetail.ImmediatelySendTheResults,
+                                  ScriptEngineIsEventRecordRequested(ActionDetail),
                                   SrcVal0);
         return HasError;
 
@@ -2649,6 +2769,7 @@ ScriptEngineExecute(PGUEST_REGS GuestRegs, ACTION_BUFFER ActionDetail, UINT64 *
         ScriptEngineFunctionFormats(
             ActionDetail.Tag,
             ActionDetail.ImmediatelySendTheResults,
+            ScriptEngineIsEventRecordRequested(ActionDetail),
             SrcVal0);
         return HasError;
 
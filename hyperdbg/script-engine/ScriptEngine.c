@@ -69,12 +69,312 @@ ScriptEngineSearchSymbolForMask(const char * SearchMask)
     return SymSearchSymbolForMask(SearchMask);
 }
 
+BOOLEAN
+ScriptEngineConvertAddressToObjectName(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement)
+{
+    //
+    // A wrapper for pdb address converter
+    //
+    return SymConvertAddressToObjectName(Address, ObjectName, ObjectNameSize, Displacement);
+}
+
 /**
+* @brief parse the script and generate the code
+* @details the field accesses are converted to constant offsets before
+* parsing the script
 *
-*
+* @param str the script
+* @return PSYMBOL_BUFFER
 */
 PSYMBOL_BUFFER
 ScriptEngineParse(char * str)
+{
+    PSYMBOL_BUFFER CodeBuffer;
+    char *         Message = NULL;
+    char *         Script  = ScriptEngineResolveFieldAccesses(str, &Message);
+
+    if (Script == NULL)
+    {
+        CodeBuffer          = NewSymbolBuffer();
+        CodeBuffer->Message = Message;
+        return CodeBuffer;
+    }
+
+    CodeBuffer = ScriptEngineParseScript(Script);
+
+    if (Script != str)
+    {
+        free(Script);
+    }
+
+    return CodeBuffer;
+}
+
+/**
+* @brief checks whether a character can be a part of the operands and
+* the names of the field accesses
+*
+* @param c
+* @return BOOLEAN
+*/
+BOOLEAN
+IsFieldAccessNameChar(char c)
+{
+    return IsLetter(c) || IsDecimal(c) || c == '_' || c == '`';
+}
+
+/**
+* @brief convert the field accesses of the structures to constant offsets
+* @details "Operand->Type.Field" (e.g., "@rcx->_EPROCESS.ImageFileName")
+* is the address of the field in the structure that starts at the operand,
+* it's converted to "(Operand + 0xOffset)" using the layout of the
+* structure in the loaded symbols, so accessing the fields doesn't have
+* any cost when the script is executed, the fields of the nested
+* structures are separated by dots (e.g., "_EPROCESS.Pcb.DirectoryTableBase")
+*
+* @param str the script
+* @param ErrorMessage the error message if a field is not resolved
+* @return char * the converted script (or str itself if there is no field
+* access), NULL if a field is not resolved
+*/
+char *
+ScriptEngineResolveFieldAccesses(char * str, char ** ErrorMessage)
+{
+    size_t Length        = strlen(str);
+    size_t CountOfArrows = 0;
+    size_t ResultIdx     = 0;
+    size_t i             = 0;
+    char * Result;
+    char   TypeName[FIELD_ACCESS_MAXIMUM_NAME_LENGTH];
+    char   FieldPath[FIELD_ACCESS_MAXIMUM_NAME_LENGTH];
+
+    for (i = 0; i + 1 < Length; i++)
+    {
+        if (str[i] == '-' && str[i + 1] == '>')
+        {
+            CountOfArrows++;
+        }
+    }
+
+    if (CountOfArrows == 0)
+    {
+        //
+        // Most of the scripts don't have any field access
+        //
+        return str;
+    }
+
+    Result = (char *)malloc(Length + CountOfArrows * FIELD_ACCESS_MAXIMUM_EXPANSION + 1);
+
+    i = 0;
+
+    while (i < Length)
+    {
+        size_t ArrowIdx;
+        size_t OperandStart;
+        size_t OperandEnd;
+        size_t NameStart;
+        UINT32 Offset = 0;
+
+        //
+        // Copy the strings and the comments without any change
+        //
+        if (str[i] == '"')
+        {
+            Result[ResultIdx++] = str[i++];
+
+            while (i < Length && str[i] != '"')
+            {
+                if (str[i] == '\\' && i + 1 < Length)
+                {
+                    Result[ResultIdx++] = str[i++];
+                }
+                Result[ResultIdx++] = str[i++];
+            }
+
+            if (i < Length)
+            {
+                Result[ResultIdx++] = str[i++];
+            }
+            continue;
+        }
+        else if (str[i] == '/' && str[i + 1] == '/')
+        {
+            while (i < Length && str[i] != '\n')
+            {
+                Result[ResultIdx++] = str[i++];
+            }
+            continue;
+        }
+        else if (str[i] == '/' && str[i + 1] == '*')
+        {
+            Result[ResultIdx++] = str[i++];
+            Result[ResultIdx++] = str[i++];
+
+            while (i < Length && !(str[i] == '*' && str[i + 1] == '/'))
+            {
+                Result[ResultIdx++] = str[i++];
+            }
+
+            if (i < Length)
+            {
+                Result[ResultIdx++] = str[i++];
+                Result[ResultIdx++] = str[i++];
+            }
+            continue;
+        }
+        else if (str[i] != '-' || str[i + 1] != '>')
+        {
+            Result[ResultIdx++] = str[i++];
+            continue;
+        }
+
+        ArrowIdx = i;
+
+        //
+        // Find the operand before the arrow, it's either a parenthesized
+        // expression (e.g., "poi(@rcx + 8)") or a register, a pseudo-register,
+        // an id or a number
+        //
+        OperandEnd = ResultIdx;
+
+        while (OperandEnd > 0 && (Result[OperandEnd - 1] == ' ' || Result[OperandEnd - 1] == '\t'))
+        {
+            OperandEnd--;
+        }
+
+        OperandStart = OperandEnd;
+
+        if (OperandStart > 0 && Result[OperandStart - 1] == ')')
+        {
+            int Depth = 0;
+
+            do
+            {
+                OperandStart--;
+
+                if (Result[OperandStart] == ')')
+                {
+                    Depth++;
+                }
+                else if (Result[OperandStart] == '(')
+                {
+                    Depth--;
+                }
+            } while (OperandStart > 0 && Depth != 0);
+        }
+
+        while (OperandStart > 0 && IsFieldAccessNameChar(Result[OperandStart - 1]))
+        {
+            OperandStart--;
+        }
+
+        if (OperandStart > 0 && (Result[OperandStart - 1] == '@' || Result[OperandStart - 1] == '$'))
+        {
+            OperandStart--;
+        }
+
+        //
+        // Read the name of the structure and the field
+        //
+        i += 2;
+
+        while (i < Length && (str[i] == ' ' || str[i] == '\t'))
+        {
+            i++;
+        }
+
+        NameStart = i;
+
+        while (i < Length && (IsFieldAccessNameChar(str[i]) || str[i] == '!'))
+        {
+            i++;
+        }
+
+        if (i - NameStart < FIELD_ACCESS_MAXIMUM_NAME_LENGTH)
+        {
+            memcpy(TypeName, &str[NameStart], i - NameStart);
+            TypeName[i - NameStart] = '\0';
+        }
+        else
+        {
+            TypeName[0] = '\0';
+        }
+
+        FieldPath[0] = '\0';
+
+        if (i < Length && str[i] == '.')
+        {
+            NameStart = ++i;
+
+            while (i < Length && (IsFieldAccessNameChar(str[i]) || str[i] == '.'))
+            {
+                i++;
+            }
+
+            if (i - NameStart < FIELD_ACCESS_MAXIMUM_NAME_LENGTH)
+            {
+                memcpy(FieldPath, &str[NameStart], i - NameStart);
+                FieldPath[i - NameStart] = '\0';
+            }
+        }
+
+        if (OperandStart == OperandEnd || TypeName[0] == '\0' || FieldPath[0] == '\0' ||
+            !SymGetFieldOffset(TypeName, FieldPath, &Offset))
+        {
+            //
+            // Show the line of the field access in the error
+            //
+            CurrentLine     = 0;
+            CurrentLineIdx  = 0;
+            CurrentTokenIdx = ArrowIdx;
+
+            for (size_t j = 0; j < ArrowIdx; j++)
+            {
+                if (str[j] == '\n')
+                {
+                    CurrentLine++;
+                    CurrentLineIdx = j + 1;
+                }
+            }
+
+            InputIdx = ArrowIdx;
+
+            while (str[InputIdx] != '\n' && str[InputIdx] != '\0')
+            {
+                InputIdx++;
+            }
+
+            *ErrorMessage = HandleError(UNRESOLVED_FIELD, str);
+
+            free(Result);
+            return NULL;
+        }
+
+        //
+        // Convert it to "(Operand + 0xOffset)"
+        //
+        memmove(&Result[OperandStart + 1], &Result[OperandStart], ResultIdx - OperandStart);
+        Result[OperandStart] = '(';
+        ResultIdx++;
+
+        ResultIdx += sprintf(&Result[ResultIdx], " + 0x%x)", Offset);
+    }
+
+    Result[ResultIdx] = '\0';
+
+    return Result;
+}
+
+/**
+* @brief parse the script (after converting the field accesses) and
+* generate the code
+*
+* @param str the script
+* @return PSYMBOL_BUFFER
+*/
+PSYMBOL_BUFFER
+ScriptEngineParseScript(char * str)
 {
     TOKEN_LIST Stack = NewTokenList();
     TOKEN_LIST LALRInputTokens;
@@ -1791,6 +2091,11 @@ HandleError(unsigned int ErrorType, char * str)
         strcat(Message, "Unkown Token");
         return Message;
 
+    case UNRESOLVED_FIELD:
+        strcat(Message, "SymbolError: ");
+        strcat(Message, "Unresolved Structure or Field");
+        return Message;
+
     default:
         strcat(Message, "Unkown Error: ");
         return Message;
@@ -26,6 +26,8 @@ __declspec(dllimport) UINT64 SymConvertNameToAddress(const char * FunctionOrVari
 __declspec(dllimport) UINT32 SymLoadFileSymbol(UINT64 BaseAddress, const char * PdbFileName);
 __declspec(dllimport) UINT32 SymUnloadAllSymbols();
 __declspec(dllimport) UINT32 SymSearchSymbolForMask(const char * SearchMask);
+__declspec(dllimport) BOOLEAN SymConvertAddressToObjectName(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement);
+__declspec(dllimport) BOOLEAN SymGetFieldOffset(const char * TypeName, const char * FieldPath, PUINT32 FieldOffset);
 
 //
 // *** export pdb wrapper as script engine function ***
@@ -38,11 +40,26 @@ __declspec(dllexport) UINT32
     ScriptEngineUnloadAllSymbols();
 __declspec(dllexport) UINT32
     ScriptEngineSearchSymbolForMask(const char * SearchMask);
+__declspec(dllexport) BOOLEAN
+    ScriptEngineConvertAddressToObjectName(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement);
 //
 // *** Exoort script engine functions ***
 //
-#    define SYNTAX_ERROR 0
-#    define UNKOWN_TOKEN 1
+#    define SYNTAX_ERROR     0
+#    define UNKOWN_TOKEN     1
+#    define UNRESOLVED_FIELD 2
+
+/**
+* @brief maximum length of the names of the structures and the fields
+* in the field accesses (Operand->Type.Field)
+*/
+#    define FIELD_ACCESS_MAXIMUM_NAME_LENGTH 256
+
+/**
+* @brief maximum count of the characters that are added to the script
+* by converting a field access to "(Operand + 0xOffset)"
+*/
+#    define FIELD_ACCESS_MAXIMUM_EXPANSION 16
 
 PSYMBOL
 NewSymbol(void);
@@ -73,6 +90,15 @@ ToSymbol(TOKEN Token);
 
 __declspec(dllexport) PSYMBOL_BUFFER ScriptEngineParse(char * str);
 
+PSYMBOL_BUFFER
+ScriptEngineParseScript(char * str);
+
+BOOLEAN
+IsFieldAccessNameChar(char c);
+
+char *
+ScriptEngineResolveFieldAccesses(char * str, char ** ErrorMessage);
+
 char *
 ScriptEngineBooleanExpresssionParse(
     UINT64         BooleanExpressionSize,
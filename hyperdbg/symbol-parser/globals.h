@@ -0,0 +1,23 @@
+/**
+ * @file globals.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Global Variables of the symbol parser
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//		    	Global Variables                //
+//////////////////////////////////////////////////
+
+std::vector<PSYMBOL_LOADED_MODULE_DETAILS> g_LoadedModules;
+BOOLEAN                                    g_IsLoadedModulesInitialized = FALSE;
+CHAR *                                     g_CurrentModuleName          = NULL;
+CHAR                                       g_NtModuleName[_MAX_FNAME]   = {0};
+
+SYMBOL_ADDRESS_CACHE_ENTRY g_SymbolAddressCache[SymbolAddressCacheEntries] = {0};
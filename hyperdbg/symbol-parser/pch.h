@@ -11,21 +11,36 @@
  */
 #pragma once
 
-#include <Windows.h>
-#include <string>
-#include <iomanip>
-#include <sstream>
-#include <vector>
+#ifdef HYPERDBG_UNIT_TESTS
 
-#define _NO_CVCONST_H // for symbol parsing
-#include <DbgHelp.h>
+//
+// The unit tests build the portable modules on other platforms, so the
+// definitions of Windows are provided by the tests
+//
+#    include "symbol-parser-unit-tests.h"
+
+#else
 
-#include "Definition.h"
-#include "symbol-parser.h"
+#    include <Windows.h>
+#    include <string>
+#    include <iomanip>
+#    include <sstream>
+#    include <vector>
+#    include <algorithm>
+
+#    define _NO_CVCONST_H // for symbol parsing
+#    include <DbgHelp.h>
+
+#    include "Definition.h"
+#    include "pdb-reader.h"
+#    include "symbol-lookup.h"
+#    include "symbol-parser.h"
 
 using namespace std;
 
 //
 // Needed to link symbol server
 //
-#pragma comment(lib, "dbghelp.lib")
+#    pragma comment(lib, "dbghelp.lib")
+
+#endif // HYPERDBG_UNIT_TESTS
@@ -0,0 +1,1891 @@
+/**
+ * @file pdb-reader.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Native reader of pdb (MSF) files
+ * @details The file is memory-mapped and the DBI, section headers and
+ * symbol records streams are parsed on the first lookup, then a hash
+ * table (name to rva) and a sorted array (rva to symbol) are built from
+ * the public and global symbols, the result is saved in an index file
+ * that is mapped instead of parsing the pdb file in the next sessions,
+ * the layout of the structures is read from the TPI stream on the first
+ * lookup of a structure
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+
+#ifdef _WIN32
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "pdb-reader.h"
+
+//////////////////////////////////////////////////
+//				MSF File Format                 //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Magic of the MSF 7.00 files
+ *
+ */
+static const char PdbReaderMsfMagic[] = "Microsoft C/C++ MSF 7.00\r\n\x1a\x44\x53\x00\x00\x00";
+
+#define PDB_READER_MSF_MAGIC_SIZE 32
+#define PDB_READER_NIL_STREAM     0xffffffff
+#define PDB_READER_INVALID_INDEX  0xffff
+
+/**
+ * @brief Fixed streams of the pdb file
+ *
+ */
+#define PDB_READER_PDB_STREAM 1
+#define PDB_READER_TPI_STREAM 2
+#define PDB_READER_DBI_STREAM 3
+
+/**
+ * @brief Index of the section headers stream in the optional debug
+ * header of the DBI stream
+ *
+ */
+#define PDB_READER_DBG_HEADER_SECTION_HEADERS 5
+
+/**
+ * @brief Size of the IMAGE_SECTION_HEADER structure and the offset of
+ * its VirtualSize and VirtualAddress fields
+ *
+ */
+#define PDB_READER_SECTION_HEADER_SIZE            40
+#define PDB_READER_SECTION_HEADER_VIRTUAL_SIZE    8
+#define PDB_READER_SECTION_HEADER_VIRTUAL_ADDRESS 12
+
+/**
+ * @brief Kinds of the CodeView records in the field lists
+ *
+ */
+#define PDB_READER_LF_FIELDLIST 0x1203
+#define PDB_READER_LF_BCLASS    0x1400
+#define PDB_READER_LF_VBCLASS   0x1401
+#define PDB_READER_LF_IVBCLASS  0x1402
+#define PDB_READER_LF_INDEX     0x1404
+#define PDB_READER_LF_VFUNCTAB  0x1409
+#define PDB_READER_LF_ENUMERATE 0x1502
+#define PDB_READER_LF_MEMBER    0x150d
+#define PDB_READER_LF_STMEMBER  0x150e
+#define PDB_READER_LF_METHOD    0x150f
+#define PDB_READER_LF_NESTTYPE  0x1510
+#define PDB_READER_LF_ONEMETHOD 0x1511
+
+/**
+ * @brief Kinds of the numeric leaves (values below LF_NUMERIC are
+ * stored in the leaf itself)
+ *
+ */
+#define PDB_READER_LF_NUMERIC   0x8000
+#define PDB_READER_LF_CHAR      0x8000
+#define PDB_READER_LF_SHORT     0x8001
+#define PDB_READER_LF_USHORT    0x8002
+#define PDB_READER_LF_LONG      0x8003
+#define PDB_READER_LF_ULONG     0x8004
+#define PDB_READER_LF_QUADWORD  0x8009
+#define PDB_READER_LF_UQUADWORD 0x800a
+
+/**
+ * @brief The structure is a forward reference (property of the records
+ * of the structures)
+ *
+ */
+#define PDB_READER_PROPERTY_FORWARD_REFERENCE 0x80
+
+/**
+ * @brief Methods that are introducing virtual methods have an extra
+ * offset in their LF_ONEMETHOD records
+ *
+ */
+#define PDB_READER_METHOD_PROPERTY(Attributes) (((Attributes) >> 2) & 7)
+#define PDB_READER_METHOD_INTRO_VIRTUAL        4
+#define PDB_READER_METHOD_PURE_INTRO_VIRTUAL   6
+
+#pragma pack(push, 1)
+
+/**
+ * @brief The first block of the MSF file
+ *
+ */
+typedef struct _PDB_READER_MSF_SUPER_BLOCK
+{
+    char     Magic[PDB_READER_MSF_MAGIC_SIZE];
+    uint32_t BlockSize;
+    uint32_t FreeBlockMapBlock;
+    uint32_t NumBlocks;
+    uint32_t NumDirectoryBytes;
+    uint32_t Unknown;
+    uint32_t BlockMapAddr;
+
+} PDB_READER_MSF_SUPER_BLOCK, *PPDB_READER_MSF_SUPER_BLOCK;
+
+/**
+ * @brief Header of the PDB stream
+ *
+ */
+typedef struct _PDB_READER_PDB_STREAM_HEADER
+{
+    uint32_t Version;
+    uint32_t Signature;
+    uint32_t Age;
+    uint8_t  Guid[16];
+
+} PDB_READER_PDB_STREAM_HEADER, *PPDB_READER_PDB_STREAM_HEADER;
+
+/**
+ * @brief Header of the DBI stream
+ *
+ */
+typedef struct _PDB_READER_DBI_HEADER
+{
+    int32_t  VersionSignature;
+    uint32_t VersionHeader;
+    uint32_t Age;
+    uint16_t GlobalStreamIndex;
+    uint16_t BuildNumber;
+    uint16_t PublicStreamIndex;
+    uint16_t PdbDllVersion;
+    uint16_t SymRecordStreamIndex;
+    uint16_t PdbDllRbld;
+    int32_t  ModInfoSize;
+    int32_t  SectionContributionSize;
+    int32_t  SectionMapSize;
+    int32_t  SourceInfoSize;
+    int32_t  TypeServerMapSize;
+    uint32_t MfcTypeServerIndex;
+    int32_t  OptionalDbgHeaderSize;
+    int32_t  EcSubstreamSize;
+    uint16_t Flags;
+    uint16_t Machine;
+    uint32_t Padding;
+
+} PDB_READER_DBI_HEADER, *PPDB_READER_DBI_HEADER;
+
+/**
+ * @brief Header of the TPI stream
+ *
+ */
+typedef struct _PDB_READER_TPI_HEADER
+{
+    uint32_t Version;
+    uint32_t HeaderSize;
+    uint32_t TypeIndexBegin;
+    uint32_t TypeIndexEnd;
+    uint32_t TypeRecordBytes;
+    uint16_t HashStreamIndex;
+    uint16_t HashAuxStreamIndex;
+    uint32_t HashKeySize;
+    uint32_t NumHashBuckets;
+    int32_t  HashValueBufferOffset;
+    uint32_t HashValueBufferLength;
+    int32_t  IndexOffsetBufferOffset;
+    uint32_t IndexOffsetBufferLength;
+    int32_t  HashAdjBufferOffset;
+    uint32_t HashAdjBufferLength;
+
+} PDB_READER_TPI_HEADER, *PPDB_READER_TPI_HEADER;
+
+/**
+ * @brief Header of the CodeView symbol records
+ *
+ */
+typedef struct _PDB_READER_RECORD_HEADER
+{
+    uint16_t RecordLength; // Length of the record (without this field)
+    uint16_t RecordKind;
+
+} PDB_READER_RECORD_HEADER, *PPDB_READER_RECORD_HEADER;
+
+/**
+ * @brief Body of the S_PUB32, S_GDATA32 and S_LDATA32 records
+ * @details For public symbols, the first field is the flags and
+ * for data symbols, it's the type index
+ *
+ */
+typedef struct _PDB_READER_ADDRESS_RECORD
+{
+    uint32_t FlagsOrType;
+    uint32_t Offset;
+    uint16_t Segment;
+
+} PDB_READER_ADDRESS_RECORD, *PPDB_READER_ADDRESS_RECORD;
+
+#pragma pack(pop)
+
+//////////////////////////////////////////////////
+//				Index File Format               //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Magic and version of the index files
+ * @details The version should be changed if the layout of the file or
+ * the hash function of the names is changed
+ *
+ */
+static const char PdbReaderIndexMagic[] = "HDSYMIDX";
+
+#define PDB_READER_INDEX_MAGIC_SIZE 8
+#define PDB_READER_INDEX_VERSION    1
+
+#pragma pack(push, 1)
+
+/**
+ * @brief Header of the index file
+ * @details The header is followed by the symbols (sorted by the rva),
+ * the name hash table and the null-terminated names, the file is only
+ * used if the guid and the age match the pdb file
+ *
+ */
+typedef struct _PDB_READER_INDEX_HEADER
+{
+    char     Magic[PDB_READER_INDEX_MAGIC_SIZE];
+    uint32_t Version;
+    uint32_t Age;
+    uint8_t  Guid[16];
+    uint32_t ImageSize;
+    uint32_t CountOfSymbols;
+    uint32_t HashTableSize;
+    uint32_t NamesSize;
+
+} PDB_READER_INDEX_HEADER, *PPDB_READER_INDEX_HEADER;
+
+/**
+ * @brief A symbol in the index file
+ *
+ */
+typedef struct _PDB_READER_INDEX_SYMBOL
+{
+    uint32_t Rva;
+    uint16_t Kind;
+    uint16_t Reserved;
+    uint32_t NameOffset; // Offset of the name from the start of the names
+
+} PDB_READER_INDEX_SYMBOL, *PPDB_READER_INDEX_SYMBOL;
+
+#pragma pack(pop)
+
+//////////////////////////////////////////////////
+//				Mapping The File                //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Map a file to the memory
+ *
+ * @param Mapping
+ * @param FileName
+ *
+ * @return bool
+ */
+static bool
+PdbReaderMapFile(PPDB_READER_MAPPING Mapping, const char * FileName)
+{
+#ifdef _WIN32
+
+    HANDLE        FileHandle;
+    HANDLE        MappingHandle;
+    LARGE_INTEGER FileSize;
+
+    FileHandle = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    if (!GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0)
+    {
+        CloseHandle(FileHandle);
+        return false;
+    }
+
+    MappingHandle = CreateFileMappingA(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (MappingHandle == NULL)
+    {
+        CloseHandle(FileHandle);
+        return false;
+    }
+
+    Mapping->Data = (const uint8_t *)MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if (Mapping->Data == NULL)
+    {
+        CloseHandle(MappingHandle);
+        CloseHandle(FileHandle);
+        return false;
+    }
+
+    Mapping->Size          = FileSize.QuadPart;
+    Mapping->FileHandle    = FileHandle;
+    Mapping->MappingHandle = MappingHandle;
+
+#else
+
+    int         FileDescriptor;
+    struct stat FileStat;
+    void *      View;
+
+    FileDescriptor = open(FileName, O_RDONLY);
+
+    if (FileDescriptor == -1)
+    {
+        return false;
+    }
+
+    if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size == 0)
+    {
+        close(FileDescriptor);
+        return false;
+    }
+
+    View = mmap(NULL, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+
+    //
+    // The mapping remains valid after closing the file
+    //
+    close(FileDescriptor);
+
+    if (View == MAP_FAILED)
+    {
+        return false;
+    }
+
+    Mapping->Data = (const uint8_t *)View;
+    Mapping->Size = FileStat.st_size;
+
+#endif
+
+    return true;
+}
+
+/**
+ * @brief Unmap a mapped file
+ *
+ * @param Mapping
+ *
+ * @return void
+ */
+static void
+PdbReaderUnmapFile(PPDB_READER_MAPPING Mapping)
+{
+    if (Mapping->Data == NULL)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+
+    UnmapViewOfFile(Mapping->Data);
+    CloseHandle((HANDLE)Mapping->MappingHandle);
+    CloseHandle((HANDLE)Mapping->FileHandle);
+
+#else
+
+    munmap((void *)Mapping->Data, Mapping->Size);
+
+#endif
+
+    Mapping->Data = NULL;
+}
+
+//////////////////////////////////////////////////
+//				Reading The MSF                 //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the address of a block in the mapped file
+ *
+ * @param Reader
+ * @param BlockIndex
+ *
+ * @return const uint8_t * NULL if the block is out of the file
+ */
+static const uint8_t *
+PdbReaderGetBlock(PPDB_READER Reader, uint32_t BlockIndex)
+{
+    uint64_t Offset = (uint64_t)BlockIndex * Reader->BlockSize;
+
+    if (Offset + Reader->BlockSize > Reader->File.Size)
+    {
+        return NULL;
+    }
+
+    return Reader->File.Data + Offset;
+}
+
+/**
+ * @brief Read the contents of a list of blocks
+ * @details If the blocks are contiguous, the result points to the mapped
+ * file, otherwise the blocks are copied to the buffer of the stream
+ *
+ * @param Reader
+ * @param Blocks
+ * @param Size
+ * @param Stream
+ *
+ * @return bool
+ */
+static bool
+PdbReaderReadBlocks(PPDB_READER Reader, const std::vector<uint32_t> & Blocks, uint32_t Size, PPDB_READER_STREAM Stream)
+{
+    bool IsContiguous = true;
+
+    Stream->Data = NULL;
+    Stream->Size = Size;
+    Stream->Buffer.clear();
+
+    if (Size == 0)
+    {
+        return true;
+    }
+
+    for (size_t i = 0; i < Blocks.size(); i++)
+    {
+        if (PdbReaderGetBlock(Reader, Blocks[i]) == NULL)
+        {
+            return false;
+        }
+
+        if (i != 0 && Blocks[i] != Blocks[i - 1] + 1)
+        {
+            IsContiguous = false;
+        }
+    }
+
+    if (IsContiguous)
+    {
+        Stream->Data = PdbReaderGetBlock(Reader, Blocks[0]);
+        return true;
+    }
+
+    //
+    // Gather the blocks
+    //
+    Stream->Buffer.resize((size_t)Blocks.size() * Reader->BlockSize);
+
+    for (size_t i = 0; i < Blocks.size(); i++)
+    {
+        memcpy(&Stream->Buffer[i * Reader->BlockSize], PdbReaderGetBlock(Reader, Blocks[i]), Reader->BlockSize);
+    }
+
+    Stream->Data = Stream->Buffer.data();
+
+    return true;
+}
+
+/**
+ * @brief Read a stream of the pdb file
+ *
+ * @param Reader
+ * @param StreamIndex
+ * @param Stream
+ *
+ * @return bool
+ */
+static bool
+PdbReaderReadStream(PPDB_READER Reader, uint32_t StreamIndex, PPDB_READER_STREAM Stream)
+{
+    if (StreamIndex >= Reader->StreamSizes.size())
+    {
+        return false;
+    }
+
+    return PdbReaderReadBlocks(Reader, Reader->StreamBlocks[StreamIndex], Reader->StreamSizes[StreamIndex], Stream);
+}
+
+/**
+ * @brief Read the super block and the directory of the MSF file
+ *
+ * @param Reader
+ *
+ * @return bool
+ */
+static bool
+PdbReaderReadDirectory(PPDB_READER Reader)
+{
+    PPDB_READER_MSF_SUPER_BLOCK SuperBlock;
+    PDB_READER_STREAM           Directory;
+    std::vector<uint32_t>       DirectoryBlocks;
+    const uint32_t *            BlockMap;
+    const uint32_t *            Entries;
+    uint32_t                    CountOfDirectoryBlocks;
+    uint32_t                    CountOfStreams;
+    uint32_t                    CountOfEntries;
+    uint32_t                    Index;
+
+    if (Reader->File.Size < sizeof(PDB_READER_MSF_SUPER_BLOCK))
+    {
+        return false;
+    }
+
+    SuperBlock = (PPDB_READER_MSF_SUPER_BLOCK)Reader->File.Data;
+
+    if (memcmp(SuperBlock->Magic, PdbReaderMsfMagic, PDB_READER_MSF_MAGIC_SIZE) != 0)
+    {
+        return false;
+    }
+
+    if (SuperBlock->BlockSize != 512 && SuperBlock->BlockSize != 1024 &&
+        SuperBlock->BlockSize != 2048 && SuperBlock->BlockSize != 4096)
+    {
+        return false;
+    }
+
+    Reader->BlockSize = SuperBlock->BlockSize;
+
+    //
+    // The block map is a list of the blocks of the directory
+    //
+    CountOfDirectoryBlocks = (SuperBlock->NumDirectoryBytes + Reader->BlockSize - 1) / Reader->BlockSize;
+
+    BlockMap = (const uint32_t *)PdbReaderGetBlock(Reader, SuperBlock->BlockMapAddr);
+
+    if (BlockMap == NULL || CountOfDirectoryBlocks == 0 ||
+        CountOfDirectoryBlocks > Reader->BlockSize / sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    DirectoryBlocks.assign(BlockMap, BlockMap + CountOfDirectoryBlocks);
+
+    if (!PdbReaderReadBlocks(Reader, DirectoryBlocks, SuperBlock->NumDirectoryBytes, &Directory))
+    {
+        return false;
+    }
+
+    //
+    // The directory is the count of streams, then the size of each
+    // stream, then the blocks of each stream
+    //
+    Entries        = (const uint32_t *)Directory.Data;
+    CountOfEntries = Directory.Size / sizeof(uint32_t);
+
+    if (CountOfEntries == 0)
+    {
+        return false;
+    }
+
+    CountOfStreams = Entries[0];
+
+    if (CountOfStreams > CountOfEntries - 1)
+    {
+        return false;
+    }
+
+    Reader->StreamSizes.assign(Entries + 1, Entries + 1 + CountOfStreams);
+    Reader->StreamBlocks.resize(CountOfStreams);
+
+    Index = 1 + CountOfStreams;
+
+    for (uint32_t i = 0; i < CountOfStreams; i++)
+    {
+        uint32_t CountOfBlocks;
+
+        if (Reader->StreamSizes[i] == PDB_READER_NIL_STREAM)
+        {
+            Reader->StreamSizes[i] = 0;
+        }
+
+        CountOfBlocks = (Reader->StreamSizes[i] + Reader->BlockSize - 1) / Reader->BlockSize;
+
+        if (CountOfBlocks > CountOfEntries - Index)
+        {
+            return false;
+        }
+
+        Reader->StreamBlocks[i].assign(Entries + Index, Entries + Index + CountOfBlocks);
+
+        Index += CountOfBlocks;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read the guid and the age of the pdb file
+ *
+ * @param Reader
+ *
+ * @return bool
+ */
+static bool
+PdbReaderReadIdentity(PPDB_READER Reader)
+{
+    PDB_READER_STREAM PdbStream;
+
+    if (!PdbReaderReadStream(Reader, PDB_READER_PDB_STREAM, &PdbStream) ||
+        PdbStream.Size < sizeof(PDB_READER_PDB_STREAM_HEADER))
+    {
+        return false;
+    }
+
+    memcpy(Reader->Guid, ((PPDB_READER_PDB_STREAM_HEADER)PdbStream.Data)->Guid, sizeof(Reader->Guid));
+    Reader->Age = ((PPDB_READER_PDB_STREAM_HEADER)PdbStream.Data)->Age;
+
+    return true;
+}
+
+//////////////////////////////////////////////////
+//				Index Of The Symbols            //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Map the index file and read the symbols from it
+ * @details The names are not copied, they point to the mapped file
+ *
+ * @param Reader
+ *
+ * @return bool false if the file is not available or doesn't match
+ * the pdb file
+ */
+static bool
+PdbReaderLoadIndex(PPDB_READER Reader)
+{
+    PPDB_READER_INDEX_HEADER Header;
+    PPDB_READER_INDEX_SYMBOL IndexSymbols;
+    const uint32_t *         HashTable;
+    const char *             Names;
+    uint64_t                 ExpectedSize;
+
+    if (Reader->IndexFileName.empty() || !PdbReaderMapFile(&Reader->Index, Reader->IndexFileName.c_str()))
+    {
+        return false;
+    }
+
+    Header = (PPDB_READER_INDEX_HEADER)Reader->Index.Data;
+
+    if (Reader->Index.Size < sizeof(PDB_READER_INDEX_HEADER) ||
+        memcmp(Header->Magic, PdbReaderIndexMagic, PDB_READER_INDEX_MAGIC_SIZE) != 0 ||
+        Header->Version != PDB_READER_INDEX_VERSION ||
+        Header->Age != Reader->Age ||
+        memcmp(Header->Guid, Reader->Guid, sizeof(Reader->Guid)) != 0)
+    {
+        PdbReaderUnmapFile(&Reader->Index);
+        return false;
+    }
+
+    ExpectedSize = sizeof(PDB_READER_INDEX_HEADER) +
+                   (uint64_t)Header->CountOfSymbols * sizeof(PDB_READER_INDEX_SYMBOL) +
+                   (uint64_t)Header->HashTableSize * sizeof(uint32_t) +
+                   Header->NamesSize;
+
+    //
+    // The hash table should be a power of two and larger than the count
+    // of the symbols, and the last name should be terminated
+    //
+    if (ExpectedSize != Reader->Index.Size ||
+        Header->HashTableSize <= Header->CountOfSymbols ||
+        (Header->HashTableSize & (Header->HashTableSize - 1)) != 0 ||
+        (Header->NamesSize != 0 && Reader->Index.Data[Reader->Index.Size - 1] != '\0'))
+    {
+        PdbReaderUnmapFile(&Reader->Index);
+        return false;
+    }
+
+    IndexSymbols = (PPDB_READER_INDEX_SYMBOL)(Header + 1);
+    HashTable    = (const uint32_t *)(IndexSymbols + Header->CountOfSymbols);
+    Names        = (const char *)(HashTable + Header->HashTableSize);
+
+    Reader->Symbols.resize(Header->CountOfSymbols);
+
+    for (uint32_t i = 0; i < Header->CountOfSymbols; i++)
+    {
+        if (IndexSymbols[i].NameOffset >= Header->NamesSize)
+        {
+            Reader->Symbols.clear();
+            PdbReaderUnmapFile(&Reader->Index);
+            return false;
+        }
+
+        Reader->Symbols[i].Rva  = IndexSymbols[i].Rva;
+        Reader->Symbols[i].Kind = IndexSymbols[i].Kind;
+        Reader->Symbols[i].Name = Names + IndexSymbols[i].NameOffset;
+    }
+
+    for (uint32_t i = 0; i < Header->HashTableSize; i++)
+    {
+        if (HashTable[i] > Header->CountOfSymbols)
+        {
+            Reader->Symbols.clear();
+            PdbReaderUnmapFile(&Reader->Index);
+            return false;
+        }
+    }
+
+    Reader->NameHashTable.assign(HashTable, HashTable + Header->HashTableSize);
+    Reader->ImageSize     = Header->ImageSize;
+    Reader->IsIndexLoaded = true;
+
+    return true;
+}
+
+/**
+ * @brief Save the parsed symbols to the index file
+ * @details It's not an error if the file can't be written (e.g., the
+ * directory of the pdb file is read-only), the pdb file is parsed again
+ * in the next sessions
+ *
+ * @param Reader
+ *
+ * @return bool
+ */
+static bool
+PdbReaderSaveIndex(PPDB_READER Reader)
+{
+    PDB_READER_INDEX_HEADER              Header = {};
+    std::vector<PDB_READER_INDEX_SYMBOL> IndexSymbols(Reader->Symbols.size());
+    std::vector<char>                    Names;
+    FILE *                               IndexFile;
+    bool                                 Result;
+
+    if (Reader->IndexFileName.empty())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < Reader->Symbols.size(); i++)
+    {
+        IndexSymbols[i].Rva        = Reader->Symbols[i].Rva;
+        IndexSymbols[i].Kind       = Reader->Symbols[i].Kind;
+        IndexSymbols[i].Reserved   = 0;
+        IndexSymbols[i].NameOffset = (uint32_t)Names.size();
+
+        Names.insert(Names.end(), Reader->Symbols[i].Name, Reader->Symbols[i].Name + strlen(Reader->Symbols[i].Name) + 1);
+    }
+
+    memcpy(Header.Magic, PdbReaderIndexMagic, PDB_READER_INDEX_MAGIC_SIZE);
+    memcpy(Header.Guid, Reader->Guid, sizeof(Reader->Guid));
+
+    Header.Version        = PDB_READER_INDEX_VERSION;
+    Header.Age            = Reader->Age;
+    Header.ImageSize      = Reader->ImageSize;
+    Header.CountOfSymbols = (uint32_t)Reader->Symbols.size();
+    Header.HashTableSize  = (uint32_t)Reader->NameHashTable.size();
+    Header.NamesSize      = (uint32_t)Names.size();
+
+    IndexFile = fopen(Reader->IndexFileName.c_str(), "wb");
+
+    if (IndexFile == NULL)
+    {
+        return false;
+    }
+
+    Result = fwrite(&Header, sizeof(Header), 1, IndexFile) == 1 &&
+             fwrite(IndexSymbols.data(), sizeof(PDB_READER_INDEX_SYMBOL), IndexSymbols.size(), IndexFile) == IndexSymbols.size() &&
+             fwrite(Reader->NameHashTable.data(), sizeof(uint32_t), Reader->NameHashTable.size(), IndexFile) == Reader->NameHashTable.size() &&
+             fwrite(Names.data(), 1, Names.size(), IndexFile) == Names.size();
+
+    if (fclose(IndexFile) != 0)
+    {
+        Result = false;
+    }
+
+    //
+    // Don't leave an incomplete file
+    //
+    if (!Result)
+    {
+        remove(Reader->IndexFileName.c_str());
+    }
+
+    return Result;
+}
+
+//////////////////////////////////////////////////
+//				Parsing The Symbols             //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Hash a symbol name (case-insensitive FNV-1a)
+ *
+ * @param Name
+ *
+ * @return uint32_t
+ */
+static uint32_t
+PdbReaderHashName(const char * Name)
+{
+    uint32_t Hash = 0x811c9dc5;
+
+    while (*Name)
+    {
+        Hash ^= (uint8_t)tolower((uint8_t)*Name);
+        Hash *= 0x01000193;
+        Name++;
+    }
+
+    return Hash;
+}
+
+/**
+ * @brief Compare two symbol names (case-insensitive)
+ *
+ * @param Name1
+ * @param Name2
+ *
+ * @return bool
+ */
+static bool
+PdbReaderIsNameEqual(const char * Name1, const char * Name2)
+{
+    while (*Name1 && tolower((uint8_t)*Name1) == tolower((uint8_t)*Name2))
+    {
+        Name1++;
+        Name2++;
+    }
+
+    return *Name1 == *Name2;
+}
+
+/**
+ * @brief Read the rva of the sections from the section headers stream
+ *
+ * @param Reader
+ * @param Dbi the DBI stream
+ *
+ * @return bool
+ */
+static bool
+PdbReaderParseSectionHeaders(PPDB_READER Reader, const PDB_READER_STREAM & Dbi)
+{
+    PPDB_READER_DBI_HEADER DbiHeader;
+    PDB_READER_STREAM      SectionHeaders;
+    uint64_t               DbgHeaderOffset;
+    const uint16_t *       DbgHeader;
+    uint32_t               SectionHeadersStreamIndex;
+
+    DbiHeader = (PPDB_READER_DBI_HEADER)Dbi.Data;
+
+    //
+    // The optional debug header is the last substream of the DBI stream
+    //
+    DbgHeaderOffset = sizeof(PDB_READER_DBI_HEADER) + (uint64_t)(uint32_t)DbiHeader->ModInfoSize +
+                      (uint32_t)DbiHeader->SectionContributionSize + (uint32_t)DbiHeader->SectionMapSize +
+                      (uint32_t)DbiHeader->SourceInfoSize + (uint32_t)DbiHeader->TypeServerMapSize +
+                      (uint32_t)DbiHeader->EcSubstreamSize;
+
+    if (DbiHeader->OptionalDbgHeaderSize < (int32_t)((PDB_READER_DBG_HEADER_SECTION_HEADERS + 1) * sizeof(uint16_t)) ||
+        DbgHeaderOffset + DbiHeader->OptionalDbgHeaderSize > Dbi.Size)
+    {
+        return false;
+    }
+
+    DbgHeader                 = (const uint16_t *)(Dbi.Data + DbgHeaderOffset);
+    SectionHeadersStreamIndex = DbgHeader[PDB_READER_DBG_HEADER_SECTION_HEADERS];
+
+    if (SectionHeadersStreamIndex == PDB_READER_INVALID_INDEX ||
+        !PdbReaderReadStream(Reader, SectionHeadersStreamIndex, &SectionHeaders))
+    {
+        return false;
+    }
+
+    for (uint32_t Offset = 0; Offset + PDB_READER_SECTION_HEADER_SIZE <= SectionHeaders.Size; Offset += PDB_READER_SECTION_HEADER_SIZE)
+    {
+        uint32_t VirtualSize;
+        uint32_t VirtualAddress;
+
+        memcpy(&VirtualSize, SectionHeaders.Data + Offset + PDB_READER_SECTION_HEADER_VIRTUAL_SIZE, sizeof(uint32_t));
+        memcpy(&VirtualAddress, SectionHeaders.Data + Offset + PDB_READER_SECTION_HEADER_VIRTUAL_ADDRESS, sizeof(uint32_t));
+        Reader->SectionRvas.push_back(VirtualAddress);
+
+        Reader->ImageSize = std::max(Reader->ImageSize, VirtualAddress + VirtualSize);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Insert a symbol into the name hash table
+ * @details If there are multiple symbols with the same name (e.g., the
+ * public and the global record of a variable), the first one is kept
+ *
+ * @param Reader
+ * @param SymbolIndex
+ *
+ * @return void
+ */
+static void
+PdbReaderInsertName(PPDB_READER Reader, uint32_t SymbolIndex)
+{
+    const char * Name = Reader->Symbols[SymbolIndex].Name;
+    uint32_t     Mask = (uint32_t)Reader->NameHashTable.size() - 1;
+    uint32_t     Slot = PdbReaderHashName(Name) & Mask;
+
+    while (Reader->NameHashTable[Slot] != 0)
+    {
+        if (PdbReaderIsNameEqual(Reader->Symbols[Reader->NameHashTable[Slot] - 1].Name, Name))
+        {
+            return;
+        }
+
+        Slot = (Slot + 1) & Mask;
+    }
+
+    Reader->NameHashTable[Slot] = SymbolIndex + 1;
+}
+
+/**
+ * @brief Parse the public and global symbols and build the indexes
+ * @details Both the public and the global symbols are stored in the
+ * symbol records stream so the records are walked once instead of
+ * reading the hash tables of the public and global streams
+ *
+ * @param Reader
+ *
+ * @return bool
+ */
+static bool
+PdbReaderParseSymbols(PPDB_READER Reader)
+{
+    PDB_READER_STREAM      Dbi;
+    PPDB_READER_DBI_HEADER DbiHeader;
+    uint32_t               Offset;
+    uint32_t               TableSize;
+
+    if (Reader->IsSymbolsParsed)
+    {
+        return Reader->IsSymbolsValid;
+    }
+
+    Reader->IsSymbolsParsed = true;
+
+    //
+    // Use the index file if it's saved for this pdb file before
+    //
+    if (PdbReaderLoadIndex(Reader))
+    {
+        Reader->IsSymbolsValid = true;
+        return true;
+    }
+
+    if (!PdbReaderReadStream(Reader, PDB_READER_DBI_STREAM, &Dbi) || Dbi.Size < sizeof(PDB_READER_DBI_HEADER))
+    {
+        return false;
+    }
+
+    DbiHeader = (PPDB_READER_DBI_HEADER)Dbi.Data;
+
+    if (DbiHeader->SymRecordStreamIndex == PDB_READER_INVALID_INDEX ||
+        !PdbReaderParseSectionHeaders(Reader, Dbi) ||
+        !PdbReaderReadStream(Reader, DbiHeader->SymRecordStreamIndex, &Reader->SymbolRecords))
+    {
+        return false;
+    }
+
+    //
+    // Walk the records
+    //
+    Offset = 0;
+
+    while (Offset + sizeof(PDB_READER_RECORD_HEADER) <= Reader->SymbolRecords.Size)
+    {
+        PPDB_READER_RECORD_HEADER  RecordHeader;
+        PPDB_READER_ADDRESS_RECORD Record;
+        const char *               Name;
+        uint32_t                   RecordEnd;
+        PDB_READER_SYMBOL          Symbol;
+
+        RecordHeader = (PPDB_READER_RECORD_HEADER)(Reader->SymbolRecords.Data + Offset);
+        RecordEnd    = Offset + sizeof(uint16_t) + RecordHeader->RecordLength;
+
+        if (RecordHeader->RecordLength < sizeof(uint16_t) || RecordEnd > Reader->SymbolRecords.Size)
+        {
+            break;
+        }
+
+        if ((RecordHeader->RecordKind == PDB_READER_S_PUB32 ||
+             RecordHeader->RecordKind == PDB_READER_S_GDATA32 ||
+             RecordHeader->RecordKind == PDB_READER_S_LDATA32) &&
+            RecordEnd - Offset > sizeof(PDB_READER_RECORD_HEADER) + sizeof(PDB_READER_ADDRESS_RECORD))
+        {
+            Record = (PPDB_READER_ADDRESS_RECORD)(RecordHeader + 1);
+            Name   = (const char *)(Record + 1);
+
+            //
+            // Ignore the absolute symbols and the unterminated names
+            //
+            if (Record->Segment != 0 && Record->Segment <= Reader->SectionRvas.size() &&
+                memchr(Name, 0, Reader->SymbolRecords.Data + RecordEnd - (const uint8_t *)Name) != NULL)
+            {
+                Symbol.Rva  = Reader->SectionRvas[Record->Segment - 1] + Record->Offset;
+                Symbol.Kind = RecordHeader->RecordKind;
+                Symbol.Name = Name;
+
+                Reader->Symbols.push_back(Symbol);
+            }
+        }
+
+        Offset = RecordEnd;
+    }
+
+    //
+    // Sort the symbols by the rva and build the hash table of the names
+    //
+    std::stable_sort(Reader->Symbols.begin(), Reader->Symbols.end(), [](const PDB_READER_SYMBOL & Symbol1, const PDB_READER_SYMBOL & Symbol2) {
+        return Symbol1.Rva < Symbol2.Rva;
+    });
+
+    TableSize = 16;
+
+    while (TableSize < Reader->Symbols.size() * 2)
+    {
+        TableSize <<= 1;
+    }
+
+    Reader->NameHashTable.assign(TableSize, 0);
+
+    for (uint32_t i = 0; i < Reader->Symbols.size(); i++)
+    {
+        PdbReaderInsertName(Reader, i);
+    }
+
+    Reader->IsSymbolsValid = true;
+
+    //
+    // Save the symbols for the next sessions
+    //
+    PdbReaderSaveIndex(Reader);
+
+    return true;
+}
+
+//////////////////////////////////////////////////
+//				Parsing The Types               //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Read a numeric leaf
+ *
+ * @param Data
+ * @param End end of the record
+ * @param Value
+ *
+ * @return uint32_t size of the leaf, zero if it's not valid
+ */
+static uint32_t
+PdbReaderReadNumeric(const uint8_t * Data, const uint8_t * End, uint64_t * Value)
+{
+    uint16_t Leaf;
+    uint32_t Size;
+
+    if (End - Data < (ptrdiff_t)sizeof(uint16_t))
+    {
+        return 0;
+    }
+
+    memcpy(&Leaf, Data, sizeof(uint16_t));
+
+    if (Leaf < PDB_READER_LF_NUMERIC)
+    {
+        *Value = Leaf;
+        return sizeof(uint16_t);
+    }
+
+    switch (Leaf)
+    {
+    case PDB_READER_LF_CHAR:
+        Size = 1;
+        break;
+    case PDB_READER_LF_SHORT:
+    case PDB_READER_LF_USHORT:
+        Size = 2;
+        break;
+    case PDB_READER_LF_LONG:
+    case PDB_READER_LF_ULONG:
+        Size = 4;
+        break;
+    case PDB_READER_LF_QUADWORD:
+    case PDB_READER_LF_UQUADWORD:
+        Size = 8;
+        break;
+    default:
+        return 0;
+    }
+
+    if (End - Data < (ptrdiff_t)(sizeof(uint16_t) + Size))
+    {
+        return 0;
+    }
+
+    *Value = 0;
+    memcpy(Value, Data + sizeof(uint16_t), Size);
+
+    return sizeof(uint16_t) + Size;
+}
+
+/**
+ * @brief Read a null-terminated name in a record
+ *
+ * @param Data
+ * @param End end of the record
+ *
+ * @return const char * NULL if the name is not terminated
+ */
+static const char *
+PdbReaderReadName(const uint8_t * Data, const uint8_t * End)
+{
+    if (Data >= End || memchr(Data, 0, End - Data) == NULL)
+    {
+        return NULL;
+    }
+
+    return (const char *)Data;
+}
+
+/**
+ * @brief Get the body of a type record
+ *
+ * @param Reader
+ * @param TypeIndex
+ * @param Kind
+ * @param Body
+ * @param End end of the record
+ *
+ * @return bool false if the type is a simple type or not valid
+ */
+static bool
+PdbReaderGetTypeRecord(PPDB_READER Reader, uint32_t TypeIndex, uint16_t * Kind, const uint8_t ** Body, const uint8_t ** End)
+{
+    PPDB_READER_RECORD_HEADER RecordHeader;
+
+    if (TypeIndex < Reader->TypeIndexBegin || TypeIndex - Reader->TypeIndexBegin >= Reader->TypeOffsets.size())
+    {
+        return false;
+    }
+
+    RecordHeader = (PPDB_READER_RECORD_HEADER)(Reader->TypeRecords.Data + Reader->TypeOffsets[TypeIndex - Reader->TypeIndexBegin]);
+
+    *Kind = RecordHeader->RecordKind;
+    *Body = (const uint8_t *)(RecordHeader + 1);
+    *End  = (const uint8_t *)RecordHeader + sizeof(uint16_t) + RecordHeader->RecordLength;
+
+    return true;
+}
+
+/**
+ * @brief Read a record of a structure, class or union
+ *
+ * @param Kind
+ * @param Body
+ * @param End
+ * @param FieldList type index of the field list
+ * @param Name
+ * @param IsForwardReference
+ *
+ * @return bool false if the record is not a valid structure
+ */
+static bool
+PdbReaderReadStructure(uint16_t Kind, const uint8_t * Body, const uint8_t * End, uint32_t * FieldList, const char ** Name, bool * IsForwardReference)
+{
+    uint16_t Property;
+    uint32_t HeaderSize;
+    uint32_t SizeOfLeaf;
+    uint64_t Size;
+
+    if (Kind == PDB_READER_LF_STRUCTURE || Kind == PDB_READER_LF_CLASS)
+    {
+        //
+        // Count, property, field list, derived from and vshape
+        //
+        HeaderSize = sizeof(uint16_t) * 2 + sizeof(uint32_t) * 3;
+    }
+    else if (Kind == PDB_READER_LF_UNION)
+    {
+        //
+        // Count, property and field list
+        //
+        HeaderSize = sizeof(uint16_t) * 2 + sizeof(uint32_t);
+    }
+    else
+    {
+        return false;
+    }
+
+    if (End - Body < (ptrdiff_t)HeaderSize)
+    {
+        return false;
+    }
+
+    memcpy(&Property, Body + sizeof(uint16_t), sizeof(uint16_t));
+    memcpy(FieldList, Body + sizeof(uint16_t) * 2, sizeof(uint32_t));
+
+    SizeOfLeaf = PdbReaderReadNumeric(Body + HeaderSize, End, &Size);
+
+    if (SizeOfLeaf == 0)
+    {
+        return false;
+    }
+
+    *Name               = PdbReaderReadName(Body + HeaderSize + SizeOfLeaf, End);
+    *IsForwardReference = (Property & PDB_READER_PROPERTY_FORWARD_REFERENCE) != 0;
+
+    return *Name != NULL;
+}
+
+/**
+ * @brief Index the type records and the names of the structures
+ *
+ * @param Reader
+ *
+ * @return bool
+ */
+static bool
+PdbReaderParseTypes(PPDB_READER Reader)
+{
+    PPDB_READER_TPI_HEADER TpiHeader;
+    uint32_t               Offset;
+
+    if (Reader->IsTypesParsed)
+    {
+        return Reader->IsTypesValid;
+    }
+
+    Reader->IsTypesParsed = true;
+
+    if (!PdbReaderReadStream(Reader, PDB_READER_TPI_STREAM, &Reader->TypeRecords) ||
+        Reader->TypeRecords.Size < sizeof(PDB_READER_TPI_HEADER))
+    {
+        return false;
+    }
+
+    TpiHeader = (PPDB_READER_TPI_HEADER)Reader->TypeRecords.Data;
+
+    if (TpiHeader->HeaderSize < sizeof(PDB_READER_TPI_HEADER) || TpiHeader->HeaderSize > Reader->TypeRecords.Size)
+    {
+        return false;
+    }
+
+    Reader->TypeIndexBegin = TpiHeader->TypeIndexBegin;
+
+    //
+    // Walk the records, the type index of each record is the index of
+    // the previous record plus one
+    //
+    Offset = TpiHeader->HeaderSize;
+
+    while (Offset + sizeof(PDB_READER_RECORD_HEADER) <= Reader->TypeRecords.Size)
+    {
+        PPDB_READER_RECORD_HEADER RecordHeader;
+        uint32_t                  RecordEnd;
+        uint32_t                  FieldList;
+        const char *              Name;
+        bool                      IsForwardReference;
+
+        RecordHeader = (PPDB_READER_RECORD_HEADER)(Reader->TypeRecords.Data + Offset);
+        RecordEnd    = Offset + sizeof(uint16_t) + RecordHeader->RecordLength;
+
+        if (RecordHeader->RecordLength < sizeof(uint16_t) || RecordEnd > Reader->TypeRecords.Size)
+        {
+            break;
+        }
+
+        if (PdbReaderReadStructure(RecordHeader->RecordKind,
+                                   (const uint8_t *)(RecordHeader + 1),
+                                   Reader->TypeRecords.Data + RecordEnd,
+                                   &FieldList,
+                                   &Name,
+                                   &IsForwardReference) &&
+            !IsForwardReference)
+        {
+            //
+            // The first definition of each name is kept
+            //
+            Reader->Structures.emplace(Name, Reader->TypeIndexBegin + (uint32_t)Reader->TypeOffsets.size());
+        }
+
+        Reader->TypeOffsets.push_back(Offset);
+
+        Offset = RecordEnd;
+    }
+
+    Reader->IsTypesValid = true;
+
+    return true;
+}
+
+/**
+ * @brief Get the definition of a structure from its type index
+ * @details The modifiers (const and volatile) are removed and the forward
+ * references are resolved by the name of the structure
+ *
+ * @param Reader
+ * @param TypeIndex
+ *
+ * @return uint32_t zero if the type is not a structure
+ */
+static uint32_t
+PdbReaderResolveStructure(PPDB_READER Reader, uint32_t TypeIndex)
+{
+    uint16_t       Kind;
+    const uint8_t * Body;
+    const uint8_t * End;
+    uint32_t       FieldList;
+    const char *   Name;
+    bool           IsForwardReference;
+
+    while (PdbReaderGetTypeRecord(Reader, TypeIndex, &Kind, &Body, &End))
+    {
+        if (Kind == PDB_READER_LF_MODIFIER && End - Body >= (ptrdiff_t)sizeof(uint32_t))
+        {
+            memcpy(&TypeIndex, Body, sizeof(uint32_t));
+            continue;
+        }
+
+        if (!PdbReaderReadStructure(Kind, Body, End, &FieldList, &Name, &IsForwardReference))
+        {
+            return 0;
+        }
+
+        if (!IsForwardReference)
+        {
+            return TypeIndex;
+        }
+
+        auto Iterator = Reader->Structures.find(Name);
+
+        return Iterator == Reader->Structures.end() ? 0 : Iterator->second;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Find a member in the field list of a structure
+ *
+ * @param Reader
+ * @param FieldList type index of the field list
+ * @param Name name of the member
+ * @param NameLength
+ * @param Offset offset of the member
+ * @param Type type index of the member
+ *
+ * @return bool
+ */
+static bool
+PdbReaderFindMember(PPDB_READER Reader, uint32_t FieldList, const char * Name, size_t NameLength, uint32_t * Offset, uint32_t * Type)
+{
+    uint16_t       Kind;
+    const uint8_t * Data;
+    const uint8_t * End;
+
+    if (!PdbReaderGetTypeRecord(Reader, FieldList, &Kind, &Data, &End) || Kind != PDB_READER_LF_FIELDLIST)
+    {
+        return false;
+    }
+
+    while (End - Data >= (ptrdiff_t)sizeof(uint16_t))
+    {
+        uint16_t     MemberKind;
+        uint16_t     Attributes;
+        uint32_t     MemberType;
+        uint32_t     SizeOfLeaf;
+        uint64_t     Value;
+        const char * MemberName = NULL;
+
+        //
+        // Skip the padding between the members
+        //
+        if (*Data > 0xf0)
+        {
+            Data += *Data & 0x0f;
+            continue;
+        }
+
+        memcpy(&MemberKind, Data, sizeof(uint16_t));
+        Data += sizeof(uint16_t);
+
+        if (End - Data < (ptrdiff_t)(sizeof(uint16_t) + sizeof(uint32_t)))
+        {
+            return false;
+        }
+
+        memcpy(&Attributes, Data, sizeof(uint16_t));
+
+        switch (MemberKind)
+        {
+        case PDB_READER_LF_MEMBER:
+
+            //
+            // Attributes, type, offset and name
+            //
+            memcpy(&MemberType, Data + sizeof(uint16_t), sizeof(uint32_t));
+            Data += sizeof(uint16_t) + sizeof(uint32_t);
+
+            SizeOfLeaf = PdbReaderReadNumeric(Data, End, &Value);
+            MemberName = PdbReaderReadName(Data + SizeOfLeaf, End);
+
+            if (SizeOfLeaf == 0 || MemberName == NULL)
+            {
+                return false;
+            }
+
+            if (strlen(MemberName) == NameLength && memcmp(MemberName, Name, NameLength) == 0)
+            {
+                *Offset = (uint32_t)Value;
+                *Type   = MemberType;
+                return true;
+            }
+
+            Data = (const uint8_t *)MemberName + strlen(MemberName) + 1;
+            break;
+
+        case PDB_READER_LF_BCLASS:
+
+            //
+            // Attributes, type and offset
+            //
+            SizeOfLeaf = PdbReaderReadNumeric(Data + sizeof(uint16_t) + sizeof(uint32_t), End, &Value);
+
+            if (SizeOfLeaf == 0)
+            {
+                return false;
+            }
+
+            Data += sizeof(uint16_t) + sizeof(uint32_t) + SizeOfLeaf;
+            break;
+
+        case PDB_READER_LF_VBCLASS:
+        case PDB_READER_LF_IVBCLASS:
+
+            //
+            // Attributes, base type, pointer type, pointer offset and
+            // offset in the virtual base table
+            //
+            Data += sizeof(uint16_t) + sizeof(uint32_t) * 2;
+
+            for (int i = 0; i < 2; i++)
+            {
+                SizeOfLeaf = PdbReaderReadNumeric(Data, End, &Value);
+
+                if (SizeOfLeaf == 0)
+                {
+                    return false;
+                }
+
+                Data += SizeOfLeaf;
+            }
+
+            break;
+
+        case PDB_READER_LF_ENUMERATE:
+
+            //
+            // Attributes, value and name
+            //
+            SizeOfLeaf = PdbReaderReadNumeric(Data + sizeof(uint16_t), End, &Value);
+            MemberName = PdbReaderReadName(Data + sizeof(uint16_t) + SizeOfLeaf, End);
+
+            if (SizeOfLeaf == 0 || MemberName == NULL)
+            {
+                return false;
+            }
+
+            Data = (const uint8_t *)MemberName + strlen(MemberName) + 1;
+            break;
+
+        case PDB_READER_LF_STMEMBER:
+        case PDB_READER_LF_METHOD:
+        case PDB_READER_LF_NESTTYPE:
+
+            //
+            // Attributes (or count or padding), type and name
+            //
+            MemberName = PdbReaderReadName(Data + sizeof(uint16_t) + sizeof(uint32_t), End);
+
+            if (MemberName == NULL)
+            {
+                return false;
+            }
+
+            Data = (const uint8_t *)MemberName + strlen(MemberName) + 1;
+            break;
+
+        case PDB_READER_LF_ONEMETHOD:
+
+            //
+            // Attributes, type, offset in the virtual table (only for
+            // the introducing virtual methods) and name
+            //
+            Data += sizeof(uint16_t) + sizeof(uint32_t);
+
+            if (PDB_READER_METHOD_PROPERTY(Attributes) == PDB_READER_METHOD_INTRO_VIRTUAL ||
+                PDB_READER_METHOD_PROPERTY(Attributes) == PDB_READER_METHOD_PURE_INTRO_VIRTUAL)
+            {
+                Data += sizeof(uint32_t);
+            }
+
+            MemberName = PdbReaderReadName(Data, End);
+
+            if (MemberName == NULL)
+            {
+                return false;
+            }
+
+            Data = (const uint8_t *)MemberName + strlen(MemberName) + 1;
+            break;
+
+        case PDB_READER_LF_VFUNCTAB:
+
+            //
+            // Padding and type
+            //
+            Data += sizeof(uint16_t) + sizeof(uint32_t);
+            break;
+
+        case PDB_READER_LF_INDEX:
+
+            //
+            // The rest of the members are in another field list
+            //
+            memcpy(&MemberType, Data + sizeof(uint16_t), sizeof(uint32_t));
+
+            return MemberType != FieldList && PdbReaderFindMember(Reader, MemberType, Name, NameLength, Offset, Type);
+
+        default:
+
+            //
+            // Unknown member, the size of the rest is not known
+            //
+            return false;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////
+//					Interface                   //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Open and map a pdb file
+ * @details Only the MSF directory and the identity of the file are read
+ * here, the symbols are read from the index file or parsed on the first
+ * lookup
+ *
+ * @param PdbFileName
+ *
+ * @return PPDB_READER NULL if the file is not a valid pdb file
+ */
+PPDB_READER
+PdbReaderOpen(const char * PdbFileName)
+{
+    PPDB_READER Reader = new PDB_READER();
+
+    if (!PdbReaderMapFile(&Reader->File, PdbFileName))
+    {
+        delete Reader;
+        return NULL;
+    }
+
+    if (!PdbReaderReadDirectory(Reader))
+    {
+        PdbReaderClose(Reader);
+        return NULL;
+    }
+
+    //
+    // The index file is only used if the pdb file can be identified
+    //
+    if (PdbReaderReadIdentity(Reader))
+    {
+        Reader->IndexFileName = std::string(PdbFileName) + PDB_READER_INDEX_FILE_EXTENSION;
+    }
+
+    return Reader;
+}
+
+/**
+ * @brief Unmap the pdb file and free the indexes
+ *
+ * @param Reader
+ *
+ * @return void
+ */
+void
+PdbReaderClose(PPDB_READER Reader)
+{
+    if (Reader == NULL)
+    {
+        return;
+    }
+
+    PdbReaderUnmapFile(&Reader->Index);
+    PdbReaderUnmapFile(&Reader->File);
+
+    delete Reader;
+}
+
+/**
+ * @brief Find the rva of a symbol by its name (case-insensitive)
+ *
+ * @param Reader
+ * @param Name
+ * @param Rva
+ *
+ * @return bool
+ */
+bool
+PdbReaderFindSymbolByName(PPDB_READER Reader, const char * Name, uint32_t * Rva)
+{
+    uint32_t Mask;
+    uint32_t Slot;
+
+    if (!PdbReaderParseSymbols(Reader))
+    {
+        return false;
+    }
+
+    Mask = (uint32_t)Reader->NameHashTable.size() - 1;
+    Slot = PdbReaderHashName(Name) & Mask;
+
+    while (Reader->NameHashTable[Slot] != 0)
+    {
+        const PDB_READER_SYMBOL * Symbol = &Reader->Symbols[Reader->NameHashTable[Slot] - 1];
+
+        if (PdbReaderIsNameEqual(Symbol->Name, Name))
+        {
+            *Rva = Symbol->Rva;
+            return true;
+        }
+
+        Slot = (Slot + 1) & Mask;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Find the symbol that contains an rva
+ * @details The result is the symbol with the highest rva that is not
+ * above the target rva
+ *
+ * @param Reader
+ * @param Rva
+ * @param Displacement distance of the rva from the start of the symbol
+ *
+ * @return const PDB_READER_SYMBOL * NULL if there is no symbol before the rva
+ */
+const PDB_READER_SYMBOL *
+PdbReaderFindSymbolByRva(PPDB_READER Reader, uint32_t Rva, uint32_t * Displacement)
+{
+    std::vector<PDB_READER_SYMBOL>::iterator Iterator;
+
+    if (!PdbReaderParseSymbols(Reader))
+    {
+        return NULL;
+    }
+
+    Iterator = std::upper_bound(Reader->Symbols.begin(), Reader->Symbols.end(), Rva, [](uint32_t TargetRva, const PDB_READER_SYMBOL & Symbol) {
+        return TargetRva < Symbol.Rva;
+    });
+
+    if (Iterator == Reader->Symbols.begin())
+    {
+        return NULL;
+    }
+
+    //
+    // Move to the first symbol of this rva
+    //
+    Iterator--;
+
+    while (Iterator != Reader->Symbols.begin() && (Iterator - 1)->Rva == Iterator->Rva)
+    {
+        Iterator--;
+    }
+
+    *Displacement = Rva - Iterator->Rva;
+
+    return &*Iterator;
+}
+
+/**
+ * @brief Get the size of the image (end of its last section)
+ *
+ * @param Reader
+ *
+ * @return uint32_t zero if the sections are not available
+ */
+uint32_t
+PdbReaderGetImageSize(PPDB_READER Reader)
+{
+    if (!PdbReaderParseSymbols(Reader))
+    {
+        return 0;
+    }
+
+    return Reader->ImageSize;
+}
+
+/**
+ * @brief Find the offset of a field of a structure
+ * @details The members of the nested structures are separated by dots
+ * (e.g., "Pcb.DirectoryTableBase"), and the offset is from the start
+ * of the outermost structure
+ *
+ * @param Reader
+ * @param TypeName name of the structure (case-sensitive)
+ * @param FieldPath
+ * @param Offset
+ *
+ * @return bool
+ */
+bool
+PdbReaderFindField(PPDB_READER Reader, const char * TypeName, const char * FieldPath, uint32_t * Offset)
+{
+    uint32_t       TypeIndex;
+    uint32_t       MemberOffset;
+    uint16_t       Kind;
+    const uint8_t * Body;
+    const uint8_t * End;
+    uint32_t       FieldList;
+    const char *   Name;
+    bool           IsForwardReference;
+    const char *   Dot;
+
+    if (!PdbReaderParseTypes(Reader))
+    {
+        return false;
+    }
+
+    auto Iterator = Reader->Structures.find(TypeName);
+
+    if (Iterator == Reader->Structures.end())
+    {
+        return false;
+    }
+
+    TypeIndex = Iterator->second;
+    *Offset   = 0;
+
+    while (true)
+    {
+        if (!PdbReaderGetTypeRecord(Reader, TypeIndex, &Kind, &Body, &End) ||
+            !PdbReaderReadStructure(Kind, Body, End, &FieldList, &Name, &IsForwardReference))
+        {
+            return false;
+        }
+
+        Dot = strchr(FieldPath, '.');
+
+        if (!PdbReaderFindMember(Reader, FieldList, FieldPath, Dot == NULL ? strlen(FieldPath) : Dot - FieldPath, &MemberOffset, &TypeIndex))
+        {
+            return false;
+        }
+
+        *Offset += MemberOffset;
+
+        if (Dot == NULL)
+        {
+            return true;
+        }
+
+        //
+        // Move to the nested structure
+        //
+        TypeIndex = PdbReaderResolveStructure(Reader, TypeIndex);
+        FieldPath = Dot + 1;
+
+        if (TypeIndex == 0)
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Enumerate the symbols that match a mask (sorted by the rva)
+ *
+ * @param Reader
+ * @param Mask wildcard mask ('*' and '?'), NULL means all symbols
+ * @param Callback
+ * @param Context
+ *
+ * @return uint32_t count of the matched symbols
+ */
+uint32_t
+PdbReaderEnumerateSymbols(PPDB_READER Reader, const char * Mask, PDB_READER_ENUMERATE_CALLBACK Callback, void * Context)
+{
+    uint32_t CountOfMatches = 0;
+
+    if (!PdbReaderParseSymbols(Reader))
+    {
+        return 0;
+    }
+
+    for (const PDB_READER_SYMBOL & Symbol : Reader->Symbols)
+    {
+        if (Mask == NULL || PdbReaderMatchMask(Mask, Symbol.Name))
+        {
+            Callback(&Symbol, Context);
+            CountOfMatches++;
+        }
+    }
+
+    return CountOfMatches;
+}
+
+/**
+ * @brief Check whether a name matches a wildcard mask (case-insensitive)
+ *
+ * @param Mask
+ * @param Name
+ *
+ * @return bool
+ */
+bool
+PdbReaderMatchMask(const char * Mask, const char * Name)
+{
+    const char * StarMask = NULL;
+    const char * StarName = NULL;
+
+    while (*Name)
+    {
+        if (*Mask == '*')
+        {
+            //
+            // Remember the position to backtrack
+            //
+            StarMask = ++Mask;
+            StarName = Name;
+        }
+        else if (*Mask == '?' || tolower((uint8_t)*Mask) == tolower((uint8_t)*Name))
+        {
+            Mask++;
+            Name++;
+        }
+        else if (StarMask != NULL)
+        {
+            Mask = StarMask;
+            Name = ++StarName;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*Mask == '*')
+    {
+        Mask++;
+    }
+
+    return *Mask == '\0';
+}
@@ -0,0 +1,178 @@
+/**
+ * @file pdb-reader.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of the native reader of pdb (MSF) files
+ * @details This reader doesn't depend on DbgHelp or Windows headers
+ * so it can be built and used on other platforms too
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////
+//					Definitions                 //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Kinds of the CodeView symbol records that have an address
+ *
+ */
+#define PDB_READER_S_LDATA32 0x110c
+#define PDB_READER_S_GDATA32 0x110d
+#define PDB_READER_S_PUB32   0x110e
+
+/**
+ * @brief Kinds of the CodeView type records of the structures
+ *
+ */
+#define PDB_READER_LF_MODIFIER  0x1001
+#define PDB_READER_LF_CLASS     0x1504
+#define PDB_READER_LF_STRUCTURE 0x1505
+#define PDB_READER_LF_UNION     0x1506
+
+/**
+ * @brief Extension of the index file that is saved next to the pdb file
+ * @details The index keeps the parsed symbols, so the next sessions map
+ * it instead of parsing the pdb file again
+ *
+ */
+#define PDB_READER_INDEX_FILE_EXTENSION ".index"
+
+//////////////////////////////////////////////////
+//					Structures                  //
+//////////////////////////////////////////////////
+
+/**
+ * @brief A public or global symbol that is read from the pdb file
+ *
+ */
+typedef struct _PDB_READER_SYMBOL
+{
+    uint32_t     Rva;  // Relative virtual address of the symbol
+    uint16_t     Kind; // Kind of the CodeView record (S_PUB32, S_GDATA32, S_LDATA32)
+    const char * Name; // Null-terminated name (points to the symbol records stream)
+
+} PDB_READER_SYMBOL, *PPDB_READER_SYMBOL;
+
+/**
+ * @brief A memory-mapped file
+ *
+ */
+typedef struct _PDB_READER_MAPPING
+{
+    const uint8_t * Data;
+    uint64_t        Size;
+    void *          FileHandle;
+    void *          MappingHandle;
+
+} PDB_READER_MAPPING, *PPDB_READER_MAPPING;
+
+/**
+ * @brief Contents of a stream of the pdb file
+ * @details If the blocks of the stream are contiguous in the file, the
+ * stream points to the mapped file, otherwise it's copied to a buffer
+ *
+ */
+typedef struct _PDB_READER_STREAM
+{
+    const uint8_t *      Data;
+    uint32_t             Size;
+    std::vector<uint8_t> Buffer;
+
+} PDB_READER_STREAM, *PPDB_READER_STREAM;
+
+/**
+ * @brief State of an opened pdb file
+ *
+ */
+typedef struct _PDB_READER
+{
+    //
+    // The mapped pdb file
+    //
+    PDB_READER_MAPPING File;
+
+    //
+    // The MSF directory
+    //
+    uint32_t                           BlockSize;
+    std::vector<uint32_t>              StreamSizes;
+    std::vector<std::vector<uint32_t>> StreamBlocks;
+
+    //
+    // Identity of the pdb file (from the PDB stream)
+    //
+    uint8_t  Guid[16];
+    uint32_t Age;
+
+    //
+    // The index file of the symbols
+    //
+    std::string        IndexFileName;
+    PDB_READER_MAPPING Index;
+    bool               IsIndexLoaded; // Symbols are read from the index file
+
+    //
+    // Symbols (parsed on the first lookup)
+    //
+    bool                           IsSymbolsParsed;
+    bool                           IsSymbolsValid;
+    PDB_READER_STREAM              SymbolRecords;
+    std::vector<uint32_t>          SectionRvas;
+    uint32_t                       ImageSize;      // End of the last section
+    std::vector<PDB_READER_SYMBOL> Symbols;        // Sorted by the rva
+    std::vector<uint32_t>          NameHashTable;  // Index of the symbol plus one, zero is empty
+
+    //
+    // Types (parsed on the first lookup of a structure)
+    //
+    bool                                      IsTypesParsed;
+    bool                                      IsTypesValid;
+    PDB_READER_STREAM                         TypeRecords;    // The TPI stream
+    uint32_t                                  TypeIndexBegin; // Index of the first type record
+    std::vector<uint32_t>                     TypeOffsets;    // Offset of the record of each type in the TPI stream
+    std::unordered_map<std::string, uint32_t> Structures;     // Name of the defined structures to their type index
+
+} PDB_READER, *PPDB_READER;
+
+/**
+ * @brief Callback that is called for each of the enumerated symbols
+ *
+ */
+typedef void (*PDB_READER_ENUMERATE_CALLBACK)(const PDB_READER_SYMBOL * Symbol, void * Context);
+
+//////////////////////////////////////////////////
+//					Functions                   //
+//////////////////////////////////////////////////
+
+PPDB_READER
+PdbReaderOpen(const char * PdbFileName);
+
+void
+PdbReaderClose(PPDB_READER Reader);
+
+bool
+PdbReaderFindSymbolByName(PPDB_READER Reader, const char * Name, uint32_t * Rva);
+
+const PDB_READER_SYMBOL *
+PdbReaderFindSymbolByRva(PPDB_READER Reader, uint32_t Rva, uint32_t * Displacement);
+
+uint32_t
+PdbReaderGetImageSize(PPDB_READER Reader);
+
+bool
+PdbReaderFindField(PPDB_READER Reader, const char * TypeName, const char * FieldPath, uint32_t * Offset);
+
+uint32_t
+PdbReaderEnumerateSymbols(PPDB_READER Reader, const char * Mask, PDB_READER_ENUMERATE_CALLBACK Callback, void * Context);
+
+bool
+PdbReaderMatchMask(const char * Mask, const char * Name);
@@ -0,0 +1,152 @@
+/**
+ * @file symbol-lookup.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Converting the addresses to the symbols of the loaded modules
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+//
+// Global Variables
+//
+extern std::vector<PSYMBOL_LOADED_MODULE_DETAILS> g_LoadedModules;
+extern SYMBOL_ADDRESS_CACHE_ENTRY                 g_SymbolAddressCache[SymbolAddressCacheEntries];
+
+/**
+ * @brief Get the entry of the cache of the recently converted addresses
+ * that an address is kept in
+ * @details The upper bits of the multiplicative hash select the entry (the
+ * nearby addresses of the same function get different entries)
+ *
+ * @param Address
+ *
+ * @return PSYMBOL_ADDRESS_CACHE_ENTRY
+ */
+PSYMBOL_ADDRESS_CACHE_ENTRY
+SymGetAddressCacheEntry(UINT64 Address)
+{
+    return &g_SymbolAddressCache[((Address * 0x9E3779B97F4A7C15) >> 32) % SymbolAddressCacheEntries];
+}
+
+/**
+ * @brief Invalidate the recently converted addresses
+ *
+ * @return VOID
+ */
+VOID
+SymInvalidateAddressCache()
+{
+    RtlZeroMemory(g_SymbolAddressCache, sizeof(g_SymbolAddressCache));
+}
+
+/**
+ * @brief Find the symbol that contains an address
+ * @details The module is the loaded module with the highest base address
+ * below the address, then its symbols are searched by a binary search,
+ * the results (including not found addresses) are kept in a small cache
+ * as the same addresses are usually converted repeatedly, each address
+ * has a single entry (selected by its hash) so checking the cache costs
+ * the same for the hits and the misses
+ *
+ * @param Address
+ * @param Module
+ * @param Name
+ * @param Displacement
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SymLookupAddress(UINT64 Address, PSYMBOL_LOADED_MODULE_DETAILS * Module, const char ** Name, PUINT64 Displacement)
+{
+    PSYMBOL_LOADED_MODULE_DETAILS ModuleDetails = NULL;
+    PSYMBOL_ADDRESS_CACHE_ENTRY   CacheEntry    = NULL;
+    const char *                  SymbolName    = NULL;
+    UINT64                        SymbolOffset  = 0;
+
+    //
+    // Check the recently converted addresses
+    //
+    CacheEntry = SymGetAddressCacheEntry(Address);
+
+    if (CacheEntry->IsValid && CacheEntry->Address == Address)
+    {
+        *Module       = CacheEntry->Module;
+        *Name         = CacheEntry->Name;
+        *Displacement = CacheEntry->Displacement;
+
+        return CacheEntry->Module != NULL;
+    }
+
+    //
+    // Find the module
+    //
+    for (auto item : g_LoadedModules)
+    {
+        if (item->BaseAddress <= Address &&
+            (ModuleDetails == NULL || item->BaseAddress > ModuleDetails->BaseAddress))
+        {
+            ModuleDetails = item;
+        }
+    }
+
+    if (ModuleDetails != NULL && ModuleDetails->PdbReader != NULL)
+    {
+        uint32_t                  SymbolDisplacement = 0;
+        const PDB_READER_SYMBOL * Symbol             = NULL;
+
+        if (ModuleDetails->ImageSize == 0)
+        {
+            ModuleDetails->ImageSize = PdbReaderGetImageSize(ModuleDetails->PdbReader);
+        }
+
+        if (Address - ModuleDetails->BaseAddress < ModuleDetails->ImageSize)
+        {
+            Symbol = PdbReaderFindSymbolByRva(ModuleDetails->PdbReader, (uint32_t)(Address - ModuleDetails->BaseAddress), &SymbolDisplacement);
+        }
+
+        if (Symbol != NULL)
+        {
+            SymbolName   = Symbol->Name;
+            SymbolOffset = SymbolDisplacement;
+        }
+    }
+    else if (ModuleDetails != NULL && Address - ModuleDetails->BaseAddress < ModuleDetails->ImageSize)
+    {
+        auto Iterator = upper_bound(ModuleDetails->AddressRanges->begin(), ModuleDetails->AddressRanges->end(), Address, [](UINT64 TargetAddress, const SYMBOL_ADDRESS_RANGE & Range) {
+            return TargetAddress < Range.Address;
+        });
+
+        if (Iterator != ModuleDetails->AddressRanges->begin())
+        {
+            Iterator--;
+
+            SymbolName   = Iterator->Name.c_str();
+            SymbolOffset = Address - Iterator->Address;
+        }
+    }
+
+    if (SymbolName == NULL)
+    {
+        ModuleDetails = NULL;
+    }
+
+    //
+    // Save the result in the cache
+    //
+    CacheEntry->Address      = Address;
+    CacheEntry->IsValid      = TRUE;
+    CacheEntry->Module       = ModuleDetails;
+    CacheEntry->Name         = SymbolName;
+    CacheEntry->Displacement = SymbolOffset;
+
+    *Module       = ModuleDetails;
+    *Name         = SymbolName;
+    *Displacement = SymbolOffset;
+
+    return ModuleDetails != NULL;
+}
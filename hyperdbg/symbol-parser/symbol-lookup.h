@@ -0,0 +1,81 @@
+/**
+ * @file symbol-lookup.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Headers of converting the addresses to the symbols of the
+ * loaded modules
+ * @details
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+//////////////////////////////////////////////////
+//					Configs                     //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the recently converted addresses that are cached
+ *
+ */
+#define SymbolAddressCacheEntries 256
+
+//////////////////////////////////////////////////
+//					Structures                  //
+//////////////////////////////////////////////////
+
+/**
+ * @brief Start address of a symbol of the modules that are loaded by
+ * DbgHelp (the symbols of the native reader are sorted by the reader)
+ *
+ */
+typedef struct _SYMBOL_ADDRESS_RANGE
+{
+    UINT64 Address;
+    string Name;
+
+} SYMBOL_ADDRESS_RANGE, *PSYMBOL_ADDRESS_RANGE;
+
+/**
+ * @brief Hold detail about the loaded modules
+ *
+ */
+typedef struct _SYMBOL_LOADED_MODULE_DETAILS
+{
+    UINT64                         BaseAddress;
+    DWORD64                        ModuleBase;
+    char *                         ModuleName[_MAX_FNAME];
+    PPDB_READER                    PdbReader;     // NULL if the symbols are loaded by DbgHelp
+    UINT64                         ImageSize;     // Size of the module (zero if it's not computed yet)
+    vector<SYMBOL_ADDRESS_RANGE> * AddressRanges; // Symbols of DbgHelp sorted by the address
+
+} SYMBOL_LOADED_MODULE_DETAILS, *PSYMBOL_LOADED_MODULE_DETAILS;
+
+/**
+ * @brief A recently converted address
+ *
+ */
+typedef struct _SYMBOL_ADDRESS_CACHE_ENTRY
+{
+    UINT64                        Address;
+    BOOLEAN                       IsValid;
+    PSYMBOL_LOADED_MODULE_DETAILS Module; // NULL if the address is not in any module
+    const char *                  Name;
+    UINT64                        Displacement;
+
+} SYMBOL_ADDRESS_CACHE_ENTRY, *PSYMBOL_ADDRESS_CACHE_ENTRY;
+
+//////////////////////////////////////////////////
+//					Functions                   //
+//////////////////////////////////////////////////
+
+PSYMBOL_ADDRESS_CACHE_ENTRY
+SymGetAddressCacheEntry(UINT64 Address);
+
+BOOLEAN
+SymLookupAddress(UINT64 Address, PSYMBOL_LOADED_MODULE_DETAILS * Module, const char ** Name, PUINT64 Displacement);
+
+VOID
+SymInvalidateAddressCache();
@@ -11,6 +11,7 @@
  *
  */
 #include "pch.h"
+#include "globals.h"
 
 //
 // Global Variables
@@ -183,15 +184,6 @@ SymLoadFileSymbol(UINT64 BaseAddress, const char * PdbFileName)
         return -1;
     }
 
-    //
-    // Determine the base address and the file size
-    //
-    if (!SymGetFileParams(PdbFileName, FileSize))
-    {
-        printf("err, cannot obtain file parameters (internal error)\n");
-        return -1;
-    }
-
     //
     // Determine the extension of the file
     //
@@ -262,24 +254,69 @@ SymLoadFileSymbol(UINT64 BaseAddress, const char * PdbFileName)
 
     RtlZeroMemory(ModuleDetails, sizeof(SYMBOL_LOADED_MODULE_DETAILS));
 
-    ModuleDetails->ModuleBase = SymLoadModule64(
-        GetCurrentProcess(), // Process handle of the current process
-        NULL,                // Handle to the module's image file (not needed)
-        PdbFileName,         // Path/name of the file
-        NULL,                // User-defined short name of the module (it can be NULL)
-        BaseAddress,         // Base address of the module (cannot be NULL if .PDB file is
-                             // used, otherwise it can be NULL)
-        FileSize             // Size of the file (cannot be NULL if .PDB file is used,
-                             // otherwise it can be NULL)
-    );
+#if UseNativePdbReader
 
-    if (ModuleDetails->ModuleBase == NULL)
+    //
+    // Map the file using the native reader, the symbols are parsed
+    // on the first lookup
+    //
+    ModuleDetails->PdbReader = PdbReaderOpen(PdbFileName);
+
+#endif // UseNativePdbReader
+
+    if (ModuleDetails->PdbReader != NULL)
     {
-        printf("err, loading symbols failed (%u)\n",
-               GetLastError());
+        //
+        // The module is not loaded by DbgHelp so its base address
+        // is used as the module base
+        //
+        ModuleDetails->ModuleBase = BaseAddress;
+    }
+    else
+    {
+        //
+        // Determine the base address and the file size (only needed
+        // by DbgHelp)
+        //
+        if (!SymGetFileParams(PdbFileName, FileSize))
+        {
+            printf("err, cannot obtain file parameters (internal error)\n");
 
-        free(ModuleDetails);
-        return -1;
+            free(ModuleDetails);
+            return -1;
+        }
+
+        ModuleDetails->ModuleBase = SymLoadModule64(
+            GetCurrentProcess(), // Process handle of the current process
+            NULL,                // Handle to the module's image file (not needed)
+            PdbFileName,         // Path/name of the file
+            NULL,                // User-defined short name of the module (it can be NULL)
+            BaseAddress,         // Base address of the module (cannot be NULL if .PDB file is
+                                 // used, otherwise it can be NULL)
+            FileSize             // Size of the file (cannot be NULL if .PDB file is used,
+                                 // otherwise it can be NULL)
+        );
+
+        if (ModuleDetails->ModuleBase == NULL)
+        {
+            printf("err, loading symbols failed (%u)\n",
+                   GetLastError());
+
+            free(ModuleDetails);
+            return -1;
+        }
+
+        //
+        // Build the sorted list of the symbols once, so the addresses are
+        // converted to the symbols without querying DbgHelp
+        //
+        ModuleDetails->AddressRanges = new vector<SYMBOL_ADDRESS_RANGE>;
+
+        SymEnumSymbols(GetCurrentProcess(), ModuleDetails->ModuleBase, "*", SymBuildAddressRangesCallback, ModuleDetails);
+
+        sort(ModuleDetails->AddressRanges->begin(), ModuleDetails->AddressRanges->end(), [](const SYMBOL_ADDRESS_RANGE & Range1, const SYMBOL_ADDRESS_RANGE & Range2) {
+            return Range1.Address < Range2.Address;
+        });
     }
 
 #ifndef DoNotShowDetailedResult
@@ -309,6 +346,11 @@ SymLoadFileSymbol(UINT64 BaseAddress, const char * PdbFileName)
     //
     g_LoadedModules.push_back(ModuleDetails);
 
+    //
+    // The addresses of the new module might be cached as unknown
+    //
+    SymInvalidateAddressCache();
+
     if (!g_IsLoadedModulesInitialized)
     {
         //
@@ -332,15 +374,27 @@ SymUnloadAllSymbols()
 
     for (auto item : g_LoadedModules)
     {
-        //
-        // Unload symbols for the module
-        //
-        Ret = SymUnloadModule64(GetCurrentProcess(), item->ModuleBase);
-
-        if (!Ret)
+        if (item->PdbReader != NULL)
         {
-            printf("err, unload symbol failed (%u)\n",
-                   GetLastError());
+            //
+            // Unmap the file of the native reader
+            //
+            PdbReaderClose(item->PdbReader);
+        }
+        else
+        {
+            //
+            // Unload symbols for the module
+            //
+            Ret = SymUnloadModule64(GetCurrentProcess(), item->ModuleBase);
+
+            if (!Ret)
+            {
+                printf("err, unload symbol failed (%u)\n",
+                       GetLastError());
+            }
+
+            delete item->AddressRanges;
         }
 
         free(item);
@@ -350,6 +404,7 @@ SymUnloadAllSymbols()
     // Clear the list
     //
     g_LoadedModules.clear();
+    SymInvalidateAddressCache();
 
     //
     // Uninitialize DbgHelp
@@ -408,7 +463,14 @@ SymConvertNameToAddress(const char * FunctionOrVariableName, PBOOLEAN WasFound)
         memmove((char *)FunctionOrVariableName, FunctionOrVariableName + 3, strlen(FunctionOrVariableName));
     }
 
-    if (SymFromName(GetCurrentProcess(), FunctionOrVariableName, Symbol))
+    if (SymConvertNameToAddressUsingPdbReader(FunctionOrVariableName, &Address))
+    {
+        //
+        // Found in the modules of the native reader
+        //
+        Found = TRUE;
+    }
+    else if (SymFromName(GetCurrentProcess(), FunctionOrVariableName, Symbol))
     {
         //
         // SymFromName returned success
@@ -445,8 +507,10 @@ SymConvertNameToAddress(const char * FunctionOrVariableName, PBOOLEAN WasFound)
 UINT32
 SymSearchSymbolForMask(const char * SearchMask)
 {
-    BOOL    Ret        = FALSE;
-    DWORD64 ModuleBase = NULL;
+    BOOL                          Ret           = FALSE;
+    DWORD64                       ModuleBase    = NULL;
+    PSYMBOL_LOADED_MODULE_DETAILS ModuleDetails = NULL;
+    const char *                  Mask          = NULL;
 
     //
     // Find module base
@@ -464,6 +528,24 @@ SymSearchSymbolForMask(const char * SearchMask)
         return -1;
     }
 
+    //
+    // Check whether the module is loaded by the native reader
+    //
+    ModuleDetails = SymGetPdbReaderModule(ModuleBase);
+
+    if (ModuleDetails != NULL)
+    {
+        //
+        // The mask of the native reader doesn't contain the module name
+        //
+        Mask = strchr(SearchMask, '!');
+        Mask = Mask == NULL ? SearchMask : Mask + 1;
+
+        PdbReaderEnumerateSymbols(ModuleDetails->PdbReader, Mask, SymPdbReaderEnumerateCallback, ModuleDetails);
+
+        return 0;
+    }
+
     Ret = SymEnumSymbols(
         GetCurrentProcess(),    // Process handle of the current process
         ModuleBase,             // Base address of the module
@@ -830,6 +912,326 @@ SymShowSymbolDetails(SYMBOL_INFO & SymInfo)
 #endif // !DoNotShowDetailedResult
 }
 
+/**
+ * @brief Get the details of a module that is loaded by the native reader
+ *
+ * @param ModuleBase
+ *
+ * @return PSYMBOL_LOADED_MODULE_DETAILS NULL if the module is not found
+ * or it's loaded by DbgHelp
+ */
+PSYMBOL_LOADED_MODULE_DETAILS
+SymGetPdbReaderModule(DWORD64 ModuleBase)
+{
+    for (auto item : g_LoadedModules)
+    {
+        if (item->ModuleBase == ModuleBase && item->PdbReader != NULL)
+        {
+            return item;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Convert function name to address using the native reader
+ * @details If the name doesn't contain the module name, all of the
+ * modules of the native reader are searched
+ *
+ * @param FunctionOrVariableName
+ * @param Address
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SymConvertNameToAddressUsingPdbReader(const char * FunctionOrVariableName, PUINT64 Address)
+{
+    PSYMBOL_LOADED_MODULE_DETAILS ModuleDetails = NULL;
+    const char *                  Name          = NULL;
+    uint32_t                      Rva           = 0;
+
+    Name = strchr(FunctionOrVariableName, '!');
+
+    if (Name != NULL)
+    {
+        //
+        // Find the module from its name
+        //
+        ModuleDetails = SymGetPdbReaderModule(SymGetModuleBaseFromSearchMask(FunctionOrVariableName, FALSE));
+
+        if (ModuleDetails == NULL ||
+            !PdbReaderFindSymbolByName(ModuleDetails->PdbReader, Name + 1, &Rva))
+        {
+            return FALSE;
+        }
+
+        *Address = ModuleDetails->BaseAddress + Rva;
+        return TRUE;
+    }
+
+    for (auto item : g_LoadedModules)
+    {
+        if (item->PdbReader != NULL &&
+            PdbReaderFindSymbolByName(item->PdbReader, FunctionOrVariableName, &Rva))
+        {
+            *Address = item->BaseAddress + Rva;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Callback for showing the symbols of the native reader
+ *
+ * @param Symbol
+ * @param UserContext details of the module
+ *
+ * @return VOID
+ */
+VOID
+SymPdbReaderEnumerateCallback(const PDB_READER_SYMBOL * Symbol, PVOID UserContext)
+{
+    PSYMBOL_LOADED_MODULE_DETAILS ModuleDetails = (PSYMBOL_LOADED_MODULE_DETAILS)UserContext;
+
+    //
+    // Module!Name Address
+    //
+    printf("%s  %s!%s\n",
+           SymSeparateTo64BitValue(ModuleDetails->BaseAddress + Symbol->Rva).c_str(),
+           (const char *)ModuleDetails->ModuleName,
+           Symbol->Name);
+}
+
+/**
+ * @brief Callback for building the sorted list of the symbols of
+ * the modules that are loaded by DbgHelp
+ *
+ * @param SymInfo
+ * @param SymbolSize
+ * @param UserContext details of the module
+ *
+ * @return BOOL
+ */
+BOOL CALLBACK
+SymBuildAddressRangesCallback(SYMBOL_INFO * SymInfo, ULONG SymbolSize, PVOID UserContext)
+{
+    PSYMBOL_LOADED_MODULE_DETAILS ModuleDetails = (PSYMBOL_LOADED_MODULE_DETAILS)UserContext;
+
+    if (SymInfo != 0 && SymInfo->Address >= ModuleDetails->BaseAddress)
+    {
+        ModuleDetails->AddressRanges->push_back({SymInfo->Address, SymInfo->Name});
+
+        //
+        // The module ends after its last symbol
+        //
+        ModuleDetails->ImageSize = max(ModuleDetails->ImageSize,
+                                       SymInfo->Address + max(SymbolSize, (ULONG)1) - ModuleDetails->BaseAddress);
+    }
+
+    //
+    // Continue enumeration
+    //
+    return TRUE;
+}
+
+/**
+ * @brief Convert an address to the object name (module!name) and the
+ * displacement of the address from the start of the object
+ *
+ * @param Address
+ * @param ObjectName
+ * @param ObjectNameSize
+ * @param Displacement
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SymConvertAddressToObjectName(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement)
+{
+    PSYMBOL_LOADED_MODULE_DETAILS ModuleDetails = NULL;
+    const char *                  Name          = NULL;
+
+    if (!SymLookupAddress(Address, &ModuleDetails, &Name, Displacement))
+    {
+        return FALSE;
+    }
+
+    sprintf_s(ObjectName, ObjectNameSize, "%s!%s", (const char *)ModuleDetails->ModuleName, Name);
+
+    return TRUE;
+}
+
+/**
+ * @brief Find the offset of a field of a structure using DbgHelp
+ *
+ * @param ModuleBase
+ * @param TypeName
+ * @param FieldPath
+ * @param FieldOffset
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SymGetFieldOffsetUsingDbgHelp(DWORD64 ModuleBase, const char * TypeName, const char * FieldPath, PUINT32 FieldOffset)
+{
+    ULONG64      Buffer[(sizeof(SYMBOL_INFO) + MAX_SYM_NAME * sizeof(CHAR) + sizeof(ULONG64) - 1) / sizeof(ULONG64)];
+    PSYMBOL_INFO Symbol    = (PSYMBOL_INFO)Buffer;
+    ULONG        TypeIndex = 0;
+    const char * Dot       = NULL;
+    size_t       Length    = 0;
+
+    Symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+    Symbol->MaxNameLen   = MAX_SYM_NAME;
+
+    if (!SymGetTypeFromName(GetCurrentProcess(), ModuleBase, TypeName, Symbol))
+    {
+        return FALSE;
+    }
+
+    TypeIndex    = Symbol->TypeIndex;
+    *FieldOffset = 0;
+
+    while (TRUE)
+    {
+        DWORD                    ChildrenCount = 0;
+        vector<BYTE>             ChildrenBuffer;
+        TI_FINDCHILDREN_PARAMS * Children;
+        BOOLEAN                  IsFound = FALSE;
+
+        Dot    = strchr(FieldPath, '.');
+        Length = Dot == NULL ? strlen(FieldPath) : Dot - FieldPath;
+
+        if (!SymGetTypeInfo(GetCurrentProcess(), ModuleBase, TypeIndex, TI_GET_CHILDRENCOUNT, &ChildrenCount) ||
+            ChildrenCount == 0)
+        {
+            return FALSE;
+        }
+
+        ChildrenBuffer.resize(sizeof(TI_FINDCHILDREN_PARAMS) + ChildrenCount * sizeof(ULONG));
+
+        Children        = (TI_FINDCHILDREN_PARAMS *)ChildrenBuffer.data();
+        Children->Count = ChildrenCount;
+        Children->Start = 0;
+
+        if (!SymGetTypeInfo(GetCurrentProcess(), ModuleBase, TypeIndex, TI_FINDCHILDREN, Children))
+        {
+            return FALSE;
+        }
+
+        for (DWORD i = 0; i < ChildrenCount && !IsFound; i++)
+        {
+            WCHAR * ChildName = NULL;
+            DWORD   Offset    = 0;
+
+            if (!SymGetTypeInfo(GetCurrentProcess(), ModuleBase, Children->ChildId[i], TI_GET_SYMNAME, &ChildName))
+            {
+                continue;
+            }
+
+            //
+            // Compare the wide name of the member with the field
+            //
+            IsFound = wcslen(ChildName) == Length;
+
+            for (size_t j = 0; j < Length && IsFound; j++)
+            {
+                IsFound = ChildName[j] == (WCHAR)FieldPath[j];
+            }
+
+            LocalFree(ChildName);
+
+            if (IsFound)
+            {
+                if (!SymGetTypeInfo(GetCurrentProcess(), ModuleBase, Children->ChildId[i], TI_GET_OFFSET, &Offset) ||
+                    !SymGetTypeInfo(GetCurrentProcess(), ModuleBase, Children->ChildId[i], TI_GET_TYPEID, &TypeIndex))
+                {
+                    return FALSE;
+                }
+
+                *FieldOffset += Offset;
+            }
+        }
+
+        if (!IsFound)
+        {
+            return FALSE;
+        }
+
+        if (Dot == NULL)
+        {
+            return TRUE;
+        }
+
+        //
+        // Move to the nested structure
+        //
+        FieldPath = Dot + 1;
+    }
+}
+
+/**
+ * @brief Find the offset of a field of a structure
+ * @details used by the script engine to convert the field accesses
+ * to constant offsets, if the type name doesn't contain the module
+ * name, all of the modules are searched
+ *
+ * @param TypeName name of the structure (e.g., nt!_EPROCESS or _EPROCESS)
+ * @param FieldPath name of the field, the fields of the nested
+ * structures are separated by dots (e.g., Pcb.DirectoryTableBase)
+ * @param FieldOffset offset of the field from the start of the structure
+ *
+ * @return BOOLEAN
+ */
+BOOLEAN
+SymGetFieldOffset(const char * TypeName, const char * FieldPath, PUINT32 FieldOffset)
+{
+    const char * Name       = strchr(TypeName, '!');
+    DWORD64      ModuleBase = NULL;
+
+    if (Name != NULL)
+    {
+        //
+        // Find the module from its name
+        //
+        ModuleBase = SymGetModuleBaseFromSearchMask(TypeName, FALSE);
+        Name++;
+
+        if (ModuleBase == NULL)
+        {
+            return FALSE;
+        }
+    }
+    else
+    {
+        Name = TypeName;
+    }
+
+    for (auto item : g_LoadedModules)
+    {
+        if (ModuleBase != NULL && item->ModuleBase != ModuleBase)
+        {
+            continue;
+        }
+
+        if (item->PdbReader != NULL)
+        {
+            if (PdbReaderFindField(item->PdbReader, Name, FieldPath, FieldOffset))
+            {
+                return TRUE;
+            }
+        }
+        else if (SymGetFieldOffsetUsingDbgHelp(item->ModuleBase, Name, FieldPath, FieldOffset))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 /**
  * @brief Interpret different tags for pdbs
  *
@@ -17,30 +17,12 @@
 
 #define DoNotShowDetailedResult TRUE
 
-//////////////////////////////////////////////////
-//					Structures                  //
-//////////////////////////////////////////////////
-
 /**
- * @brief Hold detail about the loaded modules
+ * @brief Read the pdb files using the native reader (pdb-reader.cpp) and
+ * only use DbgHelp if the native reader is not able to open the file
  *
  */
-typedef struct _SYMBOL_LOADED_MODULE_DETAILS
-{
-    UINT64  BaseAddress;
-    DWORD64 ModuleBase;
-    char *  ModuleName[_MAX_FNAME];
-
-} SYMBOL_LOADED_MODULE_DETAILS, *PSYMBOL_LOADED_MODULE_DETAILS;
-
-//////////////////////////////////////////////////
-//		    	Global Variables                //
-//////////////////////////////////////////////////
-
-std::vector<PSYMBOL_LOADED_MODULE_DETAILS> g_LoadedModules;
-BOOLEAN                                    g_IsLoadedModulesInitialized = FALSE;
-CHAR *                                     g_CurrentModuleName          = NULL;
-CHAR                                       g_NtModuleName[_MAX_FNAME]   = {0};
+#define UseNativePdbReader TRUE
 
 //////////////////////////////////////////////////
 //					Exports                     //
@@ -50,6 +32,8 @@ __declspec(dllexport) UINT32 SymLoadFileSymbol(UINT64 BaseAddress, const char *
 __declspec(dllexport) UINT32 SymUnloadAllSymbols();
 __declspec(dllexport) UINT32 SymSearchSymbolForMask(const char * SearchMask);
 __declspec(dllexport) UINT64 SymConvertNameToAddress(const char * FunctionOrVariableName, PBOOLEAN WasFound);
+__declspec(dllexport) BOOLEAN SymConvertAddressToObjectName(UINT64 Address, char * ObjectName, UINT32 ObjectNameSize, PUINT64 Displacement);
+__declspec(dllexport) BOOLEAN SymGetFieldOffset(const char * TypeName, const char * FieldPath, PUINT32 FieldOffset);
 }
 
 //////////////////////////////////////////////////
@@ -68,6 +52,21 @@ SymShowSymbolInfo(DWORD64 ModBase);
 BOOL CALLBACK
 SymEnumSymbolsCallback(SYMBOL_INFO * SymInfo, ULONG SymbolSize, PVOID UserContext);
 
+VOID
+SymPdbReaderEnumerateCallback(const PDB_READER_SYMBOL * Symbol, PVOID UserContext);
+
+PSYMBOL_LOADED_MODULE_DETAILS
+SymGetPdbReaderModule(DWORD64 ModuleBase);
+
+BOOLEAN
+SymConvertNameToAddressUsingPdbReader(const char * FunctionOrVariableName, PUINT64 Address);
+
+BOOL CALLBACK
+SymBuildAddressRangesCallback(SYMBOL_INFO * SymInfo, ULONG SymbolSize, PVOID UserContext);
+
+BOOLEAN
+SymGetFieldOffsetUsingDbgHelp(DWORD64 ModuleBase, const char * TypeName, const char * FieldPath, PUINT32 FieldOffset);
+
 VOID
 SymShowSymbolDetails(SYMBOL_INFO & SymInfo);
 
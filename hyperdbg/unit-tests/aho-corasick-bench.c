@@ -0,0 +1,276 @@
+/**
+ * @file aho-corasick-bench.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the multi-pattern (Aho-Corasick) matcher
+ * @details The table of transitions of the automaton is compared with the
+ * previous automaton (the failure links are followed and the children are
+ * searched in the list of siblings for each byte) and with a separate
+ * search of each pattern (as running s* once for each pattern), the buffer
+ * is either random or made of the prefixes of the patterns (the automaton
+ * is in a deep state for most of the bytes) and the patterns are placed a
+ * few times in it
+ *
+ * Usage: aho-corasick-bench [megabytes] [rounds]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <stdio.h>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the copies of each pattern in the buffer
+ *
+ */
+#define BENCH_COUNT_OF_COPIES 16
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+UINT64 g_CountOfMatches;
+UCHAR  g_Patterns[MaximumMultiPatternSearchPatternsTotalLength];
+UINT32 g_PatternsLength[MaximumMultiPatternSearchPatternsCount];
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count the matches
+ *
+ * @param PatternId
+ * @param Address
+ * @param Context
+ * @return VOID
+ */
+static VOID
+BenchCountMatchCallback(UINT32 PatternId, UINT64 Address, PVOID Context)
+{
+    g_CountOfMatches++;
+}
+
+/**
+ * @brief Scan the buffer with the previous automaton (the failure links
+ * are followed for each byte)
+ *
+ * @param Automaton
+ * @param Buffer
+ * @param BufferSize
+ * @return VOID
+ */
+static VOID
+BenchFailureLinks(PAHO_CORASICK_AUTOMATON Automaton, const UCHAR * Buffer, UINT32 BufferSize)
+{
+    UINT16 State = AHO_CORASICK_ROOT_STATE;
+    UINT16 Child;
+
+    for (UINT32 i = 0; i < BufferSize; i++)
+    {
+        while (TRUE)
+        {
+            if (State == AHO_CORASICK_ROOT_STATE)
+            {
+                State = Automaton->Transitions[AHO_CORASICK_ROOT_STATE][Buffer[i]];
+                break;
+            }
+
+            for (Child = Automaton->States[State].FirstChild;
+                 Child != AHO_CORASICK_NO_STATE && Automaton->States[Child].Byte != Buffer[i];
+                 Child = Automaton->States[Child].NextSibling)
+                ;
+
+            if (Child != AHO_CORASICK_NO_STATE)
+            {
+                State = Child;
+                break;
+            }
+
+            State = Automaton->States[State].Failure;
+        }
+
+        g_CountOfMatches += Automaton->States[State].CountOfMatches;
+    }
+}
+
+/**
+ * @brief Search each pattern separately
+ *
+ * @param CountOfPatterns
+ * @param Buffer
+ * @param BufferSize
+ * @return VOID
+ */
+static VOID
+BenchEachPattern(UINT32 CountOfPatterns, const UCHAR * Buffer, UINT32 BufferSize)
+{
+    const UCHAR * Pattern = g_Patterns;
+
+    for (UINT32 i = 0; i < CountOfPatterns; i++)
+    {
+        for (UINT32 Position = 0; Position + g_PatternsLength[i] <= BufferSize; Position++)
+        {
+            UINT32 j = 0;
+
+            while (j < g_PatternsLength[i] && Buffer[Position + j] == Pattern[j])
+            {
+                j++;
+            }
+
+            if (j == g_PatternsLength[i])
+            {
+                g_CountOfMatches++;
+            }
+        }
+
+        Pattern += g_PatternsLength[i];
+    }
+}
+
+/**
+ * @brief Search the buffer a few times
+ *
+ * @param Automaton
+ * @param CountOfPatterns
+ * @param Buffer
+ * @param BufferSize
+ * @param Rounds
+ * @param Method 0 each pattern, 1 failure links and 2 table of transitions
+ * @return double Megabytes per second
+ */
+static double
+BenchRun(PAHO_CORASICK_AUTOMATON Automaton, UINT32 CountOfPatterns, const UCHAR * Buffer, UINT32 BufferSize, UINT32 Rounds, UINT32 Method)
+{
+    struct timespec Start, End;
+    UINT16          State;
+
+    g_CountOfMatches = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &Start);
+
+    for (UINT32 i = 0; i < Rounds; i++)
+    {
+        if (Method == 0)
+        {
+            BenchEachPattern(CountOfPatterns, Buffer, BufferSize);
+        }
+        else if (Method == 1)
+        {
+            BenchFailureLinks(Automaton, Buffer, BufferSize);
+        }
+        else
+        {
+            State = AHO_CORASICK_ROOT_STATE;
+
+            AhoCorasickScanBuffer(Automaton, Buffer, BufferSize, 0, &State, 0xffffffff, BenchCountMatchCallback, NULL);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &End);
+
+    if (g_CountOfMatches < (UINT64)BENCH_COUNT_OF_COPIES * CountOfPatterns * Rounds)
+    {
+        printf("err, the matches are not found\n");
+    }
+
+    return (double)BufferSize * Rounds / ((End.tv_sec - Start.tv_sec) * 1e3 + (End.tv_nsec - Start.tv_nsec) / 1e6) / 1e3;
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32                  BufferSize        = (argc > 1 ? atoi(argv[1]) : 16) * 1024 * 1024;
+    UINT32                  Rounds            = argc > 2 ? atoi(argv[2]) : 2;
+    UINT32                  Random            = 0x12345678;
+    UCHAR *                 Buffer            = malloc(BufferSize);
+    PAHO_CORASICK_AUTOMATON Automaton         = malloc(sizeof(AHO_CORASICK_AUTOMATON));
+    UINT32                  CountsOfPatterns[] = {1, 4, 16, MaximumMultiPatternSearchPatternsCount};
+    UINT32                  CountOfPatterns;
+    UINT32                  Offset;
+    BOOLEAN                 IsPartialMatches;
+
+    if (Buffer == NULL || Automaton == NULL)
+    {
+        return 1;
+    }
+
+    //
+    // The patterns share their first bytes (like the prologues of the
+    // functions), so the previous automaton follows the failure links
+    //
+    for (UINT32 i = 0; i < MaximumMultiPatternSearchPatternsCount; i++)
+    {
+        g_PatternsLength[i] = MaximumMultiPatternSearchPatternsTotalLength / MaximumMultiPatternSearchPatternsCount;
+
+        for (UINT32 j = 0; j < g_PatternsLength[i]; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            g_Patterns[i * g_PatternsLength[i] + j] = j < 4 ? (UCHAR)("\x48\x89\x5c\x24"[j]) : (UCHAR)Random;
+        }
+    }
+
+    for (UINT32 i = 0; i < 2 * sizeof(CountsOfPatterns) / sizeof(CountsOfPatterns[0]); i++)
+    {
+        CountOfPatterns  = CountsOfPatterns[i % (sizeof(CountsOfPatterns) / sizeof(CountsOfPatterns[0]))];
+        IsPartialMatches = i >= sizeof(CountsOfPatterns) / sizeof(CountsOfPatterns[0]);
+
+        for (UINT32 j = 0; j < BufferSize;)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            if (!IsPartialMatches)
+            {
+                Buffer[j++] = (UCHAR)Random;
+                continue;
+            }
+
+            //
+            // A prefix of a pattern which is not completed
+            //
+            Offset = (Random >> 8) % CountOfPatterns * g_PatternsLength[0];
+
+            for (UINT32 k = 0; k < 1 + Random % (g_PatternsLength[0] - 1) && j < BufferSize; k++)
+            {
+                Buffer[j++] = g_Patterns[Offset + k];
+            }
+        }
+
+        for (UINT32 j = 0; j < BENCH_COUNT_OF_COPIES * CountOfPatterns; j++)
+        {
+            Offset = (UINT32)((UINT64)(BufferSize - g_PatternsLength[0]) / (BENCH_COUNT_OF_COPIES * CountOfPatterns) * j);
+
+            memcpy(&Buffer[Offset], &g_Patterns[(j % CountOfPatterns) * g_PatternsLength[0]], g_PatternsLength[0]);
+        }
+
+        if (!AhoCorasickBuild(Automaton, g_PatternsLength, g_Patterns, CountOfPatterns))
+        {
+            return 1;
+        }
+
+        printf("%-16s %2u patterns  each pattern: %8.2f MB/s, failure links: %8.2f MB/s, transitions: %8.2f MB/s\n",
+               IsPartialMatches ? "partial matches" : "random",
+               CountOfPatterns,
+               BenchRun(Automaton, CountOfPatterns, Buffer, BufferSize, Rounds, 0),
+               BenchRun(Automaton, CountOfPatterns, Buffer, BufferSize, Rounds, 1),
+               BenchRun(Automaton, CountOfPatterns, Buffer, BufferSize, Rounds, 2));
+    }
+
+    free(Automaton);
+    free(Buffer);
+
+    return 0;
+}
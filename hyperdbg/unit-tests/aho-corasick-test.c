@@ -0,0 +1,443 @@
+/**
+ * @file aho-corasick-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the multi-pattern (Aho-Corasick) matcher
+ * @details The matches of the automaton are compared with a search of each
+ * pattern at each position, the buffers are also scanned in pieces (with
+ * the state kept between them like the pages of sm and !sm) and with a
+ * limited count of matches that are continued from the returned offset
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Size of the buffer of the test
+ *
+ */
+#define AHO_CORASICK_TEST_BUFFER_SIZE 0x2000
+
+/**
+ * @brief Maximum count of the matches of the test
+ *
+ */
+#define AHO_CORASICK_TEST_MAXIMUM_MATCHES 0x40000
+
+/**
+ * @brief A match of the test
+ *
+ */
+typedef struct _AHO_CORASICK_TEST_MATCH
+{
+    UINT64 Address;
+    UINT32 PatternId;
+
+} AHO_CORASICK_TEST_MATCH, *PAHO_CORASICK_TEST_MATCH;
+
+/**
+ * @brief The matches of a scan
+ *
+ */
+typedef struct _AHO_CORASICK_TEST_MATCHES
+{
+    AHO_CORASICK_TEST_MATCH Matches[AHO_CORASICK_TEST_MAXIMUM_MATCHES];
+    UINT32                  CountOfMatches;
+
+} AHO_CORASICK_TEST_MATCHES, *PAHO_CORASICK_TEST_MATCHES;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+UCHAR                     g_Buffer[AHO_CORASICK_TEST_BUFFER_SIZE];
+UCHAR                     g_Patterns[MaximumMultiPatternSearchPatternsTotalLength];
+UINT32                    g_PatternsLength[MaximumMultiPatternSearchPatternsCount];
+AHO_CORASICK_TEST_MATCHES g_Expected;
+AHO_CORASICK_TEST_MATCHES g_Found;
+UINT32                    g_Random = 0x87654321;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A small random number generator (xorshift)
+ *
+ * @return UINT32
+ */
+static UINT32
+AhoCorasickTestRandom()
+{
+    g_Random ^= g_Random << 13;
+    g_Random ^= g_Random >> 17;
+    g_Random ^= g_Random << 5;
+
+    return g_Random;
+}
+
+/**
+ * @brief Save a match of the automaton
+ *
+ * @param PatternId
+ * @param Address
+ * @param Context The matches
+ * @return VOID
+ */
+static VOID
+AhoCorasickTestSaveMatch(UINT32 PatternId, UINT64 Address, PVOID Context)
+{
+    PAHO_CORASICK_TEST_MATCHES Matches = (PAHO_CORASICK_TEST_MATCHES)Context;
+
+    if (Matches->CountOfMatches < AHO_CORASICK_TEST_MAXIMUM_MATCHES)
+    {
+        Matches->Matches[Matches->CountOfMatches].Address   = Address;
+        Matches->Matches[Matches->CountOfMatches].PatternId = PatternId;
+    }
+
+    Matches->CountOfMatches++;
+}
+
+/**
+ * @brief Order the matches by their addresses and their patterns
+ *
+ * @param First
+ * @param Second
+ * @return int
+ */
+static int
+AhoCorasickTestCompareMatches(const void * First, const void * Second)
+{
+    const AHO_CORASICK_TEST_MATCH * A = (const AHO_CORASICK_TEST_MATCH *)First;
+    const AHO_CORASICK_TEST_MATCH * B = (const AHO_CORASICK_TEST_MATCH *)Second;
+
+    if (A->Address != B->Address)
+    {
+        return A->Address < B->Address ? -1 : 1;
+    }
+
+    return A->PatternId < B->PatternId ? -1 : A->PatternId > B->PatternId;
+}
+
+/**
+ * @brief Search each pattern at each position of the buffer
+ *
+ * @param CountOfPatterns
+ * @param Buffer
+ * @param BufferSize
+ * @param BaseAddress
+ * @param Matches
+ * @return VOID
+ */
+static VOID
+AhoCorasickTestReferenceSearch(UINT32 CountOfPatterns, const UCHAR * Buffer, UINT32 BufferSize, UINT64 BaseAddress, PAHO_CORASICK_TEST_MATCHES Matches)
+{
+    Matches->CountOfMatches = 0;
+
+    for (UINT32 Position = 0; Position < BufferSize; Position++)
+    {
+        const UCHAR * Pattern = g_Patterns;
+
+        for (UINT32 i = 0; i < CountOfPatterns; i++)
+        {
+            if (Position + g_PatternsLength[i] <= BufferSize &&
+                memcmp(&Buffer[Position], Pattern, g_PatternsLength[i]) == 0)
+            {
+                AhoCorasickTestSaveMatch(i, BaseAddress + Position, Matches);
+            }
+
+            Pattern += g_PatternsLength[i];
+        }
+    }
+}
+
+/**
+ * @brief Check whether the matches of the automaton are the same as the
+ * matches of the reference search (in any order)
+ *
+ * @return BOOLEAN
+ */
+static BOOLEAN
+AhoCorasickTestIsSameMatches()
+{
+    if (g_Found.CountOfMatches != g_Expected.CountOfMatches ||
+        g_Found.CountOfMatches > AHO_CORASICK_TEST_MAXIMUM_MATCHES)
+    {
+        return FALSE;
+    }
+
+    qsort(g_Found.Matches, g_Found.CountOfMatches, sizeof(AHO_CORASICK_TEST_MATCH), AhoCorasickTestCompareMatches);
+    qsort(g_Expected.Matches, g_Expected.CountOfMatches, sizeof(AHO_CORASICK_TEST_MATCH), AhoCorasickTestCompareMatches);
+
+    return memcmp(g_Found.Matches, g_Expected.Matches, g_Found.CountOfMatches * sizeof(AHO_CORASICK_TEST_MATCH)) == 0;
+}
+
+/**
+ * @brief Create random patterns from the buffer (or random bytes)
+ *
+ * @param CountOfPatterns
+ * @param MaximumLength
+ * @return UINT32 Total length of the patterns
+ */
+static UINT32
+AhoCorasickTestCreatePatterns(UINT32 CountOfPatterns, UINT32 MaximumLength)
+{
+    UINT32 TotalLength = 0;
+
+    for (UINT32 i = 0; i < CountOfPatterns; i++)
+    {
+        g_PatternsLength[i] = 1 + AhoCorasickTestRandom() % MaximumLength;
+
+        if (AhoCorasickTestRandom() % 4 != 0)
+        {
+            memcpy(&g_Patterns[TotalLength],
+                   &g_Buffer[AhoCorasickTestRandom() % (AHO_CORASICK_TEST_BUFFER_SIZE - g_PatternsLength[i])],
+                   g_PatternsLength[i]);
+        }
+        else
+        {
+            for (UINT32 j = 0; j < g_PatternsLength[i]; j++)
+            {
+                g_Patterns[TotalLength + j] = (UCHAR)(AhoCorasickTestRandom() % 4);
+            }
+        }
+
+        TotalLength += g_PatternsLength[i];
+    }
+
+    return TotalLength;
+}
+
+/**
+ * @brief Check the automaton with random patterns on a buffer of a small
+ * alphabet (many overlapping matches and suffixes of the patterns)
+ *
+ * @param Automaton
+ * @return VOID
+ */
+static VOID
+AhoCorasickTestRandomPatterns(PAHO_CORASICK_AUTOMATON Automaton)
+{
+    BOOLEAN IsValid          = TRUE;
+    BOOLEAN IsPiecesValid    = TRUE;
+    BOOLEAN IsResumedValid   = TRUE;
+    UINT32  CountOfPatterns;
+    UINT32  ScannedSize;
+    UINT32  Position;
+    UINT32  Size;
+    UINT32  MaximumMatches;
+    UINT16  State;
+
+    for (UINT32 i = 0; i < AHO_CORASICK_TEST_BUFFER_SIZE; i++)
+    {
+        g_Buffer[i] = (UCHAR)(AhoCorasickTestRandom() % 4);
+    }
+
+    for (UINT32 Round = 0; Round < 300; Round++)
+    {
+        CountOfPatterns = 1 + AhoCorasickTestRandom() % MaximumMultiPatternSearchPatternsCount;
+
+        AhoCorasickTestCreatePatterns(CountOfPatterns, 1 + AhoCorasickTestRandom() % (MaximumMultiPatternSearchPatternsTotalLength / CountOfPatterns));
+
+        if (!AhoCorasickBuild(Automaton, g_PatternsLength, g_Patterns, CountOfPatterns))
+        {
+            IsValid = FALSE;
+            continue;
+        }
+
+        AhoCorasickTestReferenceSearch(CountOfPatterns, g_Buffer, AHO_CORASICK_TEST_BUFFER_SIZE, 0x1000, &g_Expected);
+
+        //
+        // The whole buffer
+        //
+        State                  = AHO_CORASICK_ROOT_STATE;
+        g_Found.CountOfMatches = 0;
+
+        ScannedSize = AhoCorasickScanBuffer(Automaton,
+                                            g_Buffer,
+                                            AHO_CORASICK_TEST_BUFFER_SIZE,
+                                            0x1000,
+                                            &State,
+                                            0xffffffff,
+                                            AhoCorasickTestSaveMatch,
+                                            &g_Found);
+
+        if (ScannedSize != AHO_CORASICK_TEST_BUFFER_SIZE || !AhoCorasickTestIsSameMatches())
+        {
+            IsValid = FALSE;
+        }
+
+        //
+        // Pieces of the buffer with the state kept between them
+        //
+        State                  = AHO_CORASICK_ROOT_STATE;
+        g_Found.CountOfMatches = 0;
+
+        for (Position = 0; Position < AHO_CORASICK_TEST_BUFFER_SIZE; Position += Size)
+        {
+            Size = 1 + AhoCorasickTestRandom() % 300;
+            Size = min(Size, AHO_CORASICK_TEST_BUFFER_SIZE - Position);
+
+            AhoCorasickScanBuffer(Automaton, &g_Buffer[Position], Size, 0x1000 + Position, &State, 0xffffffff, AhoCorasickTestSaveMatch, &g_Found);
+        }
+
+        if (!AhoCorasickTestIsSameMatches())
+        {
+            IsPiecesValid = FALSE;
+        }
+
+        //
+        // A limited count of matches for each scan, the next scan
+        // continues from the first byte that is not scanned
+        //
+        State                  = AHO_CORASICK_ROOT_STATE;
+        g_Found.CountOfMatches = 0;
+        MaximumMatches         = MaximumMultiPatternSearchPatternsCount + AhoCorasickTestRandom() % 64;
+
+        for (Position = 0; Position < AHO_CORASICK_TEST_BUFFER_SIZE;)
+        {
+            UINT32 PreviousCount = g_Found.CountOfMatches;
+
+            ScannedSize = AhoCorasickScanBuffer(Automaton,
+                                                &g_Buffer[Position],
+                                                AHO_CORASICK_TEST_BUFFER_SIZE - Position,
+                                                0x1000 + Position,
+                                                &State,
+                                                MaximumMatches,
+                                                AhoCorasickTestSaveMatch,
+                                                &g_Found);
+
+            if (g_Found.CountOfMatches - PreviousCount > MaximumMatches)
+            {
+                IsResumedValid = FALSE;
+            }
+
+            Position += ScannedSize;
+        }
+
+        if (!AhoCorasickTestIsSameMatches())
+        {
+            IsResumedValid = FALSE;
+        }
+    }
+
+    UNIT_TEST_CHECK(IsValid);
+    UNIT_TEST_CHECK(IsPiecesValid);
+    UNIT_TEST_CHECK(IsResumedValid);
+}
+
+/**
+ * @brief Check the duplicate patterns, the patterns that are suffixes of
+ * the others and the limits of the patterns
+ *
+ * @param Automaton
+ * @return VOID
+ */
+static VOID
+AhoCorasickTestPatterns(PAHO_CORASICK_AUTOMATON Automaton)
+{
+    const char * Text = "ushers and she said he has his hers";
+    UINT32       Lengths[MaximumMultiPatternSearchPatternsCount + 1];
+    UINT32       ScannedSize;
+    UINT16       State;
+
+    //
+    // "he", "she", "his", "hers" and "he" again
+    //
+    memcpy(g_Patterns, "heshehishersshe", 15);
+    Lengths[0] = 2;
+    Lengths[1] = 3;
+    Lengths[2] = 3;
+    Lengths[3] = 4;
+    Lengths[4] = 3;
+
+    UNIT_TEST_CHECK(AhoCorasickBuild(Automaton, Lengths, g_Patterns, 5));
+
+    memcpy(g_PatternsLength, Lengths, 5 * sizeof(UINT32));
+    AhoCorasickTestReferenceSearch(5, (const UCHAR *)Text, (UINT32)strlen(Text), 0, &g_Expected);
+
+    State                  = AHO_CORASICK_ROOT_STATE;
+    g_Found.CountOfMatches = 0;
+
+    AhoCorasickScanBuffer(Automaton, (const UCHAR *)Text, (UINT32)strlen(Text), 0, &State, 0xffffffff, AhoCorasickTestSaveMatch, &g_Found);
+
+    UNIT_TEST_CHECK(g_Expected.CountOfMatches == 11);
+    UNIT_TEST_CHECK(AhoCorasickTestIsSameMatches());
+
+    //
+    // "she" (and the duplicate "she" and "he") end on the same byte, they
+    // are either reported together or not at all
+    //
+    State                  = AHO_CORASICK_ROOT_STATE;
+    g_Found.CountOfMatches = 0;
+
+    ScannedSize = AhoCorasickScanBuffer(Automaton, (const UCHAR *)"ushe", 4, 0, &State, 2, AhoCorasickTestSaveMatch, &g_Found);
+
+    UNIT_TEST_CHECK(ScannedSize == 3 && g_Found.CountOfMatches == 0);
+
+    ScannedSize = AhoCorasickScanBuffer(Automaton, (const UCHAR *)"ushe" + 3, 1, 3, &State, 3, AhoCorasickTestSaveMatch, &g_Found);
+
+    UNIT_TEST_CHECK(ScannedSize == 1 && g_Found.CountOfMatches == 3);
+
+    //
+    // The limits of the count and the length of the patterns
+    //
+    for (UINT32 i = 0; i <= MaximumMultiPatternSearchPatternsCount; i++)
+    {
+        Lengths[i] = 1;
+    }
+
+    memset(g_Patterns, 'a', sizeof(g_Patterns));
+
+    UNIT_TEST_CHECK(AhoCorasickBuild(Automaton, Lengths, g_Patterns, MaximumMultiPatternSearchPatternsCount));
+    UNIT_TEST_CHECK(!AhoCorasickBuild(Automaton, Lengths, g_Patterns, MaximumMultiPatternSearchPatternsCount + 1));
+    UNIT_TEST_CHECK(!AhoCorasickBuild(Automaton, Lengths, g_Patterns, 0));
+
+    Lengths[1] = 0;
+    UNIT_TEST_CHECK(!AhoCorasickBuild(Automaton, Lengths, g_Patterns, 2));
+
+    //
+    // The longest patterns use all of the states
+    //
+    for (UINT32 i = 0; i < sizeof(g_Patterns); i++)
+    {
+        g_Patterns[i] = (UCHAR)AhoCorasickTestRandom();
+    }
+
+    Lengths[0] = MaximumMultiPatternSearchPatternsTotalLength / 2;
+    Lengths[1] = MaximumMultiPatternSearchPatternsTotalLength / 2;
+
+    UNIT_TEST_CHECK(AhoCorasickBuild(Automaton, Lengths, g_Patterns, 2));
+    UNIT_TEST_CHECK(Automaton->CountOfStates <= AHO_CORASICK_MAXIMUM_STATES);
+
+    Lengths[1]++;
+    UNIT_TEST_CHECK(!AhoCorasickBuild(Automaton, Lengths, g_Patterns, 2));
+}
+
+int
+main()
+{
+    PAHO_CORASICK_AUTOMATON Automaton = (PAHO_CORASICK_AUTOMATON)malloc(sizeof(AHO_CORASICK_AUTOMATON));
+
+    if (Automaton == NULL)
+    {
+        return 1;
+    }
+
+    AhoCorasickTestPatterns(Automaton);
+    AhoCorasickTestRandomPatterns(Automaton);
+
+    free(Automaton);
+
+    return UNIT_TEST_RESULT("aho-corasick-test");
+}
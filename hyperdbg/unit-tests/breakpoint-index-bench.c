@@ -0,0 +1,253 @@
+/**
+ * @file breakpoint-index-bench.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the index of breakpoints of 'bp' command
+ * @details The lookups of the #BP vm-exits (by the physical address) and
+ * the range queries of the memory reads (by the virtual address) are
+ * compared with walking the list of breakpoints (as the previous handlers
+ * of the #BP vm-exits and the memory reads), the cost of the insertion and
+ * the removal of the index is also measured
+ *
+ * Usage: breakpoint-index-bench [lookups]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <stdio.h>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+DEBUGGEE_BP_DESCRIPTOR g_Descriptors[MAXIMUM_NUMBER_OF_BREAKPOINTS];
+LIST_ENTRY             g_BreakpointsListHead;
+UINT64                 g_Found;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the current time in nanoseconds
+ *
+ * @return double
+ */
+static double
+BenchNow()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+/**
+ * @brief Find a breakpoint by its physical address in the list
+ *
+ * @param PhysAddress
+ * @return PDEBUGGEE_BP_DESCRIPTOR
+ */
+static PDEBUGGEE_BP_DESCRIPTOR
+BenchListFindByPhysicalAddress(UINT64 PhysAddress)
+{
+    PLIST_ENTRY TempList = &g_BreakpointsListHead;
+
+    while (&g_BreakpointsListHead != TempList->Flink)
+    {
+        TempList                                      = TempList->Flink;
+        PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(TempList, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
+
+        if (CurrentBreakpointDesc->PhysAddress == PhysAddress)
+        {
+            return CurrentBreakpointDesc;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Count the breakpoints in the range of a read with the list
+ *
+ * @param Address
+ * @param Size
+ * @return VOID
+ */
+static VOID
+BenchListRange(UINT64 Address, UINT32 Size)
+{
+    PLIST_ENTRY TempList = &g_BreakpointsListHead;
+
+    while (&g_BreakpointsListHead != TempList->Flink)
+    {
+        TempList                                      = TempList->Flink;
+        PDEBUGGEE_BP_DESCRIPTOR CurrentBreakpointDesc = CONTAINING_RECORD(TempList, DEBUGGEE_BP_DESCRIPTOR, BreakpointsList);
+
+        if (CurrentBreakpointDesc->Address - Address < Size)
+        {
+            g_Found++;
+        }
+    }
+}
+
+/**
+ * @brief Count the breakpoints in the range of a read with the index
+ *
+ * @param Index
+ * @param Address
+ * @param Size
+ * @return VOID
+ */
+static VOID
+BenchIndexRange(PBREAKPOINT_INDEX Index, UINT64 Address, UINT32 Size)
+{
+    for (UINT32 i = BreakpointIndexLowerBound(Index, Address, 0); i < Index->CountOfBreakpoints; i++)
+    {
+        if (Index->SortedByAddress[i].Address - Address >= Size)
+        {
+            break;
+        }
+
+        g_Found++;
+    }
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32            Lookups              = argc > 1 ? atoi(argv[1]) : 1000000;
+    UINT32            CountsOfBreakpoints[] = {16, 256, MAXIMUM_NUMBER_OF_BREAKPOINTS};
+    UINT32            Random               = 0x2468ace0;
+    PBREAKPOINT_INDEX Index                = malloc(sizeof(BREAKPOINT_INDEX));
+    UINT32            CountOfBreakpoints;
+    UINT64            Address;
+    double            Start;
+    double            ListLookup, IndexLookup, ListRange, IndexRange, Update;
+
+    if (Index == NULL)
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < sizeof(CountsOfBreakpoints) / sizeof(CountsOfBreakpoints[0]); i++)
+    {
+        CountOfBreakpoints = CountsOfBreakpoints[i];
+
+        RtlZeroMemory(Index, sizeof(BREAKPOINT_INDEX));
+        InitializeListHead(&g_BreakpointsListHead);
+
+        //
+        // The breakpoints are on the functions of a 4 MB image
+        //
+        for (UINT32 j = 0; j < CountOfBreakpoints; j++)
+        {
+            g_Descriptors[j].Address     = 0xfffff80000000000 + (UINT64)j * (0x400000 / CountOfBreakpoints);
+            g_Descriptors[j].PhysAddress = 0x10000000 + (g_Descriptors[j].Address & 0xffffffff);
+
+            InsertHeadList(&g_BreakpointsListHead, &g_Descriptors[j].BreakpointsList);
+            BreakpointIndexInsert(Index, &g_Descriptors[j], 0);
+        }
+
+        //
+        // The #BP vm-exits of the breakpoints
+        //
+        g_Found = 0;
+        Start   = BenchNow();
+
+        for (UINT32 j = 0; j < Lookups; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            g_Found += BenchListFindByPhysicalAddress(g_Descriptors[Random % CountOfBreakpoints].PhysAddress) != NULL;
+        }
+
+        ListLookup = (BenchNow() - Start) / Lookups;
+        Start      = BenchNow();
+
+        for (UINT32 j = 0; j < Lookups; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            g_Found += BreakpointIndexFindByPhysicalAddress(Index, g_Descriptors[Random % CountOfBreakpoints].PhysAddress) != NULL;
+        }
+
+        IndexLookup = (BenchNow() - Start) / Lookups;
+
+        if (g_Found != (UINT64)Lookups * 2)
+        {
+            printf("err, the breakpoints are not found\n");
+        }
+
+        //
+        // The reads of a page of the image
+        //
+        Start = BenchNow();
+
+        for (UINT32 j = 0; j < Lookups; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            Address = 0xfffff80000000000 + (Random % 0x400) * PAGE_SIZE;
+
+            BenchListRange(Address, PAGE_SIZE);
+        }
+
+        ListRange = (BenchNow() - Start) / Lookups;
+        Start     = BenchNow();
+
+        for (UINT32 j = 0; j < Lookups; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            Address = 0xfffff80000000000 + (Random % 0x400) * PAGE_SIZE;
+
+            BenchIndexRange(Index, Address, PAGE_SIZE);
+        }
+
+        IndexRange = (BenchNow() - Start) / Lookups;
+
+        //
+        // Removing and setting a breakpoint again ('bc' and 'bp')
+        //
+        Start = BenchNow();
+
+        for (UINT32 j = 0; j < Lookups / 16; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            BreakpointIndexRemove(Index, &g_Descriptors[Random % CountOfBreakpoints]);
+            BreakpointIndexInsert(Index, &g_Descriptors[Random % CountOfBreakpoints], 0);
+        }
+
+        Update = (BenchNow() - Start) / (Lookups / 16);
+
+        printf("%4u breakpoints  #BP: list %7.1f ns, hash %5.1f ns  read of a page: list %7.1f ns, sorted %5.1f ns  bc + bp: %6.1f ns\n",
+               CountOfBreakpoints,
+               ListLookup,
+               IndexLookup,
+               ListRange,
+               IndexRange,
+               Update);
+    }
+
+    free(Index);
+
+    return 0;
+}
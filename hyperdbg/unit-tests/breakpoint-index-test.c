@@ -0,0 +1,405 @@
+/**
+ * @file breakpoint-index-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the index of breakpoints of 'bp' command
+ * @details Random insertions and removals are compared with a list of the
+ * breakpoints, the clusters of the hash table are checked after each
+ * removal (backward-shift deletion) and the same addresses are set in
+ * different processes (cr3-keyed lookups)
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+DEBUGGEE_BP_DESCRIPTOR g_Descriptors[MAXIMUM_NUMBER_OF_BREAKPOINTS * 2];
+UINT64                 g_AddressSpaces[MAXIMUM_NUMBER_OF_BREAKPOINTS * 2];
+BOOLEAN                g_IsIndexed[MAXIMUM_NUMBER_OF_BREAKPOINTS * 2];
+UINT32                 g_Random = 0x13572468;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A small random number generator (xorshift)
+ *
+ * @return UINT32
+ */
+static UINT32
+BreakpointIndexTestRandom()
+{
+    g_Random ^= g_Random << 13;
+    g_Random ^= g_Random >> 17;
+    g_Random ^= g_Random << 5;
+
+    return g_Random;
+}
+
+/**
+ * @brief Get the home slot of a physical address (the same hash as the
+ * index)
+ *
+ * @param PhysAddress
+ * @return UINT32
+ */
+static UINT32
+BreakpointIndexTestHomeSlot(UINT64 PhysAddress)
+{
+    return (UINT32)((PhysAddress * 0x9E3779B97F4A7C15) >> 32) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1);
+}
+
+/**
+ * @brief Check the structure of the index
+ * @details The sorted array should be in the order of the addresses and
+ * the address spaces, and each entry of the hash table should be reachable
+ * from its home slot without passing an empty slot (no tombstones)
+ *
+ * @param Index
+ * @param CountOfBreakpoints Count of the indexed breakpoints
+ * @return BOOLEAN
+ */
+static BOOLEAN
+BreakpointIndexTestIsValid(PBREAKPOINT_INDEX Index, UINT32 CountOfBreakpoints)
+{
+    UINT32 CountOfSlots = 0;
+    UINT32 Slot;
+
+    if (Index->CountOfBreakpoints != CountOfBreakpoints)
+    {
+        return FALSE;
+    }
+
+    for (UINT32 i = 1; i < Index->CountOfBreakpoints; i++)
+    {
+        if (Index->SortedByAddress[i - 1].Address > Index->SortedByAddress[i].Address ||
+            (Index->SortedByAddress[i - 1].Address == Index->SortedByAddress[i].Address &&
+             Index->SortedByAddress[i - 1].AddressSpace >= Index->SortedByAddress[i].AddressSpace))
+        {
+            return FALSE;
+        }
+    }
+
+    for (UINT32 i = 0; i < BREAKPOINT_INDEX_HASH_TABLE_SIZE; i++)
+    {
+        if (Index->HashedByPhysicalAddress[i].BreakpointDesc == NULL)
+        {
+            continue;
+        }
+
+        CountOfSlots++;
+
+        for (Slot = BreakpointIndexTestHomeSlot(Index->HashedByPhysicalAddress[i].Address);
+             Slot != i;
+             Slot = (Slot + 1) & (BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1))
+        {
+            if (Index->HashedByPhysicalAddress[Slot].BreakpointDesc == NULL)
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return CountOfSlots == CountOfBreakpoints;
+}
+
+/**
+ * @brief Check that the indexed breakpoints are found and the others are
+ * not found
+ *
+ * @param Index
+ * @return BOOLEAN
+ */
+static BOOLEAN
+BreakpointIndexTestIsFound(PBREAKPOINT_INDEX Index)
+{
+    PDEBUGGEE_BP_DESCRIPTOR Expected;
+
+    for (UINT32 i = 0; i < MAXIMUM_NUMBER_OF_BREAKPOINTS * 2; i++)
+    {
+        Expected = g_IsIndexed[i] ? &g_Descriptors[i] : NULL;
+
+        if (BreakpointIndexFindByAddress(Index, g_Descriptors[i].Address, g_AddressSpaces[i]) != Expected ||
+            BreakpointIndexFindByPhysicalAddress(Index, g_Descriptors[i].PhysAddress) != Expected)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Insert and remove random breakpoints
+ *
+ * @param Index
+ * @return VOID
+ */
+static VOID
+BreakpointIndexTestRandomOperations(PBREAKPOINT_INDEX Index)
+{
+    BOOLEAN  IsValid            = TRUE;
+    BOOLEAN  IsFound            = TRUE;
+    UINT32   CountOfBreakpoints = 0;
+    UINT32   Descriptor;
+    CR3_TYPE Cr3;
+
+    RtlZeroMemory(Index, sizeof(BREAKPOINT_INDEX));
+    RtlZeroMemory(g_IsIndexed, sizeof(g_IsIndexed));
+
+    //
+    // The breakpoints are on a few pages (close physical addresses), half
+    // of them are user-mode addresses of a few processes
+    //
+    for (UINT32 i = 0; i < MAXIMUM_NUMBER_OF_BREAKPOINTS * 2; i++)
+    {
+        Cr3.Flags = 0x1000 * (1 + BreakpointIndexTestRandom() % 4);
+
+        g_Descriptors[i].Address     = (i % 2 ? 0xfffff80000000000 : 0x7ff600000000) + (BreakpointIndexTestRandom() % 0x4000);
+        g_Descriptors[i].PhysAddress = 0x100000 + i * 7;
+        g_Descriptors[i].Cr3         = Cr3.Flags;
+        g_AddressSpaces[i]           = BreakpointIndexGetAddressSpace(g_Descriptors[i].Address, Cr3);
+
+        //
+        // The same address in the same address space can't be indexed
+        // twice, so the duplicates are moved
+        //
+        for (UINT32 j = 0; j < i; j++)
+        {
+            if (g_Descriptors[j].Address == g_Descriptors[i].Address && g_AddressSpaces[j] == g_AddressSpaces[i])
+            {
+                g_Descriptors[i].Address += 0x4000;
+                j = (UINT32)-1;
+            }
+        }
+    }
+
+    for (UINT32 Round = 0; Round < 20000; Round++)
+    {
+        Descriptor = BreakpointIndexTestRandom() % (MAXIMUM_NUMBER_OF_BREAKPOINTS * 2);
+
+        if (g_IsIndexed[Descriptor])
+        {
+            BreakpointIndexRemove(Index, &g_Descriptors[Descriptor]);
+
+            g_IsIndexed[Descriptor] = FALSE;
+            CountOfBreakpoints--;
+        }
+        else if (CountOfBreakpoints < MAXIMUM_NUMBER_OF_BREAKPOINTS)
+        {
+            BreakpointIndexInsert(Index, &g_Descriptors[Descriptor], g_AddressSpaces[Descriptor]);
+
+            g_IsIndexed[Descriptor] = TRUE;
+            CountOfBreakpoints++;
+        }
+
+        if (!BreakpointIndexTestIsValid(Index, CountOfBreakpoints))
+        {
+            IsValid = FALSE;
+        }
+
+        if (Round % 64 == 0 && !BreakpointIndexTestIsFound(Index))
+        {
+            IsFound = FALSE;
+        }
+    }
+
+    UNIT_TEST_CHECK(IsValid);
+    UNIT_TEST_CHECK(IsFound && BreakpointIndexTestIsFound(Index));
+
+    //
+    // Remove all of them, the table should be empty again
+    //
+    for (UINT32 i = 0; i < MAXIMUM_NUMBER_OF_BREAKPOINTS * 2; i++)
+    {
+        if (g_IsIndexed[i])
+        {
+            BreakpointIndexRemove(Index, &g_Descriptors[i]);
+
+            g_IsIndexed[i] = FALSE;
+            CountOfBreakpoints--;
+        }
+    }
+
+    UNIT_TEST_CHECK(CountOfBreakpoints == 0 && BreakpointIndexTestIsValid(Index, 0));
+    UNIT_TEST_CHECK(BreakpointIndexTestIsFound(Index));
+}
+
+/**
+ * @brief Remove the entries of a cluster that wraps around the end of the
+ * hash table
+ *
+ * @param Index
+ * @return VOID
+ */
+static VOID
+BreakpointIndexTestBackwardShift(PBREAKPOINT_INDEX Index)
+{
+    UINT32 CountOfBreakpoints = 0;
+    UINT64 PhysAddress        = 0x200000;
+    UINT32 HomeSlot;
+
+    RtlZeroMemory(Index, sizeof(BREAKPOINT_INDEX));
+    RtlZeroMemory(g_IsIndexed, sizeof(g_IsIndexed));
+
+    //
+    // Three addresses with the last slot as their home, then three
+    // addresses with the first slot as their home, they all make a
+    // cluster from the last slot to the fifth slot
+    //
+    for (UINT32 i = 0; i < 6; i++)
+    {
+        HomeSlot = i < 3 ? BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1 : 0;
+
+        while (BreakpointIndexTestHomeSlot(PhysAddress) != HomeSlot)
+        {
+            PhysAddress++;
+        }
+
+        g_Descriptors[i].Address     = 0xfffff80000001000 + i;
+        g_Descriptors[i].PhysAddress = PhysAddress++;
+        g_AddressSpaces[i]           = 0;
+
+        BreakpointIndexInsert(Index, &g_Descriptors[i], 0);
+
+        g_IsIndexed[i] = TRUE;
+        CountOfBreakpoints++;
+    }
+
+    for (UINT32 i = 6; i < MAXIMUM_NUMBER_OF_BREAKPOINTS * 2; i++)
+    {
+        g_Descriptors[i].Address     = 0;
+        g_Descriptors[i].PhysAddress = 0;
+        g_AddressSpaces[i]           = 1;
+    }
+
+    UNIT_TEST_CHECK(Index->HashedByPhysicalAddress[BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1].BreakpointDesc == &g_Descriptors[0]);
+    UNIT_TEST_CHECK(Index->HashedByPhysicalAddress[4].BreakpointDesc == &g_Descriptors[5]);
+    UNIT_TEST_CHECK(Index->HashedByPhysicalAddress[5].BreakpointDesc == NULL);
+
+    //
+    // Removing the first entry moves the others back, the entries of the
+    // first slot are moved to their home and not before it
+    //
+    BreakpointIndexRemove(Index, &g_Descriptors[0]);
+    g_IsIndexed[0] = FALSE;
+    CountOfBreakpoints--;
+
+    UNIT_TEST_CHECK(BreakpointIndexTestIsValid(Index, CountOfBreakpoints));
+    UNIT_TEST_CHECK(BreakpointIndexTestIsFound(Index));
+    UNIT_TEST_CHECK(Index->HashedByPhysicalAddress[BREAKPOINT_INDEX_HASH_TABLE_SIZE - 1].BreakpointDesc == &g_Descriptors[1]);
+    UNIT_TEST_CHECK(Index->HashedByPhysicalAddress[4].BreakpointDesc == NULL);
+
+    //
+    // An entry in the middle of the cluster
+    //
+    BreakpointIndexRemove(Index, &g_Descriptors[3]);
+    g_IsIndexed[3] = FALSE;
+    CountOfBreakpoints--;
+
+    UNIT_TEST_CHECK(BreakpointIndexTestIsValid(Index, CountOfBreakpoints));
+    UNIT_TEST_CHECK(BreakpointIndexTestIsFound(Index));
+    UNIT_TEST_CHECK(Index->HashedByPhysicalAddress[3].BreakpointDesc == NULL);
+
+    //
+    // Removing a breakpoint that is not indexed doesn't change anything
+    //
+    BreakpointIndexRemove(Index, &g_Descriptors[3]);
+
+    UNIT_TEST_CHECK(BreakpointIndexTestIsValid(Index, CountOfBreakpoints));
+    UNIT_TEST_CHECK(BreakpointIndexTestIsFound(Index));
+}
+
+/**
+ * @brief The same address in different processes and the kernel addresses
+ * that are shared between the processes
+ *
+ * @param Index
+ * @return VOID
+ */
+static VOID
+BreakpointIndexTestAddressSpaces(PBREAKPOINT_INDEX Index)
+{
+    CR3_TYPE Cr3First  = {.Flags = 0x1aa000};
+    CR3_TYPE Cr3Second = {.Flags = 0x2bb000};
+    UINT64   UserSpaceFirst;
+    UINT64   UserSpaceSecond;
+
+    RtlZeroMemory(Index, sizeof(BREAKPOINT_INDEX));
+
+    UserSpaceFirst  = BreakpointIndexGetAddressSpace(0x7ff612340000, Cr3First);
+    UserSpaceSecond = BreakpointIndexGetAddressSpace(0x7ff612340000, Cr3Second);
+
+    UNIT_TEST_CHECK(UserSpaceFirst == Cr3First.Flags && UserSpaceSecond == Cr3Second.Flags);
+    UNIT_TEST_CHECK(BreakpointIndexGetAddressSpace(0xfffff80012340000, Cr3First) == 0);
+    UNIT_TEST_CHECK(BreakpointIndexGetAddressSpace(0xfffff80012340000, Cr3Second) == 0);
+
+    g_Descriptors[0].Address     = 0x7ff612340000;
+    g_Descriptors[0].PhysAddress = 0x5000;
+    g_Descriptors[1].Address     = 0x7ff612340000;
+    g_Descriptors[1].PhysAddress = 0x9000;
+    g_Descriptors[2].Address     = 0x7ff612340010;
+    g_Descriptors[2].PhysAddress = 0x9010;
+    g_Descriptors[3].Address     = 0x7ff61233fff0;
+    g_Descriptors[3].PhysAddress = 0x9ff0;
+
+    BreakpointIndexInsert(Index, &g_Descriptors[1], UserSpaceSecond);
+    BreakpointIndexInsert(Index, &g_Descriptors[0], UserSpaceFirst);
+    BreakpointIndexInsert(Index, &g_Descriptors[2], UserSpaceSecond);
+    BreakpointIndexInsert(Index, &g_Descriptors[3], UserSpaceFirst);
+
+    UNIT_TEST_CHECK(BreakpointIndexFindByAddress(Index, 0x7ff612340000, UserSpaceFirst) == &g_Descriptors[0]);
+    UNIT_TEST_CHECK(BreakpointIndexFindByAddress(Index, 0x7ff612340000, UserSpaceSecond) == &g_Descriptors[1]);
+    UNIT_TEST_CHECK(BreakpointIndexFindByAddress(Index, 0x7ff612340000, 0) == NULL);
+    UNIT_TEST_CHECK(BreakpointIndexFindByAddress(Index, 0x7ff612340010, UserSpaceFirst) == NULL);
+
+    //
+    // The range of a read starts from the first entry of the address in
+    // any address space
+    //
+    UNIT_TEST_CHECK(BreakpointIndexLowerBound(Index, 0x7ff612340000, 0) == 1);
+    UNIT_TEST_CHECK(Index->SortedByAddress[1].BreakpointDesc == &g_Descriptors[0]);
+    UNIT_TEST_CHECK(Index->SortedByAddress[2].BreakpointDesc == &g_Descriptors[1]);
+    UNIT_TEST_CHECK(BreakpointIndexLowerBound(Index, 0x7ff612340001, 0) == 3);
+    UNIT_TEST_CHECK(BreakpointIndexLowerBound(Index, 0x7ff612340011, 0) == 4);
+
+    //
+    // Removing the breakpoint of a process keeps the other one
+    //
+    BreakpointIndexRemove(Index, &g_Descriptors[0]);
+
+    UNIT_TEST_CHECK(BreakpointIndexFindByAddress(Index, 0x7ff612340000, UserSpaceFirst) == NULL);
+    UNIT_TEST_CHECK(BreakpointIndexFindByAddress(Index, 0x7ff612340000, UserSpaceSecond) == &g_Descriptors[1]);
+    UNIT_TEST_CHECK(BreakpointIndexFindByPhysicalAddress(Index, 0x5000) == NULL);
+    UNIT_TEST_CHECK(BreakpointIndexFindByPhysicalAddress(Index, 0x9000) == &g_Descriptors[1]);
+    UNIT_TEST_CHECK(Index->CountOfBreakpoints == 3);
+}
+
+int
+main()
+{
+    PBREAKPOINT_INDEX Index = (PBREAKPOINT_INDEX)malloc(sizeof(BREAKPOINT_INDEX));
+
+    if (Index == NULL)
+    {
+        return 1;
+    }
+
+    BreakpointIndexTestAddressSpaces(Index);
+    BreakpointIndexTestBackwardShift(Index);
+    BreakpointIndexTestRandomOperations(Index);
+
+    free(Index);
+
+    return UNIT_TEST_RESULT("breakpoint-index-test");
+}
@@ -0,0 +1,360 @@
+/**
+ * @file cpuid-cache-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the per-core cache of CPUID results
+ * @details CPUID is replayed from a dump of a processor, then the results
+ * of the cache are compared with the dump
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum count of the records of the dump
+ *
+ */
+#define MAXIMUM_CPUID_DUMP_RECORDS 0x400
+
+/**
+ * @brief A leaf and subleaf of the dump
+ *
+ */
+typedef struct _CPUID_DUMP_RECORD
+{
+    UINT32 Leaf;
+    UINT32 Subleaf;
+    INT32  Registers[4];
+
+} CPUID_DUMP_RECORD, *PCPUID_DUMP_RECORD;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+CPUID_DUMP_RECORD g_CpuidDump[MAXIMUM_CPUID_DUMP_RECORDS];
+UINT32            g_CpuidDumpCount;
+UINT32            g_CpuidExecutionCount;
+CPUID_CACHE       g_Cache;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Find the record of a leaf and subleaf in the dump
+ *
+ * @details Like the processor, the subleaf is ignored for the leaves
+ * that don't have subleaves, and the leaves after the last leaf return
+ * the last basic leaf
+ *
+ * @param Leaf
+ * @param Subleaf
+ * @return PCPUID_DUMP_RECORD
+ */
+PCPUID_DUMP_RECORD
+CpuidDumpFind(UINT32 Leaf, UINT32 Subleaf)
+{
+    UINT32 LastBasicLeaf = (UINT32)g_CpuidDump[0].Registers[0];
+
+    Subleaf = CpuidCacheNormalizeSubleaf(Leaf, Subleaf);
+
+    for (UINT32 i = 0; i < g_CpuidDumpCount; i++)
+    {
+        if (g_CpuidDump[i].Leaf == Leaf && g_CpuidDump[i].Subleaf == Subleaf)
+        {
+            return &g_CpuidDump[i];
+        }
+    }
+
+    for (UINT32 i = 0; i < g_CpuidDumpCount; i++)
+    {
+        if (g_CpuidDump[i].Leaf == LastBasicLeaf && g_CpuidDump[i].Subleaf == 0)
+        {
+            return &g_CpuidDump[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Replay CPUID from the dump (used by the cache)
+ *
+ * @param Registers
+ * @param Leaf
+ * @param Subleaf
+ */
+void
+__cpuidex(int Registers[4], int Leaf, int Subleaf)
+{
+    PCPUID_DUMP_RECORD Record = CpuidDumpFind((UINT32)Leaf, (UINT32)Subleaf);
+
+    g_CpuidExecutionCount++;
+
+    if (Record == NULL)
+    {
+        memset(Registers, 0, sizeof(int) * 4);
+        return;
+    }
+
+    memcpy(Registers, Record->Registers, sizeof(int) * 4);
+}
+
+/**
+ * @brief Read a dump in the raw format of the 'cpuid -r' tool
+ *
+ * @param Path
+ * @return BOOLEAN
+ */
+BOOLEAN
+CpuidDumpRead(const char * Path)
+{
+    FILE *   File = fopen(Path, "r");
+    char     Line[0x100];
+    unsigned Leaf, Subleaf, Eax, Ebx, Ecx, Edx;
+
+    if (File == NULL)
+    {
+        printf("err, unable to open '%s'\n", Path);
+        return FALSE;
+    }
+
+    while (fgets(Line, sizeof(Line), File) != NULL && g_CpuidDumpCount < MAXIMUM_CPUID_DUMP_RECORDS)
+    {
+        if (sscanf(Line, " 0x%x 0x%x: eax=0x%x ebx=0x%x ecx=0x%x edx=0x%x", &Leaf, &Subleaf, &Eax, &Ebx, &Ecx, &Edx) != 6)
+        {
+            continue;
+        }
+
+        g_CpuidDump[g_CpuidDumpCount].Leaf         = Leaf;
+        g_CpuidDump[g_CpuidDumpCount].Subleaf      = Subleaf;
+        g_CpuidDump[g_CpuidDumpCount].Registers[0] = (INT32)Eax;
+        g_CpuidDump[g_CpuidDumpCount].Registers[1] = (INT32)Ebx;
+        g_CpuidDump[g_CpuidDumpCount].Registers[2] = (INT32)Ecx;
+        g_CpuidDump[g_CpuidDumpCount].Registers[3] = (INT32)Edx;
+        g_CpuidDumpCount++;
+    }
+
+    fclose(File);
+
+    return g_CpuidDumpCount != 0 && g_CpuidDump[0].Leaf == 0;
+}
+
+/**
+ * @brief Compare the result of the cache with the dump
+ *
+ * @param Leaf
+ * @param Subleaf
+ * @return BOOLEAN
+ */
+BOOLEAN
+CpuidCacheTestCompare(UINT32 Leaf, UINT32 Subleaf)
+{
+    INT32              Registers[4];
+    PCPUID_DUMP_RECORD Record = CpuidDumpFind(Leaf, Subleaf);
+
+    CpuidCacheQuery(&g_Cache, Leaf, Subleaf, Registers);
+
+    return Record != NULL && memcmp(Registers, Record->Registers, sizeof(Registers)) == 0;
+}
+
+/**
+ * @brief Check the prefilled leaves and the leaves that are cached
+ * at the first use
+ *
+ * @return VOID
+ */
+VOID
+CpuidCacheTestReplay()
+{
+    UINT32 ExecutionCount;
+
+    CpuidCacheInitialize(&g_Cache);
+
+    //
+    // All of the prefilled leaves are read from the cache
+    //
+    ExecutionCount = g_CpuidExecutionCount;
+
+    for (UINT32 i = 0; i < g_CpuidDumpCount; i++)
+    {
+        if (g_CpuidDump[i].Subleaf == 0 && CpuidCacheIsLeafCacheable(g_CpuidDump[i].Leaf))
+        {
+            UNIT_TEST_CHECK(CpuidCacheTestCompare(g_CpuidDump[i].Leaf, 0));
+        }
+    }
+
+    UNIT_TEST_CHECK(g_CpuidExecutionCount == ExecutionCount);
+
+    //
+    // The other subleaves are executed once, then they are cached
+    //
+    for (UINT32 i = 0; i < g_CpuidDumpCount; i++)
+    {
+        UNIT_TEST_CHECK(CpuidCacheTestCompare(g_CpuidDump[i].Leaf, g_CpuidDump[i].Subleaf));
+    }
+
+    ExecutionCount = g_CpuidExecutionCount;
+
+    for (UINT32 i = 0; i < g_CpuidDumpCount; i++)
+    {
+        if (CpuidCacheIsLeafCacheable(g_CpuidDump[i].Leaf))
+        {
+            UNIT_TEST_CHECK(CpuidCacheTestCompare(g_CpuidDump[i].Leaf, g_CpuidDump[i].Subleaf));
+        }
+    }
+
+    UNIT_TEST_CHECK(g_CpuidExecutionCount == ExecutionCount);
+}
+
+/**
+ * @brief Check the leaves that are executed each time and the leaves
+ * that ignore the subleaf
+ *
+ * @return VOID
+ */
+VOID
+CpuidCacheTestUncachedAndNormalizedLeaves()
+{
+    INT32  Registers[4];
+    INT32  Expected[4];
+    UINT32 ExecutionCount;
+
+    CpuidCacheInitialize(&g_Cache);
+
+    //
+    // The extended state enumeration depends on XCR0, so it's never cached
+    //
+    ExecutionCount = g_CpuidExecutionCount;
+
+    for (UINT32 i = 0; i < 4; i++)
+    {
+        UNIT_TEST_CHECK(CpuidCacheTestCompare(CPUID_EXTENDED_STATE_ENUMERATION, 1));
+    }
+
+    UNIT_TEST_CHECK(g_CpuidExecutionCount == ExecutionCount + 4);
+
+    //
+    // The leaves without subleaves return the same result for any ECX
+    //
+    ExecutionCount = g_CpuidExecutionCount;
+
+    CpuidCacheQuery(&g_Cache, CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS, 0, Expected);
+    CpuidCacheQuery(&g_Cache, CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS, 0x1234, Registers);
+
+    UNIT_TEST_CHECK(memcmp(Registers, Expected, sizeof(Registers)) == 0);
+    UNIT_TEST_CHECK(g_CpuidExecutionCount == ExecutionCount);
+
+    //
+    // The leaves with subleaves are kept separately
+    //
+    CpuidCacheQuery(&g_Cache, CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 0, Expected);
+    CpuidCacheQuery(&g_Cache, CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 1, Registers);
+
+    UNIT_TEST_CHECK(memcmp(Registers, Expected, sizeof(Registers)) != 0);
+}
+
+/**
+ * @brief Check that the full cache still returns the results of the
+ * processor
+ *
+ * @return VOID
+ */
+VOID
+CpuidCacheTestFullCache()
+{
+    INT32  Registers[4];
+    UINT32 ExecutionCount;
+
+    CpuidCacheInitialize(&g_Cache);
+
+    for (UINT32 Subleaf = 0; Subleaf < CPUID_CACHE_SIZE; Subleaf++)
+    {
+        CpuidCacheQuery(&g_Cache, 0x4, Subleaf, Registers);
+    }
+
+    UNIT_TEST_CHECK(g_Cache.CountOfEntries == CPUID_CACHE_MAXIMUM_ENTRIES);
+
+    //
+    // The leaves that are not in the cache are executed each time
+    //
+    ExecutionCount = g_CpuidExecutionCount;
+
+    UNIT_TEST_CHECK(CpuidCacheTestCompare(0x4, CPUID_CACHE_SIZE + 1));
+    UNIT_TEST_CHECK(CpuidCacheTestCompare(0x4, CPUID_CACHE_SIZE + 1));
+    UNIT_TEST_CHECK(g_CpuidExecutionCount == ExecutionCount + 2);
+
+    //
+    // The prefilled leaves are still in the cache
+    //
+    ExecutionCount = g_CpuidExecutionCount;
+
+    UNIT_TEST_CHECK(CpuidCacheTestCompare(0, 0));
+    UNIT_TEST_CHECK(CpuidCacheTestCompare(CPUID_EXTENDED_FUNCTION_MAXIMUM_AND_IDENTIFIER, 0));
+    UNIT_TEST_CHECK(g_CpuidExecutionCount == ExecutionCount);
+}
+
+/**
+ * @brief Check the bits that reflect the guest's CR4
+ *
+ * @return VOID
+ */
+VOID
+CpuidCacheTestGuestState()
+{
+    INT32              Registers[4];
+    CONTROL_REGISTER_4 Cr4 = {0};
+
+    CpuidCacheInitialize(&g_Cache);
+
+    Cr4.OsXsave = TRUE;
+
+    CpuidCacheQuery(&g_Cache, CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS, 0, Registers);
+    CpuidCacheApplyGuestState(CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS, 0, Registers, Cr4.Flags);
+    UNIT_TEST_CHECK((Registers[2] & CPUID_FEATURE_ECX_OSXSAVE_BIT) != 0);
+
+    CpuidCacheApplyGuestState(CPUID_PROCESSOR_AND_PROCESSOR_FEATURE_IDENTIFIERS, 0, Registers, 0);
+    UNIT_TEST_CHECK((Registers[2] & CPUID_FEATURE_ECX_OSXSAVE_BIT) == 0);
+
+    Cr4.Flags               = 0;
+    Cr4.ProtectionKeyEnable = TRUE;
+
+    CpuidCacheQuery(&g_Cache, CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 0, Registers);
+    CpuidCacheApplyGuestState(CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 0, Registers, Cr4.Flags);
+    UNIT_TEST_CHECK((Registers[2] & CPUID_EXTENDED_FEATURE_ECX_OSPKE_BIT) != 0);
+
+    CpuidCacheApplyGuestState(CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 0, Registers, 0);
+    UNIT_TEST_CHECK((Registers[2] & CPUID_EXTENDED_FEATURE_ECX_OSPKE_BIT) == 0);
+
+    //
+    // The other subleaves are not changed
+    //
+    CpuidCacheQuery(&g_Cache, CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 1, Registers);
+    UNIT_TEST_CHECK(CpuidCacheTestCompare(CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS, 1));
+}
+
+int
+main(int argc, char * argv[])
+{
+    if (!CpuidDumpRead(argc > 1 ? argv[1] : "data/cpuid-dump.txt"))
+    {
+        printf("err, invalid cpuid dump\n");
+        return 1;
+    }
+
+    CpuidCacheTestReplay();
+    CpuidCacheTestUncachedAndNormalizedLeaves();
+    CpuidCacheTestFullCache();
+    CpuidCacheTestGuestState();
+
+    return UNIT_TEST_RESULT("cpuid-cache-test");
+}
@@ -0,0 +1,60 @@
+//
+// Source of pdb-reader-test.pdb, the fixture of pdb-reader-test.cpp
+//
+// The pdb is created by rustc (no_core, so it doesn't need the standard
+// library of Windows) and lld-link:
+//
+//   rustc --crate-name pdb_reader_test --target x86_64-pc-windows-msvc
+//         --crate-type bin -C panic=abort -C opt-level=0 -g --emit obj
+//         -o pdb-reader-test.obj pdb-reader-test.rs
+//   lld-link /nologo /debug /entry:mainCRTStartup /subsystem:console
+//            /nodefaultlib /out:pdb-reader-test.exe
+//            /pdb:pdb-reader-test.pdb pdb-reader-test.obj
+//
+#![feature(no_core, lang_items)]
+#![no_core]
+#![no_main]
+
+#[lang = "sized"] pub trait Sized {}
+#[lang = "copy"] pub trait Copy {}
+#[lang = "pointee_sized"] pub trait PointeeSized {}
+#[lang = "meta_sized"] pub trait MetaSized {}
+#[lang = "freeze"] pub unsafe trait Freeze {}
+#[lang = "sync"] pub unsafe trait Sync {}
+#[lang = "drop_in_place"] pub unsafe fn drop_in_place<T: ?Sized>(_p: *mut T) {}
+
+//
+// Structures of the field tests (the layout is the layout of C)
+//
+#[repr(C)] pub struct Inner { pub x: u32, pub y: u64 }
+#[repr(C)] pub struct Tail { pub p: *const Outer, pub q: u8 }
+#[repr(C)] pub struct Outer { pub a: u8, pub inner: Inner, pub c: u16, pub arr: [u32; 3], pub tail: Tail }
+#[repr(C)] pub union Value { pub low: u32, pub full: u64 }
+#[repr(C)] pub struct Holder { pub flags: u16, pub value: Value, pub outer: Outer, pub next: *const Holder }
+
+//
+// Globals (S_GDATA32 and S_PUB32)
+//
+#[no_mangle] pub static mut GlobalOuter: Outer = Outer { a: 1, inner: Inner { x: 2, y: 3 }, c: 4, arr: [5, 6, 7], tail: Tail { p: 0 as *const Outer, q: 8 } };
+#[no_mangle] pub static mut GlobalHolder: Holder = Holder { flags: 1, value: Value { full: 2 }, outer: Outer { a: 1, inner: Inner { x: 2, y: 3 }, c: 4, arr: [5, 6, 7], tail: Tail { p: 0 as *const Outer, q: 8 } }, next: 0 as *const Holder };
+#[no_mangle] pub static mut KeNumberProcessors: u32 = 1;
+#[no_mangle] pub static mut PsInitialSystemProcess: u64 = 2;
+#[no_mangle] pub static mut PsLoadedModuleList: u64 = 3;
+
+//
+// Functions (S_PUB32)
+//
+#[no_mangle] #[inline(never)] pub extern "C" fn NtCreateFile(a: u64) -> u64 { a }
+#[no_mangle] #[inline(never)] pub extern "C" fn NtCreateProcess(a: u64, b: u64) -> u64 { b }
+#[no_mangle] #[inline(never)] pub extern "C" fn NtCreateThread(a: u64, b: u64, c: u64) -> u64 { c }
+#[no_mangle] #[inline(never)] pub extern "C" fn NtOpenFile(a: u32) -> u32 { a }
+#[no_mangle] #[inline(never)] pub extern "C" fn NtOpenProcess(a: u32, b: u32) -> u32 { b }
+#[no_mangle] #[inline(never)] pub extern "C" fn NtClose(a: u16) -> u16 { a }
+#[no_mangle] #[inline(never)] pub extern "C" fn ExAllocatePool(a: u8) -> u8 { a }
+#[no_mangle] #[inline(never)] pub extern "C" fn ExFreePool(a: u8, b: u8) -> u8 { b }
+#[no_mangle] #[inline(never)] pub extern "C" fn KeBugCheck(a: u64) -> u32 { 0 }
+#[no_mangle] #[inline(never)] pub extern "C" fn KeQueryPerformanceCounter(a: u32) -> u64 { 0 }
+#[no_mangle] #[inline(never)] pub extern "C" fn RtlCopyMemory(a: u64, b: u32) -> u32 { b }
+#[no_mangle] #[inline(never)] pub extern "C" fn RtlZeroMemory(a: u32, b: u64) -> u64 { b }
+#[no_mangle] #[inline(never)] pub extern "C" fn UseHolder(h: *const Holder) -> *const Holder { h }
+#[no_mangle] pub extern "C" fn mainCRTStartup() -> u32 { 0 }
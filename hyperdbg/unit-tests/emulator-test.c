@@ -0,0 +1,324 @@
+/**
+ * @file emulator-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the emulator of the simple memory accesses
+ * @details The instructions are the encodings of GNU as (checked with
+ * objdump), the decoded operands, the accessed addresses and the results
+ * of the registers are compared with the expected values
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Indexes of the general purpose registers in GUEST_REGS
+ *
+ */
+#define RAX  0
+#define RCX  1
+#define RDX  2
+#define RBX  3
+#define RSP  4
+#define RSI  6
+#define RDI  7
+#define R8   8
+#define R9   9
+#define R12  12
+#define R13  13
+#define R14  14
+#define NONE EMULATOR_REGISTER_NONE
+#define RIP  EMULATOR_REGISTER_RIP
+
+/**
+ * @brief An instruction and its expected decoding
+ *
+ */
+typedef struct _EMULATOR_TEST_CASE
+{
+    const char * Name;
+    UINT8        Bytes[EMULATOR_MAXIMUM_INSTRUCTION_LENGTH];
+    UINT8        SizeOfBytes;
+    BOOLEAN      IsSupported;
+    UINT8        Length;
+    UINT8        AccessSize;
+    UINT8        RegisterSize;
+    BOOLEAN      IsWrite;
+    BOOLEAN      IsSignExtended;
+    BOOLEAN      HasImmediate;
+    BOOLEAN      IsHighByteRegister;
+    UINT8        Register;
+    UINT8        BaseRegister;
+    UINT8        IndexRegister;
+    UINT8        Scale;
+    INT64        Displacement;
+    UINT64       Immediate;
+
+} EMULATOR_TEST_CASE, *PEMULATOR_TEST_CASE;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+EMULATOR_TEST_CASE g_TestCases[] = {
+    //
+    // Name, bytes, size, supported, length, access size, register size, write, sign extended,
+    // immediate, high byte, register, base, index, scale, displacement, immediate
+    //
+    {"mov [rax], rbx", {0x48, 0x89, 0x18}, 3, TRUE, 3, 8, 8, TRUE, FALSE, FALSE, FALSE, RBX, RAX, NONE, 1, 0, 0},
+    {"mov [rcx+0x10], edx", {0x89, 0x51, 0x10}, 3, TRUE, 3, 4, 4, TRUE, FALSE, FALSE, FALSE, RDX, RCX, NONE, 1, 0x10, 0},
+    {"mov [rsp+rsi*4-0x80], r9w", {0x66, 0x44, 0x89, 0x4c, 0xb4, 0x80}, 6, TRUE, 6, 2, 2, TRUE, FALSE, FALSE, FALSE, R9, RSP, RSI, 4, -0x80, 0},
+    {"mov [rbx], ah", {0x88, 0x23}, 2, TRUE, 2, 1, 1, TRUE, FALSE, FALSE, TRUE, RAX, RBX, NONE, 1, 0, 0},
+    {"mov [rbx], spl", {0x40, 0x88, 0x23}, 3, TRUE, 3, 1, 1, TRUE, FALSE, FALSE, FALSE, RSP, RBX, NONE, 1, 0, 0},
+    {"mov r12, [r13+r14*8+0x12345678]", {0x4f, 0x8b, 0xa4, 0xf5, 0x78, 0x56, 0x34, 0x12}, 8, TRUE, 8, 8, 8, FALSE, FALSE, FALSE, FALSE, R12, R13, R14, 8, 0x12345678, 0},
+    {"mov eax, [rip+0x100]", {0x8b, 0x05, 0x00, 0x01, 0x00, 0x00}, 6, TRUE, 6, 4, 4, FALSE, FALSE, FALSE, FALSE, RAX, RIP, NONE, 1, 0x100, 0},
+    {"mov cl, [rdx]", {0x8a, 0x0a}, 2, TRUE, 2, 1, 1, FALSE, FALSE, FALSE, FALSE, RCX, RDX, NONE, 1, 0, 0},
+    {"mov byte [rdi], 0x7f", {0xc6, 0x07, 0x7f}, 3, TRUE, 3, 1, 0, TRUE, FALSE, TRUE, FALSE, RAX, RDI, NONE, 1, 0, 0x7f},
+    {"mov qword [rax], -2", {0x48, 0xc7, 0x00, 0xfe, 0xff, 0xff, 0xff}, 7, TRUE, 7, 8, 0, TRUE, FALSE, TRUE, FALSE, RAX, RAX, NONE, 1, 0, 0xfffffffffffffffe},
+    {"mov word [rax+1], 0x1234", {0x66, 0xc7, 0x40, 0x01, 0x34, 0x12}, 6, TRUE, 6, 2, 0, TRUE, FALSE, TRUE, FALSE, RAX, RAX, NONE, 1, 1, 0x1234},
+    {"movzx eax, byte [rbx]", {0x0f, 0xb6, 0x03}, 3, TRUE, 3, 1, 4, FALSE, FALSE, FALSE, FALSE, RAX, RBX, NONE, 1, 0, 0},
+    {"movsx rax, word [rbx]", {0x48, 0x0f, 0xbf, 0x03}, 4, TRUE, 4, 2, 8, FALSE, TRUE, FALSE, FALSE, RAX, RBX, NONE, 1, 0, 0},
+    {"movsxd r8, [rax+rbx*2]", {0x4c, 0x63, 0x04, 0x58}, 4, TRUE, 4, 4, 8, FALSE, TRUE, FALSE, FALSE, R8, RAX, RBX, 2, 0, 0},
+    {"mov eax, [rbx*8+0x1000]", {0x8b, 0x04, 0xdd, 0x00, 0x10, 0x00, 0x00}, 7, TRUE, 7, 4, 4, FALSE, FALSE, FALSE, FALSE, RAX, NONE, RBX, 8, 0x1000, 0},
+    {"ds mov rax, [rsp]", {0x3e, 0x48, 0x8b, 0x04, 0x24}, 5, TRUE, 5, 8, 8, FALSE, FALSE, FALSE, FALSE, RAX, RSP, NONE, 1, 0, 0},
+
+    //
+    // Not supported by the emulator (or truncated)
+    //
+    {"lock add [rax], 1", {0xf0, 0x83, 0x00, 0x01}, 4, FALSE},
+    {"mov eax, fs:[rax]", {0x64, 0x8b, 0x00}, 3, FALSE},
+    {"mov eax, ebx", {0x89, 0xd8}, 2, FALSE},
+    {"add [rax], ebx", {0x01, 0x18}, 2, FALSE},
+    {"movsxd eax, [rax] (without rex.w)", {0x63, 0x00}, 2, FALSE},
+    {"mov byte [rdi], imm8 (truncated)", {0xc6, 0x07}, 2, FALSE},
+    {"mov r12, [r13+r14*8+disp32] (truncated)", {0x4f, 0x8b, 0xa4, 0xf5, 0x78, 0x56}, 6, FALSE},
+};
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Decode the instructions and compare them with the expected decoding
+ *
+ * @return VOID
+ */
+VOID
+TestDecoder()
+{
+    EMULATOR_INSTRUCTION Instruction;
+
+    for (UINT32 i = 0; i < sizeof(g_TestCases) / sizeof(g_TestCases[0]); i++)
+    {
+        PEMULATOR_TEST_CASE TestCase = &g_TestCases[i];
+        BOOLEAN             IsSupported;
+
+        IsSupported = EmulatorDecodeInstruction(TestCase->Bytes, TestCase->SizeOfBytes, &Instruction);
+
+        if (IsSupported != TestCase->IsSupported)
+        {
+            printf("%s: decoded as %s\n", TestCase->Name, IsSupported ? "supported" : "not supported");
+        }
+
+        UNIT_TEST_CHECK(IsSupported == TestCase->IsSupported);
+
+        if (!IsSupported || !TestCase->IsSupported)
+        {
+            continue;
+        }
+
+        UNIT_TEST_CHECK(Instruction.Length == TestCase->Length);
+        UNIT_TEST_CHECK(Instruction.AccessSize == TestCase->AccessSize);
+        UNIT_TEST_CHECK(Instruction.IsWrite == TestCase->IsWrite);
+        UNIT_TEST_CHECK(Instruction.IsSignExtended == TestCase->IsSignExtended);
+        UNIT_TEST_CHECK(Instruction.HasImmediate == TestCase->HasImmediate);
+        UNIT_TEST_CHECK(Instruction.BaseRegister == TestCase->BaseRegister);
+        UNIT_TEST_CHECK(Instruction.IndexRegister == TestCase->IndexRegister);
+        UNIT_TEST_CHECK(Instruction.Displacement == TestCase->Displacement);
+
+        if (TestCase->IndexRegister != NONE)
+        {
+            UNIT_TEST_CHECK(Instruction.Scale == TestCase->Scale);
+        }
+
+        if (TestCase->HasImmediate)
+        {
+            UNIT_TEST_CHECK(Instruction.Immediate == TestCase->Immediate);
+        }
+        else
+        {
+            UNIT_TEST_CHECK(Instruction.RegisterSize == TestCase->RegisterSize);
+            UNIT_TEST_CHECK(Instruction.Register == TestCase->Register);
+            UNIT_TEST_CHECK(Instruction.IsHighByteRegister == TestCase->IsHighByteRegister);
+        }
+    }
+
+    //
+    // The bytes after the maximum length of an instruction are not used
+    //
+    UINT8 LongInstruction[EMULATOR_MAXIMUM_INSTRUCTION_LENGTH + 1] = {0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x89, 0x00, 0x00};
+
+    UNIT_TEST_CHECK(EmulatorDecodeInstruction(LongInstruction, sizeof(LongInstruction), &Instruction) == TRUE);
+    UNIT_TEST_CHECK(Instruction.Length == EMULATOR_MAXIMUM_INSTRUCTION_LENGTH);
+
+    LongInstruction[12] = 0x48;
+    LongInstruction[13] = 0x89;
+    LongInstruction[14] = 0x04;
+
+    UNIT_TEST_CHECK(EmulatorDecodeInstruction(LongInstruction, sizeof(LongInstruction), &Instruction) == FALSE);
+}
+
+/**
+ * @brief Emulate the accesses on the registers of a guest
+ *
+ * @return VOID
+ */
+VOID
+TestAccesses()
+{
+    EMULATOR_INSTRUCTION Instruction;
+    GUEST_REGS           Regs = {0};
+
+    Regs.rax = 0x1111111111111111;
+    Regs.rbx = 0x1000;
+    Regs.rsp = 0x7ff0;
+    Regs.rsi = 3;
+    Regs.r9  = 0xaaaabbbbccccdddd;
+    Regs.r13 = 0x200000;
+    Regs.r14 = 2;
+
+    //
+    // mov [rsp+rsi*4-0x80], r9w
+    //
+    EmulatorDecodeInstruction(g_TestCases[2].Bytes, g_TestCases[2].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK(EmulatorGetMemoryAddress(&Instruction, &Regs, 0) == 0x7ff0 + 3 * 4 - 0x80);
+    UNIT_TEST_CHECK((UINT16)EmulatorGetWriteValue(&Instruction, &Regs) == 0xdddd);
+
+    //
+    // mov [rbx], ah
+    //
+    Regs.rax = 0x1234;
+    EmulatorDecodeInstruction(g_TestCases[3].Bytes, g_TestCases[3].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK((UINT8)EmulatorGetWriteValue(&Instruction, &Regs) == 0x12);
+
+    //
+    // mov r12, [r13+r14*8+0x12345678]
+    //
+    EmulatorDecodeInstruction(g_TestCases[5].Bytes, g_TestCases[5].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK(EmulatorGetMemoryAddress(&Instruction, &Regs, 0) == 0x200000 + 2 * 8 + 0x12345678);
+    EmulatorSetReadValue(&Instruction, &Regs, 0x8877665544332211);
+    UNIT_TEST_CHECK(Regs.r12 == 0x8877665544332211);
+
+    //
+    // mov eax, [rip+0x100] (based on the next instruction, zero extended)
+    //
+    Regs.rax = 0xffffffffffffffff;
+    EmulatorDecodeInstruction(g_TestCases[6].Bytes, g_TestCases[6].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK(EmulatorGetMemoryAddress(&Instruction, &Regs, 0xfffff80000001000) == 0xfffff80000001000 + 6 + 0x100);
+    EmulatorSetReadValue(&Instruction, &Regs, 0xffffffff80000000);
+    UNIT_TEST_CHECK(Regs.rax == 0x80000000);
+
+    //
+    // mov cl, [rdx] (the rest of the register is kept)
+    //
+    Regs.rcx = 0x1122334455667788;
+    EmulatorDecodeInstruction(g_TestCases[7].Bytes, g_TestCases[7].SizeOfBytes, &Instruction);
+    EmulatorSetReadValue(&Instruction, &Regs, 0xee);
+    UNIT_TEST_CHECK(Regs.rcx == 0x11223344556677ee);
+
+    //
+    // mov qword [rax], -2
+    //
+    EmulatorDecodeInstruction(g_TestCases[9].Bytes, g_TestCases[9].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK(EmulatorGetWriteValue(&Instruction, &Regs) == 0xfffffffffffffffe);
+
+    //
+    // movzx eax, byte [rbx] and movsx rax, word [rbx]
+    //
+    Regs.rax = 0xffffffffffffffff;
+    EmulatorDecodeInstruction(g_TestCases[11].Bytes, g_TestCases[11].SizeOfBytes, &Instruction);
+    EmulatorSetReadValue(&Instruction, &Regs, 0x80);
+    UNIT_TEST_CHECK(Regs.rax == 0x80);
+
+    EmulatorDecodeInstruction(g_TestCases[12].Bytes, g_TestCases[12].SizeOfBytes, &Instruction);
+    EmulatorSetReadValue(&Instruction, &Regs, 0x8000);
+    UNIT_TEST_CHECK(Regs.rax == 0xffffffffffff8000);
+
+    //
+    // movsxd r8, [rax+rbx*2]
+    //
+    Regs.rax = 0x10;
+    EmulatorDecodeInstruction(g_TestCases[13].Bytes, g_TestCases[13].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK(EmulatorGetMemoryAddress(&Instruction, &Regs, 0) == 0x10 + 0x1000 * 2);
+    EmulatorSetReadValue(&Instruction, &Regs, 0xfffffffe);
+    UNIT_TEST_CHECK(Regs.r8 == 0xfffffffffffffffe);
+
+    //
+    // mov eax, [rbx*8+0x1000] (without base)
+    //
+    EmulatorDecodeInstruction(g_TestCases[14].Bytes, g_TestCases[14].SizeOfBytes, &Instruction);
+    UNIT_TEST_CHECK(EmulatorGetMemoryAddress(&Instruction, &Regs, 0) == 0x1000 * 8 + 0x1000);
+}
+
+/**
+ * @brief Match the accesses with the data breakpoints of DR7
+ *
+ * @return VOID
+ */
+VOID
+TestDataBreakpoints()
+{
+    UINT64 Addresses[EMULATOR_DEBUG_REGISTERS] = {0x1000, 0x2004, 0x3000, 0x4003};
+    UINT64 Dr7;
+
+    //
+    // DR0: local, write, 1 byte
+    // DR1: global, read/write, 4 bytes
+    // DR2: local, execution (never matches the accesses)
+    // DR3: disabled, read/write, 8 bytes
+    //
+    Dr7 = (1 << 0) | (1 << 3) | (1 << 4) |
+          (1ull << 16) | (0ull << 18) |
+          (3ull << 20) | (3ull << 22) |
+          (0ull << 24) | (0ull << 26) |
+          (3ull << 28) | (2ull << 30);
+
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x1000, 1, TRUE) == 0x1);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x1000, 1, FALSE) == 0);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0xff8, 8, TRUE) == 0);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0xffc, 8, TRUE) == 0x1);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x2007, 1, FALSE) == 0x2);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x2008, 4, FALSE) == 0);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x2002, 2, TRUE) == 0);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x2003, 2, TRUE) == 0x2);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x3000, 8, TRUE) == 0);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x4000, 8, TRUE) == 0);
+
+    //
+    // DR3 enabled, its address is aligned to its length (8 bytes)
+    //
+    Dr7 |= 1 << 6;
+
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x4000, 1, FALSE) == 0x8);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x4007, 1, TRUE) == 0x8);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x4008, 1, TRUE) == 0);
+    UNIT_TEST_CHECK(EmulatorGetDataBreakpoints(Dr7, Addresses, 0x0, 0x5000, TRUE) == 0xb);
+}
+
+int
+main()
+{
+    TestDecoder();
+    TestAccesses();
+    TestDataBreakpoints();
+
+    return UNIT_TEST_RESULT("emulator-test");
+}
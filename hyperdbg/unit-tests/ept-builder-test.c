@@ -0,0 +1,449 @@
+/**
+ * @file ept-builder-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the builder of the identity mapped EPT tables
+ * @details The identity map is built from synthetic MTRR ranges, then
+ * each 2MB region of the map is walked and compared with the memory
+ * type of the MTRR ranges
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the tables that are allocated by the builder
+ *
+ */
+UINT32 g_AllocatedTables;
+
+/**
+ * @brief The allocations fail after this count of tables
+ *
+ */
+UINT32 g_AllocationLimit = (UINT32)-1;
+
+/**
+ * @brief Synthetic MTRR ranges, the MMIO hole below 4GB (UC) with a
+ * frame buffer (WC) in it, a WT region that covers two 2MB pages of
+ * the sixth 1GB region and a WP region that crosses the 40GB boundary
+ *
+ */
+const MTRR_RANGE_DESCRIPTOR g_MemoryRanges[] = {
+    {0xc0000000, 0xffffffff, MEMORY_TYPE_UNCACHEABLE},
+    {0xd0000000, 0xd0ffffff, MEMORY_TYPE_WRITE_COMBINING},
+    {0x140200000, 0x1405fffff, MEMORY_TYPE_WRITE_THROUGH},
+    {0x9ffe00000, 0xa001fffff, MEMORY_TYPE_WRITE_PROTECTED},
+};
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Allocate a table, the physical address is the virtual address
+ * of the table so the tables can be walked by the test
+ *
+ * @param Size
+ * @param PhysicalAddress
+ * @return PVOID
+ */
+PVOID
+EptBuilderTestAllocateTable(SIZE_T Size, UINT64 * PhysicalAddress)
+{
+    PVOID Table;
+
+    if (g_AllocatedTables >= g_AllocationLimit)
+    {
+        return NULL;
+    }
+
+    Table = aligned_alloc(PAGE_SIZE, (Size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+
+    if (Table == NULL)
+    {
+        return NULL;
+    }
+
+    memset(Table, 0, Size);
+
+    g_AllocatedTables++;
+    *PhysicalAddress = (UINT64)Table;
+
+    return Table;
+}
+
+/**
+ * @brief Free the tables of the page table
+ *
+ * @param PageTable
+ * @return VOID
+ */
+VOID
+EptBuilderTestFree(PVMM_EPT_PAGE_TABLE PageTable)
+{
+    while (!IsListEmpty(&PageTable->PML2TablesList))
+    {
+        PLIST_ENTRY Entry = PageTable->PML2TablesList.Flink;
+
+        RemoveEntryList(Entry);
+        free((PUCHAR)Entry - offsetof(VMM_EPT_PML2_TABLE, PML2TablesList));
+    }
+
+    for (UINT32 i = 0; i < VMM_EPT_PML4E_COUNT; i++)
+    {
+        free(PageTable->PML3[i]);
+    }
+
+    free(PageTable);
+}
+
+/**
+ * @brief Build an identity map from the synthetic MTRR ranges
+ *
+ * @param IdentityMapSize
+ * @param Use1GbPages
+ * @param Result
+ * @return PVMM_EPT_PAGE_TABLE
+ */
+PVMM_EPT_PAGE_TABLE
+EptBuilderTestBuild(UINT64 IdentityMapSize, BOOLEAN Use1GbPages, BOOLEAN * Result)
+{
+    EPT_BUILDER_CONFIGURATION Configuration = {0};
+    PVMM_EPT_PAGE_TABLE       PageTable;
+
+    PageTable = aligned_alloc(PAGE_SIZE, (sizeof(VMM_EPT_PAGE_TABLE) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+    memset(PageTable, 0, sizeof(VMM_EPT_PAGE_TABLE));
+
+    Configuration.MemoryRanges         = g_MemoryRanges;
+    Configuration.NumberOfMemoryRanges = sizeof(g_MemoryRanges) / sizeof(g_MemoryRanges[0]);
+    Configuration.IdentityMapSize      = IdentityMapSize;
+    Configuration.Use1GbPages          = Use1GbPages;
+    Configuration.AllocateTable        = EptBuilderTestAllocateTable;
+
+    g_AllocatedTables = 0;
+
+    *Result = EptBuilderBuildIdentityMap(&Configuration, PageTable);
+
+    return PageTable;
+}
+
+/**
+ * @brief The memory type of a 2MB page based on the synthetic MTRR ranges
+ * (computed without the builder)
+ *
+ * @param Address
+ * @return UCHAR
+ */
+UCHAR
+EptBuilderTestExpectedMemoryType(UINT64 Address)
+{
+    UCHAR MemoryType = MEMORY_TYPE_WRITE_BACK;
+
+    if (Address < SIZE_2_MB)
+    {
+        return MEMORY_TYPE_UNCACHEABLE;
+    }
+
+    for (UINT32 i = 0; i < sizeof(g_MemoryRanges) / sizeof(g_MemoryRanges[0]); i++)
+    {
+        if (Address >= g_MemoryRanges[i].PhysicalBaseAddress && Address <= g_MemoryRanges[i].PhysicalEndAddress)
+        {
+            if (g_MemoryRanges[i].MemoryType == MEMORY_TYPE_UNCACHEABLE)
+            {
+                return MEMORY_TYPE_UNCACHEABLE;
+            }
+
+            MemoryType = g_MemoryRanges[i].MemoryType;
+        }
+    }
+
+    return MemoryType;
+}
+
+/**
+ * @brief Walk the page table for an address
+ *
+ * @param PageTable
+ * @param Address
+ * @param MemoryType
+ * @param Is1GbPage
+ * @return UINT64 The translated physical address or -1 if it's not mapped
+ */
+UINT64
+EptBuilderTestTranslate(PVMM_EPT_PAGE_TABLE PageTable, UINT64 Address, UCHAR * MemoryType, BOOLEAN * Is1GbPage)
+{
+    PEPT_PML4_POINTER PML4 = &PageTable->PML4[ADDRMASK_EPT_PML4_INDEX(Address)];
+    PEPT_PML3_POINTER PML3;
+    PEPT_PML3_ENTRY   LargePML3;
+    PEPT_PML2_ENTRY   PML2;
+
+    if (!PML4->ReadAccess)
+    {
+        return (UINT64)-1;
+    }
+
+    PML3      = &((PEPT_PML3_POINTER)((UINT64)PML4->PageFrameNumber * PAGE_SIZE))[ADDRMASK_EPT_PML3_INDEX(Address)];
+    LargePML3 = (PEPT_PML3_ENTRY)PML3;
+
+    if (!PML3->ReadAccess)
+    {
+        return (UINT64)-1;
+    }
+
+    if (LargePML3->LargePage)
+    {
+        *MemoryType = (UCHAR)LargePML3->MemoryType;
+        *Is1GbPage  = TRUE;
+
+        return LargePML3->PageFrameNumber * SIZE_1_GB + (Address & (SIZE_1_GB - 1));
+    }
+
+    PML2 = &((PEPT_PML2_ENTRY)((UINT64)PML3->PageFrameNumber * PAGE_SIZE))[ADDRMASK_EPT_PML2_INDEX(Address)];
+
+    if (!PML2->ReadAccess || !PML2->LargePage)
+    {
+        return (UINT64)-1;
+    }
+
+    *MemoryType = (UCHAR)PML2->MemoryType;
+    *Is1GbPage  = FALSE;
+
+    return PML2->PageFrameNumber * SIZE_2_MB + (Address & (SIZE_2_MB - 1));
+}
+
+/**
+ * @brief Walk all of the 2MB pages of the identity map
+ *
+ * @param PageTable
+ * @param Use1GbPages
+ * @return UINT32 Count of the 1GB regions that are mapped by 1GB pages
+ */
+UINT32
+EptBuilderTestWalk(PVMM_EPT_PAGE_TABLE PageTable, BOOLEAN Use1GbPages)
+{
+    UINT32  CountOf1GbPages = 0;
+    UCHAR   MemoryType;
+    BOOLEAN Is1GbPage;
+    UINT64  Translated;
+
+    for (UINT64 Address = 0; Address < PageTable->IdentityMapSize; Address += SIZE_2_MB)
+    {
+        Translated = EptBuilderTestTranslate(PageTable, Address + 0x123, &MemoryType, &Is1GbPage);
+
+        UNIT_TEST_CHECK(Translated == Address + 0x123);
+        UNIT_TEST_CHECK(MemoryType == EptBuilderTestExpectedMemoryType(Address));
+        UNIT_TEST_CHECK(Use1GbPages || !Is1GbPage);
+
+        if (Is1GbPage && (Address & (SIZE_1_GB - 1)) == 0)
+        {
+            CountOf1GbPages++;
+        }
+    }
+
+    return CountOf1GbPages;
+}
+
+/**
+ * @brief Check the size of the identity map
+ *
+ * @return VOID
+ */
+VOID
+EptBuilderTestIdentityMapSize()
+{
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(0, TRUE, 0) == 64 * SIZE_1_GB);
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(39, TRUE, 0) == SIZE_512_GB);
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(46, TRUE, 0) == 128 * SIZE_512_GB);
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(52, TRUE, 0) == 512 * SIZE_512_GB);
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(20, TRUE, 0) == SIZE_1_GB);
+
+    //
+    // Without 1GB pages, the first 512GB and the RAM are mapped
+    //
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(46, FALSE, 16 * SIZE_1_GB) == SIZE_512_GB);
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(46, FALSE, 700 * SIZE_1_GB) == 2 * SIZE_512_GB);
+    UNIT_TEST_CHECK(EptBuilderGetIdentityMapSize(36, FALSE, 16 * SIZE_1_GB) == 64 * SIZE_1_GB);
+}
+
+/**
+ * @brief Check the memory types of the ranges
+ *
+ * @return VOID
+ */
+VOID
+EptBuilderTestMemoryType()
+{
+    BOOLEAN IsUniform;
+    UINT32  Count = sizeof(g_MemoryRanges) / sizeof(g_MemoryRanges[0]);
+
+    //
+    // The first 2MB is always UC
+    //
+    UNIT_TEST_CHECK(EptBuilderGetMemoryType(g_MemoryRanges, Count, 0, SIZE_2_MB, &IsUniform) == MEMORY_TYPE_UNCACHEABLE);
+    UNIT_TEST_CHECK(IsUniform);
+    EptBuilderGetMemoryType(g_MemoryRanges, Count, 0, SIZE_1_GB, &IsUniform);
+    UNIT_TEST_CHECK(!IsUniform);
+
+    //
+    // UC takes precedence over WC
+    //
+    UNIT_TEST_CHECK(EptBuilderGetMemoryType(g_MemoryRanges, Count, 0xd0000000, SIZE_2_MB, &IsUniform) == MEMORY_TYPE_UNCACHEABLE);
+    UNIT_TEST_CHECK(EptBuilderGetMemoryType(g_MemoryRanges, Count, 3 * SIZE_1_GB, SIZE_1_GB, &IsUniform) == MEMORY_TYPE_UNCACHEABLE);
+    UNIT_TEST_CHECK(IsUniform);
+
+    //
+    // Partially overlapped ranges are not uniform
+    //
+    UNIT_TEST_CHECK(EptBuilderGetMemoryType(g_MemoryRanges, Count, 5 * SIZE_1_GB + SIZE_2_MB, SIZE_2_MB, &IsUniform) == MEMORY_TYPE_WRITE_THROUGH);
+    UNIT_TEST_CHECK(IsUniform);
+    EptBuilderGetMemoryType(g_MemoryRanges, Count, 5 * SIZE_1_GB, SIZE_1_GB, &IsUniform);
+    UNIT_TEST_CHECK(!IsUniform);
+
+    UNIT_TEST_CHECK(EptBuilderGetMemoryType(g_MemoryRanges, Count, 8 * SIZE_1_GB, SIZE_1_GB, &IsUniform) == MEMORY_TYPE_WRITE_BACK);
+    UNIT_TEST_CHECK(IsUniform);
+}
+
+/**
+ * @brief Build and walk the identity map with and without 1GB pages
+ *
+ * @return VOID
+ */
+VOID
+EptBuilderTestIdentityMap()
+{
+    PVMM_EPT_PAGE_TABLE PageTable;
+    BOOLEAN             Result;
+    UINT64              Size = EptBuilderGetIdentityMapSize(46, TRUE, 0);
+
+    //
+    // With 1GB pages, only the first, the sixth, the 40th and the 41st
+    // 1GB regions need PML2 tables
+    //
+    PageTable = EptBuilderTestBuild(Size, TRUE, &Result);
+
+    UNIT_TEST_CHECK(Result);
+    UNIT_TEST_CHECK(g_AllocatedTables == (Size / SIZE_512_GB) + 4);
+    UNIT_TEST_CHECK(EptBuilderTestWalk(PageTable, TRUE) == (Size / SIZE_1_GB) - 4);
+
+    EptBuilderTestFree(PageTable);
+
+    //
+    // Without 1GB pages, each 1GB region has a PML2 table
+    //
+    Size      = EptBuilderGetIdentityMapSize(46, FALSE, 16 * SIZE_1_GB);
+    PageTable = EptBuilderTestBuild(Size, FALSE, &Result);
+
+    UNIT_TEST_CHECK(Result);
+    UNIT_TEST_CHECK(g_AllocatedTables == 1 + (Size / SIZE_1_GB));
+    UNIT_TEST_CHECK(EptBuilderTestWalk(PageTable, FALSE) == 0);
+
+    EptBuilderTestFree(PageTable);
+}
+
+/**
+ * @brief Check that the tables are kept in the page table if an
+ * allocation fails
+ *
+ * @return VOID
+ */
+VOID
+EptBuilderTestAllocationFailure()
+{
+    PVMM_EPT_PAGE_TABLE PageTable;
+    BOOLEAN             Result;
+    UINT32              CountOfTables = 0;
+
+    g_AllocationLimit = 3;
+
+    PageTable = EptBuilderTestBuild(EptBuilderGetIdentityMapSize(46, TRUE, 0), TRUE, &Result);
+
+    UNIT_TEST_CHECK(!Result);
+    UNIT_TEST_CHECK(g_AllocatedTables == 3);
+
+    for (UINT32 i = 0; i < VMM_EPT_PML4E_COUNT; i++)
+    {
+        CountOfTables += PageTable->PML3[i] != NULL;
+    }
+
+    for (PLIST_ENTRY Entry = PageTable->PML2TablesList.Flink; Entry != &PageTable->PML2TablesList; Entry = Entry->Flink)
+    {
+        CountOfTables++;
+    }
+
+    UNIT_TEST_CHECK(CountOfTables == 3);
+
+    EptBuilderTestFree(PageTable);
+
+    g_AllocationLimit = (UINT32)-1;
+}
+
+/**
+ * @brief Split a 1GB page and walk the 2MB pages of it
+ *
+ * @return VOID
+ */
+VOID
+EptBuilderTestSplit()
+{
+    PVMM_EPT_PAGE_TABLE PageTable;
+    PVMM_EPT_PML2_TABLE NewTable;
+    PEPT_PML3_ENTRY     Entry;
+    UINT64              PhysicalAddress = 0;
+    UCHAR               MemoryType;
+    BOOLEAN             Is1GbPage;
+    BOOLEAN             Result;
+
+    PageTable = EptBuilderTestBuild(EptBuilderGetIdentityMapSize(39, TRUE, 0), TRUE, &Result);
+
+    UNIT_TEST_CHECK(Result);
+
+    //
+    // Split the MMIO hole (UC) and the second 1GB region (WB)
+    //
+    for (UINT64 Address = SIZE_1_GB; Address < 4 * SIZE_1_GB; Address += 2 * SIZE_1_GB)
+    {
+        Entry = (PEPT_PML3_ENTRY)&PageTable->PML3[0][ADDRMASK_EPT_PML3_INDEX(Address)];
+
+        UNIT_TEST_CHECK(Entry->LargePage);
+
+        NewTable = EptBuilderTestAllocateTable(sizeof(VMM_EPT_PML2_TABLE), &PhysicalAddress);
+        EptBuilderSplitPml3Entry(Entry, NewTable, PhysicalAddress);
+        InsertHeadList(&PageTable->PML2TablesList, &NewTable->PML2TablesList);
+
+        UNIT_TEST_CHECK(!Entry->LargePage);
+        UNIT_TEST_CHECK(NewTable->Entry == (PEPT_PML3_POINTER)Entry);
+    }
+
+    for (UINT64 Address = SIZE_1_GB; Address < 4 * SIZE_1_GB; Address += 2 * SIZE_1_GB)
+    {
+        for (UINT64 Offset = 0; Offset < SIZE_1_GB; Offset += SIZE_2_MB)
+        {
+            UNIT_TEST_CHECK(EptBuilderTestTranslate(PageTable, Address + Offset, &MemoryType, &Is1GbPage) == Address + Offset);
+            UNIT_TEST_CHECK(!Is1GbPage);
+            UNIT_TEST_CHECK(MemoryType == EptBuilderTestExpectedMemoryType(Address + Offset));
+        }
+    }
+
+    EptBuilderTestFree(PageTable);
+}
+
+int
+main()
+{
+    EptBuilderTestIdentityMapSize();
+    EptBuilderTestMemoryType();
+    EptBuilderTestIdentityMap();
+    EptBuilderTestAllocationFailure();
+    EptBuilderTestSplit();
+
+    return UNIT_TEST_RESULT("ept-builder-test");
+}
@@ -0,0 +1,242 @@
+/**
+ * @file forwarding-bench.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the queues of the output sources
+ * @details The queues are compared with the previous forwarding (each
+ * message is written to each source by the thread that receives the
+ * events), the time is the time of the thread that receives the events
+ * and the sources are a file and a tcp source (a socketpair) that is
+ * read slowly
+ *
+ * Usage: forwarding-bench [messages] [microseconds of each read of the
+ * slow source]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <sys/socket.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The file of the file source
+ *
+ */
+#define BENCH_FILE "build/forwarding-bench.txt"
+
+/**
+ * @brief Size of each read of the slow source
+ *
+ */
+#define BENCH_READ_SIZE 0x1000
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+UINT64                     g_OutputSourceTag = DebuggerOutputSourceTagStartSeed;
+LIST_ENTRY                 g_OutputSources;
+PDEBUGGER_EVENT_FORWARDING g_OutputSourcesIndex[EVENT_FORWARDING_MAXIMUM_SOURCES];
+UINT32                     g_ReadDelay;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result)
+{
+    return FALSE;
+}
+
+int
+CommunicationClientConnectToServer(PCSTR Ip, PCSTR Port, SOCKET * ConnectSocketArg)
+{
+    return 1;
+}
+
+int
+CommunicationClientSendMessage(SOCKET ConnectSocket, const char * sendbuf, int buflen)
+{
+    ssize_t Sent;
+
+    while (buflen != 0)
+    {
+        Sent = send(ConnectSocket, sendbuf, buflen, MSG_NOSIGNAL);
+
+        if (Sent <= 0)
+        {
+            return 1;
+        }
+
+        sendbuf += Sent;
+        buflen -= (int)Sent;
+    }
+
+    return 0;
+}
+
+int
+CommunicationClientShutdownConnection(SOCKET ConnectSocket)
+{
+    shutdown(ConnectSocket, SHUT_RDWR);
+    return 0;
+}
+
+int
+CommunicationClientCleanup(SOCKET ConnectSocket)
+{
+    close(ConnectSocket);
+    return 0;
+}
+
+HANDLE
+NamedPipeClientCreatePipe(LPCSTR PipeName)
+{
+    return NULL;
+}
+
+BOOLEAN
+NamedPipeClientSendMessage(HANDLE PipeHandle, char * BufferToSend, int BufferSize)
+{
+    return FALSE;
+}
+
+VOID
+NamedPipeClientClosePipe(HANDLE PipeHandle)
+{
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Read the slow source until it's closed
+ *
+ * @param Parameter The socket
+ * @return void*
+ */
+void *
+BenchReadThread(void * Parameter)
+{
+    SOCKET Socket = (SOCKET)(UINT64)Parameter;
+    CHAR   Buffer[BENCH_READ_SIZE];
+
+    while (recv(Socket, Buffer, sizeof(Buffer), 0) > 0)
+    {
+        usleep(g_ReadDelay);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Forward the messages to a file and to a slow tcp source
+ *
+ * @param CountOfMessages
+ * @param IsQueued Whether the messages are queued or written by the
+ * caller (as the previous forwarding)
+ * @param Policy The policy of the slow source
+ * @return double Nanoseconds per message
+ */
+double
+BenchRun(UINT32 CountOfMessages, BOOLEAN IsQueued, DEBUGGER_EVENT_FORWARDING_POLICY Policy)
+{
+    DEBUGGER_EVENT_FORWARDING     File        = {};
+    DEBUGGER_EVENT_FORWARDING     Socket      = {};
+    DEBUGGER_GENERAL_EVENT_DETAIL EventDetail = {0};
+    SOCKET                        Sockets[2];
+    pthread_t                     Thread;
+    string                        Message = "the message of the event with a few values: 0x1000 0x2000 0x3000\n";
+    struct timespec               Start, End;
+
+    unlink(BENCH_FILE);
+    socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets);
+    pthread_create(&Thread, NULL, BenchReadThread, (void *)(UINT64)Sockets[1]);
+
+    File.Type            = EVENT_FORWARDING_FILE;
+    File.Handle          = ForwardingCreateOutputSource(EVENT_FORWARDING_FILE, BENCH_FILE, NULL);
+    File.OutputUniqueTag = ForwardingGetNewOutputSourceTag();
+
+    Socket.Type            = EVENT_FORWARDING_TCP;
+    Socket.Policy          = Policy;
+    Socket.Socket          = Sockets[0];
+    Socket.OutputUniqueTag = ForwardingGetNewOutputSourceTag();
+
+    g_OutputSourcesIndex[File.OutputUniqueTag - DebuggerOutputSourceTagStartSeed]   = &File;
+    g_OutputSourcesIndex[Socket.OutputUniqueTag - DebuggerOutputSourceTagStartSeed] = &Socket;
+
+    EventDetail.OutputSourceTags[0] = File.OutputUniqueTag;
+    EventDetail.OutputSourceTags[1] = Socket.OutputUniqueTag;
+
+    if (IsQueued)
+    {
+        ForwardingOpenOutputSource(&File);
+        ForwardingOpenOutputSource(&Socket);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &Start);
+
+    for (UINT32 i = 0; i < CountOfMessages; i++)
+    {
+        if (IsQueued)
+        {
+            ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size());
+        }
+        else
+        {
+            ForwardingWriteToFile(File.Handle, (CHAR *)Message.c_str(), (UINT32)Message.size());
+            ForwardingSendToTcpSocket(Socket.Socket, (CHAR *)Message.c_str(), (UINT32)Message.size());
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &End);
+
+    if (IsQueued)
+    {
+        ForwardingCloseOutputSource(&File);
+        ForwardingCloseOutputSource(&Socket);
+    }
+    else
+    {
+        CloseHandle(File.Handle);
+        close(Sockets[0]);
+    }
+
+    pthread_join(Thread, NULL);
+    close(Sockets[1]);
+
+    return ((End.tv_sec - Start.tv_sec) * 1e9 + (End.tv_nsec - Start.tv_nsec)) / CountOfMessages;
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32 CountOfMessages = argc > 1 ? atoi(argv[1]) : 200000;
+    double DirectTime, BlockTime, DropTime;
+
+    g_ReadDelay = argc > 2 ? atoi(argv[2]) : 50;
+
+    signal(SIGPIPE, SIG_IGN);
+
+    DirectTime = BenchRun(CountOfMessages, FALSE, EVENT_FORWARDING_POLICY_BLOCK);
+    BlockTime  = BenchRun(CountOfMessages, TRUE, EVENT_FORWARDING_POLICY_BLOCK);
+    DropTime   = BenchRun(CountOfMessages, TRUE, EVENT_FORWARDING_POLICY_DROP);
+
+    printf("messages: %u, read delay: %u us, direct writes: %.1f ns, queued (block): %.1f ns, queued (drop): %.1f ns (per message)\n",
+           CountOfMessages,
+           g_ReadDelay,
+           DirectTime,
+           BlockTime,
+           DropTime);
+
+    return 0;
+}
@@ -0,0 +1,654 @@
+/**
+ * @file forwarding-test.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the queues and the writer threads of the output sources
+ * @details The file sources write to the files of the build directory
+ * (and to a fifo that is never read for the writes that block), the tcp
+ * sources write to a socketpair and the namedpipes are replaced by a
+ * write that ignores the cancellation, the timeout of closing the sources
+ * is shortened by the Makefile
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The files of the file sources
+ *
+ */
+#define FORWARDING_TEST_TEXT_FILE   "build/forwarding-test.txt"
+#define FORWARDING_TEST_BINARY_FILE "build/forwarding-test.bin"
+#define FORWARDING_TEST_FIFO        "build/forwarding-test.fifo"
+
+/**
+ * @brief Count of the messages of each test
+ *
+ */
+#define FORWARDING_TEST_MESSAGES 20000
+
+/**
+ * @brief Count of the binary sources that are opened while the events
+ * are forwarded
+ *
+ */
+#define FORWARDING_TEST_OPENS 100
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+UINT64                     g_OutputSourceTag = DebuggerOutputSourceTagStartSeed;
+LIST_ENTRY                 g_OutputSources;
+PDEBUGGER_EVENT_FORWARDING g_OutputSourcesIndex[EVENT_FORWARDING_MAXIMUM_SOURCES];
+
+/**
+ * @brief The namedpipe writes wait for this flag (and ignore the
+ * cancellation)
+ *
+ */
+static volatile BOOLEAN g_ForwardingTestReleasePipe;
+
+/**
+ * @brief Set by the thread that forwards the messages while the
+ * binary source is opened
+ *
+ */
+static volatile BOOLEAN g_ForwardingTestStopForwarding;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result)
+{
+    return FALSE;
+}
+
+int
+CommunicationClientConnectToServer(PCSTR Ip, PCSTR Port, SOCKET * ConnectSocketArg)
+{
+    return 1;
+}
+
+int
+CommunicationClientSendMessage(SOCKET ConnectSocket, const char * sendbuf, int buflen)
+{
+    ssize_t Sent;
+
+    while (buflen != 0)
+    {
+        Sent = send(ConnectSocket, sendbuf, buflen, MSG_NOSIGNAL);
+
+        if (Sent <= 0)
+        {
+            return 1;
+        }
+
+        sendbuf += Sent;
+        buflen -= (int)Sent;
+    }
+
+    return 0;
+}
+
+int
+CommunicationClientShutdownConnection(SOCKET ConnectSocket)
+{
+    shutdown(ConnectSocket, SHUT_RDWR);
+    return 0;
+}
+
+int
+CommunicationClientCleanup(SOCKET ConnectSocket)
+{
+    close(ConnectSocket);
+    return 0;
+}
+
+HANDLE
+NamedPipeClientCreatePipe(LPCSTR PipeName)
+{
+    return NULL;
+}
+
+BOOLEAN
+NamedPipeClientSendMessage(HANDLE PipeHandle, char * BufferToSend, int BufferSize)
+{
+    while (!__atomic_load_n(&g_ForwardingTestReleasePipe, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+
+    return TRUE;
+}
+
+VOID
+NamedPipeClientClosePipe(HANDLE PipeHandle)
+{
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Milliseconds since an arbitrary point
+ *
+ * @return UINT64
+ */
+static UINT64
+ForwardingTestMilliseconds()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1000 + Time.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Initialize a source and add it to the index
+ *
+ * @param Source
+ * @param Type
+ * @param Format
+ * @param Policy
+ * @return VOID
+ */
+static VOID
+ForwardingTestInitializeSource(PDEBUGGER_EVENT_FORWARDING       Source,
+                               DEBUGGER_EVENT_FORWARDING_TYPE   Type,
+                               DEBUGGER_EVENT_FORWARDING_FORMAT Format,
+                               DEBUGGER_EVENT_FORWARDING_POLICY Policy)
+{
+    memset(Source, 0, sizeof(DEBUGGER_EVENT_FORWARDING));
+
+    Source->Type            = Type;
+    Source->Format          = Format;
+    Source->Policy          = Policy;
+    Source->State           = EVENT_FORWARDING_STATE_NOT_OPENED;
+    Source->OutputUniqueTag = ForwardingGetNewOutputSourceTag();
+
+    g_OutputSourcesIndex[Source->OutputUniqueTag - DebuggerOutputSourceTagStartSeed] = Source;
+}
+
+/**
+ * @brief Create the text of a message
+ *
+ * @param Index
+ * @return string
+ */
+static string
+ForwardingTestMessage(UINT32 Index)
+{
+    return "message " + to_string(Index) + " of the event\n";
+}
+
+/**
+ * @brief Read a whole file
+ *
+ * @param Path
+ * @return string
+ */
+static string
+ForwardingTestReadFile(const char * Path)
+{
+    ifstream     File(Path, ios::binary);
+    stringstream Content;
+
+    Content << File.rdbuf();
+
+    return Content.str();
+}
+
+/**
+ * @brief The messages of the events are written to a file in the order
+ * of the events
+ *
+ * @return VOID
+ */
+static VOID
+ForwardingTestFile()
+{
+    DEBUGGER_EVENT_FORWARDING     Source;
+    DEBUGGER_GENERAL_EVENT_DETAIL EventDetail = {0};
+    string                        Expected;
+    string                        Message;
+
+    unlink(FORWARDING_TEST_TEXT_FILE);
+
+    ForwardingTestInitializeSource(&Source, EVENT_FORWARDING_FILE, EVENT_FORWARDING_FORMAT_TEXT, EVENT_FORWARDING_POLICY_BLOCK);
+
+    Source.Handle = ForwardingCreateOutputSource(EVENT_FORWARDING_FILE, FORWARDING_TEST_TEXT_FILE, NULL);
+
+    UNIT_TEST_CHECK(Source.Handle != INVALID_HANDLE_VALUE);
+    UNIT_TEST_CHECK(ForwardingOpenOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED);
+    UNIT_TEST_CHECK(ForwardingOpenOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_ALREADY_OPENED);
+
+    EventDetail.OutputSourceTags[0] = Source.OutputUniqueTag;
+
+    for (UINT32 i = 0; i < FORWARDING_TEST_MESSAGES; i++)
+    {
+        Message = ForwardingTestMessage(i);
+        Expected += Message;
+
+        UNIT_TEST_CHECK(ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size()));
+    }
+
+    UNIT_TEST_CHECK(ForwardingCloseOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_CLOSED);
+    UNIT_TEST_CHECK(ForwardingCloseOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_ALREADY_CLOSED);
+
+    //
+    // The closed sources don't receive the messages
+    //
+    UNIT_TEST_CHECK(!ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size()));
+
+    UNIT_TEST_CHECK(ForwardingTestReadFile(FORWARDING_TEST_TEXT_FILE) == Expected);
+
+    UNIT_TEST_CHECK(Source.Statistics.CountOfQueuedMessages == FORWARDING_TEST_MESSAGES);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfDroppedMessages == 0);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfFailedWrites == 0);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfWrittenBytes == (LONG64)Expected.size());
+    UNIT_TEST_CHECK(Source.Statistics.CountOfWrites <= FORWARDING_TEST_MESSAGES);
+    UNIT_TEST_CHECK(Source.Queue == NULL && Source.WriteBuffer == NULL);
+}
+
+/**
+ * @brief Forward the messages until the test stops it
+ *
+ * @param Parameter The details of the event
+ * @return VOID *
+ */
+static VOID *
+ForwardingTestForwardThread(VOID * Parameter)
+{
+    PDEBUGGER_GENERAL_EVENT_DETAIL EventDetail = (PDEBUGGER_GENERAL_EVENT_DETAIL)Parameter;
+    string                         Message;
+
+    for (UINT32 i = 0; !__atomic_load_n(&g_ForwardingTestStopForwarding, __ATOMIC_ACQUIRE); i++)
+    {
+        Message = ForwardingTestMessage(i);
+
+        ForwardingPerformEventForwarding(EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size());
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Binary sources that are opened while the events are forwarded
+ * start with the header of the stream and contain valid records
+ *
+ * @return VOID
+ */
+static VOID
+ForwardingTestBinaryFile()
+{
+    DEBUGGER_EVENT_FORWARDING     Sources[FORWARDING_TEST_OPENS];
+    DEBUGGER_GENERAL_EVENT_DETAIL EventDetail = {0};
+    pthread_t                     Thread;
+    PDEBUGGER_EVENT_RECORD        Record;
+    vector<CHAR>                  Buffer;
+    UINT64                        CountOfRecords[FORWARDING_TEST_OPENS] = {0};
+    UINT64                        Count;
+    BOOLEAN                       IsHeaderValid = TRUE;
+    BOOLEAN                       IsStreamValid = TRUE;
+    BOOLEAN                       IsCountValid  = TRUE;
+
+    EventDetail.Tag = 0x1000001;
+
+    g_ForwardingTestStopForwarding = FALSE;
+    pthread_create(&Thread, NULL, ForwardingTestForwardThread, &EventDetail);
+
+    for (UINT32 i = 0; i < FORWARDING_TEST_OPENS; i++)
+    {
+        PDEBUGGER_EVENT_FORWARDING Source = &Sources[i];
+
+        unlink(FORWARDING_TEST_BINARY_FILE);
+
+        ForwardingTestInitializeSource(Source, EVENT_FORWARDING_FILE, EVENT_FORWARDING_FORMAT_BINARY, EVENT_FORWARDING_POLICY_BLOCK);
+
+        Source->Handle = ForwardingCreateOutputSource(EVENT_FORWARDING_FILE, FORWARDING_TEST_BINARY_FILE, NULL);
+
+        //
+        // The events are forwarded to the source before it's opened
+        //
+        __atomic_store_n(&EventDetail.OutputSourceTags[0], Source->OutputUniqueTag, __ATOMIC_RELEASE);
+
+        UNIT_TEST_CHECK(ForwardingOpenOutputSource(Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED);
+        usleep(1000);
+        UNIT_TEST_CHECK(ForwardingCloseOutputSource(Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_CLOSED);
+
+        //
+        // The header is the first message of the source
+        //
+        ifstream Stream(FORWARDING_TEST_BINARY_FILE, ios::binary);
+
+        if (!RecordsReadStreamHeader(Stream))
+        {
+            IsHeaderValid = FALSE;
+            continue;
+        }
+
+        Count = 0;
+
+        while (RecordsReadNext(Stream, Buffer, &Record))
+        {
+            string Text((CHAR *)Record + Record->Length - Record->TextLength, Record->TextLength);
+
+            if (Record->Tag != EventDetail.Tag || Text.compare(0, 8, "message ") != 0)
+            {
+                IsStreamValid = FALSE;
+            }
+
+            Count++;
+        }
+
+        if (!Stream.eof())
+        {
+            IsStreamValid = FALSE;
+        }
+
+        CountOfRecords[i] = Count;
+    }
+
+    __atomic_store_n(&g_ForwardingTestStopForwarding, TRUE, __ATOMIC_RELEASE);
+    pthread_join(Thread, NULL);
+
+    //
+    // The messages are counted after they're queued, so the counters are
+    // compared after the last message
+    //
+    for (UINT32 i = 0; i < FORWARDING_TEST_OPENS; i++)
+    {
+        if (CountOfRecords[i] + 1 != (UINT64)Sources[i].Statistics.CountOfQueuedMessages)
+        {
+            IsCountValid = FALSE;
+        }
+    }
+
+    UNIT_TEST_CHECK(IsHeaderValid);
+    UNIT_TEST_CHECK(IsStreamValid);
+    UNIT_TEST_CHECK(IsCountValid);
+}
+
+/**
+ * @brief Read a socket until it's closed
+ *
+ * @param Parameter The socket and the string that receives the bytes
+ * @return VOID *
+ */
+static VOID *
+ForwardingTestReadThread(VOID * Parameter)
+{
+    pair<SOCKET, string *> * Reader = (pair<SOCKET, string *> *)Parameter;
+    CHAR                     Buffer[0x1000];
+    ssize_t                  Length;
+
+    while ((Length = recv(Reader->first, Buffer, sizeof(Buffer), 0)) > 0)
+    {
+        Reader->second->append(Buffer, Length);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief The messages of the events are sent to a tcp source (a
+ * socketpair) in the order of the events
+ *
+ * @return VOID
+ */
+static VOID
+ForwardingTestSocketpair()
+{
+    DEBUGGER_EVENT_FORWARDING     Source;
+    DEBUGGER_GENERAL_EVENT_DETAIL EventDetail = {0};
+    SOCKET                        Sockets[2];
+    pthread_t                     Thread;
+    string                        Expected;
+    string                        Received;
+    string                        Message;
+    pair<SOCKET, string *>        Reader;
+
+    UNIT_TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets) == 0);
+
+    ForwardingTestInitializeSource(&Source, EVENT_FORWARDING_TCP, EVENT_FORWARDING_FORMAT_TEXT, EVENT_FORWARDING_POLICY_BLOCK);
+
+    Source.Socket = Sockets[0];
+    Source.Handle = (HANDLE)TRUE;
+
+    Reader = make_pair(Sockets[1], &Received);
+    pthread_create(&Thread, NULL, ForwardingTestReadThread, &Reader);
+
+    UNIT_TEST_CHECK(ForwardingOpenOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED);
+
+    EventDetail.OutputSourceTags[0] = Source.OutputUniqueTag;
+
+    for (UINT32 i = 0; i < FORWARDING_TEST_MESSAGES; i++)
+    {
+        Message = ForwardingTestMessage(i);
+        Expected += Message;
+
+        UNIT_TEST_CHECK(ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size()));
+    }
+
+    UNIT_TEST_CHECK(ForwardingCloseOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_CLOSED);
+
+    pthread_join(Thread, NULL);
+    close(Sockets[1]);
+
+    UNIT_TEST_CHECK(Received == Expected);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfDroppedMessages == 0);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfWrittenBytes == (LONG64)Expected.size());
+}
+
+/**
+ * @brief A tcp source that is never read drops the messages with the
+ * drop policy and is closed by shutting down the socket after the
+ * timeout
+ *
+ * @return VOID
+ */
+static VOID
+ForwardingTestSocketpairNotRead()
+{
+    DEBUGGER_EVENT_FORWARDING     Source;
+    DEBUGGER_GENERAL_EVENT_DETAIL EventDetail = {0};
+    SOCKET                        Sockets[2];
+    string                        Message(0x1000, 'a');
+    UINT64                        Start;
+    UINT64                        Elapsed;
+
+    UNIT_TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets) == 0);
+
+    ForwardingTestInitializeSource(&Source, EVENT_FORWARDING_TCP, EVENT_FORWARDING_FORMAT_TEXT, EVENT_FORWARDING_POLICY_DROP);
+
+    Source.Socket = Sockets[0];
+    Source.Handle = (HANDLE)TRUE;
+
+    UNIT_TEST_CHECK(ForwardingOpenOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED);
+
+    EventDetail.OutputSourceTags[0] = Source.OutputUniqueTag;
+
+    //
+    // Twice the size of the queue, the caller is never blocked
+    //
+    for (UINT32 i = 0; i < 2 * EVENT_FORWARDING_QUEUE_SIZE / 0x1000; i++)
+    {
+        ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size());
+    }
+
+    UNIT_TEST_CHECK(Source.Statistics.CountOfDroppedMessages != 0);
+
+    Start = ForwardingTestMilliseconds();
+    UNIT_TEST_CHECK(ForwardingCloseOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_CLOSED);
+    Elapsed = ForwardingTestMilliseconds() - Start;
+
+    UNIT_TEST_CHECK(Elapsed >= EVENT_FORWARDING_CLOSE_TIMEOUT && Elapsed < 2 * EVENT_FORWARDING_CLOSE_TIMEOUT);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfFailedWrites != 0);
+    UNIT_TEST_CHECK(Source.Queue == NULL);
+
+    close(Sockets[1]);
+}
+
+/**
+ * @brief The blocked write of a file source (a fifo that is never read)
+ * is canceled after the timeout
+ *
+ * @return VOID
+ */
+static VOID
+ForwardingTestFileNotRead()
+{
+    DEBUGGER_EVENT_FORWARDING     Source;
+    DEBUGGER_GENERAL_EVENT_DETAIL EventDetail = {0};
+    string                        Message(0x1000, 'a');
+    int                           FifoReader;
+    UINT64                        Start;
+    UINT64                        Elapsed;
+
+    unlink(FORWARDING_TEST_FIFO);
+    UNIT_TEST_CHECK(mkfifo(FORWARDING_TEST_FIFO, 0644) == 0);
+
+    FifoReader = open(FORWARDING_TEST_FIFO, O_RDONLY | O_NONBLOCK);
+
+    ForwardingTestInitializeSource(&Source, EVENT_FORWARDING_FILE, EVENT_FORWARDING_FORMAT_TEXT, EVENT_FORWARDING_POLICY_BLOCK);
+
+    Source.Handle = ForwardingCreateOutputSource(EVENT_FORWARDING_FILE, FORWARDING_TEST_FIFO, NULL);
+
+    UNIT_TEST_CHECK(Source.Handle != INVALID_HANDLE_VALUE);
+    UNIT_TEST_CHECK(ForwardingOpenOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED);
+
+    EventDetail.OutputSourceTags[0] = Source.OutputUniqueTag;
+
+    //
+    // More than the fifo takes, but less than the queue
+    //
+    for (UINT32 i = 0; i < EVENT_FORWARDING_QUEUE_SIZE / 0x2000; i++)
+    {
+        UNIT_TEST_CHECK(ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size()));
+    }
+
+    Start = ForwardingTestMilliseconds();
+    UNIT_TEST_CHECK(ForwardingCloseOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_CLOSED);
+    Elapsed = ForwardingTestMilliseconds() - Start;
+
+    UNIT_TEST_CHECK(Elapsed >= EVENT_FORWARDING_CLOSE_TIMEOUT && Elapsed < 2 * EVENT_FORWARDING_CLOSE_TIMEOUT);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfFailedWrites != 0);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfDroppedMessages != 0);
+    UNIT_TEST_CHECK(Source.Queue == NULL);
+
+    close(FifoReader);
+    unlink(FORWARDING_TEST_FIFO);
+}
+
+/**
+ * @brief Release the namedpipe writes after a while, so the test fails
+ * instead of waiting forever for a source that is never closed
+ *
+ * @param Parameter
+ * @return VOID *
+ */
+static VOID *
+ForwardingTestReleasePipeThread(VOID * Parameter)
+{
+    for (UINT32 i = 0; i < 5 * EVENT_FORWARDING_CLOSE_TIMEOUT && !__atomic_load_n(&g_ForwardingTestReleasePipe, __ATOMIC_ACQUIRE); i++)
+    {
+        usleep(1000);
+    }
+
+    __atomic_store_n(&g_ForwardingTestReleasePipe, TRUE, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/**
+ * @brief A write that is not canceled doesn't block closing the source
+ * for more than twice the timeout, the buffers are left to the thread
+ *
+ * @return VOID
+ */
+static VOID
+ForwardingTestWriteNotCanceled()
+{
+    static DEBUGGER_EVENT_FORWARDING Source;
+    DEBUGGER_GENERAL_EVENT_DETAIL    EventDetail = {0};
+    pthread_t                        Thread;
+    string                           Message(0x100, 'a');
+    UINT64                           Start;
+    UINT64                           Elapsed;
+
+    ForwardingTestInitializeSource(&Source, EVENT_FORWARDING_NAMEDPIPE, EVENT_FORWARDING_FORMAT_TEXT, EVENT_FORWARDING_POLICY_BLOCK);
+
+    g_ForwardingTestReleasePipe = FALSE;
+    pthread_create(&Thread, NULL, ForwardingTestReleasePipeThread, NULL);
+
+    UNIT_TEST_CHECK(ForwardingOpenOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_OPENED);
+
+    EventDetail.OutputSourceTags[0] = Source.OutputUniqueTag;
+
+    for (UINT32 i = 0; i < 16; i++)
+    {
+        UNIT_TEST_CHECK(ForwardingPerformEventForwarding(&EventDetail, (CHAR *)Message.c_str(), (UINT32)Message.size()));
+    }
+
+    Start = ForwardingTestMilliseconds();
+    UNIT_TEST_CHECK(ForwardingCloseOutputSource(&Source) == DEBUGGER_OUTPUT_SOURCE_STATUS_SUCCESSFULLY_CLOSED);
+    Elapsed = ForwardingTestMilliseconds() - Start;
+
+    UNIT_TEST_CHECK(Elapsed >= 2 * EVENT_FORWARDING_CLOSE_TIMEOUT && Elapsed < 3 * EVENT_FORWARDING_CLOSE_TIMEOUT);
+    UNIT_TEST_CHECK(Source.WriterThread == NULL);
+    UNIT_TEST_CHECK(Source.Queue != NULL && Source.WriteBuffer != NULL);
+
+    //
+    // The thread finishes the write and exits as the queue is discarded
+    //
+    __atomic_store_n(&g_ForwardingTestReleasePipe, TRUE, __ATOMIC_RELEASE);
+
+    for (UINT32 i = 0; i < 1000 && __atomic_load_n(&Source.Statistics.CountOfWrittenBytes, __ATOMIC_ACQUIRE) == 0; i++)
+    {
+        usleep(1000);
+    }
+
+    UNIT_TEST_CHECK(Source.Statistics.CountOfWrittenBytes == 0x100);
+    UNIT_TEST_CHECK(Source.Statistics.CountOfDroppedMessages == 15);
+    UNIT_TEST_CHECK(Source.QueueSize == 0);
+
+    pthread_join(Thread, NULL);
+}
+
+int
+main()
+{
+    //
+    // The writes to the closed fifos and sockets fail instead of
+    // terminating the test
+    //
+    signal(SIGPIPE, SIG_IGN);
+
+    ForwardingTestFile();
+    ForwardingTestBinaryFile();
+    ForwardingTestSocketpair();
+    ForwardingTestSocketpairNotRead();
+    ForwardingTestFileNotRead();
+    ForwardingTestWriteNotCanceled();
+
+    return UNIT_TEST_RESULT("forwarding-test");
+}
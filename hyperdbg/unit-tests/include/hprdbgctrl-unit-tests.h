@@ -0,0 +1,385 @@
+/**
+ * @file hprdbgctrl-unit-tests.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Definitions of Windows for building the portable modules of
+ * the debugger in the unit tests
+ * @details The pch.h of hprdbgctrl includes this file instead of the
+ * Windows headers when HYPERDBG_UNIT_TESTS is defined, the threads, the
+ * locks and the files are built on POSIX, the routines of the other
+ * modules (e.g., the sockets and the namedpipes) are only declared here
+ * and are implemented by each test
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////
+//					Types   					//
+//////////////////////////////////////////////////
+
+typedef void         VOID, *PVOID, *LPVOID;
+typedef char         CHAR, *PCHAR;
+typedef const char * PCSTR, *LPCSTR;
+typedef uint8_t      UCHAR, BYTE, BOOLEAN, UINT8, *PUCHAR, *PBOOLEAN, *PUINT8;
+typedef int16_t      SHORT, INT16;
+typedef uint16_t     USHORT, WORD, UINT16, *PUINT16;
+typedef int32_t      LONG, INT, INT32, BOOL, *PLONG, *PINT32;
+typedef uint32_t     ULONG, ULONG32, DWORD, UINT, UINT32, *PULONG, *PUINT32, *LPDWORD;
+typedef int64_t      LONGLONG, LONG64, INT64, *PINT64;
+typedef uint64_t     ULONGLONG, ULONG64, DWORD64, UINT64, SIZE_T, ULONG_PTR, *PUINT64, *PSIZE_T;
+typedef void *       HANDLE;
+typedef int          SOCKET;
+
+typedef struct _LIST_ENTRY
+{
+    struct _LIST_ENTRY * Flink;
+    struct _LIST_ENTRY * Blink;
+
+} LIST_ENTRY, *PLIST_ENTRY;
+
+typedef pthread_mutex_t CRITICAL_SECTION, *PCRITICAL_SECTION;
+typedef pthread_cond_t  CONDITION_VARIABLE, *PCONDITION_VARIABLE;
+
+typedef DWORD(*LPTHREAD_START_ROUTINE)(LPVOID Parameter);
+
+#define IN
+#define OUT
+#define WINAPI
+#define TRUE  1
+#define FALSE 0
+
+#define INFINITE              0xffffffff
+#define WAIT_OBJECT_0         0x00000000
+#define WAIT_TIMEOUT          0x00000102
+#define WAIT_FAILED           0xffffffff
+#define INVALID_HANDLE_VALUE  ((HANDLE)(intptr_t)-1)
+#define GENERIC_WRITE         0x40000000
+#define OPEN_ALWAYS           4
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+
+//////////////////////////////////////////////////
+//					Handles   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The object behind a handle of the tests (a thread or a file)
+ *
+ */
+typedef struct _UNIT_TEST_HANDLE
+{
+    BOOLEAN   IsThread;
+    BOOLEAN   IsJoined;
+    pthread_t Thread;
+    int       FileDescriptor;
+
+} UNIT_TEST_HANDLE, *PUNIT_TEST_HANDLE;
+
+/**
+ * @brief The routine of a new thread, it's freed by the thread as the
+ * handle might be closed before the thread starts
+ *
+ */
+typedef struct _UNIT_TEST_THREAD_START
+{
+    LPTHREAD_START_ROUTINE StartRoutine;
+    LPVOID                 Parameter;
+
+} UNIT_TEST_THREAD_START, *PUNIT_TEST_THREAD_START;
+
+//////////////////////////////////////////////////
+//					Routines   					//
+//////////////////////////////////////////////////
+
+#define strnlen_s strnlen
+
+#define InterlockedIncrement64(Target)  __atomic_add_fetch((Target), 1, __ATOMIC_SEQ_CST)
+#define InterlockedAdd64(Target, Value) __atomic_add_fetch((Target), (Value), __ATOMIC_SEQ_CST)
+
+static inline VOID
+InitializeCriticalSection(PCRITICAL_SECTION CriticalSection)
+{
+    pthread_mutexattr_t Attributes;
+
+    //
+    // The critical sections can be entered again by their owner
+    //
+    pthread_mutexattr_init(&Attributes);
+    pthread_mutexattr_settype(&Attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(CriticalSection, &Attributes);
+    pthread_mutexattr_destroy(&Attributes);
+}
+
+static inline VOID
+DeleteCriticalSection(PCRITICAL_SECTION CriticalSection)
+{
+    pthread_mutex_destroy(CriticalSection);
+}
+
+static inline VOID
+EnterCriticalSection(PCRITICAL_SECTION CriticalSection)
+{
+    pthread_mutex_lock(CriticalSection);
+}
+
+static inline VOID
+LeaveCriticalSection(PCRITICAL_SECTION CriticalSection)
+{
+    pthread_mutex_unlock(CriticalSection);
+}
+
+static inline VOID
+InitializeConditionVariable(PCONDITION_VARIABLE ConditionVariable)
+{
+    pthread_cond_init(ConditionVariable, NULL);
+}
+
+static inline VOID
+WakeConditionVariable(PCONDITION_VARIABLE ConditionVariable)
+{
+    pthread_cond_signal(ConditionVariable);
+}
+
+static inline VOID
+WakeAllConditionVariable(PCONDITION_VARIABLE ConditionVariable)
+{
+    pthread_cond_broadcast(ConditionVariable);
+}
+
+/**
+ * @brief Only INFINITE is supported as the callers wait in loops
+ *
+ */
+static inline BOOL
+SleepConditionVariableCS(PCONDITION_VARIABLE ConditionVariable, PCRITICAL_SECTION CriticalSection, DWORD Milliseconds)
+{
+    return pthread_cond_wait(ConditionVariable, CriticalSection) == 0;
+}
+
+static inline VOID *
+UnitTestThreadStart(VOID * Parameter)
+{
+    UNIT_TEST_THREAD_START Start = *(PUNIT_TEST_THREAD_START)Parameter;
+
+    free(Parameter);
+
+    return (VOID *)(uintptr_t)Start.StartRoutine(Start.Parameter);
+}
+
+static inline HANDLE
+CreateThread(PVOID                  ThreadAttributes,
+             SIZE_T                 StackSize,
+             LPTHREAD_START_ROUTINE StartAddress,
+             LPVOID                 Parameter,
+             DWORD                  CreationFlags,
+             LPDWORD                ThreadId)
+{
+    PUNIT_TEST_HANDLE       Handle = (PUNIT_TEST_HANDLE)calloc(1, sizeof(UNIT_TEST_HANDLE));
+    PUNIT_TEST_THREAD_START Start  = (PUNIT_TEST_THREAD_START)malloc(sizeof(UNIT_TEST_THREAD_START));
+
+    if (Handle == NULL || Start == NULL)
+    {
+        free(Handle);
+        free(Start);
+        return NULL;
+    }
+
+    Handle->IsThread    = TRUE;
+    Start->StartRoutine = StartAddress;
+    Start->Parameter    = Parameter;
+
+    if (pthread_create(&Handle->Thread, NULL, UnitTestThreadStart, Start) != 0)
+    {
+        free(Handle);
+        free(Start);
+        return NULL;
+    }
+
+    return Handle;
+}
+
+/**
+ * @brief Only the handles of the threads can be waited
+ *
+ */
+static inline DWORD
+WaitForSingleObject(HANDLE Object, DWORD Milliseconds)
+{
+    PUNIT_TEST_HANDLE Handle = (PUNIT_TEST_HANDLE)Object;
+    struct timespec   Deadline;
+    int               Status;
+
+    if (Handle->IsJoined)
+    {
+        return WAIT_OBJECT_0;
+    }
+
+    if (Milliseconds == INFINITE)
+    {
+        Status = pthread_join(Handle->Thread, NULL);
+    }
+    else
+    {
+        clock_gettime(CLOCK_REALTIME, &Deadline);
+
+        Deadline.tv_sec += Milliseconds / 1000;
+        Deadline.tv_nsec += (long)(Milliseconds % 1000) * 1000000;
+
+        if (Deadline.tv_nsec >= 1000000000)
+        {
+            Deadline.tv_sec += 1;
+            Deadline.tv_nsec -= 1000000000;
+        }
+
+        Status = pthread_timedjoin_np(Handle->Thread, NULL, &Deadline);
+    }
+
+    if (Status == ETIMEDOUT)
+    {
+        return WAIT_TIMEOUT;
+    }
+
+    Handle->IsJoined = Status == 0;
+
+    return Status == 0 ? WAIT_OBJECT_0 : WAIT_FAILED;
+}
+
+static inline VOID
+UnitTestCancelSignalHandler(int Signal)
+{
+}
+
+/**
+ * @brief The blocking write of the thread is interrupted by a signal
+ * without SA_RESTART, so it fails like the canceled writes of Windows
+ *
+ */
+static inline BOOL
+CancelSynchronousIo(HANDLE Thread)
+{
+    PUNIT_TEST_HANDLE Handle = (PUNIT_TEST_HANDLE)Thread;
+    struct sigaction  Action = {};
+
+    Action.sa_handler = UnitTestCancelSignalHandler;
+    sigemptyset(&Action.sa_mask);
+    sigaction(SIGUSR1, &Action, NULL);
+
+    return pthread_kill(Handle->Thread, SIGUSR1) == 0;
+}
+
+static inline HANDLE
+CreateFileA(LPCSTR FileName,
+            DWORD  DesiredAccess,
+            DWORD  ShareMode,
+            PVOID  SecurityAttributes,
+            DWORD  CreationDisposition,
+            DWORD  FlagsAndAttributes,
+            HANDLE TemplateFile)
+{
+    PUNIT_TEST_HANDLE Handle;
+    int               FileDescriptor;
+
+    FileDescriptor = open(FileName, O_WRONLY | O_CREAT, 0644);
+
+    if (FileDescriptor == -1)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    Handle = (PUNIT_TEST_HANDLE)calloc(1, sizeof(UNIT_TEST_HANDLE));
+
+    if (Handle == NULL)
+    {
+        close(FileDescriptor);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    Handle->FileDescriptor = FileDescriptor;
+
+    return Handle;
+}
+
+/**
+ * @brief A write that is interrupted after some of the bytes returns
+ * the count of the written bytes (the callers check it)
+ *
+ */
+static inline BOOL
+WriteFile(HANDLE File, const VOID * Buffer, DWORD NumberOfBytesToWrite, LPDWORD NumberOfBytesWritten, PVOID Overlapped)
+{
+    PUNIT_TEST_HANDLE Handle  = (PUNIT_TEST_HANDLE)File;
+    ssize_t           Written = write(Handle->FileDescriptor, Buffer, NumberOfBytesToWrite);
+
+    if (Written < 0)
+    {
+        *NumberOfBytesWritten = 0;
+        return FALSE;
+    }
+
+    *NumberOfBytesWritten = (DWORD)Written;
+
+    return TRUE;
+}
+
+/**
+ * @brief The threads that are not waited are detached
+ *
+ */
+static inline BOOL
+CloseHandle(HANDLE Object)
+{
+    PUNIT_TEST_HANDLE Handle = (PUNIT_TEST_HANDLE)Object;
+
+    if (Handle->IsThread && !Handle->IsJoined)
+    {
+        pthread_detach(Handle->Thread);
+    }
+    else if (!Handle->IsThread)
+    {
+        close(Handle->FileDescriptor);
+    }
+
+    free(Handle);
+
+    return TRUE;
+}
+
+//////////////////////////////////////////////////
+//				 Headers of HyperDbg			//
+//////////////////////////////////////////////////
+
+using namespace std;
+
+#include "Configuration.h"
+#include "Definition.h"
+#include "communication.h"
+#include "namedpipe.h"
+#include "forwarding.h"
+#include "records.h"
+#include "output-sink.h"
+
+/**
+ * @brief Implemented by the tests that forward the messages
+ *
+ */
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result);
@@ -0,0 +1,298 @@
+/**
+ * @file hprdbghv-unit-tests.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Definitions of the kernel for building the portable modules of
+ * the hypervisor in the unit tests
+ * @details The pch.h of hprdbghv includes this file instead of the WDK
+ * headers when HYPERDBG_UNIT_TESTS is defined, the routines that the
+ * tests replace (e.g., the instructions of the processor) are only
+ * declared here and are implemented by each test
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+//////////////////////////////////////////////////
+//					Types   					//
+//////////////////////////////////////////////////
+
+#define PAGE_SIZE         0x1000
+#define PAGE_SHIFT        12
+#define DECLSPEC_ALIGN(x) __attribute__((aligned(x)))
+
+typedef void     VOID, *PVOID;
+typedef char     CHAR, *PCHAR;
+typedef uint8_t  UCHAR, BYTE, BOOLEAN, UINT8, *PUCHAR, *PBOOLEAN, *PUINT8;
+typedef int16_t  SHORT, INT16;
+typedef uint16_t USHORT, WORD, UINT16, *PUINT16;
+typedef int32_t  LONG, INT, INT32, BOOL, *PLONG, *PINT32;
+typedef uint32_t ULONG, ULONG32, DWORD, UINT, UINT32, *PULONG, *PUINT32;
+typedef int64_t  LONGLONG, LONG64, INT64, *PINT64;
+typedef uint64_t ULONGLONG, ULONG64, DWORD64, UINT64, SIZE_T, ULONG_PTR, *PUINT64, *PSIZE_T;
+typedef void *   HANDLE;
+typedef LONG     NTSTATUS;
+
+typedef struct _LIST_ENTRY
+{
+    struct _LIST_ENTRY * Flink;
+    struct _LIST_ENTRY * Blink;
+
+} LIST_ENTRY, *PLIST_ENTRY;
+
+typedef struct _SLIST_ENTRY
+{
+    struct _SLIST_ENTRY * Next;
+
+} SLIST_ENTRY, *PSLIST_ENTRY;
+
+/**
+ * @brief The head of an interlocked singly linked list, the sequence is
+ * changed by each operation so a compare-exchange of both of the fields
+ * (cmpxchg16b) isn't confused by the entries that are reused (ABA)
+ *
+ */
+typedef union DECLSPEC_ALIGN(16) _SLIST_HEADER
+{
+    struct
+    {
+        PSLIST_ENTRY Next;
+        UINT32       Depth;
+        UINT32       Sequence;
+    } List;
+
+    unsigned __int128 Value;
+
+} SLIST_HEADER, *PSLIST_HEADER;
+
+typedef struct _DISPATCHER_HEADER
+{
+    UINT64 Reserved[3];
+
+} DISPATCHER_HEADER;
+
+typedef struct _IRP *            PIRP;
+typedef struct _DEVICE_OBJECT *  PDEVICE_OBJECT;
+typedef struct _DRIVER_OBJECT *  PDRIVER_OBJECT;
+typedef struct _UNICODE_STRING * PUNICODE_STRING;
+typedef struct _KPROCESS *       PEPROCESS;
+
+#define IN
+#define OUT
+#define UNALIGNED
+#define TRUE  1
+#define FALSE 0
+
+
+//////////////////////////////////////////////////
+//					Routines   					//
+//////////////////////////////////////////////////
+
+#define RtlZeroMemory(Destination, Length)         memset((Destination), 0, (Length))
+#define RtlCopyMemory(Destination, Source, Length) memcpy((Destination), (Source), (Length))
+#define RtlMoveMemory(Destination, Source, Length) memmove((Destination), (Source), (Length))
+#define CONTAINING_RECORD(Address, Type, Field)    ((Type *)((char *)(Address) - offsetof(Type, Field)))
+
+#ifndef min
+#    define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef max
+#    define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+static inline VOID
+InitializeListHead(PLIST_ENTRY ListHead)
+{
+    ListHead->Flink = ListHead->Blink = ListHead;
+}
+
+static inline BOOLEAN
+IsListEmpty(const LIST_ENTRY * ListHead)
+{
+    return ListHead->Flink == ListHead;
+}
+
+static inline VOID
+InsertHeadList(PLIST_ENTRY ListHead, PLIST_ENTRY Entry)
+{
+    Entry->Flink           = ListHead->Flink;
+    Entry->Blink           = ListHead;
+    ListHead->Flink->Blink = Entry;
+    ListHead->Flink        = Entry;
+}
+
+static inline VOID
+InsertTailList(PLIST_ENTRY ListHead, PLIST_ENTRY Entry)
+{
+    Entry->Flink           = ListHead;
+    Entry->Blink           = ListHead->Blink;
+    ListHead->Blink->Flink = Entry;
+    ListHead->Blink        = Entry;
+}
+
+static inline BOOLEAN
+RemoveEntryList(PLIST_ENTRY Entry)
+{
+    Entry->Blink->Flink = Entry->Flink;
+    Entry->Flink->Blink = Entry->Blink;
+
+    return Entry->Flink == Entry->Blink;
+}
+
+#define MemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define InterlockedIncrement(Target)                   __atomic_add_fetch((Target), 1, __ATOMIC_SEQ_CST)
+#define InterlockedDecrement(Target)                   __atomic_sub_fetch((Target), 1, __ATOMIC_SEQ_CST)
+#define InterlockedExchange(Target, Value)             __atomic_exchange_n((Target), (Value), __ATOMIC_SEQ_CST)
+#define InterlockedCompareExchange(Target, Value, Old) __sync_val_compare_and_swap((Target), (Old), (Value))
+#define InterlockedIncrement64                         InterlockedIncrement
+#define InterlockedDecrement64                         InterlockedDecrement
+#define InterlockedExchange64                          InterlockedExchange
+#define InterlockedCompareExchange64                   InterlockedCompareExchange
+#define InterlockedAdd64(Target, Value)                __atomic_add_fetch((Target), (Value), __ATOMIC_SEQ_CST)
+
+static inline BOOLEAN
+InterlockedBitTestAndSet64(volatile LONG64 * Base, LONG64 Bit)
+{
+    return (__atomic_fetch_or(Base, 1LL << Bit, __ATOMIC_SEQ_CST) >> Bit) & 1;
+}
+
+static inline BOOLEAN
+InterlockedBitTestAndReset64(volatile LONG64 * Base, LONG64 Bit)
+{
+    return (__atomic_fetch_and(Base, ~(1LL << Bit), __ATOMIC_SEQ_CST) >> Bit) & 1;
+}
+
+static inline VOID
+InitializeSListHead(PSLIST_HEADER ListHead)
+{
+    ListHead->Value = 0;
+}
+
+static inline USHORT
+ExQueryDepthSList(PSLIST_HEADER ListHead)
+{
+    return (USHORT)__atomic_load_n(&ListHead->List.Depth, __ATOMIC_RELAXED);
+}
+
+static inline PSLIST_ENTRY
+InterlockedPushEntrySList(PSLIST_HEADER ListHead, PSLIST_ENTRY ListEntry)
+{
+    SLIST_HEADER Old, New;
+
+    do
+    {
+        Old.Value         = ListHead->Value;
+        ListEntry->Next   = Old.List.Next;
+        New.List.Next     = ListEntry;
+        New.List.Depth    = Old.List.Depth + 1;
+        New.List.Sequence = Old.List.Sequence + 1;
+    } while (!__sync_bool_compare_and_swap(&ListHead->Value, Old.Value, New.Value));
+
+    return Old.List.Next;
+}
+
+static inline PSLIST_ENTRY
+InterlockedPopEntrySList(PSLIST_HEADER ListHead)
+{
+    SLIST_HEADER Old, New;
+
+    do
+    {
+        Old.Value = ListHead->Value;
+
+        if (Old.List.Next == NULL)
+        {
+            return NULL;
+        }
+
+        //
+        // The entry might be popped by another thread, the memory stays
+        // valid (like the slabs) and the sequence fails the exchange
+        //
+        New.List.Next     = __atomic_load_n(&Old.List.Next->Next, __ATOMIC_RELAXED);
+        New.List.Depth    = Old.List.Depth - 1;
+        New.List.Sequence = Old.List.Sequence + 1;
+    } while (!__sync_bool_compare_and_swap(&ListHead->Value, Old.Value, New.Value));
+
+    return Old.List.Next;
+}
+
+static inline PSLIST_ENTRY
+InterlockedFlushSList(PSLIST_HEADER ListHead)
+{
+    SLIST_HEADER Old, New;
+
+    do
+    {
+        Old.Value         = ListHead->Value;
+        New.List.Next     = NULL;
+        New.List.Depth    = 0;
+        New.List.Sequence = Old.List.Sequence + 1;
+    } while (!__sync_bool_compare_and_swap(&ListHead->Value, Old.Value, New.Value));
+
+    return Old.List.Next;
+}
+
+static inline BOOLEAN
+_BitScanForward(unsigned long * Index, UINT32 Mask)
+{
+    if (Mask == 0)
+    {
+        return FALSE;
+    }
+
+    *Index = __builtin_ctz(Mask);
+
+    return TRUE;
+}
+
+/**
+ * @brief Implemented by the tests that use CPUID
+ *
+ */
+void
+__cpuidex(int Registers[4], int Leaf, int Subleaf);
+
+/**
+ * @brief Implemented by the tests that build the event records
+ *
+ */
+ULONG
+KeGetCurrentProcessorNumber();
+
+HANDLE
+PsGetCurrentProcessId();
+
+HANDLE
+PsGetCurrentThreadId();
+
+//////////////////////////////////////////////////
+//				 Headers of HyperDbg			//
+//////////////////////////////////////////////////
+
+#include "Definition.h"
+#include "Configuration.h"
+#include "MemoryMapper.h"
+#include "Common.h"
+#include "CpuidCache.h"
+#include "EmulatorDecoder.h"
+#include "Emulator.h"
+#include "Ept.h"
+#include "EptBuilder.h"
+#include "SlabAllocator.h"
+#include "LoggingRecords.h"
+#include "SearchEngine.h"
+#include "AhoCorasick.h"
+#include "BreakpointIndex.h"
+#include "TransparencyCache.h"
@@ -0,0 +1,52 @@
+/**
+ * @file symbol-parser-unit-tests.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Definitions of Windows for building the portable modules of
+ * the symbol parser in the unit tests
+ * @details The pch.h of symbol-parser includes this file instead of the
+ * Windows and DbgHelp headers when HYPERDBG_UNIT_TESTS is defined
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////
+//					Types   					//
+//////////////////////////////////////////////////
+
+typedef void     VOID, *PVOID;
+typedef char     CHAR, *PCHAR;
+typedef uint8_t  UCHAR, BOOLEAN, *PBOOLEAN;
+typedef uint32_t ULONG, DWORD, UINT32, *PUINT32;
+typedef uint64_t ULONG64, DWORD64, UINT64, *PUINT64;
+
+#define TRUE       1
+#define FALSE      0
+#define _MAX_FNAME 256
+
+//////////////////////////////////////////////////
+//					Routines   					//
+//////////////////////////////////////////////////
+
+#define RtlZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+
+//////////////////////////////////////////////////
+//				 Headers of HyperDbg			//
+//////////////////////////////////////////////////
+
+using namespace std;
+
+#include "pdb-reader.h"
+#include "symbol-lookup.h"
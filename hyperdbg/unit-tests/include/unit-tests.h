@@ -0,0 +1,52 @@
+/**
+ * @file unit-tests.h
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Checks of the unit tests
+ * @details Each test is a separate program that returns zero if all of
+ * its checks are passed
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#pragma once
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the failed checks of the current test
+ *
+ */
+static unsigned int g_UnitTestFailedChecks;
+
+//////////////////////////////////////////////////
+//					Checks   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Check a condition and show the location if it's not true
+ *
+ */
+#define UNIT_TEST_CHECK(Condition)                                                    \
+    do                                                                                \
+    {                                                                                 \
+        if (!(Condition))                                                             \
+        {                                                                             \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition);      \
+            __atomic_add_fetch(&g_UnitTestFailedChecks, 1, __ATOMIC_RELAXED);        \
+        }                                                                             \
+    } while (0)
+
+/**
+ * @brief Show the result of the test and return the exit code of it
+ *
+ */
+#define UNIT_TEST_RESULT(Name)                                                        \
+    (printf("%s: %s\n", (Name), g_UnitTestFailedChecks == 0 ? "passed" : "FAILED"), \
+     g_UnitTestFailedChecks == 0 ? 0 : 1)
@@ -0,0 +1,221 @@
+/**
+ * @file output-sink-bench.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the buffered output of ShowMessages
+ * @details The output of 'u' (14 messages for each instruction by the
+ * formats of DisassembleBuffer) is shown with and without the buffering
+ * (the previous ShowMessages delivered each message), the packets are
+ * sent to a socketpair that is read by another thread (as the remote
+ * debugger) and the time is the time of the command
+ *
+ * Usage: output-sink-bench [instructions] [rounds]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <stdarg.h>
+#include <sys/socket.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Size of each read of the remote debugger
+ *
+ */
+#define BENCH_READ_SIZE 0x10000
+
+/**
+ * @brief Padding of the bytes of the instructions (as DisassembleBuffer)
+ *
+ */
+#define BENCH_PADDING_LENGTH 12
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+BOOLEAN                  g_OutputBuffering = TRUE;
+thread_local OUTPUT_SINK g_OutputSink      = {0};
+OUTPUT_SINK_STATISTICS   g_OutputSinkStatistics;
+int                      g_Sockets[2];
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+VOID
+ShowMessagesDeliver(char * Message, UINT32 Length)
+{
+    ssize_t Sent;
+
+    InterlockedIncrement64(&g_OutputSinkStatistics.CountOfPackets);
+    InterlockedAdd64(&g_OutputSinkStatistics.CountOfBytes, Length);
+
+    //
+    // Like RemoteConnectionSendResultsToHost
+    //
+    while (Length != 0)
+    {
+        Sent = send(g_Sockets[0], Message, Length, MSG_NOSIGNAL);
+
+        if (Sent <= 0)
+        {
+            return;
+        }
+
+        Message += Sent;
+        Length -= (UINT32)Sent;
+    }
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the current time in nanoseconds
+ *
+ * @return double
+ */
+static double
+BenchNow()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+/**
+ * @brief Format and show a message (as ShowMessages)
+ *
+ * @param Fmt
+ * @return VOID
+ */
+static VOID
+BenchShow(const char * Fmt, ...)
+{
+    va_list ArgList;
+    char    TempMessage[PacketChunkSize] = {0};
+
+    va_start(ArgList, Fmt);
+    int sprintfresult = vsprintf(TempMessage, Fmt, ArgList);
+    va_end(ArgList);
+
+    if (sprintfresult > 0)
+    {
+        ShowMessagesOutput(TempMessage, sprintfresult);
+    }
+}
+
+/**
+ * @brief Read the packets as the remote debugger
+ *
+ * @param Parameter
+ * @return VOID *
+ */
+static VOID *
+BenchRemoteDebugger(VOID * Parameter)
+{
+    char * Buffer = (char *)malloc(BENCH_READ_SIZE);
+
+    while (recv(g_Sockets[1], Buffer, BENCH_READ_SIZE, 0) > 0)
+        ;
+
+    free(Buffer);
+
+    return NULL;
+}
+
+/**
+ * @brief Show the output of 'u' for the instructions
+ *
+ * @param CountOfInstructions
+ * @return VOID
+ */
+static VOID
+BenchDisassemble(UINT32 CountOfInstructions)
+{
+    UINT64 Address = 0xfffff80112340000;
+    UINT32 Length;
+
+    ShowMessagesStartCommand();
+
+    for (UINT32 i = 0; i < CountOfInstructions; i++)
+    {
+        Length = 1 + (i * 7) % 8;
+
+        BenchShow("%08x`%08x   ", (UINT32)(Address >> 32), (UINT32)Address);
+
+        for (UINT32 j = 0; j < Length; j++)
+        {
+            BenchShow(" %02X", (UCHAR)(Address + j));
+        }
+
+        for (UINT32 j = 0; j < BENCH_PADDING_LENGTH - Length; j++)
+        {
+            BenchShow("   ");
+        }
+
+        BenchShow(" %s\n", "mov qword ptr ss:[rsp+0x08], rbx");
+
+        Address += Length;
+    }
+
+    ShowMessagesFinishCommand();
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32    CountOfInstructions = argc > 1 ? atoi(argv[1]) : 1000;
+    UINT32    Rounds              = argc > 2 ? atoi(argv[2]) : 100;
+    pthread_t RemoteDebugger;
+    double    Start;
+    double    Time;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, g_Sockets) != 0 ||
+        pthread_create(&RemoteDebugger, NULL, BenchRemoteDebugger, NULL) != 0)
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        g_OutputBuffering = i == 1;
+
+        memset((void *)&g_OutputSinkStatistics, 0, sizeof(g_OutputSinkStatistics));
+
+        Start = BenchNow();
+
+        for (UINT32 j = 0; j < Rounds; j++)
+        {
+            BenchDisassemble(CountOfInstructions);
+        }
+
+        Time = (BenchNow() - Start) / Rounds;
+
+        printf("u of %u instructions, %-10s %8.1f us, messages: %6lld, packets: %6lld, bytes: %7lld\n",
+               CountOfInstructions,
+               g_OutputBuffering ? "buffered:" : "each call:",
+               Time / 1e3,
+               (long long)g_OutputSinkStatistics.CountOfMessages / Rounds,
+               (long long)g_OutputSinkStatistics.CountOfPackets / Rounds,
+               (long long)g_OutputSinkStatistics.CountOfBytes / Rounds);
+    }
+
+    shutdown(g_Sockets[0], SHUT_RDWR);
+    pthread_join(RemoteDebugger, NULL);
+    close(g_Sockets[0]);
+    close(g_Sockets[1]);
+
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file output-sink-test.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the buffered output of ShowMessages
+ * @details The delivered packets are kept by the test instead of being
+ * sent to the remote debugger, the buffer is checked to be delivered on
+ * the newline threshold, a full buffer and the end of each (nested)
+ * command without changing the delivered bytes
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+BOOLEAN                  g_OutputBuffering = TRUE;
+thread_local OUTPUT_SINK g_OutputSink      = {0};
+OUTPUT_SINK_STATISTICS   g_OutputSinkStatistics;
+
+/**
+ * @brief The delivered packets
+ *
+ */
+static vector<string> g_OutputSinkTestPackets;
+
+/**
+ * @brief Shows a message while the next packet is delivered (like the
+ * errors of sending the packet)
+ *
+ */
+static BOOLEAN g_OutputSinkTestShowWhileDelivering;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+VOID
+ShowMessagesDeliver(char * Message, UINT32 Length)
+{
+    UNIT_TEST_CHECK(strlen(Message) == Length);
+
+    g_OutputSinkTestPackets.push_back(string(Message, Length));
+
+    if (g_OutputSinkTestShowWhileDelivering)
+    {
+        char Error[] = "err, unable to send the packet\n";
+
+        g_OutputSinkTestShowWhileDelivering = FALSE;
+
+        ShowMessagesOutput(Error, sizeof(Error) - 1);
+    }
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Show a message like ShowMessages
+ *
+ * @param Message
+ * @return VOID
+ */
+static VOID
+OutputSinkTestShow(const char * Message)
+{
+    char Buffer[PacketChunkSize];
+
+    strcpy(Buffer, Message);
+
+    ShowMessagesOutput(Buffer, (UINT32)strlen(Buffer));
+}
+
+/**
+ * @brief Join the delivered packets
+ *
+ * @return string
+ */
+static string
+OutputSinkTestDelivered()
+{
+    string Result;
+
+    for (const string & Packet : g_OutputSinkTestPackets)
+    {
+        Result += Packet;
+    }
+
+    return Result;
+}
+
+/**
+ * @brief The messages outside of the commands and the messages when the
+ * buffering is disabled are delivered immediately
+ *
+ * @return VOID
+ */
+static VOID
+OutputSinkTestImmediate()
+{
+    g_OutputSinkTestPackets.clear();
+
+    OutputSinkTestShow("kernel message\n");
+    OutputSinkTestShow("no newline");
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 2);
+
+    g_OutputBuffering = FALSE;
+
+    ShowMessagesStartCommand();
+    OutputSinkTestShow("first\n");
+    OutputSinkTestShow("second\n");
+    ShowMessagesFinishCommand();
+
+    g_OutputBuffering = TRUE;
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 4);
+    UNIT_TEST_CHECK(OutputSinkTestDelivered() == "kernel message\nno newlinefirst\nsecond\n");
+}
+
+/**
+ * @brief The lines of a command are delivered on the newline threshold
+ * and the end of the command
+ *
+ * @return VOID
+ */
+static VOID
+OutputSinkTestNewlines()
+{
+    string Expected;
+    char   Line[64];
+
+    g_OutputSinkTestPackets.clear();
+
+    ShowMessagesStartCommand();
+
+    for (UINT32 i = 0; i < OUTPUT_SINK_NEWLINE_THRESHOLD * 2 + 5; i++)
+    {
+        //
+        // A line is made of a few messages (like the bytes of 'u')
+        //
+        snprintf(Line, sizeof(Line), "fffff801`%08x ", i);
+        OutputSinkTestShow(Line);
+        Expected += Line;
+
+        OutputSinkTestShow("48 89 5c 24 08 ");
+        Expected += "48 89 5c 24 08 ";
+
+        OutputSinkTestShow("mov qword ptr [rsp+0x8], rbx\n");
+        Expected += "mov qword ptr [rsp+0x8], rbx\n";
+
+        if (i == OUTPUT_SINK_NEWLINE_THRESHOLD - 2)
+        {
+            UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 0);
+        }
+    }
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 2);
+
+    ShowMessagesFinishCommand();
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 3);
+    UNIT_TEST_CHECK(OutputSinkTestDelivered() == Expected);
+    UNIT_TEST_CHECK(g_OutputSink.Size == 0 && g_OutputSink.CountOfNewlines == 0);
+}
+
+/**
+ * @brief A full buffer is delivered before it overflows
+ *
+ * @return VOID
+ */
+static VOID
+OutputSinkTestFullBuffer()
+{
+    string Expected;
+    char   Message[1000];
+
+    g_OutputSinkTestPackets.clear();
+
+    memset(Message, 'a', sizeof(Message) - 1);
+    Message[sizeof(Message) - 1] = '\0';
+
+    ShowMessagesStartCommand();
+
+    for (UINT32 i = 0; i < 10; i++)
+    {
+        OutputSinkTestShow(Message);
+        Expected += Message;
+    }
+
+    ShowMessagesFinishCommand();
+
+    for (const string & Packet : g_OutputSinkTestPackets)
+    {
+        UNIT_TEST_CHECK(Packet.size() < PacketChunkSize);
+    }
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 4);
+    UNIT_TEST_CHECK(OutputSinkTestDelivered() == Expected);
+}
+
+/**
+ * @brief Nested commands deliver their output when they finish and the
+ * messages that are shown while delivering are not buffered
+ *
+ * @return VOID
+ */
+static VOID
+OutputSinkTestNested()
+{
+    g_OutputSinkTestPackets.clear();
+
+    ShowMessagesStartCommand();
+    OutputSinkTestShow("outer\n");
+
+    ShowMessagesStartCommand();
+    OutputSinkTestShow("inner\n");
+    ShowMessagesFinishCommand();
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 1);
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets[0] == "outer\ninner\n");
+
+    g_OutputSinkTestShowWhileDelivering = TRUE;
+
+    OutputSinkTestShow("last\n");
+    ShowMessagesFinishCommand();
+
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets.size() == 3);
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets[1] == "last\n");
+    UNIT_TEST_CHECK(g_OutputSinkTestPackets[2] == "err, unable to send the packet\n");
+    UNIT_TEST_CHECK(g_OutputSink.CommandDepth == 0 && g_OutputSink.Size == 0);
+}
+
+int
+main()
+{
+    OutputSinkTestImmediate();
+    OutputSinkTestNewlines();
+    OutputSinkTestFullBuffer();
+    OutputSinkTestNested();
+
+    return UNIT_TEST_RESULT("output-sink-test");
+}
@@ -0,0 +1,305 @@
+/**
+ * @file pdb-reader-bench.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the native reader of pdb files
+ * @details The pdb file is copied to the build directory and loaded twice,
+ * once by parsing the streams of the symbols (and saving the index file)
+ * and once from the saved index file, then the lookups of the names (the
+ * hash table) and the rvas (the sorted symbols) are compared with walking
+ * all the symbols (as enumerating the symbols and comparing each of them),
+ * the enumeration of a mask is also measured
+ *
+ * Usage: pdb-reader-bench [pdb file] [lookups]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <strings.h>
+#include <time.h>
+#include <vector>
+
+#include "pdb-reader.h"
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The copy of the pdb file that is opened (the index file is
+ * saved next to it)
+ *
+ */
+#define BENCH_PDB_FILE "build/pdb-reader-bench.pdb"
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The symbols of the pdb file
+ *
+ */
+static std::vector<PDB_READER_SYMBOL> g_BenchSymbols;
+
+/**
+ * @brief Count of the found symbols
+ *
+ */
+static uint64_t g_Found;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the current time in nanoseconds
+ *
+ * @return double
+ */
+static double
+BenchNow()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+/**
+ * @brief Keep the enumerated symbols
+ *
+ * @param Symbol
+ * @param Context
+ * @return void
+ */
+static void
+BenchEnumerateCallback(const PDB_READER_SYMBOL * Symbol, void * Context)
+{
+    g_BenchSymbols.push_back(*Symbol);
+}
+
+/**
+ * @brief Count the enumerated symbols
+ *
+ * @param Symbol
+ * @param Context
+ * @return void
+ */
+static void
+BenchCountCallback(const PDB_READER_SYMBOL * Symbol, void * Context)
+{
+    g_Found++;
+}
+
+/**
+ * @brief Open the pdb file and look up a symbol (the symbols are parsed
+ * on the first lookup)
+ *
+ * @param Name
+ * @return double Nanoseconds
+ */
+static double
+BenchLoad(const char * Name)
+{
+    double      Start = BenchNow();
+    PPDB_READER Reader;
+    uint32_t    Rva;
+
+    Reader = PdbReaderOpen(BENCH_PDB_FILE);
+
+    if (Reader == NULL || !PdbReaderFindSymbolByName(Reader, Name, &Rva))
+    {
+        printf("err, unable to load the symbols\n");
+    }
+
+    PdbReaderClose(Reader);
+
+    return BenchNow() - Start;
+}
+
+/**
+ * @brief Find a symbol by its name by walking the symbols
+ *
+ * @param Name
+ * @param Rva
+ * @return bool
+ */
+static bool
+BenchWalkFindByName(const char * Name, uint32_t * Rva)
+{
+    for (const PDB_READER_SYMBOL & Symbol : g_BenchSymbols)
+    {
+        if (strcasecmp(Symbol.Name, Name) == 0)
+        {
+            *Rva = Symbol.Rva;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Find the symbol that contains an rva by walking the symbols
+ *
+ * @param Rva
+ * @return const PDB_READER_SYMBOL *
+ */
+static const PDB_READER_SYMBOL *
+BenchWalkFindByRva(uint32_t Rva)
+{
+    const PDB_READER_SYMBOL * Result = NULL;
+
+    for (const PDB_READER_SYMBOL & Symbol : g_BenchSymbols)
+    {
+        if (Symbol.Rva <= Rva && (Result == NULL || Symbol.Rva > Result->Rva))
+        {
+            Result = &Symbol;
+        }
+    }
+
+    return Result;
+}
+
+int
+main(int argc, char * argv[])
+{
+    const char * PdbFileName    = argc > 1 ? argv[1] : "data/pdb-reader-test.pdb";
+    uint32_t     CountOfLookups = argc > 2 ? atoi(argv[2]) : 1000000;
+    uint32_t     Random         = 0x13579bdf;
+    uint32_t     CountOfWalks;
+    uint32_t     Rva;
+    uint32_t     Displacement;
+    PPDB_READER  Reader;
+    double       Start, FirstLoad, IndexLoad, WalkName, HashName, WalkRva, SortedRva, Mask;
+
+    {
+        std::ifstream Source(PdbFileName, std::ios::binary);
+        std::ofstream Destination(BENCH_PDB_FILE, std::ios::binary);
+
+        Destination << Source.rdbuf();
+    }
+
+    Reader = PdbReaderOpen(BENCH_PDB_FILE);
+
+    if (Reader == NULL || PdbReaderEnumerateSymbols(Reader, NULL, BenchEnumerateCallback, NULL) == 0)
+    {
+        printf("err, unable to read the symbols of %s\n", PdbFileName);
+        return 1;
+    }
+
+    //
+    // Loading the symbols without and with the index file
+    //
+    remove(BENCH_PDB_FILE PDB_READER_INDEX_FILE_EXTENSION);
+
+    FirstLoad = BenchLoad(g_BenchSymbols.back().Name);
+    IndexLoad = BenchLoad(g_BenchSymbols.back().Name);
+
+    //
+    // Walking the symbols is slow on large pdb files, so it's done for
+    // fewer lookups
+    //
+    CountOfWalks = (uint32_t)(CountOfLookups / (g_BenchSymbols.size() / 16 + 1)) + 1;
+
+    //
+    // Names
+    //
+    g_Found = 0;
+    Start   = BenchNow();
+
+    for (uint32_t i = 0; i < CountOfWalks; i++)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        g_Found += BenchWalkFindByName(g_BenchSymbols[Random % g_BenchSymbols.size()].Name, &Rva);
+    }
+
+    WalkName = (BenchNow() - Start) / CountOfWalks;
+    Start    = BenchNow();
+
+    for (uint32_t i = 0; i < CountOfLookups; i++)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        g_Found += PdbReaderFindSymbolByName(Reader, g_BenchSymbols[Random % g_BenchSymbols.size()].Name, &Rva);
+    }
+
+    HashName = (BenchNow() - Start) / CountOfLookups;
+
+    if (g_Found != (uint64_t)CountOfWalks + CountOfLookups)
+    {
+        printf("err, the names are not found\n");
+    }
+
+    //
+    // Rvas (inside the symbols)
+    //
+    g_Found = 0;
+    Start   = BenchNow();
+
+    for (uint32_t i = 0; i < CountOfWalks; i++)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        g_Found += BenchWalkFindByRva(g_BenchSymbols[Random % g_BenchSymbols.size()].Rva + 4) != NULL;
+    }
+
+    WalkRva = (BenchNow() - Start) / CountOfWalks;
+    Start   = BenchNow();
+
+    for (uint32_t i = 0; i < CountOfLookups; i++)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        g_Found += PdbReaderFindSymbolByRva(Reader, g_BenchSymbols[Random % g_BenchSymbols.size()].Rva + 4, &Displacement) != NULL;
+    }
+
+    SortedRva = (BenchNow() - Start) / CountOfLookups;
+
+    if (g_Found != (uint64_t)CountOfWalks + CountOfLookups)
+    {
+        printf("err, the rvas are not found\n");
+    }
+
+    //
+    // A mask ('x nt!Nt*')
+    //
+    g_Found = 0;
+    Start   = BenchNow();
+
+    PdbReaderEnumerateSymbols(Reader, "Nt*", BenchCountCallback, NULL);
+
+    Mask = BenchNow() - Start;
+
+    printf("%zu symbols  load: streams %.2f ms, index %.2f ms  name: walk %.1f ns, hash %.1f ns  rva: walk %.1f ns, sorted %.1f ns  'Nt*': %.2f ms (%llu symbols)\n",
+           g_BenchSymbols.size(),
+           FirstLoad / 1e6,
+           IndexLoad / 1e6,
+           WalkName,
+           HashName,
+           WalkRva,
+           SortedRva,
+           Mask / 1e6,
+           (unsigned long long)g_Found);
+
+    PdbReaderClose(Reader);
+
+    return 0;
+}
@@ -0,0 +1,432 @@
+/**
+ * @file pdb-reader-test.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the native reader of pdb files
+ * @details The fixture (data/pdb-reader-test.pdb) is created by a real
+ * linker from data/pdb-reader-test.rs, the expected addresses and the
+ * layouts of the structures are the ones that llvm-pdbutil shows for it.
+ * The fixture is copied to the build directory as the reader saves the
+ * index of the symbols next to the pdb file
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pdb-reader.h"
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The copy of the fixture that is opened by the tests
+ *
+ */
+#define PDB_READER_TEST_FILE "build/pdb-reader-test.pdb"
+
+/**
+ * @brief A field of the fixture and its offset
+ *
+ */
+typedef struct _PDB_READER_TEST_FIELD
+{
+    const char * TypeName;
+    const char * FieldPath;
+    uint32_t     Offset;
+
+} PDB_READER_TEST_FIELD, *PPDB_READER_TEST_FIELD;
+
+/**
+ * @brief A symbol of the fixture
+ *
+ */
+typedef struct _PDB_READER_TEST_SYMBOL
+{
+    const char * Name;
+    uint32_t     Rva;
+
+} PDB_READER_TEST_SYMBOL, *PPDB_READER_TEST_SYMBOL;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The symbols of the fixture (S_PUB32 and S_GDATA32)
+ *
+ */
+static const PDB_READER_TEST_SYMBOL g_PdbReaderTestSymbols[] = {
+    {"ExAllocatePool", 0x1000},
+    {"ExFreePool", 0x1010},
+    {"KeBugCheck", 0x1020},
+    {"KeQueryPerformanceCounter", 0x1030},
+    {"NtClose", 0x1040},
+    {"NtCreateFile", 0x1050},
+    {"NtCreateProcess", 0x1060},
+    {"NtCreateThread", 0x1080},
+    {"NtOpenFile", 0x10a0},
+    {"NtOpenProcess", 0x10b0},
+    {"RtlCopyMemory", 0x10c0},
+    {"RtlZeroMemory", 0x10e0},
+    {"UseHolder", 0x1100},
+    {"mainCRTStartup", 0x1110},
+    {"GlobalHolder", 0x3000},
+    {"GlobalOuter", 0x3050},
+    {"KeNumberProcessors", 0x3088},
+    {"PsInitialSystemProcess", 0x3090},
+    {"PsLoadedModuleList", 0x3098},
+    {"pdb_reader_test::GlobalHolder", 0x3000},
+    {"pdb_reader_test::PsLoadedModuleList", 0x3098},
+};
+
+/**
+ * @brief The fields of the structures of the fixture, the offsets are
+ * the offsets of the LF_MEMBER records that llvm-pdbutil shows (the
+ * structures are referenced by forward references and the nested
+ * offsets are the sums of the offsets of the members)
+ *
+ */
+static const PDB_READER_TEST_FIELD g_PdbReaderTestFields[] = {
+    {"pdb_reader_test::Inner", "x", 0},
+    {"pdb_reader_test::Inner", "y", 8},
+    {"pdb_reader_test::Outer", "a", 0},
+    {"pdb_reader_test::Outer", "inner", 8},
+    {"pdb_reader_test::Outer", "inner.x", 8},
+    {"pdb_reader_test::Outer", "inner.y", 16},
+    {"pdb_reader_test::Outer", "c", 24},
+    {"pdb_reader_test::Outer", "arr", 28},
+    {"pdb_reader_test::Outer", "tail", 40},
+    {"pdb_reader_test::Outer", "tail.p", 40},
+    {"pdb_reader_test::Outer", "tail.q", 48},
+    {"pdb_reader_test::Value", "low", 0},
+    {"pdb_reader_test::Value", "full", 0},
+    {"pdb_reader_test::Holder", "flags", 0},
+    {"pdb_reader_test::Holder", "value", 8},
+    {"pdb_reader_test::Holder", "value.full", 8},
+    {"pdb_reader_test::Holder", "outer", 16},
+    {"pdb_reader_test::Holder", "outer.inner.y", 32},
+    {"pdb_reader_test::Holder", "outer.arr", 44},
+    {"pdb_reader_test::Holder", "outer.tail.q", 64},
+    {"pdb_reader_test::Holder", "next", 72},
+};
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Copy a file
+ *
+ * @param Source
+ * @param Destination
+ * @return bool
+ */
+static bool
+PdbReaderTestCopyFile(const char * Source, const char * Destination)
+{
+    FILE * SourceFile      = fopen(Source, "rb");
+    FILE * DestinationFile = NULL;
+    char   Buffer[0x1000];
+    size_t Length;
+    bool   Result = false;
+
+    if (SourceFile == NULL)
+    {
+        return false;
+    }
+
+    DestinationFile = fopen(Destination, "wb");
+
+    if (DestinationFile != NULL)
+    {
+        Result = true;
+
+        while ((Length = fread(Buffer, 1, sizeof(Buffer), SourceFile)) != 0)
+        {
+            Result = Result && fwrite(Buffer, 1, Length, DestinationFile) == Length;
+        }
+
+        Result = fclose(DestinationFile) == 0 && Result;
+    }
+
+    fclose(SourceFile);
+
+    return Result;
+}
+
+/**
+ * @brief Change a byte of a file
+ *
+ * @param FileName
+ * @param Offset
+ * @param Origin SEEK_SET or SEEK_END
+ * @return bool
+ */
+static bool
+PdbReaderTestCorruptFile(const char * FileName, long Offset, int Origin)
+{
+    FILE * File = fopen(FileName, "r+b");
+    int    Byte;
+    bool   Result;
+
+    if (File == NULL)
+    {
+        return false;
+    }
+
+    Result = fseek(File, Offset, Origin) == 0 && (Byte = fgetc(File)) != EOF &&
+             fseek(File, Offset, Origin) == 0 && fputc(Byte ^ 0xff, File) != EOF;
+
+    return fclose(File) == 0 && Result;
+}
+
+/**
+ * @brief Check whether a file exists
+ *
+ * @param FileName
+ * @return bool
+ */
+static bool
+PdbReaderTestIsFileExists(const char * FileName)
+{
+    FILE * File = fopen(FileName, "rb");
+
+    if (File == NULL)
+    {
+        return false;
+    }
+
+    fclose(File);
+
+    return true;
+}
+
+/**
+ * @brief Collect the enumerated symbols as text (the order, rvas, kinds
+ * and names of the sessions are compared)
+ *
+ * @param Symbol
+ * @param Context
+ * @return void
+ */
+static void
+PdbReaderTestCollectSymbol(const PDB_READER_SYMBOL * Symbol, void * Context)
+{
+    std::vector<std::string> * Symbols = (std::vector<std::string> *)Context;
+    char                       Line[0x200];
+
+    snprintf(Line, sizeof(Line), "%x %x %s", Symbol->Rva, Symbol->Kind, Symbol->Name);
+
+    Symbols->push_back(Line);
+}
+
+/**
+ * @brief Check the symbols of an opened fixture
+ *
+ * @param Reader
+ * @return void
+ */
+static void
+PdbReaderTestCheckSymbols(PPDB_READER Reader)
+{
+    uint32_t                  Rva;
+    uint32_t                  Displacement;
+    const PDB_READER_SYMBOL * Symbol;
+    std::string               UpperName;
+
+    for (const PDB_READER_TEST_SYMBOL & Expected : g_PdbReaderTestSymbols)
+    {
+        UNIT_TEST_CHECK(PdbReaderFindSymbolByName(Reader, Expected.Name, &Rva) && Rva == Expected.Rva);
+
+        //
+        // The names are case-insensitive
+        //
+        UpperName = Expected.Name;
+
+        for (char & Character : UpperName)
+        {
+            Character = (char)toupper((unsigned char)Character);
+        }
+
+        UNIT_TEST_CHECK(PdbReaderFindSymbolByName(Reader, UpperName.c_str(), &Rva) && Rva == Expected.Rva);
+
+        Symbol = PdbReaderFindSymbolByRva(Reader, Expected.Rva, &Displacement);
+        UNIT_TEST_CHECK(Symbol != NULL && Symbol->Rva == Expected.Rva && Displacement == 0);
+    }
+
+    UNIT_TEST_CHECK(!PdbReaderFindSymbolByName(Reader, "NtCreate", &Rva));
+    UNIT_TEST_CHECK(!PdbReaderFindSymbolByName(Reader, "NtCreateFileEx", &Rva));
+
+    //
+    // The addresses inside the functions and before the first symbol
+    //
+    Symbol = PdbReaderFindSymbolByRva(Reader, 0x1065, &Displacement);
+    UNIT_TEST_CHECK(Symbol != NULL && strcmp(Symbol->Name, "NtCreateProcess") == 0 && Displacement == 5);
+
+    UNIT_TEST_CHECK(PdbReaderFindSymbolByRva(Reader, 0xfff, &Displacement) == NULL);
+}
+
+/**
+ * @brief Check that the symbols of the saved index are the symbols of
+ * the pdb file and that the stale indexes are not used
+ *
+ * @return void
+ */
+static void
+PdbReaderTestIndexRoundTrip()
+{
+    std::string              IndexFileName = std::string(PDB_READER_TEST_FILE) + PDB_READER_INDEX_FILE_EXTENSION;
+    std::vector<std::string> ParsedSymbols;
+    std::vector<std::string> IndexedSymbols;
+    uint32_t                 ImageSize;
+    PPDB_READER              Reader;
+
+    remove(IndexFileName.c_str());
+
+    //
+    // The first session parses the pdb file and saves the index
+    //
+    Reader = PdbReaderOpen(PDB_READER_TEST_FILE);
+    UNIT_TEST_CHECK(Reader != NULL);
+
+    if (Reader == NULL)
+    {
+        return;
+    }
+
+    PdbReaderTestCheckSymbols(Reader);
+    UNIT_TEST_CHECK(!Reader->IsIndexLoaded);
+
+    PdbReaderEnumerateSymbols(Reader, "*", PdbReaderTestCollectSymbol, &ParsedSymbols);
+    ImageSize = PdbReaderGetImageSize(Reader);
+
+    PdbReaderClose(Reader);
+
+    UNIT_TEST_CHECK(PdbReaderTestIsFileExists(IndexFileName.c_str()));
+    UNIT_TEST_CHECK(ParsedSymbols.size() == 19 + 5); // S_PUB32 and S_GDATA32
+
+    //
+    // The next session reads the same symbols from the index
+    //
+    Reader = PdbReaderOpen(PDB_READER_TEST_FILE);
+    UNIT_TEST_CHECK(Reader != NULL);
+
+    if (Reader == NULL)
+    {
+        return;
+    }
+
+    PdbReaderTestCheckSymbols(Reader);
+    UNIT_TEST_CHECK(Reader->IsIndexLoaded);
+
+    PdbReaderEnumerateSymbols(Reader, "*", PdbReaderTestCollectSymbol, &IndexedSymbols);
+
+    UNIT_TEST_CHECK(IndexedSymbols == ParsedSymbols);
+    UNIT_TEST_CHECK(PdbReaderGetImageSize(Reader) == ImageSize);
+
+    PdbReaderClose(Reader);
+
+    //
+    // An index of another age of the pdb file (the age is after the
+    // magic and the version) is parsed again and replaced
+    //
+    UNIT_TEST_CHECK(PdbReaderTestCorruptFile(IndexFileName.c_str(), 12, SEEK_SET));
+
+    for (int Session = 0; Session < 2; Session++)
+    {
+        Reader = PdbReaderOpen(PDB_READER_TEST_FILE);
+        UNIT_TEST_CHECK(Reader != NULL);
+
+        if (Reader == NULL)
+        {
+            return;
+        }
+
+        PdbReaderTestCheckSymbols(Reader);
+        UNIT_TEST_CHECK(Reader->IsIndexLoaded == (Session == 1));
+
+        PdbReaderClose(Reader);
+    }
+
+    //
+    // A damaged index (the last name is not terminated) isn't used either
+    //
+    UNIT_TEST_CHECK(PdbReaderTestCorruptFile(IndexFileName.c_str(), -1, SEEK_END));
+
+    Reader = PdbReaderOpen(PDB_READER_TEST_FILE);
+    UNIT_TEST_CHECK(Reader != NULL);
+
+    if (Reader == NULL)
+    {
+        return;
+    }
+
+    PdbReaderTestCheckSymbols(Reader);
+    UNIT_TEST_CHECK(!Reader->IsIndexLoaded);
+
+    PdbReaderClose(Reader);
+}
+
+/**
+ * @brief Check the offsets of the fields of the structures
+ *
+ * @return void
+ */
+static void
+PdbReaderTestFields()
+{
+    uint32_t    Offset;
+    PPDB_READER Reader = PdbReaderOpen(PDB_READER_TEST_FILE);
+
+    UNIT_TEST_CHECK(Reader != NULL);
+
+    if (Reader == NULL)
+    {
+        return;
+    }
+
+    for (const PDB_READER_TEST_FIELD & Expected : g_PdbReaderTestFields)
+    {
+        Offset = ~0u;
+
+        UNIT_TEST_CHECK(PdbReaderFindField(Reader, Expected.TypeName, Expected.FieldPath, &Offset) &&
+                        Offset == Expected.Offset);
+    }
+
+    //
+    // The names of the types and the fields are case-sensitive (like C)
+    // and the fields of the base types and the pointers are not found
+    //
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::outer", "a", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::Outer", "A", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "Outer", "a", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::Outer", "missing", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::Outer", "a.b", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::Outer", "inner.", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::Holder", "next.flags", &Offset));
+    UNIT_TEST_CHECK(!PdbReaderFindField(Reader, "pdb_reader_test::Holder", "outer..a", &Offset));
+
+    PdbReaderClose(Reader);
+}
+
+int
+main()
+{
+    if (!PdbReaderTestCopyFile("data/pdb-reader-test.pdb", PDB_READER_TEST_FILE))
+    {
+        printf("err, unable to copy the fixture\n");
+        return 1;
+    }
+
+    PdbReaderTestIndexRoundTrip();
+    PdbReaderTestFields();
+
+    return UNIT_TEST_RESULT("pdb-reader-test");
+}
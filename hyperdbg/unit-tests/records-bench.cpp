@@ -0,0 +1,256 @@
+/**
+ * @file records-bench.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the event records
+ * @details The records are built by the kernel (LoggingRecords.c) and read
+ * back from a stream of a binary output source, they are compared with the
+ * text messages of the events (as the previous output sources) which are
+ * formatted by the kernel and parsed again by the collectors with a regular
+ * expression, the conversion of the records to JSON lines ('output convert')
+ * is also measured
+ *
+ * Usage: records-bench [events]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <regex>
+#include <sstream>
+#include <time.h>
+#include <x86intrin.h>
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The core of the records that are built
+ *
+ */
+static UINT32 g_BenchCoreId;
+
+/**
+ * @brief Sum of the values that are read back
+ *
+ */
+static UINT64 g_Sum;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result)
+{
+    return FALSE;
+}
+
+//
+// The records are built by LoggingRecords.c of the kernel
+//
+extern "C" {
+UINT32
+LogGetEventRecordLength(UINT32 * CountOfValues, UINT32 * TextLength);
+
+VOID
+LogFillEventRecord(PVOID                      Buffer,
+                   UINT64                     Tag,
+                   DEBUGGER_EVENT_RECORD_KIND Kind,
+                   UINT64 *                   Values,
+                   UINT32                     CountOfValues,
+                   const char *               Text,
+                   UINT32                     TextLength);
+
+ULONG
+KeGetCurrentProcessorNumber()
+{
+    return g_BenchCoreId;
+}
+
+HANDLE
+PsGetCurrentProcessId()
+{
+    return (HANDLE)0x1234;
+}
+
+HANDLE
+PsGetCurrentThreadId()
+{
+    return (HANDLE)0x5678;
+}
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the current time in nanoseconds
+ *
+ * @return double
+ */
+static double
+BenchNow()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+/**
+ * @brief The values of an event
+ *
+ * @param Event
+ * @param Values
+ * @return VOID
+ */
+static VOID
+BenchGetValues(UINT32 Event, UINT64 * Values)
+{
+    Values[0] = 0xfffff80000001000 + Event * 0x10;
+    Values[1] = Event;
+    Values[2] = (UINT64)Event << 32;
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32       CountOfEvents = argc > 1 ? atoi(argv[1]) : 200000;
+    std::regex   Pattern("tag: ([0-9a-f]+), core: ([0-9a-f]+), pid: ([0-9a-f]+), tid: ([0-9a-f]+), "
+                         "tsc: ([0-9a-f]+), rip: ([0-9a-f]+), rcx: ([0-9a-f]+), rdx: ([0-9a-f]+)\n");
+    CHAR         Buffer[PacketChunkSize];
+    UINT64       Values[3];
+    UINT32       CountOfValues, TextLength, Length;
+    string       Text, Streamed;
+    stringstream Stream, Json;
+    vector<CHAR> RecordBuffer;
+    UINT64       TextBytes = 0, RecordBytes = 0, CountOfRecords = 0;
+    double       Start, TextFormat, TextParse, RecordFill, RecordRead, RecordJson;
+
+    //
+    // The text messages (the kernel formats them and the collectors
+    // parse them again)
+    //
+    Start = BenchNow();
+
+    for (UINT32 i = 0; i < CountOfEvents; i++)
+    {
+        BenchGetValues(i, Values);
+
+        Length = snprintf(Buffer,
+                          sizeof(Buffer),
+                          "tag: %x, core: %x, pid: %x, tid: %x, tsc: %llx, rip: %llx, rcx: %llx, rdx: %llx\n",
+                          i,
+                          i % 8,
+                          0x1234,
+                          0x5678,
+                          (unsigned long long)__rdtsc(),
+                          (unsigned long long)Values[0],
+                          (unsigned long long)Values[1],
+                          (unsigned long long)Values[2]);
+
+        Text.append(Buffer, Length);
+        TextBytes += Length;
+    }
+
+    TextFormat = (BenchNow() - Start) / CountOfEvents;
+    Start      = BenchNow();
+    g_Sum      = 0;
+
+    for (std::sregex_iterator Match(Text.begin(), Text.end(), Pattern), End; Match != End; Match++)
+    {
+        for (UINT32 i = 1; i < Match->size(); i++)
+        {
+            g_Sum += strtoull((*Match)[i].str().c_str(), NULL, 16);
+        }
+    }
+
+    TextParse = (BenchNow() - Start) / CountOfEvents;
+
+    //
+    // The records (the kernel fills them and the collectors read the
+    // fields of the stream)
+    //
+    DEBUGGER_EVENT_RECORD_STREAM_HEADER Header = {DEBUGGER_EVENT_RECORD_SIGNATURE, DEBUGGER_EVENT_RECORD_VERSION};
+
+    Stream.write((char *)&Header, sizeof(Header));
+
+    Start = BenchNow();
+
+    for (UINT32 i = 0; i < CountOfEvents; i++)
+    {
+        BenchGetValues(i, Values);
+
+        g_BenchCoreId = i % 8;
+        CountOfValues = 3;
+        TextLength    = 0;
+        Length        = LogGetEventRecordLength(&CountOfValues, &TextLength);
+
+        LogFillEventRecord(Buffer, i, DEBUGGER_EVENT_RECORD_KIND_PRINT, Values, CountOfValues, NULL, TextLength);
+
+        Stream.write(Buffer, Length);
+        RecordBytes += Length;
+    }
+
+    RecordFill = (BenchNow() - Start) / CountOfEvents;
+    Streamed   = Stream.str();
+    Start      = BenchNow();
+    g_Sum      = 0;
+
+    if (RecordsReadStreamHeader(Stream))
+    {
+        PDEBUGGER_EVENT_RECORD Record;
+
+        while (RecordsReadNext(Stream, RecordBuffer, &Record))
+        {
+            UINT64 * RecordValues = (UINT64 *)((CHAR *)Record + SIZEOF_DEBUGGER_EVENT_RECORD);
+
+            g_Sum += Record->Tag + Record->CoreId + Record->ProcessId + Record->ThreadId + Record->Tsc;
+
+            for (UINT32 i = 0; i < Record->CountOfValues; i++)
+            {
+                g_Sum += RecordValues[i];
+            }
+
+            CountOfRecords++;
+        }
+    }
+
+    RecordRead = (BenchNow() - Start) / CountOfEvents;
+
+    if (CountOfRecords != CountOfEvents)
+    {
+        printf("err, the records are not read back\n");
+    }
+
+    Stream.clear();
+    Stream.str(Streamed);
+
+    Start = BenchNow();
+
+    if (!RecordsConvertToJsonLines(Stream, Json, &CountOfRecords) || CountOfRecords != CountOfEvents)
+    {
+        printf("err, the records are not converted\n");
+    }
+
+    RecordJson = (BenchNow() - Start) / CountOfEvents;
+
+    printf("%u events  text: %5.1f bytes, format %6.1f ns, regex %7.1f ns  records: %5.1f bytes, fill %6.1f ns, read %6.1f ns, json %6.1f ns\n",
+           CountOfEvents,
+           (double)TextBytes / CountOfEvents,
+           TextFormat,
+           TextParse,
+           (double)RecordBytes / CountOfEvents,
+           RecordFill,
+           RecordRead,
+           RecordJson);
+
+    return 0;
+}
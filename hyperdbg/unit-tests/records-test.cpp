@@ -0,0 +1,458 @@
+/**
+ * @file records-test.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Round-trip test of the event records
+ * @details The records are built by the kernel (LoggingRecords.c) and
+ * batched like the non-immediate records, and are read back as the debugger reads the
+ * buffers of the kernel, the streams of the binary output sources and
+ * the JSON lines of 'output convert'
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <sstream>
+
+#include "unit-tests.h"
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the records of the batches
+ *
+ */
+#define RECORDS_TEST_COUNT_OF_RECORDS 1000
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The core of the records that are built
+ *
+ */
+static UINT32 g_RecordsTestCoreId;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+BOOLEAN
+SymbolReplaceMarkers(const char * Message, UINT32 MessageLength, string & Result)
+{
+    return FALSE;
+}
+
+//
+// The records are built by LoggingRecords.c of the kernel
+//
+extern "C" {
+UINT32
+LogGetEventRecordLength(UINT32 * CountOfValues, UINT32 * TextLength);
+
+VOID
+LogFillEventRecord(PVOID                      Buffer,
+                   UINT64                     Tag,
+                   DEBUGGER_EVENT_RECORD_KIND Kind,
+                   UINT64 *                   Values,
+                   UINT32                     CountOfValues,
+                   const char *               Text,
+                   UINT32                     TextLength);
+
+ULONG
+KeGetCurrentProcessorNumber()
+{
+    return g_RecordsTestCoreId;
+}
+
+HANDLE
+PsGetCurrentProcessId()
+{
+    return (HANDLE)4;
+}
+
+HANDLE
+PsGetCurrentThreadId()
+{
+    return (HANDLE)8;
+}
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Build a record with LogGetEventRecordLength and LogFillEventRecord
+ * of the kernel
+ * @details The core and the time stamp counter of the records depend on
+ * the tag so the JSON lines are the same in each run
+ *
+ * @param Buffer The buffer that receives the record (PacketChunkSize - 1)
+ * @param Tag
+ * @param Kind
+ * @param Values
+ * @param CountOfValues
+ * @param Text
+ * @param TextLength
+ * @return UINT32 Length of the record
+ */
+static UINT32
+RecordsTestFillRecord(PVOID                      Buffer,
+                      UINT64                     Tag,
+                      DEBUGGER_EVENT_RECORD_KIND Kind,
+                      UINT64 *                   Values,
+                      UINT32                     CountOfValues,
+                      const char *               Text,
+                      UINT32                     TextLength)
+{
+    PDEBUGGER_EVENT_RECORD Record = (PDEBUGGER_EVENT_RECORD)Buffer;
+    UINT32                 Length;
+
+    g_RecordsTestCoreId = (UINT32)(Tag % 8);
+
+    Length = LogGetEventRecordLength(&CountOfValues, &TextLength);
+    LogFillEventRecord(Buffer, Tag, Kind, Values, CountOfValues, Text, TextLength);
+
+    UNIT_TEST_CHECK(Record->Length == Length && Record->Tsc != 0);
+
+    Record->Tsc = 0x123456789abcdef0 + Tag;
+
+    return Length;
+}
+
+/**
+ * @brief Check the validation of the records
+ *
+ * @return VOID
+ */
+static VOID
+RecordsTestValidation()
+{
+    CHAR                   Buffer[PacketChunkSize];
+    UINT64                 Values[2] = {0x1000, 0x2000};
+    UINT32                 Length;
+    PDEBUGGER_EVENT_RECORD Record = (PDEBUGGER_EVENT_RECORD)Buffer;
+
+    Length = RecordsTestFillRecord(Buffer, 0x1000000, DEBUGGER_EVENT_RECORD_KIND_PRINTF, Values, 2, "abc", 3);
+
+    UNIT_TEST_CHECK(Length == SIZEOF_DEBUGGER_EVENT_RECORD + 2 * sizeof(UINT64) + 3);
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, Length) == Record);
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, sizeof(Buffer)) == Record);
+
+    //
+    // Shorter buffers, other signatures and inconsistent lengths
+    //
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, Length - 1) == NULL);
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, SIZEOF_DEBUGGER_EVENT_RECORD - 1) == NULL);
+
+    Record->Signature++;
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, Length) == NULL);
+    Record->Signature--;
+
+    Record->TextLength++;
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, sizeof(Buffer)) == NULL);
+    Record->TextLength--;
+
+    Record->CountOfValues = DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES + 1;
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, sizeof(Buffer)) == NULL);
+    Record->CountOfValues = 2;
+
+    //
+    // Plain text messages are not records
+    //
+    strcpy(Buffer, "this is the text message of an event with no record\n");
+    UNIT_TEST_CHECK(RecordsGetEventRecord(Buffer, (UINT32)strlen(Buffer)) == NULL);
+}
+
+/**
+ * @brief Check the truncation of the records that don't fit in a message
+ *
+ * @return VOID
+ */
+static VOID
+RecordsTestTruncation()
+{
+    CHAR                   Buffer[PacketChunkSize];
+    UINT64                 Values[DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES + 4] = {0};
+    string                 Text(PacketChunkSize * 2, 'x');
+    UINT32                 Length;
+    PDEBUGGER_EVENT_RECORD Record;
+
+    Length = RecordsTestFillRecord(Buffer,
+                                   0x1000001,
+                                   DEBUGGER_EVENT_RECORD_KIND_PRINTF,
+                                   Values,
+                                   DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES + 4,
+                                   Text.c_str(),
+                                   (UINT32)Text.size());
+
+    Record = RecordsGetEventRecord(Buffer, Length);
+
+    UNIT_TEST_CHECK(Length == PacketChunkSize - 1);
+    UNIT_TEST_CHECK(Record != NULL);
+    UNIT_TEST_CHECK(Record != NULL && Record->CountOfValues == DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES);
+    UNIT_TEST_CHECK(Record != NULL &&
+                    Record->TextLength == PacketChunkSize - 1 - SIZEOF_DEBUGGER_EVENT_RECORD -
+                                              DEBUGGER_EVENT_RECORD_MAXIMUM_VALUES * sizeof(UINT64));
+}
+
+/**
+ * @brief Check the batches of the non-immediate records
+ * @details The records are accumulated like LogSendEventRecord and each
+ * batch is split like the OPERATION_LOG_NON_IMMEDIATE_EVENT_RECORDS
+ * messages of ReadIrpBasedBuffer
+ *
+ * @return VOID
+ */
+static VOID
+RecordsTestBatches()
+{
+    CHAR                   Batch[PacketChunkSize];
+    CHAR                   Text[64];
+    UINT32                 BatchLength    = 0;
+    UINT32                 CountOfBatches = 0;
+    UINT64                 NextTag        = 0;
+    BOOLEAN                IsValid        = TRUE;
+    UINT32                 Length;
+    UINT64                 Value;
+    PDEBUGGER_EVENT_RECORD Record;
+
+    for (UINT64 i = 0; i <= RECORDS_TEST_COUNT_OF_RECORDS; i++)
+    {
+        CHAR   RecordBuffer[PacketChunkSize];
+        UINT32 TextLength;
+
+        Value      = i * 0x10;
+        TextLength = (UINT32)snprintf(Text, sizeof(Text), "record %llu\n", (unsigned long long)i);
+        Length     = RecordsTestFillRecord(RecordBuffer,
+                                       i,
+                                       DEBUGGER_EVENT_RECORD_KIND_PRINTF,
+                                       &Value,
+                                       1,
+                                       Text,
+                                       (UINT32)(i % 7 == 0 ? 0 : TextLength));
+
+        //
+        // The batch is sent when the record doesn't fit (and after the last one)
+        //
+        if (BatchLength + Length > PacketChunkSize - 1 || i == RECORDS_TEST_COUNT_OF_RECORDS)
+        {
+            UINT32 Offset;
+
+            for (Offset = 0;
+                 (Record = RecordsGetEventRecord(Batch + Offset, BatchLength - Offset)) != NULL;
+                 Offset += Record->Length)
+            {
+                UINT64 * Values     = (UINT64 *)((CHAR *)Record + SIZEOF_DEBUGGER_EVENT_RECORD);
+                CHAR *   RecordText = (CHAR *)Values + Record->CountOfValues * sizeof(UINT64);
+
+                TextLength = (UINT32)snprintf(Text, sizeof(Text), "record %llu\n", (unsigned long long)NextTag);
+
+                if (Record->Tag != NextTag ||
+                    Record->CountOfValues != 1 ||
+                    Values[0] != NextTag * 0x10 ||
+                    Record->TextLength != (NextTag % 7 == 0 ? 0 : TextLength) ||
+                    memcmp(RecordText, Text, Record->TextLength) != 0)
+                {
+                    IsValid = FALSE;
+                }
+
+                NextTag++;
+            }
+
+            UNIT_TEST_CHECK(Offset == BatchLength);
+
+            BatchLength = 0;
+            CountOfBatches++;
+        }
+
+        memcpy(Batch + BatchLength, RecordBuffer, Length);
+        BatchLength += Length;
+    }
+
+    UNIT_TEST_CHECK(IsValid);
+    UNIT_TEST_CHECK(NextTag == RECORDS_TEST_COUNT_OF_RECORDS);
+    UNIT_TEST_CHECK(CountOfBatches > 1);
+}
+
+/**
+ * @brief Check the text of the records and the records of the text messages
+ *
+ * @return VOID
+ */
+static VOID
+RecordsTestText()
+{
+    CHAR                   Buffer[PacketChunkSize];
+    CHAR                   NewBuffer[PacketChunkSize];
+    CHAR                   Text[PacketChunkSize];
+    UINT64                 Values[2] = {0xfffff80000001000, 0x10};
+    UINT32                 Length;
+    PDEBUGGER_EVENT_RECORD Record;
+
+    RecordsTestFillRecord(Buffer, 1, DEBUGGER_EVENT_RECORD_KIND_PRINT, Values, 1, NULL, 0);
+    Record = (PDEBUGGER_EVENT_RECORD)Buffer;
+
+    UNIT_TEST_CHECK(RecordsToText(Record, Text, sizeof(Text)) == 16);
+    UNIT_TEST_CHECK(strcmp(Text, "fffff80000001000") == 0);
+
+    RecordsTestFillRecord(Buffer, 1, DEBUGGER_EVENT_RECORD_KIND_FORMATS, Values + 1, 1, NULL, 0);
+
+    UNIT_TEST_CHECK(RecordsToText(Record, Text, sizeof(Text)) == 3);
+    UNIT_TEST_CHECK(strcmp(Text, "10\n") == 0);
+    UNIT_TEST_CHECK(RecordsToText(Record, Text, 2) == 1);
+    UNIT_TEST_CHECK(strcmp(Text, "1") == 0);
+
+    RecordsTestFillRecord(Buffer, 1, DEBUGGER_EVENT_RECORD_KIND_PRINTF, Values, 2, "at 0x1000", 9);
+
+    UNIT_TEST_CHECK(RecordsToText(Record, Text, sizeof(Text)) == 9);
+    UNIT_TEST_CHECK(strcmp(Text, "at 0x1000") == 0);
+
+    //
+    // The values are kept when the text is replaced
+    //
+    Length = RecordsReplaceText(Record, "at nt!Function", 14, NewBuffer, sizeof(NewBuffer));
+    Record = RecordsGetEventRecord(NewBuffer, Length);
+
+    UNIT_TEST_CHECK(Record != NULL);
+    UNIT_TEST_CHECK(Record != NULL && Record->CountOfValues == 2 && Record->Tag == 1);
+    UNIT_TEST_CHECK(Record != NULL && memcmp((CHAR *)Record + SIZEOF_DEBUGGER_EVENT_RECORD, Values, sizeof(Values)) == 0);
+    UNIT_TEST_CHECK(Record != NULL && RecordsToText(Record, Text, sizeof(Text)) == 14 && strcmp(Text, "at nt!Function") == 0);
+
+    UNIT_TEST_CHECK(RecordsReplaceText((PDEBUGGER_EVENT_RECORD)Buffer, "abc", 3, NewBuffer, SIZEOF_DEBUGGER_EVENT_RECORD) == 0);
+
+    Length = RecordsReplaceText((PDEBUGGER_EVENT_RECORD)Buffer, "abcdef", 6, NewBuffer, SIZEOF_DEBUGGER_EVENT_RECORD + 2 * sizeof(UINT64) + 4);
+    UNIT_TEST_CHECK(Length == SIZEOF_DEBUGGER_EVENT_RECORD + 2 * sizeof(UINT64) + 4);
+    UNIT_TEST_CHECK(RecordsGetEventRecord(NewBuffer, Length) != NULL);
+
+    //
+    // The text messages of the events
+    //
+    strcpy(Text, "the result of a custom code\n");
+    Length = RecordsCreateTextRecord(0x1000002, Text, (UINT32)strlen(Text), Buffer, sizeof(Buffer));
+    Record = RecordsGetEventRecord(Buffer, Length);
+
+    UNIT_TEST_CHECK(Record != NULL);
+    UNIT_TEST_CHECK(Record != NULL && Record->Kind == DEBUGGER_EVENT_RECORD_KIND_TEXT && Record->Tag == 0x1000002);
+    UNIT_TEST_CHECK(Record != NULL && Record->CountOfValues == 0 && Record->TextLength == strlen(Text));
+
+    Length = RecordsCreateTextRecord(1, Text, (UINT32)strlen(Text), Buffer, SIZEOF_DEBUGGER_EVENT_RECORD + 3);
+    UNIT_TEST_CHECK(Length == SIZEOF_DEBUGGER_EVENT_RECORD + 3);
+    UNIT_TEST_CHECK(RecordsCreateTextRecord(1, Text, 3, Buffer, SIZEOF_DEBUGGER_EVENT_RECORD - 1) == 0);
+}
+
+/**
+ * @brief Check the streams of the records and their JSON lines
+ *
+ * @return VOID
+ */
+static VOID
+RecordsTestStreams()
+{
+    DEBUGGER_EVENT_RECORD_STREAM_HEADER Header = {DEBUGGER_EVENT_RECORD_SIGNATURE, DEBUGGER_EVENT_RECORD_VERSION};
+    CHAR                                Buffer[PacketChunkSize];
+    UINT64                              Values[3] = {0x1, 0xfffff80000001000, 0x0};
+    const char                          Text[]    = "a \"quoted\" \\ line\n\twith \x01 and \xff";
+    stringstream                        Stream;
+    stringstream                        Json;
+    vector<CHAR>                        RecordBuffer;
+    PDEBUGGER_EVENT_RECORD              Record;
+    UINT64                              CountOfRecords;
+    UINT32                              Length;
+    string                              Line;
+    string                              Streamed;
+
+    Stream.write((char *)&Header, sizeof(Header));
+
+    Length = RecordsTestFillRecord(Buffer, 7, DEBUGGER_EVENT_RECORD_KIND_PRINTF, Values, 3, Text, sizeof(Text) - 1);
+    Stream.write(Buffer, Length);
+
+    Length = RecordsTestFillRecord(Buffer, 8, DEBUGGER_EVENT_RECORD_KIND_PRINT, Values + 1, 1, NULL, 0);
+    Stream.write(Buffer, Length);
+
+    Streamed = Stream.str();
+
+    //
+    // Read the records back
+    //
+    UNIT_TEST_CHECK(RecordsReadStreamHeader(Stream));
+    UNIT_TEST_CHECK(RecordsReadNext(Stream, RecordBuffer, &Record));
+    UNIT_TEST_CHECK(Record->Tag == 7 && Record->CountOfValues == 3 && Record->TextLength == sizeof(Text) - 1);
+    UNIT_TEST_CHECK(memcmp((CHAR *)Record + SIZEOF_DEBUGGER_EVENT_RECORD + 3 * sizeof(UINT64), Text, sizeof(Text) - 1) == 0);
+
+    RecordsToJsonLine(Record, Line);
+    UNIT_TEST_CHECK(Line == "{\"tag\":7,\"kind\":\"printf\",\"core\":7,\"pid\":4,\"tid\":8,\"tsc\":\"0x123456789abcdef7\","
+                            "\"values\":[\"0x1\",\"0xfffff80000001000\",\"0x0\"],"
+                            "\"text\":\"a \\\"quoted\\\" \\\\ line\\n\\twith \\u0001 and \\u00ff\"}\n");
+
+    UNIT_TEST_CHECK(RecordsReadNext(Stream, RecordBuffer, &Record));
+    UNIT_TEST_CHECK(Record->Tag == 8 && Record->Kind == DEBUGGER_EVENT_RECORD_KIND_PRINT);
+    UNIT_TEST_CHECK(!RecordsReadNext(Stream, RecordBuffer, &Record));
+
+    //
+    // Convert the whole stream
+    //
+    Stream.clear();
+    Stream.str(Streamed);
+
+    UNIT_TEST_CHECK(RecordsConvertToJsonLines(Stream, Json, &CountOfRecords));
+    UNIT_TEST_CHECK(CountOfRecords == 2);
+    UNIT_TEST_CHECK(Json.str().compare(0, Line.size(), Line) == 0);
+    UNIT_TEST_CHECK(Json.str().substr(Line.size()) ==
+                    "{\"tag\":8,\"kind\":\"print\",\"core\":0,\"pid\":4,\"tid\":8,\"tsc\":\"0x123456789abcdef8\","
+                    "\"values\":[\"0xfffff80000001000\"],\"text\":\"\"}\n");
+
+    //
+    // A stream that stops in the middle of a record
+    //
+    Stream.clear();
+    Stream.str(Streamed.substr(0, Streamed.size() - 3));
+    Json.str("");
+
+    UNIT_TEST_CHECK(!RecordsConvertToJsonLines(Stream, Json, &CountOfRecords));
+    UNIT_TEST_CHECK(CountOfRecords == 1);
+
+    //
+    // A stream that stops in the middle of the header of a record
+    //
+    Stream.clear();
+    Stream.str(Streamed.substr(0, Streamed.size() - Length + 3));
+
+    UNIT_TEST_CHECK(!RecordsConvertToJsonLines(Stream, Json, &CountOfRecords));
+
+    //
+    // A stream of another version and a corrupted record
+    //
+    Header.Version++;
+    Stream.clear();
+    Stream.str(string((char *)&Header, sizeof(Header)) + Streamed.substr(sizeof(Header)));
+
+    UNIT_TEST_CHECK(!RecordsConvertToJsonLines(Stream, Json, &CountOfRecords));
+    UNIT_TEST_CHECK(CountOfRecords == 0);
+
+    Streamed[sizeof(Header) + offsetof(DEBUGGER_EVENT_RECORD, Length)] ^= 0x40;
+    Stream.clear();
+    Stream.str(Streamed);
+
+    UNIT_TEST_CHECK(!RecordsConvertToJsonLines(Stream, Json, &CountOfRecords));
+    UNIT_TEST_CHECK(CountOfRecords == 0);
+}
+
+int
+main()
+{
+    RecordsTestValidation();
+    RecordsTestTruncation();
+    RecordsTestBatches();
+    RecordsTestText();
+    RecordsTestStreams();
+
+    return UNIT_TEST_RESULT("records-test");
+}
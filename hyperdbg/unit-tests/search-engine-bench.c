@@ -0,0 +1,206 @@
+/**
+ * @file search-engine-bench.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the vectorized pattern search engine
+ * @details The SSE2 and the AVX2 filters of the engine are compared with a
+ * byte-by-byte compare of each position (as the previous search of s* and
+ * !s*), the buffer is random and the pattern is placed a few times in it
+ *
+ * Usage: search-engine-bench [megabytes] [rounds]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <stdio.h>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the copies of the pattern in the buffer
+ *
+ */
+#define BENCH_COUNT_OF_MATCHES 64
+
+/**
+ * @brief A pattern of the benchmark
+ *
+ */
+typedef struct _BENCH_PATTERN
+{
+    const char *  Name;
+    const UCHAR * Bytes;
+    const UCHAR * Mask;
+    UINT32        Length;
+
+} BENCH_PATTERN, *PBENCH_PATTERN;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+UINT64 g_CountOfMatches;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+void
+__cpuidex(int Registers[4], int Leaf, int Subleaf)
+{
+    __asm__ __volatile__("cpuid"
+                         : "=a"(Registers[0]), "=b"(Registers[1]), "=c"(Registers[2]), "=d"(Registers[3])
+                         : "a"(Leaf), "c"(Subleaf));
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count the matches
+ *
+ * @param BaseAddress
+ * @param OffsetInBuffer
+ * @param Context
+ * @return BOOLEAN
+ */
+static BOOLEAN
+BenchCountMatchCallback(UINT64 BaseAddress, UINT32 OffsetInBuffer, PVOID Context)
+{
+    g_CountOfMatches++;
+
+    return TRUE;
+}
+
+/**
+ * @brief Compare each position of the buffer byte by byte
+ *
+ * @param Pattern The compiled pattern
+ * @param Buffer
+ * @param BufferSize
+ * @return VOID
+ */
+static VOID
+BenchByteByByte(PSEARCH_ENGINE_PATTERN Pattern, const UCHAR * Buffer, UINT32 BufferSize)
+{
+    for (UINT32 Position = 0; Position + Pattern->Length <= BufferSize; Position++)
+    {
+        UINT32 i = 0;
+
+        while (i < Pattern->Length && ((Buffer[Position + i] ^ Pattern->Bytes[i]) & Pattern->Mask[i]) == 0)
+        {
+            i++;
+        }
+
+        if (i == Pattern->Length)
+        {
+            g_CountOfMatches++;
+        }
+    }
+}
+
+/**
+ * @brief Search the buffer a few times
+ *
+ * @param Pattern The compiled pattern
+ * @param Buffer
+ * @param BufferSize
+ * @param Rounds
+ * @param Method 0 byte by byte, 1 SSE2 and 2 AVX2
+ * @return double Gigabytes per second
+ */
+static double
+BenchRun(PSEARCH_ENGINE_PATTERN Pattern, const UCHAR * Buffer, UINT32 BufferSize, UINT32 Rounds, UINT32 Method)
+{
+    struct timespec Start, End;
+
+    g_CountOfMatches = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &Start);
+
+    for (UINT32 i = 0; i < Rounds; i++)
+    {
+        if (Method == 0)
+        {
+            BenchByteByByte(Pattern, Buffer, BufferSize);
+        }
+        else
+        {
+            SearchEngineScanBuffer(Pattern, Buffer, BufferSize, 0, Method == 2, BenchCountMatchCallback, NULL);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &End);
+
+    if (g_CountOfMatches < (UINT64)BENCH_COUNT_OF_MATCHES * Rounds)
+    {
+        printf("err, the matches are not found\n");
+    }
+
+    return (double)BufferSize * Rounds / ((End.tv_sec - Start.tv_sec) * 1e9 + (End.tv_nsec - Start.tv_nsec));
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32                BufferSize      = (argc > 1 ? atoi(argv[1]) : 64) * 1024 * 1024;
+    UINT32                Rounds          = argc > 2 ? atoi(argv[2]) : 4;
+    BOOLEAN               IsAvx2Supported = SearchEngineIsAvx2Supported();
+    UINT32                Random          = 0x12345678;
+    UCHAR *               Buffer          = malloc(BufferSize);
+    SEARCH_ENGINE_PATTERN Pattern;
+    BENCH_PATTERN         Patterns[] = {
+        {"8 bytes", (const UCHAR *)"\x48\x89\x5c\x24\x08\x57\x48\x83", NULL, 8},
+        {"8 bytes (wildcards)", (const UCHAR *)"\x48\x8b\x05\x00\x00\x00\x00\xc3", (const UCHAR *)"\xff\xff\xff\x00\x00\x00\x00\xff", 8},
+        {"1 byte", (const UCHAR *)"\xcc", NULL, 1},
+        {"32 bytes", (const UCHAR *)"HyperDbg search engine benchmark", NULL, 32},
+    };
+
+    if (Buffer == NULL)
+    {
+        return 1;
+    }
+
+    for (UINT32 i = 0; i < sizeof(Patterns) / sizeof(Patterns[0]); i++)
+    {
+        for (UINT32 j = 0; j < BufferSize; j++)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            Buffer[j] = (UCHAR)Random;
+        }
+
+        for (UINT32 j = 0; j < BENCH_COUNT_OF_MATCHES; j++)
+        {
+            memcpy(&Buffer[(UINT64)BufferSize / BENCH_COUNT_OF_MATCHES * j + j], Patterns[i].Bytes, Patterns[i].Length);
+        }
+
+        SearchEngineCompilePattern(&Pattern, Patterns[i].Bytes, Patterns[i].Mask, Patterns[i].Length, 1);
+
+        printf("%-20s byte by byte: %6.2f GB/s, SSE2: %6.2f GB/s",
+               Patterns[i].Name,
+               BenchRun(&Pattern, Buffer, BufferSize, Rounds, 0),
+               BenchRun(&Pattern, Buffer, BufferSize, Rounds, 1));
+
+        if (IsAvx2Supported)
+        {
+            printf(", AVX2: %6.2f GB/s", BenchRun(&Pattern, Buffer, BufferSize, Rounds, 2));
+        }
+
+        printf("\n");
+    }
+
+    free(Buffer);
+
+    return 0;
+}
@@ -0,0 +1,566 @@
+/**
+ * @file search-engine-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the vectorized pattern search engine
+ * @details The matches of the SSE2 and the AVX2 filters are compared with
+ * a byte-by-byte search of the same buffers, then a memory of pages (with
+ * pages that are not valid) is searched in runs of pages like the search
+ * of the memory (s* and !s*) and the requests are continued from
+ * NextAddressToSearch like the user-mode
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Size of the buffers of the filters test
+ *
+ */
+#define SEARCH_TEST_BUFFER_SIZE 0x3000
+
+/**
+ * @brief Count of the pages of the memory of the search test
+ *
+ */
+#define SEARCH_TEST_MEMORY_PAGES 48
+
+/**
+ * @brief Address of the memory of the search test
+ *
+ */
+#define SEARCH_TEST_MEMORY_ADDRESS 0xfffff80000000000
+
+/**
+ * @brief Maximum count of the results of the tests
+ *
+ */
+#define SEARCH_TEST_MAXIMUM_RESULTS 0x10000
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+UCHAR   g_Buffer[SEARCH_TEST_BUFFER_SIZE];
+UCHAR   g_Memory[SEARCH_TEST_MEMORY_PAGES * PAGE_SIZE];
+BOOLEAN g_IsPageValid[SEARCH_TEST_MEMORY_PAGES];
+UCHAR   g_Window[MEMORY_MAPPER_WINDOW_PAGES * PAGE_SIZE + MaximumSearchPatternLength];
+UINT64  g_Results[SEARCH_TEST_MAXIMUM_RESULTS];
+UINT64  g_ExpectedResults[SEARCH_TEST_MAXIMUM_RESULTS];
+UINT32  g_Random = 0x12345678;
+
+//////////////////////////////////////////////////
+//				Other modules					//
+//////////////////////////////////////////////////
+
+void
+__cpuidex(int Registers[4], int Leaf, int Subleaf)
+{
+    __asm__ __volatile__("cpuid"
+                         : "=a"(Registers[0]), "=b"(Registers[1]), "=c"(Registers[2]), "=d"(Registers[3])
+                         : "a"(Leaf), "c"(Subleaf));
+}
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief A small random number generator (xorshift)
+ *
+ * @return UINT32
+ */
+static UINT32
+SearchTestRandom()
+{
+    g_Random ^= g_Random << 13;
+    g_Random ^= g_Random >> 17;
+    g_Random ^= g_Random << 5;
+
+    return g_Random;
+}
+
+/**
+ * @brief Search a buffer byte by byte
+ *
+ * @param Pattern The compiled pattern
+ * @param Buffer
+ * @param BufferSize
+ * @param BaseAddress
+ * @param Results The addresses of the matches
+ * @param CountOfResults Count of the previous results (updated)
+ * @return VOID
+ */
+static VOID
+SearchTestReferenceSearch(PSEARCH_ENGINE_PATTERN Pattern,
+                          const UCHAR *          Buffer,
+                          UINT32                 BufferSize,
+                          UINT64                 BaseAddress,
+                          UINT64 *               Results,
+                          UINT32 *               CountOfResults)
+{
+    for (UINT32 Position = 0; Position + Pattern->Length <= BufferSize; Position++)
+    {
+        BOOLEAN IsMatch = ((BaseAddress + Position) & (Pattern->Alignment - 1)) == 0;
+
+        for (UINT32 i = 0; i < Pattern->Length && IsMatch; i++)
+        {
+            IsMatch = ((Buffer[Position + i] ^ Pattern->Bytes[i]) & Pattern->Mask[i]) == 0;
+        }
+
+        if (IsMatch)
+        {
+            Results[(*CountOfResults)++] = BaseAddress + Position;
+        }
+    }
+}
+
+/**
+ * @brief Check the filters of the engine with the reference search
+ *
+ * @param Pattern The compiled pattern
+ * @param Buffer
+ * @param BufferSize
+ * @param BaseAddress
+ * @param UseAvx2
+ * @return BOOLEAN TRUE if the results are the same
+ */
+static BOOLEAN
+SearchTestCompareWithReference(PSEARCH_ENGINE_PATTERN Pattern,
+                               const UCHAR *          Buffer,
+                               UINT32                 BufferSize,
+                               UINT64                 BaseAddress,
+                               BOOLEAN                UseAvx2)
+{
+    SEARCH_ENGINE_RESULTS_CONTEXT ResultsContext        = {g_Results, 0, SEARCH_TEST_MAXIMUM_RESULTS};
+    UINT32                        CountOfExpectedResult = 0;
+
+    SearchTestReferenceSearch(Pattern, Buffer, BufferSize, BaseAddress, g_ExpectedResults, &CountOfExpectedResult);
+
+    SearchEngineScanBuffer(Pattern, Buffer, BufferSize, BaseAddress, UseAvx2, SearchEngineSaveResultCallback, &ResultsContext);
+
+    return ResultsContext.CountOfResults == CountOfExpectedResult &&
+           memcmp(g_Results, g_ExpectedResults, CountOfExpectedResult * sizeof(UINT64)) == 0;
+}
+
+/**
+ * @brief Check the SSE2 and AVX2 filters with the anchors on different
+ * offsets of the patterns and the tails of the buffers
+ *
+ * @param UseAvx2
+ * @return VOID
+ */
+static VOID
+SearchTestFilters(BOOLEAN UseAvx2)
+{
+    SEARCH_ENGINE_PATTERN Pattern;
+    UCHAR                 Bytes[MaximumSearchPatternLength];
+    UCHAR                 Mask[MaximumSearchPatternLength];
+    UINT32                Length;
+    UINT32                Start;
+    UINT32                Size;
+    BOOLEAN               IsValid = TRUE;
+
+    //
+    // A small alphabet has many candidates and many matches
+    //
+    for (UINT32 i = 0; i < SEARCH_TEST_BUFFER_SIZE; i++)
+    {
+        g_Buffer[i] = (UCHAR)(SearchTestRandom() % 4);
+    }
+
+    for (UINT32 Round = 0; Round < 2000; Round++)
+    {
+        Length = 1 + SearchTestRandom() % (Round % 10 == 0 ? MaximumSearchPatternLength : 12);
+        Start  = SearchTestRandom() % 64;
+        Size   = SearchTestRandom() % (SEARCH_TEST_BUFFER_SIZE - Start);
+
+        //
+        // Copy the pattern from the buffer so it's found at least once
+        //
+        memcpy(Bytes, &g_Buffer[SearchTestRandom() % (SEARCH_TEST_BUFFER_SIZE - Length)], Length);
+
+        for (UINT32 i = 0; i < Length; i++)
+        {
+            Mask[i] = SearchTestRandom() % 3 == 0 ? SEARCH_ENGINE_MASK_WILDCARD : SEARCH_ENGINE_MASK_COMPARE;
+        }
+
+        SearchEngineCompilePattern(&Pattern, Bytes, Mask, Length, 1 << (SearchTestRandom() % 4));
+
+        if (!SearchTestCompareWithReference(&Pattern, &g_Buffer[Start], Size, 0x1000 + Start, UseAvx2))
+        {
+            IsValid = FALSE;
+        }
+    }
+
+    UNIT_TEST_CHECK(IsValid);
+
+    //
+    // Leading and trailing wildcards move the anchors
+    //
+    memset(Mask, SEARCH_ENGINE_MASK_WILDCARD, sizeof(Mask));
+    memcpy(Bytes, &g_Buffer[100], 40);
+    Mask[17] = SEARCH_ENGINE_MASK_COMPARE;
+    Mask[23] = SEARCH_ENGINE_MASK_COMPARE;
+
+    SearchEngineCompilePattern(&Pattern, Bytes, Mask, 40, 1);
+
+    UNIT_TEST_CHECK(Pattern.HasAnchor && Pattern.FirstAnchorOffset == 17 && Pattern.SecondAnchorOffset == 23);
+    UNIT_TEST_CHECK(SearchTestCompareWithReference(&Pattern, g_Buffer, SEARCH_TEST_BUFFER_SIZE, 0, UseAvx2));
+
+    //
+    // A single anchor and a pattern without any anchor
+    //
+    Mask[23] = SEARCH_ENGINE_MASK_WILDCARD;
+
+    SearchEngineCompilePattern(&Pattern, Bytes, Mask, 40, 1);
+
+    UNIT_TEST_CHECK(Pattern.FirstAnchorOffset == 17 && Pattern.SecondAnchorOffset == 17);
+    UNIT_TEST_CHECK(SearchTestCompareWithReference(&Pattern, g_Buffer, SEARCH_TEST_BUFFER_SIZE, 0, UseAvx2));
+
+    Mask[17] = SEARCH_ENGINE_MASK_WILDCARD;
+
+    SearchEngineCompilePattern(&Pattern, Bytes, Mask, 8, 8);
+
+    UNIT_TEST_CHECK(!Pattern.HasAnchor);
+    UNIT_TEST_CHECK(SearchTestCompareWithReference(&Pattern, g_Buffer, 1000, 4, UseAvx2));
+
+    //
+    // The buffers that are shorter than the pattern and than the filters
+    //
+    SearchEngineCompilePattern(&Pattern, &g_Buffer[7], NULL, 3, 1);
+
+    for (Size = 0; Size < 70; Size++)
+    {
+        UNIT_TEST_CHECK(SearchTestCompareWithReference(&Pattern, g_Buffer, Size, 0, UseAvx2));
+    }
+}
+
+/**
+ * @brief Check the patterns of the search requests (values and masks)
+ *
+ * @return VOID
+ */
+static VOID
+SearchTestRequests()
+{
+    UINT64                  RequestBuffer[(SIZEOF_DEBUGGER_SEARCH_MEMORY / sizeof(UINT64)) + 1 + 4];
+    PDEBUGGER_SEARCH_MEMORY Request = (PDEBUGGER_SEARCH_MEMORY)RequestBuffer;
+    UINT64 *                Values  = (UINT64 *)((UINT64)Request + SIZEOF_DEBUGGER_SEARCH_MEMORY);
+    SEARCH_ENGINE_PATTERN   Pattern;
+
+    memset(RequestBuffer, 0, sizeof(RequestBuffer));
+
+    Request->ByteSize        = SEARCH_DWORD;
+    Request->CountOf64Chunks = 2;
+    Values[0]                = 0x11223344;
+    Values[1]                = 0x55667788;
+    Values[2]                = 0xffffffff;
+    Values[3]                = 0xff00ff00;
+
+    UNIT_TEST_CHECK(SearchEngineCompilePatternFromSearchRequest(&Pattern, Request));
+    UNIT_TEST_CHECK(Pattern.Length == 8 && Pattern.Alignment == 4);
+    UNIT_TEST_CHECK(Pattern.Bytes[0] == 0x44 && Pattern.Bytes[3] == 0x11 && Pattern.Bytes[4] == 0x00 && Pattern.Bytes[5] == 0x77);
+    UNIT_TEST_CHECK(Pattern.Mask[4] == SEARCH_ENGINE_MASK_WILDCARD && Pattern.Mask[5] == SEARCH_ENGINE_MASK_COMPARE);
+    UNIT_TEST_CHECK(Pattern.FirstAnchorOffset == 0 && Pattern.SecondAnchorOffset == 7);
+
+    Request->ByteSize = SEARCH_QWORD;
+    UNIT_TEST_CHECK(SearchEngineCompilePatternFromSearchRequest(&Pattern, Request) && Pattern.Alignment == 8);
+
+    Request->CountOf64Chunks = MaximumSearchPatternLength / 8 + 1;
+    UNIT_TEST_CHECK(!SearchEngineCompilePatternFromSearchRequest(&Pattern, Request));
+
+    Request->CountOf64Chunks = 0;
+    UNIT_TEST_CHECK(!SearchEngineCompilePatternFromSearchRequest(&Pattern, Request));
+
+    UNIT_TEST_CHECK(!SearchEngineCompilePattern(&Pattern, Pattern.Bytes, NULL, 4, 3));
+    UNIT_TEST_CHECK(!SearchEngineCompilePattern(&Pattern, Pattern.Bytes, NULL, 0, 1));
+}
+
+/**
+ * @brief Search the memory of the test like SearchMemoryPerformSearch,
+ * the valid pages are read in runs of up to MEMORY_MAPPER_WINDOW_PAGES
+ * pages after the carried bytes of the previous run
+ *
+ * @param Pattern The compiled pattern
+ * @param Address Start of the range
+ * @param Length Length of the range
+ * @param ResultsContext
+ * @param UseAvx2
+ * @return BOOLEAN FALSE if the results buffer is full
+ */
+static BOOLEAN
+SearchTestSearchMemory(PSEARCH_ENGINE_PATTERN         Pattern,
+                       UINT64                         Address,
+                       UINT64                         Length,
+                       PSEARCH_ENGINE_RESULTS_CONTEXT ResultsContext,
+                       BOOLEAN                        UseAvx2)
+{
+    UINT64  CurrentAddress = Address;
+    UINT64  EndAddress     = Address + Length;
+    UINT64  RunAddress;
+    UINT64  ChunkSize;
+    UINT32  CarrySize = 0;
+    UINT32  RunSize;
+    UINT32  CountOfPages;
+    BOOLEAN IsRunBroken;
+
+    while (CurrentAddress < EndAddress)
+    {
+        RunAddress   = CurrentAddress;
+        RunSize      = 0;
+        CountOfPages = 0;
+        IsRunBroken  = FALSE;
+
+        while (CountOfPages < MEMORY_MAPPER_WINDOW_PAGES && CurrentAddress < EndAddress)
+        {
+            UINT64 Offset = CurrentAddress - SEARCH_TEST_MEMORY_ADDRESS;
+
+            ChunkSize = min((CurrentAddress & ~(UINT64)(PAGE_SIZE - 1)) + PAGE_SIZE, EndAddress) - CurrentAddress;
+            CurrentAddress += ChunkSize;
+
+            if (!g_IsPageValid[Offset / PAGE_SIZE])
+            {
+                IsRunBroken = TRUE;
+                break;
+            }
+
+            memcpy(g_Window + CarrySize + RunSize, &g_Memory[Offset], ChunkSize);
+
+            RunSize += (UINT32)ChunkSize;
+            CountOfPages++;
+        }
+
+        if (CountOfPages != 0 &&
+            !SearchEngineScanRun(Pattern, g_Window, &CarrySize, RunSize, RunAddress, UseAvx2, SearchEngineSaveResultCallback, ResultsContext))
+        {
+            return FALSE;
+        }
+
+        if (IsRunBroken)
+        {
+            CarrySize = 0;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Search the memory with the requests of the user-mode, each
+ * request continues from the NextAddressToSearch of the previous one
+ *
+ * @param Pattern The compiled pattern
+ * @param Address Start of the range
+ * @param Length Length of the range
+ * @param MaximumResults Maximum results of each request
+ * @param UseAvx2
+ * @param Results The results of all of the requests
+ * @param CountOfRequests Count of the requests
+ * @return UINT32 Count of the results
+ */
+static UINT32
+SearchTestSearchMemoryByRequests(PSEARCH_ENGINE_PATTERN Pattern,
+                                 UINT64                 Address,
+                                 UINT64                 Length,
+                                 UINT32                 MaximumResults,
+                                 BOOLEAN                UseAvx2,
+                                 UINT64 *               Results,
+                                 UINT32 *               CountOfRequests)
+{
+    UINT64                        EndAddress     = Address + Length;
+    UINT32                        CountOfResults = 0;
+    SEARCH_ENGINE_RESULTS_CONTEXT ResultsContext;
+    BOOLEAN                       IsFinished;
+
+    *CountOfRequests = 0;
+
+    while (TRUE)
+    {
+        ResultsContext.Results        = Results + CountOfResults;
+        ResultsContext.CountOfResults = 0;
+        ResultsContext.MaximumResults = MaximumResults;
+
+        IsFinished = SearchTestSearchMemory(Pattern, Address, EndAddress - Address, &ResultsContext, UseAvx2);
+
+        CountOfResults += ResultsContext.CountOfResults;
+        (*CountOfRequests)++;
+
+        if (IsFinished)
+        {
+            break;
+        }
+
+        Address = SearchEngineGetNextAddressToSearch(&ResultsContext);
+
+        if (Address >= EndAddress)
+        {
+            break;
+        }
+    }
+
+    return CountOfResults;
+}
+
+/**
+ * @brief Check the matches that cross the pages and the runs of pages,
+ * the pages that are not valid and the requests that are continued
+ *
+ * @param UseAvx2
+ * @return VOID
+ */
+static VOID
+SearchTestMemory(BOOLEAN UseAvx2)
+{
+    SEARCH_ENGINE_PATTERN         Pattern;
+    SEARCH_ENGINE_RESULTS_CONTEXT ResultsContext;
+    const UCHAR                   Marker[] = "\xde\xad\xbe\xef\x13\x37\xca\xfe\xba\xbe";
+    UINT32                        CountOfExpectedResult;
+    UINT32                        CountOfResults;
+    UINT32                        CountOfRequests;
+    UINT64                        Start;
+    UINT64                        Length;
+
+    for (UINT32 i = 0; i < sizeof(g_Memory); i++)
+    {
+        g_Memory[i] = (UCHAR)SearchTestRandom();
+    }
+
+    for (UINT32 i = 0; i < SEARCH_TEST_MEMORY_PAGES; i++)
+    {
+        g_IsPageValid[i] = i != 20 && i != 21 && i != 40;
+
+        //
+        // Each page (except the last one) has a marker that crosses its
+        // end (and the last page of each run of the window)
+        //
+        if (i != SEARCH_TEST_MEMORY_PAGES - 1)
+        {
+            memcpy(&g_Memory[(i + 1) * PAGE_SIZE - 1 - i % 9], Marker, sizeof(Marker) - 1);
+        }
+    }
+
+    SearchEngineCompilePattern(&Pattern, Marker, NULL, sizeof(Marker) - 1, 1);
+
+    //
+    // The whole memory, the matches on the pages that are not valid and
+    // on the boundaries of them are not found
+    //
+    CountOfExpectedResult = 0;
+
+    for (UINT32 i = 0; i < SEARCH_TEST_MEMORY_PAGES;)
+    {
+        UINT32 First = i;
+
+        while (i < SEARCH_TEST_MEMORY_PAGES && g_IsPageValid[i])
+        {
+            i++;
+        }
+
+        SearchTestReferenceSearch(&Pattern,
+                                  &g_Memory[First * PAGE_SIZE],
+                                  (i - First) * PAGE_SIZE,
+                                  SEARCH_TEST_MEMORY_ADDRESS + First * PAGE_SIZE,
+                                  g_ExpectedResults,
+                                  &CountOfExpectedResult);
+
+        while (i < SEARCH_TEST_MEMORY_PAGES && !g_IsPageValid[i])
+        {
+            i++;
+        }
+    }
+
+    ResultsContext.Results        = g_Results;
+    ResultsContext.CountOfResults = 0;
+    ResultsContext.MaximumResults = SEARCH_TEST_MAXIMUM_RESULTS;
+
+    UNIT_TEST_CHECK(SearchTestSearchMemory(&Pattern, SEARCH_TEST_MEMORY_ADDRESS, sizeof(g_Memory), &ResultsContext, UseAvx2));
+    UNIT_TEST_CHECK(CountOfExpectedResult == SEARCH_TEST_MEMORY_PAGES - 6);
+    UNIT_TEST_CHECK(ResultsContext.CountOfResults == CountOfExpectedResult);
+    UNIT_TEST_CHECK(memcmp(g_Results, g_ExpectedResults, CountOfExpectedResult * sizeof(UINT64)) == 0);
+
+    //
+    // Ranges that start and end inside the pages
+    //
+    for (UINT32 Round = 0; Round < 200; Round++)
+    {
+        Start  = SearchTestRandom() % sizeof(g_Memory);
+        Length = SearchTestRandom() % (sizeof(g_Memory) - Start);
+
+        CountOfExpectedResult = 0;
+
+        for (UINT32 i = 0; i < SEARCH_TEST_MEMORY_PAGES - 6; i++)
+        {
+            if (g_ExpectedResults[i] >= SEARCH_TEST_MEMORY_ADDRESS + Start &&
+                g_ExpectedResults[i] + Pattern.Length <= SEARCH_TEST_MEMORY_ADDRESS + Start + Length)
+            {
+                CountOfExpectedResult++;
+            }
+        }
+
+        ResultsContext.CountOfResults = 0;
+
+        SearchTestSearchMemory(&Pattern, SEARCH_TEST_MEMORY_ADDRESS + Start, Length, &ResultsContext, UseAvx2);
+
+        UNIT_TEST_CHECK(ResultsContext.CountOfResults == CountOfExpectedResult);
+    }
+
+    //
+    // Overlapping matches of the requests that are continued from the
+    // next address (a run of the same byte that crosses the pages)
+    //
+    memset(&g_Memory[3 * PAGE_SIZE - 50], 0x41, 100);
+    SearchEngineCompilePattern(&Pattern, (const UCHAR *)"AAAA", NULL, 4, 1);
+
+    CountOfExpectedResult = 0;
+    SearchTestReferenceSearch(&Pattern, &g_Memory[0], 20 * PAGE_SIZE, SEARCH_TEST_MEMORY_ADDRESS, g_ExpectedResults, &CountOfExpectedResult);
+
+    for (UINT32 MaximumResults = 1; MaximumResults < 12; MaximumResults++)
+    {
+        CountOfResults = SearchTestSearchMemoryByRequests(&Pattern,
+                                                          SEARCH_TEST_MEMORY_ADDRESS,
+                                                          20 * PAGE_SIZE,
+                                                          MaximumResults,
+                                                          UseAvx2,
+                                                          g_Results,
+                                                          &CountOfRequests);
+
+        UNIT_TEST_CHECK(CountOfExpectedResult == 97);
+        UNIT_TEST_CHECK(CountOfResults == CountOfExpectedResult);
+        UNIT_TEST_CHECK(memcmp(g_Results, g_ExpectedResults, CountOfExpectedResult * sizeof(UINT64)) == 0);
+        UNIT_TEST_CHECK(CountOfRequests == CountOfExpectedResult / MaximumResults + 1);
+    }
+}
+
+int
+main()
+{
+    BOOLEAN IsAvx2Supported = SearchEngineIsAvx2Supported();
+
+    SearchTestRequests();
+
+    SearchTestFilters(FALSE);
+    SearchTestMemory(FALSE);
+
+    if (IsAvx2Supported)
+    {
+        SearchTestFilters(TRUE);
+        SearchTestMemory(TRUE);
+    }
+    else
+    {
+        printf("search-engine-test: AVX2 is not supported, only SSE2 is tested\n");
+    }
+
+    return UNIT_TEST_RESULT("search-engine-test");
+}
@@ -0,0 +1,292 @@
+/**
+ * @file slab-allocator-bench.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the slab allocator of the pool manager
+ * @details The slab allocator is compared with the list of pools of the
+ * previous pool manager (a single list of all of the pools behind a
+ * spinlock that is walked by intention for the allocations and by address
+ * for the frees), the frees of the list are immediately reusable here so
+ * the list is measured in its best case
+ *
+ * Usage: slab-allocator-bench [threads] [pools]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the intentions (the caches of the pool manager)
+ *
+ */
+#define BENCH_INTENTIONS 8
+
+/**
+ * @brief Count of the objects that each thread allocates before freeing them
+ *
+ */
+#define BENCH_BATCH 8
+
+/**
+ * @brief Count of the allocations of each thread
+ *
+ */
+#define BENCH_ITERATIONS 400000
+
+/**
+ * @brief A pool of the list (as in the previous pool manager)
+ *
+ */
+typedef struct _BENCH_POOL_TABLE
+{
+    UINT64     Address;
+    UINT32     Intention;
+    BOOLEAN    IsBusy;
+    LIST_ENTRY PoolsList;
+
+} BENCH_POOL_TABLE, *PBENCH_POOL_TABLE;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+LIST_ENTRY     g_PoolsList;
+volatile LONG  g_PoolsLock;
+SLAB_ALLOCATOR g_Allocator;
+SLAB_CACHE     g_Caches[BENCH_INTENTIONS];
+BOOLEAN        g_UseSlabs;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+PVOID
+BenchAllocateMemory(SIZE_T Size)
+{
+    return malloc(Size);
+}
+
+VOID
+BenchFreeMemory(PVOID Memory)
+{
+    free(Memory);
+}
+
+VOID
+BenchLock()
+{
+    while (__atomic_exchange_n(&g_PoolsLock, 1, __ATOMIC_ACQUIRE))
+    {
+        while (__atomic_load_n(&g_PoolsLock, __ATOMIC_RELAXED))
+        {
+            __builtin_ia32_pause();
+        }
+    }
+}
+
+VOID
+BenchUnlock()
+{
+    __atomic_store_n(&g_PoolsLock, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Request a pool from the list
+ *
+ * @param Intention
+ * @return UINT64
+ */
+UINT64
+BenchListRequestPool(UINT32 Intention)
+{
+    UINT64 Address = 0;
+
+    BenchLock();
+
+    for (PLIST_ENTRY Entry = g_PoolsList.Flink; Entry != &g_PoolsList; Entry = Entry->Flink)
+    {
+        PBENCH_POOL_TABLE PoolTable = (PBENCH_POOL_TABLE)((PUCHAR)Entry - offsetof(BENCH_POOL_TABLE, PoolsList));
+
+        if (PoolTable->Intention == Intention && PoolTable->IsBusy == FALSE)
+        {
+            PoolTable->IsBusy = TRUE;
+            Address           = PoolTable->Address;
+            break;
+        }
+    }
+
+    BenchUnlock();
+
+    return Address;
+}
+
+/**
+ * @brief Free a pool of the list
+ *
+ * @param Address
+ * @return BOOLEAN
+ */
+BOOLEAN
+BenchListFreePool(UINT64 Address)
+{
+    BOOLEAN Result = FALSE;
+
+    BenchLock();
+
+    for (PLIST_ENTRY Entry = g_PoolsList.Flink; Entry != &g_PoolsList; Entry = Entry->Flink)
+    {
+        PBENCH_POOL_TABLE PoolTable = (PBENCH_POOL_TABLE)((PUCHAR)Entry - offsetof(BENCH_POOL_TABLE, PoolsList));
+
+        if (PoolTable->Address == Address)
+        {
+            PoolTable->IsBusy = FALSE;
+            Result            = TRUE;
+            break;
+        }
+    }
+
+    BenchUnlock();
+
+    return Result;
+}
+
+/**
+ * @brief Allocate and free the objects of an intention on a thread
+ *
+ * @param Parameter The number of the thread
+ * @return void*
+ */
+void *
+BenchThread(void * Parameter)
+{
+    UINT32 Core      = (UINT32)(UINT64)Parameter;
+    UINT32 Intention = Core % BENCH_INTENTIONS;
+    UINT64 Objects[BENCH_BATCH];
+
+    for (UINT32 i = 0; i < BENCH_ITERATIONS / BENCH_BATCH; i++)
+    {
+        for (UINT32 j = 0; j < BENCH_BATCH; j++)
+        {
+            Objects[j] = g_UseSlabs ? (UINT64)SlabAllocate(&g_Caches[Intention], Core) : BenchListRequestPool(Intention);
+        }
+
+        for (UINT32 j = 0; j < BENCH_BATCH; j++)
+        {
+            if (Objects[j] == 0)
+            {
+                continue;
+            }
+
+            if (g_UseSlabs)
+            {
+                SlabFree(&g_Allocator, (PVOID)Objects[j], Core);
+            }
+            else
+            {
+                BenchListFreePool(Objects[j]);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Run the threads and compute the time of each allocation and free
+ *
+ * @param CountOfThreads
+ * @return double Nanoseconds per allocation and free
+ */
+double
+BenchRun(UINT32 CountOfThreads)
+{
+    pthread_t *     Threads = malloc(sizeof(pthread_t) * CountOfThreads);
+    struct timespec Start, End;
+
+    clock_gettime(CLOCK_MONOTONIC, &Start);
+
+    for (UINT64 i = 0; i < CountOfThreads; i++)
+    {
+        pthread_create(&Threads[i], NULL, BenchThread, (void *)i);
+    }
+
+    for (UINT32 i = 0; i < CountOfThreads; i++)
+    {
+        pthread_join(Threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &End);
+
+    free(Threads);
+
+    return ((End.tv_sec - Start.tv_sec) * 1e9 + (End.tv_nsec - Start.tv_nsec)) / ((double)BENCH_ITERATIONS * CountOfThreads);
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32            CountOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+    UINT32            CountOfPools   = argc > 2 ? atoi(argv[2]) : 1024;
+    PBENCH_POOL_TABLE Pools          = calloc(CountOfPools, sizeof(BENCH_POOL_TABLE));
+    double            ListTime, SlabTime;
+
+    //
+    // The pools of the intentions are interleaved in the list
+    //
+    InitializeListHead(&g_PoolsList);
+
+    for (UINT32 i = 0; i < CountOfPools; i++)
+    {
+        Pools[i].Address   = (UINT64)malloc(0x100);
+        Pools[i].Intention = i % BENCH_INTENTIONS;
+
+        InsertTailList(&g_PoolsList, &Pools[i].PoolsList);
+    }
+
+    SlabInitializeAllocator(&g_Allocator, CountOfThreads, BenchAllocateMemory, BenchFreeMemory);
+
+    for (UINT32 i = 0; i < BENCH_INTENTIONS; i++)
+    {
+        SlabInitializeCache(&g_Allocator, &g_Caches[i], 0x100);
+
+        while (g_Caches[i].FreeObjects < CountOfPools / BENCH_INTENTIONS)
+        {
+            SlabGrowCache(&g_Allocator, &g_Caches[i]);
+        }
+    }
+
+    //
+    // Half of the pools are held during the benchmark (e.g., the pools of
+    // the hooks), these are the first pools of the list
+    //
+    for (UINT32 i = 0; i < CountOfPools / 2; i++)
+    {
+        Pools[i].IsBusy = TRUE;
+        SlabAllocate(&g_Caches[i % BENCH_INTENTIONS], 0);
+    }
+
+    g_UseSlabs = FALSE;
+    ListTime   = BenchRun(CountOfThreads);
+
+    g_UseSlabs = TRUE;
+    SlabTime   = BenchRun(CountOfThreads);
+
+    printf("threads: %u, pools: %u, list: %.1f ns, slabs: %.1f ns (per allocation and free)\n",
+           CountOfThreads,
+           CountOfPools,
+           ListTime,
+           SlabTime);
+
+    return 0;
+}
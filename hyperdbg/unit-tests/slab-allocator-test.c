@@ -0,0 +1,385 @@
+/**
+ * @file slab-allocator-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the slab allocator of the pool manager
+ * @details The objects of the allocator are checked on a single thread,
+ * then the threads allocate and free the objects concurrently and check
+ * that no object is given to two threads at the same time
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+#include <pthread.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Count of the threads (cores) of the concurrent test
+ *
+ */
+#define SLAB_TEST_THREADS 8
+
+/**
+ * @brief Count of the allocations of each thread of the concurrent test
+ *
+ */
+#define SLAB_TEST_ITERATIONS 200000
+
+/**
+ * @brief Count of the objects that each thread keeps at the same time
+ *
+ */
+#define SLAB_TEST_HELD_OBJECTS 64
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+SLAB_ALLOCATOR g_Allocator;
+SLAB_CACHE     g_Cache;
+UINT32         g_ArenaAllocations;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+PVOID
+SlabTestAllocateMemory(SIZE_T Size)
+{
+    g_ArenaAllocations++;
+
+    return malloc(Size);
+}
+
+VOID
+SlabTestFreeMemory(PVOID Memory)
+{
+    free(Memory);
+}
+
+/**
+ * @brief Check whether all bytes of an object are zero
+ *
+ * @param Object
+ * @param Size
+ * @return BOOLEAN
+ */
+BOOLEAN
+SlabTestIsZero(PVOID Object, UINT32 Size)
+{
+    for (UINT32 i = 0; i < Size; i++)
+    {
+        if (((PUCHAR)Object)[i] != 0)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Check the size classes
+ *
+ * @return VOID
+ */
+VOID
+SlabTestSizeClasses()
+{
+    UNIT_TEST_CHECK(SlabGetSizeClass(1) == 0x40);
+    UNIT_TEST_CHECK(SlabGetSizeClass(0x40) == 0x40);
+    UNIT_TEST_CHECK(SlabGetSizeClass(0x41) == 0x80);
+    UNIT_TEST_CHECK(SlabGetSizeClass(0x800) == 0x800);
+    UNIT_TEST_CHECK(SlabGetSizeClass(0x1000) == 0x1000);
+    UNIT_TEST_CHECK(SlabGetSizeClass(0x1001) == 0x2000);
+    UNIT_TEST_CHECK(SlabGetSizeClass(0x2001) == 0x3000);
+    UNIT_TEST_CHECK(SlabGetSizeClass(SLAB_MAXIMUM_OBJECT_SIZE) == SLAB_MAXIMUM_OBJECT_SIZE);
+    UNIT_TEST_CHECK(SlabGetSizeClass(SLAB_MAXIMUM_OBJECT_SIZE + 1) == 0);
+}
+
+/**
+ * @brief Allocate all of the objects of a slab and check them
+ *
+ * @param ObjectSize
+ * @return VOID
+ */
+VOID
+SlabTestObjects(UINT32 ObjectSize)
+{
+    PVOID *      Objects = calloc(SLAB_MAXIMUM_OBJECTS, sizeof(PVOID));
+    PSLAB_HEADER Slab  = NULL;
+    UINT32       Count = 0;
+    UINT32       Index;
+    UINT32       Alignment;
+
+    SlabInitializeAllocator(&g_Allocator, 4, SlabTestAllocateMemory, SlabTestFreeMemory);
+    UNIT_TEST_CHECK(SlabInitializeCache(&g_Allocator, &g_Cache, ObjectSize));
+    UNIT_TEST_CHECK(SlabAllocate(&g_Cache, 0) == NULL);
+    UNIT_TEST_CHECK(g_Cache.Exhaustions == 1);
+
+    UNIT_TEST_CHECK(SlabGrowCache(&g_Allocator, &g_Cache));
+
+    Alignment = min(g_Cache.ObjectSize, PAGE_SIZE);
+
+    while ((Objects[Count] = SlabAllocate(&g_Cache, Count % 4)) != NULL)
+    {
+        Slab = SlabLookup(&g_Allocator, (UINT64)Objects[Count], &Index);
+
+        UNIT_TEST_CHECK(Slab != NULL && Slab->Cache == &g_Cache);
+        UNIT_TEST_CHECK(((UINT64)Objects[Count] & (Alignment - 1)) == 0);
+        UNIT_TEST_CHECK(SlabTestIsZero(Objects[Count], g_Cache.ObjectSize));
+
+        memset(Objects[Count], 0xcc, g_Cache.ObjectSize);
+        Count++;
+    }
+
+    //
+    // The objects of the slab don't overlap and are used completely
+    //
+    UNIT_TEST_CHECK(Count == (SLAB_SIZE - Slab->FirstObjectOffset) / g_Cache.ObjectSize);
+    UNIT_TEST_CHECK(Slab->FirstObjectOffset >= sizeof(SLAB_HEADER));
+    UNIT_TEST_CHECK(g_Cache.FreeObjects == 0);
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        UNIT_TEST_CHECK(((PUCHAR)Objects[i])[0] == 0xcc && ((PUCHAR)Objects[i])[g_Cache.ObjectSize - 1] == 0xcc);
+    }
+
+    //
+    // Interior pointers, unknown addresses and double frees are rejected
+    //
+    UNIT_TEST_CHECK(!SlabFree(&g_Allocator, (PUCHAR)Objects[0] + 8, 0));
+    UNIT_TEST_CHECK(!SlabFree(&g_Allocator, Slab, 0));
+    UNIT_TEST_CHECK(!SlabFree(&g_Allocator, Objects, 0));
+
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        UNIT_TEST_CHECK(SlabFree(&g_Allocator, Objects[i], i % 4));
+    }
+
+    UNIT_TEST_CHECK(!SlabFree(&g_Allocator, Objects[0], 0));
+    UNIT_TEST_CHECK(g_Cache.FreeObjects == Count);
+
+    //
+    // The magazines keep at most SLAB_MAGAZINE_SIZE objects, the rest are
+    // in the depot
+    //
+    for (UINT32 i = 0; i < 4; i++)
+    {
+        UNIT_TEST_CHECK(ExQueryDepthSList(&g_Cache.Magazines[i]) <= SLAB_MAGAZINE_SIZE);
+    }
+
+    //
+    // The freed objects are zeroed and reused, including the objects in the
+    // magazines of the other cores
+    //
+    for (UINT32 i = 0; i < Count; i++)
+    {
+        Objects[i] = SlabAllocate(&g_Cache, 0);
+
+        UNIT_TEST_CHECK(Objects[i] != NULL && SlabTestIsZero(Objects[i], g_Cache.ObjectSize));
+    }
+
+    UNIT_TEST_CHECK(SlabAllocate(&g_Cache, 0) == NULL);
+    UNIT_TEST_CHECK(g_Cache.CountOfSlabs == 1);
+
+    //
+    // The deferred objects are not reused until they're reclaimed
+    //
+    memset(Objects[0], 0xcc, g_Cache.ObjectSize);
+
+    UNIT_TEST_CHECK(SlabDeferFree(&g_Allocator, Objects[0]));
+    UNIT_TEST_CHECK(!SlabDeferFree(&g_Allocator, Objects[0]));
+    UNIT_TEST_CHECK(SlabAllocate(&g_Cache, 0) == NULL);
+
+    SlabReclaimDeferred(&g_Cache);
+
+    UNIT_TEST_CHECK(SlabAllocate(&g_Cache, 1) == Objects[0]);
+    UNIT_TEST_CHECK(SlabTestIsZero(Objects[0], g_Cache.ObjectSize));
+
+    SlabUninitializeCache(&g_Allocator, &g_Cache);
+    SlabUninitializeAllocator(&g_Allocator);
+
+    free(Objects);
+}
+
+/**
+ * @brief Grow the caches until the directory is full
+ *
+ * @return VOID
+ */
+VOID
+SlabTestGrowth()
+{
+    SLAB_CACHE Caches[3];
+    UINT32     CountOfSlabs = 0;
+    UINT32     Index;
+    PVOID      Object;
+
+    g_ArenaAllocations = 0;
+
+    SlabInitializeAllocator(&g_Allocator, 1, SlabTestAllocateMemory, SlabTestFreeMemory);
+
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        UNIT_TEST_CHECK(SlabInitializeCache(&g_Allocator, &Caches[i], 0x40 << (i * 4)));
+    }
+
+    while (SlabGrowCache(&g_Allocator, &Caches[CountOfSlabs % 3]))
+    {
+        CountOfSlabs++;
+    }
+
+    UNIT_TEST_CHECK(CountOfSlabs == SLAB_DIRECTORY_MAXIMUM_SLABS);
+    UNIT_TEST_CHECK(g_ArenaAllocations == 3 + (CountOfSlabs + SLAB_ARENA_SLABS - 1) / SLAB_ARENA_SLABS);
+
+    //
+    // All of the slabs are found in the directory
+    //
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        while ((Object = SlabAllocate(&Caches[i], 0)) != NULL)
+        {
+            UNIT_TEST_CHECK(SlabLookup(&g_Allocator, (UINT64)Object, &Index) != NULL);
+        }
+    }
+
+    for (UINT32 i = 0; i < 3; i++)
+    {
+        SlabUninitializeCache(&g_Allocator, &Caches[i]);
+    }
+
+    SlabUninitializeAllocator(&g_Allocator);
+}
+
+/**
+ * @brief Allocate and free the objects on a thread, each object is filled
+ * with the number of the thread while it's held
+ *
+ * @param Parameter The number of the thread
+ * @return void*
+ */
+void *
+SlabTestThread(void * Parameter)
+{
+    UINT32  Core = (UINT32)(UINT64)Parameter;
+    PUINT32 Held[SLAB_TEST_HELD_OBJECTS] = {0};
+    UINT32  Seed                         = Core + 1;
+    UINT32  Slot;
+
+    for (UINT32 i = 0; i < SLAB_TEST_ITERATIONS; i++)
+    {
+        Seed = Seed * 1103515245 + 12345;
+        Slot = (Seed >> 16) % SLAB_TEST_HELD_OBJECTS;
+
+        if (Held[Slot] != NULL)
+        {
+            for (UINT32 j = 0; j < g_Cache.ObjectSize / sizeof(UINT32); j++)
+            {
+                UNIT_TEST_CHECK(Held[Slot][j] == Core + 1);
+            }
+
+            UNIT_TEST_CHECK(SlabFree(&g_Allocator, Held[Slot], Core));
+            Held[Slot] = NULL;
+            continue;
+        }
+
+        Held[Slot] = SlabAllocate(&g_Cache, Core);
+
+        if (Held[Slot] != NULL)
+        {
+            UNIT_TEST_CHECK(SlabTestIsZero(Held[Slot], g_Cache.ObjectSize));
+
+            for (UINT32 j = 0; j < g_Cache.ObjectSize / sizeof(UINT32); j++)
+            {
+                Held[Slot][j] = Core + 1;
+            }
+        }
+    }
+
+    for (UINT32 i = 0; i < SLAB_TEST_HELD_OBJECTS; i++)
+    {
+        if (Held[i] != NULL)
+        {
+            UNIT_TEST_CHECK(SlabFree(&g_Allocator, Held[i], Core));
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Allocate and free the objects on all threads at the same time,
+ * the cache has fewer objects than the threads need so the threads also
+ * run out of objects
+ *
+ * @return VOID
+ */
+VOID
+SlabTestConcurrency()
+{
+    pthread_t Threads[SLAB_TEST_THREADS];
+    UINT64    TotalObjects;
+
+    SlabInitializeAllocator(&g_Allocator, SLAB_TEST_THREADS, SlabTestAllocateMemory, SlabTestFreeMemory);
+    UNIT_TEST_CHECK(SlabInitializeCache(&g_Allocator, &g_Cache, 0x100));
+
+    for (UINT32 i = 0; i < 2; i++)
+    {
+        UNIT_TEST_CHECK(SlabGrowCache(&g_Allocator, &g_Cache));
+    }
+
+    TotalObjects = g_Cache.FreeObjects;
+
+    UNIT_TEST_CHECK(TotalObjects < SLAB_TEST_THREADS * SLAB_TEST_HELD_OBJECTS);
+
+    for (UINT64 i = 0; i < SLAB_TEST_THREADS; i++)
+    {
+        pthread_create(&Threads[i], NULL, SlabTestThread, (void *)i);
+    }
+
+    for (UINT32 i = 0; i < SLAB_TEST_THREADS; i++)
+    {
+        pthread_join(Threads[i], NULL);
+    }
+
+    //
+    // All of the objects are free again
+    //
+    UNIT_TEST_CHECK(g_Cache.FreeObjects == TotalObjects);
+
+    for (UINT64 i = 0; i < TotalObjects; i++)
+    {
+        UNIT_TEST_CHECK(SlabAllocate(&g_Cache, 0) != NULL);
+    }
+
+    UNIT_TEST_CHECK(SlabAllocate(&g_Cache, 0) == NULL);
+
+    SlabUninitializeCache(&g_Allocator, &g_Cache);
+    SlabUninitializeAllocator(&g_Allocator);
+}
+
+int
+main()
+{
+    SlabTestSizeClasses();
+
+    for (UINT32 Size = SLAB_MINIMUM_OBJECT_SIZE; Size <= SLAB_MAXIMUM_OBJECT_SIZE; Size <<= 1)
+    {
+        SlabTestObjects(Size);
+    }
+
+    SlabTestObjects(0x3000);
+    SlabTestGrowth();
+    SlabTestConcurrency();
+
+    return UNIT_TEST_RESULT("slab-allocator-test");
+}
@@ -0,0 +1,263 @@
+/**
+ * @file symbol-lookup-bench.cpp
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of converting the addresses to the symbols
+ * @details SymLookupAddress is measured with and without the cache of the
+ * recently converted addresses (the entry of each address is invalidated
+ * before converting it), on the modules of the native reader (the pdb file
+ * is mapped as 32 modules) and on a module of DbgHelp (the sorted list of
+ * the symbols), for a few hot addresses (like the addresses of a trace),
+ * random addresses of the modules and a few addresses that are not in any
+ * module
+ *
+ * Usage: symbol-lookup-bench [pdb file] [lookups] [symbols of the DbgHelp
+ * module]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief The copy of the fixture that is opened if no pdb file is given
+ *
+ */
+#define BENCH_PDB_FILE "build/symbol-lookup-bench.pdb"
+
+/**
+ * @brief Count of the modules of the native reader
+ *
+ */
+#define BENCH_COUNT_OF_MODULES 32
+
+/**
+ * @brief Count of the hot addresses
+ *
+ */
+#define BENCH_COUNT_OF_HOT_ADDRESSES 48
+
+/**
+ * @brief Base address of the modules
+ *
+ */
+#define BENCH_MODULES_BASE_ADDRESS 0xfffff80000000000
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+std::vector<PSYMBOL_LOADED_MODULE_DETAILS> g_LoadedModules;
+SYMBOL_ADDRESS_CACHE_ENTRY                 g_SymbolAddressCache[SymbolAddressCacheEntries] = {0};
+
+/**
+ * @brief Rva of the symbols of the pdb file
+ *
+ */
+static std::vector<uint32_t> g_BenchRvas;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the current time in nanoseconds
+ *
+ * @return double
+ */
+static double
+BenchNow()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+/**
+ * @brief Keep the rva of an enumerated symbol
+ *
+ * @param Symbol
+ * @param Context
+ * @return VOID
+ */
+static VOID
+BenchEnumerateCallback(const PDB_READER_SYMBOL * Symbol, void * Context)
+{
+    g_BenchRvas.push_back(Symbol->Rva);
+}
+
+/**
+ * @brief Convert the addresses
+ *
+ * @param Addresses
+ * @param IsCached Whether the cache is used or the entry of each address
+ * is invalidated before converting it
+ * @return double Nanoseconds per address
+ */
+static double
+BenchRun(const std::vector<UINT64> & Addresses, BOOLEAN IsCached)
+{
+    PSYMBOL_LOADED_MODULE_DETAILS Module;
+    const char *                  Name;
+    UINT64                        Displacement;
+    UINT64                        CountOfFound = 0;
+    double                        Start;
+
+    SymInvalidateAddressCache();
+
+    Start = BenchNow();
+
+    for (UINT64 Address : Addresses)
+    {
+        if (!IsCached)
+        {
+            SymGetAddressCacheEntry(Address)->IsValid = FALSE;
+        }
+
+        CountOfFound += SymLookupAddress(Address, &Module, &Name, &Displacement);
+    }
+
+    Start = (BenchNow() - Start) / Addresses.size();
+
+    //
+    // Keep the result so the lookups are not removed
+    //
+    if (CountOfFound > Addresses.size())
+    {
+        printf("err, more addresses are found than the converted addresses\n");
+    }
+
+    return Start;
+}
+
+/**
+ * @brief Measure the addresses of the loaded modules
+ *
+ * @param Title
+ * @param Rvas Rva of the symbols of each module
+ * @param CountOfModules
+ * @param ModuleSize
+ * @param CountOfLookups
+ * @return VOID
+ */
+static VOID
+BenchModules(const char * Title, const std::vector<uint32_t> & Rvas, UINT32 CountOfModules, UINT64 ModuleSize, UINT32 CountOfLookups)
+{
+    std::vector<UINT64> Hot, Random, Unknown;
+    UINT64              HotAddresses[BENCH_COUNT_OF_HOT_ADDRESSES];
+    UINT32              Seed = 0x2545f491;
+
+    for (UINT32 i = 0; i < BENCH_COUNT_OF_HOT_ADDRESSES + CountOfLookups; i++)
+    {
+        Seed ^= Seed << 13;
+        Seed ^= Seed >> 17;
+        Seed ^= Seed << 5;
+
+        UINT64 Address = BENCH_MODULES_BASE_ADDRESS + (Seed >> 8) % CountOfModules * ModuleSize +
+                         Rvas[Seed % Rvas.size()] + Seed % 0x20;
+
+        if (i < BENCH_COUNT_OF_HOT_ADDRESSES)
+        {
+            HotAddresses[i] = Address;
+        }
+        else
+        {
+            Random.push_back(Address);
+            Hot.push_back(HotAddresses[Seed % BENCH_COUNT_OF_HOT_ADDRESSES]);
+
+            //
+            // The same count of user-mode addresses (below all of the
+            // modules)
+            //
+            Unknown.push_back(HotAddresses[Seed % BENCH_COUNT_OF_HOT_ADDRESSES] - BENCH_MODULES_BASE_ADDRESS + 0x7ff600000000);
+        }
+    }
+
+    printf("%s\n", Title);
+    printf("  hot addresses      no cache: %7.1f ns, cache: %6.1f ns\n", BenchRun(Hot, FALSE), BenchRun(Hot, TRUE));
+    printf("  random addresses   no cache: %7.1f ns, cache: %6.1f ns\n", BenchRun(Random, FALSE), BenchRun(Random, TRUE));
+    printf("  unknown addresses  no cache: %7.1f ns, cache: %6.1f ns\n", BenchRun(Unknown, FALSE), BenchRun(Unknown, TRUE));
+}
+
+int
+main(int argc, char * argv[])
+{
+    const char *                  PdbFileName    = argc > 1 ? argv[1] : BENCH_PDB_FILE;
+    UINT32                        CountOfLookups = argc > 2 ? atoi(argv[2]) : 2000000;
+    UINT32                        CountOfSymbols = argc > 3 ? atoi(argv[3]) : 300000;
+    SYMBOL_LOADED_MODULE_DETAILS  Modules[BENCH_COUNT_OF_MODULES] = {0};
+    SYMBOL_LOADED_MODULE_DETAILS  DbgHelpModule                   = {0};
+    vector<SYMBOL_ADDRESS_RANGE>  AddressRanges;
+    std::vector<uint32_t>         DbgHelpRvas;
+    PPDB_READER                   Reader;
+    UINT64                        ModuleSize;
+    char                          Title[0x100];
+
+    if (argc <= 1)
+    {
+        std::ifstream Source("data/pdb-reader-test.pdb", std::ios::binary);
+        std::ofstream Destination(BENCH_PDB_FILE, std::ios::binary);
+
+        Destination << Source.rdbuf();
+    }
+
+    Reader = PdbReaderOpen(PdbFileName);
+
+    if (Reader == NULL || PdbReaderEnumerateSymbols(Reader, "*", BenchEnumerateCallback, NULL) == 0)
+    {
+        printf("err, unable to read the symbols of %s\n", PdbFileName);
+        return 1;
+    }
+
+    //
+    // The pdb file is loaded as the modules of the native reader
+    //
+    ModuleSize = (PdbReaderGetImageSize(Reader) + 0xfffff) & ~0xfffffull;
+
+    for (UINT32 i = 0; i < BENCH_COUNT_OF_MODULES; i++)
+    {
+        Modules[i].BaseAddress = BENCH_MODULES_BASE_ADDRESS + i * ModuleSize;
+        Modules[i].PdbReader   = Reader;
+
+        g_LoadedModules.push_back(&Modules[i]);
+    }
+
+    snprintf(Title, sizeof(Title), "native reader, %u modules of %zu symbols", BENCH_COUNT_OF_MODULES, g_BenchRvas.size());
+    BenchModules(Title, g_BenchRvas, BENCH_COUNT_OF_MODULES, ModuleSize, CountOfLookups);
+
+    //
+    // A module of DbgHelp, the symbols are 0x40 bytes apart
+    //
+    g_LoadedModules.clear();
+
+    for (UINT32 i = 0; i < CountOfSymbols; i++)
+    {
+        AddressRanges.push_back({BENCH_MODULES_BASE_ADDRESS + 0x1000 + i * 0x40ull, "Function" + to_string(i)});
+        DbgHelpRvas.push_back(0x1000 + i * 0x40);
+    }
+
+    DbgHelpModule.BaseAddress   = BENCH_MODULES_BASE_ADDRESS;
+    DbgHelpModule.ImageSize     = 0x1000 + CountOfSymbols * 0x40ull;
+    DbgHelpModule.AddressRanges = &AddressRanges;
+
+    g_LoadedModules.push_back(&DbgHelpModule);
+
+    snprintf(Title, sizeof(Title), "DbgHelp, 1 module of %u symbols", CountOfSymbols);
+    BenchModules(Title, DbgHelpRvas, 1, DbgHelpModule.ImageSize, CountOfLookups);
+
+    PdbReaderClose(Reader);
+
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file transparency-cache-bench.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Benchmark of the per-core cache of the transparency decisions
+ * @details The decisions of the vm-exits of the transparent-mode (!hide)
+ * are found with the cache and compared with walking the transparency list
+ * and comparing the process names on each vm-exit (as the previous handler
+ * of the vm-exits), the running processes are switched after a random
+ * count of vm-exits and a quarter of them are on the list
+ *
+ * Usage: transparency-cache-bench [vm-exits] [processes]
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+
+#include <stdio.h>
+#include <time.h>
+
+//////////////////////////////////////////////////
+//					Definitions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Maximum count of the entries of the transparency list
+ *
+ */
+#define BENCH_MAXIMUM_LIST_ENTRIES 64
+
+/**
+ * @brief Maximum count of the running processes
+ *
+ */
+#define BENCH_MAXIMUM_PROCESSES 256
+
+//////////////////////////////////////////////////
+//					Structures					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief An entry of the transparency list (like TRANSPARENCY_PROCESS)
+ *
+ */
+typedef struct _BENCH_TRANSPARENCY_PROCESS
+{
+    UINT32     ProcessId;
+    CHAR       ProcessName[16];
+    BOOLEAN    TrueIfProcessIdAndFalseIfProcessName;
+    LIST_ENTRY OtherProcesses;
+
+} BENCH_TRANSPARENCY_PROCESS, *PBENCH_TRANSPARENCY_PROCESS;
+
+/**
+ * @brief A running process
+ *
+ */
+typedef struct _BENCH_PROCESS
+{
+    UINT64 GuestCr3;
+    HANDLE ProcessId;
+    CHAR   ImageFileName[16];
+
+} BENCH_PROCESS, *PBENCH_PROCESS;
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+BENCH_TRANSPARENCY_PROCESS       g_ListEntries[BENCH_MAXIMUM_LIST_ENTRIES];
+LIST_ENTRY                       g_ProcessList;
+BENCH_PROCESS                    g_Processes[BENCH_MAXIMUM_PROCESSES];
+UINT32                           g_Schedule[0x10000];
+TRANSPARENCY_PROCESS_CACHE_ENTRY g_Cache[TRANSPARENCY_PROCESS_CACHE_ENTRIES];
+UINT64                           g_CountOfHidden;
+UINT64                           g_CountOfMisses;
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Get the current time in nanoseconds
+ *
+ * @return double
+ */
+static double
+BenchNow()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+/**
+ * @brief Check whether a process is on the transparency list by walking
+ * the list (the previous handler, the names are compared like StartsWith)
+ *
+ * @param ProcessId
+ * @param ProcessName
+ * @return BOOLEAN
+ */
+static BOOLEAN
+BenchListIsProcessOnTransparencyList(HANDLE ProcessId, PCHAR ProcessName)
+{
+    PLIST_ENTRY TempList = &g_ProcessList;
+
+    while (&g_ProcessList != TempList->Flink)
+    {
+        TempList                                   = TempList->Flink;
+        PBENCH_TRANSPARENCY_PROCESS ProcessDetails = CONTAINING_RECORD(TempList, BENCH_TRANSPARENCY_PROCESS, OtherProcesses);
+
+        if (ProcessDetails->TrueIfProcessIdAndFalseIfProcessName)
+        {
+            if ((HANDLE)(UINT64)ProcessDetails->ProcessId == ProcessId)
+            {
+                return TRUE;
+            }
+        }
+        else
+        {
+            size_t LengthOfPrefix = strlen(ProcessName);
+
+            if (strlen(ProcessDetails->ProcessName) >= LengthOfPrefix &&
+                memcmp(ProcessName, ProcessDetails->ProcessName, LengthOfPrefix) == 0)
+            {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Find the decisions of the vm-exits
+ *
+ * @param CountOfVmexits
+ * @param IsCached Whether the cache is used or the list is walked for
+ * each vm-exit
+ * @return double Nanoseconds per vm-exit
+ */
+static double
+BenchRun(UINT32 CountOfVmexits, BOOLEAN IsCached)
+{
+    PBENCH_PROCESS Process;
+    BOOLEAN        IsProcessOnTransparencyList;
+    double         Start;
+
+    RtlZeroMemory(g_Cache, sizeof(g_Cache));
+
+    g_CountOfHidden = 0;
+    g_CountOfMisses = 0;
+    Start           = BenchNow();
+
+    for (UINT32 i = 0; i < CountOfVmexits; i++)
+    {
+        Process = &g_Processes[g_Schedule[i & (sizeof(g_Schedule) / sizeof(g_Schedule[0]) - 1)]];
+
+        if (!IsCached ||
+            !TransparentProcessCacheLookup(g_Cache, Process->GuestCr3, Process->ProcessId, 1, &IsProcessOnTransparencyList))
+        {
+            IsProcessOnTransparencyList = BenchListIsProcessOnTransparencyList(Process->ProcessId, Process->ImageFileName);
+
+            if (IsCached)
+            {
+                TransparentProcessCacheInsert(g_Cache, Process->GuestCr3, Process->ProcessId, 1, IsProcessOnTransparencyList);
+            }
+
+            g_CountOfMisses++;
+        }
+
+        g_CountOfHidden += IsProcessOnTransparencyList;
+    }
+
+    return (BenchNow() - Start) / CountOfVmexits;
+}
+
+int
+main(int argc, char * argv[])
+{
+    UINT32 CountOfVmexits     = argc > 1 ? atoi(argv[1]) : 10000000;
+    UINT32 CountOfProcesses   = argc > 2 ? atoi(argv[2]) : 8;
+    UINT32 CountsOfEntries[]  = {1, 4, 16, BENCH_MAXIMUM_LIST_ENTRIES};
+    UINT32 Random             = 0x0badf00d;
+    UINT32 CountOfEntries;
+    UINT32 Process;
+    UINT64 CountOfHidden;
+    double List, Cache;
+
+    if (CountOfProcesses == 0 || CountOfProcesses > BENCH_MAXIMUM_PROCESSES)
+    {
+        return 1;
+    }
+
+    //
+    // The running processes, the cr3s are random pages
+    //
+    for (UINT32 i = 0; i < CountOfProcesses; i++)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        g_Processes[i].GuestCr3  = (UINT64)(Random & 0xfffff) << PAGE_SHIFT;
+        g_Processes[i].ProcessId = (HANDLE)(UINT64)(0x1000 + i * 4);
+
+        snprintf(g_Processes[i].ImageFileName, sizeof(g_Processes[i].ImageFileName), "process%03u.exe", i);
+    }
+
+    //
+    // The processes run for a random count of vm-exits (1 to 64)
+    //
+    for (UINT32 i = 0; i < sizeof(g_Schedule) / sizeof(g_Schedule[0]);)
+    {
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+
+        Process = (Random >> 8) % CountOfProcesses;
+
+        for (UINT32 j = 0; j < 1 + Random % 64 && i < sizeof(g_Schedule) / sizeof(g_Schedule[0]); j++)
+        {
+            g_Schedule[i++] = Process;
+        }
+    }
+
+    for (UINT32 i = 0; i < sizeof(CountsOfEntries) / sizeof(CountsOfEntries[0]); i++)
+    {
+        CountOfEntries = CountsOfEntries[i];
+
+        //
+        // Half of the entries are process ids and half of them are names,
+        // the entries of a quarter of the processes are at the end of the
+        // list
+        //
+        InitializeListHead(&g_ProcessList);
+
+        for (UINT32 j = 0; j < CountOfEntries; j++)
+        {
+            Process = CountOfEntries - 1 - j;
+
+            if (Process < (CountOfProcesses + 3) / 4)
+            {
+                g_ListEntries[j].ProcessId = (UINT32)(UINT64)g_Processes[Process * 4].ProcessId;
+                strcpy(g_ListEntries[j].ProcessName, g_Processes[Process * 4].ImageFileName);
+            }
+            else
+            {
+                g_ListEntries[j].ProcessId = 0x8000 + j * 4;
+                snprintf(g_ListEntries[j].ProcessName, sizeof(g_ListEntries[j].ProcessName), "hidden%03u.exe", j);
+            }
+
+            g_ListEntries[j].TrueIfProcessIdAndFalseIfProcessName = j & 1;
+
+            InsertHeadList(&g_ProcessList, &g_ListEntries[j].OtherProcesses);
+        }
+
+        List          = BenchRun(CountOfVmexits, FALSE);
+        CountOfHidden = g_CountOfHidden;
+        Cache         = BenchRun(CountOfVmexits, TRUE);
+
+        if (g_CountOfHidden != CountOfHidden)
+        {
+            printf("err, the decisions are not the same\n");
+        }
+
+        printf("%2u entries, %u processes  list: %6.1f ns, cache: %5.1f ns (%.2f%% misses)\n",
+               CountOfEntries,
+               CountOfProcesses,
+               List,
+               Cache,
+               100.0 * g_CountOfMisses / CountOfVmexits);
+    }
+
+    return 0;
+}
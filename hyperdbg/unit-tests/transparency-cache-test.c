@@ -0,0 +1,109 @@
+/**
+ * @file transparency-cache-test.c
+ * @author Sina Karvandi (sina@rayanfam.com)
+ * @brief Test of the per-core cache of the transparency decisions
+ * @details The cached decisions are only used for the same guest cr3, the
+ * same process id and the same version of the transparency list, and the
+ * processes that share an entry replace each other
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright This project is released under the GNU Public License v3.
+ *
+ */
+#include "pch.h"
+#include "unit-tests.h"
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////
+//					Globals   					//
+//////////////////////////////////////////////////
+
+TRANSPARENCY_PROCESS_CACHE_ENTRY g_Cache[TRANSPARENCY_PROCESS_CACHE_ENTRIES];
+
+//////////////////////////////////////////////////
+//					Functions					//
+//////////////////////////////////////////////////
+
+/**
+ * @brief Check the keys of the cached decisions
+ *
+ * @return VOID
+ */
+static VOID
+TransparencyCacheTestKeys()
+{
+    BOOLEAN IsProcessOnTransparencyList = FALSE;
+
+    RtlZeroMemory(g_Cache, sizeof(g_Cache));
+
+    UNIT_TEST_CHECK(!TransparentProcessCacheLookup(g_Cache, 0x1aa000, (HANDLE)0x10, 1, &IsProcessOnTransparencyList));
+
+    TransparentProcessCacheInsert(g_Cache, 0x1aa000, (HANDLE)0x10, 1, TRUE);
+
+    UNIT_TEST_CHECK(TransparentProcessCacheLookup(g_Cache, 0x1aa000, (HANDLE)0x10, 1, &IsProcessOnTransparencyList));
+    UNIT_TEST_CHECK(IsProcessOnTransparencyList == TRUE);
+
+    //
+    // A terminated process that its cr3 is reused by another process
+    //
+    UNIT_TEST_CHECK(!TransparentProcessCacheLookup(g_Cache, 0x1aa000, (HANDLE)0x24, 1, &IsProcessOnTransparencyList));
+
+    //
+    // The transparency list is changed
+    //
+    UNIT_TEST_CHECK(!TransparentProcessCacheLookup(g_Cache, 0x1aa000, (HANDLE)0x10, 2, &IsProcessOnTransparencyList));
+
+    //
+    // The decision of a process which is not on the list is also cached
+    //
+    TransparentProcessCacheInsert(g_Cache, 0x1aa000, (HANDLE)0x10, 2, FALSE);
+
+    UNIT_TEST_CHECK(TransparentProcessCacheLookup(g_Cache, 0x1aa000, (HANDLE)0x10, 2, &IsProcessOnTransparencyList));
+    UNIT_TEST_CHECK(IsProcessOnTransparencyList == FALSE);
+}
+
+/**
+ * @brief Check the processes that share an entry of the cache
+ *
+ * @return VOID
+ */
+static VOID
+TransparencyCacheTestConflicts()
+{
+    BOOLEAN IsProcessOnTransparencyList = FALSE;
+    UINT64  GuestCr3First               = 0x1aa000;
+    UINT64  GuestCr3Second              = GuestCr3First + TRANSPARENCY_PROCESS_CACHE_ENTRIES * PAGE_SIZE;
+    UINT64  GuestCr3Other               = GuestCr3First + PAGE_SIZE;
+
+    RtlZeroMemory(g_Cache, sizeof(g_Cache));
+
+    TransparentProcessCacheInsert(g_Cache, GuestCr3First, (HANDLE)0x10, 1, TRUE);
+    TransparentProcessCacheInsert(g_Cache, GuestCr3Other, (HANDLE)0x14, 1, FALSE);
+
+    UNIT_TEST_CHECK(TransparentProcessCacheLookup(g_Cache, GuestCr3First, (HANDLE)0x10, 1, &IsProcessOnTransparencyList));
+    UNIT_TEST_CHECK(IsProcessOnTransparencyList == TRUE);
+    UNIT_TEST_CHECK(TransparentProcessCacheLookup(g_Cache, GuestCr3Other, (HANDLE)0x14, 1, &IsProcessOnTransparencyList));
+    UNIT_TEST_CHECK(IsProcessOnTransparencyList == FALSE);
+
+    //
+    // The second process replaces the first one, the other process stays
+    //
+    TransparentProcessCacheInsert(g_Cache, GuestCr3Second, (HANDLE)0x18, 1, FALSE);
+
+    UNIT_TEST_CHECK(!TransparentProcessCacheLookup(g_Cache, GuestCr3First, (HANDLE)0x10, 1, &IsProcessOnTransparencyList));
+    UNIT_TEST_CHECK(TransparentProcessCacheLookup(g_Cache, GuestCr3Second, (HANDLE)0x18, 1, &IsProcessOnTransparencyList));
+    UNIT_TEST_CHECK(IsProcessOnTransparencyList == FALSE);
+    UNIT_TEST_CHECK(TransparentProcessCacheLookup(g_Cache, GuestCr3Other, (HANDLE)0x14, 1, &IsProcessOnTransparencyList));
+}
+
+int
+main()
+{
+    TransparencyCacheTestKeys();
+    TransparencyCacheTestConflicts();
+
+    return UNIT_TEST_RESULT("transparency-cache-test");
+}